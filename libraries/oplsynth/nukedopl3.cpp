@@ -1000,11 +1000,21 @@ void NukedOPL3::WriteReg(int reg, int v) {
 }
 
 void NukedOPL3::Update(float* sndptr, int numsamples) {
-	Bit16s buffer[2];
-	for (Bit32u i = 0; i < (Bit32u)numsamples; i++) {
-		chip_generate(&opl3, buffer);
-		*sndptr++ += (float)(buffer[0] / 10240.0);
-		*sndptr++ += (float)(buffer[1] / 10240.0);
+	// Generate in blocks so that the conversion to float runs as a separate
+	// loop the compiler can vectorize instead of being interleaved with the
+	// chip emulation.
+	enum { BLOCK = 256 };
+	Bit16s buffer[BLOCK * 2];
+	while (numsamples > 0) {
+		int count = numsamples < BLOCK ? numsamples : BLOCK;
+		for (int i = 0; i < count; i++) {
+			chip_generate(&opl3, &buffer[i * 2]);
+		}
+		for (int i = 0; i < count * 2; i++) {
+			sndptr[i] += (float)(buffer[i] / 10240.0);
+		}
+		sndptr += count * 2;
+		numsamples -= count;
 	}
 }
 
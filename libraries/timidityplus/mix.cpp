@@ -33,6 +33,17 @@
 #include "mix.h"
 #include "optcode.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MIX_USE_SSE2
+#ifdef __SSE4_1__
+#include <smmintrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MIX_USE_NEON
+#endif
+
 namespace TimidityPlus
 {
 extern float min_sustain_time;
@@ -52,7 +63,53 @@ typedef int32_t mix_t;
 	if (++pan_delay_wpt == PAN_DELAY_BUF_MAX) {pan_delay_wpt = 0;}
 
 
+/*
+ * Steady-state part of the stereo mixers: adds count mono samples to the
+ * interleaved output with constant gains. All arithmetic is 32 bit integer
+ * with the same wraparound as the scalar loop, so the vector paths are bit
+ * exact.
+ */
+#ifdef MIX_USE_SSE2
+static inline __m128i mix_mullo(__m128i a, __m128i b)
+{
+#ifdef __SSE4_1__
+	return _mm_mullo_epi32(a, b);
+#else
+	__m128i even = _mm_mul_epu32(a, b);
+	__m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+}
+#endif
 
+static void mix_stereo_block(const mix_t *sp, int32_t *lp, int32_t left, int32_t right, int count)
+{
+	int i = 0;
+#if defined(MIX_USE_SSE2)
+	__m128i gain = _mm_setr_epi32(left, right, left, right);
+	for (; i + 4 <= count; i += 4, sp += 4, lp += 8) {
+		__m128i s = _mm_loadu_si128((const __m128i *)sp);
+		__m128i lo = mix_mullo(_mm_unpacklo_epi32(s, s), gain);
+		__m128i hi = mix_mullo(_mm_unpackhi_epi32(s, s), gain);
+		_mm_storeu_si128((__m128i *)lp, _mm_add_epi32(_mm_loadu_si128((const __m128i *)lp), lo));
+		_mm_storeu_si128((__m128i *)(lp + 4), _mm_add_epi32(_mm_loadu_si128((const __m128i *)(lp + 4)), hi));
+	}
+#elif defined(MIX_USE_NEON)
+	const int32_t g[4] = { left, right, left, right };
+	int32x4_t gain = vld1q_s32(g);
+	for (; i + 4 <= count; i += 4, sp += 4, lp += 8) {
+		int32x4_t s = vld1q_s32(sp);
+		int32x4x2_t ss = vzipq_s32(s, s);
+		vst1q_s32(lp, vmlaq_s32(vld1q_s32(lp), ss.val[0], gain));
+		vst1q_s32(lp + 4, vmlaq_s32(vld1q_s32(lp + 4), ss.val[1], gain));
+	}
+#endif
+	for (; i < count; i++) {
+		mix_t s = *sp++;
+		MIXATION(left);
+		MIXATION(right);
+	}
+}
 
 /**************** interface function ****************/
 void Mixer::mix_voice(int32_t *buf, int v, int32_t c)
@@ -762,11 +819,7 @@ void Mixer::mix_mystery(mix_t *sp, int32_t *lp, int v, int count)
 	vp->old_right_mix = linear_right;
 	count -= i;
 	if(vp->pan_delay_rpt == 0) {
-		for (i = 0; i < count; i++) {
-			s = *sp++;
-			MIXATION(left);
-			MIXATION(right);
-		}
+		mix_stereo_block(sp, lp, left, right, count);
 	} else if(vp->panning < 64) {
 		for (i = 0; i < count; i++) {
 			s = *sp++;
@@ -905,11 +958,7 @@ void Mixer::mix_center(mix_t *sp, int32_t *lp, int v, int count)
 	}
 	vp->old_left_mix = vp->old_right_mix = linear_left;
 	count -= i;
-	for (i = 0; i < count; i++) {
-		s = *sp++;
-		MIXATION(left);
-		MIXATION(left);
-	}
+	mix_stereo_block(sp, lp, left, left, count);
 }
 
 void Mixer::mix_single_signal(mix_t *sp, int32_t *lp, int v, int count)
@@ -1031,10 +1080,12 @@ void Mixer::mix_single(mix_t *sp, int32_t *lp, int v, int count)
 	}
 	vp->old_left_mix = linear_left;
 	count -= i;
-	for (i = 0; i < count; i++) {
-		s = *sp++;
-		MIXATION(left);
-		lp++;
+	/* lp may point at the right channel, so the last sample must not touch
+	 * the slot after it. */
+	if (count > 0) {
+		mix_stereo_block(sp, lp, left, 0, count - 1);
+		s = sp[count - 1];
+		lp[(count - 1) * 2] += left * s;
 	}
 }
 
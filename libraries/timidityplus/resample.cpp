@@ -33,6 +33,18 @@
 #include "resample.h"
 #include "recache.h"
 
+/* The vector gauss kernel sums the taps in a different order than the
+ * scalar one, so it is left out when bit exact output is wanted. */
+#ifndef TIMIDITY_BITEXACT
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GAUSS_USE_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define GAUSS_USE_NEON
+#endif
+#endif
+
 namespace TimidityPlus
 {
 
@@ -140,6 +152,31 @@ static resample_t resample_gauss(sample_t *src, splen_t ofs, resample_rec_t *rec
 		sptr = src + left - (gauss_n >> 1);
 		gptr = gauss_table[ofs&FRACTION_MASK];
 		if (gauss_n == DEFAULT_GAUSS_ORDER) {
+#if defined(GAUSS_USE_SSE2)
+			/* 24 of the 26 taps in three blocks of 8 samples, the rest is scalar. */
+			__m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+			for (int k = 0; k < 24; k += 8) {
+				__m128i raw = _mm_loadu_si128((const __m128i *)(sptr + k));
+				__m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(raw, raw), 16));
+				__m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(raw, raw), 16));
+				acc0 = _mm_add_ps(acc0, _mm_mul_ps(lo, _mm_loadu_ps(gptr + k)));
+				acc1 = _mm_add_ps(acc1, _mm_mul_ps(hi, _mm_loadu_ps(gptr + k + 4)));
+			}
+			acc0 = _mm_add_ps(acc0, acc1);
+			acc0 = _mm_add_ps(acc0, _mm_movehl_ps(acc0, acc0));
+			acc0 = _mm_add_ss(acc0, _mm_shuffle_ps(acc0, acc0, 1));
+			y = _mm_cvtss_f32(acc0) + sptr[24] * gptr[24] + sptr[25] * gptr[25];
+#elif defined(GAUSS_USE_NEON)
+			float32x4_t acc0 = vdupq_n_f32(0), acc1 = vdupq_n_f32(0);
+			for (int k = 0; k < 24; k += 8) {
+				int16x8_t raw = vld1q_s16(sptr + k);
+				acc0 = vmlaq_f32(acc0, vcvtq_f32_s32(vmovl_s16(vget_low_s16(raw))), vld1q_f32(gptr + k));
+				acc1 = vmlaq_f32(acc1, vcvtq_f32_s32(vmovl_s16(vget_high_s16(raw))), vld1q_f32(gptr + k + 4));
+			}
+			acc0 = vaddq_f32(acc0, acc1);
+			float32x2_t sum = vadd_f32(vget_low_f32(acc0), vget_high_f32(acc0));
+			y = vget_lane_f32(vpadd_f32(sum, sum), 0) + sptr[24] * gptr[24] + sptr[25] * gptr[25];
+#else
 			/* expanding the loop for the default case.
 				* this will allow intensive optimization when compiled
 				* with SSE2 capability.
@@ -172,6 +209,7 @@ static resample_t resample_gauss(sample_t *src, splen_t ofs, resample_rec_t *rec
 			do_gauss;
 			y += *sptr * *gptr;
 #undef do_gauss
+#endif
 		}
 		else {
 			gend = gptr + gauss_n;
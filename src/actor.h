@@ -686,6 +686,7 @@ public:
 	bool CheckMeleeRange();
 
 	bool CheckNoDelay();
+	bool CanTickIdle();
 
 	virtual void BeginPlay();			// Called immediately after the actor is created
 	void CallBeginPlay();
@@ -767,6 +768,7 @@ public:
 	// Finds the first item of a particular type.
 	AActor *FindInventory (PClassActor *type, bool subclass=false);
 	AActor *FindInventory (FName type, bool subclass = false);
+	bool InventoryMayContain (PClassActor *type);
 	template<class T> T *FindInventory ()
 	{
 		return static_cast<T *> (FindInventory (RUNTIME_CLASS(T)));
@@ -1019,11 +1021,36 @@ public:
 	void AttachLight(unsigned int count, const FLightDefaults *lightdef);
 	void SetDynamicLights();
 
-// info for drawing
 // NOTE: The first member variable *must* be snext.
 	AActor			*snext, **sprev;	// links in sector (if needed)
 	DVector3		__Pos;		// double underscores so that it won't get used by accident. Access to this should be exclusively through the designated access functions.
 
+// The fields every actor's Tick touches are kept together up here, so running
+// the thinkers doesn't drag the rest of this huge object through the cache.
+	DVector3		Vel;
+	double			radius, Height;		// for movement checking
+	struct sector_t	*Sector;
+	subsector_t *		subsector;
+	double			floorz, ceilingz;	// closest together of contacted secs
+	double			dropoffz;		// killough 11/98: the lowest floor over all contacted Sectors.
+	ActorFlags		flags;
+	ActorFlags2		flags2;			// Heretic flags
+	ActorFlags3		flags3;			// [RH] Hexen/Heretic actor-dependant behavior made flaggable
+	ActorFlags4		flags4;			// [RH] Even more flags!
+	ActorFlags5		flags5;			// OMG! We need another one.
+	ActorFlags6		flags6;			// Shit! Where did all the flags go?
+	ActorFlags7		flags7;			// WHO WANTS TO BET ON 8!?
+	ActorFlags8		flags8;			// I see your 8, and raise you a bet for 9.
+	int32_t			tics;				// state tic counter
+	FState			*state;
+	player_t		*player;		// only valid if type of PlayerPawn
+
+	// [RH] Used to interpolate the view to get >35 FPS
+	DVector3 Prev;
+	DRotator PrevAngles;
+	int PrevPortalGroup;
+
+// info for drawing
 	DAngle			SpriteAngle;
 	DAngle			SpriteRotation;
 	DRotator		Angles;
@@ -1044,16 +1071,7 @@ public:
 	uint32_t			RenderHidden;		// current renderer must *not* have any of these features
 
 	ActorRenderFlags	renderflags;		// Different rendering flags
-	ActorFlags		flags;
-	ActorFlags2		flags2;			// Heretic flags
-	ActorFlags3		flags3;			// [RH] Hexen/Heretic actor-dependant behavior made flaggable
-	ActorFlags4		flags4;			// [RH] Even more flags!
-	ActorFlags5		flags5;			// OMG! We need another one.
-	ActorFlags6		flags6;			// Shit! Where did all the flags go?
-	ActorFlags7		flags7;			// WHO WANTS TO BET ON 8!?
-	ActorFlags8		flags8;			// I see your 8, and raise you a bet for 9.
 	double			Floorclip;		// value to use for floor clipping
-	double			radius, Height;		// for movement checking
 
 	FAngle			VisibleStartAngle;
 	FAngle			VisibleStartPitch;
@@ -1061,17 +1079,12 @@ public:
 	FAngle			VisibleEndPitch;
 
 	DVector3		OldRenderPos;
-	DVector3		Vel;
 	DVector2		SpriteOffset;
 	double			Speed;
 	double			FloatSpeed;
 
 // interaction info
 	FBlockNode		*BlockNode;			// links in blocks (if needed)
-	struct sector_t	*Sector;
-	subsector_t *		subsector;
-	double			floorz, ceilingz;	// closest together of contacted secs
-	double			dropoffz;		// killough 11/98: the lowest floor over all contacted Sectors.
 
 	uint32_t		ThruBits;
 	FTextureID		floorpic;			// contacted sec floorpic
@@ -1091,8 +1104,6 @@ public:
 	double			StealthAlpha;	// Minmum alpha for MF_STEALTH.
 	int				WoundHealth;		// Health needed to enter wound state
 
-	int32_t			tics;				// state tic counter
-	FState			*state;
 	//VMFunction		*Damage;			// For missiles and monster railgun
 	int				DamageVal;
 	VMFunction		*DamageFunc;
@@ -1122,7 +1133,6 @@ public:
 	int32_t			threshold;		// if > 0, the target will be chased
 	int32_t			DefThreshold;	// [MC] Default threshold which the actor will reset its threshold to after switching targets
 									// no matter what (even if shot)
-	player_t		*player;		// only valid if type of PlayerPawn
 	TObjPtr<AActor*>	LastLookActor;	// Actor last looked for (if TIDtoHate != 0)
 	DVector3		SpawnPoint; 	// For nightmare respawn
 	int				StartHealth;
@@ -1196,6 +1206,10 @@ public:
 
 	TObjPtr<AActor*>	Inventory;		// [RH] This actor's inventory
 	uint32_t			InventoryID;	// A unique ID to keep track of inventory items
+	AActor				*InventoryFilterHead;	// Bit filter of the classes in a large inventory,
+	uint32_t			InventoryFilterID;		// valid while the head and InventoryID are unchanged
+	bool				InventoryFiltered;
+	uint64_t			InventoryFilter[4];
 
 	uint8_t smokecounter;
 	uint8_t FloatBobPhase;
@@ -1247,10 +1261,6 @@ public:
 	// [RH] Decal(s) this weapon/projectile generates on impact.
 	FDecalBase *DecalGenerator;
 
-	// [RH] Used to interpolate the view to get >35 FPS
-	DVector3 Prev;
-	DRotator PrevAngles;
-	int PrevPortalGroup;
 	TArray<FDynamicLight *> AttachedLights;
 	TDeletingArray<FLightDefaults *> UserLights;
 
@@ -1263,6 +1273,9 @@ public:
 	static void ClearTIDHashes ();
 	void SetTID (int newTID);
 
+	// Changes whenever an actor enters or leaves the TID hash, so lookups can be cached.
+	static unsigned TIDHashGeneration;
+
 private:
 	void AddToHash ();
 	void RemoveFromHash ();
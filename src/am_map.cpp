@@ -846,6 +846,18 @@ static double mapxstart=0; //x-value for the bitmap.
 
 static bool stopped = true;
 
+// cached floor geometry for the textured automap, see AM_BuildSubsectorCache
+struct AMSubsector
+{
+	subsector_t *sub;
+	unsigned firstpoint;
+	unsigned numpoints;
+};
+
+static TArray<AMSubsector> AMSubsectors;
+static TArray<mpoint_t> AMPoints;
+static const subsector_t *AMCachedSubsectors;
+
 static void AM_calcMinMaxMtoF();
 
 static void DrawMarker (FTexture *tex, double x, double y, int yadjust,
@@ -1396,6 +1408,9 @@ void AM_LevelInit ()
 	}
 
 	AM_clearMarks();
+	AMSubsectors.Clear();
+	AMPoints.Clear();
+	AMCachedSubsectors = nullptr;
 
 	AM_findMinMaxBoundaries();
 	scale_mtof = min_scale_mtof / 0.7;
@@ -2070,177 +2085,247 @@ sector_t * AM_FakeFlat(AActor *viewer, sector_t * sec, sector_t * dest)
 
 //=============================================================================
 //
-// AM_drawSubsectors
+// The floor geometry for the textured automap is cached per level: the
+// subsectors are sorted by sector so that everything that only depends
+// on the sector is done once per sector and the polygons of a sector
+// reach the 2D drawer in a row, where they can be batched. The vertices
+// are kept so that the segs need not be walked again each frame.
 //
 //=============================================================================
 
-void AM_drawSubsectors()
+static void AM_BuildSubsectorCache()
 {
-	static TArray<FVector2> points;
-	double scale = scale_mtof;
+	auto &subsectors = level.subsectors;
+
+	if (subsectors.Size() == 0) return;
+	if (AMCachedSubsectors == &subsectors[0] && AMSubsectors.Size() > 0) return;
+	AMCachedSubsectors = &subsectors[0];
+	AMSubsectors.Clear();
+	AMPoints.Clear();
+
+	for (auto &sub : subsectors)
+	{
+		if (!(sub.flags & SSECF_POLYORG)) AMSubsectors.Push({ &sub, 0, sub.numlines });
+	}
+	std::stable_sort(AMSubsectors.begin(), AMSubsectors.end(), [](const AMSubsector &a, const AMSubsector &b)
+	{
+		return a.sub->render_sector->sectornum < b.sub->render_sector->sectornum;
+	});
+	for (auto &ams : AMSubsectors)
+	{
+		ams.firstpoint = AMPoints.Size();
+		for (uint32_t j = 0; j < ams.numpoints; ++j)
+		{
+			AMPoints.Push({ ams.sub->firstline[j].v1->fX(), ams.sub->firstline[j].v1->fY() });
+		}
+	}
+}
+
+//=============================================================================
+//
+// What is drawn for a sector's floor on the textured automap.
+// Returns false if it isn't drawn at all.
+//
+//=============================================================================
+
+struct AMFloor
+{
+	FTexture *pic;
 	DAngle rotation;
-	sector_t tempsec;
 	int floorlight;
 	double scalex, scaley;
 	double originx, originy;
 	FColormap colormap;
+	FColormap cheatcolormap;	// for subsectors that haven't been seen yet
 	PalEntry flatcolor;
+};
+
+static bool AM_GetFloor(sector_t *render_sector, AMFloor &floor)
+{
+	sector_t tempsec;
 	mpoint_t originpt;
 
-	auto &subsectors = level.subsectors;
-	for (unsigned i = 0; i < subsectors.Size(); ++i)
+	if ((render_sector->MoreFlags & SECMF_HIDDEN) && am_cheat == 0)
 	{
-		if (subsectors[i].flags & SSECF_POLYORG)
-		{
-			continue;
-		}
+		return false;
+	}
 
-		if ((!(subsectors[i].flags & SSECMF_DRAWN) || (subsectors[i].render_sector->MoreFlags & SECMF_HIDDEN)) && am_cheat == 0)
-		{
-			continue;
-		}
+	if (am_portaloverlay && render_sector->PortalGroup != MapPortalGroup && render_sector->PortalGroup != 0)
+	{
+		return false;
+	}
+
+	// For lighting and texture determination
+	sector_t *sec = AM_FakeFlat(players[consoleplayer].camera, render_sector, &tempsec);
+	floor.floorlight = sec->GetFloorLight();
+	// Find texture origin.
+	originpt.x = -sec->GetXOffset(sector_t::floor);
+	originpt.y = sec->GetYOffset(sector_t::floor);
+	floor.rotation = -sec->GetAngle(sector_t::floor);
+	// Coloring for the polygon
+	floor.colormap = sec->Colormap;
+
+	FTextureID maptex = sec->GetTexture(sector_t::floor);
+	floor.flatcolor = sec->SpecialColors[sector_t::floor];
+
+	floor.scalex = sec->GetXScale(sector_t::floor);
+	floor.scaley = sec->GetYScale(sector_t::floor);
+
+	if (sec->e->XFloor.ffloors.Size())
+	{
+		secplane_t *floorplane = &sec->floorplane;
+
+		// Look for the highest floor below the camera viewpoint.
+		// Check the center of the subsector's sector. Do not check each
+		// subsector separately because that might result in different planes for
+		// different subsectors of the same sector which is not wanted here.
+		// (Make the comparison in floating point to avoid overflows and improve performance.)
+		double secx;
+		double secy;
+		double seczb, seczt;
+		double cmpz = r_viewpoint.Pos.Z;
 
-		if (am_portaloverlay && subsectors[i].render_sector->PortalGroup != MapPortalGroup && subsectors[i].render_sector->PortalGroup != 0)
+		if (players[consoleplayer].camera && sec == players[consoleplayer].camera->Sector)
 		{
-			continue;
+			// For the actual camera sector use the current viewpoint as reference.
+			secx = r_viewpoint.Pos.X;
+			secy = r_viewpoint.Pos.Y;
 		}
-
-		// Fill the points array from the subsector.
-		points.Resize(subsectors[i].numlines);
-		for (uint32_t j = 0; j < subsectors[i].numlines; ++j)
+		else
 		{
-			mpoint_t pt = { subsectors[i].firstline[j].v1->fX(),
-							subsectors[i].firstline[j].v1->fY() };
-			if (am_rotate == 1 || (am_rotate == 2 && viewactive))
+			secx = sec->centerspot.X;
+			secy = sec->centerspot.Y;
+		}
+		seczb = floorplane->ZatPoint(secx, secy);
+		seczt = sec->ceilingplane.ZatPoint(secx, secy);
+
+		for (unsigned int i = 0; i < sec->e->XFloor.ffloors.Size(); ++i)
+		{
+			F3DFloor *rover = sec->e->XFloor.ffloors[i];
+			if (!(rover->flags & FF_EXISTS)) continue;
+			if (rover->flags & FF_FOG) continue;
+			if (!(rover->flags & FF_RENDERPLANES)) continue;
+			if (rover->alpha == 0) continue;
+			double roverz = rover->top.plane->ZatPoint(secx, secy);
+			// Ignore 3D floors that are above or below the sector itself:
+			// they are hidden. Since 3D floors are sorted top to bottom,
+			// if we get below the sector floor, we can stop.
+			if (roverz > seczt) continue;
+			if (roverz < seczb) break;
+			if (roverz < cmpz)
 			{
-				AM_rotatePoint(&pt.x, &pt.y);
+				maptex = *(rover->top.texture);
+				floor.flatcolor = *(rover->top.flatcolor);
+				floorplane = rover->top.plane;
+				sector_t *model = rover->top.model;
+				int selector = (rover->flags & FF_INVERTPLANES) ? sector_t::floor : sector_t::ceiling;
+				floor.rotation = -model->GetAngle(selector);
+				floor.scalex = model->GetXScale(selector);
+				floor.scaley = model->GetYScale(selector);
+				originpt.x = -model->GetXOffset(selector);
+				originpt.y = model->GetYOffset(selector);
+				break;
 			}
-			points[j].X = float(f_x + ((pt.x - m_x) * scale));
-			points[j].Y = float(f_y + (f_h - (pt.y - m_y) * scale));
 		}
-		// For lighting and texture determination
-		sector_t *sec = AM_FakeFlat(players[consoleplayer].camera, subsectors[i].render_sector, &tempsec);
-		floorlight = sec->GetFloorLight();
-		// Find texture origin.
-		originpt.x = -sec->GetXOffset(sector_t::floor);
-		originpt.y = sec->GetYOffset(sector_t::floor);
-		rotation = -sec->GetAngle(sector_t::floor);
-		// Coloring for the polygon
-		colormap = sec->Colormap;
-
-		FTextureID maptex = sec->GetTexture(sector_t::floor);
-		flatcolor = sec->SpecialColors[sector_t::floor];
-
-		scalex = sec->GetXScale(sector_t::floor);
-		scaley = sec->GetYScale(sector_t::floor);
-
-		if (sec->e->XFloor.ffloors.Size())
-		{
-			secplane_t *floorplane = &sec->floorplane;
-
-			// Look for the highest floor below the camera viewpoint.
-			// Check the center of the subsector's sector. Do not check each
-			// subsector separately because that might result in different planes for
-			// different subsectors of the same sector which is not wanted here.
-			// (Make the comparison in floating point to avoid overflows and improve performance.)
-			double secx;
-			double secy;
-			double seczb, seczt;
-			double cmpz = r_viewpoint.Pos.Z;
-
-			if (players[consoleplayer].camera && sec == players[consoleplayer].camera->Sector)
-			{
-				// For the actual camera sector use the current viewpoint as reference.
-				secx = r_viewpoint.Pos.X;
-				secy = r_viewpoint.Pos.Y;
-			}
-			else
-			{
-				secx = sec->centerspot.X;
-				secy = sec->centerspot.Y;
-			}
-			seczb = floorplane->ZatPoint(secx, secy);
-			seczt = sec->ceilingplane.ZatPoint(secx, secy);
 
-			for (unsigned int i = 0; i < sec->e->XFloor.ffloors.Size(); ++i)
-			{
-				F3DFloor *rover = sec->e->XFloor.ffloors[i];
-				if (!(rover->flags & FF_EXISTS)) continue;
-				if (rover->flags & FF_FOG) continue;
-				if (!(rover->flags & FF_RENDERPLANES)) continue;
-				if (rover->alpha == 0) continue;
-				double roverz = rover->top.plane->ZatPoint(secx, secy);
-				// Ignore 3D floors that are above or below the sector itself:
-				// they are hidden. Since 3D floors are sorted top to bottom,
-				// if we get below the sector floor, we can stop.
-				if (roverz > seczt) continue;
-				if (roverz < seczb) break;
-				if (roverz < cmpz)
-				{
-					maptex = *(rover->top.texture);
-					flatcolor = *(rover->top.flatcolor);
-					floorplane = rover->top.plane;
-					sector_t *model = rover->top.model;
-					int selector = (rover->flags & FF_INVERTPLANES) ? sector_t::floor : sector_t::ceiling;
-					rotation = -model->GetAngle(selector);
-					scalex = model->GetXScale(selector);
-					scaley = model->GetYScale(selector);
-					originpt.x = -model->GetXOffset(selector);
-					originpt.y = model->GetYOffset(selector);
-					break;
-				}
-			}
+		lightlist_t *light = P_GetPlaneLight(sec, floorplane, false);
+		floor.floorlight = *light->p_lightlevel;
+		floor.colormap = light->extra_colormap;
+	}
+	if (maptex == skyflatnum)
+	{
+		return false;
+	}
+	floor.pic = TexMan(maptex);
+	if (floor.pic == NULL || floor.pic->UseType == ETextureType::Null)
+	{
+		return false;
+	}
 
-			lightlist_t *light = P_GetPlaneLight(sec, floorplane, false);
-			floorlight = *light->p_lightlevel;
-			colormap = light->extra_colormap;
-		}
-		if (maptex == skyflatnum)
+	// Apply the floor's rotation to the texture origin.
+	if (floor.rotation != 0)
+	{
+		AM_rotate(&originpt.x, &originpt.y, floor.rotation);
+	}
+	// Apply the automap's rotation to the texture origin.
+	if (am_rotate == 1 || (am_rotate == 2 && viewactive))
+	{
+		floor.rotation = floor.rotation + 90. - players[consoleplayer].camera->Angles.Yaw;
+		AM_rotatePoint(&originpt.x, &originpt.y);
+	}
+	floor.originx = f_x + ((originpt.x - m_x) * scale_mtof);
+	floor.originy = f_y + (f_h - (originpt.y - m_y) * scale_mtof);
+
+	// If a subsector has not actually been seen yet (because you are cheating
+	// to see it on the map), tint and desaturate it.
+	floor.cheatcolormap = floor.colormap;
+	floor.cheatcolormap.LightColor = PalEntry(
+		(floor.colormap.LightColor.r + 255) / 2,
+		(floor.colormap.LightColor.g + 200) / 2,
+		(floor.colormap.LightColor.b + 160) / 2);
+	floor.cheatcolormap.Desaturation = 255 - (255 - floor.colormap.Desaturation) / 4;
+	return true;
+}
+
+//=============================================================================
+//
+// AM_drawSubsectors
+//
+//=============================================================================
+
+void AM_drawSubsectors()
+{
+	static TArray<FVector2> points;
+	double scale = scale_mtof;
+	bool rotate = am_rotate == 1 || (am_rotate == 2 && viewactive);
+	sector_t *lastsector = nullptr;
+	bool drawsector = false;
+	AMFloor floor;
+
+	AM_BuildSubsectorCache();
+	for (auto &ams : AMSubsectors)
+	{
+		subsector_t *sub = ams.sub;
+
+		if (!(sub->flags & SSECMF_DRAWN) && am_cheat == 0)
 		{
 			continue;
 		}
-
-		// Apply the floor's rotation to the texture origin.
-		if (rotation != 0)
+		if (sub->render_sector != lastsector)
 		{
-			AM_rotate(&originpt.x, &originpt.y, rotation);
+			lastsector = sub->render_sector;
+			drawsector = AM_GetFloor(lastsector, floor);
 		}
-		// Apply the automap's rotation to the texture origin.
-		if (am_rotate == 1 || (am_rotate == 2 && viewactive))
+		if (!drawsector)
 		{
-			rotation = rotation + 90. - players[consoleplayer].camera->Angles.Yaw;
-			AM_rotatePoint(&originpt.x, &originpt.y);
+			continue;
 		}
-		originx = f_x + ((originpt.x - m_x) * scale);
-		originy = f_y + (f_h - (originpt.y - m_y) * scale);
 
-		// If this subsector has not actually been seen yet (because you are cheating
-		// to see it on the map), tint and desaturate it.
-		if (!(subsectors[i].flags & SSECMF_DRAWN))
+		// Fill the points array from the subsector.
+		points.Resize(ams.numpoints);
+		for (uint32_t j = 0; j < ams.numpoints; ++j)
 		{
-			colormap.LightColor = PalEntry(
-				(colormap.LightColor.r + 255) / 2,
-				(colormap.LightColor.g + 200) / 2,
-				(colormap.LightColor.b + 160) / 2);
-			colormap.Desaturation = 255 - (255 - colormap.Desaturation) / 4;
+			mpoint_t pt = AMPoints[ams.firstpoint + j];
+			if (rotate)
+			{
+				AM_rotatePoint(&pt.x, &pt.y);
+			}
+			points[j].X = float(f_x + ((pt.x - m_x) * scale));
+			points[j].Y = float(f_y + (f_h - (pt.y - m_y) * scale));
 		}
 
 		// Draw the polygon.
-		FTexture *pic = TexMan(maptex);
-		if (pic != NULL && pic->UseType != ETextureType::Null)
-		{
-			screen->FillSimplePoly(TexMan(maptex),
-				&points[0], points.Size(),
-				originx, originy,
-				scale / scalex,
-				scale / scaley,
-				rotation,
-				colormap,
-				flatcolor,
-				floorlight,
-				f_y + f_h
-				);
-		}
+		screen->FillSimplePoly(floor.pic,
+			&points[0], points.Size(),
+			floor.originx, floor.originy,
+			scale / floor.scalex,
+			scale / floor.scaley,
+			floor.rotation,
+			(sub->flags & SSECMF_DRAWN) ? floor.colormap : floor.cheatcolormap,
+			floor.flatcolor,
+			floor.floorlight,
+			f_y + f_h
+			);
 	}
 }
 
@@ -2611,6 +2696,14 @@ void AM_drawWalls (bool allmap)
 				AM_rotatePoint(&l.b.x, &l.b.y);
 			}
 
+			// The same trivial reject as in AM_clipMline, but done before working out
+			// the line's color, which is the expensive part when zoomed in on a big map.
+			if (MIN(l.a.y, l.b.y) > m_y2 || MAX(l.a.y, l.b.y) < m_y ||
+				MIN(l.a.x, l.b.x) > m_x2 || MAX(l.a.x, l.b.x) < m_x)
+			{
+				continue;
+			}
+
 			if (am_cheat != 0 || (line.flags & ML_MAPPED))
 			{
 				if ((line.flags & ML_DONTDRAW) && (am_cheat == 0 || am_cheat >= 4))
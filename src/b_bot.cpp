@@ -94,6 +94,8 @@ void DBot::Clear ()
 	allround = false;
 	increase = false;
 	old = { 0, 0 };
+	numsightcache = 0;
+	cachesight = false;
 }
 
 FSerializer &Serialize(FSerializer &arc, const char *key, botskill_t &skill, botskill_t *def)
@@ -147,13 +149,18 @@ void DBot::Tick ()
 
 	BotThinkCycles.Clock();
 	bglobal.m_Thinking = true;
+	numsightcache = 0;
+	cachesight = true;
 	Think ();
+	cachesight = false;
 	bglobal.m_Thinking = false;
 	BotThinkCycles.Unclock();
 }
 
 CVAR (Int, bot_next_color, 11, 0)
 CVAR (Bool, bot_observer, false, 0)
+// A bot that can still see its enemy only looks for a better one every this many tics.
+CVAR (Int, bot_enemyscan, 1, CVAR_SERVERINFO)
 
 CCMD (addbot)
 {
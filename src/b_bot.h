@@ -177,6 +177,7 @@ public:
 
 	//(b_func.cpp)
 	bool Check_LOS (AActor *to, DAngle vangle);
+	bool CheckSight (AActor *to, int flags);
 
 	player_t	*player;
 	DAngle		Angle;		// The wanted angle that the bot try to get every tic.
@@ -212,6 +213,17 @@ public:
 
 	DVector2	old;
 
+	// Sight checks done during the current Think call. Not saved.
+	struct SightResult
+	{
+		AActor	*target;
+		int		flags;
+		bool	result;
+	};
+	SightResult	sightcache[8];
+	unsigned	numsightcache;
+	bool		cachesight;
+
 private:
 	//(b_think.cpp)
 	void Think ();
@@ -246,5 +258,6 @@ EXTERN_CVAR (Int, bot_maxcorpses)
 EXTERN_CVAR (Bool, bot_observer)
 EXTERN_CVAR (Bool, bot_watersplash)
 EXTERN_CVAR (Bool, bot_chat)
+EXTERN_CVAR (Int, bot_enemyscan)
 
 #endif	// __B_BOT_H__
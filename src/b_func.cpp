@@ -155,7 +155,7 @@ bool DBot::Reachable (AActor *rtarget)
 //in doom is 90 degrees infront.
 bool DBot::Check_LOS (AActor *to, DAngle vangle)
 {
-	if (!P_CheckSight (player->mo, to, SF_SEEPASTBLOCKEVERYTHING))
+	if (!CheckSight (to, SF_SEEPASTBLOCKEVERYTHING))
 		return false; // out of sight
 	if (vangle >= 360.)
 		return true;
@@ -165,6 +165,27 @@ bool DBot::Check_LOS (AActor *to, DAngle vangle)
 	return absangle(player->mo->AngleTo(to), player->mo->Angles.Yaw) <= (vangle/2);
 }
 
+//Sight check from the bot to a target. The same targets get checked
+//several times per tic, and nothing a sight check depends on is moved
+//while the bot thinks, so the results are kept until Think returns.
+bool DBot::CheckSight (AActor *to, int flags)
+{
+	if (!cachesight)
+		return P_CheckSight (player->mo, to, flags);
+
+	for (unsigned i = 0; i < numsightcache; i++)
+	{
+		if (sightcache[i].target == to && sightcache[i].flags == flags)
+			return sightcache[i].result;
+	}
+	bool result = P_CheckSight (player->mo, to, flags);
+	if (numsightcache < countof(sightcache))
+	{
+		sightcache[numsightcache++] = { to, flags, result };
+	}
+	return result;
+}
+
 //-------------------------------------
 //Bot_Dofire()
 //-------------------------------------
@@ -390,7 +411,7 @@ AActor *DBot::Choose_Mate ()
 			&& ((player->mo->health/2) <= client->mo->health || !deathmatch)
 			&& !bglobal.IsLeader(client)) //taken?
 		{
-			if (P_CheckSight (player->mo, client->mo, SF_IGNOREVISIBILITY))
+			if (CheckSight (client->mo, SF_IGNOREVISIBILITY))
 			{
 				test = client->mo->Distance2D(player->mo);
 
@@ -155,14 +155,14 @@ void DBot::ThinkForMove (ticcmd_t *cmd)
 		if (enemy && Check_LOS (enemy, SHOOTFOV)) 
 			Dofire (cmd); //Order bot to fire current weapon
 	}
-	else if (enemy && P_CheckSight (player->mo, enemy, 0)) //Fight!
+	else if (enemy && CheckSight (enemy, 0)) //Fight!
 	{
 		Pitch (enemy);
 
 		//Check if it's more important to get an item than fight.
 		if (dest && (dest->flags&MF_SPECIAL)) //Must be an item, that is close enough.
 		{
-#define is(x) dest->IsKindOf (PClass::FindClass (#x))
+#define is(x) dest->IsKindOf (NAME_##x)
 			if (
 				(
 				 (player->mo->health < skill.isp &&
@@ -313,7 +313,7 @@ void DBot::ThinkForMove (ticcmd_t *cmd)
 						dest = item;
 					}
 				}
-				else if (mate && (r < 179 || P_CheckSight(player->mo, mate)))
+				else if (mate && (r < 179 || CheckSight(mate, 0)))
 				{
 					dest = mate;
 				}
@@ -381,7 +381,7 @@ void DBot::WhatToGet (AActor *item)
 			}
 		}
 	}
-	else if (item->IsKindOf (PClass::FindActor(NAME_Ammo)))
+	else if (item->IsKindOf (NAME_Ammo))
 	{
 		auto ac = PClass::FindActor(NAME_Ammo);
 		auto parent = item->GetClass();
@@ -423,7 +423,7 @@ void DBot::Set_enemy ()
 
 	if (enemy
 		&& enemy->health > 0
-		&& P_CheckSight (player->mo, enemy))
+		&& CheckSight (enemy, 0))
 	{
 		oldenemy = enemy;
 	}
@@ -434,7 +434,10 @@ void DBot::Set_enemy ()
 
 	// [RH] Don't even bother looking for a different enemy if this is not deathmatch
 	// and we already have an existing enemy.
-	if (deathmatch || !enemy)
+	// A visible enemy is only reconsidered every bot_enemyscan tics, with the bots
+	// spread evenly over the interval.
+	if ((deathmatch || !enemy) &&
+		(oldenemy == nullptr || bot_enemyscan <= 1 || (level.maptime + int(player - players)) % bot_enemyscan == 0))
 	{
 		allround = !!enemy;
 		enemy = Find_enemy();
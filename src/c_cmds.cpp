@@ -45,6 +45,7 @@
 
 #include "version.h"
 #include "c_console.h"
+#include "c_consolebuffer.h"
 #include "c_dispatch.h"
 
 #include "i_system.h"
@@ -73,6 +74,8 @@
 #include "r_data/r_interpolate.h"
 #include "c_functions.h"
 #include "g_levellocals.h"
+#include "tflatmap.h"
+#include "stats.h"
 
 extern FILE *Logfile;
 extern bool insave;
@@ -523,6 +526,7 @@ UNSAFE_CCMD (logfile)
 	{
 		const char *timestr = myasctime();
 		Printf("Log stopped: %s\n", timestr);
+		LogWriter.Flush();
 		fclose (Logfile);
 		Logfile = NULL;
 	}
@@ -1534,6 +1538,66 @@ CCMD(angleconvtest)
 	}
 }
 
+//==========================================================================
+//
+// Compares TMap and TFlatMap on inserting, finding, missing and removing
+// the given number of keys.
+//
+//==========================================================================
+
+template<class MapType> static void BenchMap(const char *name, const TArray<int> &keys)
+{
+	cycle_t insert, hit, miss, remove;
+	insert.Reset(); hit.Reset(); miss.Reset(); remove.Reset();
+	int found = 0;
+	{
+		MapType map;
+		insert.Clock();
+		for (auto key : keys) map.Insert(key, key);
+		insert.Unclock();
+
+		hit.Clock();
+		for (int pass = 0; pass < 8; pass++)
+		{
+			for (auto key : keys) found += map.CheckKey(key) != nullptr;
+		}
+		hit.Unclock();
+
+		miss.Clock();
+		for (int pass = 0; pass < 8; pass++)
+		{
+			for (auto key : keys) found += map.CheckKey(~key) != nullptr;
+		}
+		miss.Unclock();
+
+		remove.Clock();
+		for (auto key : keys) map.Remove(key);
+		remove.Unclock();
+	}
+	Printf("%-8s insert %7.3f ms  hit %7.3f ms  miss %7.3f ms  remove %7.3f ms  (%d found)\n",
+		name, insert.TimeMS(), hit.TimeMS(), miss.TimeMS(), remove.TimeMS(), found);
+}
+
+CCMD(benchmaps)
+{
+	int count = argv.argc() > 1 ? atoi(argv[1]) : 10000;
+	if (count <= 0)
+	{
+		Printf("Usage: benchmaps [number of keys]\n");
+		return;
+	}
+
+	// Keys are spread out like FName indices and pointers would be in practice.
+	TArray<int> keys;
+	keys.Resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		keys[i] = i * 16 + (i & 3);
+	}
+	BenchMap<TMap<int, int>>("TMap", keys);
+	BenchMap<TFlatMap<int, int>>("TFlatMap", keys);
+}
+
 extern uint32_t r_renderercaps;
 #define PRINT_CAP(X, Y) Printf("  %-18s: %s (%s)\n", #Y, !!(r_renderercaps & Y) ? "Yes" : "No ", X);
 CCMD(r_showcaps)
@@ -926,8 +926,7 @@ int PrintString (int printlevel, const char *outline)
 		}
 		else if (Logfile != nullptr)
 		{
-			fputs(outline, Logfile);
-			fflush(Logfile);
+			LogWriter.Write(Logfile, outline);
 		}
 		return count;
 	}
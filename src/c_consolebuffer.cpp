@@ -35,7 +35,36 @@
 
 #include "c_console.h"
 #include "c_consolebuffer.h"
+#include "c_cvars.h"
+#include "templates.h"
 
+CVAR(Bool, log_async, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+FLogWriter LogWriter;
+
+//==========================================================================
+//
+// The thread is started with the first write. Anything written after
+// the writer has been shut down goes to the file directly.
+//
+//==========================================================================
+
+void FLogWriter::Write(FILE *file, const char *text)
+{
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+		if (log_async && !mQuit)
+		{
+			if (!mThread.joinable()) mThread = std::thread([this]() { Run(); });
+			mQueue.Push({ file, text });
+			mWake.notify_one();
+			return;
+		}
+	}
+	Flush();
+	fputs(text, file);
+	fflush(file);
+}
 
 //==========================================================================
 //
@@ -43,16 +72,10 @@
 //
 //==========================================================================
 
-FConsoleBuffer::FConsoleBuffer()
+void FLogWriter::Flush()
 {
-	mLogFile = NULL;
-	mAddType = NEWLINE;
-	mLastFont = NULL;
-	mLastDisplayWidth = -1;
-	mLastLineNeedsUpdate = false;
-	mTextLines = 0;
-	mBufferWasCleared = true;
-	mBrokenStart.Push(0);
+	std::unique_lock<std::mutex> lock(mLock);
+	mIdle.wait(lock, [this]() { return mQueue.Size() == 0 && !mWriting; });
 }
 
 //==========================================================================
@@ -61,9 +84,33 @@ FConsoleBuffer::FConsoleBuffer()
 //
 //==========================================================================
 
-FConsoleBuffer::~FConsoleBuffer()
+void FLogWriter::Run()
 {
-	FreeBrokenText();
+	TArray<Entry> batch;
+	std::unique_lock<std::mutex> lock(mLock);
+	for (;;)
+	{
+		mWake.wait(lock, [this]() { return mQuit || mQueue.Size() > 0; });
+		if (mQueue.Size() == 0) break;
+
+		batch = std::move(mQueue);
+		mWriting = true;
+		lock.unlock();
+
+		FILE *last = nullptr;
+		for (auto &entry : batch)
+		{
+			if (last != nullptr && last != entry.File) fflush(last);
+			fputs(entry.Text, entry.File);
+			last = entry.File;
+		}
+		if (last != nullptr) fflush(last);
+		batch.Clear();
+
+		lock.lock();
+		mWriting = false;
+		mIdle.notify_all();
+	}
 }
 
 //==========================================================================
@@ -72,14 +119,32 @@ FConsoleBuffer::~FConsoleBuffer()
 //
 //==========================================================================
 
-void FConsoleBuffer::FreeBrokenText(unsigned start, unsigned end)
+FLogWriter::~FLogWriter()
 {
-	if (end > m_BrokenConsoleText.Size()) end = m_BrokenConsoleText.Size();
-	for (unsigned i = start; i < end; i++)
 	{
-		m_BrokenConsoleText[i].Clear();
-		m_BrokenConsoleText[i].ShrinkToFit();
+		std::unique_lock<std::mutex> lock(mLock);
+		mQuit = true;
+		mWake.notify_one();
 	}
+	if (mThread.joinable()) mThread.join();
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+FConsoleBuffer::FConsoleBuffer()
+{
+	mLogFile = NULL;
+	mAddType = NEWLINE;
+	mLastFont = NULL;
+	mLastDisplayWidth = -1;
+	mFirstChangedLine = UINT_MAX;
+	mTextLines = 0;
+	mBufferWasCleared = true;
+	mBrokenStart.Push(0);
 }
 
 //==========================================================================
@@ -103,13 +168,13 @@ void FConsoleBuffer::AddText(int printlevel, const char *text, FILE *logfile)
 	{
 		// Just wondering: Do we actually need this case? If so, it may need some work.
 		mConsoleText.Pop();	// remove the line to be replaced
-		mLastLineNeedsUpdate = true;
+		mFirstChangedLine = MIN(mFirstChangedLine, mConsoleText.Size());
 	}
 	else if (mAddType == APPENDLINE)
 	{
 		mConsoleText.Pop(build);
 		printlevel = -1;
-		mLastLineNeedsUpdate = true;
+		mFirstChangedLine = MIN(mFirstChangedLine, mConsoleText.Size());
 	}
 	
 	if (printlevel >= 0 && printlevel != PRINT_HIGH)
@@ -193,8 +258,7 @@ void FConsoleBuffer::WriteLineToLog(FILE *LogFile, const char *outline)
 	}
 	*dstp=0;
 
-	fputs (copy.Data(), LogFile);
-	fflush (LogFile);
+	LogWriter.Write(LogFile, copy.Data());
 }
 
 //==========================================================================
@@ -222,7 +286,7 @@ void FConsoleBuffer::WriteContentToLog(FILE *LogFile)
 
 void FConsoleBuffer::Linefeed(FILE *Logfile)
 {
-	if (mAddType != NEWLINE && Logfile != NULL) fputc('\n', Logfile);
+	if (mAddType != NEWLINE && Logfile != NULL) LogWriter.Write(Logfile, "\n");
 	mAddType = NEWLINE;
 }
 
@@ -251,6 +315,8 @@ void FConsoleBuffer::AddMidText(const char *string, bool bold, FILE *Logfile)
 //==========================================================================
 //
 // Format the text for output
+// Only lines that were added or changed since the last call get broken
+// up. Everything is done again if the font or the width changes.
 //
 //==========================================================================
 
@@ -258,10 +324,6 @@ void FConsoleBuffer::FormatText(FFont *formatfont, int displaywidth)
 {
 	if (formatfont != mLastFont || displaywidth != mLastDisplayWidth || mBufferWasCleared)
 	{
-		FreeBrokenText();
-		if (mBufferWasCleared)
-			mLastLineNeedsUpdate = false;
-		m_BrokenConsoleText.Clear();
 		mBrokenStart.Clear();
 		mBrokenStart.Push(0);
 		mBrokenLines.Clear();
@@ -269,22 +331,14 @@ void FConsoleBuffer::FormatText(FFont *formatfont, int displaywidth)
 		mLastDisplayWidth = displaywidth;
 		mBufferWasCleared = false;
 	}
-	unsigned brokensize = m_BrokenConsoleText.Size();
-	if (brokensize == mConsoleText.Size())
-	{
-		// The last line got text appended. 
-		if (mLastLineNeedsUpdate)
-		{
-			brokensize--;
-			m_BrokenConsoleText.Resize(brokensize);
-		}
-	}
+	unsigned brokensize = mBrokenStart.Size() - 1;
+	brokensize = MIN(brokensize, MIN(mFirstChangedLine, mConsoleText.Size()));
+
 	mBrokenLines.Resize(mBrokenStart[brokensize]);
 	mBrokenStart.Resize(brokensize);
 	for (unsigned i = brokensize; i < mConsoleText.Size(); i++)
 	{
 		auto bl = V_BreakLines(formatfont, displaywidth, mConsoleText[i], true);
-		m_BrokenConsoleText.Push(bl);
 		mBrokenStart.Push(mBrokenLines.Size());
 		for(auto &bline : bl)
 		{
@@ -293,12 +347,14 @@ void FConsoleBuffer::FormatText(FFont *formatfont, int displaywidth)
 	}
 	mTextLines = mBrokenLines.Size();
 	mBrokenStart.Push(mTextLines);
-	mLastLineNeedsUpdate = false;
+	mFirstChangedLine = UINT_MAX;
 }
 
 //==========================================================================
 //
 // Delete old content if number of lines gets too large
+// The formatted text of the deleted lines is removed along with them so
+// that a full buffer doesn't have to be formatted again every frame.
 //
 //==========================================================================
 
@@ -308,7 +364,21 @@ void FConsoleBuffer::ResizeBuffer(unsigned newsize)
 	{
 		unsigned todelete = mConsoleText.Size() - newsize;
 		mConsoleText.Delete(0, todelete);
-		mBufferWasCleared = true;
+
+		unsigned formatted = mBrokenStart.Size() - 1;
+		if (todelete >= formatted || todelete >= mFirstChangedLine)
+		{
+			mBufferWasCleared = true;
+			mFirstChangedLine = UINT_MAX;
+		}
+		else
+		{
+			unsigned firstkept = mBrokenStart[todelete];
+			mBrokenLines.Delete(0, firstkept);
+			mBrokenStart.Delete(0, todelete);
+			for (auto &start : mBrokenStart) start -= firstkept;
+			mTextLines = mBrokenLines.Size();
+			if (mFirstChangedLine != UINT_MAX) mFirstChangedLine -= todelete;
+		}
 	}
 }
-
@@ -35,6 +35,9 @@
 
 #include <limits.h>
 #include <stdio.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "zstring.h"
 #include "tarray.h"
 #include "v_text.h"
@@ -46,11 +49,44 @@ enum EAddType
 	REPLACELINE
 };
 
+//==========================================================================
+//
+// Writes the log file on a background thread so that heavy console output
+// doesn't have to wait for the disk. Text is written in the order it was
+// queued and the file is flushed once per batch.
+//
+//==========================================================================
+
+class FLogWriter
+{
+	struct Entry
+	{
+		FILE *File;
+		FString Text;
+	};
+
+	std::mutex mLock;
+	std::condition_variable mWake;
+	std::condition_variable mIdle;
+	std::thread mThread;
+	TArray<Entry> mQueue;
+	bool mWriting = false;
+	bool mQuit = false;
+
+	void Run();
+
+public:
+	~FLogWriter();
+	void Write(FILE *file, const char *text);
+	void Flush();	// waits until everything queued so far is in the file
+};
+
+extern FLogWriter LogWriter;
+
 class FConsoleBuffer
 {
 	TArray<FString> mConsoleText;
-	TArray<TArray<FBrokenLines>> m_BrokenConsoleText;	// This holds the structures returned by V_BreakLines and is used for memory management.
-	TArray<unsigned int> mBrokenStart;		
+	TArray<unsigned int> mBrokenStart;		// for each formatted line of mConsoleText where its part of mBrokenLines starts, plus the end.
 	TArray<FBrokenLines> mBrokenLines;		// This holds the single lines, indexed by mBrokenStart and is used for printing.
 	FILE * mLogFile;
 	EAddType mAddType;
@@ -59,16 +95,14 @@ class FConsoleBuffer
 	
 	FFont *mLastFont;
 	int mLastDisplayWidth;
-	bool mLastLineNeedsUpdate;
+	unsigned int mFirstChangedLine;		// lines from here on were replaced after they got formatted.
 
 	void WriteLineToLog(FILE *LogFile, const char *outline);
-	void FreeBrokenText(unsigned int start = 0, unsigned int end = INT_MAX);
 
 	void Linefeed(FILE *Logfile);
 	
 public:
 	FConsoleBuffer();
-	~FConsoleBuffer();
 	void AddText(int printlevel, const char *string, FILE *logfile = NULL);
 	void AddMidText(const char *string, bool bold, FILE *logfile);
 	void FormatText(FFont *formatfont, int displaywidth);
@@ -58,6 +58,7 @@
 
 #include "w_wad.h"
 #include "version.h"
+#include "superfasthash.h"
 
 #define SHOULD_BLACKLIST(name) \
 	if (#name[0]==CurrentFindCVar[0]) \
@@ -79,6 +80,10 @@ bool FBaseCVar::m_UseCallback = false;
 
 FBaseCVar *CVars = NULL;
 
+// All named cvars, hashed by name. The cvars are constructed during
+// static initialization, so this must not be anything with a constructor.
+FBaseCVar *FBaseCVar::CVarHash[FBaseCVar::HASH_SIZE];
+
 int cvar_defflags;
 
 FBaseCVar::FBaseCVar (const char *var_name, uint32_t flags, void (*callback)(FBaseCVar &))
@@ -111,6 +116,13 @@ FBaseCVar::FBaseCVar (const char *var_name, uint32_t flags, void (*callback)(FBa
 		Name = copystring (var_name);
 		m_Next = CVars;
 		CVars = this;
+
+		FBaseCVar **bucket = &CVarHash[MakeKey (var_name) % HASH_SIZE];
+		m_NextHash = *bucket;
+		m_PrevHash = bucket;
+		if (m_NextHash)
+			m_NextHash->m_PrevHash = &m_NextHash;
+		*bucket = this;
 	}
 
 	if (var)
@@ -149,6 +161,9 @@ FBaseCVar::~FBaseCVar ()
 			else
 				CVars = m_Next;
 		}
+		*m_PrevHash = m_NextHash;
+		if (m_NextHash)
+			m_NextHash->m_PrevHash = m_PrevHash;
 		C_RemoveTabCommand(Name);
 		delete[] Name;
 	}
@@ -1640,13 +1655,20 @@ void C_ForgetCVars (void)
 FBaseCVar *FindCVar (const char *var_name, FBaseCVar **prev)
 {
 	FBaseCVar *var;
-	FBaseCVar *dummy;
 
 	if (var_name == NULL)
 		return NULL;
 
 	if (prev == NULL)
-		prev = &dummy;
+	{
+		// Nobody needs the list predecessor, so the hash can be used.
+		var = FBaseCVar::CVarHash[MakeKey (var_name) % FBaseCVar::HASH_SIZE];
+		while (var != NULL && stricmp (var->GetName (), var_name) != 0)
+		{
+			var = var->m_NextHash;
+		}
+		return var;
+	}
 
 	var = CVars;
 	*prev = NULL;
@@ -1682,7 +1704,7 @@ FBaseCVar *FindCVarSub (const char *var_name, int namelen)
 	if (var_name == NULL)
 		return NULL;
 
-	var = CVars;
+	var = FBaseCVar::CVarHash[MakeKey (var_name, namelen) % FBaseCVar::HASH_SIZE];
 	while (var)
 	{
 		const char *probename = var->GetName ();
@@ -1692,7 +1714,7 @@ FBaseCVar *FindCVarSub (const char *var_name, int namelen)
 		{
 			break;
 		}
-		var = var->m_Next;
+		var = var->m_NextHash;
 	}
 	return var;
 }
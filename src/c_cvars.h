@@ -172,6 +172,10 @@ private:
 
 	void (*m_Callback)(FBaseCVar &);
 	FBaseCVar *m_Next;
+	FBaseCVar *m_NextHash, **m_PrevHash;	// chain in CVarHash, newest first
+
+	enum { HASH_SIZE = 1021 };
+	static FBaseCVar *CVarHash[HASH_SIZE];
 
 	static bool m_UseCallback;
 	static bool m_DoNoSet;
@@ -812,14 +812,11 @@ bool FConfigFile::WriteConfigFile () const
 		return true;
 	}
 
-	FileWriter *file = FileWriter::Open (PathName);
+	BufferWriter header, body;
 	FConfigSection *section;
 	FConfigEntry *entry;
 
-	if (file == NULL)
-		return false;
-
-	WriteCommentHeader (file);
+	WriteCommentHeader (&header);
 
 	section = Sections;
 	while (section != NULL)
@@ -827,28 +824,77 @@ bool FConfigFile::WriteConfigFile () const
 		entry = section->RootEntry;
 		if (section->Note.IsNotEmpty())
 		{
-			file->Write (section->Note.GetChars(), section->Note.Len());
+			body.Write (section->Note.GetChars(), section->Note.Len());
 		}
-		file->Printf ("[%s]\n", section->SectionName.GetChars());
+		body.Printf ("[%s]\n", section->SectionName.GetChars());
 		while (entry != NULL)
 		{
 			if (strpbrk(entry->Value, "\r\n") == NULL)
 			{ // Single-line value
-				file->Printf ("%s=%s\n", entry->Key, entry->Value);
+				body.Printf ("%s=%s\n", entry->Key, entry->Value);
 			}
 			else
 			{ // Multi-line value
 				const char *endtag = GenerateEndTag(entry->Value);
-				file->Printf ("%s=<<<%s\n%s\n>>>%s\n", entry->Key,
+				body.Printf ("%s=<<<%s\n%s\n>>>%s\n", entry->Key,
 					endtag, entry->Value, endtag);
 			}
 			entry = entry->Next;
 		}
 		section = section->Next;
-		file->Write ("\n", 1);
+		body.Write ("\n", 1);
 	}
+
+	if (IsUnchanged (*header.GetBuffer(), *body.GetBuffer()))
+	{
+		return true;
+	}
+
+	FileWriter *file = FileWriter::Open (PathName);
+	if (file == NULL)
+		return false;
+
+	bool success = file->Write (header.GetBuffer()->Data(), header.GetBuffer()->Size()) == header.GetBuffer()->Size() &&
+		file->Write (body.GetBuffer()->Data(), body.GetBuffer()->Size()) == body.GetBuffer()->Size();
 	delete file;
-	return true;
+	return success;
+}
+
+//====================================================================
+//
+// FConfigFile :: IsUnchanged
+//
+// Checks if the file on disk already has this content. The header is
+// only compared by its number of lines, since it may hold a time stamp.
+//
+//====================================================================
+
+bool FConfigFile::IsUnchanged (const TArray<unsigned char> &header, const TArray<unsigned char> &body) const
+{
+	FileReader fr;
+	if (!fr.OpenFile (PathName))
+	{
+		return false;
+	}
+	auto size = fr.GetLength ();
+	if (size < (long)body.Size())
+	{
+		return false;
+	}
+	TArray<unsigned char> old((unsigned)size, true);
+	if (fr.Read (old.Data(), size) != size)
+	{
+		return false;
+	}
+
+	unsigned pos = 0;
+	for (auto c : header)
+	{
+		if (c != '\n') continue;
+		while (pos < old.Size() && old[pos] != '\n') pos++;
+		if (pos++ == old.Size()) return false;
+	}
+	return old.Size() - pos == body.Size() && memcmp (&old[pos], body.Data(), body.Size()) == 0;
 }
 
 //====================================================================
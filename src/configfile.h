@@ -79,6 +79,7 @@ protected:
 	virtual char *ReadLine (char *string, int n, void *file) const;
 	bool ReadConfig (void *file);
 	static const char *GenerateEndTag(const char *value);
+	bool IsUnchanged (const TArray<unsigned char> &header, const TArray<unsigned char> &body) const;
 	void RenameSection(const char *oldname, const char *newname) const;
 
 	bool OkayToWrite;
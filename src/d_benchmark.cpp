@@ -0,0 +1,432 @@
+/*
+** d_benchmark.cpp
+** Scripted benchmark runs
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**---------------------------------------------------------------------------
+**
+** A benchmark suite is a text file like this:
+**
+**   seconds 10
+**   backends software truecolor poly
+**   scene MAP01
+**   scene MAP07 1056 -512 0 90 spin
+**
+** Every scene is run for the given number of seconds with each backend.
+** If a position and angle are given the player is held there, 'spin' turns
+** the view once around during the run. The backends are gl, software,
+** truecolor and poly. Switching between OpenGL and software needs a
+** restart, so backends for the renderer that is not active are skipped.
+**
+** 'benchmark <suite> [output]' runs it from the console, -benchmark <suite>
+** with optional -benchmarkout <file> runs it after startup and quits when
+** done. Results are written as JSON, benchmark.json by default.
+**
+*/
+
+#include <chrono>
+#include <algorithm>
+
+#include "d_main.h"
+#include "d_event.h"
+#include "c_dispatch.h"
+#include "c_cvars.h"
+#include "m_argv.h"
+#include "sc_man.h"
+#include "files.h"
+#include "stats.h"
+#include "g_level.h"
+#include "doomstat.h"
+#include "g_levellocals.h"
+#include "d_player.h"
+#include "actor.h"
+#include "m_alloc.h"
+#include "dobjgc.h"
+#include "version.h"
+
+EXTERN_CVAR(Bool, swtruecolor)
+EXTERN_CVAR(Bool, r_polyrenderer)
+
+extern int currentrenderer;
+extern cycle_t ThinkCycles;
+extern cycle_t VMCycles[10];
+
+enum EBenchBackend
+{
+	BENCH_GL,
+	BENCH_Software,
+	BENCH_Truecolor,
+	BENCH_Poly,
+	NUM_BENCH_BACKENDS
+};
+
+static const char *BenchBackendNames[] = { "gl", "software", "truecolor", "poly" };
+
+struct FBenchScene
+{
+	FString Map;
+	bool HasPosition = false;
+	bool Spin = false;
+	DVector3 Pos;
+	double Angle = 0;
+};
+
+struct FBenchResult
+{
+	FString Map;
+	int Backend;
+	TArray<double> FrameMS;
+	double ThinkMS = 0, ThinkMaxMS = 0;
+	double VMMS = 0;
+	int Tics = 0;
+	size_t PeakAllocBytes = 0;
+	size_t PeakTextureBytes = 0;
+};
+
+enum EBenchState
+{
+	BS_Idle,
+	BS_Loading,
+	BS_Warmup,
+	BS_Measuring
+};
+
+static TArray<FBenchScene> BenchScenes;
+static TArray<int> BenchBackends;
+static TArray<FBenchResult> BenchResults;
+static FString BenchOutput;
+static double BenchSeconds;
+static bool BenchQuit;
+static EBenchState BenchState = BS_Idle;
+static unsigned BenchRun;		// scene * numbackends + backend
+static uint64_t BenchStateStart, BenchLastFrame;
+static int BenchLastTic;
+static double BenchLastVM;
+static bool SavedTruecolor, SavedPoly;
+
+static const double BenchWarmupSeconds = 2;
+
+static uint64_t BenchTimeNS()
+{
+	using namespace std::chrono;
+	return (uint64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+static bool ParseBenchSuite(const char *filename)
+{
+	FScanner sc;
+	if (!sc.OpenFile(filename))
+	{
+		Printf("Could not open %s\n", filename);
+		return false;
+	}
+
+	BenchScenes.Clear();
+	BenchBackends.Clear();
+	BenchSeconds = 10;
+	while (sc.GetString())
+	{
+		if (sc.Compare("seconds"))
+		{
+			sc.MustGetFloat();
+			BenchSeconds = MAX(sc.Float, 1.);
+		}
+		else if (sc.Compare("backends"))
+		{
+			while (sc.CheckString("gl") || sc.CheckString("software") || sc.CheckString("truecolor") || sc.CheckString("poly"))
+			{
+				for (int i = 0; i < NUM_BENCH_BACKENDS; i++)
+				{
+					if (sc.Compare(BenchBackendNames[i]) && BenchBackends.Find(i) == BenchBackends.Size()) BenchBackends.Push(i);
+				}
+			}
+		}
+		else if (sc.Compare("scene"))
+		{
+			FBenchScene scene;
+			sc.MustGetString();
+			scene.Map = sc.String;
+			if (sc.CheckFloat())
+			{
+				scene.HasPosition = true;
+				scene.Pos.X = sc.Float;
+				sc.MustGetFloat();
+				scene.Pos.Y = sc.Float;
+				sc.MustGetFloat();
+				scene.Pos.Z = sc.Float;
+				sc.MustGetFloat();
+				scene.Angle = sc.Float;
+				scene.Spin = sc.CheckString("spin");
+			}
+			BenchScenes.Push(scene);
+		}
+		else
+		{
+			sc.ScriptError("Unknown benchmark keyword '%s'", sc.String);
+		}
+	}
+	if (BenchBackends.Size() == 0)
+	{
+		BenchBackends.Push(currentrenderer == 1 ? BENCH_GL : BENCH_Software);
+	}
+	return true;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+static bool BackendAvailable(int backend)
+{
+	return (backend == BENCH_GL) == (currentrenderer == 1);
+}
+
+static void SetBackend(int backend)
+{
+	if (backend == BENCH_GL) return;
+	swtruecolor = backend == BENCH_Truecolor;
+	r_polyrenderer = backend == BENCH_Poly;
+}
+
+static double Percentile(TArray<double> &sorted, double fraction)
+{
+	if (sorted.Size() == 0) return 0;
+	unsigned index = MIN(unsigned(sorted.Size() * fraction), sorted.Size() - 1);
+	return sorted[index];
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+static void WriteBenchResults()
+{
+	FileWriter *fw = FileWriter::Open(BenchOutput);
+	if (fw == nullptr)
+	{
+		Printf("Could not write %s\n", BenchOutput.GetChars());
+		return;
+	}
+
+	fw->Printf("{\n\t\"engine\": \"%s\",\n\t\"seconds\": %g,\n\t\"results\": [\n", GetVersionString(), BenchSeconds);
+	for (unsigned i = 0; i < BenchResults.Size(); i++)
+	{
+		auto &res = BenchResults[i];
+		TArray<double> sorted = res.FrameMS;
+		std::sort(sorted.begin(), sorted.end());
+		double total = 0;
+		for (auto ms : sorted) total += ms;
+		double avg = sorted.Size() > 0 ? total / sorted.Size() : 0;
+		int tics = MAX(res.Tics, 1);
+
+		fw->Printf("\t\t{ \"map\": \"%s\", \"backend\": \"%s\", \"frames\": %u, "
+			"\"frame_min_ms\": %.3f, \"frame_avg_ms\": %.3f, \"frame_p99_ms\": %.3f, \"frame_max_ms\": %.3f, "
+			"\"tics\": %d, \"think_avg_ms\": %.3f, \"think_max_ms\": %.3f, \"vm_avg_ms\": %.3f, "
+			"\"peak_alloc_bytes\": %zu, \"peak_texture_bytes\": %zu }%s\n",
+			res.Map.GetChars(), BenchBackendNames[res.Backend], sorted.Size(),
+			sorted.Size() > 0 ? sorted[0] : 0., avg, Percentile(sorted, 0.99), sorted.Size() > 0 ? sorted.Last() : 0.,
+			res.Tics, res.ThinkMS / tics, res.ThinkMaxMS, res.VMMS / tics,
+			res.PeakAllocBytes, res.PeakTextureBytes, i + 1 < BenchResults.Size() ? "," : "");
+
+		Printf("%s %s: avg %.2f ms, p99 %.2f ms, think %.2f ms/tic\n", res.Map.GetChars(), BenchBackendNames[res.Backend],
+			avg, Percentile(sorted, 0.99), res.ThinkMS / tics);
+	}
+	fw->Printf("\t]\n}\n");
+	delete fw;
+	Printf("Benchmark results written to %s\n", BenchOutput.GetChars());
+}
+
+//==========================================================================
+//
+// Goes to the next scene/backend combination that can run, or finishes.
+//
+//==========================================================================
+
+static void StartBenchRun()
+{
+	unsigned numruns = BenchScenes.Size() * BenchBackends.Size();
+	while (BenchRun < numruns && !BackendAvailable(BenchBackends[BenchRun % BenchBackends.Size()]))
+	{
+		Printf("Skipping %s backend, it needs a restart with the other renderer\n", BenchBackendNames[BenchBackends[BenchRun % BenchBackends.Size()]]);
+		BenchRun++;
+	}
+	if (BenchRun >= numruns)
+	{
+		BenchState = BS_Idle;
+		swtruecolor = SavedTruecolor;
+		r_polyrenderer = SavedPoly;
+		WriteBenchResults();
+		if (BenchQuit) AddCommandString("quit");
+		return;
+	}
+
+	auto &scene = BenchScenes[BenchRun / BenchBackends.Size()];
+	SetBackend(BenchBackends[BenchRun % BenchBackends.Size()]);
+	G_DeferedInitNew(scene.Map);
+	BenchState = BS_Loading;
+}
+
+void D_StartBenchmark(const char *suite, const char *output, bool quitwhendone)
+{
+	if (BenchState != BS_Idle)
+	{
+		Printf("A benchmark is already running\n");
+		return;
+	}
+	if (!ParseBenchSuite(suite) || BenchScenes.Size() == 0) return;
+
+	BenchOutput = output != nullptr ? output : "benchmark.json";
+	BenchQuit = quitwhendone;
+	BenchResults.Clear();
+	BenchRun = 0;
+	SavedTruecolor = swtruecolor;
+	SavedPoly = r_polyrenderer;
+	StartBenchRun();
+}
+
+//==========================================================================
+//
+// Holds the player at the scene's position so that every run sees the
+// same view, and keeps them out of harm's way.
+//
+//==========================================================================
+
+static void PlaceBenchCamera(const FBenchScene &scene, double fraction)
+{
+	player_t *player = &players[consoleplayer];
+	if (player->mo == nullptr) return;
+
+	player->cheats |= CF_GODMODE | CF_NOTARGET;
+	if (scene.HasPosition)
+	{
+		player->mo->SetOrigin(scene.Pos, false);
+		player->mo->Vel.Zero();
+		player->mo->Angles.Yaw = DAngle(scene.Angle + (scene.Spin ? fraction * 360 : 0));
+		player->mo->Angles.Pitch = 0.;
+	}
+}
+
+//==========================================================================
+//
+// Called once per frame by the main loop.
+//
+//==========================================================================
+
+void D_BenchmarkFrame()
+{
+	if (BenchState == BS_Idle) return;
+
+	auto &scene = BenchScenes[BenchRun / BenchBackends.Size()];
+	uint64_t now = BenchTimeNS();
+	double elapsed = (now - BenchStateStart) * 1e-9;
+
+	switch (BenchState)
+	{
+	case BS_Loading:
+		if (gamestate == GS_LEVEL && gameaction == ga_nothing && level.MapName.CompareNoCase(scene.Map) == 0)
+		{
+			BenchState = BS_Warmup;
+			BenchStateStart = now;
+		}
+		break;
+
+	case BS_Warmup:
+		PlaceBenchCamera(scene, 0);
+		if (elapsed >= BenchWarmupSeconds)
+		{
+			auto &res = BenchResults[BenchResults.Reserve(1)];
+			res.Map = scene.Map;
+			res.Backend = BenchBackends[BenchRun % BenchBackends.Size()];
+			BenchState = BS_Measuring;
+			BenchStateStart = BenchLastFrame = now;
+			BenchLastTic = gametic;
+			BenchLastVM = VMCycles[0].TimeMS();
+		}
+		break;
+
+	case BS_Measuring:
+	{
+		auto &res = BenchResults.Last();
+		res.FrameMS.Push((now - BenchLastFrame) * 1e-6);
+		BenchLastFrame = now;
+
+		if (gametic != BenchLastTic)
+		{
+			// ThinkCycles only holds the last tic, which is good enough when frames run faster than tics.
+			int tics = gametic - BenchLastTic;
+			res.Tics += tics;
+			res.ThinkMS += ThinkCycles.TimeMS() * tics;
+			res.ThinkMaxMS = MAX(res.ThinkMaxMS, ThinkCycles.TimeMS());
+			BenchLastTic = gametic;
+		}
+		// 'stat vm' resets the counter when it is shown.
+		double vm = VMCycles[0].TimeMS();
+		res.VMMS += vm >= BenchLastVM ? vm - BenchLastVM : vm;
+		BenchLastVM = vm;
+
+		res.PeakAllocBytes = MAX(res.PeakAllocBytes, GC::AllocBytes);
+		res.PeakTextureBytes = MAX(res.PeakTextureBytes, M_MemoryUsage(MEMTAG_TEXTURES));
+
+		PlaceBenchCamera(scene, MIN(elapsed / BenchSeconds, 1.));
+		if (elapsed >= BenchSeconds)
+		{
+			BenchRun++;
+			StartBenchRun();
+		}
+		break;
+	}
+
+	default:
+		break;
+	}
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void D_CheckBenchmarkArg()
+{
+	const char *suite = Args->CheckValue("-benchmark");
+	if (suite != nullptr)
+	{
+		D_StartBenchmark(suite, Args->CheckValue("-benchmarkout"), true);
+	}
+}
+
+CCMD(benchmark)
+{
+	if (argv.argc() < 2)
+	{
+		Printf("Usage: benchmark <suite> [output]\n");
+		return;
+	}
+	D_StartBenchmark(argv[1], argv.argc() >= 3 ? argv[2] : nullptr, false);
+}
@@ -122,6 +122,8 @@ struct StateMapper
 };
 
 static TArray<StateMapper> StateMap;
+// First Dehacked frame number covered by each StateMap entry, for binary searching.
+static TArray<int> StateMapStart;
 
 // Sound equivalences. When a patch tries to change a sound,
 // use these sound names.
@@ -236,6 +238,7 @@ DEFINE_FIELD_X(DehInfo, DehInfo, MaxHealth)
 TArray<PClassActor *> TouchedActors;
 
 TArray<uint32_t> UnchangedSpriteNames;
+static TMap<uint32_t, int> UnchangedSpriteIndex;
 bool changedStates;
 
 // Sprite<->Class map for DehackedPickup::DetermineType
@@ -402,33 +405,46 @@ static int FindSprite (const char *sprname)
 {
 	uint32_t nameint;
 	memcpy(&nameint, sprname, 4);
-	auto f = UnchangedSpriteNames.Find(nameint);
-	return f == UnchangedSpriteNames.Size() ? -1 : f;
+	auto f = UnchangedSpriteIndex.CheckKey(nameint);
+	return f == nullptr ? -1 : *f;
 }
 
 static FState *FindState (int statenum)
 {
-	int stateacc;
-	unsigned i;
+	if (statenum <= 0)
+		return NULL;
 
-	if (statenum == 0)
+	if (StateMapStart.Size() != StateMap.Size())
+	{
+		StateMapStart.Resize(StateMap.Size());
+		int stateacc = 1;
+		for (unsigned i = 0; i < StateMap.Size(); i++)
+		{
+			StateMapStart[i] = stateacc;
+			stateacc += StateMap[i].StateSpan;
+		}
+	}
+
+	// find the last entry that starts at or before statenum
+	unsigned min = 0, max = StateMap.Size();
+	while (min < max)
+	{
+		unsigned mid = (min + max) / 2;
+		if (StateMapStart[mid] <= statenum) min = mid + 1;
+		else max = mid;
+	}
+	if (min == 0)
 		return NULL;
 
-	for (i = 0, stateacc = 1; i < StateMap.Size(); i++)
+	const StateMapper &map = StateMap[min - 1];
+	int stateacc = StateMapStart[min - 1];
+	if (stateacc + map.StateSpan > statenum && map.State != NULL)
 	{
-		if (stateacc <= statenum && stateacc + StateMap[i].StateSpan > statenum)
+		if (map.OwnerIsPickup)
 		{
-			if (StateMap[i].State != NULL)
-			{
-				if (StateMap[i].OwnerIsPickup)
-				{
-					PushTouchedActor(StateMap[i].Owner);
-				}
-				return StateMap[i].State + statenum - stateacc;
-			}
-			else return NULL;
+			PushTouchedActor(map.Owner);
 		}
-		stateacc += StateMap[i].StateSpan;
+		return map.State + statenum - stateacc;
 	}
 	return NULL;
 }
@@ -805,7 +821,7 @@ static void SetDehParams(FState *state, int codepointer, VMDisassemblyDumper &di
 		state->SetAction(sfunc);
 		sfunc->PrintableName.Format("Dehacked.%s.%d.%d", MBFCodePointers[codepointer].name.GetChars(), value1, value2);
 
-		disasmdump.Write(sfunc, sfunc->PrintableName);
+		disasmdump.Write(sfunc, sfunc->PrintableName, buildit.GetUnoptimizedCodeSize());
 
 #ifdef HAVE_VM_JIT
 		if (Args->CheckParm("-dumpjit"))
@@ -2671,6 +2687,7 @@ static void UnloadDehSupp ()
 		StyleNames.Reset();
 		AmmoNames.Reset();
 		UnchangedSpriteNames.Reset();
+		UnchangedSpriteIndex.Clear();
 	}
 }
 
@@ -2703,9 +2720,15 @@ static bool LoadDehSupp ()
 			EnglishStrings = GStrings.GetDefaultStrings();
 
 		UnchangedSpriteNames.Resize(sprites.Size());
+		UnchangedSpriteIndex.Clear();
 		for (unsigned i = 0; i < UnchangedSpriteNames.Size(); ++i)
 		{
 			memcpy (&UnchangedSpriteNames[i], &sprites[i].name, 4);
+			// FindSprite returns the first sprite with a given name.
+			if (UnchangedSpriteIndex.CheckKey(UnchangedSpriteNames[i]) == nullptr)
+			{
+				UnchangedSpriteIndex[UnchangedSpriteNames[i]] = i;
+			}
 		}
 
 		FScanner sc;
@@ -3074,6 +3097,7 @@ void FinishDehPatch ()
 	}
 	// Now that all Dehacked patches have been processed, it's okay to free StateMap.
 	StateMap.Reset();
+	StateMapStart.Reset();
 	TouchedActors.Reset();
 	EnglishStrings.Clear();
 	GStrings.SetDehackedStrings(std::move(DehStrings));
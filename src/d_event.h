@@ -76,6 +76,7 @@ enum gameaction_t : int
 	ga_togglemap,
 	ga_fullconsole,
 	ga_resumeconversation,
+	ga_demoseek,
 };
 
 
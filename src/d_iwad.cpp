@@ -35,6 +35,7 @@
 #include "d_main.h"
 #include "gi.h"
 #include "cmdlib.h"
+#include "m_crc32.h"
 #include "doomstat.h"
 #include "i_system.h"
 #include "w_wad.h"
@@ -366,6 +367,63 @@ int FIWadManager::ScanIWAD (const char *iwad)
 	return -1;
 }
 
+//==========================================================================
+//
+// Identifying an IWAD means reading its entire directory, which can take
+// a while for large files on slow storage. So the result is remembered in
+// the config, along with the file's size and time stamp and a checksum of
+// the IWAD definitions it was matched against, since the returned index
+// is only meaningful for the same set of definitions.
+//
+//==========================================================================
+
+static uint32_t GetIWadInfoChecksum(const TArray<FIWADInfo> &infos)
+{
+	uint32_t crc = 0;
+	for (auto &info : infos)
+	{
+		crc = AddCRC32(crc, (const uint8_t*)info.Name.GetChars(), (unsigned)info.Name.Len() + 1);
+		for (auto &lump : info.Lumps)
+		{
+			crc = AddCRC32(crc, (const uint8_t*)lump.GetChars(), (unsigned)lump.Len() + 1);
+		}
+	}
+	return crc;
+}
+
+int FIWadManager::CachedScanIWAD (const char *iwad)
+{
+	size_t size;
+	time_t time;
+
+	// Keys can't contain '=' in the config file.
+	if (GameConfig == nullptr || strchr(iwad, '=') != nullptr || !GetFileInfo(iwad, &size, &time))
+	{
+		return ScanIWAD(iwad);
+	}
+
+	FString stamp;
+	stamp.Format("%zu,%lld,%08x,", size, (long long)time, GetIWadInfoChecksum(mIWadInfos));
+	if (GameConfig->SetSection("IWADCache"))
+	{
+		const char *value = GameConfig->GetValueForKey(iwad);
+		if (value != nullptr && strncmp(value, stamp.GetChars(), stamp.Len()) == 0)
+		{
+			int index = (int)strtol(value + stamp.Len(), nullptr, 10);
+			if (index >= -1 && index < (int)mIWadInfos.Size())
+			{
+				return index;
+			}
+		}
+	}
+
+	int index = ScanIWAD(iwad);
+	GameConfig->SetSection("IWADCache", true);
+	stamp.AppendFormat("%d", index);
+	GameConfig->SetValueForKey(iwad, stamp);
+	return index;
+}
+
 //==========================================================================
 //
 // Look for IWAD definition lump
@@ -520,7 +578,7 @@ void FIWadManager::ValidateIWADs()
 		}
 		else
 		{
-			index = ScanIWAD(p.mFullPath);
+			index = CachedScanIWAD(p.mFullPath);
 		}
 		p.mInfoIndex = index;
 	}
@@ -62,6 +62,7 @@
 #include "m_misc.h"
 #include "menu/menu.h"
 #include "c_console.h"
+#include "c_consolebuffer.h"
 #include "c_dispatch.h"
 #include "i_sound.h"
 #include "i_video.h"
@@ -104,6 +105,8 @@
 #include "r_data/r_vanillatrans.h"
 #include "s_music.h"
 #include "swrenderer/r_swcolormaps.h"
+#include "r_governor.h"
+#include "jobs.h"
 
 EXTERN_CVAR(Bool, hud_althud)
 EXTERN_CVAR(Bool, cl_customizeinvulmap)
@@ -170,6 +173,10 @@ EXTERN_CVAR (Int, screenblocks)
 EXTERN_CVAR (Bool, sv_cheats)
 EXTERN_CVAR (Bool, sv_unlimited_pickup)
 EXTERN_CVAR (Bool, I_FriendlyWindowTitle)
+EXTERN_CVAR (Bool, file_watchdirs)
+EXTERN_CVAR (Bool, vid_lowlatency)
+EXTERN_CVAR (Bool, cl_capfps)
+EXTERN_CVAR (Int, vid_maxfps)
 
 extern int testingmode;
 extern bool setmodeneeded;
@@ -205,6 +212,8 @@ CVAR (Float, timelimit, 0.f, CVAR_SERVERINFO);
 CVAR (Int, wipetype, 1, CVAR_ARCHIVE);
 CVAR (Int, snd_drawoutput, 0, 0);
 CVAR (Bool, fixunitystatusbar, false, 0);
+CVAR (Bool, hud_retained, false, CVAR_ARCHIVE);
+CVAR (Bool, wi_retained, true, CVAR_ARCHIVE);
 CUSTOM_CVAR (String, vid_cursor, "None", CVAR_ARCHIVE | CVAR_NOINITCALL)
 {
 	bool res = false;
@@ -257,9 +266,14 @@ FStartupInfo DoomStartupInfo;
 FString lastIWAD;
 int restart = 0;
 bool batchrun;	// just run the startup and collect all error messages in a logfile, then quit without any interaction
+bool headless;
 bool AppActive = true;
 
 cycle_t FrameCycles;
+extern cycle_t ThinkCycles;
+extern bool timingdemo;
+static FILE *TimeDemoLog;
+static bool TimeDemoLogOpened;
 
 // [SP] Store the capabilities of the renderer in a global variable, to prevent excessive per-frame processing
 uint32_t r_renderercaps = 0;
@@ -269,6 +283,7 @@ uint32_t r_renderercaps = 0;
 
 static int demosequence;
 static int pagetic;
+static unsigned GameEvents;		// events that got past the console and menu
 
 // CODE --------------------------------------------------------------------
 
@@ -311,6 +326,7 @@ void D_ProcessEvents (void)
 			continue;				// console ate the event
 		if (M_Responder (ev))
 			continue;				// menu ate the event
+		GameEvents++;
 		// check events
 		if (ev->type != EV_Mouse && E_Responder(ev)) // [ZZ] ZScript ate the event // update 07.03.17: mouse events are handled directly
 			continue;
@@ -688,6 +704,93 @@ CVAR (Flag, compat_oldrandom,			compatflags2, COMPATF2_OLD_RANDOM_GENERATOR);
 
 CVAR(Bool, vid_activeinbackground, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
 
+//==========================================================================
+//
+// D_LogTimeDemoTic
+//
+// With -timedemolog <file>, a timedemo writes one CSV line per tic with
+// the time spent in the playsim, the thinkers, the GC and the renderer.
+// Combine with -nodraw to benchmark only the playsim.
+//
+//==========================================================================
+
+static void D_LogTimeDemoTic(cycle_t &tictime, cycle_t &gctime)
+{
+	if (TimeDemoLog == nullptr)
+	{
+		const char *filename = Args->CheckValue("-timedemolog");
+		if (filename == nullptr || TimeDemoLogOpened) return;
+		TimeDemoLogOpened = true;
+		TimeDemoLog = fopen(filename, "w");
+		if (TimeDemoLog == nullptr)
+		{
+			Printf("Could not open %s for writing\n", filename);
+			return;
+		}
+		fprintf(TimeDemoLog, "tic,tic_ms,think_ms,gc_ms,render_ms\n");
+	}
+	fprintf(TimeDemoLog, "%d,%.3f,%.3f,%.3f,%.3f\n", gametic, tictime.TimeMS(), ThinkCycles.TimeMS(), gctime.TimeMS(), FrameCycles.TimeMS());
+}
+
+void D_CloseTimeDemoLog()
+{
+	if (TimeDemoLog != nullptr)
+	{
+		fclose(TimeDemoLog);
+		TimeDemoLog = nullptr;
+	}
+}
+
+//==========================================================================
+//
+// D_HeadlessTicStats
+//
+// A headless host has no screen to show stats on, so it periodically
+// prints how evenly its tics were spaced to the console and log file.
+// A tic counts as late if it came more than half a tic after it was due.
+//
+//==========================================================================
+
+CVAR(Int, host_ticstats, 60, 0)	// seconds between reports, 0 disables them
+
+static void D_HeadlessTicStats()
+{
+	static int lastgametic = -1;
+	static uint64_t lastticns, reportns, worstns, totalns;
+	static int numtics, numlate;
+	const uint64_t ticns = 1000000000ull / TICRATE;
+
+	uint64_t now = I_nsTime();
+	if (lastgametic < 0 || gametic < lastgametic)
+	{
+		lastgametic = gametic;
+		lastticns = reportns = now;
+		return;
+	}
+	if (gametic == lastgametic)
+	{
+		return;
+	}
+
+	int ran = gametic - lastgametic;
+	uint64_t interval = (now - lastticns) / ran;
+	numtics += ran;
+	totalns += now - lastticns;
+	worstns = MAX(worstns, interval);
+	if (interval > ticns + ticns / 2) numlate += ran;
+	lastgametic = gametic;
+	lastticns = now;
+
+	if (host_ticstats > 0 && now - reportns >= uint64_t(host_ticstats) * 1000000000ull)
+	{
+		Printf("Host tics: %d in %.1f s, avg %.2f ms, worst %.2f ms, %d late\n", numtics, (now - reportns) / 1e9,
+			totalns / 1e6 / numtics, worstns / 1e6, numlate);
+		reportns = now;
+		worstns = totalns = 0;
+		numtics = numlate = 0;
+	}
+}
+
 //==========================================================================
 //
 // D_Display
@@ -700,6 +803,7 @@ void D_Display ()
 {
 	bool wipe;
 	bool hw2d;
+	bool retained, redraw;
 
 	if (nodrawers || screen == NULL)
 		return; 				// for comparative timing / profiling
@@ -709,6 +813,7 @@ void D_Display ()
 		return;
 	}
 
+	PROFILE_ZONE("Display");
 	cycle_t cycles;
 	
 	cycles.Reset();
@@ -875,7 +980,30 @@ void D_Display ()
 			//cycle_t stb;
 			//stb.Reset();
 			//stb.Clock();
-			if (hud_althud && viewheight == SCREENHEIGHT && screenblocks > 10)
+
+			// With hud_retained the HUD is only drawn again when a new tic has run
+			// or the layout changed. Animations that interpolate with TicFrac will
+			// only update once per tic. The menu and console can change how the HUD
+			// looks without a tic running, so the HUD is never kept while they are up.
+			retained = hud_retained && hw2d && menuactive == MENU_Off && ConsoleState == c_up;
+			redraw = true;
+			if (retained)
+			{
+				uint64_t key = gametic;
+				key = key * 31 + (hud_althud ? 1 : 0) + (DrawFSHUD ? 2 : 0) + (automapactive ? 4 : 0) + (viewactive ? 8 : 0);
+				key = key * 31 + screenblocks;
+				key = key * 31 + viewheight;
+				key = key * 31 + SCREENWIDTH;
+				key = key * 31 + SCREENHEIGHT;
+				key = key * 31 + consoleplayer;
+				redraw = !screen->BeginRetained2D(RETAINED2D_HUD, key);
+			}
+
+			if (!redraw)
+			{
+				// the HUD from an earlier frame has been played back.
+			}
+			else if (hud_althud && viewheight == SCREENHEIGHT && screenblocks > 10)
 			{
 				StatusBar->DrawBottomStuff (HUD_AltHud);
 				if (DrawFSHUD || automapactive) StatusBar->DrawAltHUD();
@@ -900,22 +1028,38 @@ void D_Display ()
 				StatusBar->CallDraw (HUD_StatusBar, r_viewpoint.TicFrac);
 				StatusBar->DrawTopStuff (HUD_StatusBar);
 			}
+			if (retained && redraw) screen->EndRetained2D();
 			//stb.Unclock();
 			//Printf("Stbar = %f\n", stb.TimeMS());
 			CT_Drawer ();
 			break;
 
 		case GS_INTERMISSION:
-			screen->SetBlendingRect(0,0,0,0);
-			hw2d = screen->Begin2D(false);
-			WI_Drawer ();
-			CT_Drawer ();
-			break;
-
 		case GS_FINALE:
 			screen->SetBlendingRect(0,0,0,0);
 			hw2d = screen->Begin2D(false);
-			F_Drawer ();
+
+			// Intermissions and finales only change in their tickers and responders,
+			// so with wi_retained they are drawn once per tic or input event and
+			// played back in between. Like the HUD, they are not kept while the
+			// menu or console can change the CVARs they use.
+			retained = wi_retained && hw2d && menuactive == MENU_Off && ConsoleState == c_up;
+			redraw = true;
+			if (retained)
+			{
+				uint64_t key = gametic;
+				key = key * 31 + GameEvents;	// the responders can skip ahead
+				key = key * 31 + gamestate;
+				key = key * 31 + SCREENWIDTH;
+				key = key * 31 + SCREENHEIGHT;
+				redraw = !screen->BeginRetained2D(RETAINED2D_INTERMISSION, key);
+			}
+			if (redraw)
+			{
+				if (gamestate == GS_INTERMISSION) WI_Drawer ();
+				else F_Drawer ();
+				if (retained) screen->EndRetained2D();
+			}
 			CT_Drawer ();
 			break;
 
@@ -1011,10 +1155,12 @@ void D_Display ()
 		screen->WipeCleanup();
 		I_FreezeTime(false);
 		GSnd->SetSfxPaused(false, 1);
+		FHitchLog::SkipFrame();
 	}
 	screen->End2D();
 	cycles.Unclock();
 	FrameCycles = cycles;
+	R_GovernorFrame(cycles.TimeMS());
 }
 
 //==========================================================================
@@ -1062,6 +1208,26 @@ void D_ErrorCleanup ()
 //
 //==========================================================================
 
+//==========================================================================
+//
+// D_CheckModifiedLumps
+//
+// Picks up changes to files in directory mounts so that textures can be
+// edited without restarting.
+//
+//==========================================================================
+
+static void D_CheckModifiedLumps ()
+{
+	TArray<int> lumps;
+	Wads.FindModifiedLumps (lumps);
+	if (lumps.Size() > 0)
+	{
+		DPrintf (DMSG_NOTIFY, "%u lumps changed on disk\n", lumps.Size());
+		TexMan.SourceLumpsModified (lumps);
+	}
+}
+
 void D_DoomLoop ()
 {
 	int lasttic = 0;
@@ -1074,6 +1240,8 @@ void D_DoomLoop ()
 
 	vid_cursor.Callback();
 
+	cycle_t tictime, gctime;
+
 	for (;;)
 	{
 		try
@@ -1083,11 +1251,22 @@ void D_DoomLoop ()
 			{
 				lasttic = gametic;
 				I_StartFrame ();
+				if (file_watchdirs) D_CheckModifiedLumps ();
+			}
+			if (vid_lowlatency && !cl_capfps && !singletics)
+			{
+				I_WaitForFrame(vid_maxfps);
+			}
+			else
+			{
+				I_WaitForFrame(0);
 			}
 			I_SetFrameTime();
 
 			// process one or more tics
-			if (singletics)
+			// demo_seek fast-forwards the demo the same way, without rendering.
+			bool seeking = G_DemoSeeking();
+			if (singletics || seeking)
 			{
 				I_StartTic ();
 				D_ProcessEvents ();
@@ -1096,13 +1275,24 @@ void D_DoomLoop ()
 					D_DoAdvanceDemo ();
 				C_Ticker ();
 				M_Ticker ();
+				tictime.Reset();
+				tictime.Clock();
 				G_Ticker ();
+				tictime.Unclock();
 				// [RH] Use the consoleplayer's camera to update sounds
 				S_UpdateSounds (players[consoleplayer].camera);	// move positional sounds
 				gametic++;
 				maketic++;
+				gctime.Reset();
+				gctime.Clock();
 				GC::CheckGC ();
+				gctime.Unclock();
 				Net_NewMakeTic ();
+				if (seeking && !singletics)
+				{
+					// keep TryRunTics in sync for when the seek is done.
+					nettics[0] = maketic / ticdup;
+				}
 			}
 			else
 			{
@@ -1110,7 +1300,20 @@ void D_DoomLoop ()
 			}
 			// Update display, next frame, with current state.
 			I_StartTic ();
-			D_Display ();
+			I_MarkInputTime();
+			if (timingdemo) FrameCycles.Reset();
+			if (!seeking) D_Display ();
+			I_FramePresented();
+			FProfileZone::EndFrame();
+			D_BenchmarkFrame();
+			if (singletics && timingdemo)
+			{
+				D_LogTimeDemoTic(tictime, gctime);
+			}
+			if (headless)
+			{
+				D_HeadlessTicStats();
+			}
 			S_UpdateMusic();
 			if (wantToRestart)
 			{
@@ -2149,6 +2352,7 @@ static void D_DoomInit()
 
 	if (!batchrun) Printf ("M_LoadDefaults: Load system defaults.\n");
 	M_LoadDefaults ();			// load before initing other systems
+	FJobSystem::PinThread(JOB_Frame);
 }
 
 //==========================================================================
@@ -2419,6 +2623,7 @@ void I_FatalError(const char *error, ...)
 		// Record error to log (if logging)
 		if (Logfile)
 		{
+			LogWriter.Flush();
 			fprintf(Logfile, "\n**** DIED WITH FATAL ERROR:\n%s\n", errortext);
 			fflush(Logfile);
 		}
@@ -2456,6 +2661,73 @@ static void FixUnityStatusBar()
 	}
 }
 
+//==========================================================================
+//
+// Startup timeline
+//
+// With -startuptimes, the time spent in each startup phase is printed
+// once all definitions have been parsed.
+//
+//==========================================================================
+
+struct FStartupPhase
+{
+	const char *Name;
+	uint64_t Start;
+};
+
+static TArray<FStartupPhase> StartupPhases;
+
+static void D_StartupPhase(const char *name)
+{
+	StartupPhases.Push({ name, I_nsTime() });
+}
+
+static void D_PrintStartupTimeline()
+{
+	D_StartupPhase(nullptr);
+	if (Args->CheckParm("-startuptimes"))
+	{
+		Printf("Startup timeline:\n");
+		for (unsigned i = 0; i + 1 < StartupPhases.Size(); i++)
+		{
+			Printf("%8.1f ms %8.1f ms  %s\n", (StartupPhases[i].Start - StartupPhases[0].Start) * 1e-6,
+				(StartupPhases[i + 1].Start - StartupPhases[i].Start) * 1e-6, StartupPhases[i].Name);
+		}
+	}
+	StartupPhases.Clear();
+}
+
+//==========================================================================
+//
+// D_StartDefinitionPrefetch
+//
+// The definition lumps are only parsed after the video and sound devices
+// have been set up, which mostly waits on drivers. The compressed ones get
+// inflated in the background meanwhile.
+//
+//==========================================================================
+
+static void D_StartDefinitionPrefetch()
+{
+	static const char *const names[] = {
+		"REVERBS", "SNDINFO", "SNDSEQ", "MAPINFO", "ZMAPINFO", "EMAPINFO", "UMAPINFO", "MUSINFO",
+		"TEXTURES", "HIRESTEX", "ANIMDEFS", "FONTDEFS", "TEAMINFO", "TRNSLATE", "ZSCRIPT", "DECORATE",
+		"KEYCONF", "GLDEFS", "DOOMDEFS", "HTICDEFS", "HEXNDEFS", "STRFDEFS", "MODELDEF", "VOXELDEF",
+		"DECALDEF", "MENUDEF", "LOCKDEFS", "TERRAIN", "SBARINFO", "ALTHUDCF"
+	};
+	TArray<int> lumps;
+	for (auto name : names)
+	{
+		int lump, lastlump = 0;
+		while ((lump = Wads.FindLump(name, &lastlump)) != -1)
+		{
+			lumps.Push(lump);
+		}
+	}
+	Wads.StartBackgroundPrefetch(lumps, 64 << 20);
+}
+
 //==========================================================================
 //
 // D_DoomMain
@@ -2498,6 +2770,14 @@ static int D_DoomMain_Internal (void)
 		Printf("\n");
 	}
 
+	if (Args->CheckParm("-headless"))
+	{
+		// The video system still gets initialized because textures, fonts and the console
+		// depend on it, but nothing is ever drawn and the tics are paced by the timer.
+		headless = true;
+		nodrawers = true;
+	}
+
 	if (Args->CheckParm("-hashfiles"))
 	{
 		const char *filename = "fileinfo.txt";
@@ -2570,6 +2850,7 @@ static int D_DoomMain_Internal (void)
 		// Load zdoom.pk3 alone so that we can get access to the internal gameinfos before 
 		// the IWAD is known.
 
+		D_StartupPhase("IWAD and config");
 		GetCmdLineFiles(pwads);
 		FString iwad = CheckGameInfo(pwads);
 
@@ -2631,10 +2912,15 @@ static int D_DoomMain_Internal (void)
 		}
 
 		if (!batchrun) Printf ("W_Init: Init WADfiles.\n");
+		D_StartupPhase("W_Init");
 		Wads.InitMultipleFiles (allwads);
 		allwads.Clear();
 		allwads.ShrinkToFit();
 		SetMapxxFlag();
+		FScanner::CacheLumps(true);
+		D_StartDefinitionPrefetch();
+
+		D_StartupPhase("CVARINFO and LANGUAGE");
 
 		C_GrabCVarDefaults(); //parse DEFCVARS
 
@@ -2664,17 +2950,20 @@ static int D_DoomMain_Internal (void)
 		if (!restart)
 		{
 			if (!batchrun) Printf ("I_Init: Setting up machine state.\n");
+			D_StartupPhase("I_Init");
 			I_Init ();
 			I_CreateRenderer();
 		}
 
 		if (!batchrun) Printf ("V_Init: allocate screen.\n");
+		D_StartupPhase("V_Init");
 		V_Init (!!restart);
 
 		// Base systems have been inited; enable cvar callbacks
 		FBaseCVar::EnableCallbacks ();
 
 		if (!batchrun) Printf ("S_Init: Setting up sound.\n");
+		D_StartupPhase("S_Init");
 		S_Init ();
 
 		if (!batchrun) Printf ("ST_Init: Init startup screen.\n");
@@ -2691,7 +2980,11 @@ static int D_DoomMain_Internal (void)
 
 		CheckCmdLine();
 
+		D_StartupPhase("Wait for definition prefetch");
+		Wads.FinishBackgroundPrefetch();
+
 		// [RH] Load sound environments
+		D_StartupPhase("Sound and map definitions");
 		S_ParseReverbDef ();
 
 		// [RH] Parse any SNDINFO lumps
@@ -2707,12 +3000,14 @@ static int D_DoomMain_Internal (void)
 		S_ParseMusInfo();
 
 		if (!batchrun) Printf ("Texman.Init: Init texture manager.\n");
+		D_StartupPhase("TexMan.Init");
 		TexMan.Init();
 		C_InitConback();
 
 		FixUnityStatusBar();
 
 		StartScreen->Progress();
+		D_StartupPhase("V_InitFonts");
 		V_InitFonts();
 
 		// [CW] Parse any TEAMINFO lumps.
@@ -2720,6 +3015,7 @@ static int D_DoomMain_Internal (void)
 		TeamLibrary.ParseTeamInfo ();
 
 		R_ParseTrnslate();
+		D_StartupPhase("Scripts");
 		PClassActor::StaticInit ();
 
 		// [GRB] Initialize player class list
@@ -2736,13 +3032,16 @@ static int D_DoomMain_Internal (void)
 
 		StartScreen->Progress ();
 
+		D_StartupPhase("ParseGLDefs");
 		ParseGLDefs();
 
 		if (!batchrun) Printf ("R_Init: Init %s refresh subsystem.\n", gameinfo.ConfigName.GetChars());
 		StartScreen->LoadingStatus ("Loading graphics", 0x3f);
+		D_StartupPhase("R_Init");
 		R_Init ();
 
 		if (!batchrun) Printf ("DecalLibrary: Load decals.\n");
+		D_StartupPhase("Decals and Dehacked");
 		DecalLibrary.ReadAllDecals ();
 
 		// Load embedded Dehacked patches
@@ -2774,7 +3073,11 @@ static int D_DoomMain_Internal (void)
 		// Create replacements for dehacked pickups
 		FinishDehPatch();
 
+		// Dehacked was the last thing allowed to alter the states.
+		FState::StaticSetupZeroTicChains();
+
 		if (!batchrun) Printf("M_Init: Init menus.\n");
+		D_StartupPhase("M_Init");
 		M_Init();
 
 		// clean up the compiler symbols which are not needed any longer.
@@ -2796,6 +3099,7 @@ static int D_DoomMain_Internal (void)
 
 		if (!batchrun) Printf ("P_Init: Init Playloop state.\n");
 		StartScreen->LoadingStatus ("Init game engine", 0x3f);
+		D_StartupPhase("P_Init");
 		AM_StaticInit();
 		P_Init ();
 
@@ -2823,6 +3127,7 @@ static int D_DoomMain_Internal (void)
 		if (!restart)
 		{
 			if (!batchrun) Printf ("D_CheckNetGame: Checking network game status.\n");
+			D_StartupPhase("D_CheckNetGame");
 			StartScreen->LoadingStatus ("Checking network game status.", 0x3f);
 			if (!D_CheckNetGame ())
 			{
@@ -2840,6 +3145,11 @@ static int D_DoomMain_Internal (void)
 		delete iwad_man;	// now we won't need this anymore
 		iwad_man = NULL;
 
+		// All definition lumps have been parsed by now.
+		FScanner::CacheLumps(false);
+		Wads.ReleaseBackgroundPrefetch();
+		D_PrintStartupTimeline();
+
 		// [RH] Run any saved commands from the command line or autoexec.cfg now.
 		gamestate = GS_FULLCONSOLE;
 		Net_NewMakeTic ();
@@ -2944,6 +3254,7 @@ static int D_DoomMain_Internal (void)
 		}
 
 		D_DoAnonStats();
+		if (restart == 0) D_CheckBenchmarkArg();
 
 		if (I_FriendlyWindowTitle)
 			I_SetWindowTitle(DoomStartupInfo.Name.GetChars());
@@ -3005,6 +3316,10 @@ int D_DoomMain()
 
 void D_Cleanup()
 {
+	// Don't leave a savegame half written.
+	G_WaitForSaveThread();
+	G_CancelPreparse();
+
 	if (demorecording)
 	{
 		G_CheckDemoStatus();
@@ -49,6 +49,10 @@ int D_DoomMain (void);
 
 
 void D_Display ();
+void D_CloseTimeDemoLog ();
+void D_StartBenchmark (const char *suite, const char *output, bool quitwhendone);
+void D_CheckBenchmarkArg ();
+void D_BenchmarkFrame ();
 
 
 //
@@ -150,6 +154,7 @@ class FIWadManager
 
 	void ParseIWadInfo(const char *fn, const char *data, int datasize, FIWADInfo *result = nullptr);
 	int ScanIWAD (const char *iwad);
+	int CachedScanIWAD (const char *iwad);
 	int CheckIWADInfo(const char *iwad);
 	int IdentifyVersion (TArray<FString> &wadfiles, const char *iwad, const char *zdoom_wad, const char *optional_wad);
 	void CollectSearchPaths();
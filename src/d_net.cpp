@@ -125,6 +125,11 @@ int 			resendcount[MAXNETNODES];
 uint64_t		lastrecvtime[MAXPLAYERS];				// [RH] Used for pings
 uint64_t		currrecvtime[MAXPLAYERS];
 uint64_t		lastglobalrecvtime;						// Identify the last time a packet was received.
+uint64_t		netbytesout[MAXNETNODES];				// Traffic per node, counted by the packet driver
+uint64_t		netbytesin[MAXNETNODES];
+unsigned		netpacketsout[MAXNETNODES];
+unsigned		netpacketsin[MAXNETNODES];
+static uint64_t	nettrafficstart;						// I_msTime when the counters were reset
 bool			hadlate;
 int				netdelay[MAXNETNODES][BACKUPTICS];		// Used for storing network delay times.
 int				lastaverage;
@@ -169,6 +174,15 @@ CUSTOM_CVAR (Bool, cl_capfps, false, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 	}
 }
 
+// Do the vid_maxfps wait before starting a frame instead of before presenting it.
+CUSTOM_CVAR (Bool, vid_lowlatency, false, CVAR_ARCHIVE|CVAR_GLOBALCONFIG|CVAR_NOINITCALL)
+{
+	if (!cl_capfps)
+	{
+		I_SetFPSLimit(-1);
+	}
+}
+
 CVAR(Bool, net_ticbalance, false, CVAR_SERVERINFO | CVAR_NOSAVE)
 CUSTOM_CVAR(Int, net_extratic, 0, CVAR_SERVERINFO | CVAR_NOSAVE)
 {
@@ -328,6 +342,16 @@ static struct TicSpecial
 		return *this;
 	}
 
+	void WriteBytes (const uint8_t *block, int len)
+	{
+		if (streamptr && len > 0)
+		{
+			CheckSpace (len);
+			memcpy (streamptr, block, len);
+			streamptr += len;
+		}
+	}
+
 } specials;
 
 void Net_ClearBuffers ()
@@ -345,6 +369,11 @@ void Net_ClearBuffers ()
 	memset (resendcount, 0, sizeof(resendcount));
 	memset (lastrecvtime, 0, sizeof(lastrecvtime));
 	memset (currrecvtime, 0, sizeof(currrecvtime));
+	memset (netbytesout, 0, sizeof(netbytesout));
+	memset (netbytesin, 0, sizeof(netbytesin));
+	memset (netpacketsout, 0, sizeof(netpacketsout));
+	memset (netpacketsin, 0, sizeof(netpacketsin));
+	nettrafficstart = I_msTime();
 	memset (consistancy, 0, sizeof(consistancy));
 	nodeingame[0] = true;
 
@@ -1840,6 +1869,14 @@ static void TicStabilityWait()
 	if (!r_ticstability)
 		return;
 
+	if (netgame && !demoplayback)
+	{
+		// Sleep on the socket instead of spinning, so that a packet
+		// with new tics ends the wait right away.
+		I_WaitForPacket((int)stabilityticduration);
+		return;
+	}
+
 	uint64_t start = duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
 	while (true)
 	{
@@ -1878,7 +1915,7 @@ void TryRunTics (void)
 	// will all be wasted anyway.
 	if (pauseext) 
 		r_NoInterpolate = true;
-	bool doWait = cl_capfps || r_NoInterpolate /*|| netgame*/;
+	bool doWait = cl_capfps || r_NoInterpolate || headless /*|| netgame*/;
 
 	// get real tics
 	if (doWait)
@@ -1939,8 +1976,7 @@ void TryRunTics (void)
 			C_Ticker();
 			M_Ticker();
 			// Repredict the player for new buffered movement
-			P_UnPredictPlayer();
-			P_PredictPlayer(&players[consoleplayer]);
+			P_RepredictPlayer(&players[consoleplayer]);
 		}
 		return;
 	}
@@ -1973,7 +2009,14 @@ void TryRunTics (void)
 
 		// Update time returned by I_GetTime, but only if we are stuck in this loop
 		if (lowtic < gametic + counts)
+		{
+			// Don't spin while waiting for the other nodes. This returns as
+			// soon as a packet arrives and otherwise after a millisecond, so
+			// local tics are still made on time.
+			if (netgame && !demoplayback)
+				I_WaitForPacket(1000);
 			I_SetFrameTime();
+		}
 
 		// don't stay in here forever -- give the menu a chance to work
 		if (I_GetTime () - entertic >= 1)
@@ -1981,8 +2024,7 @@ void TryRunTics (void)
 			C_Ticker ();
 			M_Ticker ();
 			// Repredict the player for new buffered movement
-			P_UnPredictPlayer();
-			P_PredictPlayer(&players[consoleplayer]);
+			P_RepredictPlayer(&players[consoleplayer]);
 			return;
 		}
 	}
@@ -2096,8 +2138,7 @@ void Net_WriteString (const char *it)
 
 void Net_WriteBytes (const uint8_t *block, int len)
 {
-	while (len--)
-		specials << *block++;
+	specials.WriteBytes (block, len);
 }
 
 //==========================================================================
@@ -2108,17 +2149,18 @@ void Net_WriteBytes (const uint8_t *block, int len)
 
 FDynamicBuffer::FDynamicBuffer ()
 {
-	m_Data = NULL;
-	m_Len = m_BufferLen = 0;
+	m_Data = m_Inline;
+	m_Len = 0;
+	m_BufferLen = INLINE_SIZE;
 }
 
 FDynamicBuffer::~FDynamicBuffer ()
 {
-	if (m_Data)
+	if (m_Data != m_Inline)
 	{
 		M_Free (m_Data);
-		m_Data = NULL;
 	}
+	m_Data = NULL;
 	m_Len = m_BufferLen = 0;
 }
 
@@ -2126,8 +2168,13 @@ void FDynamicBuffer::SetData (const uint8_t *data, int len)
 {
 	if (len > m_BufferLen)
 	{
+		// The old contents get replaced anyway, so there's nothing to preserve.
+		if (m_Data != m_Inline)
+		{
+			M_Free (m_Data);
+		}
 		m_BufferLen = (len + 255) & ~255;
-		m_Data = (uint8_t *)M_Realloc (m_Data, m_BufferLen);
+		m_Data = (uint8_t *)M_Malloc (m_BufferLen);
 	}
 	if (data != NULL)
 	{
@@ -2786,11 +2833,60 @@ static void RunScript(uint8_t **stream, AActor *pawn, int snum, int argn, int al
 	P_StartScript(pawn, NULL, snum, level.MapName, arg, MIN<int>(countof(arg), argn), ACS_NET | always);
 }
 
+//==========================================================================
+//
+// Payload sizes of all net commands, so that Net_SkipCommand can step over
+// most of them without looking at their contents. An entry of -1 means the
+// size depends on the data and has to be worked out by parsing it.
+//
+//==========================================================================
+
+static const struct FNetCommandSizes
+{
+	int8_t Size[256];
+
+	FNetCommandSizes ()
+	{
+		static const uint8_t variable[] =
+		{
+			DEM_SAY, DEM_ADDBOT, DEM_GIVECHEAT, DEM_TAKECHEAT, DEM_SETINV, DEM_NETEVENT,
+			DEM_SUMMON2, DEM_SUMMONFRIEND2, DEM_SUMMONFOE2, DEM_CHANGEMAP2,
+			DEM_MUSICCHANGE, DEM_PRINT, DEM_CENTERPRINT, DEM_UINFCHANGED, DEM_CHANGEMAP,
+			DEM_SUMMON, DEM_SUMMONFRIEND, DEM_SUMMONFOE, DEM_SUMMONMBF, DEM_REMOVE,
+			DEM_SPRAY, DEM_MORPHEX, DEM_KILLCLASSCHEAT, DEM_MDK, DEM_SAVEGAME,
+			DEM_SINFCHANGED, DEM_SINFCHANGEDXOR, DEM_RUNSCRIPT, DEM_RUNSCRIPT2,
+			DEM_RUNNAMEDSCRIPT, DEM_RUNSPECIAL, DEM_SETSLOT, DEM_SETSLOTPNUM,
+			DEM_ADDSLOT, DEM_ADDSLOTDEFAULT,
+		};
+
+		// Anything not listed has no payload.
+		memset (Size, 0, sizeof(Size));
+		for (auto type : variable)
+		{
+			Size[type] = -1;
+		}
+		Size[DEM_WARPCHEAT] = 6;
+		Size[DEM_INVUSE] = Size[DEM_FOV] = Size[DEM_MYFOV] = 4;
+		Size[DEM_INVDROP] = 8;
+		Size[DEM_GENERICCHEAT] = Size[DEM_DROPPLAYER] = 1;
+		Size[DEM_ADDCONTROLLER] = Size[DEM_DELCONTROLLER] = 1;
+		Size[DEM_CONVREPLY] = 3;
+		Size[DEM_SETPITCHLIMIT] = 2;
+	}
+} NetCommandSizes;
+
 void Net_SkipCommand (int type, uint8_t **stream)
 {
 	uint8_t t;
 	size_t skip;
 
+	int size = NetCommandSizes.Size[type & 255];
+	if (size >= 0)
+	{
+		*stream += size;
+		return;
+	}
+
 	switch (type)
 	{
 		case DEM_SAY:
@@ -2839,27 +2935,6 @@ void Net_SkipCommand (int type, uint8_t **stream)
 			skip = strlen ((char *)(*stream)) + 1;
 			break;
 
-		case DEM_WARPCHEAT:
-			skip = 6;
-			break;
-
-		case DEM_INVUSE:
-		case DEM_FOV:
-		case DEM_MYFOV:
-			skip = 4;
-			break;
-
-		case DEM_INVDROP:
-			skip = 8;
-			break;
-
-		case DEM_GENERICCHEAT:
-		case DEM_DROPPLAYER:
-		case DEM_ADDCONTROLLER:
-		case DEM_DELCONTROLLER:
-			skip = 1;
-			break;
-
 		case DEM_SAVEGAME:
 			skip = strlen ((char *)(*stream)) + 1;
 			skip += strlen ((char *)(*stream) + skip) + 1;
@@ -2904,10 +2979,6 @@ void Net_SkipCommand (int type, uint8_t **stream)
 			skip = 3 + *(*stream + 2) * 4;
 			break;
 
-		case DEM_CONVREPLY:
-			skip = 3;
-			break;
-
 		case DEM_SETSLOT:
 		case DEM_SETSLOTPNUM:
 			{
@@ -2924,10 +2995,6 @@ void Net_SkipCommand (int type, uint8_t **stream)
 			skip = 2 + ((*stream)[1] >> 7);
 			break;
 
-		case DEM_SETPITCHLIMIT:
-			skip = 2;
-			break;
-
 		default:
 			return;
 	}
@@ -2964,13 +3031,31 @@ int Net_GetLatency(int *ld, int *ad)
 }
 
 // [RH] List "ping" times
+// Also lists the average traffic per second to and from each remote node.
 CCMD (pings)
 {
 	int i;
+	double seconds = MAX<uint64_t>(I_msTime() - nettrafficstart, 1) / 1000.;
+
 	for (i = 0; i < MAXPLAYERS; i++)
+	{
 		if (playeringame[i])
-			Printf ("% 4" PRId64 " %s\n", currrecvtime[i] - lastrecvtime[i],
-					players[i].userinfo.GetName());
+		{
+			int node = nodeforplayer[i];
+			if (node > 0 && node < MAXNETNODES && netgame)
+			{
+				Printf ("% 4" PRId64 " %s (out %.0f B/s %.1f pkt/s, in %.0f B/s %.1f pkt/s)\n", currrecvtime[i] - lastrecvtime[i],
+						players[i].userinfo.GetName(),
+						netbytesout[node] / seconds, netpacketsout[node] / seconds,
+						netbytesin[node] / seconds, netpacketsin[node] / seconds);
+			}
+			else
+			{
+				Printf ("% 4" PRId64 " %s\n", currrecvtime[i] - lastrecvtime[i],
+						players[i].userinfo.GetName());
+			}
+		}
+	}
 }
 
 //==========================================================================
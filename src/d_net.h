@@ -93,18 +93,25 @@ struct doomcom_t
 };
 
 
+// Holds one player's special commands for one tic. Small command streams,
+// which is almost all of them, fit in the inline storage and never touch the heap.
 class FDynamicBuffer
 {
 public:
 	FDynamicBuffer ();
 	~FDynamicBuffer ();
+	FDynamicBuffer (const FDynamicBuffer &) = delete;
+	FDynamicBuffer &operator= (const FDynamicBuffer &) = delete;
 
 	void SetData (const uint8_t *data, int len);
 	uint8_t *GetData (int *len = NULL);
 
 private:
+	enum { INLINE_SIZE = 128 };
+
 	uint8_t *m_Data;
 	int m_Len, m_BufferLen;
+	uint8_t m_Inline[INLINE_SIZE];
 };
 
 extern FDynamicBuffer NetSpecs[MAXPLAYERS][BACKUPTICS];
@@ -149,6 +156,10 @@ extern	int 			maketic;
 extern	int 			nettics[MAXNETNODES];
 extern	int				netdelay[MAXNETNODES][BACKUPTICS];
 extern	int 			nodeforplayer[MAXPLAYERS];
+extern	uint64_t		netbytesout[MAXNETNODES];	// bytes that went over the wire, after compression
+extern	uint64_t		netbytesin[MAXNETNODES];
+extern	unsigned		netpacketsout[MAXNETNODES];
+extern	unsigned		netpacketsin[MAXNETNODES];
 
 extern	ticcmd_t		netcmds[MAXPLAYERS][BACKUPTICS];
 extern	int 			ticdup;
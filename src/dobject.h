@@ -265,18 +265,18 @@ private:
 
 	void *operator new(size_t len, nonew&)
 	{
-		return M_Malloc(len);
+		return GC::AllocObject(len);
 	}
 public:
 
 	void operator delete (void *mem, nonew&)
 	{
-		M_Free(mem);
+		GC::FreeObject(mem);
 	}
 
 	void operator delete (void *mem)
 	{
-		M_Free(mem);
+		GC::FreeObject(mem);
 	}
 
 	// GC fiddling
@@ -343,7 +343,7 @@ protected:
 
 	void operator delete (void *mem, EInPlace *)
 	{
-		M_Free (mem);
+		GC::FreeObject (mem);
 	}
 
 	template<typename T, typename... Args>
@@ -389,6 +389,7 @@ static inline void GC::WriteBarrier(DObject *pointed)
 
 #include "memarena.h"
 extern FMemArena ClassDataAllocator;
+#include "tflatmap.h"
 #include "symbols.h"
 #include "dobjtype.h"
 
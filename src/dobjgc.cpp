@@ -80,6 +80,7 @@
 #include "intermission/intermission.h"
 #include "g_levellocals.h"
 #include "events.h"
+#include "i_time.h"
 
 // MACROS ------------------------------------------------------------------
 
@@ -118,6 +119,14 @@
 // Cost of calling of one destructor
 #define GCFINALIZECOST	100
 
+// Objects up to this size come from the slab pools. Pool sizes are
+// rounded up to a multiple of POOLGRANULARITY.
+#define POOLMAXSIZE		8192
+#define POOLGRANULARITY	16
+// Each slab is about this big, but holds at least POOLMINSLOTS objects.
+#define POOLSLABSIZE	65536
+#define POOLMINSLOTS	8
+
 // TYPES -------------------------------------------------------------------
 
 // This object is responsible for marking sectors during the propagate
@@ -140,6 +149,32 @@ IMPLEMENT_CLASS(DSectorMarker, false, false)
 
 // PUBLIC FUNCTION PROTOTYPES ----------------------------------------------
 
+struct FObjectSlab;
+
+// Comes before every object. While the object is allocated it points to the
+// slab it belongs to, or is null if it came from M_Malloc.
+struct alignas(16) FObjectHeader
+{
+	FObjectSlab *Slab;
+	FObjectHeader *NextFree;
+};
+
+struct FObjectPool
+{
+	size_t SlotSize;			// including the header
+	unsigned SlotsPerSlab;
+	FObjectSlab *Partial;		// slabs with free slots
+	FObjectSlab *Spare;			// one completely empty slab that is kept around
+};
+
+struct alignas(16) FObjectSlab
+{
+	FObjectPool *Pool;
+	FObjectSlab *Prev, *Next;
+	FObjectHeader *FreeList;
+	unsigned Used;
+};
+
 // PRIVATE FUNCTION PROTOTYPES ---------------------------------------------
 
 static size_t CalcStepSize();
@@ -150,6 +185,10 @@ extern DThinker *NextToThink;
 
 // PUBLIC DATA DEFINITIONS -------------------------------------------------
 
+// Upper bound for the time a single collection step may take, in microseconds.
+// Anything left over carries to the next CheckGC. 0 means no limit.
+CVAR(Int, gc_maxsteptime, 0, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+
 namespace GC
 {
 size_t AllocBytes;
@@ -166,16 +205,215 @@ int StepMul = DEFAULT_GCMUL;
 int StepCount;
 uint64_t CheckTime;
 bool FinalGC;
+size_t PoolUsed;
+size_t PoolReserved;
 
 // PRIVATE DATA DEFINITIONS ------------------------------------------------
 
 static DSectorMarker *SectorMarker;
+static FObjectPool *Pools[POOLMAXSIZE / POOLGRANULARITY + 1];
 static int LastCollectTime;		// Time last time collector finished
 static size_t LastCollectAlloc;	// Memory allocation when collector finished
 static size_t MinStepSize;		// Cover at least this much memory per step
+static int SweptObjects;		// Objects freed by the current sweep
+static int SweptDestroyed;		// ...and how many of those were destroyed by the game, not found unreachable
+static int LastSwept, LastSweptDestroyed;	// The same for the last finished collection
 
 // CODE --------------------------------------------------------------------
 
+//==========================================================================
+//
+// LinkSlab / UnlinkSlab
+//
+// Maintain a pool's list of slabs that still have free slots.
+//
+//==========================================================================
+
+static void LinkSlab(FObjectPool *pool, FObjectSlab *slab)
+{
+	slab->Prev = nullptr;
+	slab->Next = pool->Partial;
+	if (pool->Partial != nullptr)
+	{
+		pool->Partial->Prev = slab;
+	}
+	pool->Partial = slab;
+}
+
+static void UnlinkSlab(FObjectPool *pool, FObjectSlab *slab)
+{
+	if (slab->Prev != nullptr)
+	{
+		slab->Prev->Next = slab->Next;
+	}
+	else
+	{
+		pool->Partial = slab->Next;
+	}
+	if (slab->Next != nullptr)
+	{
+		slab->Next->Prev = slab->Prev;
+	}
+	slab->Prev = slab->Next = nullptr;
+}
+
+//==========================================================================
+//
+// NewSlab
+//
+// Slabs don't go through M_Malloc. AllocBytes should count only the
+// objects in them, not the free space the collector can do nothing about.
+//
+//==========================================================================
+
+static FObjectSlab *NewSlab(FObjectPool *pool)
+{
+	size_t size = sizeof(FObjectSlab) + pool->SlotSize * pool->SlotsPerSlab;
+	FObjectSlab *slab = (FObjectSlab *)malloc(size);
+	if (slab == nullptr)
+	{
+		I_FatalError("Could not malloc %zu bytes", size);
+	}
+	slab->Pool = pool;
+	slab->Prev = slab->Next = nullptr;
+	slab->Used = 0;
+
+	// Hand out the slots in address order.
+	uint8_t *slots = (uint8_t *)(slab + 1);
+	FObjectHeader *next = nullptr;
+	for (unsigned i = pool->SlotsPerSlab; i-- > 0; )
+	{
+		FObjectHeader *slot = (FObjectHeader *)(slots + i * pool->SlotSize);
+		slot->NextFree = next;
+		next = slot;
+	}
+	slab->FreeList = next;
+	PoolReserved += size;
+	return slab;
+}
+
+static void FreeSlab(FObjectSlab *slab)
+{
+	PoolReserved -= sizeof(FObjectSlab) + slab->Pool->SlotSize * slab->Pool->SlotsPerSlab;
+	free(slab);
+}
+
+//==========================================================================
+//
+// AllocObject
+//
+// Gets memory for a new object. Objects of the same size share slabs.
+// That keeps the steady stream of projectiles and puffs from fragmenting
+// the heap, and places actors of the same class close together.
+//
+//==========================================================================
+
+void *AllocObject(size_t size)
+{
+	FObjectHeader *header;
+
+	if (size > POOLMAXSIZE)
+	{
+		header = (FObjectHeader *)M_Malloc(sizeof(FObjectHeader) + size);
+		header->Slab = nullptr;
+		return header + 1;
+	}
+
+	size_t index = (size + POOLGRANULARITY - 1) / POOLGRANULARITY;
+	FObjectPool *pool = Pools[index];
+	if (pool == nullptr)
+	{
+		pool = Pools[index] = new FObjectPool;
+		pool->SlotSize = sizeof(FObjectHeader) + index * POOLGRANULARITY;
+		pool->SlotsPerSlab = MAX<unsigned>(POOLMINSLOTS, unsigned(POOLSLABSIZE / pool->SlotSize));
+		pool->Partial = nullptr;
+		pool->Spare = nullptr;
+	}
+
+	FObjectSlab *slab = pool->Partial;
+	if (slab == nullptr)
+	{
+		if (pool->Spare != nullptr)
+		{
+			slab = pool->Spare;
+			pool->Spare = nullptr;
+		}
+		else
+		{
+			slab = NewSlab(pool);
+		}
+		LinkSlab(pool, slab);
+	}
+
+	header = slab->FreeList;
+	slab->FreeList = header->NextFree;
+	if (slab->FreeList == nullptr)
+	{
+		UnlinkSlab(pool, slab);
+	}
+	slab->Used++;
+	header->Slab = slab;
+	AllocBytes += pool->SlotSize;
+	PoolUsed += pool->SlotSize;
+	M_TrackMemory(MEMTAG_OBJECTS, pool->SlotSize);
+	return header + 1;
+}
+
+//==========================================================================
+//
+// FreeObject
+//
+// Returns an object's memory to its slab. Each pool keeps only one empty
+// slab, so a burst of objects doesn't hold on to its memory forever.
+//
+//==========================================================================
+
+void FreeObject(void *mem)
+{
+	if (mem == nullptr)
+	{
+		return;
+	}
+
+	FObjectHeader *header = (FObjectHeader *)mem - 1;
+	FObjectSlab *slab = header->Slab;
+	if (slab == nullptr)
+	{
+		M_Free(header);
+		return;
+	}
+
+	FObjectPool *pool = slab->Pool;
+	bool wasfull = slab->FreeList == nullptr;
+	header->Slab = nullptr;
+	header->NextFree = slab->FreeList;
+	slab->FreeList = header;
+	slab->Used--;
+	AllocBytes -= pool->SlotSize;
+	PoolUsed -= pool->SlotSize;
+	M_TrackMemory(MEMTAG_OBJECTS, -ptrdiff_t(pool->SlotSize));
+
+	if (slab->Used == 0)
+	{
+		if (!wasfull)
+		{
+			UnlinkSlab(pool, slab);
+		}
+		if (pool->Spare == nullptr)
+		{
+			pool->Spare = slab;
+		}
+		else
+		{
+			FreeSlab(slab);
+		}
+	}
+	else if (wasfull)
+	{
+		LinkSlab(pool, slab);
+	}
+}
+
 //==========================================================================
 //
 // SetThreshold
@@ -253,7 +491,12 @@ static DObject **SweepList(DObject **p, size_t count, size_t *finalize_count)
 		{
 			assert(curr->IsDead());
 			*p = curr->ObjNext;
-			if (!(curr->ObjectFlags & OF_EuthanizeMe))
+			SweptObjects++;
+			if (curr->ObjectFlags & OF_EuthanizeMe)
+			{
+				SweptDestroyed++;
+			}
+			else
 			{	// The object must be destroyed before it can be finalized.
 				// Note that thinkers must already have been destroyed. If they get here without
 				// having been destroyed first, it means they somehow became unattached from the
@@ -429,6 +672,7 @@ static void Atomic()
 	SweepPos = &Root;
 	State = GCS_Sweep;
 	Estimate = AllocBytes;
+	SweptObjects = SweptDestroyed = 0;
 
 	// Now that we are about to start a sweep, establish a baseline minimum
 	// step size for how much memory we want to sweep each CheckGC().
@@ -479,6 +723,8 @@ static size_t SingleStep()
 		State = GCS_Pause;		// end collection
 		LastCollectAlloc = AllocBytes;
 		LastCollectTime = CheckTime;
+		LastSwept = SweptObjects;
+		LastSweptDestroyed = SweptDestroyed;
 		return 0;
 
 	default:
@@ -498,11 +744,22 @@ static size_t SingleStep()
 
 void Step()
 {
+	PROFILE_ZONE("GC step");
 	// We recalculate a step size in case the rate of allocation went up
 	// since we started sweeping because we don't want to fall behind.
 	// However, we also don't want to go slower than what was decided upon
 	// when the sweep began if the rate of allocation has slowed.
 	size_t lim = MAX(CalcStepSize(), MinStepSize);
+
+	// A time limit spreads the work over more calls, but if memory has grown
+	// to twice what it was at the start of the cycle, the collector has fallen
+	// too far behind and has to catch up regardless.
+	uint64_t deadline = 0;
+	if (gc_maxsteptime > 0 && AllocBytes < Estimate * 2)
+	{
+		deadline = I_nsTime() + uint64_t(gc_maxsteptime) * 1000;
+	}
+	int steps = 0;
 	do
 	{
 		size_t done = SingleStep();
@@ -514,6 +771,11 @@ void Step()
 		{
 			lim = 0;
 		}
+		// Reading the clock isn't free, so only do it every few steps.
+		if (deadline != 0 && (++steps & 15) == 0 && I_nsTime() >= deadline)
+		{
+			break;
+		}
 	} while (lim && State != GCS_Pause);
 	if (State != GCS_Pause)
 	{
@@ -537,6 +799,7 @@ void Step()
 
 void FullGC()
 {
+	PROFILE_ZONE("Full GC");
 	if (State <= GCS_Propagate)
 	{
 		// Reset sweep mark to sweep all elements (returning them to white)
@@ -763,13 +1026,16 @@ ADD_STAT(gc)
 		"  Sweep  ",
 		"Finalize " };
 	FString out;
-	out.Format("[%s] Alloc:%6zuK  Thresh:%6zuK  Est:%6zuK  Steps: %d  %zuK",
+	out.Format("[%s] Alloc:%6zuK  Thresh:%6zuK  Est:%6zuK  Steps: %d  %zuK  Pool:%6zuK/%6zuK  Freed: %d (%d destroyed)",
 		StateStrings[GC::State],
 		(GC::AllocBytes + 1023) >> 10,
 		(GC::Threshold + 1023) >> 10,
 		(GC::Estimate + 1023) >> 10,
 		GC::StepCount,
-		(GC::MinStepSize + 1023) >> 10);
+		(GC::MinStepSize + 1023) >> 10,
+		(GC::PoolUsed + 1023) >> 10,
+		(GC::PoolReserved + 1023) >> 10,
+		GC::LastSwept, GC::LastSweptDestroyed);
 	return out;
 }
 
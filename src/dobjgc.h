@@ -136,6 +136,15 @@ namespace GC
 	// Unroots an object.
 	void DelSoftRoot(DObject *obj);
 
+	// Allocates and frees the memory for DObjects. Objects of the same size
+	// share slabs, with big ones going to M_Malloc directly.
+	void *AllocObject(size_t size);
+	void FreeObject(void *mem);
+
+	// Bytes of pooled objects in use and bytes reserved for the pools.
+	extern size_t PoolUsed;
+	extern size_t PoolReserved;
+
 	template<class T> void Mark(T *&obj)
 	{
 		union
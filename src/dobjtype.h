@@ -69,6 +69,7 @@ public:
 	TArray<FTypeAndOffset> SpecialInits;
 	TArray<PField *> Fields;
 	PClassType			*VMType = nullptr;
+	TArray<int>			 ThinkerCounts;	// linked thinkers of this class or a subclass, per statnum
 
 	void (*ConstructNative)(void *);
 
@@ -125,6 +125,7 @@ extern	bool			viewactive;
 
 extern	bool	 		nodrawers;
 extern	bool	 		noblit;
+extern	bool			headless;		// -headless: a host nobody watches. No drawing, no sound.
 
 extern	int 			viewwindowx;
 extern	int 			viewwindowy;
@@ -36,6 +36,7 @@
 #include "stats.h"
 #include "p_local.h"
 #include "p_effect.h"
+#include "p_spec.h"
 #include "statnums.h"
 #include "i_system.h"
 #include "doomerrors.h"
@@ -45,12 +46,13 @@
 #include "vm.h"
 #include "c_dispatch.h"
 #include "v_text.h"
+#include "jobs.h"
 #include "g_levellocals.h"
 #include "a_dynlight.h"
 
 
 static int ThinkCount;
-static cycle_t ThinkCycles;
+cycle_t ThinkCycles;		// also logged per tic by -timedemolog
 extern cycle_t BotSupportCycles;
 extern cycle_t ActionCycles;
 extern int BotWTG;
@@ -59,6 +61,14 @@ extern int currentrenderer;
 EXTERN_CVAR (Bool, gl_lights)
 EXTERN_CVAR (Bool, r_dynlights)
 
+// Tick independent thinkers (see DThinker::GetTickKey) on worker threads.
+// The result is identical to serial ticking so this is safe for demos and netgames.
+CVAR (Bool, sv_parallelthinkers, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+CVAR (Int, sv_parallelthinkers_min, 256, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+// Only lists whose thinkers are known not to interact across keys are considered.
+static const int ParallelStatnums[] = { STAT_LIGHT };
+
 IMPLEMENT_CLASS(DThinker, false, false)
 
 DThinker *NextToThink;
@@ -67,6 +77,32 @@ FThinkerList DThinker::Thinkers[MAX_STATNUM+2];
 FThinkerList DThinker::FreshThinkers[MAX_STATNUM+1];
 bool DThinker::bSerialOverride = false;
 
+//==========================================================================
+//
+// Every class keeps count of how many linked thinkers of it or of any of
+// its subclasses each statnum has, so that FThinkerIterator can skip the
+// lists that can't contain anything it is looking for.
+//
+//==========================================================================
+
+static void CountThinker(DThinker *thinker, int statnum, int delta)
+{
+	for (PClass *cls = thinker->GetClass(); cls != nullptr; cls = cls->ParentClass)
+	{
+		if (cls->ThinkerCounts.Size() == 0)
+		{
+			cls->ThinkerCounts.Resize(MAX_STATNUM + 2);
+			memset(cls->ThinkerCounts.Data(), 0, cls->ThinkerCounts.Size() * sizeof(int));
+		}
+		cls->ThinkerCounts[statnum] += delta;
+	}
+}
+
+static inline bool MayHaveThinkers(const PClass *type, int statnum)
+{
+	return type->ThinkerCounts.Size() > 0 && type->ThinkerCounts[statnum] > 0;
+}
+
 //==========================================================================
 //
 //
@@ -95,6 +131,12 @@ void FThinkerList::AddTail(DThinker *thinker)
 	GC::WriteBarrier(thinker, Sentinel);
 	GC::WriteBarrier(tail, thinker);
 	GC::WriteBarrier(Sentinel, thinker);
+
+	if (this >= DThinker::FreshThinkers && this < DThinker::FreshThinkers + countof(DThinker::FreshThinkers))
+		thinker->ListStat = uint8_t(this - DThinker::FreshThinkers);
+	else
+		thinker->ListStat = uint8_t(this - DThinker::Thinkers);
+	CountThinker(thinker, thinker->ListStat, 1);
 }
 
 //==========================================================================
@@ -304,6 +346,11 @@ void DThinker::Remove()
 	GC::WriteBarrier(next, prev);
 	NextThinker = nullptr;
 	PrevThinker = nullptr;
+	if (ListStat != 0xff)
+	{
+		CountThinker(this, ListStat, -1);
+		ListStat = 0xff;
+	}
 }
 
 //==========================================================================
@@ -494,6 +541,11 @@ bool DThinker::DoDestroyThinkersInList (FThinkerList &list)
 			auto next = node->NextThinker;
 			toDelete.Push(node);
 			node->NextThinker = node->PrevThinker = nullptr;	// clear the links
+			if (node->ListStat != 0xff)
+			{
+				CountThinker(node, node->ListStat, -1);
+				node->ListStat = 0xff;
+			}
 			node = next;
 		}
 		list.Sentinel->NextThinker = list.Sentinel->PrevThinker = nullptr;
@@ -590,21 +642,37 @@ struct ProfileInfo
 {
 	int numcalls = 0;
 	cycle_t timer;
+	cycle_t categories[NUM_TPC];
 
 	ProfileInfo()
 	{
 		timer.Reset();
+		for (auto &cat : categories) cat.Reset();
 	}
 };
 
+struct ProfileInstance
+{
+	FName className;
+	int tid;
+	DVector3 pos;
+	double time;
+};
+
 TMap<FName, ProfileInfo> Profiles;
+static TArray<ProfileInstance> ProfileInstances;
+
+cycle_t *ThinkerProfileTimers;
+int ThinkerProfileCategory;
 
 
 void DThinker::RunThinkers ()
 {
+	PROFILE_ZONE("Thinkers");
 	int i, count;
 
 	ThinkCount = 0;
+	ThinkerProfileTimers = nullptr;	// in case a VM abort left it set
 	ThinkCycles.Reset();
 	BotSupportCycles.Reset();
 	ActionCycles.Reset();
@@ -656,7 +724,19 @@ void DThinker::RunThinkers ()
 		// Tick every thinker left from last time
 		for (i = STAT_FIRST_THINKING; i <= MAX_STATNUM; ++i)
 		{
-			TickThinkers(&Thinkers[i], NULL);
+			bool parallel = false;
+			if (sv_parallelthinkers)
+			{
+				for (int stat : ParallelStatnums) if (stat == i) parallel = true;
+			}
+			if (i == STAT_SCROLLER && (count = P_TickScrollers(&Thinkers[i])) >= 0)
+			{
+				ThinkCount += count;
+			}
+			else if (!parallel || TickThinkersParallel(&Thinkers[i]) < 0)
+			{
+				TickThinkers(&Thinkers[i], NULL);
+			}
 		}
 
 		// Keep ticking the fresh thinkers until there are no new ones.
@@ -683,6 +763,7 @@ void DThinker::RunThinkers ()
 	else
 	{
 		Profiles.Clear();
+		ProfileInstances.Clear();
 		// Tick every thinker left from last time
 		for (i = STAT_FIRST_THINKING; i <= MAX_STATNUM; ++i)
 		{
@@ -721,6 +802,7 @@ void DThinker::RunThinkers ()
 			const char* className;
 			int numcalls;
 			double time;
+			double categories[NUM_TPC];
 		};
 
 		TArray<SortedProfileInfo> sorted;
@@ -730,7 +812,9 @@ void DThinker::RunThinkers ()
 		TMap<FName, ProfileInfo>::Pair *pair;
 		while (it.NextPair(pair))
 		{
-			sorted.Push({ pair->Key.GetChars(), pair->Value.numcalls, pair->Value.timer.TimeMS() });
+			SortedProfileInfo info = { pair->Key.GetChars(), pair->Value.numcalls, pair->Value.timer.TimeMS() };
+			for (int j = 0; j < NUM_TPC; j++) info.categories[j] = pair->Value.categories[j].TimeMS();
+			sorted.Push(info);
 		}
 
 		std::sort(sorted.begin(), sorted.end(), [](const SortedProfileInfo& left, const SortedProfileInfo& right)
@@ -756,21 +840,41 @@ void DThinker::RunThinkers ()
 			}
 		});
 
-		Printf(TEXTCOLOR_YELLOW "Total, ms   Averg, ms   Calls   Actor class\n");
-		Printf(TEXTCOLOR_YELLOW "----------  ----------  ------  --------------------\n");
+		Printf(TEXTCOLOR_YELLOW "Total, ms   Averg, ms   Calls   Native, ms  Move, ms    Action, ms  Script, ms  Collide, ms  Actor class\n");
+		Printf(TEXTCOLOR_YELLOW "----------  ----------  ------  ----------  ----------  ----------  ----------  -----------  --------------------\n");
 
 		const unsigned count = MIN(profilelimit > 0 ? profilelimit : UINT_MAX, sorted.Size());
 
 		for (unsigned i = 0; i < count; ++i)
 		{
 			const SortedProfileInfo& info = sorted[i];
-			Printf("%s%10.6f  %s%10.6f  %s%6d  %s%s\n",
+			Printf("%s%10.6f  %s%10.6f  %s%6d  " TEXTCOLOR_WHITE "%10.6f  %10.6f  %10.6f  %10.6f  %11.6f  %s%s\n",
 				profilethinkers >= 7 ? TEXTCOLOR_YELLOW : TEXTCOLOR_WHITE, info.time,
 				profilethinkers == 5 || profilethinkers == 6 ? TEXTCOLOR_YELLOW : TEXTCOLOR_WHITE, info.time / info.numcalls,
 				profilethinkers == 3 || profilethinkers == 4 ? TEXTCOLOR_YELLOW : TEXTCOLOR_WHITE, info.numcalls,
+				info.categories[TPC_Native], info.categories[TPC_Movement], info.categories[TPC_Action],
+				info.categories[TPC_Script], info.categories[TPC_Collision],
 				profilethinkers == 1 || profilethinkers == 2 ? TEXTCOLOR_YELLOW : TEXTCOLOR_WHITE, info.className);
 		}
 
+		// The single actors that cost the most, so that a culprit can be found on the map.
+		std::sort(ProfileInstances.begin(), ProfileInstances.end(), [](const ProfileInstance &left, const ProfileInstance &right)
+		{
+			return right.time < left.time;
+		});
+
+		Printf(TEXTCOLOR_YELLOW "\nTime, ms    TID     Position                        Actor class\n");
+		Printf(TEXTCOLOR_YELLOW "----------  ------  ------------------------------  --------------------\n");
+
+		const unsigned numinstances = MIN(profilelimit > 0 ? profilelimit : 10u, ProfileInstances.Size());
+
+		for (unsigned i = 0; i < numinstances; ++i)
+		{
+			const ProfileInstance &inst = ProfileInstances[i];
+			Printf("%10.6f  %6d  %9.1f %9.1f %9.1f      %s\n", inst.time, inst.tid, inst.pos.X, inst.pos.Y, inst.pos.Z, inst.className.GetChars());
+		}
+		ProfileInstances.Clear();
+
 		profilethinkers = 0;
 	}
 
@@ -823,6 +927,111 @@ int DThinker::TickThinkers (FThinkerList *list, FThinkerList *dest)
 	return count;
 }
 
+//==========================================================================
+//
+// Ticks a list of thinkers, running all groups of thinkers that share a
+// tick key and are all parallel safe on worker threads. The remaining
+// groups are ticked afterwards on the main thread, in their original order.
+// Since the groups do not share any data this produces the same results
+// as TickThinkers. Returns -1 if the list must be ticked serially.
+//
+//==========================================================================
+
+int DThinker::TickThinkersParallel(FThinkerList *list)
+{
+	struct TickGroup
+	{
+		bool parallel;
+		TArray<DThinker *> nodes;
+	};
+
+	DThinker *node = list->GetHead();
+	if (node == nullptr)
+	{
+		return 0;
+	}
+
+	static TArray<TickGroup> groups;
+	static TArray<unsigned> order;	// group index of each thinker, in list order
+	TMap<void *, unsigned> groupindex;
+	unsigned numparallel = 0;
+
+	groups.Clear();
+	order.Clear();
+	for (; node != list->Sentinel; node = node->NextThinker)
+	{
+		if (node->ObjectFlags & OF_EuthanizeMe) continue;
+
+		void *key = node->GetTickKey();
+		if (key == nullptr || (node->ObjectFlags & OF_JustSpawned))
+		{
+			return -1;
+		}
+		// Scripted subclasses call into the VM which cannot be entered from more than one thread.
+		bool parallel = node->CanTickParallel() && !node->GetClass()->bRuntimeClass;
+
+		unsigned *pindex = groupindex.CheckKey(key);
+		unsigned index;
+		if (pindex == nullptr)
+		{
+			index = groups.Reserve(1);
+			groupindex[key] = index;
+			groups[index].parallel = parallel;
+			groups[index].nodes.Clear();
+		}
+		else
+		{
+			index = *pindex;
+			groups[index].parallel &= parallel;
+		}
+		groups[index].nodes.Push(node);
+		order.Push(index);
+	}
+
+	for (auto &group : groups)
+	{
+		if (group.parallel) numparallel += group.nodes.Size();
+	}
+	if (numparallel < (unsigned)MAX<int>(sv_parallelthinkers_min, 1))
+	{
+		return -1;
+	}
+
+	unsigned numthreads = Jobs.NumThreads();
+	numthreads = MIN(numthreads, groups.Size());
+
+	auto worker = [](unsigned first, unsigned step)
+	{
+		for (unsigned g = first; g < groups.Size(); g += step)
+		{
+			if (!groups[g].parallel) continue;
+			for (auto thinker : groups[g].nodes)
+			{
+				thinker->Tick();
+			}
+		}
+	};
+
+	Jobs.RunParallel(numthreads, [=](unsigned t) { worker(t, numthreads); });
+	ThinkCount += numparallel;
+
+	// Everything else runs on the main thread in list order so that the random
+	// number sequence is not altered. The per-group node lists hold the thinkers
+	// in list order, so walking 'order' hands them out in sequence.
+	static TArray<unsigned> next;
+	next.Resize(groups.Size());
+	for (auto &n : next) n = 0;
+	for (auto index : order)
+	{
+		auto &group = groups[index];
+		DThinker *thinker = group.nodes[next[index]++];
+		if (group.parallel || (thinker->ObjectFlags & OF_EuthanizeMe)) continue;
+		ThinkCount++;
+		thinker->CallTick();
+	}
+	return numparallel;
+}
+
 //==========================================================================
 //
 //
@@ -862,10 +1071,27 @@ int DThinker::ProfileThinkers(FThinkerList *list, FThinkerList *dest)
 			ThinkCount++;
 
 			auto &prof = Profiles[node->GetClass()->TypeName];
+			cycle_t instancetime;
+			instancetime.Reset();
 			prof.numcalls++;
 			prof.timer.Clock();
+			instancetime.Clock();
+
+			ThinkerProfileTimers = prof.categories;
+			ThinkerProfileCategory = TPC_Native;
+			prof.categories[TPC_Native].Clock();
 			node->CallTick();
+			prof.categories[ThinkerProfileCategory].Unclock();
+			ThinkerProfileTimers = nullptr;
+
+			instancetime.Unclock();
 			prof.timer.Unclock();
+
+			if (node->IsKindOf(RUNTIME_CLASS(AActor)))
+			{
+				auto actor = static_cast<AActor *>(node);
+				ProfileInstances.Push({ actor->GetClass()->TypeName, actor->tid, actor->Pos(), instancetime.TimeMS() });
+			}
 			node->ObjectFlags &= ~OF_JustSpawned;
 		}
 		node = NextToThink;
@@ -886,6 +1112,7 @@ void DThinker::Tick ()
 DEFINE_ACTION_FUNCTION(DThinker, Tick)
 {
 	PARAM_SELF_PROLOGUE(DThinker);
+	FThinkerProfileScope profile(TPC_Native);
 	self->Tick();
 	return 0;
 }
@@ -896,6 +1123,7 @@ void DThinker::CallTick()
 	{
 		// Without the type cast this picks the 'void *' assignment...
 		VMValue params[1] = { (DObject*)this };
+		FThinkerProfileScope profile(TPC_Script);
 		VMCall(func, params, 1, nullptr, 0);
 	}
 	else Tick();
@@ -999,32 +1227,36 @@ DThinker *FThinkerIterator::Next (bool exact)
 	}
 	do
 	{
-		do
+		// Lists that don't contain any thinker of this type don't need to be searched.
+		if (MayHaveThinkers(m_ParentType, m_Stat))
 		{
-			if (m_CurrThinker != NULL)
+			do
 			{
-				while (!(m_CurrThinker->ObjectFlags & OF_Sentinel))
+				if (m_CurrThinker != NULL)
 				{
-					DThinker *thinker = m_CurrThinker;
-					m_CurrThinker = thinker->NextThinker;
-					if (exact)
+					while (!(m_CurrThinker->ObjectFlags & OF_Sentinel))
 					{
-						if (thinker->IsA(m_ParentType)) return thinker;
-					}
-					else if (thinker->IsKindOf(m_ParentType))
-					{
-						return thinker;
+						DThinker *thinker = m_CurrThinker;
+						m_CurrThinker = thinker->NextThinker;
+						if (exact)
+						{
+							if (thinker->IsA(m_ParentType)) return thinker;
+						}
+						else if (thinker->IsKindOf(m_ParentType))
+						{
+							return thinker;
+						}
+						// This can actually happen when a Destroy call on 'thinker' happens to destroy 'm_CurrThinker'.
+						// In that case there is no chance to recover, we have to terminate the iteration of this list.
+						if (m_CurrThinker == nullptr) break;
 					}
-					// This can actually happen when a Destroy call on 'thinker' happens to destroy 'm_CurrThinker'.
-					// In that case there is no chance to recover, we have to terminate the iteration of this list.
-					if (m_CurrThinker == nullptr) break;
 				}
-			}
-			if ((m_SearchingFresh = !m_SearchingFresh))
-			{
-				m_CurrThinker = DThinker::FreshThinkers[m_Stat].GetHead();
-			}
-		} while (m_SearchingFresh);
+				if ((m_SearchingFresh = !m_SearchingFresh))
+				{
+					m_CurrThinker = DThinker::FreshThinkers[m_Stat].GetHead();
+				}
+			} while (m_SearchingFresh);
+		}
 		if (m_SearchStats)
 		{
 			m_Stat++;
@@ -37,6 +37,7 @@
 #include <stdlib.h>
 #include "dobject.h"
 #include "statnums.h"
+#include "stats.h"
 
 class AActor;
 class player_t;
@@ -80,6 +81,13 @@ public:
 	
 	void ChangeStatNum (int statnum);
 
+	// For parallel ticking: thinkers returning the same non-null key touch the same
+	// data and are always ticked in list order relative to each other. A thinker
+	// with a null key may touch anything and forces its list to tick serially.
+	virtual void *GetTickKey() const { return nullptr; }
+	// True if Tick() may run on a worker thread (no RNG, no allocations, no VM calls)
+	virtual bool CanTickParallel() const { return false; }
+
 	static void RunThinkers ();
 	static void RunThinkers (int statnum);
 	static void DestroyAllThinkers ();
@@ -102,6 +110,7 @@ private:
 	static bool DoDestroyThinkersInList(FThinkerList &list);
 	static int TickThinkers (FThinkerList *list, FThinkerList *dest);	// Returns: # of thinkers ticked
 	static int ProfileThinkers(FThinkerList *list, FThinkerList *dest);
+	static int TickThinkersParallel(FThinkerList *list);
 	static void SaveList(FSerializer &arc, DThinker *node);
 	void Remove();
 
@@ -112,13 +121,67 @@ private:
 	friend class FThinkerIterator;
 	friend class DObject;
 	friend class FSerializer;
+	friend int P_TickScrollers(FThinkerList *list);
 
 	DThinker *NextThinker, *PrevThinker;
+	uint8_t ListStat = 0xff;	// statnum of the list this is linked into, for PClass::ThinkerCounts
 
 public:
 	FLevelLocals *Level = &level;
 };
 
+//==========================================================================
+//
+// While 'profilethinkers' runs, each thinker's time is split into these
+// categories. A scope charges the time to its category until it ends or
+// a nested scope starts, so every category only holds its own time.
+//
+//==========================================================================
+
+enum EThinkerProfileCategory
+{
+	TPC_Native,		// everything not covered by the others
+	TPC_Movement,
+	TPC_Action,
+	TPC_Script,
+	TPC_Collision,
+	NUM_TPC
+};
+
+extern cycle_t *ThinkerProfileTimers;	// only set while a thinker is profiled
+extern int ThinkerProfileCategory;
+
+class FThinkerProfileScope
+{
+public:
+	FThinkerProfileScope(int category)
+	{
+		Timers = ThinkerProfileTimers;
+		if (Timers != nullptr)
+		{
+			Previous = ThinkerProfileCategory;
+			Timers[Previous].Unclock();
+			Timers[category].Clock();
+			ThinkerProfileCategory = category;
+		}
+	}
+	~FThinkerProfileScope()
+	{
+		if (Timers != nullptr)
+		{
+			Timers[ThinkerProfileCategory].Unclock();
+			Timers[Previous].Clock();
+			ThinkerProfileCategory = Previous;
+		}
+	}
+	FThinkerProfileScope(const FThinkerProfileScope &) = delete;
+	FThinkerProfileScope &operator=(const FThinkerProfileScope &) = delete;
+
+private:
+	cycle_t *Timers;
+	int Previous;
+};
+
 class FThinkerIterator
 {
 protected:
@@ -319,7 +319,8 @@ void E_Shutdown(bool map)
 #define DEFINE_EVENT_LOOPER(name) void E_##name() \
 { \
 	for (DStaticEventHandler* handler = E_FirstEventHandler; handler; handler = handler->next) \
-		handler->name(); \
+		if (handler->Subscribes(EVS_##name)) \
+			handler->name(); \
 }
 
 // note for the functions below.
@@ -369,7 +370,8 @@ void E_WorldThingSpawned(AActor* actor)
 	if (actor->ObjectFlags & OF_EuthanizeMe)
 		return;
 	for (DStaticEventHandler* handler = E_FirstEventHandler; handler; handler = handler->next)
-		handler->WorldThingSpawned(actor);
+		if (handler->Subscribes(EVS_WorldThingSpawned))
+			handler->WorldThingSpawned(actor);
 }
 
 void E_WorldThingDied(AActor* actor, AActor* inflictor)
@@ -378,7 +380,8 @@ void E_WorldThingDied(AActor* actor, AActor* inflictor)
 	if (actor->ObjectFlags & OF_EuthanizeMe)
 		return;
 	for (DStaticEventHandler* handler = E_FirstEventHandler; handler; handler = handler->next)
-		handler->WorldThingDied(actor, inflictor);
+		if (handler->Subscribes(EVS_WorldThingDied))
+			handler->WorldThingDied(actor, inflictor);
 }
 
 void E_WorldThingGround(AActor* actor, FState* st)
@@ -387,7 +390,8 @@ void E_WorldThingGround(AActor* actor, FState* st)
 	if (actor->ObjectFlags & OF_EuthanizeMe)
 		return;
 	for (DStaticEventHandler* handler = E_FirstEventHandler; handler; handler = handler->next)
-		handler->WorldThingGround(actor, st);
+		if (handler->Subscribes(EVS_WorldThingGround))
+			handler->WorldThingGround(actor, st);
 }
 
 void E_WorldThingRevived(AActor* actor)
@@ -396,7 +400,8 @@ void E_WorldThingRevived(AActor* actor)
 	if (actor->ObjectFlags & OF_EuthanizeMe)
 		return;
 	for (DStaticEventHandler* handler = E_FirstEventHandler; handler; handler = handler->next)
-		handler->WorldThingRevived(actor);
+		if (handler->Subscribes(EVS_WorldThingRevived))
+			handler->WorldThingRevived(actor);
 }
 
 void E_WorldThingDamaged(AActor* actor, AActor* inflictor, AActor* source, int damage, FName mod, int flags, DAngle angle)
@@ -405,7 +410,8 @@ void E_WorldThingDamaged(AActor* actor, AActor* inflictor, AActor* source, int d
 	if (actor->ObjectFlags & OF_EuthanizeMe)
 		return;
 	for (DStaticEventHandler* handler = E_FirstEventHandler; handler; handler = handler->next)
-		handler->WorldThingDamaged(actor, inflictor, source, damage, mod, flags, angle);
+		if (handler->Subscribes(EVS_WorldThingDamaged))
+			handler->WorldThingDamaged(actor, inflictor, source, damage, mod, flags, angle);
 }
 
 void E_WorldThingDestroyed(AActor* actor)
@@ -418,32 +424,37 @@ void E_WorldThingDestroyed(AActor* actor)
 	if (!(actor->ObjectFlags & OF_Spawned))
 		return;
 	for (DStaticEventHandler* handler = E_LastEventHandler; handler; handler = handler->prev)
-		handler->WorldThingDestroyed(actor);
+		if (handler->Subscribes(EVS_WorldThingDestroyed))
+			handler->WorldThingDestroyed(actor);
 }
 
 void E_WorldLinePreActivated(line_t* line, AActor* actor, int activationType, bool* shouldactivate)
 {
 	for (DStaticEventHandler* handler = E_FirstEventHandler; handler; handler = handler->next)
-		handler->WorldLinePreActivated(line, actor, activationType, shouldactivate);
+		if (handler->Subscribes(EVS_WorldLinePreActivated))
+			handler->WorldLinePreActivated(line, actor, activationType, shouldactivate);
 }
 
 void E_WorldLineActivated(line_t* line, AActor* actor, int activationType)
 {
 	for (DStaticEventHandler* handler = E_FirstEventHandler; handler; handler = handler->next)
-		handler->WorldLineActivated(line, actor, activationType);
+		if (handler->Subscribes(EVS_WorldLineActivated))
+			handler->WorldLineActivated(line, actor, activationType);
 }
 
 int E_WorldSectorDamaged(sector_t* sector, AActor* source, int damage, FName damagetype, int part, DVector3 position, bool isradius)
 {
 	for (DStaticEventHandler* handler = E_FirstEventHandler; handler; handler = handler->next)
-		damage = handler->WorldSectorDamaged(sector, source, damage, damagetype, part, position, isradius);
+		if (handler->Subscribes(EVS_WorldSectorDamaged))
+			damage = handler->WorldSectorDamaged(sector, source, damage, damagetype, part, position, isradius);
 	return damage;
 }
 
 int E_WorldLineDamaged(line_t* line, AActor* source, int damage, FName damagetype, int side, DVector3 position, bool isradius)
 {
 	for (DStaticEventHandler* handler = E_FirstEventHandler; handler; handler = handler->next)
-		damage = handler->WorldLineDamaged(line, source, damage, damagetype, side, position, isradius);
+		if (handler->Subscribes(EVS_WorldLineDamaged))
+			damage = handler->WorldLineDamaged(line, source, damage, damagetype, side, position, isradius);
 	return damage;
 }
 
@@ -544,13 +555,15 @@ void E_Console(int player, FString name, int arg1, int arg2, int arg3, bool manu
 void E_RenderOverlay(EHudState state)
 {
 	for (DStaticEventHandler* handler = E_FirstEventHandler; handler; handler = handler->next)
-		handler->RenderOverlay(state);
+		if (handler->Subscribes(EVS_RenderOverlay))
+			handler->RenderOverlay(state);
 }
 
 void E_RenderUnderlay(EHudState state)
 {
 	for (DStaticEventHandler* handler = E_FirstEventHandler; handler; handler = handler->next)
-		handler->RenderUnderlay(state);
+		if (handler->Subscribes(EVS_RenderUnderlay))
+			handler->RenderUnderlay(state);
 }
 
 bool E_CheckUiProcessors()
@@ -575,7 +588,8 @@ bool E_CheckReplacement( PClassActor *replacee, PClassActor **replacement )
 {
 	bool final = false;
 	for (DStaticEventHandler *handler = E_FirstEventHandler; handler; handler = handler->next)
-		handler->CheckReplacement(replacee,replacement,&final);
+		if (handler->Subscribes(EVS_CheckReplacement))
+			handler->CheckReplacement(replacee,replacement,&final);
 	return final;
 }
 
@@ -583,7 +597,8 @@ bool E_CheckReplacee(PClassActor **replacee, PClassActor *replacement)
 {
 	bool final = false;
 	for (DStaticEventHandler *handler = E_FirstEventHandler; handler; handler = handler->next)
-		handler->CheckReplacee(replacee, replacement, &final);
+		if (handler->Subscribes(EVS_CheckReplacee))
+			handler->CheckReplacee(replacee, replacement, &final);
 	return final;
 }
 
@@ -742,6 +757,58 @@ static bool isEmptyInt(VMFunction *func)
 	return (code == nullptr || code->word == (0x00048000|OP_RET));
 }
 
+// Collects the events this handler's class overrides with a non-empty function, so that the
+// frequent dispatchers don't have to look up the virtual of every handler for every event.
+static const char *const SubscriptionNames[EVS_Count] =
+{
+	"WorldThingSpawned",
+	"WorldThingDied",
+	"WorldThingGround",
+	"WorldThingRevived",
+	"WorldThingDamaged",
+	"WorldThingDestroyed",
+	"WorldLinePreActivated",
+	"WorldLineActivated",
+	"WorldSectorDamaged",
+	"WorldLineDamaged",
+	"WorldLightning",
+	"WorldTick",
+	"RenderFrame",
+	"RenderOverlay",
+	"RenderUnderlay",
+	"UiTick",
+	"PostUiTick",
+	"CheckReplacement",
+	"CheckReplacee",
+};
+
+void DStaticEventHandler::SetupSubscriptions()
+{
+	static unsigned VIndex[EVS_Count];
+	static bool initialized = false;
+	if (!initialized)
+	{
+		for (int i = 0; i < EVS_Count; i++)
+		{
+			VIndex[i] = GetVirtualIndex(RUNTIME_CLASS(DStaticEventHandler), SubscriptionNames[i]);
+			assert(VIndex[i] != ~0u);
+		}
+		initialized = true;
+	}
+
+	auto clss = GetClass();
+	uint32_t mask = 1u << EVS_Valid;
+	for (int i = 0; i < EVS_Count; i++)
+	{
+		VMFunction *func = clss->Virtuals.Size() > VIndex[i] ? clss->Virtuals[VIndex[i]] : nullptr;
+		if (func != nullptr && !isEmpty(func))
+		{
+			mask |= 1u << i;
+		}
+	}
+	Subscriptions = mask;
+}
+
 // ===========================================
 //
 //  Event handlers
@@ -105,6 +105,33 @@ bool E_CheckRequireMouse();
 // serialization stuff
 void E_SerializeEvents(FSerializer& arc);
 
+// events that are sent often enough that handlers which don't override them get skipped.
+enum EEventSubscription
+{
+	EVS_WorldThingSpawned,
+	EVS_WorldThingDied,
+	EVS_WorldThingGround,
+	EVS_WorldThingRevived,
+	EVS_WorldThingDamaged,
+	EVS_WorldThingDestroyed,
+	EVS_WorldLinePreActivated,
+	EVS_WorldLineActivated,
+	EVS_WorldSectorDamaged,
+	EVS_WorldLineDamaged,
+	EVS_WorldLightning,
+	EVS_WorldTick,
+	EVS_RenderFrame,
+	EVS_RenderOverlay,
+	EVS_RenderUnderlay,
+	EVS_UiTick,
+	EVS_PostUiTick,
+	EVS_CheckReplacement,
+	EVS_CheckReplacee,
+
+	EVS_Count,
+	EVS_Valid = 31
+};
+
 // ==============================================
 //
 //  EventHandler - base class
@@ -122,6 +149,7 @@ public:
 		next = 0;
 		Order = 0;
 		IsUiProcessor = false;
+		Subscriptions = 0;
 	}
 
 	DStaticEventHandler* prev;
@@ -133,6 +161,16 @@ public:
 	bool IsUiProcessor;
 	bool RequireMouse;
 
+	// which EEventSubscription events the handler's class actually implements.
+	// this is set up on first use, the class of a handler never changes.
+	uint32_t Subscriptions;
+	void SetupSubscriptions();
+	bool Subscribes(EEventSubscription ev)
+	{
+		if (Subscriptions == 0) SetupSubscriptions();
+		return !!(Subscriptions & (1u << ev));
+	}
+
 	// serialization handler. let's keep it here so that I don't get lost in serialized/not serialized fields
 	void Serialize(FSerializer& arc) override
 	{
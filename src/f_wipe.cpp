@@ -23,6 +23,9 @@
 //
 //-----------------------------------------------------------------------------
 
+#ifndef NO_SSE
+#include <emmintrin.h>
+#endif
 #include "i_video.h"
 #include "v_video.h"
 #include "m_random.h"
@@ -53,6 +56,9 @@ static int burntime;
 
 // [RH] Crossfade
 static int fade;
+static uint8_t *fadetable;		// the blend of every pair of colors at the current fade level
+static int fadetablelevel;
+static bool fadetablemethod;
 
 
 // Melt -------------------------------------------------------------
@@ -211,9 +217,32 @@ int wipe_CalcBurn (uint8_t *burnarray, int width, int height, int density)
 		*pixel = c1;
 		*(pixel + width) = (c1 + bottom) >> 1;
 		pixel++;
+		a = 1;
+
+#ifndef NO_SSE
+		// The rows being written are never read in the same pass,
+		// so eight pixels can be done at once.
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i one = _mm_set1_epi16(1);
+		for (; a + 8 <= width - 1; a += 8, pixel += 8)
+		{
+			p = pixel + (width << 1);
+			__m128i vtop = _mm_add_epi16(
+				_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)p), zero),
+				_mm_add_epi16(
+					_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(p - 1)), zero),
+					_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(p + 1)), zero)));
+			__m128i vbottom = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(pixel + (width << 2))), zero);
+			__m128i vc1 = _mm_srli_epi16(_mm_add_epi16(vtop, vbottom), 2);
+			vc1 = _mm_add_epi16(vc1, _mm_cmpgt_epi16(vc1, one));	// if (c1 > 1) c1--;
+			__m128i vmid = _mm_srli_epi16(_mm_add_epi16(vc1, vbottom), 1);
+			_mm_storel_epi64((__m128i *)pixel, _mm_packus_epi16(vc1, zero));
+			_mm_storel_epi64((__m128i *)(pixel + width), _mm_packus_epi16(vmid, zero));
+		}
+#endif
 
 		// main line loop
-		for (a = 1; a < width-1; a++)
+		for (; a < width-1; a++)
 		{
 			// sum top pixels
 			p = pixel + (width << 1);
@@ -248,7 +277,19 @@ int wipe_CalcBurn (uint8_t *burnarray, int width, int height, int density)
 	}
 
 	// Check for done-ness. (Every pixel with level 126 or higher counts as done.)
-	for (a = width * height, from = burnarray; a != 0; --a, ++from)
+	a = width * height;
+	from = burnarray;
+#ifndef NO_SSE
+	for (; a >= 16; a -= 16, from += 16)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i *)from);
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(v, _mm_set1_epi8(126)), v)) != 0xffff)
+		{
+			return density;
+		}
+	}
+#endif
+	for (; a != 0; --a, ++from)
 	{
 		if (*from < 126)
 		{
@@ -285,79 +326,66 @@ bool wipe_doBurn (int ticks)
 	fromold = (uint8_t *)wipe_scr_start;
 	fromnew = (uint8_t *)wipe_scr_end;
 
-	if (!r_blendmethod)
+	const PalEntry* pal = GPalette.BaseColors;
+
+	for (y = 0, firey = 0; y < SCREENHEIGHT; y++, firey += ystep)
 	{
-		for (y = 0, firey = 0; y < SCREENHEIGHT; y++, firey += ystep)
+		const uint8_t *burnrow = &burnarray[(firey>>SHIFT)*FIREWIDTH];
+
+		// All pixels covered by one fire cell get the same level, so the parts
+		// that are fully burnt or not yet burning can be copied as a whole.
+		for (x = 0, firex = 0; x < SCREENWIDTH; )
 		{
-			for (x = 0, firex = 0; x < SCREENWIDTH; x++, firex += xstep)
+			int cell = firex >> SHIFT;
+			int fglevel = burnrow[cell] / 2;
+			int start = x;
+			do
 			{
-				int fglevel;
+				x++;
+				firex += xstep;
+			}
+			while (x < SCREENWIDTH && (firex >> SHIFT) == cell);
 
-				fglevel = burnarray[(firex>>SHIFT)+(firey>>SHIFT)*FIREWIDTH] / 2;
-				if (fglevel >= 63)
-				{
-					to[x] = fromnew[x];
-				}
-				else if (fglevel == 0)
-				{
-					to[x] = fromold[x];
-					done = false;
-				}
-				else
+			if (fglevel >= 63)
+			{
+				memcpy(&to[start], &fromnew[start], x - start);
+				continue;
+			}
+			done = false;
+			if (fglevel == 0)
+			{
+				memcpy(&to[start], &fromold[start], x - start);
+			}
+			else if (!r_blendmethod)
+			{
+				int bglevel = 64-fglevel;
+				uint32_t *fg2rgb = Col2RGB8[fglevel];
+				uint32_t *bg2rgb = Col2RGB8[bglevel];
+				for (int i = start; i < x; i++)
 				{
-					int bglevel = 64-fglevel;
-					uint32_t *fg2rgb = Col2RGB8[fglevel];
-					uint32_t *bg2rgb = Col2RGB8[bglevel];
-					uint32_t fg = fg2rgb[fromnew[x]];
-					uint32_t bg = bg2rgb[fromold[x]];
+					uint32_t fg = fg2rgb[fromnew[i]];
+					uint32_t bg = bg2rgb[fromold[i]];
 					fg = (fg+bg) | 0x1f07c1f;
-					to[x] = RGB32k.All[fg & (fg>>15)];
-					done = false;
+					to[i] = RGB32k.All[fg & (fg>>15)];
 				}
 			}
-			fromold += SCREENWIDTH;
-			fromnew += SCREENWIDTH;
-			to += SCREENPITCH;
-		}
-
-	}
-	else
-	{
-		for (y = 0, firey = 0; y < SCREENHEIGHT; y++, firey += ystep)
-		{
-			for (x = 0, firex = 0; x < SCREENWIDTH; x++, firex += xstep)
+			else
 			{
-				int fglevel;
-
-				fglevel = burnarray[(firex>>SHIFT)+(firey>>SHIFT)*FIREWIDTH] / 2;
-				if (fglevel >= 63)
-				{
-					to[x] = fromnew[x];
-				}
-				else if (fglevel == 0)
+				int bglevel = 64-fglevel;
+				for (int i = start; i < x; i++)
 				{
-					to[x] = fromold[x];
-					done = false;
-				}
-				else
-				{
-					int bglevel = 64-fglevel;
-
-					const PalEntry* pal = GPalette.BaseColors;
-
-					uint32_t fg = fromnew[x];
-					uint32_t bg = fromold[x];
+					uint32_t fg = fromnew[i];
+					uint32_t bg = fromold[i];
 					int r = MIN((pal[fg].r * fglevel + pal[bg].r * bglevel) >> 8, 63);
 					int g = MIN((pal[fg].g * fglevel + pal[bg].g * bglevel) >> 8, 63);
 					int b = MIN((pal[fg].b * fglevel + pal[bg].b * bglevel) >> 8, 63);
-					to[x] = RGB256k.RGB[r][g][b];
-					done = false;
+					to[i] = RGB256k.RGB[r][g][b];
 				}
 			}
-			fromold += SCREENWIDTH;
-			fromnew += SCREENWIDTH;
-			to += SCREENPITCH;
 		}
+		fromold += SCREENWIDTH;
+		fromnew += SCREENWIDTH;
+		to += SCREENPITCH;
 	}
 	return done || (burntime > 40);
 }
@@ -373,9 +401,49 @@ bool wipe_exitBurn (int ticks)
 bool wipe_initFade (int ticks)
 {
 	fade = 0;
+	fadetable = new uint8_t[256 * 256];
+	fadetablelevel = -1;
 	return 0;
 }
 
+//==========================================================================
+//
+// The fade level only changes once per tic, so instead of blending every
+// pixel, the result for each pair of colors is worked out once and the
+// screen is done with a single lookup per pixel.
+//
+//==========================================================================
+
+static void wipe_MakeFadeTable ()
+{
+	int bglevel = 64 - fade;
+	uint32_t *fg2rgb = Col2RGB8[fade];
+	uint32_t *bg2rgb = Col2RGB8[bglevel];
+	const PalEntry *pal = GPalette.BaseColors;
+	uint8_t *dest = fadetable;
+
+	for (int fg = 0; fg < 256; fg++)
+	{
+		for (int bg = 0; bg < 256; bg++)
+		{
+			if (!r_blendmethod)
+			{
+				uint32_t c = (fg2rgb[fg] + bg2rgb[bg]) | 0x1f07c1f;
+				*dest++ = RGB32k.All[c & (c>>15)];
+			}
+			else
+			{
+				int r = MIN((pal[fg].r * (64-bglevel) + pal[bg].r * bglevel) >> 8, 63);
+				int g = MIN((pal[fg].g * (64-bglevel) + pal[bg].g * bglevel) >> 8, 63);
+				int b = MIN((pal[fg].b * (64-bglevel) + pal[bg].b * bglevel) >> 8, 63);
+				*dest++ = RGB256k.RGB[r][g][b];
+			}
+		}
+	}
+	fadetablelevel = fade;
+	fadetablemethod = r_blendmethod;
+}
+
 bool wipe_doFade (int ticks)
 {
 	fade += ticks * 2;
@@ -387,47 +455,23 @@ bool wipe_doFade (int ticks)
 	else
 	{
 		int x, y;
-		int bglevel = 64 - fade;
-		uint32_t *fg2rgb = Col2RGB8[fade];
-		uint32_t *bg2rgb = Col2RGB8[bglevel];
 		uint8_t *fromnew = (uint8_t *)wipe_scr_end;
 		uint8_t *fromold = (uint8_t *)wipe_scr_start;
 		uint8_t *to = screen->GetBuffer();
-		const PalEntry *pal = GPalette.BaseColors;
 
-		if (!r_blendmethod)
+		if (fade != fadetablelevel || r_blendmethod != fadetablemethod)
 		{
-			for (y = 0; y < SCREENHEIGHT; y++)
-			{
-				for (x = 0; x < SCREENWIDTH; x++)
-				{
-					uint32_t fg = fg2rgb[fromnew[x]];
-					uint32_t bg = bg2rgb[fromold[x]];
-					fg = (fg+bg) | 0x1f07c1f;
-					to[x] = RGB32k.All[fg & (fg>>15)];
-				}
-				fromnew += SCREENWIDTH;
-				fromold += SCREENWIDTH;
-				to += SCREENPITCH;
-			}
+			wipe_MakeFadeTable();
 		}
-		else
+		for (y = 0; y < SCREENHEIGHT; y++)
 		{
-			for (y = 0; y < SCREENHEIGHT; y++)
+			for (x = 0; x < SCREENWIDTH; x++)
 			{
-				for (x = 0; x < SCREENWIDTH; x++)
-				{
-					uint32_t fg = fromnew[x];
-					uint32_t bg = fromold[x];
-					int r = MIN((pal[fg].r * (64-bglevel) + pal[bg].r * bglevel) >> 8, 63);
-					int g = MIN((pal[fg].g * (64-bglevel) + pal[bg].g * bglevel) >> 8, 63);
-					int b = MIN((pal[fg].b * (64-bglevel) + pal[bg].b * bglevel) >> 8, 63);
-					to[x] = RGB256k.RGB[r][g][b];
-				}
-				fromnew += SCREENWIDTH;
-				fromold += SCREENWIDTH;
-				to += SCREENPITCH;
+				to[x] = fadetable[(fromnew[x] << 8) | fromold[x]];
 			}
+			fromnew += SCREENWIDTH;
+			fromold += SCREENWIDTH;
+			to += SCREENPITCH;
 		}
 	}
 	return false;
@@ -435,6 +479,8 @@ bool wipe_doFade (int ticks)
 
 bool wipe_exitFade (int ticks)
 {
+	delete[] fadetable;
+	fadetable = NULL;
 	return 0;
 }
 
@@ -33,6 +33,17 @@
 **
 */
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <limits.h>
+
 #include "files.h"
 #include "i_system.h"
 #include "templates.h"
@@ -348,6 +359,76 @@ public:
 	}
 };
 
+//==========================================================================
+//
+// MappedFileReader
+//
+// Maps an entire file into memory. Because the data is exposed through
+// GetBuffer, resource files opened with this reader cache uncompressed
+// lumps as pointers into the mapping instead of copying them to the heap.
+// The mapping is copy-on-write so that code modifying a cached lump
+// cannot affect the file.
+//
+//==========================================================================
+
+class MappedFileReader : public MemoryReader
+{
+	void *Mapping = nullptr;
+
+public:
+	~MappedFileReader()
+	{
+		if (Mapping != nullptr)
+		{
+#ifdef _WIN32
+			UnmapViewOfFile(Mapping);
+#else
+			munmap(Mapping, Length);
+#endif
+		}
+	}
+
+	bool Open(const char *filename)
+	{
+#ifdef _WIN32
+		HANDLE file = CreateFileW(WideString(filename).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0 || size.QuadPart > LONG_MAX)
+		{
+			CloseHandle(file);
+			return false;
+		}
+		HANDLE map = CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+		CloseHandle(file);
+		if (map == nullptr) return false;
+		Mapping = MapViewOfFile(map, FILE_MAP_COPY, 0, 0, 0);
+		CloseHandle(map);
+		if (Mapping == nullptr) return false;
+		Length = (long)size.QuadPart;
+#else
+		int fd = open(filename, O_RDONLY);
+		if (fd == -1) return false;
+
+		struct stat info;
+		if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size <= 0 || info.st_size > LONG_MAX)
+		{
+			close(fd);
+			return false;
+		}
+		void *map = mmap(nullptr, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (map == MAP_FAILED) return false;
+		Mapping = map;
+		Length = (long)info.st_size;
+#endif
+		bufptr = (const char *)Mapping;
+		FilePos = 0;
+		return true;
+	}
+};
+
 
 
 //==========================================================================
@@ -371,6 +452,19 @@ bool FileReader::OpenFile(const char *filename, FileReader::Size start, FileRead
 	return true;
 }
 
+bool FileReader::OpenMappedFile(const char *filename)
+{
+	auto reader = new MappedFileReader;
+	if (!reader->Open(filename))
+	{
+		delete reader;
+		return false;
+	}
+	Close();
+	mReader = reader;
+	return true;
+}
+
 bool FileReader::OpenFilePart(FileReader &parent, FileReader::Size start, FileReader::Size length)
 {
 	auto reader = new FileReaderRedirect(parent, (long)start, (long)length);
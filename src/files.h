@@ -171,11 +171,14 @@ public:
 	}
 
 	bool OpenFile(const char *filename, Size start = 0, Size length = -1);
+	bool OpenMappedFile(const char *filename);	// maps the entire file into memory. Fails if mapping is not possible.
 	bool OpenFilePart(FileReader &parent, Size start, Size length);
 	bool OpenMemory(const void *mem, Size length);	// read directly from the buffer
 	bool OpenMemoryArray(const void *mem, Size length);	// read from a copy of the buffer.
 	bool OpenMemoryArray(std::function<bool(TArray<uint8_t>&)> getter);	// read contents to a buffer and return a reader to it
 	bool OpenDecompressor(FileReader &parent, Size length, int method, bool seekable);	// creates a decompressor stream. 'seekable' uses a buffered version so that the Seek and Tell methods can be used.
+	bool OpenBufferedDecompressor(FileReader &&source, Size length, int method);	// seekable decompressor stream that takes ownership of the compressed data's reader.
+	bool OpenStreamingDecompressor(FileReader &&source, Size length, int method);	// seekable decompressor stream with bounded memory; backward seeks restart decompression.
 
 	Size Tell() const
 	{
@@ -324,6 +327,7 @@ public:
 
 	BufferWriter() {}
 	virtual size_t Write(const void *buffer, size_t len) override;
+	virtual long Tell() override { return (long)mBuffer.Size(); }
 	TArray<unsigned char> *GetBuffer() { return &mBuffer; }
 };
 
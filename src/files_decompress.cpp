@@ -42,6 +42,7 @@
 #include "i_system.h"
 #include "templates.h"
 #include "m_misc.h"
+#include "doomerrors.h"
 
 
 long DecompressorBase::Tell () const
@@ -562,7 +563,85 @@ public:
 };
 
 
-bool FileReader::OpenDecompressor(FileReader &parent, Size length, int method, bool seekable)
+//==========================================================================
+//
+// DecompressorBuffered
+//
+// Makes a decompressor stream seekable by keeping everything decompressed
+// so far. Data is only decompressed as far as it gets read, so looking at
+// the header of a large compressed lump does not inflate all of it.
+//
+//==========================================================================
+
+class DecompressorBuffered : public MemoryReader
+{
+	FileReader Source;				// only set if the compressed data is owned by this reader.
+	FileReaderInterface *Stream = nullptr;
+	TArray<char> Buffer;
+	long Decoded = 0;
+
+public:
+	DecompressorBuffered(long length)
+	{
+		Length = length;
+		Buffer.Resize(length);
+		bufptr = Buffer.Data();
+	}
+
+	~DecompressorBuffered()
+	{
+		delete Stream;
+	}
+
+	FileReader &GetSource() { return Source; }
+	void SetStream(FileReaderInterface *stream) { Stream = stream; }
+
+	void Fill(long upto)
+	{
+		if (upto > Length) upto = Length;
+		if (upto <= Decoded) return;
+
+		// Decode in reasonably sized steps so that small reads do not each go through the decompressor.
+		long len = MAX<long>(upto - Decoded, MIN<long>(4096, Length - Decoded));
+		try
+		{
+			Decoded += Stream->Read(&Buffer[Decoded], len);
+		}
+		catch (CRecoverableError &err)
+		{
+			// Keep going with what could be read, like the lump cache does.
+			Printf("%s\n", err.GetMessage());
+			memset(&Buffer[Decoded], 0, Length - Decoded);
+			Decoded = Length;
+		}
+		if (Decoded < upto)
+		{
+			memset(&Buffer[Decoded], 0, Length - Decoded);
+			Decoded = Length;
+		}
+	}
+
+	long Read(void *buffer, long len) override
+	{
+		Fill(FilePos + MAX<long>(len, 0));
+		return MemoryReader::Read(buffer, len);
+	}
+
+	char *Gets(char *strbuf, int len) override
+	{
+		Fill(FilePos + MAX(len, 0));
+		return MemoryReader::Gets(strbuf, len);
+	}
+
+	const char *GetBuffer() const override
+	{
+		// Anyone asking for the buffer expects all of the data.
+		const_cast<DecompressorBuffered *>(this)->Fill(Length);
+		return bufptr;
+	}
+};
+
+static DecompressorBase *CreateDecompressor(FileReader &parent, FileReader::Size length, int method)
 {
 	DecompressorBase *dec = nullptr;
 	switch (method)
@@ -586,19 +665,195 @@ bool FileReader::OpenDecompressor(FileReader &parent, Size length, int method, b
 			
 		// todo: METHOD_IMPLODE, METHOD_SHRINK
 		default:
-			return false;
+			return nullptr;
 	}
 	dec->Length = (long)length;
+	return dec;
+}
+
+bool FileReader::OpenDecompressor(FileReader &parent, Size length, int method, bool seekable)
+{
 	if (!seekable)
 	{
+		auto dec = CreateDecompressor(parent, length, method);
+		if (dec == nullptr) return false;
 		Close();
 		mReader = dec;
 		return true;
 	}
 	else
 	{
-		// todo: create a wrapper. for now this fails
-		delete dec;
+		auto buffered = new DecompressorBuffered((long)length);
+		auto dec = CreateDecompressor(parent, length, method);
+		if (dec == nullptr)
+		{
+			delete buffered;
+			return false;
+		}
+		buffered->SetStream(dec);
+		Close();
+		mReader = buffered;
+		return true;
+	}
+}
+
+bool FileReader::OpenBufferedDecompressor(FileReader &&source, Size length, int method)
+{
+	auto buffered = new DecompressorBuffered((long)length);
+	buffered->GetSource() = std::move(source);
+	auto dec = CreateDecompressor(buffered->GetSource(), length, method);
+	if (dec == nullptr)
+	{
+		delete buffered;
+		return false;
+	}
+	buffered->SetStream(dec);
+	Close();
+	mReader = buffered;
+	return true;
+}
+
+//==========================================================================
+//
+// DecompressorStream
+//
+// A seekable decompressor stream that only keeps one block of
+// decompressed data around. Forward seeks decompress and discard,
+// backward seeks outside the current block start over from the
+// beginning. This is meant for long, mostly sequentially read lumps like
+// streamed music, where keeping all of the data would cost more memory
+// than restarting the decompressor once per loop.
+//
+//==========================================================================
+
+class DecompressorStream : public FileReaderInterface
+{
+	enum { BLOCK_SIZE = 32768 };
+
+	FileReader Source;
+	DecompressorBase *Stream = nullptr;
+	int Method;
+	long FilePos = 0;
+	long StreamPos = 0;		// how much has been decompressed since the last restart
+	long BlockStart = 0;
+	long BlockLen = 0;
+	bool Broken = false;
+	uint8_t Block[BLOCK_SIZE];
+
+public:
+	DecompressorStream(FileReader &&source, long length, int method)
+		: Source(std::move(source)), Method(method)
+	{
+		Length = length;
+	}
+
+	~DecompressorStream()
+	{
+		delete Stream;
+	}
+
+	bool Restart()
+	{
+		delete Stream;
+		Stream = nullptr;
+		StreamPos = BlockStart = BlockLen = 0;
+		Source.Seek(0, FileReader::SeekSet);
+		Stream = CreateDecompressor(Source, Length, Method);
+		return Stream != nullptr;
+	}
+
+	// Makes the block contain pos. Returns false if there is no data there.
+	bool Fill(long pos)
+	{
+		if (pos >= BlockStart && pos < BlockStart + BlockLen) return true;
+		if (pos >= Length) return false;
+		if (pos < BlockStart)
+		{
+			Broken = !Restart();
+		}
+		if (Broken) return false;
+		while (StreamPos <= pos)
+		{
+			long len = MIN<long>(BLOCK_SIZE, Length - StreamPos);
+			try
+			{
+				BlockLen = Stream->Read(Block, len);
+			}
+			catch (CRecoverableError &err)
+			{
+				// Past this point, the data just ends.
+				Printf("%s\n", err.GetMessage());
+				BlockLen = 0;
+			}
+			BlockStart = StreamPos;
+			StreamPos += BlockLen;
+			if (BlockLen < len)
+			{
+				if (StreamPos <= pos) Broken = true;
+				return !Broken;
+			}
+		}
+		return true;
+	}
+
+	long Tell() const override
+	{
+		return FilePos;
+	}
+
+	long Seek(long offset, int origin) override
+	{
+		switch (origin)
+		{
+		case SEEK_CUR:
+			offset += FilePos;
+			break;
+
+		case SEEK_END:
+			offset += Length;
+			break;
+		}
+		if (offset < 0 || offset > Length) return -1;
+		FilePos = offset;
+		return 0;
+	}
+
+	long Read(void *buffer, long len) override
+	{
+		uint8_t *out = (uint8_t *)buffer;
+		long done = 0;
+		while (len > done && Fill(FilePos))
+		{
+			long avail = MIN<long>(len - done, BlockStart + BlockLen - FilePos);
+			memcpy(out + done, Block + (FilePos - BlockStart), avail);
+			done += avail;
+			FilePos += avail;
+		}
+		return done;
+	}
+
+	char *Gets(char *strbuf, int len) override
+	{
+		if (len <= 0 || FilePos >= Length) return nullptr;
+		char *p = strbuf;
+		while (--len > 0 && Read(p, 1) == 1)
+		{
+			if (*p++ == '\n') break;
+		}
+		*p = 0;
+		return p == strbuf ? nullptr : strbuf;
+	}
+};
+
+bool FileReader::OpenStreamingDecompressor(FileReader &&source, Size length, int method)
+{
+	auto stream = new DecompressorStream(std::move(source), (long)length, method);
+	if (!stream->Restart())
+	{
+		delete stream;
 		return false;
 	}
+	Close();
+	mReader = stream;
+	return true;
 }
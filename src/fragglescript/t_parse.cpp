@@ -178,7 +178,7 @@ static void add_char(char *tokn, char c)
 //
 //==========================================================================
 
-char *FParser::GetTokens(char *s)
+char *FParser::TokenizeStatement(char *s)
 {
 	char *tokn = NULL;
 
@@ -286,6 +286,85 @@ char *FParser::GetTokens(char *s)
 	return Rover;
 }
 
+//==========================================================================
+//
+// stores the result of the last TokenizeStatement call for the statement
+// starting at s.
+//
+//==========================================================================
+
+void FParser::CacheStatement(char *s)
+{
+	FFsStatement st;
+
+	st.Next = Script->MakeIndex(Rover);
+	st.LineStart = Script->MakeIndex(LineStart);
+	st.Text = Script->StatementText.Size();
+	st.TextLen = NumTokens > 0 ? int(Tokens[NumTokens-1] + strlen(Tokens[NumTokens-1]) + 1 - Tokens[0]) : 0;
+	st.FirstToken = Script->StatementTokens.Size();
+	st.NumTokens = NumTokens;
+	st.Section = Section;
+	st.BraceType = BraceType;
+
+	if (st.TextLen > 0)
+	{
+		Script->StatementText.Reserve(st.TextLen);
+		memcpy(&Script->StatementText[st.Text], Tokens[0], st.TextLen);
+	}
+	for (int i = 0; i < NumTokens; i++)
+	{
+		Script->StatementTokens.Push(int(Tokens[i] - Tokens[0]));
+		Script->StatementTypes.Push(TokenType[i]);
+	}
+	Script->StatementMap[Script->MakeIndex(s)] = Script->Statements.Push(st);
+}
+
+//==========================================================================
+//
+// GetTokens
+//
+// Each statement of a script only needs to be tokenized once. The result
+// gets stored in the script so that loops and scripts that are started
+// repeatedly can just copy the tokens back.
+//
+//==========================================================================
+
+char *FParser::GetTokens(char *s)
+{
+	// included lumps are not part of the script's data and are only run once.
+	if (s < Script->data || s >= Script->data + Script->len)
+	{
+		return TokenizeStatement(s);
+	}
+
+	unsigned *index = Script->StatementMap.CheckKey(Script->MakeIndex(s));
+	if (index == nullptr)
+	{
+		TokenizeStatement(s);
+		CacheStatement(s);
+		return Rover;
+	}
+
+	const FFsStatement &st = Script->Statements[*index];
+
+	Tokens[0][0] = 0;
+	if (st.TextLen > 0)
+	{
+		memcpy(Tokens[0], &Script->StatementText[st.Text], st.TextLen);
+	}
+	for (int i = 0; i < st.NumTokens; i++)
+	{
+		Tokens[i] = Tokens[0] + Script->StatementTokens[st.FirstToken + i];
+		TokenType[i] = Script->StatementTypes[st.FirstToken + i];
+	}
+	NumTokens = st.NumTokens;
+	LineStart = Script->data + st.LineStart;
+	Section = st.Section;
+	if (Section != nullptr) BraceType = st.BraceType;
+	Rover = Script->data + st.Next;
+	return Rover;
+}
+
 
 //==========================================================================
 //
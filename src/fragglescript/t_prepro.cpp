@@ -132,6 +132,23 @@ void DFsScript::ClearSections()
 		}
 		sections[i] = nullptr;
 	}
+	// the cached statements point to the sections.
+	ClearStatements();
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void DFsScript::ClearStatements()
+{
+	StatementMap.Clear();
+	Statements.Clear();
+	StatementText.Clear();
+	StatementTokens.Clear();
+	StatementTypes.Clear();
 }
 
 //==========================================================================
@@ -390,6 +407,7 @@ void DFsScript::DryRunScript()
 void DFsScript::Preprocess()
 {
 	len = (int)strlen(data);
+	ClearStatements();
 	ProcessFindChar(data, 0);  // fill in everything
 	DryRunScript();
 }
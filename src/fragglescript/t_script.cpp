@@ -195,6 +195,7 @@ void DFsScript::Serialize(FSerializer &arc)
 	Super::Serialize(arc);
 	// don't save a reference to the global script
 	if (parent == global_script) parent = nullptr;
+	if (arc.isReading()) ClearStatements();
 
 	arc("data", data)
 		("scriptnum", scriptnum)
@@ -262,6 +262,20 @@ enum    // brace types: where current_section is a { or }
 	bracket_close
 };
 
+// A statement as returned by FParser::GetTokens, kept so that loop bodies
+// and repeatedly triggered scripts don't need to be tokenized again.
+struct FFsStatement
+{
+	int Next;			// offset of the rover after the statement
+	int LineStart;
+	int Text;			// token text in DFsScript::StatementText
+	int TextLen;
+	int FirstToken;		// token offsets/types in DFsScript::StatementTokens/Types
+	int NumTokens;
+	DFsSection *Section;	// owned by the script's section table
+	int BraceType;
+};
+
 //==========================================================================
 //
 // Errors
@@ -332,6 +346,14 @@ public:
 	bool lastiftrue;     // haleyjd: whether last "if" statement was 
 	// true or false
 
+	// tokenized statements, indexed by their offset in data.
+	// This is never saved and gets rebuilt on demand.
+	TMap<int, unsigned> StatementMap;
+	TArray<FFsStatement> Statements;
+	TArray<char> StatementText;
+	TArray<int> StatementTokens;
+	TArray<tokentype_t> StatementTypes;
+
 	DFsScript();
 	~DFsScript();
 	void OnDestroy() override;
@@ -351,6 +373,7 @@ public:
 	char *SectionLoop(const DFsSection *sec);
 	void ClearSections();
 	void ClearChildren();
+	void ClearStatements();
 
 	int MakeIndex(const char *p) { return int(p-data); }
 
@@ -426,6 +449,8 @@ struct FParser
 
 	void NextToken();
 	char *GetTokens(char *s);
+	char *TokenizeStatement(char *s);
+	void CacheStatement(char *s);
 	void PrintTokens();
 	void ErrorMessage(FString msg);
 
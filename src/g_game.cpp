@@ -97,6 +97,7 @@
 #include "g_levellocals.h"
 #include "events.h"
 #include "d_main.h"
+#include "jobs.h"
 
 
 static FRandom pr_dmspawn ("DMSpawn");
@@ -112,6 +113,7 @@ void	G_PlayerReborn (int player);
 
 void	G_DoNewGame (void);
 void	G_DoLoadGame (void);
+static bool G_ReadSaveGame (std::unique_ptr<FResourceFile> &resfile, bool hidecon);
 void	G_DoPlayDemo (void);
 void	G_DoCompleted (void);
 void	G_DoVictory (void);
@@ -119,18 +121,24 @@ void	G_DoWorldDone (void);
 void	G_DoSaveGame (bool okForQuicksave, bool forceQuicksave, FString filename, const char *description);
 void	G_DoAutoSave ();
 void	G_DoQuickSave ();
+static void G_TakeDemoKeyframe ();
+static void G_DoDemoSeek ();
+static void G_ClearDemoKeyframes ();
 
 void STAT_Serialize(FSerializer &file);
 bool WriteZip(const char *filename, TArray<FString> &filenames, TArray<FCompressedBuffer> &content);
+bool WriteZip(FileWriter *f, TArray<FString> &filenames, TArray<FCompressedBuffer> &content);
 
 FIntCVar gameskill ("skill", 2, CVAR_SERVERINFO|CVAR_LATCH);
 CVAR(Bool, save_formatted, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)	// use formatted JSON for saves (more readable but a larger files and a bit slower.
+CVAR(Bool, save_binary, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)	// use the binary serializer format for game data unless save_formatted is on.
 CVAR (Int, deathmatch, 0, CVAR_SERVERINFO|CVAR_LATCH);
 CVAR (Bool, chasedemo, false, 0);
 CVAR (Bool, storesavepic, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 CVAR (Bool, longsavemessages, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 CVAR (String, save_dir, "", CVAR_ARCHIVE|CVAR_GLOBALCONFIG);
 CVAR (Bool, cl_waitforsave, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
+CVAR (Bool, save_background, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);	// compress and write savegames on a worker thread
 CVAR (Bool, enablescriptscreenshot, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
 EXTERN_CVAR (Float, con_midtime);
 
@@ -190,6 +198,8 @@ FString			demoname;
 bool 			demorecording;
 bool 			demoplayback;
 bool			demonew;				// [RH] Only used around G_InitNew for demos
+static int		DemoTic;				// tics played back since the demo started
+static int		DemoSeekTarget = -1;	// DemoTic demo_seek is fast-forwarding to
 int				demover;
 uint8_t*			demobuffer;
 uint8_t*			demo_p;
@@ -1077,6 +1087,8 @@ void G_Ticker ()
 	int i;
 	gamestate_t	oldgamestate;
 
+	G_CheckSaveThread();
+
 	// do player reborns if needed
 	for (i = 0; i < MAXPLAYERS; i++)
 	{
@@ -1169,6 +1181,10 @@ void G_Ticker ()
 			P_ResumeConversation ();
 			gameaction = ga_nothing;
 			break;
+		case ga_demoseek:
+			gameaction = ga_nothing;
+			G_DoDemoSeek ();
+			break;
 		default:
 		case ga_nothing:
 			break;
@@ -1184,6 +1200,11 @@ void G_Ticker ()
 		}
 	}
 
+	if (demoplayback && gamestate == GS_LEVEL && gameaction == ga_nothing)
+	{
+		G_TakeDemoKeyframe ();
+	}
+
 	// get commands, check consistancy, and build new consistancy check
 	int buf = (gametic/ticdup)%BACKUPTICS;
 
@@ -1292,6 +1313,15 @@ void G_Ticker ()
 
 	// [MK] Additional ticker for UI events right after all others
 	E_PostUiTick();
+
+	if (demoplayback)
+	{
+		DemoTic++;
+		if (DemoSeekTarget >= 0 && DemoTic >= DemoSeekTarget)
+		{
+			DemoSeekTarget = -1;
+		}
+	}
 }
 
 
@@ -1900,17 +1930,45 @@ void G_DoLoadGame ()
 	hidecon = gameaction == ga_loadgamehidecon;
 	gameaction = ga_nothing;
 
+	// The savegame being loaded may still be in the process of being written.
+	G_WaitForSaveThread();
+
 	std::unique_ptr<FResourceFile> resfile(FResourceFile::OpenResourceFile(savename.GetChars(), true, true));
 	if (resfile == nullptr)
 	{
 		LoadGameError("TXT_COULDNOTREAD");
 		return;
 	}
+	if (!G_ReadSaveGame(resfile, hidecon))
+	{
+		return;
+	}
+
+	BackupSaveName = savename;
+
+	if (longsavemessages) Printf("%s (%s)\n", GStrings("GGLOADED"), savename.GetChars());
+	else Printf("%s\n", GStrings("GGLOADED"));
+
+	// At this point, the GC threshold is likely a lot higher than the
+	// amount of memory in use, so bring it down now by starting a
+	// collection.
+	GC::StartCollection();
+}
+
+//==========================================================================
+//
+// Restores the game from an opened savegame. Also used for demo keyframes,
+// which are savegames kept in memory.
+//
+//==========================================================================
+
+static bool G_ReadSaveGame (std::unique_ptr<FResourceFile> &resfile, bool hidecon)
+{
 	FResourceLump *info = resfile->FindLump("info.json");
 	if (info == nullptr)
 	{
 		LoadGameError("TXT_NOINFOJSON");
-		return;
+		return false;
 	}
 
 	SaveVersion = 0;
@@ -1920,7 +1978,7 @@ void G_DoLoadGame ()
 	if (!arc.OpenReader((const char *)data, info->LumpSize))
 	{
 		LoadGameError("TXT_FAILEDTOREADSG");
-		return;
+		return false;
 	}
 
 	// Check whether this savegame actually has been created by a compatible engine.
@@ -1943,7 +2001,7 @@ void G_DoLoadGame ()
 		{
 			LoadGameError("TXT_IOTHERENGINESG", engine.GetChars());
 		}
-		return;
+		return false;
 	}
 
 	if (SaveVersion < MINSAVEVER || SaveVersion > SAVEVER)
@@ -1961,18 +2019,18 @@ void G_DoLoadGame ()
 		}
 		message.Substitute("%d", FStringf("%d", SaveVersion));
 		LoadGameError(message);
-		return;
+		return false;
 	}
 
 	if (!G_CheckSaveGameWads(arc, true))
 	{
-		return;
+		return false;
 	}
 
 	if (map.IsEmpty())
 	{
 		LoadGameError("TXT_NOMAPSG");
-		return;
+		return false;
 	}
 
 	// Now that it looks like we can load this save, hide the fullscreen console if it was up
@@ -1988,14 +2046,14 @@ void G_DoLoadGame ()
 	if (info == nullptr)
 	{
 		LoadGameError("TXT_NOGLOBALSJSON");
-		return;
+		return false;
 	}
 
 	data = info->CacheLump();
 	if (!arc.OpenReader((const char *)data, info->LumpSize))
 	{
 		LoadGameError("TXT_SGINFOERR");
-		return;
+		return false;
 	}
 
 
@@ -2024,6 +2082,7 @@ void G_DoLoadGame ()
 	level.time = Scale(time[1], TICRATE, time[0]);
 
 	G_ReadSnapshots(resfile.get());
+	G_PreparseSnapshot(FindLevelInfo(map));	// parse the current level's snapshot while the map loads
 	resfile.reset(nullptr);	// we no longer need the resource file below this point
 	G_ReadVisited(arc);
 
@@ -2044,16 +2103,7 @@ void G_DoLoadGame ()
 
 	if (level.info != nullptr)
 		level.info->Snapshot.Clean();
-
-	BackupSaveName = savename;
-
-	if (longsavemessages) Printf("%s (%s)\n", GStrings("GGLOADED"), savename.GetChars());
-	else Printf("%s\n", GStrings("GGLOADED"));
-
-	// At this point, the GC threshold is likely a lot higher than the
-	// amount of memory in use, so bring it down now by starting a
-	// collection.
-	GC::StartCollection();
+	return true;
 }
 
 
@@ -2249,68 +2299,200 @@ static void PutSavePic (FileWriter *file, int width, int height)
 	}
 }
 
-void G_DoSaveGame (bool okForQuicksave, bool forceQuicksave, FString filename, const char *description)
+//==========================================================================
+//
+// Savegame writer
+//
+// Only the serialization itself needs the game state. Everything the
+// savegame consists of is copied into a job which then gets compressed and
+// written to disk on a worker thread. The worker must not touch anything
+// but the job's own data, so all reporting is done by G_CheckSaveThread
+// once it has finished.
+//
+//==========================================================================
+
+struct FSaveGameJob
 {
-	TArray<FCompressedBuffer> savegame_content;
-	TArray<FString> savegame_filenames;
+	FString Filename;
+	FString Description;
+	bool OkForQuicksave;
+	bool ForceQuicksave;
 
-	char buf[100];
+	TArray<FString> Filenames;
+	TArray<FCompressedBuffer> Content;	// entries with a null buffer get deflated from Raw
+	TArray<TArray<char>> Raw;
+	bool Succeeded = false;
 
-	// Do not even try, if we're not in a level. (Can happen after
-	// a demo finishes playback.)
-	if (level.lines.Size() == 0 || level.sectors.Size() == 0 || gamestate != GS_LEVEL)
+	~FSaveGameJob()
 	{
-		return;
+		for (auto &buff : Content) buff.Clean();
 	}
 
-	if (demoplayback)
+	void Add(const char *name, TArray<char> &&raw)
 	{
-		filename = G_BuildSaveName ("demosave." SAVEGAME_EXT, -1);
+		Filenames.Push(name);
+		Content.Push({ 0, 0, METHOD_STORED, 0, 0, nullptr });
+		Raw[Raw.Reserve(1)] = std::move(raw);
 	}
 
-	if (cl_waitforsave)
-		I_FreezeTime(true);
+	void Add(const char *name, const FCompressedBuffer &buff)
+	{
+		// The buffer may still be owned by the game so the job gets its own copy.
+		FCompressedBuffer copy = buff;
+		copy.mBuffer = new char[buff.mCompressedSize];
+		memcpy(copy.mBuffer, buff.mBuffer, buff.mCompressedSize);
+		Filenames.Push(name);
+		Content.Push(copy);
+		Raw.Reserve(1);
+	}
 
-	insave = true;
-	try
+	void Compress()
 	{
-		G_SnapshotLevel();
+		for (unsigned i = 0; i < Content.Size(); i++)
+		{
+			if (Content[i].mBuffer == nullptr)
+			{
+				Content[i] = CompressZipBuffer(Raw[i].Size() > 0 ? &Raw[i][0] : "", Raw[i].Size());
+				Raw[i].Reset();
+			}
+		}
 	}
-	catch(CRecoverableError &err)
+
+	void Run()
 	{
-		// delete the snapshot. Since the save failed it is broken.
-		insave = false;
-		level.info->Snapshot.Clean();
-		Printf(PRINT_HIGH, "Save failed\n");
-		Printf(PRINT_HIGH, "%s\n", err.GetMessage());
-		// The time freeze must be reset if the save fails.
-		if (cl_waitforsave)
-			I_FreezeTime(false);
-		return;
+		Compress();
+
+		if (WriteZip(Filename, Filenames, Content))
+		{
+			// Check whether the file is ok by trying to open it.
+			FResourceFile *test = FResourceFile::OpenResourceFile(Filename, true);
+			if (test != nullptr)
+			{
+				delete test;
+				Succeeded = true;
+			}
+		}
 	}
-	catch (...)
+};
+
+static FSaveGameJob *SaveJob;
+static FJobCounter SaveTask;
+
+static void G_FinishSaveJob()
+{
+	if (SaveJob->Succeeded)
 	{
-		insave = false;
-		if (cl_waitforsave)
-			I_FreezeTime(false);
-		throw;
+		savegameManager.NotifyNewSave(SaveJob->Filename, SaveJob->Description, SaveJob->OkForQuicksave, SaveJob->ForceQuicksave);
+		BackupSaveName = SaveJob->Filename;
+
+		if (longsavemessages) Printf("%s (%s)\n", GStrings("GGSAVED"), SaveJob->Filename.GetChars());
+		else Printf("%s\n", GStrings("GGSAVED"));
 	}
+	else
+	{
+		Printf(PRINT_HIGH, "%s\n", GStrings("TXT_SAVEFAILED"));
+	}
+	delete SaveJob;
+	SaveJob = nullptr;
+}
+
+//==========================================================================
+//
+// Reports a savegame once the worker is done with it. Called every tic.
+//
+//==========================================================================
+
+void G_CheckSaveThread()
+{
+	if (SaveJob != nullptr && SaveTask.IsDone())
+	{
+		G_FinishSaveJob();
+	}
+}
+
+//==========================================================================
+//
+// Blocks until a pending savegame has been written. This must be done
+// before loading a game, starting another save and shutting down.
+//
+//==========================================================================
+
+void G_WaitForSaveThread()
+{
+	if (SaveJob != nullptr)
+	{
+		Jobs.Wait(SaveTask);
+		G_FinishSaveJob();
+	}
+}
+
+static void G_StartSaveJob(FSaveGameJob *job)
+{
+	SaveJob = job;
+	if (save_background)
+	{
+		Jobs.Submit(SaveTask, [job]()
+		{
+			try
+			{
+				job->Run();
+			}
+			catch (...)
+			{
+				job->Succeeded = false;
+			}
+		});
+	}
+	else
+	{
+		job->Run();
+		G_FinishSaveJob();
+	}
+}
+
+//==========================================================================
+//
+// Serializes everything that makes up a savegame into a job. The caller
+// must set insave.
+//
+//==========================================================================
+
+static FSaveGameJob *G_BuildSaveGame (const char *description, bool withpic)
+{
+	TArray<FCompressedBuffer> snapshot_content;
+	TArray<FString> snapshot_filenames;
+	TArray<char> levelsnapshot;
+	std::unique_ptr<FSaveGameJob> job(new FSaveGameJob);
+
+	char buf[100];
+
+	level.info->Snapshot.Clean();
+	G_SnapshotLevelUncompressed(levelsnapshot);
 
-	BufferWriter savepic;
 	FSerializer savegameinfo;		// this is for displayable info about the savegame
 	FSerializer savegameglobals;	// and this for non-level related info that must be saved.
 
 	savegameinfo.OpenWriter(true);
-	savegameglobals.OpenWriter(save_formatted);
+	if (save_binary && !save_formatted) savegameglobals.OpenBinaryWriter();
+	else savegameglobals.OpenWriter(save_formatted);
 
 	SaveVersion = SAVEVER;
-	PutSavePic(&savepic, SAVEPICWIDTH, SAVEPICHEIGHT);
 	mysnprintf(buf, countof(buf), GAMENAME " %s", GetVersionString());
-	// put some basic info into the PNG so that this isn't lost when the image gets extracted.
-	M_AppendPNGText(&savepic, "Software", buf);
-	M_AppendPNGText(&savepic, "Title", description);
-	M_AppendPNGText(&savepic, "Current Map", level.MapName);
-	M_FinishPNG(&savepic);
+	if (withpic)
+	{
+		BufferWriter savepic;
+
+		PutSavePic(&savepic, SAVEPICWIDTH, SAVEPICHEIGHT);
+		// put some basic info into the PNG so that this isn't lost when the image gets extracted.
+		M_AppendPNGText(&savepic, "Software", buf);
+		M_AppendPNGText(&savepic, "Title", description);
+		M_AppendPNGText(&savepic, "Current Map", level.MapName);
+		M_FinishPNG(&savepic);
+
+		auto picdata = savepic.GetBuffer();
+		FCompressedBuffer bufpng = { picdata->Size(), picdata->Size(), METHOD_STORED, 0, static_cast<unsigned int>(crc32(0, &(*picdata)[0], picdata->Size())), (char*)&(*picdata)[0] };
+		job->Add("savepic.png", bufpng);
+	}
 
 	int ver = SAVEVER;
 	savegameinfo.AddString("Software", buf)
@@ -2346,54 +2528,94 @@ void G_DoSaveGame (bool okForQuicksave, bool forceQuicksave, FString filename, c
 		savegameglobals("nextskill", NextSkill);
 	}
 
-	auto picdata = savepic.GetBuffer();
-	FCompressedBuffer bufpng = { picdata->Size(), picdata->Size(), METHOD_STORED, 0, static_cast<unsigned int>(crc32(0, &(*picdata)[0], picdata->Size())), (char*)&(*picdata)[0] };
+	// Only copying the serializer output happens here, deflating it is left to the save thread.
+	unsigned len;
+	const char *data = savegameinfo.GetOutput(&len);
+	TArray<char> raw(len, true);
+	if (len > 0) memcpy(&raw[0], data, len);
+	job->Add("info.json", std::move(raw));
 
-	savegame_content.Push(bufpng);
-	savegame_filenames.Push("savepic.png");
-	savegame_content.Push(savegameinfo.GetCompressedOutput());
-	savegame_filenames.Push("info.json");
-	savegame_content.Push(savegameglobals.GetCompressedOutput());
-	savegame_filenames.Push("globals.json");
+	data = savegameglobals.GetOutput(&len);
+	raw.Resize(len);
+	if (len > 0) memcpy(&raw[0], data, len);
+	job->Add("globals.json", std::move(raw));
 
-	G_WriteSnapshots (savegame_filenames, savegame_content);
-	
-
-	bool succeeded = false;
+	if (level.info->isValid())
+	{
+		job->Add(G_SnapshotFileName(level.info), std::move(levelsnapshot));
+	}
 
-	if (WriteZip(filename, savegame_filenames, savegame_content))
+	// The other levels' snapshots only need to be copied. Those which haven't
+	// been deflated yet are left to the save thread as well.
+	G_WriteSnapshots (snapshot_filenames, snapshot_content);
+	for (unsigned i = 0; i < snapshot_content.Size(); i++)
 	{
-		// Check whether the file is ok by trying to open it.
-		FResourceFile *test = FResourceFile::OpenResourceFile(filename, true);
-		if (test != nullptr)
+		auto &snapshot = snapshot_content[i];
+		if (snapshot.mMethod == METHOD_STORED)
+		{
+			raw.Resize(snapshot.mSize);
+			if (snapshot.mSize > 0) memcpy(&raw[0], snapshot.mBuffer, snapshot.mSize);
+			job->Add(snapshot_filenames[i], std::move(raw));
+		}
+		else
 		{
-			delete test;
-			succeeded = true;
+			job->Add(snapshot_filenames[i], snapshot);
 		}
 	}
+	return job.release();
+}
 
-	if (succeeded)
-	{
-		savegameManager.NotifyNewSave(filename, description, okForQuicksave, forceQuicksave);
-		BackupSaveName = filename;
+void G_DoSaveGame (bool okForQuicksave, bool forceQuicksave, FString filename, const char *description)
+{
+	FSaveGameJob *job;
 
-		if (longsavemessages) Printf("%s (%s)\n", GStrings("GGSAVED"), filename.GetChars());
-		else Printf("%s\n", GStrings("GGSAVED"));
+	// Do not even try, if we're not in a level. (Can happen after
+	// a demo finishes playback.)
+	if (level.lines.Size() == 0 || level.sectors.Size() == 0 || gamestate != GS_LEVEL)
+	{
+		return;
 	}
-	else
+
+	if (demoplayback)
 	{
-		Printf(PRINT_HIGH, "%s\n", GStrings("TXT_SAVEFAILED"));
+		filename = G_BuildSaveName ("demosave." SAVEGAME_EXT, -1);
 	}
 
+	// Only one savegame can be in flight at a time.
+	G_WaitForSaveThread();
 
-	// delete the JSON buffers we created just above. Everything else will
-	// either still be needed or taken care of automatically.
-	savegame_content[1].Clean();
-	savegame_content[2].Clean();
+	if (cl_waitforsave)
+		I_FreezeTime(true);
+
+	insave = true;
+	try
+	{
+		job = G_BuildSaveGame(description, true);
+	}
+	catch(CRecoverableError &err)
+	{
+		insave = false;
+		Printf(PRINT_HIGH, "Save failed\n");
+		Printf(PRINT_HIGH, "%s\n", err.GetMessage());
+		// The time freeze must be reset if the save fails.
+		if (cl_waitforsave)
+			I_FreezeTime(false);
+		return;
+	}
+	catch (...)
+	{
+		insave = false;
+		if (cl_waitforsave)
+			I_FreezeTime(false);
+		throw;
+	}
+
+	job->Filename = filename.GetChars();
+	job->Description = description;
+	job->OkForQuicksave = okForQuicksave;
+	job->ForceQuicksave = forceQuicksave;
+	G_StartSaveJob(job);
 
-	// We don't need the snapshot any longer.
-	level.info->Snapshot.Clean();
-		
 	insave = false;
 
 	if (cl_waitforsave)
@@ -2454,6 +2676,176 @@ void G_ReadDemoTiccmd (ticcmd_t *cmd, int player)
 	}
 } 
 
+//==========================================================================
+//
+// Demo keyframes
+//
+// With demo_keyframes set, the game state is kept in memory every that many
+// seconds of demo playback, in the same form as a savegame. demo_seek then
+// restores the last keyframe before the requested time and fast-forwards
+// from there without rendering, so a long demo doesn't have to be replayed
+// from the start to get to a point.
+//
+//==========================================================================
+
+CVAR(Int, demo_keyframes, 0, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)	// seconds between keyframes, 0 to disable them
+
+struct FDemoKeyframe
+{
+	int Tic;
+	ptrdiff_t DemoPos;
+	bool InGame[MAXPLAYERS];
+	ticcmd_t Cmds[MAXPLAYERS];	// the base for the next delta encoded commands
+	TArray<unsigned char> Data;	// savegame zip
+};
+
+static TArray<FDemoKeyframe> DemoKeyframes;
+
+static void G_ClearDemoKeyframes ()
+{
+	DemoKeyframes.Reset();
+	DemoTic = 0;
+	DemoSeekTarget = -1;
+}
+
+static void G_TakeDemoKeyframe ()
+{
+	int interval = demo_keyframes * TICRATE;
+
+	if (interval <= 0 || DemoTic % interval != 0 || demorecording)
+		return;
+	if (DemoKeyframes.Size() > 0 && DemoKeyframes.Last().Tic >= DemoTic)
+		return;
+	if (level.lines.Size() == 0 || level.sectors.Size() == 0)
+		return;
+
+	std::unique_ptr<FSaveGameJob> job;
+
+	insave = true;
+	try
+	{
+		job.reset(G_BuildSaveGame("Demo keyframe", false));
+	}
+	catch (CRecoverableError &err)
+	{
+		insave = false;
+		Printf(PRINT_HIGH, "Could not create a demo keyframe: %s\n", err.GetMessage());
+		return;
+	}
+	catch (...)
+	{
+		insave = false;
+		throw;
+	}
+	insave = false;
+
+	// This doesn't use the save thread. A seek may need the keyframe right away.
+	BufferWriter zip;
+	job->Compress();
+	if (!WriteZip(&zip, job->Filenames, job->Content))
+		return;
+
+	FDemoKeyframe &key = DemoKeyframes[DemoKeyframes.Reserve(1)];
+	key.Tic = DemoTic;
+	key.DemoPos = demo_p - demobuffer;
+	for (int i = 0; i < MAXPLAYERS; i++)
+	{
+		key.InGame[i] = playeringame[i];
+		key.Cmds[i] = players[i].cmd;
+	}
+	key.Data = std::move(*zip.GetBuffer());
+}
+
+static bool G_RestoreDemoKeyframe (FDemoKeyframe &key)
+{
+	FileReader fr;
+
+	if (!fr.OpenMemory(key.Data.Data(), key.Data.Size()))
+		return false;
+
+	std::unique_ptr<FResourceFile> resfile(FResourceFile::OpenResourceFile("demo keyframe", fr, true));
+	if (resfile == nullptr)
+		return false;
+
+	for (int i = 0; i < MAXPLAYERS; i++)
+	{
+		playeringame[i] = key.InGame[i];
+	}
+
+	// don't spend a lot of time in loadlevel
+	precache = false;
+	demonew = true;
+	bool res = G_ReadSaveGame(resfile, false);
+	demonew = false;
+	precache = true;
+	if (!res)
+		return false;
+
+	usergame = false;
+	for (int i = 0; i < MAXPLAYERS; i++)
+	{
+		players[i].cmd = key.Cmds[i];
+	}
+	demo_p = demobuffer + key.DemoPos;
+	DemoTic = key.Tic;
+	return true;
+}
+
+static void G_DoDemoSeek ()
+{
+	if (!demoplayback || DemoSeekTarget < 0)
+		return;
+
+	int best = -1;
+	for (unsigned i = 0; i < DemoKeyframes.Size() && DemoKeyframes[i].Tic <= DemoSeekTarget; i++)
+	{
+		best = i;
+	}
+
+	// Only go through a keyframe if it's going backwards or it skips ahead.
+	// Otherwise just continue from where the demo currently is.
+	if (DemoSeekTarget < DemoTic || (best >= 0 && DemoKeyframes[best].Tic > DemoTic))
+	{
+		if (best < 0)
+		{
+			Printf("There is no keyframe before that point. Set demo_keyframes to seek backwards.\n");
+			DemoSeekTarget = -1;
+			return;
+		}
+		if (!G_RestoreDemoKeyframe(DemoKeyframes[best]))
+		{
+			Printf("Could not restore the demo keyframe.\n");
+			DemoSeekTarget = -1;
+			return;
+		}
+	}
+	if (DemoSeekTarget <= DemoTic)
+	{
+		DemoSeekTarget = -1;
+	}
+}
+
+bool G_DemoSeeking ()
+{
+	return demoplayback && DemoSeekTarget >= 0;
+}
+
+CCMD (demo_seek)
+{
+	if (!demoplayback)
+	{
+		Printf("Not playing back a demo\n");
+		return;
+	}
+	if (argv.argc() < 2)
+	{
+		Printf("Usage: demo_seek <seconds>\nThe demo is at %d seconds, with %u keyframes\n", DemoTic / TICRATE, DemoKeyframes.Size());
+		return;
+	}
+	DemoSeekTarget = MAX(0, int(atof(argv[1]) * TICRATE));
+	gameaction = ga_demoseek;
+}
+
 bool stoprecording;
 
 CCMD (stop)
@@ -2796,6 +3188,7 @@ void G_DoPlayDemo (void)
 	int demolump;
 
 	gameaction = ga_nothing;
+	G_ClearDemoKeyframes();
 
 	// [RH] Allow for demos not loaded as lumps
 	demolump = Wads.CheckNumForFullName (defdemoname, true);
@@ -2915,6 +3308,7 @@ bool G_CheckDemoStatus (void)
 		C_RestoreCVars ();		// [RH] Restore cvars demo might have changed
 		M_Free (demobuffer);
 		demobuffer = NULL;
+		G_ClearDemoKeyframes();
 
 		P_SetupWeapons_ntohton();
 		demoplayback = false;
@@ -2936,6 +3330,7 @@ bool G_CheckDemoStatus (void)
 				// Trying to get back to a stable state after timing a demo
 				// seems to cause problems. I don't feel like fixing that
 				// right now.
+				D_CloseTimeDemoLog();
 				I_FatalError ("timed %i gametics in %i realtics (%.1f fps)\n"
 							  "(This is not really an error.)", gametic,
 							  endtime, (float)gametic/(float)endtime*(float)TICRATE);
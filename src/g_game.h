@@ -60,6 +60,9 @@ void G_DoLoadGame (void);
 void G_SaveGame (const char *filename, const char *description);
 // Called by messagebox
 void G_DoQuickSave ();
+// Savegames are written on a worker thread
+void G_CheckSaveThread ();
+void G_WaitForSaveThread ();
 
 // Only called by startup code.
 void G_RecordDemo (const char* name);
@@ -69,6 +72,7 @@ void G_BeginRecording (const char *startmap);
 void G_PlayDemo (char* name);
 void G_TimeDemo (const char* name);
 bool G_CheckDemoStatus (void);
+bool G_DemoSeeking (void);
 
 void G_WorldDone (void);
 
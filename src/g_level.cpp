@@ -94,18 +94,24 @@
 
 #include "g_hub.h"
 #include "g_levellocals.h"
+#include "stats.h"
 #include "actorinlines.h"
 #include "vm.h"
 #include "i_time.h"
 #include "p_maputl.h"
 #include "s_music.h"
+#include "jobs.h"
 
 #include <string.h>
+#include <zlib.h>
+#include <exception>
 
 void STAT_StartNewGame(const char *lev);
 void STAT_ChangeLevel(const char *newl);
 
 EXTERN_CVAR(Bool, save_formatted)
+EXTERN_CVAR(Bool, save_binary)
+CVAR(Int, hub_snapshotmemory, 32, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)	// megabytes of hub snapshots that are kept uncompressed
 EXTERN_CVAR (Float, sv_gravity)
 EXTERN_CVAR (Float, sv_aircontrol)
 EXTERN_CVAR (Int, disableautosave)
@@ -913,6 +919,8 @@ void G_DoCompleted (void)
 		{ // Make sure we don't have a snapshot lying around from before.
 			level.info->Snapshot.Clean();
 		}
+		// If the next level was visited before, get its snapshot parsed during the intermission.
+		G_PreparseSnapshot(FindLevelInfo(nextlevel, false));
 	}
 	else
 	{ // Forget the states of all existing levels.
@@ -996,6 +1004,9 @@ void G_DoLoadLevel (int position, bool autosave, bool newGame)
 	else
 		lastposition = position;
 
+	// Loading takes long by design, there's nothing to learn from logging it.
+	FHitchLog::SkipFrame();
+
 	G_InitLevelLocals ();
 	StatusBar->DetachAllMessages ();
 
@@ -1718,17 +1729,175 @@ void G_SnapshotLevel ()
 {
 	level.info->Snapshot.Clean();
 
+	if (level.info->isValid())
+	{
+		TArray<char> output;
+
+		if (G_SnapshotLevelUncompressed(output))
+		{
+			// Hub snapshots are kept stored and only get deflated once the
+			// uncompressed ones exceed hub_snapshotmemory, so leaving a level
+			// doesn't have to wait for zlib.
+			unsigned len = output.Size();
+			FCompressedBuffer &snapshot = level.info->Snapshot;
+			snapshot.mSize = snapshot.mCompressedSize = len;
+			snapshot.mMethod = METHOD_STORED;
+			snapshot.mZipFlags = 0;
+			snapshot.mCRC32 = crc32(0, (const Bytef*)output.Data(), len);
+			snapshot.mBuffer = new char[len + 1];
+			if (len > 0) memcpy(snapshot.mBuffer, output.Data(), len);
+			snapshot.mBuffer[len] = 0;
+			G_PackSnapshots(level.info);
+		}
+	}
+}
+
+//==========================================================================
+//
+// Deflates stored hub snapshots until the uncompressed ones fit into
+// hub_snapshotmemory again. The one for 'keep' is left alone since that's
+// the level which was just left.
+//
+//==========================================================================
+
+static void PackSnapshot(level_info_t *info)
+{
+	FCompressedBuffer &snapshot = info->Snapshot;
+	FCompressedBuffer packed = CompressZipBuffer(snapshot.mBuffer, snapshot.mSize);
+	snapshot.Clean();
+	snapshot = packed;
+}
+
+void G_PackSnapshots(level_info_t *keep)
+{
+	size_t budget = size_t(MAX(*hub_snapshotmemory, 0)) << 20;
+	size_t stored = 0;
+
+	auto count = [&](level_info_t *info)
+	{
+		if (info->Snapshot.mBuffer != nullptr && info->Snapshot.mMethod == METHOD_STORED) stored += info->Snapshot.mSize;
+	};
+	auto pack = [&](level_info_t *info)
+	{
+		if (stored > budget && info != keep && info->Snapshot.mBuffer != nullptr && info->Snapshot.mMethod == METHOD_STORED)
+		{
+			stored -= info->Snapshot.mSize;
+			PackSnapshot(info);
+		}
+	};
+
+	for (auto &info : wadlevelinfos) count(&info);
+	count(&TheDefaultLevelInfo);
+
+	for (auto &info : wadlevelinfos) pack(&info);
+	pack(&TheDefaultLevelInfo);
+}
+
+//==========================================================================
+//
+// Serializes the current level without compressing it. The savegame code
+// uses this so that the output can be deflated on the save thread.
+//
+//==========================================================================
+
+bool G_SnapshotLevelUncompressed (TArray<char> &output)
+{
+	output.Clear();
+
 	if (level.info->isValid())
 	{
 		FSerializer arc;
 
-		if (arc.OpenWriter(save_formatted))
+		if (save_binary && !save_formatted ? arc.OpenBinaryWriter() : arc.OpenWriter(save_formatted))
 		{
+			unsigned len;
+
 			SaveVersion = SAVEVER;
 			G_SerializeLevel(arc, false);
-			level.info->Snapshot = arc.GetCompressedOutput();
+			const char *data = arc.GetOutput(&len);
+			output.Resize(len);
+			if (len > 0) memcpy(&output[0], data, len);
+			return true;
 		}
 	}
+	return false;
+}
+
+//==========================================================================
+//
+// Parsing a big snapshot takes about as long as loading the map itself, so
+// when it's known which level will be entered next, its snapshot is parsed
+// on a worker thread while the map gets set up. The worker gets its own
+// copy of the buffer so nothing the game thread does can disturb it.
+//
+//==========================================================================
+
+static FJobCounter PreparseJob;
+static bool PreparseStarted;
+static FCompressedBuffer PreparseInput = { 0,0,0,0,0,nullptr };
+static level_info_t *PreparseLevel;
+static FReader *PreparseResult;
+static std::exception_ptr PreparseError;
+
+static FReader *G_FinishPreparse (level_info_t *info)
+{
+	if (!PreparseStarted)
+		return nullptr;
+
+	Jobs.Wait(PreparseJob);
+	PreparseStarted = false;
+	FReader *result = PreparseResult;
+	auto error = PreparseError;
+	// The level's snapshot may have been replaced or packed in the meantime.
+	// Packing keeps the CRC of the uncompressed data, replacing it doesn't.
+	bool match = info != nullptr && info == PreparseLevel && info->Snapshot.mBuffer != nullptr &&
+		info->Snapshot.mCRC32 == PreparseInput.mCRC32 && info->Snapshot.mSize == PreparseInput.mSize;
+
+	PreparseInput.Clean();
+	PreparseLevel = nullptr;
+	PreparseResult = nullptr;
+	PreparseError = nullptr;
+
+	if (!match)
+	{
+		DeleteSerializerInput(result);
+		return nullptr;
+	}
+	if (error)
+	{
+		std::rethrow_exception(error);
+	}
+	return result;
+}
+
+void G_PreparseSnapshot (level_info_t *info)
+{
+	DeleteSerializerInput(G_FinishPreparse(nullptr));
+
+	if (info == nullptr || info->Snapshot.mBuffer == nullptr || !info->isValid())
+		return;
+
+	PreparseInput = info->Snapshot;
+	PreparseInput.mBuffer = new char[info->Snapshot.mCompressedSize];
+	memcpy(PreparseInput.mBuffer, info->Snapshot.mBuffer, info->Snapshot.mCompressedSize);
+	PreparseLevel = info;
+	PreparseStarted = true;
+	Jobs.Submit(PreparseJob, []()
+	{
+		try
+		{
+			PreparseResult = ParseSerializerInput(&PreparseInput);
+		}
+		catch (...)
+		{
+			PreparseError = std::current_exception();
+		}
+	});
+}
+
+void G_CancelPreparse ()
+{
+	DeleteSerializerInput(G_FinishPreparse(nullptr));
 }
 
 //==========================================================================
@@ -1740,13 +1909,18 @@ void G_SnapshotLevel ()
 
 void G_UnSnapshotLevel (bool hubLoad)
 {
+	FReader *preparsed = G_FinishPreparse(level.info);
+
 	if (level.info->Snapshot.mBuffer == nullptr)
+	{
+		DeleteSerializerInput(preparsed);
 		return;
+	}
 
 	if (level.info->isValid())
 	{
 		FSerializer arc;
-		if (!arc.OpenReader(&level.info->Snapshot))
+		if (preparsed != nullptr ? !arc.OpenReader(preparsed) : !arc.OpenReader(&level.info->Snapshot))
 		{
 			I_Error("Failed to load savegame");
 			return;
@@ -1796,26 +1970,30 @@ void G_UnSnapshotLevel (bool hubLoad)
 //
 //==========================================================================
 
+FString G_SnapshotFileName(level_info_t *info)
+{
+	FString filename;
+
+	filename.Format(info == &TheDefaultLevelInfo? "%s.mapd.json" : "%s.map.json", info->MapName.GetChars());
+	filename.ToLower();
+	return filename;
+}
+
 void G_WriteSnapshots(TArray<FString> &filenames, TArray<FCompressedBuffer> &buffers)
 {
 	unsigned int i;
-	FString filename;
 
 	for (i = 0; i < wadlevelinfos.Size(); i++)
 	{
 		if (wadlevelinfos[i].Snapshot.mCompressedSize > 0)
 		{
-			filename.Format("%s.map.json", wadlevelinfos[i].MapName.GetChars());
-			filename.ToLower();
-			filenames.Push(filename);
+			filenames.Push(G_SnapshotFileName(&wadlevelinfos[i]));
 			buffers.Push(wadlevelinfos[i].Snapshot);
 		}
 	}
 	if (TheDefaultLevelInfo.Snapshot.mCompressedSize > 0)
 	{
-		filename.Format("%s.mapd.json", TheDefaultLevelInfo.MapName.GetChars());
-		filename.ToLower();
-		filenames.Push(filename);
+		filenames.Push(G_SnapshotFileName(&TheDefaultLevelInfo));
 		buffers.Push(TheDefaultLevelInfo.Snapshot);
 	}
 }
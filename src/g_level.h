@@ -525,8 +525,13 @@ void G_ParseMapInfo (FString basemapinfo);
 void G_ClearSnapshots (void);
 void P_RemoveDefereds ();
 void G_SnapshotLevel (void);
+bool G_SnapshotLevelUncompressed (TArray<char> &output);
+void G_PreparseSnapshot (level_info_t *info);
+void G_CancelPreparse ();
+void G_PackSnapshots (level_info_t *keep);
 void G_UnSnapshotLevel (bool keepPlayers);
 void G_ReadSnapshots (FResourceFile *);
+FString G_SnapshotFileName (level_info_t *info);
 void G_WriteSnapshots (TArray<FString> &, TArray<FCompressedBuffer> &);
 void G_WriteVisited(FSerializer &arc);
 void G_ReadVisited(FSerializer &arc);
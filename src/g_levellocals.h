@@ -60,7 +60,10 @@ struct FLevelData
 	TArray<subsector_t> gamesubsectors;
 	TArray<node_t> gamenodes;
 	node_t *headgamenode;
+	FPointTree pointnodes;		// compact copies for R_PointInSubsector and P_PointInSubsector
+	FPointTree gamepointnodes;
 	TArray<uint8_t> rejectmatrix;
+	TArray<uint16_t> sightgroups;	// sectors with different groups are never connected
 	TArray<zone_t>	Zones;
 
 	TArray<FSectorPortal> sectorPortals;
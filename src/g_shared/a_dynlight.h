@@ -266,6 +266,7 @@ public:
 	int m_tickCount;
 	int m_lastUpdate;
 	int mShadowmapIndex;
+	int mCollectStamp;		// used by the renderer to find lights already collected for a model.
 	bool m_active;
 	bool visibletoplayer;
 	bool shadowmapped;
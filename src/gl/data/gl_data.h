@@ -60,6 +60,7 @@ extern TArray<FPortal *> glSectorPortals;
 extern TArray<FGLLinePortal*> linePortalToGL;
 
 extern TArray<uint8_t> currentmapsection;
+extern TArray<uint64_t> nodemapsections;
 
 void gl_InitPortals();
 void gl_BuildPortalCoverage(FPortalCoverage *coverage, subsector_t *subsector, const DVector2 &displacement);
@@ -249,6 +249,27 @@ static void SpreadHackedFlag(subsector_t * sub)
 }
 
 
+//==========================================================================
+//
+// Collects which map sections each node's subtree contains, so that the
+// BSP walk can skip everything that can't be seen from the current view.
+// With more than 64 sections several share a bit, which is still safe.
+//
+//==========================================================================
+
+static uint64_t SetNodeMapSections(void *node)
+{
+	if ((size_t)node & 1)
+	{
+		subsector_t *sub = (subsector_t *)((uint8_t *)node - 1);
+		return 1ull << (sub->mapsection & 63);
+	}
+	node_t *bsp = (node_t *)node;
+	uint64_t mask = SetNodeMapSections(bsp->children[0]) | SetNodeMapSections(bsp->children[1]);
+	nodemapsections[bsp->Index()] = mask;
+	return mask;
+}
+
 //==========================================================================
 //
 // 
@@ -301,6 +322,9 @@ static void PrepareSectorData()
 	}
 	MapSectionGenerator msg;
 	msg.SetMapSections();
+
+	nodemapsections.Resize(level.nodes.Size());
+	if (level.nodes.Size() > 0) SetNodeMapSections(level.HeadNode());
 }
 
 //==========================================================================
@@ -159,6 +159,9 @@ FFlatVertexBuffer::FFlatVertexBuffer(int width, int height)
 	}
 	}
 	mIndex = mCurIndex = 0;
+	mStaticIndex = mStaticEnd = 0;
+	mFrame = mLevelGeneration = 0;
+	mBatching = false;
 	mNumReserved = NUM_RESERVED;
 	vbo_shadowdata.Resize(mNumReserved);
 
@@ -273,6 +276,39 @@ void FFlatVertexBuffer::Unmap()
 	}
 }
 
+//==========================================================================
+//
+// Submits the draws that were merged by RenderArray
+//
+//==========================================================================
+
+unsigned int gl_pendingdraws;
+
+void gl_FlushPendingDraws()
+{
+	GLRenderer->mVBO->FlushBatch();
+}
+
+void FFlatVertexBuffer::FlushBatch()
+{
+	unsigned int count = mBatchFirst.Size();
+	if (count == 0) return;
+
+	gl_pendingdraws = 0;
+	drawcalls.Clock();
+	if (count == 1)
+	{
+		glDrawArrays(GL_TRIANGLE_FAN, mBatchFirst[0], mBatchCount[0]);
+	}
+	else
+	{
+		glMultiDrawArrays(GL_TRIANGLE_FAN, &mBatchFirst[0], &mBatchCount[0], count);
+	}
+	drawcalls.Unclock();
+	mBatchFirst.Clear();
+	mBatchCount.Clear();
+}
+
 //==========================================================================
 //
 // Initialize a single vertex
@@ -450,7 +486,10 @@ void FFlatVertexBuffer::CreateVBO()
 {
 	vbo_shadowdata.Resize(mNumReserved);
 	CreateFlatVBO();
-	mCurIndex = mIndex = vbo_shadowdata.Size();
+	mStaticIndex = vbo_shadowdata.Size();
+	mStaticEnd = mStaticIndex + STATIC_WALL_SIZE;
+	mCurIndex = mIndex = mStaticEnd;
+	mLevelGeneration++;
 	Map();
 	memcpy(map, &vbo_shadowdata[0], vbo_shadowdata.Size() * sizeof(FFlatVertex));
 	Unmap();
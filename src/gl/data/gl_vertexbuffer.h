@@ -110,11 +110,19 @@ class FFlatVertexBuffer : public FVertexBuffer
 	unsigned int mIndex;
 	unsigned int mCurIndex;
 	unsigned int mNumReserved;
+	unsigned int mStaticIndex;		// next free entry in the area for cached wall vertices
+	unsigned int mStaticEnd;		// the streaming area starts here
+	unsigned int mFrame;
+	unsigned int mLevelGeneration;
+	bool mBatching;
+	TArray<int> mBatchFirst;		// triangle fans waiting to be submitted with a single call
+	TArray<int> mBatchCount;
 
 	void CheckPlanes(sector_t *sector);
 
 	static const unsigned int BUFFER_SIZE = 2000000;
 	static const unsigned int BUFFER_SIZE_TO_USE = 1999500;
+	static const unsigned int STATIC_WALL_SIZE = 300000;
 
 public:
 	enum
@@ -153,6 +161,31 @@ public:
 		return p;
 	}
 
+	// Allocates from the part of the buffer that is not overwritten every frame.
+	// Returns nullptr once that space is used up.
+	FFlatVertex *AllocStatic(unsigned int num, unsigned int *poffset)
+	{
+		if (mStaticIndex + num > mStaticEnd) return nullptr;
+		*poffset = mStaticIndex;
+		mStaticIndex += num;
+		return &map[*poffset];
+	}
+
+	FFlatVertex *GetVertex(unsigned int index)
+	{
+		return &map[index];
+	}
+
+	unsigned int GetFrame() const
+	{
+		return mFrame;
+	}
+
+	unsigned int GetLevelGeneration() const
+	{
+		return mLevelGeneration;
+	}
+
 	unsigned int GetCount(FFlatVertex *newptr, unsigned int *poffset)
 	{
 		unsigned int newofs = (unsigned int)(newptr - map);
@@ -165,6 +198,15 @@ public:
 #ifdef __GL_PCH_H	// we need the system includes for this but we cannot include them ourselves without creating #define clashes. The affected files wouldn't try to draw anyway.
 	void RenderArray(unsigned int primtype, unsigned int offset, unsigned int count)
 	{
+		if (mBatching && primtype == GL_TRIANGLE_FAN)
+		{
+			// Consecutive fans with the same state get merged. The gl_CheckPendingDraws calls
+			// in the state setting code take care of submitting them before anything changes.
+			mBatchFirst.Push(offset);
+			mBatchCount.Push(count);
+			gl_pendingdraws++;
+			return;
+		}
 		drawcalls.Clock();
 		glDrawArrays(primtype, offset, count);
 		drawcalls.Unclock();
@@ -183,11 +225,23 @@ public:
 	void Reset()
 	{
 		mCurIndex = mIndex;
+		mFrame++;
 	}
 
 	void Map();
 	void Unmap();
 
+	void BeginBatch()
+	{
+		mBatching = true;
+	}
+	void EndBatch()
+	{
+		FlushBatch();
+		mBatching = false;
+	}
+	void FlushBatch();
+
 private:
 	int CreateSubsectorVertices(subsector_t *sub, const secplane_t &plane, int floor);
 	int CreateSectorVertices(sector_t *sec, const secplane_t &plane, int floor);
@@ -269,7 +323,7 @@ public:
 
 class FModelVertexBuffer : public FVertexBuffer, public IModelVertexBuffer
 {
-	int mIndexFrame[2];
+	int mIndexFrame[2];	// frames the attribute pointers were last set up for, -1 if unknown.
 	FModelVertex *vbo_ptr;
 	uint32_t ibo_id;
 
@@ -86,6 +86,7 @@ void FLightBuffer::Clear()
 	mIndex = 0;
 	mIndices.Clear();
 	mUploadIndex = 0;
+	mLastIndex = -1;
 }
 
 int FLightBuffer::UploadLights(FDynLightData &data)
@@ -95,6 +96,15 @@ int FLightBuffer::UploadLights(FDynLightData &data)
 	int size2 = data.arrays[2].Size()/4;
 	int totalsize = size0 + size1 + size2 + 1;
 
+	if (totalsize <= 1) return -1;
+
+	// Neighboring surfaces are mostly touched by the same lights, so check if this is the list that was just uploaded.
+	if (mLastIndex >= 0 && IsLastUpload(data))
+	{
+		draw_dlight += (totalsize-1) / 2;
+		return mLastIndex;
+	}
+
 	// pointless type casting because some compilers can't print enough warnings.
 	if (mBlockAlign > 0 && (unsigned int)totalsize + (mIndex % mBlockAlign) > mBlockSize)
 	{
@@ -174,9 +184,27 @@ int FLightBuffer::UploadLights(FDynLightData &data)
 	unsigned int bufferindex = mIndex;
 	mIndex += totalsize;
 	draw_dlight += (totalsize-1) / 2;
+
+	for (int i = 0; i < 3; i++)
+	{
+		mLastLights[i].Resize(data.arrays[i].Size());
+		if (data.arrays[i].Size() > 0) memcpy(&mLastLights[i][0], &data.arrays[i][0], data.arrays[i].Size() * sizeof(float));
+	}
+	mLastIndex = bufferindex;
 	return bufferindex;
 }
 
+bool FLightBuffer::IsLastUpload(FDynLightData &data) const
+{
+	for (int i = 0; i < 3; i++)
+	{
+		unsigned size = data.arrays[i].Size();
+		if (size != mLastLights[i].Size()) return false;
+		if (size > 0 && memcmp(&data.arrays[i][0], &mLastLights[i][0], size * sizeof(float))) return false;
+	}
+	return true;
+}
+
 void FLightBuffer::Begin()
 {
 	if (gl.lightmethod == LM_DEFERRED)
@@ -203,6 +231,7 @@ int FLightBuffer::BindUBO(unsigned int index)
 	if (offset != mLastMappedIndex)
 	{
 		// this will only get called if a uniform buffer is used. For a shader storage buffer we only need to bind the buffer once at the start to all shader programs
+		gl_CheckPendingDraws();
 		mLastMappedIndex = offset;
 		glBindBufferRange(GL_UNIFORM_BUFFER, LIGHTBUF_BINDINGPOINT, mBufferId, offset*16, mBlockSize*16);	// we go from counting vec4's to counting bytes here.
 	}
@@ -7,6 +7,8 @@ struct FDynLightData;
 class FLightBuffer
 {
 	TArray<int> mIndices;
+	TArray<float> mLastLights[3];	// the most recent upload, so that identical lists can share it.
+	int mLastIndex;
 	unsigned int mBufferId;
 	float * mBufferPointer;
 
@@ -19,6 +21,8 @@ class FLightBuffer
 	unsigned int mBufferSize;
 	unsigned int mByteSize;
 
+	bool IsLastUpload(FDynLightData &data) const;
+
 public:
 
 	FLightBuffer();
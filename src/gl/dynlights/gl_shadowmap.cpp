@@ -68,12 +68,13 @@ namespace
 	cycle_t UpdateCycles;
 	int LightsProcessed;
 	int LightsShadowmapped;
+	int LightsUpdated;
 }
 
 ADD_STAT(shadowmap)
 {
 	FString out;
-	out.Format("upload=%04.2f ms  lights=%d  shadowmapped=%d", UpdateCycles.TimeMS(), LightsProcessed, LightsShadowmapped);
+	out.Format("upload=%04.2f ms  lights=%d  shadowmapped=%d  updated=%d", UpdateCycles.TimeMS(), LightsProcessed, LightsShadowmapped, LightsUpdated);
 	return out;
 }
 
@@ -111,6 +112,7 @@ void FShadowMap::Update()
 	UpdateCycles.Reset();
 	LightsProcessed = 0;
 	LightsShadowmapped = 0;
+	LightsUpdated = 0;
 
 	if (!IsEnabled())
 		return;
@@ -125,21 +127,45 @@ void FShadowMap::Update()
 
 	GLRenderer->mBuffers->BindShadowMapFB();
 
-	GLRenderer->mShadowMapShader->Bind();
-	GLRenderer->mShadowMapShader->ShadowmapQuality.Set(gl_shadowmap_quality);
-	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, mLightList);
-	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, mNodesBuffer);
-	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, mLinesBuffer);
+	// The texture's rows only depend on the light's row in the light list, because the AABB tree is static.
+	// So only the rows that differ from the last update need to be traced again.
+	if (mLastGeneration != FGLRenderBuffers::GetShadowMapGeneration())
+	{
+		mLastGeneration = FGLRenderBuffers::GetShadowMapGeneration();
+		mLastLights.Clear();
+	}
+	CollectDirtyRows();
+
+	if (mDirtyRows.Size() > 0)
+	{
+		GLint scissor[4];
+		glGetIntegerv(GL_SCISSOR_BOX, scissor);
+
+		GLRenderer->mShadowMapShader->Bind();
+		GLRenderer->mShadowMapShader->ShadowmapQuality.Set(gl_shadowmap_quality);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, mLightList);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, mNodesBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, mLinesBuffer);
+
+		glViewport(0, 0, gl_shadowmap_quality, 1024);
+		glEnable(GL_SCISSOR_TEST);
+		for (unsigned i = 0; i < mDirtyRows.Size(); i += 2)
+		{
+			glScissor(0, mDirtyRows[i], gl_shadowmap_quality, mDirtyRows[i + 1] - mDirtyRows[i]);
+			GLRenderer->RenderScreenQuad();
+		}
+		glScissor(scissor[0], scissor[1], scissor[2], scissor[3]);
 
-	glViewport(0, 0, gl_shadowmap_quality, 1024);
-	GLRenderer->RenderScreenQuad();
+		const auto &viewport = GLRenderer->mScreenViewport;
+		glViewport(viewport.left, viewport.top, viewport.width, viewport.height);
 
-	const auto &viewport = GLRenderer->mScreenViewport;
-	glViewport(viewport.left, viewport.top, viewport.width, viewport.height);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, 0);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, 0);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, 0);
+	}
 
-	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, 0);
-	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, 0);
-	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, 0);
+	mLastLights.Resize(mLights.Size());
+	memcpy(&mLastLights[0], &mLights[0], sizeof(float) * mLights.Size());
 
 	GLRenderer->mBuffers->BindShadowMapTexture(16);
 
@@ -148,6 +174,30 @@ void FShadowMap::Update()
 	UpdateCycles.Unclock();
 }
 
+void FShadowMap::CollectDirtyRows()
+{
+	mDirtyRows.Clear();
+	bool all = mLastLights.Size() != mLights.Size();
+
+	for (int row = 0; row < 1024; row++)
+	{
+		if (all || memcmp(&mLights[row * 4], &mLastLights[row * 4], 4 * sizeof(float)))
+		{
+			LightsUpdated++;
+			// Merge runs with small gaps to keep the number of passes down.
+			if (mDirtyRows.Size() > 0 && row - (int)mDirtyRows.Last() < 16)
+			{
+				mDirtyRows.Last() = row + 1;
+			}
+			else
+			{
+				mDirtyRows.Push(row);
+				mDirtyRows.Push(row + 1);
+			}
+		}
+	}
+}
+
 bool FShadowMap::ShadowTest(FDynamicLight *light, const DVector3 &pos)
 {
 	if (light->shadowmapped && light->GetRadius() > 0.0 && IsEnabled() && mAABBTree)
@@ -164,38 +214,59 @@ bool FShadowMap::IsEnabled() const
 void FShadowMap::UploadLights()
 {
 	if (mLights.Size() != 1024 * 4) mLights.Resize(1024 * 4);
-	int lightindex = 0;
+	bool slotused[1024] = {};
+	int lightcount = 0;
 
 	// Todo: this should go through the blockmap in a spiral pattern around the player so that closer lights are preferred.
+	// Lights keep the row they had in the last update if possible so that it doesn't need to be traced again.
 	for (auto light = level.lights; light; light = light->next)
 	{
 		LightsProcessed++;
-		if (light->shadowmapped && lightindex < 1024 * 4)
+		if (light->shadowmapped && lightcount < 1024)
 		{
 			LightsShadowmapped++;
+			lightcount++;
+
+			if (light->mShadowmapIndex >= 0 && light->mShadowmapIndex < 1024 && !slotused[light->mShadowmapIndex])
+			{
+				slotused[light->mShadowmapIndex] = true;
+			}
+			else
+			{
+				light->mShadowmapIndex = -1;
+			}
+		}
+		else
+		{
+			light->mShadowmapIndex = 1024;
+		}
+	}
 
-			light->mShadowmapIndex = lightindex >> 2;
+	memset(&mLights[0], 0, sizeof(float) * mLights.Size());
 
+	int freeslot = 0;
+	for (auto light = level.lights; light; light = light->next)
+	{
+		if (light->mShadowmapIndex == -1)
+		{
+			while (slotused[freeslot]) freeslot++;
+			slotused[freeslot] = true;
+			light->mShadowmapIndex = freeslot;
+		}
+		if (light->mShadowmapIndex < 1024)
+		{
+			int lightindex = light->mShadowmapIndex * 4;
 			mLights[lightindex] = light->X();
 			mLights[lightindex+1] = light->Y();
 			mLights[lightindex+2] = light->Z();
 			mLights[lightindex+3] = light->GetRadius();
-			lightindex += 4;
 		}
-        else
-        {
-            light->mShadowmapIndex = 1024;
-        }
-
-	}
-
-	for (; lightindex < 1024 * 4; lightindex++)
-	{
-		mLights[lightindex] = 0;
 	}
 
 	if (mLightList == 0)
 		glGenBuffers(1, (GLuint*)&mLightList);
+	else if (mLastLights.Size() == mLights.Size() && !memcmp(&mLights[0], &mLastLights[0], sizeof(float) * mLights.Size()))
+		return;
 
 	int oldBinding = 0;
 	glGetIntegerv(GL_SHADER_STORAGE_BUFFER_BINDING, &oldBinding);
@@ -208,13 +279,19 @@ void FShadowMap::UploadAABBTree()
 {
 	// Just comparing the level info is not enough. If two MAPINFO-less levels get played after each other, 
 	// they can both refer to the same default level info.
-	if (level.info != mLastLevel && (level.nodes.Size() != mLastNumNodes || level.segs.Size() != mLastNumSegs))
+	WaitForAABBTree();
+
+	// A pending tree always belongs to the level that was just set up.
+	if (mPendingAABBTree || (level.info != mLastLevel && (level.nodes.Size() != mLastNumNodes || level.segs.Size() != mLastNumSegs)))
 		Clear();
 
 	if (mAABBTree)
 		return;
 
-	mAABBTree.reset(new LevelAABBTree());
+	if (mPendingAABBTree)
+		mAABBTree = std::move(mPendingAABBTree);
+	else
+		mAABBTree.reset(new LevelAABBTree());
 
 	int oldBinding = 0;
 	glGetIntegerv(GL_SHADER_STORAGE_BUFFER_BINDING, &oldBinding);
@@ -230,6 +307,30 @@ void FShadowMap::UploadAABBTree()
 	glBindBuffer(GL_SHADER_STORAGE_BUFFER, oldBinding);
 }
 
+//===========================================================================
+//
+// The tree only depends on the level's lines, which do not change
+// between the end of P_SetupLevel's geometry setup and the first tic,
+// so it can be built while the level's textures are being precached.
+//
+//===========================================================================
+
+void FShadowMap::StartAABBTreeBuild()
+{
+	WaitForAABBTree();
+	mPendingAABBTree.reset();
+
+	if (!IsEnabled() || level.lines.Size() == 0)
+		return;
+
+	Jobs.Submit(mAABBTreeJob, [this]() { mPendingAABBTree.reset(new LevelAABBTree()); });
+}
+
+void FShadowMap::WaitForAABBTree()
+{
+	Jobs.Wait(mAABBTreeJob);
+}
+
 void FShadowMap::Clear()
 {
 	if (mLightList != 0)
@@ -251,6 +352,7 @@ void FShadowMap::Clear()
 	}
 
 	mAABBTree.reset();
+	mLastLights.Clear();
 
 	mLastLevel = level.info;
 	mLastNumNodes = level.nodes.Size();
@@ -3,6 +3,7 @@
 
 #include "gl/dynlights/gl_aabbtree.h"
 #include "tarray.h"
+#include "jobs.h"
 #include <memory>
 
 struct FDynamicLight;
@@ -12,11 +13,17 @@ class FShadowMap
 {
 public:
 	FShadowMap() { }
-	~FShadowMap() { Clear(); }
+	~FShadowMap() { WaitForAABBTree(); Clear(); }
 
 	// Release resources
 	void Clear();
 
+	// Start building the AABB tree of a freshly loaded level on a worker thread
+	void StartAABBTreeBuild();
+
+	// Wait for a pending StartAABBTreeBuild to finish
+	void WaitForAABBTree();
+
 	// Update shadow map texture
 	void Update();
 
@@ -33,12 +40,22 @@ private:
 	// Upload light list to the GPU
 	void UploadLights();
 
+	// Find the texture rows that need to be traced again
+	void CollectDirtyRows();
+
 	// OpenGL storage buffer with the list of lights in the shadow map texture
 	int mLightList = 0;
 
 	// Working buffer for creating the list of lights. Stored here to avoid allocating memory each frame
 	TArray<float> mLights;
 
+	// Light list of the last update and the shadow map texture it was rendered into
+	TArray<float> mLastLights;
+	unsigned mLastGeneration = 0;
+
+	// Pairs of first and end row that need to be updated
+	TArray<int> mDirtyRows;
+
 	// OpenGL storage buffers for the AABB tree
 	int mNodesBuffer = 0;
 	int mLinesBuffer = 0;
@@ -51,6 +68,10 @@ private:
 	// AABB-tree of the level, used for ray tests
 	std::unique_ptr<LevelAABBTree> mAABBTree;
 
+	// Tree built in the background during level setup, picked up by UploadAABBTree
+	std::unique_ptr<LevelAABBTree> mPendingAABBTree;
+	FJobCounter mAABBTreeJob;
+
 	FShadowMap(const FShadowMap &) = delete;
 	FShadowMap &operator=(FShadowMap &) = delete;
 };
@@ -25,6 +25,14 @@
 #include <stdlib.h>
 #include <stdint.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HQX_SSE2
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define HQX_NEON
+#endif
+
 #define MASK_2     0x0000FF00
 #define MASK_13    0x00FF00FF
 #define MASK_RGB   0x00FFFFFF
@@ -58,6 +66,50 @@ static inline int Diff(uint32_t c1, uint32_t c2)
     return yuv_diff(rgb_to_yuv(c1), rgb_to_yuv(c2));
 }
 
+/* Tests the neighbours w[1]-w[4] and w[6]-w[9] against w[5] and returns
+   one bit for each one that differs, in this order. The Y, U and V fields
+   are one byte each, so all eight tests can be done in two vectors. */
+static inline int yuv_pattern(const uint32_t *w)
+{
+    const uint32_t yuv1 = rgb_to_yuv(w[5]);
+#define YUV(k) (w[k] == w[5] ? yuv1 : rgb_to_yuv(w[k]))
+#if defined(HQX_SSE2)
+    const __m128i center = _mm_set1_epi32((int)yuv1);
+    const __m128i thresh = _mm_set1_epi32(trY | trU | trV);
+    __m128i a = _mm_setr_epi32((int)YUV(1), (int)YUV(2), (int)YUV(3), (int)YUV(4));
+    __m128i b = _mm_setr_epi32((int)YUV(6), (int)YUV(7), (int)YUV(8), (int)YUV(9));
+    a = _mm_subs_epu8(_mm_or_si128(_mm_subs_epu8(a, center), _mm_subs_epu8(center, a)), thresh);
+    b = _mm_subs_epu8(_mm_or_si128(_mm_subs_epu8(b, center), _mm_subs_epu8(center, b)), thresh);
+    a = _mm_cmpeq_epi32(a, _mm_setzero_si128());
+    b = _mm_cmpeq_epi32(b, _mm_setzero_si128());
+    const int same = _mm_movemask_ps(_mm_castsi128_ps(a)) | (_mm_movemask_ps(_mm_castsi128_ps(b)) << 4);
+    return same ^ 0xff;
+#elif defined(HQX_NEON)
+    static const uint32_t bits[2][4] = { { 1, 2, 4, 8 }, { 16, 32, 64, 128 } };
+    const uint32_t lo[4] = { YUV(1), YUV(2), YUV(3), YUV(4) };
+    const uint32_t hi[4] = { YUV(6), YUV(7), YUV(8), YUV(9) };
+    const uint8x16_t center = vreinterpretq_u8_u32(vdupq_n_u32(yuv1));
+    const uint8x16_t thresh = vreinterpretq_u8_u32(vdupq_n_u32(trY | trU | trV));
+    uint32x4_t a = vreinterpretq_u32_u8(vqsubq_u8(vabdq_u8(vreinterpretq_u8_u32(vld1q_u32(lo)), center), thresh));
+    uint32x4_t b = vreinterpretq_u32_u8(vqsubq_u8(vabdq_u8(vreinterpretq_u8_u32(vld1q_u32(hi)), center), thresh));
+    a = vandq_u32(vtstq_u32(a, a), vld1q_u32(bits[0]));
+    b = vandq_u32(vtstq_u32(b, b), vld1q_u32(bits[1]));
+    return (int)vaddvq_u32(vorrq_u32(a, b));
+#else
+    int pattern = 0;
+    int flag = 1;
+    for (int k = 1; k <= 9; k++)
+    {
+        if (k == 5) continue;
+        if (w[k] != w[5] && yuv_diff(yuv1, rgb_to_yuv(w[k])))
+            pattern |= flag;
+        flag <<= 1;
+    }
+    return pattern;
+#endif
+#undef YUV
+}
+
 /* Interpolate functions */
 static inline uint32_t Interpolate_2(uint32_t c1, int w1, uint32_t c2, int w2, int s)
 {
@@ -170,6 +170,7 @@ FModelVertexBuffer::FModelVertexBuffer(bool needindex, bool singleframe)
 {
 	vbo_ptr = nullptr;
 	ibo_id = 0;
+	mIndexFrame[0] = mIndexFrame[1] = -1;
 	if (needindex)
 	{
 		glGenBuffers(1, &ibo_id);	// The index buffer can always be a real buffer.
@@ -184,6 +185,8 @@ FModelVertexBuffer::FModelVertexBuffer(bool needindex, bool singleframe)
 
 void FModelVertexBuffer::BindVBO()
 {
+	// Other buffers set their own attribute pointers, so they must be set up again.
+	mIndexFrame[0] = mIndexFrame[1] = -1;
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_id);
 	glBindBuffer(GL_ARRAY_BUFFER, vbo_id);
 	if (!gl.legacyMode)
@@ -310,9 +313,15 @@ static TArray<FModelVertex> iBuffer;
 
 void FModelVertexBuffer::SetupFrame(FModelRenderer *renderer, unsigned int frame1, unsigned int frame2, unsigned int size)
 {
-	glBindBuffer(GL_ARRAY_BUFFER, vbo_id);
 	if (vbo_id > 0)
 	{
+		// Consecutive draws of the same model frame, like a group of identical
+		// monsters, can keep the pointers of the previous one.
+		if (mIndexFrame[0] == (int)frame1 && mIndexFrame[1] == (int)frame2) return;
+		mIndexFrame[0] = frame1;
+		mIndexFrame[1] = frame2;
+
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_id);
 		if (!gl.legacyMode)
 		{
 			glVertexAttribPointer(VATTR_VERTEX, 3, GL_FLOAT, false, sizeof(FModelVertex), &VMO[frame1].x);
@@ -329,12 +338,14 @@ void FModelVertexBuffer::SetupFrame(FModelRenderer *renderer, unsigned int frame
 	}
 	else if (frame1 == frame2 || size == 0 || gl_RenderState.GetInterpolationFactor() == 0.f)
 	{
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
 		glVertexPointer(3, GL_FLOAT, sizeof(FModelVertex), &vbo_ptr[frame1].x);
 		glTexCoordPointer(2, GL_FLOAT, sizeof(FModelVertex), &vbo_ptr[frame1].u);
 	}
 	else
 	{
 		// must interpolate
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
 		iBuffer.Resize(size);
 		glVertexPointer(3, GL_FLOAT, sizeof(FModelVertex), &iBuffer[0].x);
 		glTexCoordPointer(2, GL_FLOAT, sizeof(FModelVertex), &vbo_ptr[frame1].u);
@@ -34,6 +34,7 @@
 #include "gl/renderer/gl_lightdata.h"
 #include "gl/scene/gl_drawinfo.h"
 #include "gl/textures/gl_translate.h"
+#include "gl/system/gl_debug.h"
 #include "vectors.h"
 
 //==========================================================================
@@ -47,9 +48,33 @@ int F2DDrawer::AddData(const F2DDrawer::DataGeneric *data)
 	int addr = mData.Reserve(data->mLen);
 	memcpy(&mData[addr], data, data->mLen);
 	mLastLineCmd = -1;
+	mLastTextureCmd = -1;
+	mLastPolyCmd = -1;
 	return addr;
 }
 
+//==========================================================================
+//
+// Two textured quads can go into one draw call if the second one needs
+// no state change. Quads from the same atlas page count as the same
+// texture, which is what lets a line of text be drawn at once.
+//
+//==========================================================================
+
+bool F2DDrawer::DataTexture::CanBatch(const DataTexture &other) const
+{
+	if (mColorOverlay != 0 || other.mColorOverlay != 0) return false;
+	if (mAtlasPage >= 0 || other.mAtlasPage >= 0)
+	{
+		if (mAtlasPage != other.mAtlasPage) return false;
+	}
+	else if (mTexture != other.mTexture || mTranslation != other.mTranslation) return false;
+
+	return mClampMode == other.mClampMode && mRenderStyle == other.mRenderStyle &&
+		mMasked == other.mMasked && mAlphaTexture == other.mAlphaTexture &&
+		!memcmp(mScissor, other.mScissor, sizeof(mScissor));
+}
+
 //==========================================================================
 //
 // Draws a texture
@@ -88,6 +113,8 @@ void F2DDrawer::AddTexture(FTexture *img, DrawParms &parms)
 	dg.mVertIndex = (int)mVertices.Reserve(parms.colorOverlay == 0? 4 : 8);
 	dg.mColorOverlay = parms.colorOverlay;
 	dg.mTranslation = 0;
+	dg.mClampMode = CLAMP_XY_NOMIP;
+	dg.mAtlasPage = -1;
 
 	if (!img->bHasCanvas)
 	{
@@ -105,7 +132,6 @@ void F2DDrawer::AddTexture(FTexture *img, DrawParms &parms)
 		v1 = parms.srcy;
 		u2 = parms.srcx + parms.srcwidth;
 		v2 = parms.srcy + parms.srcheight;
-
 	}
 	else
 	{
@@ -132,6 +158,18 @@ void F2DDrawer::AddTexture(FTexture *img, DrawParms &parms)
 		u2 = float(u2 - (parms.texwidth - wi) / parms.texwidth);
 	}
 
+	if (!img->bHasCanvas)
+	{
+		const FAtlasEntry *atlas = gltex->UseAtlas(dg.mTranslation, -1, true);
+		if (atlas != nullptr)
+		{
+			dg.mClampMode = CLAMP_ATLAS_NOMIP;
+			dg.mAtlasPage = atlas->Page;
+			atlas->Map(u1, v1);
+			atlas->Map(u2, v2);
+		}
+	}
+
 	PalEntry color;
 	if (parms.style.Flags & STYLEF_ColorIsFixed)
 	{
@@ -166,7 +204,18 @@ void F2DDrawer::AddTexture(FTexture *img, DrawParms &parms)
 		ptr->Set(x + w, y + h, 0, u2, v2, color); ptr++;
 		dg.mVertCount = 8;
 	}
-	AddData(&dg);
+
+	// Test if we can batch this with the previous texture command
+	if (mLastTextureCmd != -1)
+	{
+		DataTexture *last = (DataTexture *)&mData[mLastTextureCmd];
+		if (last->CanBatch(dg))
+		{
+			last->mVertCount += 4;
+			return;
+		}
+	}
+	mLastTextureCmd = AddData(&dg);
 }
 
 
@@ -193,8 +242,8 @@ void F2DDrawer::AddPoly(FTexture *texture, FVector2 *points, int npoints,
 	poly.mTexture = gltexture;
 	poly.mColormap = colormap;
 	poly.mLightLevel = lightlevel;
-	poly.mVertCount = npoints;
-	poly.mVertIndex = (int)mVertices.Reserve(npoints);
+	poly.mVertCount = (npoints - 2) * 3;
+	poly.mVertIndex = (int)mVertices.Reserve(poly.mVertCount);
 	poly.mFlatColor = flatcolor;
 
 	bool dorotate = rotation != 0;
@@ -211,6 +260,8 @@ void F2DDrawer::AddPoly(FTexture *texture, FVector2 *points, int npoints,
 	float ox = float(originx);
 	float oy = float(originy);
 
+	FSimpleVertex first, last;
+	FSimpleVertex *ptr = &mVertices[poly.mVertIndex];
 	for (int i = 0; i < npoints; ++i)
 	{
 		float u = points[i].X - 0.5f - ox;
@@ -221,9 +272,31 @@ void F2DDrawer::AddPoly(FTexture *texture, FVector2 *points, int npoints,
 			u = t * cosrot - v * sinrot;
 			v = v * cosrot + t * sinrot;
 		}
-		mVertices[poly.mVertIndex+i].Set(points[i].X, points[i].Y, 0, u*uscale, v*vscale);
+		FSimpleVertex vert;
+		vert.Set(points[i].X, points[i].Y, 0, u*uscale, v*vscale);
+
+		// Split the fan into triangles so that consecutive polygons can be drawn at once.
+		if (i == 0) first = vert;
+		else if (i >= 2)
+		{
+			*ptr++ = first;
+			*ptr++ = last;
+			*ptr++ = vert;
+		}
+		last = vert;
+	}
+
+	// Test if we can batch this with the previous polygon
+	if (mLastPolyCmd != -1)
+	{
+		DataSimplePoly *prev = (DataSimplePoly *)&mData[mLastPolyCmd];
+		if (prev->CanBatch(poly))
+		{
+			prev->mVertCount += poly.mVertCount;
+			return;
+		}
 	}
-	AddData(&poly);
+	mLastPolyCmd = AddData(&poly);
 }
 
 //===========================================================================
@@ -365,6 +438,78 @@ void F2DDrawer::AddPixel(int x1, int y1, int palcolor, uint32_t color)
 }
 
 
+//==========================================================================
+//
+// Plays back the kept commands if they were recorded with the same key
+// and none of the materials they reference went away since. Otherwise
+// starts recording the commands that follow.
+//
+//==========================================================================
+
+bool F2DDrawer::BeginRetained(int layer, uint64_t key)
+{
+	// Nothing may be merged into a command from outside the recorded range.
+	mLastLineCmd = -1;
+	mLastTextureCmd = -1;
+	mLastPolyCmd = -1;
+
+	auto &kept = mRetained[layer];
+	if (kept.Valid && kept.Key == key && kept.Generation == FMaterial::Generation)
+	{
+		int vertbase = mVertices.Reserve(kept.Vertices.Size());
+		if (kept.Vertices.Size() > 0)
+			memcpy(&mVertices[vertbase], &kept.Vertices[0], kept.Vertices.Size() * sizeof(FSimpleVertex));
+
+		unsigned database = mData.Reserve(kept.Data.Size());
+		if (kept.Data.Size() > 0)
+			memcpy(&mData[database], &kept.Data[0], kept.Data.Size());
+		for (unsigned i = database; i < mData.Size();)
+		{
+			DataGeneric *dg = (DataGeneric *)&mData[i];
+			dg->mVertIndex += vertbase;
+			i += dg->mLen;
+		}
+		return true;
+	}
+	mRecordData = mData.Size();
+	mRecordVertex = mVertices.Size();
+	mRecordKey = key;
+	mRecordLayer = layer;
+	return false;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void F2DDrawer::EndRetained()
+{
+	if (mRecordData < 0) return;
+
+	auto &kept = mRetained[mRecordLayer];
+	kept.Data.Resize(mData.Size() - mRecordData);
+	if (kept.Data.Size() > 0)
+		memcpy(&kept.Data[0], &mData[mRecordData], kept.Data.Size());
+	kept.Vertices.Resize(mVertices.Size() - mRecordVertex);
+	if (kept.Vertices.Size() > 0)
+		memcpy(&kept.Vertices[0], &mVertices[mRecordVertex], kept.Vertices.Size() * sizeof(FSimpleVertex));
+	for (unsigned i = 0; i < kept.Data.Size();)
+	{
+		DataGeneric *dg = (DataGeneric *)&kept.Data[i];
+		dg->mVertIndex -= mRecordVertex;
+		i += dg->mLen;
+	}
+	kept.Key = mRecordKey;
+	kept.Generation = FMaterial::Generation;
+	kept.Valid = true;
+	mRecordData = -1;
+	mLastLineCmd = -1;
+	mLastTextureCmd = -1;
+	mLastPolyCmd = -1;
+}
+
 //==========================================================================
 //
 //
@@ -376,6 +521,7 @@ void F2DDrawer::Draw()
 	F2DDrawer::EDrawType lasttype = DrawTypeTexture;
 
 	if (mData.Size() == 0) return;
+	FGLDebug::PushGroup("2D");
 	int8_t savedlightmode = glset.lightmode;
 	// lightmode is only relevant for automap subsectors,
 	// but We cannot use the software light mode here because it doesn't properly calculate the light for 2D rendering.
@@ -407,7 +553,7 @@ void F2DDrawer::Draw()
 			DataTexture *dt = static_cast<DataTexture*>(dg);
 
 			gl_SetRenderStyle(dt->mRenderStyle, !dt->mMasked, false);
-			gl_RenderState.SetMaterial(dt->mTexture, CLAMP_XY_NOMIP, dt->mTranslation, -1, dt->mAlphaTexture);
+			gl_RenderState.SetMaterial(dt->mTexture, dt->mClampMode, dt->mTranslation, -1, dt->mAlphaTexture);
 
 			glEnable(GL_SCISSOR_TEST);
 			glScissor(dt->mScissor[0], dt->mScissor[1], dt->mScissor[2], dt->mScissor[3]);
@@ -415,10 +561,26 @@ void F2DDrawer::Draw()
 			gl_RenderState.AlphaFunc(GL_GEQUAL, 0.f);
 			gl_RenderState.Apply();
 
-			glDrawArrays(GL_TRIANGLE_STRIP, dt->mVertIndex, 4);
+			if (dt->mColorOverlay != 0 || dt->mVertCount == 4)
+			{
+				glDrawArrays(GL_TRIANGLE_STRIP, dt->mVertIndex, 4);
+			}
+			else
+			{
+				// a batch of separate quads with consecutive vertices
+				unsigned count = dt->mVertCount / 4;
+				mBatchFirst.Resize(count);
+				mBatchCount.Resize(count);
+				for (unsigned q = 0; q < count; q++)
+				{
+					mBatchFirst[q] = dt->mVertIndex + q * 4;
+					mBatchCount[q] = 4;
+				}
+				glMultiDrawArrays(GL_TRIANGLE_STRIP, &mBatchFirst[0], &mBatchCount[0], count);
+			}
 
 			gl_RenderState.BlendEquation(GL_FUNC_ADD);
-			if (dt->mVertCount > 4)
+			if (dt->mColorOverlay != 0)
 			{
 				gl_RenderState.SetTextureMode(TM_MASK);
 				gl_RenderState.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -442,7 +604,7 @@ void F2DDrawer::Draw()
 			gl_RenderState.SetMaterial(dsp->mTexture, CLAMP_NONE, 0, -1, false);
 			gl_RenderState.SetObjectColor(dsp->mFlatColor|0xff000000);
 			gl_RenderState.Apply();
-			glDrawArrays(GL_TRIANGLE_FAN, dsp->mVertIndex, dsp->mVertCount);
+			glDrawArrays(GL_TRIANGLES, dsp->mVertIndex, dsp->mVertCount);
 			gl_RenderState.SetObjectColor(0xffffffff);
 			break;
 		}
@@ -484,6 +646,7 @@ void F2DDrawer::Draw()
 	}
 	gl_RenderState.SetVertexBuffer(GLRenderer->mVBO);
 	glset.lightmode = savedlightmode;
+	FGLDebug::PopGroup();
 }
 
 void F2DDrawer::Clear()
@@ -491,4 +654,7 @@ void F2DDrawer::Clear()
 	mVertices.Clear();
 	mData.Clear();
 	mLastLineCmd = -1;
+	mLastTextureCmd = -1;
+	mLastPolyCmd = -1;
+	mRecordData = -1;	// an unfinished recording can't be kept
 }
@@ -2,6 +2,7 @@
 #define __2DDRAWER_H
 
 #include "tarray.h"
+#include "v_video.h"
 #include "gl/data/gl_vertexbuffer.h"
 
 class F2DDrawer : public FSimpleVertexBuffer
@@ -30,9 +31,13 @@ class F2DDrawer : public FSimpleVertexBuffer
 		int mScissor[4];
 		uint32_t mColorOverlay;
 		int mTranslation;
+		int mClampMode;
+		int mAtlasPage;	// -1 if not drawn from the atlas
 		FRenderStyle mRenderStyle;
 		bool mMasked;
 		bool mAlphaTexture;
+
+		bool CanBatch(const DataTexture &other) const;
 	};
 	
 	struct DataFlatFill : public DataGeneric
@@ -46,11 +51,36 @@ class F2DDrawer : public FSimpleVertexBuffer
 		int mLightLevel;
 		FColormap mColormap;
 		PalEntry mFlatColor;
+
+		bool CanBatch(const DataSimplePoly &other) const
+		{
+			return mTexture == other.mTexture && mLightLevel == other.mLightLevel &&
+				mColormap == other.mColormap && mFlatColor == other.mFlatColor;
+		}
 	};
 
 	TArray<FSimpleVertex> mVertices;
 	TArray<uint8_t> mData;
 	int mLastLineCmd = -1;	// consecutive lines can be batched into a single draw call so keep this info around.
+	int mLastTextureCmd = -1;	// the same for textures that share their state
+	int mLastPolyCmd = -1;		// and for polygons, which are stored as triangles for this
+	TArray<GLint> mBatchFirst;
+	TArray<GLsizei> mBatchCount;
+
+	// Kept commands for retained drawing, one set per layer. Their vertex indices are relative to Vertices.
+	struct FRetained
+	{
+		TArray<FSimpleVertex> Vertices;
+		TArray<uint8_t> Data;
+		uint64_t Key = 0;
+		unsigned int Generation = 0;
+		bool Valid = false;
+	};
+	FRetained mRetained[NUM_RETAINED2D];
+	int mRecordData = -1;	// start of the commands being recorded
+	int mRecordVertex = 0;
+	int mRecordLayer = 0;
+	uint64_t mRecordKey = 0;
 	
 	int AddData(const DataGeneric *data);
 	
@@ -67,6 +97,9 @@ public:
 	void AddLine(int x1, int y1, int x2, int y2, int palcolor, uint32_t color, uint8_t alpha = 255);
 	void AddPixel(int x1, int y1, int palcolor, uint32_t color);
 		
+	bool BeginRetained(int layer, uint64_t key);
+	void EndRetained();
+
 	void Draw();
 	void Clear();
 };
@@ -59,12 +59,14 @@
 #include "gl/shaders/gl_colormapshader.h"
 #include "gl/shaders/gl_lensshader.h"
 #include "gl/shaders/gl_fxaashader.h"
+#include "gl/shaders/gl_sharpenshader.h"
 #include "gl/shaders/gl_presentshader.h"
 #include "gl/shaders/gl_postprocessshader.h"
 #include "gl/shaders/gl_postprocessshaderinstance.h"
 #include "gl/renderer/gl_2ddrawer.h"
 #include "gl/stereo3d/gl_stereo3d.h"
 #include "r_videoscale.h"
+#include "i_time.h"
 
 extern bool vid_hdr_active;
 
@@ -96,6 +98,8 @@ CUSTOM_CVAR(Int, gl_bloom_kernel_size, 7, CVAR_ARCHIVE)
 		self = 7;
 }
 
+CVAR(Bool, gl_fusepasses, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
 CVAR(Bool, gl_lens, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
 
 CVAR(Float, gl_lens_k, -0.12f, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
@@ -157,6 +161,28 @@ EXTERN_CVAR(Int, gl_satformula)
 
 CVAR(Int, gl_dither_bpc, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG | CVAR_NOINITCALL)
 
+// Lowers the 3D scene's render resolution when the GPU can't keep up
+CVAR(Bool, gl_dynres, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+CUSTOM_CVAR(Int, gl_dynres_fps, 60, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+{
+	if (self < 10) self = 10;
+}
+
+CUSTOM_CVAR(Float, gl_dynres_min, 0.5f, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+{
+	if (self < 0.25f) self = 0.25f;
+	else if (self > 1.0f) self = 1.0f;
+}
+
+CUSTOM_CVAR(Float, gl_dynres_sharpen, 0.5f, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+{
+	if (self < 0.0f) self = 0.0f;
+	else if (self > 1.0f) self = 1.0f;
+}
+
+EXTERN_CVAR(Bool, vid_governor)
+
 void FGLRenderer::RenderScreenQuad()
 {
 	mVBO->BindVBO();
@@ -171,13 +197,169 @@ void FGLRenderer::PostProcessScene(int fixedcm, const std::function<void()> &aft
 	mCustomPostProcessShaders->Run("beforebloom");
 	BloomScene(fixedcm);
 	afterBloomDrawEndScene2D();
-	TonemapScene();
+	// If both the tonemap and colormap passes are active they are done in a single pass.
+	if (TonemapScene(gl_fusepasses ? fixedcm : CM_DEFAULT)) fixedcm = CM_DEFAULT;
 	ColormapScene(fixedcm);
 	LensDistortScene();
 	ApplyFXAA();
 	mCustomPostProcessShaders->Run("scene");
 }
 
+//-----------------------------------------------------------------------------
+//
+// Picks the render scale for the next frame from the GPU time the scene
+// took a few frames ago. The timestamps are only read once they are
+// available so this never stalls. Without timer queries the frame time
+// is used instead.
+//
+//-----------------------------------------------------------------------------
+
+void FGLRenderer::UpdateDynamicResolution()
+{
+	double now = I_msTimeF();
+	double frametime = now - mDynResLastFrame;
+	mDynResLastFrame = now;
+
+	bool hasTimers = glQueryCounter != nullptr && glGetQueryObjectui64v != nullptr;
+	double sample = -1;
+	if (hasTimers)
+	{
+		for (auto &timer : mDynResTimers)
+		{
+			if (!timer.Pending) continue;
+
+			GLuint available = 0;
+			glGetQueryObjectuiv(timer.Ids[1], GL_QUERY_RESULT_AVAILABLE, &available);
+			if (!available) continue;
+
+			GLuint64 start = 0, end = 0;
+			glGetQueryObjectui64v(timer.Ids[0], GL_QUERY_RESULT, &start);
+			glGetQueryObjectui64v(timer.Ids[1], GL_QUERY_RESULT, &end);
+			if (end > start) sample = MAX(sample, (end - start) / 1000000.0);
+			timer.Pending = false;
+		}
+	}
+	else if (frametime < 250)	// ignore hitches from loading and pausing
+	{
+		sample = frametime;
+	}
+
+	if (sample >= 0)
+	{
+		mDynResSceneTime = mDynResSceneTime > 0 ? mDynResSceneTime * 0.8 + sample * 0.2 : sample;
+
+		// The scene's cost grows with the pixel count, i.e. the square of the scale.
+		// Leave some of the frame for the post processing and the 2D parts.
+		double budget = 1000.0 / gl_dynres_fps * (hasTimers ? 0.85 : 1.0);
+		double wanted = mDynResScale * sqrt(budget / MAX(mDynResSceneTime, 0.01));
+
+		// Drop quickly when over budget but climb back slowly so the resolution doesn't pump.
+		double speed = wanted < mDynResScale ? 0.25 : 0.05;
+		mDynResScale = (float)clamp(mDynResScale + (wanted - mDynResScale) * speed, (double)gl_dynres_min, 1.0);
+	}
+
+	mDynResRecording = -1;
+	if (hasTimers && !mDynResTimers[mDynResTimerIndex].Pending)
+	{
+		auto &timer = mDynResTimers[mDynResTimerIndex];
+		if (timer.Ids[0] == 0) glGenQueries(2, timer.Ids);
+		mDynResRecording = mDynResTimerIndex;
+	}
+}
+
+//-----------------------------------------------------------------------------
+//
+// Shrinks the scene viewport for the 3D parts of the main view
+//
+//-----------------------------------------------------------------------------
+
+void FGLRenderer::BeginDynamicResolution()
+{
+	mDynResActive = false;
+
+	// The governor changes the resolution in coarse steps itself
+	if (!gl_dynres || vid_governor)
+	{
+		mDynResScale = 1.0f;
+		mDynResSceneTime = 0;
+		return;
+	}
+
+	UpdateDynamicResolution();
+	if (mDynResRecording >= 0)
+		glQueryCounter(mDynResTimers[mDynResRecording].Ids[0], GL_TIMESTAMP);
+
+	int width = MAX((int)round(mSceneViewport.width * mDynResScale), 1);
+	int height = MAX((int)round(mSceneViewport.height * mDynResScale), 1);
+	if (width >= mSceneViewport.width && height >= mSceneViewport.height)
+		return;
+
+	mDynResViewport = mSceneViewport;
+	mSceneViewport.width = width;
+	mSceneViewport.height = height;
+	glViewport(mSceneViewport.left, mSceneViewport.top, mSceneViewport.width, mSceneViewport.height);
+	glScissor(mSceneViewport.left, mSceneViewport.top, mSceneViewport.width, mSceneViewport.height);
+	mDynResActive = true;
+}
+
+//-----------------------------------------------------------------------------
+//
+// Stretches the scene back over the full scene viewport and sharpens it.
+// Player sprites, the HUD and everything else 2D are drawn after this at
+// the native resolution.
+//
+//-----------------------------------------------------------------------------
+
+void FGLRenderer::EndDynamicResolution()
+{
+	if (mDynResRecording >= 0)
+	{
+		auto &timer = mDynResTimers[mDynResRecording];
+		glQueryCounter(timer.Ids[1], GL_TIMESTAMP);
+		timer.Pending = true;
+		mDynResTimerIndex = (mDynResTimerIndex + 1) % DynResTimerFrames;
+		mDynResRecording = -1;
+	}
+
+	if (!mDynResActive)
+		return;
+
+	FGLDebug::PushGroup("UpscaleScene");
+
+	const GL_IRECT scaled = mSceneViewport;
+	mSceneViewport = mDynResViewport;
+	mDynResActive = false;
+
+	gl_RenderState.EnableDrawBuffers(1);
+	{
+		FGLPostProcessState savedState;
+		glDisable(GL_STENCIL_TEST);
+
+		mBuffers->UpscaleSceneToTexture(scaled.left, scaled.top, scaled.width, scaled.height, mSceneViewport.width, mSceneViewport.height);
+
+		mBuffers->BindSceneFB(false);
+		glViewport(mSceneViewport.left, mSceneViewport.top, mSceneViewport.width, mSceneViewport.height);
+		mBuffers->BindCurrentTexture(0);
+		mSharpenShader->Bind();
+		mSharpenShader->InputTexture.Set(0);
+		mSharpenShader->Scale.Set(mSceneViewport.width / (float)mScreenViewport.width, mSceneViewport.height / (float)mScreenViewport.height);
+		mSharpenShader->Offset.Set(mSceneViewport.left / (float)mScreenViewport.width, mSceneViewport.top / (float)mScreenViewport.height);
+		mSharpenShader->InvSize.Set(1.0f / mBuffers->GetWidth(), 1.0f / mBuffers->GetHeight());
+		// Sharpen more the further the scene was stretched
+		float stretch = mSceneViewport.width / (float)scaled.width;
+		mSharpenShader->Sharpness.Set(gl_dynres_sharpen * MIN(stretch - 1.0f, 1.0f));
+		RenderScreenQuad();
+
+		glEnable(GL_STENCIL_TEST);
+	}
+	glScissor(mSceneViewport.left, mSceneViewport.top, mSceneViewport.width, mSceneViewport.height);
+	gl_RenderState.EnableDrawBuffers(gl_RenderState.GetPassDrawBufferCount());
+	gl_RenderState.Apply();
+	gl_RenderState.ApplyMatrices();
+
+	FGLDebug::PopGroup();
+}
+
 //-----------------------------------------------------------------------------
 //
 // Adds ambient occlusion to the scene
@@ -563,10 +745,12 @@ void FGLRenderer::BlurScene(float gameinfobluramount)
 //
 //-----------------------------------------------------------------------------
 
-void FGLRenderer::TonemapScene()
+bool FGLRenderer::TonemapScene(int fixedcm)
 {
 	if (gl_tonemap == 0)
-		return;
+		return false;
+
+	bool colormap = fixedcm >= CM_FIRSTSPECIALCOLORMAP && fixedcm < CM_MAXCOLORMAP;
 
 	FGLDebug::PushGroup("TonemapScene");
 
@@ -577,9 +761,14 @@ void FGLRenderer::TonemapScene()
 
 	mBuffers->BindNextFB();
 	mBuffers->BindCurrentTexture(0);
-	mTonemapShader->Bind();
+	mTonemapShader->Bind(colormap);
 	mTonemapShader->SceneTexture.Set(0);
 
+	if (colormap)
+	{
+		SetColormapUniforms(mTonemapShader->MapStart, mTonemapShader->MapRange, fixedcm);
+	}
+
 	if (mTonemapShader->IsPaletteMode())
 	{
 		glActiveTexture(GL_TEXTURE1);
@@ -605,6 +794,7 @@ void FGLRenderer::TonemapScene()
 	mBuffers->NextTexture();
 
 	FGLDebug::PopGroup();
+	return colormap;
 }
 
 void FGLRenderer::CreateTonemapPalette()
@@ -643,6 +833,22 @@ void FGLRenderer::ClearTonemapPalette()
 	}
 }
 
+//-----------------------------------------------------------------------------
+//
+// Uniforms for a special colormap, for the colormap pass or the tonemap pass it is fused into
+//
+//-----------------------------------------------------------------------------
+
+void FGLRenderer::SetColormapUniforms(FUniform4f &start, FUniform4f &range, int fixedcm)
+{
+	FSpecialColormap *scm = &SpecialColormaps[fixedcm - CM_FIRSTSPECIALCOLORMAP];
+	float m[] = { scm->ColorizeEnd[0] - scm->ColorizeStart[0],
+		scm->ColorizeEnd[1] - scm->ColorizeStart[1], scm->ColorizeEnd[2] - scm->ColorizeStart[2], 0.f };
+
+	start.Set(scm->ColorizeStart[0], scm->ColorizeStart[1], scm->ColorizeStart[2], 0.f);
+	range.Set(m);
+}
+
 //-----------------------------------------------------------------------------
 //
 // Colormap scene texture and place the result in the HUD/2D texture
@@ -662,12 +868,7 @@ void FGLRenderer::ColormapScene(int fixedcm)
 	mBuffers->BindCurrentTexture(0);
 	mColormapShader->Bind();
 	
-	FSpecialColormap *scm = &SpecialColormaps[fixedcm - CM_FIRSTSPECIALCOLORMAP];
-	float m[] = { scm->ColorizeEnd[0] - scm->ColorizeStart[0],
-		scm->ColorizeEnd[1] - scm->ColorizeStart[1], scm->ColorizeEnd[2] - scm->ColorizeStart[2], 0.f };
-
-	mColormapShader->MapStart.Set(scm->ColorizeStart[0], scm->ColorizeStart[1], scm->ColorizeStart[2], 0.f);
-	mColormapShader->MapRange.Set(m);
+	SetColormapUniforms(mColormapShader->MapStart, mColormapShader->MapRange, fixedcm);
 
 	RenderScreenQuad();
 	mBuffers->NextTexture();
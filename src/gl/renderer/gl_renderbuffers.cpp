@@ -703,6 +703,34 @@ void FGLRenderBuffers::BlitSceneToTexture()
 	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
 }
 
+//==========================================================================
+//
+// Stretches the part of the scene that was rendered at a lower resolution
+// over the full scene area of the next pipeline texture.
+//
+// Multisampled buffers can't be resolved and scaled in one blit, so they
+// are resolved into the first pipeline texture first.
+//
+//==========================================================================
+
+void FGLRenderBuffers::UpscaleSceneToTexture(int left, int top, int srcWidth, int srcHeight, int dstWidth, int dstHeight)
+{
+	if (mSamples > 1)
+	{
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, mSceneFB);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, mPipelineFB[0]);
+		glBlitFramebuffer(left, top, left + srcWidth, top + srcHeight, left, top, left + srcWidth, top + srcHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	}
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, mPipelineFB[0]);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, mPipelineFB[1]);
+	glBlitFramebuffer(left, top, left + srcWidth, top + srcHeight, left, top, left + dstWidth, top + dstHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+	mCurrentPipelineTexture = 1;
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+}
+
 //==========================================================================
 //
 // Eye textures and their frame buffers
@@ -793,6 +821,8 @@ void FGLRenderBuffers::ClearShadowMap()
 	mCurrentShadowMapSize = 0;
 }
 
+unsigned int FGLRenderBuffers::ShadowMapGeneration;
+
 void FGLRenderBuffers::CreateShadowMap()
 {
 	if (mShadowMapTexture != 0 && gl_shadowmap_quality == mCurrentShadowMapSize)
@@ -819,6 +849,7 @@ void FGLRenderBuffers::CreateShadowMap()
 	glBindFramebuffer(GL_FRAMEBUFFER, frameBufferBinding);
 
 	mCurrentShadowMapSize = gl_shadowmap_quality;
+	ShadowMapGeneration++;
 }
 
 //==========================================================================
@@ -925,6 +956,13 @@ void FGLRenderBuffers::BindNextFB()
 {
 	int out = (mCurrentPipelineTexture + 1) % NumPipelineTextures;
 	glBindFramebuffer(GL_FRAMEBUFFER, mPipelineFB[out]);
+
+	// The pass that follows replaces the old contents completely.
+	if ((gl.flags & RFL_INVALIDATE_BUFFER) != 0)
+	{
+		GLenum attachment = GL_COLOR_ATTACHMENT0;
+		glInvalidateFramebuffer(GL_FRAMEBUFFER, 1, &attachment);
+	}
 }
 
 //==========================================================================
@@ -37,6 +37,7 @@ public:
 	void BindSceneNormalTexture(int index);
 	void BindSceneDepthTexture(int index);
 	void BlitSceneToTexture();
+	void UpscaleSceneToTexture(int left, int top, int srcWidth, int srcHeight, int dstWidth, int dstHeight);
 
 	void BindCurrentTexture(int index);
 	void BindCurrentFB();
@@ -55,6 +56,7 @@ public:
 
 	void BindShadowMapFB();
 	void BindShadowMapTexture(int index);
+	static unsigned int GetShadowMapGeneration() { return ShadowMapGeneration; }
 
 	enum { NumBloomLevels = 4 };
 	FGLBloomTextureLevel BloomLevels[NumBloomLevels];
@@ -146,6 +148,7 @@ private:
 	GLuint mShadowMapTexture = 0;
 	GLuint mShadowMapFB = 0;
 	int mCurrentShadowMapSize = 0;
+	static unsigned int ShadowMapGeneration;	// changes whenever the shadow map contents are lost
 
 	GLuint mDitherTexture = 0;
 
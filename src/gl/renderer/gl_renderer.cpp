@@ -59,6 +59,7 @@
 #include "gl/shaders/gl_colormapshader.h"
 #include "gl/shaders/gl_lensshader.h"
 #include "gl/shaders/gl_fxaashader.h"
+#include "gl/shaders/gl_sharpenshader.h"
 #include "gl/shaders/gl_presentshader.h"
 #include "gl/shaders/gl_present3dRowshader.h"
 #include "gl/shaders/gl_shadowmapshader.h"
@@ -128,6 +129,7 @@ FGLRenderer::FGLRenderer(OpenGLFrameBuffer *fb)
 	mSSAOShader = nullptr;
 	mSSAOCombineShader = nullptr;
 	mFXAAShader = nullptr;
+	mSharpenShader = nullptr;
 	mFXAALumaShader = nullptr;
 	mShadowMapShader = nullptr;
 	mCustomPostProcessShaders = nullptr;
@@ -151,6 +153,7 @@ void FGLRenderer::Initialize(int width, int height)
 	mTonemapPalette = nullptr;
 	mLensShader = new FLensShader();
 	mFXAAShader = new FFXAAShader;
+	mSharpenShader = new FSharpenShader;
 	mFXAALumaShader = new FFXAALumaShader;
 	mPresentShader = new FPresentShader();
 	mPresent3dCheckerShader = new FPresent3DCheckerShader();
@@ -228,6 +231,11 @@ FGLRenderer::~FGLRenderer()
 	delete mCustomPostProcessShaders;
 	delete mFXAAShader;
 	delete mFXAALumaShader;
+	delete mSharpenShader;
+	for (auto &timer : mDynResTimers)
+	{
+		if (timer.Ids[0] != 0) glDeleteQueries(2, timer.Ids);
+	}
 }
 
 
@@ -21,6 +21,7 @@ class FLightBuffer;
 class FSamplerManager;
 class DPSprite;
 class FGLRenderBuffers;
+class FUniform4f;
 class FLinearDepthShader;
 class FDepthBlurShader;
 class FSSAOShader;
@@ -36,6 +37,7 @@ class FColormapShader;
 class FLensShader;
 class FFXAALumaShader;
 class FFXAAShader;
+class FSharpenShader;
 class FPresentShader;
 class FPresent3DCheckerShader;
 class FPresent3DColumnShader; 
@@ -134,6 +136,7 @@ public:
 	FLensShader *mLensShader;
 	FFXAALumaShader *mFXAALumaShader;
 	FFXAAShader *mFXAAShader;
+	FSharpenShader *mSharpenShader;
 	FPresentShader *mPresentShader;
 	FPresent3DCheckerShader *mPresent3dCheckerShader;
 	FPresent3DColumnShader *mPresent3dColumnShader;
@@ -163,6 +166,23 @@ public:
 	GL_IRECT mOutputLetterbox;
 	bool mDrawingScene2D = false;
 
+	// Dynamic resolution: the scene is drawn into a part of mSceneViewport
+	// and stretched back over it before the 2D parts of the screen are drawn.
+	enum { DynResTimerFrames = 4 };
+	struct DynResTimer
+	{
+		unsigned int Ids[2] = { 0, 0 };
+		bool Pending = false;
+	};
+	DynResTimer mDynResTimers[DynResTimerFrames];
+	int mDynResTimerIndex = 0;
+	int mDynResRecording = -1;
+	double mDynResSceneTime = 0;
+	double mDynResLastFrame = 0;
+	float mDynResScale = 1.0f;
+	bool mDynResActive = false;
+	GL_IRECT mDynResViewport;
+
 	float mSceneClearColor[3];
 
 	float mGlobVis = 0.0f;
@@ -190,12 +210,16 @@ public:
 	void AmbientOccludeScene();
 	void UpdateCameraExposure();
 	void BloomScene(int fixedcm);
-	void TonemapScene();
+	bool TonemapScene(int fixedcm);
 	void ColormapScene(int fixedcm);
+	void SetColormapUniforms(FUniform4f &start, FUniform4f &range, int fixedcm);
 	void CreateTonemapPalette();
 	void ClearTonemapPalette();
 	void LensDistortScene();
 	void ApplyFXAA();
+	void BeginDynamicResolution();
+	void EndDynamicResolution();
+	void UpdateDynamicResolution();
 	void BlurScene(float gameinfobluramount);
 	void CopyToBackbuffer(const GL_IRECT *bounds, bool applyGamma);
 	void DrawPresentTexture(const GL_IRECT &box, bool applyGamma);
@@ -56,6 +56,7 @@ TArray<VSMatrix> gl_MatrixStack;
 
 static void matrixToGL(const VSMatrix &mat, int loc)
 {
+	gl_CheckPendingDraws();
 	glUniformMatrix4fv(loc, 1, false, (float*)&mat);
 }
 
@@ -164,6 +165,13 @@ bool FRenderState::ApplyShader()
 		}
 	}
 
+	static float lastcolor[4], lastnormal[4];
+	if (memcmp(lastcolor, mColor.vec, sizeof(lastcolor)) || memcmp(lastnormal, mNormal.vec, sizeof(lastnormal)))
+	{
+		gl_CheckPendingDraws();
+		memcpy(lastcolor, mColor.vec, sizeof(lastcolor));
+		memcpy(lastnormal, mNormal.vec, sizeof(lastnormal));
+	}
 	glVertexAttrib4fv(VATTR_COLOR, mColor.vec);
 	glVertexAttrib4fv(VATTR_NORMAL, mNormal.vec);
 	//activeShader->muObjectColor2.Set(mObjectColor2);
@@ -312,10 +320,18 @@ bool FRenderState::ApplyShader()
 
 	if (mModelMatrixEnabled)
 	{
-		matrixToGL(mModelMatrix, activeShader->modelmatrix_index);
-		VSMatrix norm;
-		norm.computeNormalMatrix(mModelMatrix);
-		matrixToGL(norm, activeShader->normalmodelmatrix_index);
+		// Models apply the state once per surface with the same matrix, and the
+		// normal matrix needs an inversion, so the last matrix is kept per shader.
+		if (!activeShader->currentModelMatrixState || !activeShader->currentModelMatrixValid ||
+			memcmp(mModelMatrix.get(), activeShader->currentModelMatrix.get(), 16 * sizeof(FLOATTYPE)))
+		{
+			matrixToGL(mModelMatrix, activeShader->modelmatrix_index);
+			VSMatrix norm;
+			norm.computeNormalMatrix(mModelMatrix);
+			matrixToGL(norm, activeShader->normalmodelmatrix_index);
+			activeShader->currentModelMatrix = mModelMatrix;
+			activeShader->currentModelMatrixValid = true;
+		}
 		activeShader->currentModelMatrixState = true;
 	}
 	else if (activeShader->currentModelMatrixState)
@@ -340,12 +356,14 @@ void FRenderState::Apply()
 	{
 		if (mSrcBlend != stSrcBlend || mDstBlend != stDstBlend)
 		{
+			gl_CheckPendingDraws();
 			stSrcBlend = mSrcBlend;
 			stDstBlend = mDstBlend;
 			glBlendFunc(mSrcBlend, mDstBlend);
 		}
 		if (mBlendEquation != stBlendEquation)
 		{
+			gl_CheckPendingDraws();
 			stBlendEquation = mBlendEquation;
 			glBlendEquation(mBlendEquation);
 		}
@@ -355,6 +373,7 @@ void FRenderState::Apply()
 
 	if (mVertexBuffer != mCurrentVertexBuffer)
 	{
+		gl_CheckPendingDraws();
 		if (mVertexBuffer == NULL) glBindBuffer(GL_ARRAY_BUFFER, 0);
 		else mVertexBuffer->BindVBO();
 		mCurrentVertexBuffer = mVertexBuffer;
@@ -428,6 +447,7 @@ void FRenderState::SetClipHeight(float height, float direction)
 			glPopMatrix();
 		}
 		*/
+		gl_CheckPendingDraws();
 		glEnable(GL_CLIP_DISTANCE0);
 	}
 	else
@@ -298,6 +298,7 @@ public:
 		if (!(gl.flags & RFL_NO_CLIP_PLANES))
 		{
 			mSplitEnabled = on;
+			gl_CheckPendingDraws();
 			if (on)
 			{
 				glEnable(GL_CLIP_DISTANCE3);
@@ -321,6 +322,7 @@ public:
 		if (!(gl.flags & RFL_NO_CLIP_PLANES))
 		{
 			mClipLineEnabled = on;
+			gl_CheckPendingDraws();
 			if (on)
 			{
 				glEnable(GL_CLIP_DISTANCE0);
@@ -478,6 +480,7 @@ public:
 		}
 		else
 		{
+			gl_CheckPendingDraws();
 			glBlendFunc(src, dst);
 		}
 	}
@@ -496,6 +499,7 @@ public:
 		}
 		else
 		{
+			gl_CheckPendingDraws();
 			glBlendEquation(eq);
 		}
 	}
@@ -504,6 +508,7 @@ public:
 	bool SetDepthClamp(bool on)
 	{
 		bool res = mLastDepthClamp;
+		gl_CheckPendingDraws();
 		if (!on) glDisable(GL_DEPTH_CLAMP);
 		else glEnable(GL_DEPTH_CLAMP);
 		mLastDepthClamp = on;
@@ -536,6 +541,7 @@ public:
 		if (mNumDrawBuffers != count)
 		{
 			static GLenum buffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+			gl_CheckPendingDraws();
 			glDrawBuffers(count, buffers);
 			mNumDrawBuffers = count;
 		}
@@ -42,6 +42,9 @@
 #include "gl/scene/gl_portal.h"
 #include "gl/scene/gl_wall.h"
 #include "gl/utility/gl_clock.h"
+#include "jobs.h"
+
+#include <vector>
 
 
 EXTERN_CVAR(Float, r_actorspriteshadowdist)
@@ -51,6 +54,7 @@ EXTERN_CVAR(Bool, gl_render_segs)
 CVAR(Bool, gl_render_things, true, 0)
 CVAR(Bool, gl_render_walls, true, 0)
 CVAR(Bool, gl_render_flats, true, 0)
+CVAR(Bool, gl_threadedsprites, false, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 
 void GLSceneDrawer::UnclipSubsector(subsector_t *sub)
 {
@@ -173,7 +177,12 @@ void GLSceneDrawer::AddLine (seg_t *seg, bool portalclip)
  		else
 		{
 			// clipping checks are only needed when the backsector is not the same as the front sector
-			if (in_area == area_default) in_area = CheckViewArea(seg->v1, seg->v2, seg->frontsector, seg->backsector);
+			if (in_area == area_default)
+			{
+				// The deferred sprites need to be processed with the view area they were found with.
+				ProcessDeferredSprites();
+				in_area = CheckViewArea(seg->v1, seg->v2, seg->frontsector, seg->backsector);
+			}
 
 			backsector = gl_FakeFlat(seg->backsector, in_area, true);
 
@@ -248,6 +257,10 @@ void GLSceneDrawer::RenderPolyBSPNode (void *node)
 	{
 		node_t *bsp = (node_t *)node;
 
+		// Skip subtrees that are entirely in map sections that can't be seen from here.
+		// For skybox views this is most of the map.
+		if (!(nodemapsections[bsp->Index()] & MapSectionMask)) return;
+
 		// Decide which side the view point is on.
 		int side = R_PointOnSide(viewx, viewy, bsp);
 
@@ -397,19 +410,26 @@ void GLSceneDrawer::RenderThings(subsector_t * sub, sector_t * sector)
 			}
 		}
 
-		GLSprite sprite(this);
-
 		// [Nash] draw sprite shadow
+		bool shadow = false;
 		if (R_ShouldDrawSpriteShadow(thing))
 		{
 			double dist = (thing->Pos() - r_viewpoint.Pos).LengthSquared();
 			double check = r_actorspriteshadowdist;
-			if (dist <= check * check)
-			{
-				sprite.Process(thing, sector, false, true);
-			}
+			shadow = dist <= check * check;
+		}
+
+		if (DeferSprites)
+		{
+			DeferredSprites.Push({ thing, sector, shadow });
+			continue;
 		}
 
+		GLSprite sprite(this);
+		if (shadow)
+		{
+			sprite.Process(thing, sector, false, true);
+		}
 		sprite.Process(thing, sector, false);
 	}
 	
@@ -446,6 +466,72 @@ void GLSceneDrawer::RenderThings(subsector_t * sub, sector_t * sector)
 }
 
 
+//==========================================================================
+//
+// Processes the things collected by RenderThings when gl_threadedsprites
+// is on. The list gets split into contiguous ranges, each of which is
+// processed by its own thread into a private sink. The sinks are then
+// added to the draw lists in order so that the result is the same as if
+// everything had been done on the main thread. Walls and flats are left
+// alone because they allocate from the vertex buffer and create portals.
+//
+//==========================================================================
+
+static void ProcessSpriteRange(GLSceneDrawer *drawer, FDeferredSprite *items, unsigned count, FSpriteSink *sink)
+{
+	gl_spritesink = sink;
+	for (unsigned i = 0; i < count; i++)
+	{
+		GLSprite sprite(drawer);
+		if (items[i].shadow)
+		{
+			sprite.Process(items[i].thing, items[i].sector, false, true);
+		}
+		sprite.Process(items[i].thing, items[i].sector, false);
+	}
+	gl_spritesink = nullptr;
+}
+
+void GLSceneDrawer::ProcessDeferredSprites()
+{
+	enum { SPRITES_PER_THREAD = 32 };
+
+	unsigned count = DeferredSprites.Size();
+	if (count == 0) return;
+
+	SetupSprite.Clock();
+	unsigned numthreads = clamp<unsigned>(Jobs.NumThreads(), 1, 8);
+	numthreads = MIN(numthreads, count / SPRITES_PER_THREAD);
+
+	if (numthreads <= 1)
+	{
+		ProcessSpriteRange(this, &DeferredSprites[0], count, nullptr);
+	}
+	else
+	{
+		std::vector<FSpriteSink> sinks(numthreads);
+
+		Jobs.RunParallel(numthreads, [&](unsigned t)
+		{
+			unsigned start = count * t / numthreads;
+			unsigned end = count * (t + 1) / numthreads;
+			ProcessSpriteRange(this, &DeferredSprites[start], end - start, &sinks[t]);
+		});
+
+		for (auto &sink : sinks)
+		{
+			for (auto &item : sink.items)
+			{
+				gl_drawinfo->drawlists[item.list].AddSprite(&item.sprite);
+			}
+			rendered_sprites += sink.rendered;
+		}
+	}
+	DeferredSprites.Clear();
+	SetupSprite.Unclock();
+}
+
+
 //==========================================================================
 //
 // R_Subsector
@@ -612,6 +698,10 @@ void GLSceneDrawer::RenderBSPNode (void *node)
 	{
 		node_t *bsp = (node_t *)node;
 
+		// Skip subtrees that are entirely in map sections that can't be seen from here.
+		// For skybox views this is most of the map.
+		if (!(nodemapsections[bsp->Index()] & MapSectionMask)) return;
+
 		// Decide which side the view point is on.
 		int side = R_PointOnSide(viewx, viewy, bsp);
 
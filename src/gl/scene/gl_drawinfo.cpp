@@ -712,6 +712,30 @@ SortNode * GLDrawList::DoSort(SortNode * head)
 }
 
 
+//==========================================================================
+//
+// In the plain pass nothing but the render state changes between
+// consecutive walls or flats, so the vertex buffer may merge draws
+// which end up with identical state.
+//
+// Sprites can be merged in every pass. Since only neighbours in the
+// draw order get merged, the depth sorting of translucent sprites stays
+// as it is.
+//
+//==========================================================================
+
+CVAR(Bool, gl_batchdraws, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+
+static bool CanBatch(int pass)
+{
+	return gl_batchdraws && pass == GLPASS_PLAIN && !gl.legacyMode;
+}
+
+static bool CanBatchSprites(int pass)
+{
+	return gl_batchdraws && (pass == GLPASS_PLAIN || pass == GLPASS_ALL || pass == GLPASS_TRANSLUCENT) && !gl.legacyMode;
+}
+
 //==========================================================================
 //
 //
@@ -719,6 +743,9 @@ SortNode * GLDrawList::DoSort(SortNode * head)
 //==========================================================================
 void GLDrawList::DoDraw(int pass, int i, bool trans)
 {
+	// Only sprites get merged here, walls and flats of these lists may change GL state directly.
+	if (drawitems[i].rendertype != GLDIT_SPRITE) GLRenderer->mVBO->EndBatch();
+
 	switch(drawitems[i].rendertype)
 	{
 	case GLDIT_FLAT:
@@ -743,6 +770,7 @@ void GLDrawList::DoDraw(int pass, int i, bool trans)
 		{
 			GLSprite * s=&sprites[drawitems[i].index];
 			RenderSprite.Clock();
+			if (CanBatchSprites(pass)) GLRenderer->mVBO->BeginBatch();
 			s->Draw(pass);
 			RenderSprite.Unclock();
 		}
@@ -833,6 +861,7 @@ void GLDrawList::DrawSorted()
 		glEnable(GL_CLIP_DISTANCE2);
 	}
 	DoDrawSorted(sorted);
+	GLRenderer->mVBO->EndBatch();
 	if (!(gl.flags & RFL_NO_CLIP_PLANES))
 	{
 		glDisable(GL_CLIP_DISTANCE1);
@@ -852,6 +881,7 @@ void GLDrawList::Draw(int pass, bool trans)
 	{
 		DoDraw(pass, i, trans);
 	}
+	GLRenderer->mVBO->EndBatch();
 }
 
 //==========================================================================
@@ -861,11 +891,15 @@ void GLDrawList::Draw(int pass, bool trans)
 //==========================================================================
 void GLDrawList::DrawWalls(int pass)
 {
+	bool batch = CanBatch(pass);
+
 	RenderWall.Clock();
+	if (batch) GLRenderer->mVBO->BeginBatch();
 	for(unsigned i=0;i<drawitems.Size();i++)
 	{
 		walls[drawitems[i].index].Draw(pass);
 	}
+	if (batch) GLRenderer->mVBO->EndBatch();
 	RenderWall.Unclock();
 }
 
@@ -876,11 +910,15 @@ void GLDrawList::DrawWalls(int pass)
 //==========================================================================
 void GLDrawList::DrawFlats(int pass)
 {
+	bool batch = CanBatch(pass);
+
 	RenderFlat.Clock();
+	if (batch) GLRenderer->mVBO->BeginBatch();
 	for(unsigned i=0;i<drawitems.Size();i++)
 	{
 		flats[drawitems[i].index].Draw(pass, false);
 	}
+	if (batch) GLRenderer->mVBO->EndBatch();
 	RenderFlat.Unclock();
 }
 
@@ -891,10 +929,16 @@ void GLDrawList::DrawFlats(int pass)
 //==========================================================================
 void GLDrawList::DrawDecals()
 {
+	// Most decals share their texture and light with the one drawn before,
+	// so the quads of a wall (and often of its neighbours) end up in one draw.
+	bool batch = gl_batchdraws && !gl.legacyMode;
+
+	if (batch) GLRenderer->mVBO->BeginBatch();
 	for(unsigned i=0;i<drawitems.Size();i++)
 	{
 		walls[drawitems[i].index].DoDrawDecals();
 	}
+	if (batch) GLRenderer->mVBO->EndBatch();
 }
 
 //==========================================================================
@@ -913,7 +957,8 @@ void GLDrawList::SortWalls()
 			GLWall * w2 = &walls[b.index];
 
 			if (w1->gltexture != w2->gltexture) return w1->gltexture < w2->gltexture;
-			return (w1->flags & 3) < (w2->flags & 3);
+			if ((w1->flags & 3) != (w2->flags & 3)) return (w1->flags & 3) < (w2->flags & 3);
+			return w1->lightlevel < w2->lightlevel;
 
 		});
 	}
@@ -927,7 +972,8 @@ void GLDrawList::SortFlats()
 		{
 			GLFlat * w1 = &flats[a.index];
 			GLFlat* w2 = &flats[b.index];
-			return w1->gltexture < w2->gltexture;
+			if (w1->gltexture != w2->gltexture) return w1->gltexture < w2->gltexture;
+			return w1->lightlevel < w2->lightlevel;
 		});
 	}
 }
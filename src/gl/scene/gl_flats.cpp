@@ -266,9 +266,7 @@ void GLFlat::DrawSubsectors(int pass, bool processlights, bool istrans)
 			if (gl_drawinfo->ss_renderflags[sub->Index()]&renderflags || istrans)
 			{
 				if (processlights) SetupSubsectorLights(GLPASS_ALL, sub, &dli);
-				drawcalls.Clock();
-				glDrawArrays(GL_TRIANGLE_FAN, index, sub->numlines);
-				drawcalls.Unclock();
+				GLRenderer->mVBO->RenderArray(GL_TRIANGLE_FAN, index, sub->numlines);
 				flatvertices += sub->numlines;
 				flatprimitives++;
 			}
@@ -90,6 +90,64 @@ UniqueList<GLHorizonInfo> UniqueHorizons;
 UniqueList<secplane_t> UniquePlaneMirrors;
 UniqueList<FGLLinePortal> UniqueLineToLines;
 
+//==========================================================================
+//
+// Occlusion queries whose results are only read in the next scene.
+// A portal that was visible there gets rendered right away instead of
+// waiting for its query. All other portals still wait, so a stale result
+// can only cause a hidden portal to be drawn, never a visible one to be
+// skipped.
+//
+//==========================================================================
+
+CVAR(Bool, gl_portalquery_async, false, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+
+struct FPortalQuery
+{
+	const void *source;
+	int recursion;
+	GLuint query;	// 0 if the portal is already known to be visible.
+};
+
+static TArray<FPortalQuery> PortalQueries;
+static TArray<GLuint> FreePortalQueries;
+static TMap<const void *, unsigned> VisiblePortals;	// bit mask of the recursion levels the portal was seen in
+
+static GLuint GetPortalQuery()
+{
+	GLuint query;
+	if (!FreePortalQueries.Pop(query)) glGenQueries(1, &query);
+	return query;
+}
+
+static void ResolvePortalQueries()
+{
+	VisiblePortals.Clear();
+	for (auto &q : PortalQueries)
+	{
+		bool visible = q.query == 0;
+		if (!visible)
+		{
+			GLuint available = 0;
+			glGetQueryObjectuiv(q.query, GL_QUERY_RESULT_AVAILABLE, &available);
+			if (available)
+			{
+				GLuint sampleCount;
+				glGetQueryObjectuiv(q.query, GL_QUERY_RESULT, &sampleCount);
+				visible = sampleCount > 0;
+			}
+			FreePortalQueries.Push(q.query);
+		}
+		if (visible && q.recursion < 32)
+		{
+			unsigned *mask = VisiblePortals.CheckKey(q.source);
+			if (mask) *mask |= 1u << q.recursion;
+			else VisiblePortals.Insert(q.source, 1u << q.recursion);
+		}
+	}
+	PortalQueries.Clear();
+}
+
 //==========================================================================
 //
 //
@@ -102,6 +160,7 @@ void GLPortal::BeginScene()
 	UniqueHorizons.Clear();
 	UniquePlaneMirrors.Clear();
 	UniqueLineToLines.Clear();
+	if (QueryObject) ResolvePortalQueries();
 }
 
 //==========================================================================
@@ -207,9 +266,18 @@ bool GLPortal::Start(bool usestencil, bool doquery)
 				else if (gl_noquery) doquery = false;
 
 				// If occlusion query is supported let's use it to avoid rendering portals that aren't visible
-				if (QueryObject)
+				GLuint query = QueryObject;
+				bool wait = true;
+				if (QueryObject && doquery && gl_portalquery_async)
 				{
-					glBeginQuery(GL_SAMPLES_PASSED, QueryObject);
+					unsigned *mask = VisiblePortals.CheckKey(GetSource());
+					wait = !(mask && recursion < 32 && (*mask & (1u << recursion)));
+					query = GetPortalQuery();
+				}
+
+				if (query)
+				{
+					glBeginQuery(GL_SAMPLES_PASSED, query);
 				}
 				else doquery = false;	// some kind of error happened
 
@@ -234,9 +302,19 @@ bool GLPortal::Start(bool usestencil, bool doquery)
 
 				GLuint sampleCount;
 
-				if (QueryObject)
+				if (query && !wait)
+				{
+					// was visible last time so don't stall on the result. It gets checked in the next scene.
+					PortalQueries.Push({ GetSource(), recursion, query });
+				}
+				else if (query)
 				{
-					glGetQueryObjectuiv(QueryObject, GL_QUERY_RESULT, &sampleCount);
+					glGetQueryObjectuiv(query, GL_QUERY_RESULT, &sampleCount);
+					if (query != QueryObject)
+					{
+						FreePortalQueries.Push(query);
+						if (sampleCount > 0) PortalQueries.Push({ GetSource(), recursion, 0 });
+					}
 
 					if (sampleCount == 0) 	// not visible
 					{
@@ -1278,6 +1356,15 @@ void GLPortal::Initialize()
 
 void GLPortal::Shutdown()
 {
+	for (auto &q : PortalQueries)
+	{
+		if (q.query != 0) glDeleteQueries(1, &q.query);
+	}
+	PortalQueries.Clear();
+	if (FreePortalQueries.Size() > 0) glDeleteQueries(FreePortalQueries.Size(), &FreePortalQueries[0]);
+	FreePortalQueries.Clear();
+	VisiblePortals.Clear();
+
 	if (0 != QueryObject)
 	{
 		glDeleteQueries(1, &QueryObject);
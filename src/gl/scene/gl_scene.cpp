@@ -48,6 +48,7 @@
 #include "events.h"
 
 #include "gl/dynlights/gl_lightbuffer.h"
+#include "gl/system/gl_debug.h"
 #include "gl/system/gl_interface.h"
 #include "gl/system/gl_framebuffer.h"
 #include "gl/system/gl_cvars.h"
@@ -85,6 +86,7 @@ CVAR(Bool, gl_sort_textures, false, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 EXTERN_CVAR (Bool, cl_capfps)
 EXTERN_CVAR (Bool, r_deathcamera)
 EXTERN_CVAR (Float, underwater_fade_scalar)
+EXTERN_CVAR (Bool, gl_threadedsprites)
 EXTERN_CVAR (Float, r_visibility)
 EXTERN_CVAR (Bool, gl_legacy_mode)
 EXTERN_CVAR (Bool, r_drawvoxels)
@@ -93,6 +95,7 @@ extern bool NoInterpolateView;
 
 area_t			in_area;
 TArray<uint8_t> currentmapsection;
+TArray<uint64_t> nodemapsections;
 int camtexcount;
 
 //-----------------------------------------------------------------------------
@@ -115,6 +118,46 @@ angle_t GLSceneDrawer::FrustumAngle()
 	return a1;
 }
 
+//-----------------------------------------------------------------------------
+//
+// Sets up the horizontal frustum that sprites are checked against once
+// their size is known, before lighting and sorting them. It uses the same
+// angle as the clipper, so nothing that can be seen gets rejected.
+//
+//-----------------------------------------------------------------------------
+
+void GLSceneDrawer::SetSpriteFrustum(angle_t a1)
+{
+	// Beyond 90 degrees the frustum isn't the intersection of its two half planes anymore.
+	SpriteFrustumValid = a1 < ANGLE_90;
+	if (!SpriteFrustumValid) return;
+
+	DAngle left = r_viewpoint.Angles.Yaw + AngleToFloat(a1);
+	DAngle right = r_viewpoint.Angles.Yaw - AngleToFloat(a1);
+	SpriteFrustum[0][0] = (float)left.Sin();
+	SpriteFrustum[0][1] = (float)-left.Cos();
+	SpriteFrustum[1][0] = (float)-right.Sin();
+	SpriteFrustum[1][1] = (float)right.Cos();
+}
+
+//-----------------------------------------------------------------------------
+//
+// Folds currentmapsection into the same 64 bits nodemapsections uses.
+//
+//-----------------------------------------------------------------------------
+
+void GLSceneDrawer::SetMapSectionMask()
+{
+	MapSectionMask = 0;
+	for (unsigned i = 0; i < currentmapsection.Size(); i++)
+	{
+		for (int bit = 0; bit < 8; bit++)
+		{
+			if (currentmapsection[i] & (1 << bit)) MapSectionMask |= 1ull << ((i * 8 + bit) & 63);
+		}
+	}
+}
+
 //-----------------------------------------------------------------------------
 //
 // Sets the area the camera is in
@@ -261,11 +304,13 @@ void GLSceneDrawer::CreateScene()
 {
 	angle_t a1 = FrustumAngle();
 	InitClipper(r_viewpoint.Angles.Yaw.BAMs() + a1, r_viewpoint.Angles.Yaw.BAMs() - a1);
+	SetSpriteFrustum(a1);
 
 	// reset the portal manager
 	GLPortal::StartFrame();
 	PO_LinkToSubsectors();
 
+	PROFILE_ZONE("GL scene setup");
 	ProcessAll.Clock();
 
 	// clip the scene and fill the drawlists
@@ -275,7 +320,11 @@ void GLSceneDrawer::CreateScene()
 	GLRenderer->mVBO->Map();
 	SetView();
 	validcount++;	// used for processing sidedefs only once by the renderer.
+	SetMapSectionMask();
+	DeferSprites = gl_threadedsprites;
 	RenderBSPNode (level.HeadNode());
+	ProcessDeferredSprites();
+	DeferSprites = false;
 	if (GLRenderer->mCurrentPortal != NULL) GLRenderer->mCurrentPortal->RenderAttached();
 	Bsp.Unclock();
 
@@ -300,6 +349,7 @@ void GLSceneDrawer::CreateScene()
 
 void GLSceneDrawer::RenderScene(int recursion)
 {
+	PROFILE_ZONE("GL scene draw");
 	RenderAll.Clock();
 
 	glDepthMask(true);
@@ -324,6 +374,7 @@ void GLSceneDrawer::RenderScene(int recursion)
 	bool haslights = GLRenderer->mLightCount > 0 && FixedColormap == CM_DEFAULT && gl_lights;
 	if (gl.lightmethod == LM_DEFERRED && haslights)
 	{
+		FGLDebug::PushGroup("DynamicLights");
 		GLRenderer->mLights->Begin();
 		gl_drawinfo->drawlists[GLDL_PLAINWALLS].DrawWalls(GLPASS_LIGHTSONLY);
 		gl_drawinfo->drawlists[GLDL_PLAINFLATS].DrawFlats(GLPASS_LIGHTSONLY);
@@ -335,9 +386,11 @@ void GLSceneDrawer::RenderScene(int recursion)
 		gl_drawinfo->drawlists[GLDL_MODELS].Draw(GLPASS_LIGHTSONLY);
 		SetupWeaponLight();
 		GLRenderer->mLights->Finish();
+		FGLDebug::PopGroup();
 	}
 
 	// Part 1: solid geometry. This is set up so that there are no transparent parts
+	FGLDebug::PushGroup("Opaque");
 	glDepthFunc(GL_LESS);
 	gl_RenderState.AlphaFunc(GL_GEQUAL, 0.f);
 	glDisable(GL_POLYGON_OFFSET_FILL);
@@ -427,6 +480,7 @@ void GLSceneDrawer::RenderScene(int recursion)
 
 	glPolygonOffset(0.0f, 0.0f);
 	glDisable(GL_POLYGON_OFFSET_FILL);
+	FGLDebug::PopGroup();
 	RenderAll.Unclock();
 
 }
@@ -442,6 +496,7 @@ void GLSceneDrawer::RenderScene(int recursion)
 void GLSceneDrawer::RenderTranslucent()
 {
 	RenderAll.Clock();
+	FGLDebug::PushGroup("Translucent");
 
 	gl_RenderState.SetCameraPos(r_viewpoint.Pos.X, r_viewpoint.Pos.Y, r_viewpoint.Pos.Z);
 
@@ -458,6 +513,7 @@ void GLSceneDrawer::RenderTranslucent()
 	glDepthMask(true);
 
 	gl_RenderState.AlphaFunc(GL_GEQUAL, 0.5f);
+	FGLDebug::PopGroup();
 	RenderAll.Unclock();
 }
 
@@ -519,7 +575,9 @@ void GLSceneDrawer::DrawScene(int drawmode)
 	// Handle all glSectorPortals after rendering the opaque objects but before
 	// doing all translucent stuff
 	recursion++;
+	FGLDebug::PushGroup("Portals");
 	GLPortal::EndFrame();
+	FGLDebug::PopGroup();
 	recursion--;
 	RenderTranslucent();
 }
@@ -858,6 +916,8 @@ sector_t * GLSceneDrawer::RenderViewpoint (AActor * camera, GL_IRECT * bounds, f
 		eye->SetUp();
 		GLRenderer->SetOutputViewport(bounds);
 		Set3DViewport(mainview);
+		bool dynres = mainview && toscreen && stereo3dMode.IsMono() && FGLRenderBuffers::IsEnabled();
+		if (dynres) GLRenderer->BeginDynamicResolution();
 		GLRenderer->mDrawingScene2D = true;
 		GLRenderer->mCurrentFoV = fov;
 		// Stereo mode specific perspective projection
@@ -871,6 +931,7 @@ sector_t * GLSceneDrawer::RenderViewpoint (AActor * camera, GL_IRECT * bounds, f
 		gl_RenderState.ApplyMatrices();
 
 		ProcessScene(toscreen);
+		if (dynres) GLRenderer->EndDynamicResolution();
 		if (mainview)
 		{
 			if (FGLRenderBuffers::IsEnabled()) PostProcess.Clock();
@@ -1025,6 +1086,8 @@ struct FGLInterface : public FRenderer
 	void RenderTextureView (FCanvasTexture *self, AActor *viewpoint, double fov) override;
 	void PreprocessLevel() override;
 	void CleanLevelData() override;
+	void StartBackgroundLevelSetup() override;
+	void FinishBackgroundLevelSetup() override;
 	bool RequireGLNodes() override;
 
 	int GetMaxViewPitch(bool down) override;
@@ -1191,9 +1254,20 @@ void FGLInterface::PreprocessLevel()
 
 void FGLInterface::CleanLevelData() 
 {
+	FinishBackgroundLevelSetup();
 	gl_CleanLevelData();
 }
 
+void FGLInterface::StartBackgroundLevelSetup()
+{
+	if (GLRenderer != nullptr) GLRenderer->mShadowMap.StartAABBTreeBuild();
+}
+
+void FGLInterface::FinishBackgroundLevelSetup()
+{
+	if (GLRenderer != nullptr) GLRenderer->mShadowMap.WaitForAABBTree();
+}
+
 bool FGLInterface::RequireGLNodes() 
 { 
 	return true; 
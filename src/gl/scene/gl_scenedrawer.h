@@ -7,6 +7,13 @@
 #include "gl/renderer/gl_lightdata.h"
 #include "gl/renderer/gl_renderer.h"
 
+struct FDeferredSprite
+{
+	AActor *thing;
+	sector_t *sector;
+	bool shadow;
+};
+
 class GLSceneDrawer
 {
 	fixed_t viewx, viewy;	// since the nodes are still fixed point, keeping the view position  also fixed point for node traversal is faster.
@@ -14,6 +21,13 @@ class GLSceneDrawer
 	subsector_t *currentsubsector;	// used by the line processing code.
 	sector_t *currentsector;
 
+	TArray<FDeferredSprite> DeferredSprites;	// things collected by the BSP walk for the sprite worker threads
+	bool DeferSprites = false;
+
+	float SpriteFrustum[2][2];	// inward normals of the frustum's left and right edge
+	bool SpriteFrustumValid = false;
+	uint64_t MapSectionMask = ~0ull;	// currentmapsection in the form nodemapsections uses
+
 	TMap<DPSprite*, int> weapondynlightindex;
 
 	void SetupWeaponLight();
@@ -28,6 +42,7 @@ class GLSceneDrawer
 	void AddLines(subsector_t * sub, sector_t * sector);
 	void AddSpecialPortalLines(subsector_t * sub, sector_t * sector, line_t *line);
 	void RenderThings(subsector_t * sub, sector_t * sector);
+	void ProcessDeferredSprites();
 	void DoSubsector(subsector_t * sub);
 	void RenderBSPNode(void *node);
 
@@ -47,6 +62,19 @@ public:
 	area_t	in_area;
 
 	angle_t FrustumAngle();
+	void SetSpriteFrustum(angle_t a1);
+	void SetMapSectionMask();
+	bool IsOutsideFrustum(float x1, float y1, float x2, float y2) const
+	{
+		if (!SpriteFrustumValid) return false;
+		x1 -= r_viewpoint.Pos.X; y1 -= r_viewpoint.Pos.Y;
+		x2 -= r_viewpoint.Pos.X; y2 -= r_viewpoint.Pos.Y;
+		for (auto &n : SpriteFrustum)
+		{
+			if (x1 * n[0] + y1 * n[1] < 0 && x2 * n[0] + y2 * n[1] < 0) return true;
+		}
+		return false;
+	}
 	void SetViewMatrix(float vx, float vy, float vz, bool mirror, bool planemirror);
 	void SetViewArea();
 	void SetupView(float vx, float vy, float vz, DAngle va, bool mirror, bool planemirror);
@@ -105,6 +105,8 @@ CVAR(Bool, gl_nolayer, false, 0)
 
 static const float LARGE_VALUE = 1e19f;
 
+thread_local FSpriteSink *gl_spritesink;
+
 
 //==========================================================================
 //
@@ -150,6 +152,7 @@ void GLSprite::CalculateVertices(FVector3 *v)
 		v[2] = mat * FVector3(x2, z, y1);
 		v[3] = mat * FVector3(x1, z, y1);
 
+		gl_CheckPendingDraws();
 		glEnable(GL_POLYGON_OFFSET_FILL);
 		glPolygonOffset(-1.0f, -128.0f);
 		return;
@@ -287,6 +290,9 @@ void GLSprite::Draw(int pass)
 	bool foglayer = false;
 	int rel = fullbright? 0 : getExtraLight();
 
+	// Models change GL state directly, so merged sprites must be drawn before.
+	if (modelframe) gl_CheckPendingDraws();
+
 	if (pass==GLPASS_TRANSLUCENT)
 	{
 		// The translucent pass requires special setup for the various modes.
@@ -344,6 +350,7 @@ void GLSprite::Draw(int pass)
 		gl_GetRenderStyle(RenderStyle, false, false, &tm, &sb, &db, &be);
 		gl_RenderState.SetTextureMode(tm);
 
+		gl_CheckPendingDraws();
 		glEnable(GL_POLYGON_OFFSET_FILL);
 		glPolygonOffset(-1.0f, -128.0f);
 	}
@@ -400,7 +407,19 @@ void GLSprite::Draw(int pass)
 		gl_RenderState.SetFog(0, 0);
 	}
 
-	if (gltexture) gl_RenderState.SetMaterial(gltexture, CLAMP_XY, translation, OverrideShader, !!(RenderStyle.Flags & STYLEF_RedIsAlpha));
+	float u1 = ul, u2 = ur, v1 = vt, v2 = vb;
+	if (gltexture)
+	{
+		int clampmode = CLAMP_XY;
+		const FAtlasEntry *atlas = modelframe ? nullptr : gltexture->UseAtlas(translation, OverrideShader);
+		if (atlas != nullptr)
+		{
+			clampmode = CLAMP_ATLAS;
+			atlas->Map(u1, v1);
+			atlas->Map(u2, v2);
+		}
+		gl_RenderState.SetMaterial(gltexture, clampmode, translation, OverrideShader, !!(RenderStyle.Flags & STYLEF_RedIsAlpha));
+	}
 	else if (!modelframe) gl_RenderState.EnableTexture(false);
 
 		//mDrawer->SetColor(lightlevel, rel, Colormap, trans);
@@ -454,12 +473,13 @@ void GLSprite::Draw(int pass)
 			gl_RenderState.SetNormal(0, 0, 0);
 			CalculateVertices(v);
 			
+			// Drawn as a fan so that the vertex buffer can merge consecutive sprites with the same state.
 			FQuadDrawer qd;
-			qd.Set(0, v[0][0], v[0][1], v[0][2], ul, vt);
-			qd.Set(1, v[1][0], v[1][1], v[1][2], ur, vt);
-			qd.Set(2, v[2][0], v[2][1], v[2][2], ul, vb);
-			qd.Set(3, v[3][0], v[3][1], v[3][2], ur, vb);
-			qd.Render(GL_TRIANGLE_STRIP);
+			qd.Set(0, v[0][0], v[0][1], v[0][2], u1, v1);
+			qd.Set(1, v[1][0], v[1][1], v[1][2], u2, v1);
+			qd.Set(2, v[3][0], v[3][1], v[3][2], u2, v2);
+			qd.Set(3, v[2][0], v[2][1], v[2][2], u1, v2);
+			qd.Render(GL_TRIANGLE_FAN);
 
 			if (foglayer)
 			{
@@ -469,7 +489,7 @@ void GLSprite::Draw(int pass)
 				gl_RenderState.BlendEquation(GL_FUNC_ADD);
 				gl_RenderState.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 				gl_RenderState.Apply();
-				qd.Render(GL_TRIANGLE_STRIP);
+				qd.Render(GL_TRIANGLE_FAN);
 				gl_RenderState.SetFixedColormap(CM_DEFAULT);
 			}
 		}
@@ -492,12 +512,14 @@ void GLSprite::Draw(int pass)
 		gl_RenderState.SetTextureMode(TM_MODULATE);
 		if (actor != nullptr && (actor->renderflags & RF_SPRITETYPEMASK) == RF_FLATSPRITE)
 		{
+			gl_CheckPendingDraws();
 			glPolygonOffset(0.0f, 0.0f);
 			glDisable(GL_POLYGON_OFFSET_FILL);
 		}
 	}
 	else if (modelframe == nullptr)
 	{
+		gl_CheckPendingDraws();
 		glPolygonOffset(0.0f, 0.0f);
 		glDisable(GL_POLYGON_OFFSET_FILL);
 	}
@@ -527,7 +549,8 @@ inline void GLSprite::PutSprite(bool translucent)
 		list = GLDL_MODELS;
 	}
 	dynlightindex = -1;
-	gl_drawinfo->drawlists[list].AddSprite(this);
+	if (gl_spritesink != nullptr) gl_spritesink->items.Push({ list, *this });
+	else gl_drawinfo->drawlists[list].AddSprite(this);
 }
 
 //==========================================================================
@@ -767,7 +790,7 @@ void GLSprite::Process(AActor* thing, sector_t * sector, int thruportal, bool is
 			// exclude vertically moving objects from this check.
 			if (!thing->Vel.isZero())
 			{
-				if (!FindModelFrame(thing->GetClass(), spritenum, thing->frame, false))
+				if (!FindModelFrame(thing->GetClass(), thing->state, spritenum, thing->frame, false))
 				{
 					return;
 				}
@@ -835,7 +858,7 @@ void GLSprite::Process(AActor* thing, sector_t * sector, int thruportal, bool is
 		z += fz;
 	}
 
-	modelframe = isPicnumOverride ? nullptr : FindModelFrame(thing->GetClass(), spritenum, thing->frame, !!(thing->flags & MF_DROPPED));
+	modelframe = isPicnumOverride ? nullptr : FindModelFrame(thing->GetClass(), thing->state, spritenum, thing->frame, !!(thing->flags & MF_DROPPED));
 
 	// don't bother drawing sprite shadows if this is a model (it will never look right)
 	if (modelframe && isSpriteShadow)
@@ -963,6 +986,13 @@ void GLSprite::Process(AActor* thing, sector_t * sector, int thruportal, bool is
 			break;
 		}
 		}
+
+		// Now that the sprite's real width is known, skip the lighting and sorting if it's entirely outside the view.
+		// Flat and rolled sprites extend in other directions than the line computed above.
+		if (spritetype != RF_FLATSPRITE && !(thing->renderflags & RF_ROLLSPRITE) && mDrawer->IsOutsideFrustum(x1, y1, x2, y2))
+		{
+			return;
+		}
 	}
 	else
 	{
@@ -1190,7 +1220,8 @@ void GLSprite::Process(AActor* thing, sector_t * sector, int thruportal, bool is
 	}
 
 	PutSprite(hw_styleflags != STYLEHW_Solid);
-	rendered_sprites++;
+	if (gl_spritesink != nullptr) gl_spritesink->rendered++;
+	else rendered_sprites++;
 }
 
 
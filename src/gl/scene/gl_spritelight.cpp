@@ -50,6 +50,12 @@
 FDynLightData modellightdata;
 int modellightindex = -1;
 
+// Models touched by more lights than this only get the ones that light them the most.
+CUSTOM_CVAR(Int, gl_maxmodellights, 0, CVAR_ARCHIVE)
+{
+	if (self < 0) self = 0;
+}
+
 template<class T>
 T smoothstep(const T edge0, const T edge1, const T x)
 {
@@ -178,9 +184,17 @@ int gl_SetDynModelLight(AActor *self, int dynlightindex)
 
 	if (self)
 	{
-		static std::vector<FDynamicLight*> addedLights; // static so that we build up a reserve (memory allocations stop)
+		struct ModelLight
+		{
+			FDynamicLight *light;
+			int group;
+			float importance;
+		};
+		static TArray<ModelLight> addedLights; // static so that we build up a reserve (memory allocations stop)
+		static int collectstamp;
 
-		addedLights.clear();
+		addedLights.Clear();
+		collectstamp++;
 
 		float x = (float)self->X();
 		float y = (float)self->Y();
@@ -205,16 +219,33 @@ int gl_SetDynModelLight(AActor *self, int dynlightindex)
 					double distSquared = dx * dx + dy * dy + dz * dz;
 					if (distSquared < radius * radius) // Light and actor touches
 					{
-						if (std::find(addedLights.begin(), addedLights.end(), light) == addedLights.end()) // Check if we already added this light from a different subsector
+						if (light->mCollectStamp != collectstamp) // Check if we already added this light from a different subsector
 						{
-							gl_AddLightToList(group, light, modellightdata);
-							addedLights.push_back(light);
+							light->mCollectStamp = collectstamp;
+							// How strongly the light reaches the actor, for when there are too many.
+							float reach = 1.f - float(sqrt(distSquared)) / radius;
+							float importance = (light->GetRed() + light->GetGreen() + light->GetBlue()) * reach;
+							addedLights.Push({ light, group, importance });
 						}
 					}
 				}
 				node = node->nextLight;
 			}
 		});
+
+		unsigned count = addedLights.Size();
+		if (gl_maxmodellights > 0 && count > (unsigned)gl_maxmodellights)
+		{
+			std::partial_sort(addedLights.begin(), addedLights.begin() + gl_maxmodellights, addedLights.end(), [](const ModelLight &a, const ModelLight &b)
+			{
+				return a.importance > b.importance;
+			});
+			count = gl_maxmodellights;
+		}
+		for (unsigned i = 0; i < count; i++)
+		{
+			gl_AddLightToList(addedLights[i].group, addedLights[i].light, modellightdata);
+		}
 	}
 
 	dynlightindex = GLRenderer->mLights->UploadLights(modellightdata);
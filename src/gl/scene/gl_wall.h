@@ -57,6 +57,8 @@ enum PortalTypes
 	PORTALTYPE_LINETOLINE,
 };
 
+struct FWallVertexCache;
+
 struct GLSeg
 {
 	float x1,x2;
@@ -208,6 +210,7 @@ private:
 
 	void SetupLights();
 	bool PrepareLight(FDynamicLight * light, int pass);
+	FWallVertexCache *FindVertexCache(bool split);
 	void MakeVertices(bool nosplit);
 	void RenderWall(int textured);
 	void RenderTextured(int rflags);
@@ -418,6 +421,21 @@ public:
 	double CalcIntersectionVertex(GLWall * w2);
 };
 
+// While set, PutSprite collects the processed sprites here instead of adding
+// them to the draw lists. Used by the sprite worker threads of the BSP pass.
+struct FSpriteSink
+{
+	struct Item
+	{
+		int list;
+		GLSprite sprite;
+	};
+	TArray<Item> items;
+	int rendered = 0;
+};
+
+extern thread_local FSpriteSink *gl_spritesink;
+
 inline float Dist2(float x1,float y1,float x2,float y2)
 {
 	return sqrtf((x1-x2)*(x1-x2)+(y1-y2)*(y1-y2));
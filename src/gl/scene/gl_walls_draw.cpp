@@ -157,6 +157,92 @@ void GLWall::SetupLights()
 	dynlightindex = GLRenderer->mLights->UploadLights(lightdata);
 }
 
+//==========================================================================
+//
+// Wall vertex cache
+//
+// Most walls look exactly the same from one frame to the next, so there is
+// no point in writing their vertices to the streaming buffer every frame.
+// Each seg gets one cache slot for its upper, middle and lower part, stored
+// in the static area of the vertex buffer. A slot is reused as long as all
+// the values the vertices are made of stay the same, which automatically
+// handles moving planes, scrolling textures and changed offsets.
+// Walls that get split at the vertex heights of adjacent sectors are not
+// cached because those heights are not part of the key.
+//
+//==========================================================================
+
+CVAR(Bool, gl_cachewallvertices, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+
+struct FWallVertexKey
+{
+	GLSeg glseg;
+	float ztop[2], zbottom[2];
+	float zceil[2], zfloor[2];
+	texcoord tcs[4];
+	int splitflags;
+};
+
+struct FWallVertexCache
+{
+	FWallVertexKey key;
+	unsigned int index;
+	unsigned int count;
+	unsigned int capacity;
+	unsigned int frame;
+};
+
+static TArray<int> WallCacheSlots;				// 3 per seg, -1 if unused
+static TArray<FWallVertexCache> WallCache;
+static unsigned int WallCacheGeneration;
+
+static int WallCachePart(int type)
+{
+	switch (type)
+	{
+	case RENDERWALL_TOP:
+		return 0;
+	case RENDERWALL_M1S:
+	case RENDERWALL_M2S:
+	case RENDERWALL_M2SNF:
+		return 1;
+	case RENDERWALL_BOTTOM:
+		return 2;
+	default:
+		return -1;
+	}
+}
+
+FWallVertexCache *GLWall::FindVertexCache(bool split)
+{
+	if (!gl_cachewallvertices || seg == nullptr || seg->sidedef == nullptr) return nullptr;
+
+	int part = WallCachePart(type);
+	if (part < 0) return nullptr;
+
+	if (split)
+	{
+		if (glseg.fracleft == 0 && vertexes[0] != nullptr && vertexes[0]->numheights) return nullptr;
+		if (glseg.fracright == 1 && vertexes[1] != nullptr && vertexes[1]->numheights) return nullptr;
+	}
+
+	if (WallCacheGeneration != GLRenderer->mVBO->GetLevelGeneration())
+	{
+		WallCacheGeneration = GLRenderer->mVBO->GetLevelGeneration();
+		WallCache.Clear();
+		WallCacheSlots.Resize(level.segs.Size() * 3);
+		for (auto &slot : WallCacheSlots) slot = -1;
+	}
+
+	int &slot = WallCacheSlots[seg->Index() * 3 + part];
+	if (slot < 0)
+	{
+		slot = WallCache.Reserve(1);
+		memset(&WallCache[slot], 0, sizeof(FWallVertexCache));
+	}
+	return &WallCache[slot];
+}
+
 //==========================================================================
 //
 // build the vertices for this wall
@@ -169,6 +255,32 @@ void GLWall::MakeVertices(bool nosplit)
 	{
 		bool split = (gl_seamless && !nosplit && seg->sidedef != NULL && !(seg->sidedef->Flags & WALLF_POLYOBJ) && !(flags & GLWF_NOSPLIT));
 
+		FWallVertexCache *cache = FindVertexCache(split);
+		FWallVertexKey key;
+		unsigned int frame = GLRenderer->mVBO->GetFrame();
+
+		if (cache != nullptr)
+		{
+			memset(&key, 0, sizeof(key));
+			key.glseg = glseg;
+			memcpy(key.ztop, ztop, sizeof(key.ztop));
+			memcpy(key.zbottom, zbottom, sizeof(key.zbottom));
+			memcpy(key.zceil, zceil, sizeof(key.zceil));
+			memcpy(key.zfloor, zfloor, sizeof(key.zfloor));
+			memcpy(key.tcs, tcs, sizeof(key.tcs));
+			key.splitflags = split ? 1 | (flags & (GLWF_NOSPLITUPPER | GLWF_NOSPLITLOWER)) : 0;
+
+			if (cache->count > 0 && !memcmp(&key, &cache->key, sizeof(key)))
+			{
+				cache->frame = frame;
+				vertindex = cache->index;
+				vertcount = cache->count;
+				return;
+			}
+			// Another part of this seg already uses the slot in this frame, so it may not be changed now.
+			if (cache->count > 0 && cache->frame == frame) cache = nullptr;
+		}
+
 		FFlatVertex *ptr = GLRenderer->mVBO->GetBuffer();
 
 		ptr->Set(glseg.x1, zbottom[0], glseg.y1, tcs[LOLFT].u, tcs[LOLFT].v);
@@ -184,6 +296,24 @@ void GLWall::MakeVertices(bool nosplit)
 		ptr++;
 		if (split && !(flags & GLWF_NOSPLITLOWER)) SplitLowerEdge(ptr);
 		vertcount = GLRenderer->mVBO->GetCount(ptr, &vertindex);
+
+		if (cache != nullptr)
+		{
+			if (cache->capacity < vertcount)
+			{
+				// the old space is lost until the next level gets loaded, but this should be rare.
+				if (GLRenderer->mVBO->AllocStatic(vertcount, &cache->index) == nullptr)
+				{
+					cache->count = 0;
+					return;
+				}
+				cache->capacity = vertcount;
+			}
+			memcpy(GLRenderer->mVBO->GetVertex(cache->index), GLRenderer->mVBO->GetVertex(vertindex), vertcount * sizeof(FFlatVertex));
+			cache->key = key;
+			cache->count = vertcount;
+			cache->frame = frame;
+		}
 	}
 }
 
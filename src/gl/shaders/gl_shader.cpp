@@ -871,6 +871,7 @@ void FShaderManager::SetActiveShader(FShader *sh)
 {
 	if (mActiveShader != sh)
 	{
+		gl_CheckPendingDraws();
 		glUseProgram(sh!= NULL? sh->GetHandle() : 0);
 		mActiveShader = sh;
 	}
@@ -56,6 +56,7 @@ public:
 
 	void Set(int newvalue)
 	{
+		gl_CheckPendingDraws();
 		glUniform1i(mIndex, newvalue);
 	}
 };
@@ -77,6 +78,7 @@ public:
 		if (newvalue != mBuffer)
 		{
 			mBuffer = newvalue;
+			gl_CheckPendingDraws();
 			glUniform1i(mIndex, newvalue);
 		}
 	}
@@ -99,6 +101,7 @@ public:
 		if (memcmp(newvalue, mBuffer, sizeof(mBuffer)))
 		{
 			memcpy(mBuffer, newvalue, sizeof(mBuffer));
+			gl_CheckPendingDraws();
 			glUniform4iv(mIndex, 1, newvalue);
 		}
 	}
@@ -121,6 +124,7 @@ public:
 		if (newvalue != mBuffer)
 		{
 			mBuffer = newvalue;
+			gl_CheckPendingDraws();
 			glUniform1f(mIndex, newvalue);
 		}
 	}
@@ -143,6 +147,7 @@ public:
 		if (memcmp(newvalue, mBuffer, sizeof(mBuffer)))
 		{
 			memcpy(mBuffer, newvalue, sizeof(mBuffer));
+			gl_CheckPendingDraws();
 			glUniform2fv(mIndex, 1, newvalue);
 		}
 	}
@@ -153,6 +158,7 @@ public:
 		{
 			mBuffer[0] = f1;
 			mBuffer[1] = f2;
+			gl_CheckPendingDraws();
 			glUniform2fv(mIndex, 1, mBuffer);
 		}
 	}
@@ -176,6 +182,7 @@ public:
 		if (memcmp(newvalue, mBuffer, sizeof(mBuffer)))
 		{
 			memcpy(mBuffer, newvalue, sizeof(mBuffer));
+			gl_CheckPendingDraws();
 			glUniform4fv(mIndex, 1, newvalue);
 		}
 	}
@@ -193,11 +200,13 @@ public:
 
 	void Set(const float *newvalue)
 	{
+		gl_CheckPendingDraws();
 		glUniform4fv(mIndex, 1, newvalue);
 	}
 
 	void Set(float a, float b, float c, float d)
 	{
+		gl_CheckPendingDraws();
 		glUniform4f(mIndex, a, b, c, d);
 	}
 };
@@ -219,6 +228,7 @@ public:
 		if (newvalue != mBuffer)
 		{
 			mBuffer = newvalue;
+			gl_CheckPendingDraws();
 			glUniform4f(mIndex, newvalue.r/255.f, newvalue.g/255.f, newvalue.b/255.f, newvalue.a/255.f);
 		}
 	}
@@ -241,6 +251,7 @@ public:
 		if (newvalue != mBuffer)
 		{
 			mBuffer = newvalue;
+			gl_CheckPendingDraws();
 			glUniform1i(mIndex, newvalue);
 		}
 	}
@@ -312,6 +323,8 @@ private:
 	int currentfixedcolormap = 0;
 	bool currentTextureMatrixState = true;// by setting the matrix state to 'true' it is guaranteed to be set the first time the render state gets applied.
 	bool currentModelMatrixState = true;
+	bool currentModelMatrixValid = false;	// currentModelMatrix is what the shader has, so it doesn't need to be uploaded again.
+	VSMatrix currentModelMatrix;
 
 public:
 	FShader(const char *name)
@@ -0,0 +1,21 @@
+#ifndef __GL_SHARPENSHADER_H
+#define __GL_SHARPENSHADER_H
+
+#include "gl_shaderprogram.h"
+
+class FSharpenShader
+{
+public:
+	void Bind();
+
+	FBufferedUniformSampler InputTexture;
+	FBufferedUniform2f Scale;
+	FBufferedUniform2f Offset;
+	FBufferedUniform2f InvSize;
+	FBufferedUniform1f Sharpness;
+
+private:
+	FShaderProgram mShader;
+};
+
+#endif
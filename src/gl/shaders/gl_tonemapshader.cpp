@@ -35,19 +35,32 @@
 #include "gl/system/gl_cvars.h"
 #include "gl/shaders/gl_tonemapshader.h"
 
-void FTonemapShader::Bind()
+void FTonemapShader::Bind(bool colormap)
 {
-	auto &shader = mShader[gl_tonemap];
+	auto &shader = colormap ? mColormapShader[gl_tonemap] : mShader[gl_tonemap];
 	if (!shader)
 	{
+		FString defines = GetDefines(gl_tonemap);
+		if (colormap) defines += "#define COLORMAP\n";
+
 		shader.Compile(FShaderProgram::Vertex, "shaders/glsl/screenquad.vp", "", 330);
-		shader.Compile(FShaderProgram::Fragment, "shaders/glsl/tonemap.fp", GetDefines(gl_tonemap), 330);
+		shader.Compile(FShaderProgram::Fragment, "shaders/glsl/tonemap.fp", defines, 330);
 		shader.SetFragDataLocation(0, "FragColor");
 		shader.Link("shaders/glsl/tonemap");
 		shader.SetAttribLocation(0, "PositionInProjection");
+	}
+	if (&shader != mLastShader)
+	{
+		// The uniform locations differ between the variants.
+		mLastShader = &shader;
 		SceneTexture.Init(shader, "InputTexture");
 		ExposureTexture.Init(shader, "ExposureTexture");
 		PaletteLUT.Init(shader, "PaletteLUT");
+		if (colormap)
+		{
+			MapStart.Init(shader, "uFixedColormapStart");
+			MapRange.Init(shader, "uFixedColormapRange");
+		}
 	}
 	shader.Bind();
 }
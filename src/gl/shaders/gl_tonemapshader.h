@@ -6,11 +6,13 @@
 class FTonemapShader
 {
 public:
-	void Bind();
+	void Bind(bool colormap = false);
 
 	FBufferedUniformSampler SceneTexture;
 	FBufferedUniformSampler ExposureTexture;
 	FBufferedUniformSampler PaletteLUT;
+	FUniform4f MapStart;	// only in the variant with the colormap pass fused in
+	FUniform4f MapRange;
 
 	static bool IsPaletteMode();
 
@@ -29,6 +31,8 @@ private:
 	static const char *GetDefines(int mode);
 
 	FShaderProgram mShader[NumTonemapModes];
+	FShaderProgram mColormapShader[NumTonemapModes];
+	FShaderProgram *mLastShader = nullptr;
 };
 
 class FExposureExtractShader
@@ -52,8 +52,34 @@ namespace
 {
 	bool gpuStatActive = false;
 	bool keepGpuStatActive = false;
-	std::vector<std::pair<FString, GLuint>> timeElapsedQueries;
 	FString gpuStatOutput;
+
+	// Every group gets a timestamp query at its start and end. Timestamps can
+	// nest, unlike GL_TIME_ELAPSED. The queries of the last few frames are kept
+	// in a ring and only read once the GPU has finished them, so the CPU never
+	// waits for the results.
+	enum { GpuTimerFrames = 4 };
+
+	struct GpuTimerQuery
+	{
+		FName Name;
+		FName Parent;
+		int Depth;
+		GLuint Ids[2];
+	};
+
+	struct GpuTimerFrame
+	{
+		TArray<GpuTimerQuery> Queries;
+		unsigned Used = 0;
+		GLuint LastIssued = 0;
+		bool Pending = false;
+	};
+
+	GpuTimerFrame gpuTimerFrames[GpuTimerFrames];
+	int gpuTimerFrame = 0;
+	bool gpuTimerRecording = false;
+	TArray<unsigned> gpuTimerStack;	// open groups of the current frame
 }
 
 ADD_STAT(gpu)
@@ -62,29 +88,113 @@ ADD_STAT(gpu)
 	return gpuStatOutput;
 }
 
+static bool HasTimerQueries()
+{
+	return glQueryCounter != nullptr && glGetQueryObjectui64v != nullptr && glGetInteger64v != nullptr;
+}
+
 //-----------------------------------------------------------------------------
 //
-// Updates OpenGL debugging state
+// Reads back a finished frame into the gpu stat and the profiler
 //
 //-----------------------------------------------------------------------------
 
-void FGLDebug::Update()
+static void ReadGpuTimerFrame(GpuTimerFrame &frame)
 {
+	// Timestamps are moved onto the profiler's clock
+	GLint64 gpunow = 0;
+	glGetInteger64v(GL_TIMESTAMP, &gpunow);
+	int64_t offset = (int64_t)FProfileZone::Now() - gpunow;
+	bool toprofiler = FProfileZone::Enabled;
+
+	struct Total { FName Name; int Depth; double Time; int Count; };
+	TArray<Total> totals;
+
+	for (unsigned i = 0; i < frame.Used; i++)
+	{
+		auto &query = frame.Queries[i];
+		GLuint64 start = 0, end = 0;
+		glGetQueryObjectui64v(query.Ids[0], GL_QUERY_RESULT, &start);
+		glGetQueryObjectui64v(query.Ids[1], GL_QUERY_RESULT, &end);
+		uint64_t duration = end > start ? end - start : 0;
+
+		if (toprofiler)
+		{
+			FProfileZone::AddEvent("GPU", query.Name.GetChars(), query.Depth > 0 ? query.Parent.GetChars() : nullptr,
+				start + offset, duration, query.Depth);
+		}
+
+		auto found = totals.FindEx([&](const Total &t) { return t.Name == query.Name && t.Depth == query.Depth; });
+		if (found == totals.Size()) totals.Push({ query.Name, query.Depth, duration / 1000000.0, 1 });
+		else
+		{
+			totals[found].Time += duration / 1000000.0;
+			totals[found].Count++;
+		}
+	}
+	frame.Used = 0;
+	frame.Pending = false;
+
 	gpuStatOutput = "";
-	for (auto &query : timeElapsedQueries)
+	for (auto &total : totals)
+	{
+		gpuStatOutput.AppendFormat("%*s%s=%04.2f ms", total.Depth * 2, "", total.Name.GetChars(), total.Time);
+		if (total.Count > 1) gpuStatOutput.AppendFormat(" (%d)", total.Count);
+		gpuStatOutput += "\n";
+	}
+}
+
+//-----------------------------------------------------------------------------
+//
+// Ends the frame's GPU timings and picks up the ones that are ready
+//
+//-----------------------------------------------------------------------------
+
+static void UpdateGpuTimers()
+{
+	if (gpuTimerRecording)
 	{
-		GLuint timeElapsed = 0;
-		glGetQueryObjectuiv(query.second, GL_QUERY_RESULT, &timeElapsed);
-		glDeleteQueries(1, &query.second);
+		auto &frame = gpuTimerFrames[gpuTimerFrame];
+		while (gpuTimerStack.Size() > 0)
+		{
+			unsigned index;
+			gpuTimerStack.Pop(index);
+			glQueryCounter(frame.Queries[index].Ids[1], GL_TIMESTAMP);
+			frame.LastIssued = frame.Queries[index].Ids[1];
+		}
+		frame.Pending = frame.Used > 0;
+		gpuTimerFrame = (gpuTimerFrame + 1) % GpuTimerFrames;
+	}
 
-		FString out;
-		out.Format("%s=%04.2f ms\n", query.first.GetChars(), timeElapsed / 1000000.0f);
-		gpuStatOutput += out;
+	// Oldest frame first
+	for (int i = 0; i < GpuTimerFrames; i++)
+	{
+		auto &frame = gpuTimerFrames[(gpuTimerFrame + i) % GpuTimerFrames];
+		if (!frame.Pending) continue;
+
+		GLuint available = 0;
+		glGetQueryObjectuiv(frame.LastIssued, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available) break;
+		ReadGpuTimerFrame(frame);
 	}
-	timeElapsedQueries.clear();
 
-	gpuStatActive = keepGpuStatActive;
+	if (!gpuStatActive) gpuStatOutput = "";
+
+	// If the GPU is so far behind that the next slot is still in use, skip a frame.
+	gpuTimerRecording = gpuStatActive && HasTimerQueries() && !gpuTimerFrames[gpuTimerFrame].Pending;
+}
+
+//-----------------------------------------------------------------------------
+//
+// Updates OpenGL debugging state
+//
+//-----------------------------------------------------------------------------
+
+void FGLDebug::Update()
+{
+	gpuStatActive = keepGpuStatActive || FProfileZone::Enabled;
 	keepGpuStatActive = false;
+	UpdateGpuTimers();
 
 	if (!HasDebugApi())
 		return;
@@ -131,12 +241,20 @@ void FGLDebug::PushGroup(const FString &name)
 		glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, (GLsizei)name.Len(), name.GetChars());
 	}
 
-	if (gpuStatActive)
+	if (gpuTimerRecording)
 	{
-		GLuint queryHandle = 0;
-		glGenQueries(1, &queryHandle);
-		glBeginQuery(GL_TIME_ELAPSED, queryHandle);
-		timeElapsedQueries.push_back({ name, queryHandle });
+		auto &frame = gpuTimerFrames[gpuTimerFrame];
+		if (frame.Used == frame.Queries.Size())
+		{
+			auto &query = frame.Queries[frame.Queries.Reserve(1)];
+			glGenQueries(2, query.Ids);
+		}
+		auto &query = frame.Queries[frame.Used];
+		query.Name = name.GetChars();
+		query.Parent = gpuTimerStack.Size() > 0 ? frame.Queries[gpuTimerStack.Last()].Name : FName(NAME_None);
+		query.Depth = gpuTimerStack.Size();
+		glQueryCounter(query.Ids[0], GL_TIMESTAMP);
+		gpuTimerStack.Push(frame.Used++);
 	}
 }
 
@@ -147,9 +265,13 @@ void FGLDebug::PopGroup()
 		glPopDebugGroup();
 	}
 
-	if (gpuStatActive)
+	if (gpuTimerRecording && gpuTimerStack.Size() > 0)
 	{
-		glEndQuery(GL_TIME_ELAPSED);
+		auto &frame = gpuTimerFrames[gpuTimerFrame];
+		unsigned index;
+		gpuTimerStack.Pop(index);
+		glQueryCounter(frame.Queries[index].Ids[1], GL_TIMESTAMP);
+		frame.LastIssued = frame.Queries[index].Ids[1];
 	}
 }
 
@@ -214,6 +214,7 @@ void OpenGLFrameBuffer::Swap()
 	Finish.Unclock();
 	camtexcount = 0;
 	FHardwareTexture::UnbindAll();
+	FHardwareTexture::EndFrame();
 	mDebug->Update();
 }
 
@@ -475,6 +476,31 @@ void OpenGLFrameBuffer::FillSimplePoly(FTexture *texture, FVector2 *points, int
 	}
 }
 
+//==========================================================================
+//
+// The scissor rectangles of the kept commands are in window coordinates,
+// so they are only valid for the screen viewport they were made with.
+//
+//==========================================================================
+
+bool OpenGLFrameBuffer::BeginRetained2D(int layer, uint64_t key)
+{
+	if (GLRenderer == nullptr || GLRenderer->m2DDrawer == nullptr) return false;
+
+	const auto &viewport = GLRenderer->mScreenViewport;
+	key = key * 31 + viewport.left;
+	key = key * 31 + viewport.top;
+	key = key * 31 + viewport.width;
+	key = key * 31 + viewport.height;
+	return GLRenderer->m2DDrawer->BeginRetained(layer, key);
+}
+
+void OpenGLFrameBuffer::EndRetained2D()
+{
+	if (GLRenderer != nullptr && GLRenderer->m2DDrawer != nullptr)
+		GLRenderer->m2DDrawer->EndRetained();
+}
+
 
 //===========================================================================
 // 
@@ -70,6 +70,9 @@ public:
 		double originx, double originy, double scalex, double scaley,
 		DAngle rotation, const FColormap &colormap, PalEntry flatcolor, int lightlevel, int bottomclip);
 
+	bool BeginRetained2D(int layer, uint64_t key) override;
+	void EndRetained2D() override;
+
 	FNativePalette *CreatePalette(FRemapTable *remap);
 
 	bool WipeStartScreen(int type);
@@ -190,6 +190,15 @@ void gl_LoadExtensions()
 		gl.lightmethod = LM_DEFERRED;
 		gl.buffermethod = BM_DEFERRED;
 		gl.flags |= RFL_NO_CLIP_PLANES;
+
+		// These are core in GLES 3.0. Tile based GPUs in particular profit from being told which
+		// attachment contents are no longer needed, so that they don't get reloaded into tile memory.
+		if (gl_version >= 3.0f)
+		{
+			if (!Args->CheckParm("-nosampler")) gl.flags |= RFL_SAMPLER_OBJECTS;
+			gl.flags |= RFL_INVALIDATE_BUFFER;
+		}
+		if (gl_version >= 3.2f || CheckExtension("GL_KHR_debug")) gl.flags |= RFL_DEBUG;
 	}
 	else
 	{
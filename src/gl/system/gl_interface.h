@@ -76,5 +76,15 @@ struct RenderContext
 
 extern RenderContext gl;
 
+// Number of draws FFlatVertexBuffer has merged but not submitted yet.
+// Everything that changes GL state has to submit them first.
+extern unsigned int gl_pendingdraws;
+void gl_FlushPendingDraws();
+
+inline void gl_CheckPendingDraws()
+{
+	if (gl_pendingdraws) gl_FlushPendingDraws();
+}
+
 #endif
 
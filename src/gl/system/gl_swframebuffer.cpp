@@ -77,6 +77,7 @@
 #endif
 
 CVAR(Int, gl_showpacks, 0, 0)
+CVAR(Bool, vid_swmappedbuffer, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
 #ifndef WIN32 // Defined in fb_d3d9 for Windows
 CVAR(Bool, vid_hwaalines, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
 CUSTOM_CVAR(Bool, vid_hw2d, true, CVAR_NOINITCALL)
@@ -264,6 +265,10 @@ OpenGLSWFrameBuffer::HWTexture::~HWTexture()
 {
 	if (Texture != 0) glDeleteTextures(1, (GLuint*)&Texture);
 	if (Buffers[0] != 0) glDeleteBuffers(2, (GLuint*)Buffers);
+	for (auto fence : Fences)
+	{
+		if (fence != nullptr) glDeleteSync((GLsync)fence);
+	}
 }
 
 OpenGLSWFrameBuffer::HWVertexBuffer::~HWVertexBuffer()
@@ -783,8 +788,11 @@ void OpenGLSWFrameBuffer::Present()
 
 void OpenGLSWFrameBuffer::SetInitialState()
 {
-	if (gl.es || strstr(gl.vendorstring, "NVIDIA") == NULL || strstr(gl.vendorstring, "Intel") == NULL)
-		UseMappedMemBuffer = false;
+	// With vid_swmappedbuffer the canvas is rendered straight into persistently
+	// mapped pixel buffers, which saves copying it every frame. The renderer
+	// reads the buffer back for blending, so it depends on the driver whether
+	// this is faster.
+	UseMappedMemBuffer = !gl.es && (gl.flags & RFL_BUFFER_STORAGE) && vid_swmappedbuffer;
 
 	AlphaBlendEnabled = false;
 	AlphaBlendOp = GL_FUNC_ADD;
@@ -936,6 +944,7 @@ void OpenGLSWFrameBuffer::ReleaseResources()
 
 void OpenGLSWFrameBuffer::ReleaseDefaultPoolItems()
 {
+	MappedMemBuffer = nullptr;	// the mapping goes away with the buffers
 	FBTexture.reset();
 	FinalWipeScreen.reset();
 	InitialWipeScreen.reset();
@@ -1147,24 +1156,26 @@ bool OpenGLSWFrameBuffer::Lock(bool buffered)
 	}
 	assert(!In2D);
 	Accel2D = vid_hw2d;
-	if (UseMappedMemBuffer)
+	if (UseMappedMemBuffer && !MappedMemBuffer)
 	{
-		if (!MappedMemBuffer)
-		{
-			BindFBBuffer();
+		BindFBBuffer();
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 
-			MappedMemBuffer = glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_READ_WRITE);
+		if (UseMappedMemBuffer)
+		{
+			// Wait until the upload from this buffer two frames ago has completed.
+			int current = FBTexture->CurrentBuffer;
+			if (FBTexture->Fences[current] != nullptr)
+			{
+				glClientWaitSync((GLsync)FBTexture->Fences[current], GL_SYNC_FLUSH_COMMANDS_BIT, 1000 * 1000 * 1000);
+				glDeleteSync((GLsync)FBTexture->Fences[current]);
+				FBTexture->Fences[current] = nullptr;
+			}
+			MappedMemBuffer = FBTexture->Mapped[current];
 			Pitch = Width;
-			if (MappedMemBuffer == nullptr)
-				return true;
-			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 		}
-		Buffer = (uint8_t*)MappedMemBuffer;
-	}
-	else
-	{
-		Buffer = MemBuffer;
 	}
+	Buffer = MappedMemBuffer ? (uint8_t*)MappedMemBuffer : MemBuffer;
 	return false;
 }
 
@@ -1188,14 +1199,7 @@ void OpenGLSWFrameBuffer::Unlock()
 	else if (--m_Lock == 0)
 	{
 		Buffer = nullptr;
-
-		if (MappedMemBuffer)
-		{
-			BindFBBuffer();
-			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
-			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
-			MappedMemBuffer = nullptr;
-		}
+		MappedMemBuffer = nullptr;	// the mapping is persistent, the same buffer is used again by the next Lock
 	}
 }
 
@@ -1351,18 +1355,39 @@ bool OpenGLSWFrameBuffer::PaintToWindow()
 
 void OpenGLSWFrameBuffer::BindFBBuffer()
 {
-	int usage = UseMappedMemBuffer ? GL_DYNAMIC_DRAW : GL_STREAM_DRAW;
-
 	int pixelsize = IsBgra() ? 4 : 1;
 	int size = Width * Height * pixelsize;
 
 	if (FBTexture->Buffers[0] == 0)
 	{
+		const GLbitfield mapflags = GL_MAP_READ_BIT | GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
 		glGenBuffers(2, (GLuint*)FBTexture->Buffers);
-		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, FBTexture->Buffers[1]);
-		glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, usage);
-		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, FBTexture->Buffers[0]);
-		glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, usage);
+		for (int i = 1; i >= 0; i--)
+		{
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, FBTexture->Buffers[i]);
+			if (UseMappedMemBuffer)
+			{
+				// Client storage asks for memory the CPU can read from quickly.
+				glBufferStorage(GL_PIXEL_UNPACK_BUFFER, size, nullptr, mapflags | GL_CLIENT_STORAGE_BIT);
+				FBTexture->Mapped[i] = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, mapflags);
+				if (FBTexture->Mapped[i] == nullptr) UseMappedMemBuffer = false;
+			}
+			else
+			{
+				glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+			}
+		}
+		if (!UseMappedMemBuffer && FBTexture->Mapped[0] != FBTexture->Mapped[1])
+		{
+			// Only one of the buffers could be mapped, so copy each frame instead.
+			for (int i = 1; i >= 0; i--)
+			{
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, FBTexture->Buffers[i]);
+				if (FBTexture->Mapped[i] != nullptr) glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+				FBTexture->Mapped[i] = nullptr;
+			}
+		}
 	}
 	else
 	{
@@ -1423,9 +1448,8 @@ void OpenGLSWFrameBuffer::Draw3DPart(bool copy3d)
 				glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
 			}
 		}
-		else if (MappedMemBuffer)
+		else
 		{
-			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
 			MappedMemBuffer = nullptr;
 		}
 
@@ -1438,6 +1462,13 @@ void OpenGLSWFrameBuffer::Draw3DPart(bool copy3d)
 			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, Width, Height, GL_RED, GL_UNSIGNED_BYTE, 0);
 		glBindTexture(GL_TEXTURE_2D, oldBinding);
 
+		if (UseMappedMemBuffer)
+		{
+			int uploaded = FBTexture->CurrentBuffer ^ 1;
+			if (FBTexture->Fences[uploaded] != nullptr) glDeleteSync((GLsync)FBTexture->Fences[uploaded]);
+			FBTexture->Fences[uploaded] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		}
+
 		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 	}
 	InScene = true;
@@ -118,6 +118,8 @@ private:
 		int Texture = 0;
 		int Buffers[2];
 		int CurrentBuffer = 0;
+		void *Mapped[2] = { nullptr, nullptr };	// persistent mappings of the buffers
+		void *Fences[2] = { nullptr, nullptr };	// signaled once the GPU is done reading a buffer
 		int WrapS = 0;
 		int WrapT = 0;
 		int Format = 0;
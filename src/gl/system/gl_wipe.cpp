@@ -519,8 +519,8 @@ bool OpenGLFrameBuffer::Wiper_Burn::Run(int ticks, OpenGLFrameBuffer *fb)
 		done = (Density < 0);
 	}
 
-	if (BurnTexture != NULL) delete BurnTexture;
-	BurnTexture = new FHardwareTexture(WIDTH, HEIGHT, true);
+	// The texture is uploaded again every time, there's no need to recreate it.
+	if (BurnTexture == NULL) BurnTexture = new FHardwareTexture(WIDTH, HEIGHT, true);
 
 	// Update the burn texture with the new burn data
 	uint8_t rgb_buffer[WIDTH*HEIGHT*4];
@@ -0,0 +1,196 @@
+// 
+//---------------------------------------------------------------------------
+//
+// Copyright(C) 2004-2016 Christoph Oelckers
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//--------------------------------------------------------------------------
+//
+/*
+** gl_atlas.cpp
+** Sprite texture atlas
+**
+*/
+
+#include "gl/system/gl_system.h"
+#include "c_cvars.h"
+
+#include "gl/system/gl_interface.h"
+#include "gl/system/gl_debug.h"
+#include "gl/renderer/gl_renderer.h"
+#include "gl/textures/gl_material.h"
+#include "gl/textures/gl_samplers.h"
+#include "gl/textures/gl_translate.h"
+#include "gl/textures/gl_atlas.h"
+
+CVAR(Bool, gl_spriteatlas, false, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+CVAR(Bool, gl_2datlas, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+
+FSpriteAtlas GLSpriteAtlas;
+
+//===========================================================================
+// 
+//
+//
+//===========================================================================
+
+FSpriteAtlas::~FSpriteAtlas()
+{
+	// The GL context is gone by now so only the memory can be released.
+	for (auto page : mPages) delete page;
+}
+
+//===========================================================================
+// 
+// Creates an empty page. The sprites are uploaded into it piecemeal so
+// the format must not be a compressed one.
+//
+//===========================================================================
+
+FSpriteAtlas::Page *FSpriteAtlas::NewPage()
+{
+	Page *page = new Page;
+	page->mipdirty = true;
+	page->lastSampler = 254;
+
+	unsigned char *buffer = (unsigned char *)calloc(4, PAGE_SIZE * PAGE_SIZE);
+	glGenTextures(1, &page->glTexID);
+	glBindTexture(GL_TEXTURE_2D, page->glTexID);
+	FGLDebug::LabelObject(GL_TEXTURE, page->glTexID, "FSpriteAtlas.Page");
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, PAGE_SIZE, PAGE_SIZE, 0, GL_BGRA, GL_UNSIGNED_BYTE, buffer);
+	free(buffer);
+	FHardwareTexture::lastbound[0] = page->glTexID;
+	mPages.Push(page);
+	return page;
+}
+
+//===========================================================================
+// 
+// Places the material's base texture with the entry's translation in a
+// page. Returns false if it is too large or no page has room left, in
+// which case the material will keep using its own texture.
+//
+//===========================================================================
+
+bool FSpriteAtlas::Add(FMaterial *mat, FAtlasEntry &entry)
+{
+	int w = 0, h = 0;
+	FTexture *tex = mat->tex;
+
+	// Same translation lookup as in FGLTexture::Bind
+	int translation = entry.Translation <= 0 ? -entry.Translation : GLTranslationPalette::GetInternalTranslation(entry.Translation);
+	bool allowhires = tex->Scale.X == 1 && tex->Scale.Y == 1 && !mat->mExpanded && translation == 0;
+	unsigned char *buffer = mat->mBaseLayer->CreateTexBuffer(translation, w, h, allowhires ? tex : NULL, true);
+	if (buffer == NULL) return false;
+
+	if (w > MAX_ENTRY_SIZE || h > MAX_ENTRY_SIZE)
+	{
+		delete[] buffer;
+		return false;
+	}
+	tex->ProcessData(buffer, w, h, false);
+
+	int pw = w + 2 * PADDING;
+	int ph = h + 2 * PADDING;
+	Rect box = { 0, 0, 0, 0 };
+	unsigned pageindex;
+	for (pageindex = 0; pageindex < mPages.Size(); pageindex++)
+	{
+		box = mPages[pageindex]->Packer.Insert(pw, ph);
+		if (box.width != 0) break;
+	}
+	if (box.width == 0)
+	{
+		if (mPages.Size() >= MAX_PAGES)
+		{
+			delete[] buffer;
+			return false;
+		}
+		pageindex = mPages.Size();
+		box = NewPage()->Packer.Insert(pw, ph);
+	}
+
+	// Replicate the edge pixels into the padding so that filtering at the border
+	// behaves like the edge clamping of a standalone texture.
+	uint32_t *padded = new uint32_t[pw * ph];
+	const uint32_t *src = (const uint32_t *)buffer;
+	for (int y = 0; y < ph; y++)
+	{
+		int sy = clamp(y - PADDING, 0, h - 1);
+		for (int x = 0; x < pw; x++)
+		{
+			int sx = clamp(x - PADDING, 0, w - 1);
+			padded[y * pw + x] = src[sy * w + sx];
+		}
+	}
+	delete[] buffer;
+
+	Page *page = mPages[pageindex];
+	glBindTexture(GL_TEXTURE_2D, page->glTexID);
+	FHardwareTexture::lastbound[0] = page->glTexID;
+	glTexSubImage2D(GL_TEXTURE_2D, 0, box.x, box.y, pw, ph, GL_BGRA, GL_UNSIGNED_BYTE, padded);
+	delete[] padded;
+	page->mipdirty = true;
+	FMaterial::ClearLastTexture();
+
+	entry.Page = pageindex;
+	entry.Rect.left = float(box.x + PADDING) / PAGE_SIZE;
+	entry.Rect.top = float(box.y + PADDING) / PAGE_SIZE;
+	entry.Rect.width = float(w) / PAGE_SIZE;
+	entry.Rect.height = float(h) / PAGE_SIZE;
+	return true;
+}
+
+//===========================================================================
+// 
+//
+//
+//===========================================================================
+
+void FSpriteAtlas::Bind(int pageindex, int sampler)
+{
+	Page *page = mPages[pageindex];
+	if (FHardwareTexture::lastbound[0] != page->glTexID)
+	{
+		glBindTexture(GL_TEXTURE_2D, page->glTexID);
+		FHardwareTexture::lastbound[0] = page->glTexID;
+	}
+	if (page->mipdirty)
+	{
+		glGenerateMipmap(GL_TEXTURE_2D);
+		page->mipdirty = false;
+	}
+	if (page->lastSampler != sampler)
+		page->lastSampler = GLRenderer->mSamplerManager->Bind(0, sampler, page->lastSampler);
+}
+
+//===========================================================================
+// 
+// Releases all pages. Called whenever the hardware textures get flushed.
+//
+//===========================================================================
+
+void FSpriteAtlas::Clear()
+{
+	for (auto page : mPages)
+	{
+		if (FHardwareTexture::lastbound[0] == page->glTexID) FHardwareTexture::lastbound[0] = 0;
+		glDeleteTextures(1, &page->glTexID);
+		delete page;
+	}
+	mPages.Clear();
+	FMaterial::ResetAtlasEntries();
+}
@@ -0,0 +1,52 @@
+#ifndef __GL_ATLAS_H
+#define __GL_ATLAS_H
+
+#include "tarray.h"
+#include "SkylineBinPack.h"
+
+class FMaterial;
+struct FAtlasEntry;
+
+//===========================================================================
+// 
+// Shared texture pages for small sprites and 2D graphics, so that
+// consecutive sprites and glyphs can be drawn without rebinding the
+// texture and 2D graphics can be batched.
+//
+//===========================================================================
+
+class FSpriteAtlas
+{
+	enum
+	{
+		PAGE_SIZE = 2048,
+		MAX_PAGES = 4,
+		MAX_ENTRY_SIZE = 256,
+		PADDING = 2,
+	};
+
+	struct Page
+	{
+		unsigned int glTexID;
+		SkylineBinPack Packer;
+		bool mipdirty;
+		uint8_t lastSampler;
+
+		Page() : Packer(PAGE_SIZE, PAGE_SIZE, true) {}
+	};
+
+	TArray<Page *> mPages;
+
+	Page *NewPage();
+
+public:
+	~FSpriteAtlas();
+
+	bool Add(FMaterial *mat, FAtlasEntry &entry);
+	void Bind(int page, int sampler);
+	void Clear();
+};
+
+extern FSpriteAtlas GLSpriteAtlas;
+
+#endif
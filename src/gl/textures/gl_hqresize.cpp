@@ -39,6 +39,10 @@
 #include "gl/renderer/gl_renderer.h"
 #include "gl/textures/gl_texture.h"
 #include "c_cvars.h"
+#include "m_misc.h"
+#include "cmdlib.h"
+#include "md5.h"
+#include "files.h"
 #include "gl/hqnx/hqx.h"
 #ifdef HAVE_MMX
 #include "gl/hqnx_asm/hqnx_asm.h"
@@ -47,6 +51,8 @@
 #include "gl/xbr/xbrz_old.h"
 
 #include "parallel_for.h"
+#include <zlib.h>
+#include <thread>
 
 EXTERN_CVAR(Int, gl_texture_hqresizemult)
 CUSTOM_CVAR(Int, gl_texture_hqresizemode, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG | CVAR_NOINITCALL)
@@ -97,6 +103,7 @@ CUSTOM_CVAR(Int, gl_texture_hqresize_mt_height, 4, CVAR_ARCHIVE | CVAR_GLOBALCON
 }
 
 CVAR(Int, xbrz_colorformat, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+CVAR(Bool, gl_texture_hqresize_diskcache, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
 
 static void xbrzApplyOptions()
 {
@@ -285,14 +292,6 @@ static unsigned char *hqNxAsmHelper( void (*hqNxFunction) ( int*, unsigned char*
 	outWidth = N * inWidth;
 	outHeight = N *inHeight;
 
-	static int initdone = false;
-
-	if (!initdone)
-	{
-		HQnX_asm::InitLUTs();
-		initdone = true;
-	}
-
 	HQnX_asm::CImage cImageIn;
 	cImageIn.SetImage(inputBuffer, inWidth, inHeight, 32);
 	cImageIn.Convert32To17();
@@ -312,13 +311,6 @@ static unsigned char *hqNxHelper( void (HQX_CALLCONV *hqNxFunction) ( unsigned*,
 							  int &outWidth,
 							  int &outHeight )
 {
-	static int initdone = false;
-
-	if (!initdone)
-	{
-		hqxInit();
-		initdone = true;
-	}
 	outWidth = N * inWidth;
 	outHeight = N *inHeight;
 
@@ -401,12 +393,183 @@ static void xbrzOldScale(size_t factor, const uint32_t* src, uint32_t* trg, int
 }
 
 
+//===========================================================================
+// 
+// Runs the selected upscaler. Returns inputBuffer unchanged if the mode
+// does not apply.
+//
+//===========================================================================
+
+static unsigned char *UpscaleBuffer(int type, int mult, unsigned char *inputBuffer, const int inWidth, const int inHeight, int &outWidth, int &outHeight)
+{
+	switch (type)
+	{
+	case 1:
+		switch(mult)
+		{
+		case 2:
+			return scaleNxHelper( &scale2x, 2, inputBuffer, inWidth, inHeight, outWidth, outHeight );
+		case 3:
+			return scaleNxHelper( &scale3x, 3, inputBuffer, inWidth, inHeight, outWidth, outHeight );
+		default:
+			return scaleNxHelper( &scale4x, 4, inputBuffer, inWidth, inHeight, outWidth, outHeight );
+		}
+	case 2:
+		switch(mult)
+		{
+		case 2:
+			return hqNxHelper( &hq2x_32, 2, inputBuffer, inWidth, inHeight, outWidth, outHeight );
+		case 3:
+			return hqNxHelper( &hq3x_32, 3, inputBuffer, inWidth, inHeight, outWidth, outHeight );
+		default:
+			return hqNxHelper( &hq4x_32, 4, inputBuffer, inWidth, inHeight, outWidth, outHeight );
+		}
+#ifdef HAVE_MMX
+	case 3:
+		switch(mult)
+		{
+		case 2:
+			return hqNxAsmHelper( &HQnX_asm::hq2x_32, 2, inputBuffer, inWidth, inHeight, outWidth, outHeight );
+		case 3:
+			return hqNxAsmHelper( &HQnX_asm::hq3x_32, 3, inputBuffer, inWidth, inHeight, outWidth, outHeight );
+		default:
+			return hqNxAsmHelper( &HQnX_asm::hq4x_32, 4, inputBuffer, inWidth, inHeight, outWidth, outHeight );
+		}
+#endif
+	case 4:
+		return xbrzHelper(xbrz::scale, mult, inputBuffer, inWidth, inHeight, outWidth, outHeight );
+	case 5:			
+		return xbrzHelper(xbrzOldScale, mult, inputBuffer, inWidth, inHeight, outWidth, outHeight );
+	case 6:
+		return normalNx(mult, inputBuffer, inWidth, inHeight, outWidth, outHeight );
+	}	return inputBuffer;
+}
+
+//===========================================================================
+// 
+// Disk cache for upscaled textures
+//
+// The key is a hash of the source pixels together with everything that
+// affects the scaler's output, so changing the mode, the multiplier or the
+// xBRZ options simply misses and creates a new entry.
+//
+//===========================================================================
+
+static const char HQCacheMagic[4] = { 'H', 'Q', 'C', '1' };
+
+// This runs on the precacher's worker threads, so the directory is set up only once.
+static const FString &HQCacheDir()
+{
+	static const FString dir = []()
+	{
+		FString path = M_GetCachePath(true);
+		path << "/hqresize";
+		CreatePath(path);
+		return path;
+	}();
+	return dir;
+}
+
+static FString HQCacheName(int type, int mult, const unsigned char *inputBuffer, int inWidth, int inHeight)
+{
+	int32_t params[5] = { type, mult, inWidth, inHeight, xbrz_colorformat };
+	float xbrzparams[5] = { xbrz_luminanceweight, xbrz_equalcolortolerance, xbrz_centerdirectionbias, xbrz_dominantdirectionthreshold, xbrz_steepdirectionthreshold };
+
+	uint8_t digest[16];
+	MD5Context md5;
+	md5.Update((const uint8_t *)params, sizeof(params));
+	if (type == 4 || type == 5) md5.Update((const uint8_t *)xbrzparams, sizeof(xbrzparams));
+	md5.Update(inputBuffer, inWidth * inHeight * 4);
+	md5.Final(digest);
+
+	FString path = HQCacheDir();
+	path << '/';
+	for (int i = 0; i < 16; i++)
+	{
+		path.AppendFormat("%02x", digest[i]);
+	}
+	path << ".hqc";
+	return path;
+}
+
+static unsigned char *LoadCachedUpscale(const FString &path, int inWidth, int inHeight, int &width, int &height)
+{
+	FileReader fr;
+	if (!fr.OpenFile(path)) return nullptr;
+
+	char magic[4];
+	if (fr.Read(magic, 4) != 4 || memcmp(magic, HQCacheMagic, 4) != 0) return nullptr;
+	width = fr.ReadUInt32();
+	height = fr.ReadUInt32();
+	if (width < inWidth || height < inHeight || width > inWidth * 6 || height > inHeight * 6) return nullptr;
+
+	uint32_t complen = fr.ReadUInt32();
+	if (complen == 0 || complen > (uint32_t)fr.GetLength() - 16) return nullptr;
+
+	TArray<Bytef> compressed(complen, true);
+	if (fr.Read(compressed.Data(), complen) != complen) return nullptr;
+
+	uLongf outlen = width * height * 4;
+	unsigned char *buffer = new unsigned char[outlen];
+	if (uncompress(buffer, &outlen, compressed.Data(), complen) != Z_OK || outlen != (uLongf)width * height * 4)
+	{
+		delete[] buffer;
+		return nullptr;
+	}
+	return buffer;
+}
+
+static void SaveCachedUpscale(const FString &path, const unsigned char *buffer, int width, int height)
+{
+	uLong srclen = width * height * 4;
+	uLongf complen = compressBound(srclen);
+	TArray<Bytef> compressed(complen + 16, true);
+	if (compress2(compressed.Data() + 16, &complen, buffer, srclen, Z_BEST_SPEED) != Z_OK) return;
+
+	uint32_t header[3] = { LittleLong(uint32_t(width)), LittleLong(uint32_t(height)), LittleLong(uint32_t(complen)) };
+	memcpy(compressed.Data(), HQCacheMagic, 4);
+	memcpy(compressed.Data() + 4, header, 12);
+
+	// Write to a per-thread temporary first so that two threads scaling identical textures cannot produce a torn entry.
+	FString temppath;
+	temppath.Format("%s.%zx", path.GetChars(), std::hash<std::thread::id>()(std::this_thread::get_id()));
+	FileWriter *fw = FileWriter::Open(temppath);
+	if (fw != nullptr)
+	{
+		const size_t length = complen + 16;
+		bool ok = fw->Write(compressed.Data(), length) == length;
+		delete fw;
+		if (!ok || rename(temppath, path) != 0) remove(temppath);
+	}
+}
+
 //===========================================================================
 // 
 // [BB] Upsamples the texture in inputBuffer, frees inputBuffer and returns
 //  the upsampled buffer.
 //
 //===========================================================================
+//===========================================================================
+// 
+// One-time setup of the lookup tables. This is done before any upsampling
+// starts so that the scalers can safely run on multiple threads.
+//
+//===========================================================================
+
+void gl_InitUpsamplers()
+{
+	static bool initdone = false;
+
+	if (!initdone)
+	{
+		hqxInit();
+#ifdef HAVE_MMX
+		HQnX_asm::InitLUTs();
+#endif
+		initdone = true;
+	}
+}
+
 unsigned char *gl_CreateUpsampledTextureBuffer ( const FTexture *inputTexture, unsigned char *inputBuffer, const int inWidth, const int inHeight, int &outWidth, int &outHeight, bool hasAlpha )
 {
 	// [BB] Make sure that outWidth and outHeight denote the size of
@@ -449,6 +612,7 @@ unsigned char *gl_CreateUpsampledTextureBuffer ( const FTexture *inputTexture, u
 
 	if (inputBuffer)
 	{
+		gl_InitUpsamplers();
 		int type = gl_texture_hqresizemode;
 		int mult = gl_texture_hqresizemult;
 		outWidth = inWidth;
@@ -463,47 +627,27 @@ unsigned char *gl_CreateUpsampledTextureBuffer ( const FTexture *inputTexture, u
 		if (mult < 2)
 			type = 0;
 
-		switch (type)
+		FString cachename;
+		if (gl_texture_hqresize_diskcache && type != 0)
 		{
-		case 1:
-			switch(mult)
+			cachename = HQCacheName(type, mult, inputBuffer, inWidth, inHeight);
+			int cachedWidth, cachedHeight;
+			unsigned char *cached = LoadCachedUpscale(cachename, inWidth, inHeight, cachedWidth, cachedHeight);
+			if (cached != nullptr)
 			{
-			case 2:
-				return scaleNxHelper( &scale2x, 2, inputBuffer, inWidth, inHeight, outWidth, outHeight );
-			case 3:
-				return scaleNxHelper( &scale3x, 3, inputBuffer, inWidth, inHeight, outWidth, outHeight );
-			default:
-				return scaleNxHelper( &scale4x, 4, inputBuffer, inWidth, inHeight, outWidth, outHeight );
+				delete[] inputBuffer;
+				outWidth = cachedWidth;
+				outHeight = cachedHeight;
+				return cached;
 			}
-		case 2:
-			switch(mult)
-			{
-			case 2:
-				return hqNxHelper( &hq2x_32, 2, inputBuffer, inWidth, inHeight, outWidth, outHeight );
-			case 3:
-				return hqNxHelper( &hq3x_32, 3, inputBuffer, inWidth, inHeight, outWidth, outHeight );
-			default:
-				return hqNxHelper( &hq4x_32, 4, inputBuffer, inWidth, inHeight, outWidth, outHeight );
-			}
-#ifdef HAVE_MMX
-		case 3:
-			switch(mult)
-			{
-			case 2:
-				return hqNxAsmHelper( &HQnX_asm::hq2x_32, 2, inputBuffer, inWidth, inHeight, outWidth, outHeight );
-			case 3:
-				return hqNxAsmHelper( &HQnX_asm::hq3x_32, 3, inputBuffer, inWidth, inHeight, outWidth, outHeight );
-			default:
-				return hqNxAsmHelper( &HQnX_asm::hq4x_32, 4, inputBuffer, inWidth, inHeight, outWidth, outHeight );
-			}
-#endif
-		case 4:
-			return xbrzHelper(xbrz::scale, mult, inputBuffer, inWidth, inHeight, outWidth, outHeight );
-		case 5:			
-			return xbrzHelper(xbrzOldScale, mult, inputBuffer, inWidth, inHeight, outWidth, outHeight );
-		case 6:
-			return normalNx(mult, inputBuffer, inWidth, inHeight, outWidth, outHeight );
 		}
+
+		unsigned char *outputBuffer = UpscaleBuffer(type, mult, inputBuffer, inWidth, inHeight, outWidth, outHeight);
+		if (outputBuffer != inputBuffer && cachename.IsNotEmpty())
+		{
+			SaveCachedUpscale(cachename, outputBuffer, outWidth, outHeight);
+		}
+		return outputBuffer;
 	}
 	return inputBuffer;
 }
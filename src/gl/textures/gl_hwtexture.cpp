@@ -32,6 +32,7 @@
 #include "c_cvars.h"
 #include "c_dispatch.h"
 #include "v_palette.h"
+#include "stats.h"
 
 #include "gl/system/gl_interface.h"
 #include "gl/system/gl_cvars.h"
@@ -43,6 +44,8 @@
 extern TexFilter_s TexFilter[];
 extern int TexFormat[];
 
+CVAR(Int, gl_texture_budget, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)	// in MB, 0 means unlimited
+
 
 //===========================================================================
 // 
@@ -50,6 +53,10 @@ extern int TexFormat[];
 //
 //===========================================================================
 unsigned int FHardwareTexture::lastbound[FHardwareTexture::MAX_TEXTURES];
+int FHardwareTexture::CurrentFrame;
+size_t FHardwareTexture::ResidentBytes;
+unsigned int FHardwareTexture::BindHits, FHardwareTexture::BindMisses, FHardwareTexture::Reloads, FHardwareTexture::Evictions;
+TArray<FHardwareTexture *> FHardwareTexture::EvictableTextures;
 
 //===========================================================================
 // 
@@ -172,6 +179,12 @@ unsigned int FHardwareTexture::CreateTexture(unsigned char * buffer, int w, int
 	}
 	TranslatedTexture * glTex=GetTexID(translation);
 	if (glTex->glTexID==0) glGenTextures(1,&glTex->glTexID);
+	if (glTex->evicted)
+	{
+		Reloads++;
+		glTex->evicted = false;
+	}
+	glTex->lastframe = CurrentFrame;
 	if (texunit != 0) glActiveTexture(GL_TEXTURE0+texunit);
 	glBindTexture(GL_TEXTURE_2D, glTex->glTexID);
 	FGLDebug::LabelObject(GL_TEXTURE, glTex->glTexID, name);
@@ -211,11 +224,14 @@ unsigned int FHardwareTexture::CreateTexture(unsigned char * buffer, int w, int
 
 	if (deletebuffer) free(buffer);
 
+	size_t bytes = size_t(rw) * rh * 4;
 	if (mipmap && TexFilter[gl_texture_filter].mipmapping)
 	{
 		glGenerateMipmap(GL_TEXTURE_2D);
 		glTex->mipmapped = true;
+		bytes += bytes / 3;
 	}
+	glTex->SetSize(bytes);
 
 	if (texunit != 0) glActiveTexture(GL_TEXTURE0);
 	return glTex->glTexID;
@@ -236,6 +252,9 @@ FHardwareTexture::FHardwareTexture(int _width, int _height, bool nocompression)
 	glDefTex.glTexID = 0;
 	glDefTex.translation = 0;
 	glDefTex.mipmapped = false;
+	glDefTex.evicted = false;
+	glDefTex.lastframe = 0;
+	glDefTex.bytes = 0;
 	glDepthID = 0;
 }
 
@@ -259,9 +278,17 @@ void FHardwareTexture::TranslatedTexture::Delete()
 		glDeleteTextures(1, &glTexID);
 		glTexID = 0;
 		mipmapped = false;
+		SetSize(0);
 	}
 }
 
+void FHardwareTexture::TranslatedTexture::SetSize(size_t newbytes)
+{
+	ResidentBytes += newbytes - bytes;
+	M_TrackMemory(MEMTAG_TEXTURES, ptrdiff_t(newbytes) - ptrdiff_t(bytes));
+	bytes = newbytes;
+}
+
 //===========================================================================
 // 
 //	Frees all associated resources
@@ -315,6 +342,77 @@ void FHardwareTexture::CleanUnused(SpriteHits &usedtranslations)
 FHardwareTexture::~FHardwareTexture() 
 { 
 	Clean(true); 
+	if (evictableIndex >= 0)
+	{
+		FHardwareTexture *last = EvictableTextures.Last();
+		EvictableTextures[evictableIndex] = last;
+		last->evictableIndex = evictableIndex;
+		EvictableTextures.Pop();
+	}
+}
+
+//===========================================================================
+// 
+//	Registers this texture with the residency manager. Its translations may
+//	then be deleted when over budget; the next Bind fails and the owner
+//	recreates the texture from its source.
+//
+//===========================================================================
+
+void FHardwareTexture::SetEvictable()
+{
+	if (evictableIndex < 0)
+	{
+		evictableIndex = EvictableTextures.Push(this);
+	}
+}
+
+//===========================================================================
+// 
+//	Called once per frame. When the resident textures exceed gl_texture_budget
+//	the ones that were least recently bound get deleted until usage is below
+//	90% of the budget. Textures bound in the current or previous frame are
+//	always kept.
+//
+//===========================================================================
+
+void FHardwareTexture::EndFrame()
+{
+	CurrentFrame++;
+
+	const size_t budget = size_t(MAX<int>(gl_texture_budget, 0)) << 20;
+	if (budget == 0 || ResidentBytes <= budget) return;
+
+	TArray<TranslatedTexture *> candidates;
+	for (auto hwtex : EvictableTextures)
+	{
+		auto check = [&](TranslatedTexture *t)
+		{
+			if (t->glTexID != 0 && t->lastframe < CurrentFrame - 1) candidates.Push(t);
+		};
+		check(&hwtex->glDefTex);
+		for (auto &t : hwtex->glTex_Translated) check(&t);
+	}
+	std::sort(candidates.begin(), candidates.end(), [](TranslatedTexture *a, TranslatedTexture *b) { return a->lastframe < b->lastframe; });
+
+	const size_t target = budget - budget / 10;
+	for (auto t : candidates)
+	{
+		if (ResidentBytes <= target) break;
+		t->Delete();
+		t->evicted = true;
+		Evictions++;
+	}
+}
+
+ADD_STAT(texresidency)
+{
+	FString out;
+	unsigned int binds = FHardwareTexture::BindHits + FHardwareTexture::BindMisses;
+	out.Format("Resident: %zu MB, budget: %d MB, bind hit rate: %.1f%%, reloads: %u, evictions: %u",
+		FHardwareTexture::ResidentBytes >> 20, *gl_texture_budget, binds ? 100. * FHardwareTexture::BindHits / binds : 100.,
+		FHardwareTexture::Reloads, FHardwareTexture::Evictions);
+	return out;
 }
 
 
@@ -345,6 +443,9 @@ FHardwareTexture::TranslatedTexture *FHardwareTexture::GetTexID(int translation)
 	glTex_Translated[add].translation = translation;
 	glTex_Translated[add].glTexID = 0;
 	glTex_Translated[add].mipmapped = false;
+	glTex_Translated[add].evicted = false;
+	glTex_Translated[add].lastframe = 0;
+	glTex_Translated[add].bytes = 0;
 	return &glTex_Translated[add];
 }
 
@@ -359,7 +460,10 @@ unsigned int FHardwareTexture::Bind(int texunit, int translation, bool needmipma
 
 	if (pTex->glTexID != 0)
 	{
+		BindHits++;
+		pTex->lastframe = CurrentFrame;
 		if (lastbound[texunit] == pTex->glTexID) return pTex->glTexID;
+		gl_CheckPendingDraws();
 		lastbound[texunit] = pTex->glTexID;
 		if (texunit != 0) glActiveTexture(GL_TEXTURE0 + texunit);
 		glBindTexture(GL_TEXTURE_2D, pTex->glTexID);
@@ -368,10 +472,12 @@ unsigned int FHardwareTexture::Bind(int texunit, int translation, bool needmipma
 		{
 			glGenerateMipmap(GL_TEXTURE_2D);
 			pTex->mipmapped = true;
+			pTex->SetSize(pTex->bytes + pTex->bytes / 3);
 		}
 		if (texunit != 0) glActiveTexture(GL_TEXTURE0);
 		return pTex->glTexID;
 	}
+	BindMisses++;
 	return 0;
 }
 
@@ -385,6 +491,7 @@ void FHardwareTexture::Unbind(int texunit)
 {
 	if (lastbound[texunit] != 0)
 	{
+		gl_CheckPendingDraws();
 		if (texunit != 0) glActiveTexture(GL_TEXTURE0+texunit);
 		glBindTexture(GL_TEXTURE_2D, 0);
 		if (texunit != 0) glActiveTexture(GL_TEXTURE0);
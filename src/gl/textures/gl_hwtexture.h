@@ -42,8 +42,12 @@ private:
 		unsigned int glTexID;
 		int translation;
 		bool mipmapped;
+		bool evicted;
+		int lastframe;
+		size_t bytes;
 
 		void Delete();
+		void SetSize(size_t newbytes);
 	};
 
 public:
@@ -58,10 +62,19 @@ public:
 
 	static void InitGlobalState() { for (int i = 0; i < MAX_TEXTURES; i++) lastbound[i] = 0; }
 
+	// Residency tracking. Only textures that can be recreated from their source on demand are evictable.
+	static int CurrentFrame;
+	static size_t ResidentBytes;
+	static unsigned int BindHits, BindMisses, Reloads, Evictions;
+	static void EndFrame();
+
 private:
 
+	static TArray<FHardwareTexture *> EvictableTextures;
+
 	short texwidth, texheight;
 	bool forcenocompression;
+	int evictableIndex = -1;
 
 	TranslatedTexture glDefTex;
 	TArray<TranslatedTexture> glTex_Translated;
@@ -87,6 +100,7 @@ public:
 
 	void Clean(bool all);
 	void CleanUnused(SpriteHits &usedtranslations);
+	void SetEvictable();
 };
 
 #endif
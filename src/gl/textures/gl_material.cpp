@@ -47,14 +47,24 @@
 #include "gl/textures/gl_translate.h"
 #include "gl/textures/gl_material.h"
 #include "gl/textures/gl_samplers.h"
+#include "gl/textures/gl_atlas.h"
 #include "gl/shaders/gl_shader.h"
 
+#include <mutex>
+
 EXTERN_CVAR(Bool, gl_render_precise)
 EXTERN_CVAR(Int, gl_lightmode)
 EXTERN_CVAR(Bool, gl_precache)
 EXTERN_CVAR(Bool, gl_texture_usehires)
+EXTERN_CVAR(Bool, gl_spriteatlas)
+EXTERN_CVAR(Bool, gl_2datlas)
 
 extern TArray<UserShaderDesc> usershaders;
+extern int currentrenderer;
+
+// Frees a texture's software pixel buffers once it has been uploaded. They get
+// recreated on demand if the software renderer or a pixel query needs them.
+CVAR(Bool, gl_unloadsoftwarepixels, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 
 //===========================================================================
 //
@@ -80,6 +90,7 @@ FGLTexture::FGLTexture(FTexture * tx, bool expandpatches)
 	bExpandFlag = expandpatches;
 	lastSampler = 254;
 	lastTranslation = -1;
+	mPreparedBuffer = nullptr;
 	tex->gl_info.SystemTexture[expandpatches] = this;
 }
 
@@ -154,6 +165,7 @@ unsigned char *FGLTexture::LoadHiresTexture(FTexture *tex, int *width, int *heig
 
 void FGLTexture::Clean(bool all)
 {
+	if (all) DiscardPrepared();
 	if (mHwTexture != nullptr) 
 	{
 		if (!all) mHwTexture->Clean(false);
@@ -186,11 +198,12 @@ void FGLTexture::CleanUnused(SpriteHits &usedtranslations)
 //
 //===========================================================================
 
-unsigned char * FGLTexture::CreateTexBuffer(int translation, int & w, int & h, FTexture *hirescheck, bool createexpanded, bool alphatrans)
+unsigned char * FGLTexture::DecodeTexBuffer(int translation, int & w, int & h, FTexture *hirescheck, bool createexpanded, bool alphatrans, int &isTransparent, bool &ishires)
 {
 	unsigned char * buffer;
 	int W, H;
-	int isTransparent = -1;
+	isTransparent = -1;
+	ishires = false;
 
 
 	// Textures that are already scaled in the texture lump will not get replaced
@@ -200,6 +213,7 @@ unsigned char * FGLTexture::CreateTexBuffer(int translation, int & w, int & h, F
 		buffer = LoadHiresTexture (hirescheck, &w, &h);
 		if (buffer)
 		{
+			ishires = true;
 			return buffer;
 		}
 	}
@@ -245,13 +259,53 @@ unsigned char * FGLTexture::CreateTexBuffer(int translation, int & w, int & h, F
 		isTransparent = 0;
 		// This is not conclusive for setting the texture's transparency info.
 	}
+	return buffer;
+}
+
+unsigned char * FGLTexture::CreateTexBuffer(int translation, int & w, int & h, FTexture *hirescheck, bool createexpanded, bool alphatrans)
+{
+	int isTransparent;
+	bool ishires;
+	unsigned char * buffer = DecodeTexBuffer(translation, w, h, hirescheck, createexpanded, alphatrans, isTransparent, ishires);
 
 	// if we just want the texture for some checks there's no need for upsampling.
-	if (!createexpanded) return buffer;
+	if (ishires || !createexpanded) return buffer;
 
 	// [BB] The hqnx upsampling (not the scaleN one) destroys partial transparency, don't upsamle textures using it.
 	// [BB] Potentially upsample the buffer.
-	return gl_CreateUpsampledTextureBuffer ( tex, buffer, W, H, w, h, !!isTransparent);
+	return gl_CreateUpsampledTextureBuffer ( tex, buffer, w, h, w, h, !!isTransparent);
+}
+
+//===========================================================================
+// 
+//	Texture preparation for the precacher. The decoding has to be done
+//	on the main thread but the upsampling can run on any thread.
+//
+//===========================================================================
+
+bool FGLTexture::BeginPrepare(FTexture *hirescheck)
+{
+	if (mPreparedBuffer != nullptr || mHwTexture != nullptr || tex->bHasCanvas) return false;
+
+	bool ishires;
+	mPreparedBuffer = DecodeTexBuffer(0, mPreparedWidth, mPreparedHeight, hirescheck, true, false, mPreparedTransparent, ishires);
+	mPreparedUpsampled = ishires;
+	return !ishires;
+}
+
+void FGLTexture::FinishPrepare()
+{
+	if (mPreparedBuffer != nullptr && !mPreparedUpsampled)
+	{
+		mPreparedBuffer = gl_CreateUpsampledTextureBuffer(tex, mPreparedBuffer, mPreparedWidth, mPreparedHeight, mPreparedWidth, mPreparedHeight, !!mPreparedTransparent);
+		mPreparedUpsampled = true;
+	}
+}
+
+void FGLTexture::DiscardPrepared()
+{
+	delete[] mPreparedBuffer;
+	mPreparedBuffer = nullptr;
 }
 
 
@@ -267,6 +321,8 @@ FHardwareTexture *FGLTexture::CreateHwTexture()
 	if (mHwTexture == NULL)
 	{
 		mHwTexture = new FHardwareTexture(tex->GetWidth() + bExpandFlag*2, tex->GetHeight() + bExpandFlag*2, tex->gl_info.bNoCompress);
+		// Canvas textures cannot be recreated from a source so they stay resident.
+		if (!tex->bHasCanvas) mHwTexture->SetEvictable();
 	}
 	return mHwTexture; 
 }
@@ -310,7 +366,7 @@ const FHardwareTexture *FGLTexture::Bind(int texunit, int clampmode, int transla
 		// Bind it to the system.
 		if (!hwtex->Bind(texunit, translation, needmipmap))
 		{
-			
+			uint64_t hitchstart = FHitchLog::Start();
 			int w=0, h=0;
 
 			// Create this texture
@@ -318,7 +374,15 @@ const FHardwareTexture *FGLTexture::Bind(int texunit, int clampmode, int transla
 			
 			if (!tex->bHasCanvas)
 			{
-				buffer = CreateTexBuffer(translation, w, h, hirescheck, true, alphatrans);
+				if (mPreparedBuffer != nullptr && mPreparedUpsampled && translation == 0 && !alphatrans)
+				{
+					// already created by the precacher.
+					buffer = mPreparedBuffer;
+					w = mPreparedWidth;
+					h = mPreparedHeight;
+					mPreparedBuffer = nullptr;
+				}
+				else buffer = CreateTexBuffer(translation, w, h, hirescheck, true, alphatrans);
 				if (tex->bWarped && gl.legacyMode && w*h <= 256*256)	// do not software-warp larger textures, especially on the old systems that still need this fallback.
 				{
 					// need to do software warping
@@ -338,6 +402,13 @@ const FHardwareTexture *FGLTexture::Bind(int texunit, int clampmode, int transla
 				return NULL;
 			}
 			delete[] buffer;
+			if (hitchstart) FHitchLog::Note(hitchstart, "Texture", "%s (%dx%d)", tex->Name.GetChars(), w, h);
+
+			// Warped textures in legacy mode get rebuilt from their pixels every frame.
+			if (gl_unloadsoftwarepixels && currentrenderer == 1 && !tex->bHasCanvas && (!tex->bWarped || !gl.legacyMode))
+			{
+				tex->Unload();
+			}
 		}
 		if (tex->bHasCanvas) static_cast<FCanvasTexture*>(tex)->NeedUpdate();
 		if (translation != lastTranslation) lastSampler = 254;
@@ -374,6 +445,7 @@ FGLTexture * FMaterial::ValidateSysTexture(FTexture * tex, bool expand)
 //
 //===========================================================================
 TArray<FMaterial *> FMaterial::mMaterials;
+unsigned int FMaterial::Generation;
 int FMaterial::mMaxBound;
 
 FMaterial::FMaterial(FTexture * tx, bool expanded)
@@ -524,6 +596,7 @@ FMaterial::FMaterial(FTexture * tx, bool expanded)
 
 FMaterial::~FMaterial()
 {
+	Generation++;
 	for(unsigned i=0;i<mMaterials.Size();i++)
 	{
 		if (mMaterials[i]==this) 
@@ -655,10 +728,23 @@ void FMaterial::Bind(int clampmode, int translation)
 	
 	// avoid rebinding the same texture multiple times.
 	if (this == last && lastclamp == clampmode && translation == lasttrans) return;
+	gl_CheckPendingDraws();
 	last = this;
 	lastclamp = clampmode;
 	lasttrans = translation;
 
+	if (clampmode == CLAMP_ATLAS || clampmode == CLAMP_ATLAS_NOMIP)
+	{
+		auto entry = mAtlasEntries.FindEx([=](const FAtlasEntry &e) { return e.Translation == translation; });
+		GLSpriteAtlas.Bind(mAtlasEntries[entry].Page, clampmode == CLAMP_ATLAS ? CLAMP_XY : CLAMP_XY_NOMIP);
+		for (int i = 1; i <= mMaxBound; i++)
+		{
+			FHardwareTexture::Unbind(i);
+		}
+		mMaxBound = 0;
+		return;
+	}
+
 	int usebright = false;
 	int maxbound = 0;
 	bool allowhires = tex->Scale.X == 1 && tex->Scale.Y == 1 && clampmode <= CLAMP_XY && !mExpanded;
@@ -692,6 +778,37 @@ void FMaterial::Bind(int clampmode, int translation)
 }
 
 
+//===========================================================================
+//
+// Checks whether this material can be drawn from the sprite atlas and
+// puts it there if it isn't yet. Plain sprites qualify untranslated, 2D
+// graphics like font glyphs also with a translation. Everything else
+// needs its own texture and sampler state.
+//
+//===========================================================================
+
+const FAtlasEntry *FMaterial::UseAtlas(int translation, int overrideshader, bool for2d)
+{
+	if (gl.legacyMode || overrideshader >= 0) return nullptr;
+	if (for2d ? !gl_2datlas : (!gl_spriteatlas || translation != 0 || tex->UseType != ETextureType::Sprite)) return nullptr;
+	if (tex->bHasCanvas || tex->bWarped) return nullptr;
+	if (mShaderIndex != SHADER_Default || mTextureLayers.Size() > 0) return nullptr;
+
+	auto index = mAtlasEntries.FindEx([=](const FAtlasEntry &e) { return e.Translation == translation; });
+	if (index == mAtlasEntries.Size())
+	{
+		FAtlasEntry entry = { translation, -1, { 0, 0, 0, 0 } };
+		GLSpriteAtlas.Add(this, entry);
+		mAtlasEntries.Push(entry);
+	}
+	return mAtlasEntries[index].Page >= 0 ? &mAtlasEntries[index] : nullptr;
+}
+
+void FMaterial::ResetAtlasEntries()
+{
+	for (auto mat : mMaterials) mat->mAtlasEntries.Clear();
+}
+
 //===========================================================================
 //
 //
@@ -702,6 +819,21 @@ void FMaterial::Precache()
 	Bind(0, 0);
 }
 
+//===========================================================================
+//
+// Decodes the base layer the same way Precache would so that the
+// upsampling can be done in parallel for a batch of textures.
+// Returns the layer if it still needs to be upsampled.
+//
+//===========================================================================
+
+FGLTexture *FMaterial::PrepareBaseLayer()
+{
+	bool allowhires = tex->Scale.X == 1 && tex->Scale.Y == 1 && !mExpanded;
+	if (mBaseLayer->BeginPrepare(allowhires ? tex : NULL)) return mBaseLayer;
+	return nullptr;
+}
+
 //===========================================================================
 //
 //
@@ -760,6 +892,8 @@ void FMaterial::BindToFrameBuffer()
 //
 //==========================================================================
 
+static std::mutex ValidateMutex;	// the sprite worker threads of the BSP pass may get here at the same time.
+
 FMaterial * FMaterial::ValidateTexture(FTexture * tex, bool expand)
 {
 again:
@@ -770,6 +904,11 @@ again:
 		FMaterial *gltex = tex->gl_info.Material[expand];
 		if (gltex == NULL) 
 		{
+			std::lock_guard<std::mutex> lock(ValidateMutex);
+			if (tex->gl_info.bNoExpand && expand) goto again;
+			gltex = tex->gl_info.Material[expand];
+			if (gltex != NULL) return gltex;
+
 			if (expand)
 			{
 				if (tex->bWarped || tex->bHasCanvas || tex->gl_info.shaderindex >= FIRST_USER_SHADER)
@@ -808,6 +947,8 @@ FMaterial * FMaterial::ValidateTexture(FTextureID no, bool expand, bool translat
 
 void FMaterial::FlushAll()
 {
+	Generation++;
+	GLSpriteAtlas.Clear();
 	for(int i=mMaterials.Size()-1;i>=0;i--)
 	{
 		mMaterials[i]->Clean(true);
@@ -23,6 +23,28 @@ enum
 	CLAMP_XY_NOMIP = 4,
 	CLAMP_NOFILTER = 5,
 	CLAMP_CAMTEX = 6,
+	CLAMP_ATLAS = 7,	// CLAMP_XY from the sprite atlas. Never passed to the sampler manager.
+	CLAMP_ATLAS_NOMIP = 8,	// CLAMP_XY_NOMIP from the sprite atlas, for 2D
+};
+
+//===========================================================================
+//
+// Where a material is in the sprite atlas, one for each translation
+//
+//===========================================================================
+
+struct FAtlasEntry
+{
+	int Translation;
+	int Page;			// -1: does not fit.
+	FloatRect Rect;
+
+	// Maps texture coordinates of the material into its atlas page.
+	void Map(float &u, float &v) const
+	{
+		u = Rect.left + u * Rect.width;
+		v = Rect.top + v * Rect.height;
+	}
 };
 
 
@@ -51,6 +73,12 @@ private:
 	uint8_t lastSampler;
 	int lastTranslation;
 
+	// decoded and upsampled in advance by the precacher
+	unsigned char * mPreparedBuffer;
+	int mPreparedWidth, mPreparedHeight;
+	int mPreparedTransparent;
+	bool mPreparedUpsampled;
+
 	unsigned char * LoadHiresTexture(FTexture *hirescheck, int *width, int *height);
 
 	FHardwareTexture *CreateHwTexture();
@@ -61,8 +89,13 @@ public:
 	FGLTexture(FTexture * tx, bool expandpatches);
 	~FGLTexture();
 
+	unsigned char * DecodeTexBuffer(int translation, int & w, int & h, FTexture *hirescheck, bool createexpanded, bool alphatrans, int &isTransparent, bool &ishires);
 	unsigned char * CreateTexBuffer(int translation, int & w, int & h, FTexture *hirescheck, bool createexpanded = true, bool alphatrans = false);
 
+	bool BeginPrepare(FTexture *hirescheck);
+	void FinishPrepare();
+	void DiscardPrepared();
+
 	void Clean(bool all);
 	void CleanUnused(SpriteHits &usedtranslations);
 	int Dump(int i);
@@ -78,6 +111,7 @@ public:
 class FMaterial
 {
 	friend class FRenderState;
+	friend class FSpriteAtlas;
 
 	struct FTextureLayer
 	{
@@ -103,6 +137,8 @@ class FMaterial
 	float mSpriteU[2], mSpriteV[2];
 	FloatRect mSpriteRect;
 
+	TArray<FAtlasEntry> mAtlasEntries;
+
 	FGLTexture * ValidateSysTexture(FTexture * tex, bool expand);
 	bool TrimBorders(int *rect);
 
@@ -113,6 +149,7 @@ public:
 	~FMaterial();
 	void Precache();
 	void PrecacheList(SpriteHits &translations);
+	FGLTexture *PrepareBaseLayer();
 	bool isMasked() const
 	{
 		return mBaseLayer->tex->bMasked;
@@ -124,6 +161,7 @@ public:
 	}
 
 	void Bind(int clamp, int translation);
+	const FAtlasEntry *UseAtlas(int translation, int overrideshader, bool for2d = false);
 
 	unsigned char * CreateTexBuffer(int translation, int & w, int & h, bool allowhires=true, bool createexpanded = true) const
 	{
@@ -248,6 +286,11 @@ public:
 	static FMaterial *ValidateTexture(FTexture * tex, bool expand);
 	static FMaterial *ValidateTexture(FTextureID no, bool expand, bool trans);
 	static void ClearLastTexture();
+	static void ResetAtlasEntries();
+
+	// Changes whenever materials get deleted or flushed, so that anything
+	// holding on to material pointers or atlas pages knows when to let go.
+	static unsigned int Generation;
 
 	static void InitGlobalState();
 };
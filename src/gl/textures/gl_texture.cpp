@@ -49,6 +49,8 @@
 #include "gl/textures/gl_translate.h"
 #include "gl/models/gl_models.h"
 #include "stats.h"
+#include "p_setup.h"
+#include "parallel_for.h"
 
 //==========================================================================
 //
@@ -91,6 +93,9 @@ CUSTOM_CVAR(Bool, gl_texture_usehires, true, CVAR_ARCHIVE|CVAR_NOINITCALL)
 }
 
 CVAR(Bool, gl_precache, false, CVAR_ARCHIVE)
+CVAR(Bool, gl_precache_multithread, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+
+EXTERN_CVAR(Int, gl_texture_hqresizemode)
 
 TexFilter_s TexFilter[]={
 	{GL_NEAREST,					GL_NEAREST,		false},
@@ -624,6 +629,43 @@ static void PrecacheSprite(FTexture *tex, SpriteHits &hits)
 	if (gltex) gltex->PrecacheList(hits);
 }
 
+//==========================================================================
+//
+// Upsamples the textures of a precache batch in parallel. Reading the
+// texture data must stay on the main thread, the upload happens when the
+// batch gets precached.
+//
+//==========================================================================
+
+static void PrepareTextures(TArray<FGLTexture *> &prepared, FTexture **textures, uint8_t *texhitlist, SpriteHits **spritehitlist, int first, int last)
+{
+	prepared.Clear();
+	for (int i = first; i > last; i--)
+	{
+		FTexture *tex = textures[i];
+		if (tex == nullptr) continue;
+
+		if (texhitlist[i] & (FTextureManager::HIT_Wall | FTextureManager::HIT_Flat | FTextureManager::HIT_Sky))
+		{
+			FMaterial *gltex = FMaterial::ValidateTexture(tex, false);
+			FGLTexture *layer = gltex ? gltex->PrepareBaseLayer() : nullptr;
+			if (layer != nullptr) prepared.Push(layer);
+		}
+		if (spritehitlist[i] != nullptr && spritehitlist[i]->CheckKey(0))
+		{
+			FMaterial *gltex = FMaterial::ValidateTexture(tex, true);
+			FGLTexture *layer = gltex ? gltex->PrepareBaseLayer() : nullptr;
+			if (layer != nullptr) prepared.Push(layer);
+		}
+	}
+
+	gl_InitUpsamplers();
+	parallel_for((int)prepared.Size(), [&](int i)
+	{
+		prepared[i]->FinishPrepare();
+	});
+}
+
 //==========================================================================
 //
 // DFrameBuffer :: Precache
@@ -752,18 +794,34 @@ void gl_PrecacheTexture(uint8_t *texhitlist, TMap<PClassActor*, bool> &actorhitl
 		precache.Reset();
 		precache.Clock();
 
-		// cache all used textures
-		for (int i = cnt - 1; i >= 0; i--)
+		// cache all used textures, in batches so that the upsampling can be done in parallel without keeping every buffer in memory.
+		const int PRECACHE_BATCH = 64;
+		bool prepare = gl_precache_multithread && gl_texture_hqresizemode != 0;
+		TArray<FTexture *> textures(cnt, true);
+		TArray<FGLTexture *> prepared;
+		for (int i = 0; i < cnt; i++) textures[i] = TexMan.ByIndex(i);
+
+		for (int first = cnt - 1; first >= 0; first -= PRECACHE_BATCH)
 		{
-			FTexture *tex = TexMan.ByIndex(i);
-			if (tex != nullptr)
+			int last = MAX(first - PRECACHE_BATCH, -1);
+			if (prepare) PrepareTextures(prepared, &textures[0], texhitlist, spritehitlist, first, last);
+
+			for (int i = first; i > last; i--)
 			{
-				PrecacheTexture(tex, texhitlist[i]);
-				if (spritehitlist[i] != nullptr && (*spritehitlist[i]).CountUsed() > 0)
+				FTexture *tex = textures[i];
+				if (tex != nullptr)
 				{
-					PrecacheSprite(tex, *spritehitlist[i]);
+					PrecacheTexture(tex, texhitlist[i]);
+					if (spritehitlist[i] != nullptr && (*spritehitlist[i]).CountUsed() > 0)
+					{
+						PrecacheSprite(tex, *spritehitlist[i]);
+					}
 				}
 			}
+
+			// anything the precacher didn't use must not stick around.
+			for (auto layer : prepared) layer->DiscardPrepared();
+			P_PumpLoadEvents();
 		}
 
 		// cache all used models
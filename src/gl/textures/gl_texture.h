@@ -22,6 +22,7 @@ void gl_GenerateGlobalBrightmapFromColormap();
 
 
 
+void gl_InitUpsamplers();
 unsigned char *gl_CreateUpsampledTextureBuffer ( const FTexture *inputTexture, unsigned char *inputBuffer, const int inWidth, const int inHeight, int &outWidth, int &outHeight, bool hasAlpha );
 int CheckDDPK3(FTexture *tex);
 int CheckExternalFile(FTexture *tex, bool & hascolorkey);
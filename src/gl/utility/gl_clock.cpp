@@ -59,10 +59,11 @@
 #include "g_levellocals.h"
 #include "gl/utility/gl_clock.h"
 #include "i_time.h"
+#include "s_sound.h"
 
-glcycle_t RenderWall,SetupWall,ClipWall;
-glcycle_t RenderFlat,SetupFlat;
-glcycle_t RenderSprite,SetupSprite;
+glfinecycle_t RenderWall,SetupWall,ClipWall;
+glfinecycle_t RenderFlat,SetupFlat;
+glfinecycle_t RenderSprite,SetupSprite;
 glcycle_t All, Finish, PortalAll, Bsp;
 glcycle_t ProcessAll, PostProcess;
 glcycle_t RenderAll;
@@ -130,6 +131,13 @@ void gl_CalculateCPUSpeed ()
 			gl_SecondsPerCycle = 1.0 / frequency;
 			gl_MillisecPerCycle = 1000.0 / frequency;
 		}
+	#else
+		// CalculateCPUSpeed has already calibrated the counter.
+		if (PerfToSec != 0)
+		{
+			gl_SecondsPerCycle = PerfToSec;
+			gl_MillisecPerCycle = PerfToMillisec;
+		}
 	#endif
 }
 
@@ -143,15 +151,20 @@ void ResetProfilingData()
 	RenderAll.Reset();
 	ProcessAll.Reset();
 	PostProcess.Reset();
-	RenderWall.Reset();
-	SetupWall.Reset();
-	ClipWall.Reset();
-	RenderFlat.Reset();
-	SetupFlat.Reset();
-	RenderSprite.Reset();
-	SetupSprite.Reset();
 	drawcalls.Reset();
 
+	// Frames that are not sampled keep showing the last sampled times.
+	if (gl_finebenching)
+	{
+		RenderWall.Reset();
+		SetupWall.Reset();
+		ClipWall.Reset();
+		RenderFlat.Reset();
+		SetupFlat.Reset();
+		RenderSprite.Reset();
+		SetupSprite.Reset();
+	}
+
 	flatvertices=flatprimitives=vertexcount=0;
 	render_texsplit=render_vertexsplit=rendered_lines=rendered_flats=rendered_sprites=rendered_decals=rendered_portals = 0;
 }
@@ -244,6 +257,9 @@ void CheckBench()
 		AppendRenderTimes(compose);
 		AppendLightStats(compose);
 		AppendMissingTextureStats(compose);
+		compose += "\n";
+		S_AppendSoundStats(compose);
+		compose += "\n";
 		compose.AppendFormat("%" PRIu64 " fps\n\n", screen->GetLastFPS());
 
 		FILE *f = fopen("benchmarks.txt", "at");
@@ -276,10 +292,20 @@ CCMD(bench)
 }
 
 bool gl_benching = false;
+bool gl_finebenching = false;
+
+// Take the per-wall/flat/sprite timings only every n-th frame
+CVAR(Int, gl_clocksampling, 4, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 
 void  checkBenchActive()
 {
+	static int framessincesample;
+
 	FStat *stat = FStat::FindStat("rendertimes");
 	gl_benching = ((stat != NULL && stat->isActive()) || printstats);
+
+	// 'bench' wants the times of the frame it saves.
+	gl_finebenching = gl_benching && (printstats || ++framessincesample >= gl_clocksampling);
+	if (gl_finebenching) framessincesample = 0;
 }
 
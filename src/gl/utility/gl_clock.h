@@ -6,6 +6,7 @@
 #include "m_fixed.h"
 
 extern bool gl_benching;
+extern bool gl_finebenching;
 
 extern double gl_SecondsPerCycle;
 extern double gl_MillisecPerCycle;
@@ -24,20 +25,11 @@ inline int64_t GetClockCycle()
 	return __builtin_ia32_rdtsc();
 }
 
-#elif defined(__GNUG__) && defined(__i386__)
+#elif defined(__GNUG__) && (defined(__i386__) || defined(__amd64__) || defined(__aarch64__))
 
 inline int64_t GetClockCycle()
 {
-	if (CPU.bRDTSC)
-	{
-		int64_t res;
-		asm volatile ("rdtsc" : "=A" (res));
-		return res;
-	}
-	else
-	{
-		return 0;
-	}	
+	return rdtsc();
 }
 
 #else
@@ -91,9 +83,56 @@ private:
 	int64_t Counter;
 };
 
-extern glcycle_t RenderWall,SetupWall,ClipWall;
-extern glcycle_t RenderFlat,SetupFlat;
-extern glcycle_t RenderSprite,SetupSprite;
+// The per-wall, per-flat and per-sprite timers run thousands of times per
+// frame. Release builds leave them out, and elsewhere they are only taken
+// every gl_clocksampling frames.
+#ifdef NO_FINE_CLOCKS
+class glfinecycle_t
+{
+public:
+	void Reset() {}
+	void Clock() {}
+	void Unclock() {}
+	double Time() { return 0; }
+	double TimeMS() { return 0; }
+};
+#else
+class glfinecycle_t
+{
+public:
+	void Reset()
+	{
+		Counter = 0;
+	}
+
+	__forceinline void Clock()
+	{
+		if (gl_finebenching) Counter -= GetClockCycle();
+	}
+
+	__forceinline void Unclock()
+	{
+		if (gl_finebenching) Counter += GetClockCycle();
+	}
+
+	double Time()
+	{
+		return double(Counter) * gl_SecondsPerCycle;
+	}
+
+	double TimeMS()
+	{
+		return double(Counter) * gl_MillisecPerCycle;
+	}
+
+private:
+	int64_t Counter;
+};
+#endif
+
+extern glfinecycle_t RenderWall,SetupWall,ClipWall;
+extern glfinecycle_t RenderFlat,SetupFlat;
+extern glfinecycle_t RenderSprite,SetupSprite;
 extern glcycle_t All, Finish, PortalAll, Bsp;
 extern glcycle_t ProcessAll, PostProcess;
 extern glcycle_t RenderAll;
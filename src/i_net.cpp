@@ -192,6 +192,73 @@ int FindNode (const sockaddr_in *address)
 	return i;
 }
 
+//
+// Packet compression
+//
+// Packets are deflated without the zlib wrapper, which would add six bytes
+// of header and checksum to every one of them even though UDP already has
+// a checksum. zlib wrapped packets from older versions are still accepted.
+// Such a packet always starts with 0x78, which a single raw deflate block
+// as written by DeflatePacket never does, because its first bit is the
+// final block flag.
+//
+static z_stream DeflateStream, InflateStream;
+static bool DeflateInited, InflateInited;
+
+static int DeflatePacket (uint8_t *dest, uLong *destlen, const uint8_t *source, uLong sourcelen)
+{
+	int err;
+
+	if (!DeflateInited)
+	{
+		memset(&DeflateStream, 0, sizeof(DeflateStream));
+		err = deflateInit2(&DeflateStream, 9, Z_DEFLATED, -15, 9, Z_DEFAULT_STRATEGY);
+		if (err != Z_OK) return err;
+		DeflateInited = true;
+	}
+	else
+	{
+		deflateReset(&DeflateStream);
+	}
+	DeflateStream.next_in = (Bytef *)source;
+	DeflateStream.avail_in = (uInt)sourcelen;
+	DeflateStream.next_out = dest;
+	DeflateStream.avail_out = (uInt)*destlen;
+	err = deflate(&DeflateStream, Z_FINISH);
+	if (err != Z_STREAM_END) return err == Z_OK ? Z_BUF_ERROR : err;
+	*destlen = DeflateStream.total_out;
+	return Z_OK;
+}
+
+static int InflatePacket (uint8_t *dest, uLongf *destlen, const uint8_t *source, uLong sourcelen)
+{
+	int err;
+
+	if (sourcelen >= 2 && source[0] == 0x78 && ((source[0] << 8) | source[1]) % 31 == 0)
+	{
+		return uncompress(dest, destlen, source, sourcelen);
+	}
+	if (!InflateInited)
+	{
+		memset(&InflateStream, 0, sizeof(InflateStream));
+		err = inflateInit2(&InflateStream, -15);
+		if (err != Z_OK) return err;
+		InflateInited = true;
+	}
+	else
+	{
+		inflateReset(&InflateStream);
+	}
+	InflateStream.next_in = (Bytef *)source;
+	InflateStream.avail_in = (uInt)sourcelen;
+	InflateStream.next_out = dest;
+	InflateStream.avail_out = (uInt)*destlen;
+	err = inflate(&InflateStream, Z_FINISH);
+	if (err != Z_STREAM_END) return err == Z_OK || err == Z_BUF_ERROR ? Z_DATA_ERROR : err;
+	*destlen = InflateStream.total_out;
+	return Z_OK;
+}
+
 //
 // PacketSend
 //
@@ -212,7 +279,7 @@ void PacketSend (void)
 	if (doomcom.datalength >= 10)
 	{
 		TransmitBuffer[0] = doomcom.data[0] | NCMD_COMPRESSED;
-		c = compress2(TransmitBuffer + 1, &size, doomcom.data + 1, doomcom.datalength - 1, 9);
+		c = DeflatePacket(TransmitBuffer + 1, &size, doomcom.data + 1, doomcom.datalength - 1);
 		size += 1;
 	}
 	else
@@ -240,6 +307,11 @@ void PacketSend (void)
 				sizeof(sendaddress[doomcom.remotenode]));
 		}
 	}
+	if (c > 0)
+	{
+		netbytesout[doomcom.remotenode] += c;
+		netpacketsout[doomcom.remotenode]++;
+	}
 	//	if (c == -1)
 	//			I_Error ("SendPacket error: %s",strerror(errno));
 }
@@ -293,11 +365,13 @@ void PacketGet (void)
 	}
 	else if (node >= 0 && c > 0)
 	{
+		netbytesin[node] += c;
+		netpacketsin[node]++;
 		doomcom.data[0] = TransmitBuffer[0] & ~NCMD_COMPRESSED;
 		if (TransmitBuffer[0] & NCMD_COMPRESSED)
 		{
 			uLongf msgsize = MAX_MSGLEN - 1;
-			int err = uncompress(doomcom.data + 1, &msgsize, TransmitBuffer + 1, c - 1);
+			int err = InflatePacket(doomcom.data + 1, &msgsize, TransmitBuffer + 1, c - 1);
 //			Printf("recv %d/%lu\n", c, msgsize + 1);
 			if (err != Z_OK)
 			{
@@ -987,6 +1061,27 @@ int I_InitNetwork (void)
 }
 
 
+//
+// I_WaitForPacket
+// Blocks until a packet arrives or the timeout expires, so callers that
+// are waiting for tics don't have to spin. Returns true if a packet is
+// waiting.
+//
+bool I_WaitForPacket (int microseconds)
+{
+	if (mysocket == INVALID_SOCKET)
+		return false;
+
+	fd_set readset;
+	timeval timeout;
+
+	FD_ZERO (&readset);
+	FD_SET (mysocket, &readset);
+	timeout.tv_sec = microseconds / 1000000;
+	timeout.tv_usec = microseconds % 1000000;
+	return select (int(mysocket) + 1, &readset, NULL, NULL, &timeout) > 0;
+}
+
 void I_NetCmd (void)
 {
 	if (doomcom.command == CMD_SEND)
@@ -4,5 +4,6 @@
 // Called by D_DoomMain.
 int I_InitNetwork (void);
 void I_NetCmd (void);
+bool I_WaitForPacket (int microseconds);
 
 #endif
@@ -40,6 +40,7 @@
 #include "doomdef.h"
 #include "c_cvars.h"
 #include "doomstat.h"
+#include "stats.h"
 
 //==========================================================================
 //
@@ -211,3 +212,92 @@ void I_FreezeTime(bool frozen)
 	}
 }
 
+
+//==========================================================================
+//
+// Frame pacing
+//
+// The FPS limit timers of the backends wait between rendering a frame and
+// presenting it, so everything on screen is as old as that wait. For
+// vid_lowlatency the wait is done before the frame instead: the next
+// present is scheduled one period after the last one and the frame is
+// started as late as the measured cost of a frame allows. Sleeps are left
+// 2 ms short and the rest is yielded away, since the sleep granularity of
+// most systems is too coarse to hit the target on its own.
+//
+// All of this uses the real clock, not the scaled game time.
+//
+//==========================================================================
+
+static uint64_t PaceTarget;			// when the current frame should be presented
+static uint64_t PaceFrameStart;
+static uint64_t PaceInputTime;
+static double PaceCost;				// estimated time from frame start to present
+static double PaceWait, PaceLatency;	// for the stat
+
+static uint64_t GetRealTimeNS()
+{
+	using namespace std::chrono;
+	return (uint64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void I_WaitForFrame(int maxfps)
+{
+	uint64_t now = GetRealTimeNS();
+	const uint64_t start = now;
+
+	if (maxfps > 0)
+	{
+		const uint64_t period = 1'000'000'000 / maxfps;
+		const uint64_t margin = (uint64_t)(PaceCost * 1.25) + 500'000;
+
+		PaceTarget += period;
+		if (PaceTarget < now + margin || PaceTarget > now + period + margin)
+		{
+			// Fell behind or the limit changed: start now and schedule from here.
+			PaceTarget = now + margin;
+		}
+
+		const uint64_t wake = PaceTarget - margin;
+		while (now < wake)
+		{
+			if (wake - now > MSToNS(2))
+			{
+				std::this_thread::sleep_for(std::chrono::nanoseconds(wake - now - MSToNS(2)));
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+			now = GetRealTimeNS();
+		}
+	}
+
+	PaceFrameStart = now;
+	PaceInputTime = now;
+	PaceWait = (now - start) / 1'000'000.;
+}
+
+void I_MarkInputTime()
+{
+	PaceInputTime = GetRealTimeNS();
+}
+
+void I_FramePresented()
+{
+	const uint64_t now = GetRealTimeNS();
+	const double cost = double(now - PaceFrameStart);
+
+	// Follow a slower frame at once but only slowly trust a faster one,
+	// otherwise a single cheap frame makes the next expensive one late.
+	PaceCost = cost > PaceCost ? cost : PaceCost * 0.95 + cost * 0.05;
+	PaceLatency = (now - PaceInputTime) / 1'000'000.;
+}
+
+ADD_STAT(latency)
+{
+	FString out;
+	out.Format("input to present %.2f ms, frame cost %.2f ms, paced wait %.2f ms",
+		PaceLatency, PaceCost / 1'000'000., PaceWait);
+	return out;
+}
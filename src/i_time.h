@@ -34,3 +34,11 @@ uint64_t I_msTimeFS();
 
 // Nanosecond-accurate time
 uint64_t I_nsTime();
+
+// Frame pacing for vid_lowlatency. I_WaitForFrame is called by D_DoomLoop
+// before a frame is started and sleeps so that the frame ends right when the
+// next one is due; a maxfps of 0 only times the frame. I_MarkInputTime notes
+// when input was last read and I_FramePresented when the frame was shown.
+void I_WaitForFrame(int maxfps);
+void I_MarkInputTime();
+void I_FramePresented();
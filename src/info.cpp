@@ -189,35 +189,39 @@ bool FState::CallAction(AActor *self, AActor *stateowner, FStateParamInfo *info,
 		{
 			CheckCallerType(self, stateowner);
 
-			// Build the parameter array. Action functions have never any explicit parameters but need to pass the defaults
+			// Native functions that take nothing but the implicit arguments are called directly. Otherwise build
+			// the parameter array. Action functions have never any explicit parameters but need to pass the defaults
 			// and fill in the implicit arguments of the called function.
 
-			if (ActionFunc->DefaultArgs.Size() > 0)
+			if (!CallDirectAction(ActionFunc, self, stateowner, info, stateret))
 			{
-				auto defs = ActionFunc->DefaultArgs;
-				auto index = actionParams.Reserve(defs.Size());
-				for (unsigned i = 0; i < defs.Size(); i++)
+				if (ActionFunc->DefaultArgs.Size() > 0)
 				{
-					actionParams[i + index] = defs[i];
+					auto &defs = ActionFunc->DefaultArgs;
+					auto index = actionParams.Reserve(defs.Size());
+					for (unsigned i = 0; i < defs.Size(); i++)
+					{
+						actionParams[i + index] = defs[i];
+					}
+
+					if (ActionFunc->ImplicitArgs >= 1)
+					{
+						actionParams[index] = self;
+					}
+					if (ActionFunc->ImplicitArgs == 3)
+					{
+						actionParams[index + 1] = stateowner;
+						actionParams[index + 2] = VMValue(info);
+					}
+
+					VMCallAction(ActionFunc, &actionParams[index], ActionFunc->DefaultArgs.Size(), &ret, stateret != nullptr);
+					actionParams.Clamp(index);
 				}
-
-				if (ActionFunc->ImplicitArgs >= 1)
-				{
-					actionParams[index] = self;
-				}
-				if (ActionFunc->ImplicitArgs == 3)
+				else
 				{
-					actionParams[index + 1] = stateowner;
-					actionParams[index + 2] = VMValue(info);
+					VMValue params[3] = { self, stateowner, VMValue(info) };
+					VMCallAction(ActionFunc, params, ActionFunc->ImplicitArgs, &ret, stateret != nullptr);
 				}
-
-				VMCallAction(ActionFunc, &actionParams[index], ActionFunc->DefaultArgs.Size(), &ret, stateret != nullptr);
-				actionParams.Clamp(index);
-			}
-			else
-			{
-				VMValue params[3] = { self, stateowner, VMValue(info) };
-				VMCallAction(ActionFunc, params, ActionFunc->ImplicitArgs, &ret, stateret != nullptr);
 			}
 		}
 		catch (CVMAbortException &err)
@@ -251,6 +255,53 @@ bool FState::CallAction(AActor *self, AActor *stateowner, FStateParamInfo *info,
 	}
 }
 
+//==========================================================================
+//
+// Calls a native action function through its direct entry point when it
+// takes nothing but the implicit arguments, so that no VMValue parameters
+// need to be staged. Returns false if the function does not qualify.
+//
+//==========================================================================
+
+bool FState::CallDirectAction(VMFunction *func, AActor *self, AActor *stateowner, FStateParamInfo *info, FState **stateret)
+{
+	if (!(func->VarFlags & VARF_Native) || func->Proto == nullptr)
+		return false;
+
+	void *direct = static_cast<VMNativeFunction *>(func)->DirectNativeCall;
+	auto &argtypes = func->Proto->ArgumentTypes;
+	auto &rettypes = func->Proto->ReturnTypes;
+	if (direct == nullptr || argtypes.Size() != func->ImplicitArgs || func->DefaultArgs.Size() > func->ImplicitArgs)
+		return false;
+
+	if (rettypes.Size() == 0)
+	{
+		if (func->ImplicitArgs == 1)
+			reinterpret_cast<void(*)(AActor *)>(direct)(self);
+		else if (func->ImplicitArgs == 3)
+			reinterpret_cast<void(*)(AActor *, AActor *, FStateParamInfo *)>(direct)(self, stateowner, info);
+		else
+			return false;
+	}
+	else if (rettypes.Size() == 1 && rettypes[0] == TypeState)
+	{
+		FState *result;
+		if (func->ImplicitArgs == 1)
+			result = reinterpret_cast<FState *(*)(AActor *)>(direct)(self);
+		else if (func->ImplicitArgs == 3)
+			result = reinterpret_cast<FState *(*)(AActor *, AActor *, FStateParamInfo *)>(direct)(self, stateowner, info);
+		else
+			return false;
+		if (stateret != nullptr)
+			*stateret = result;
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
+
 //==========================================================================
 //
 //
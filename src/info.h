@@ -50,6 +50,7 @@ struct FActorInfo;
 class FIntCVar;
 class FStateDefinitions;
 class FInternalLightAssociation;
+struct FSpriteModelFrame;
 
 enum EStateDefineFlags
 {
@@ -118,6 +119,8 @@ struct FState
 	uint8_t		DefineFlags;
 	int32_t		Misc1;			// Was changed to int8_t, reverted to long for MBF compat
 	int32_t		Misc2;			// Was changed to uint8_t, reverted to long for MBF compat
+	FState		*ZeroTicSkip;	// Last state of a pass-through chain starting here, see StaticSetupZeroTicChains
+	FSpriteModelFrame *ModelFrame;	// The owning class's model for this state's sprite and frame, set by InitModels
 public:
 	inline int GetFrame() const
 	{
@@ -175,9 +178,11 @@ public:
 	void ClearAction() { ActionFunc = NULL; }
 	void SetAction(const char *name);
 	bool CallAction(AActor *self, AActor *stateowner, FStateParamInfo *stateinfo, FState **stateret);
+	static bool CallDirectAction(VMFunction *func, AActor *self, AActor *stateowner, FStateParamInfo *stateinfo, FState **stateret);
     void CheckCallerType(AActor *self, AActor *stateowner);
 
 	static PClassActor *StaticFindStateOwner (const FState *state);
+	static void StaticSetupZeroTicChains();
 	static PClassActor *StaticFindStateOwner (const FState *state, PClassActor *info);
 	static FString StaticGetStateName(const FState *state, PClassActor *info = nullptr);
 	static FRandom pr_statetics;
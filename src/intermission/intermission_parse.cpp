@@ -938,6 +938,7 @@ CCMD(testfinale)
 			return;
 		}
 		auto id = MAKE_ID(tolower(argv[2][0]), tolower(argv[2][1]), tolower(argv[2][2]), 0);
+		GStrings.EnsureLanguage(id);
 		text = GStrings.GetLanguageString(argv[1], id);
 	}
 	if (text == nullptr)
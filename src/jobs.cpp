@@ -0,0 +1,344 @@
+/*
+** jobs.cpp
+** Shared worker pool
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**---------------------------------------------------------------------------
+**
+*/
+
+#include <thread>
+#include <deque>
+#include <vector>
+#include <condition_variable>
+#ifdef __linux__
+#include <sched.h>
+#include <stdio.h>
+#endif
+
+#include "jobs.h"
+#include "c_cvars.h"
+#include "stats.h"
+#include "templates.h"
+
+CVAR(Bool, sys_pinthreads, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+FJobSystem Jobs;
+
+static FCpuTopology CpuTopology;
+#ifdef __linux__
+static cpu_set_t FastCores, SlowCores;
+#endif
+
+struct FJobSystem::Data
+{
+	struct Job
+	{
+		FJobCounter *counter;
+		std::function<void()> func;
+	};
+
+	std::mutex Mutex;
+	std::condition_variable WorkAvailable[2];
+	std::condition_variable JobDone;
+	std::deque<Job> Queues[2];
+	std::vector<std::thread> Threads;
+	unsigned NumThreads = 1;
+	int WakeQueue[2] = { JOB_Frame, JOB_Frame };	// which workers to wake for each priority
+	bool Quit = false;
+
+	// Must be called with the mutex held.
+	bool Pop(Job &job, int first, int last)
+	{
+		for (int i = first; i <= last; i++)
+		{
+			if (!Queues[i].empty())
+			{
+				job = std::move(Queues[i].front());
+				Queues[i].pop_front();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Must be called with the mutex released.
+	void Run(Job &job)
+	{
+		job.func();
+		if (job.counter->Pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			std::lock_guard<std::mutex> lock(Mutex);
+			JobDone.notify_all();
+		}
+	}
+
+	void Worker(int first, int last)
+	{
+		std::unique_lock<std::mutex> lock(Mutex);
+		for (;;)
+		{
+			Job job;
+			if (Pop(job, first, last))
+			{
+				lock.unlock();
+				Run(job);
+				lock.lock();
+			}
+			else if (Quit)
+			{
+				break;
+			}
+			else
+			{
+				WorkAvailable[first].wait(lock);
+			}
+		}
+	}
+};
+
+//==========================================================================
+//
+// Sorts the cores this process may run on by their relative capacity.
+// Kernels without capacity information for the CPU still list the
+// maximum clock rate, which tells the clusters apart just as well.
+//
+//==========================================================================
+
+#ifdef __linux__
+static unsigned ReadCpuValue(int cpu, const char *name)
+{
+	char path[80];
+	unsigned value = 0;
+	snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/%s", cpu, name);
+	FILE *f = fopen(path, "r");
+	if (f != nullptr)
+	{
+		if (fscanf(f, "%u", &value) != 1) value = 0;
+		fclose(f);
+	}
+	return value;
+}
+#endif
+
+static void DetectTopology()
+{
+	unsigned cores = std::thread::hardware_concurrency();
+	CpuTopology.NumCores = CpuTopology.NumFastCores = cores > 0 ? cores : 1;
+
+#ifdef __linux__
+	cpu_set_t usable;
+	if (sched_getaffinity(0, sizeof(usable), &usable) != 0)
+		return;
+
+	static const char *sources[] = { "cpu_capacity", "cpufreq/cpuinfo_max_freq" };
+	static unsigned capacity[CPU_SETSIZE];
+	unsigned maxcap = 0, mincap = ~0u;
+
+	for (auto source : sources)
+	{
+		maxcap = 0, mincap = ~0u;
+		for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+		{
+			if (!CPU_ISSET(cpu, &usable)) continue;
+			capacity[cpu] = ReadCpuValue(cpu, source);
+			maxcap = MAX(maxcap, capacity[cpu]);
+			mincap = MIN(mincap, capacity[cpu]);
+		}
+		if (mincap > 0) break;
+	}
+	if (mincap == 0 || mincap == ~0u || mincap == maxcap)
+		return;
+
+	unsigned numfast = 0, numslow = 0;
+	unsigned slowcap = 0;
+	CPU_ZERO(&FastCores);
+	CPU_ZERO(&SlowCores);
+	for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+	{
+		if (!CPU_ISSET(cpu, &usable)) continue;
+		if (capacity[cpu] * 4ull >= maxcap * 3ull)
+		{
+			CPU_SET(cpu, &FastCores);
+			numfast++;
+		}
+		else
+		{
+			CPU_SET(cpu, &SlowCores);
+			slowcap = MAX(slowcap, capacity[cpu]);
+			numslow++;
+		}
+	}
+	CpuTopology.NumCores = numfast + numslow;
+	CpuTopology.NumFastCores = numfast;
+	CpuTopology.FastCapacity = maxcap;
+	CpuTopology.SlowCapacity = slowcap;
+#endif
+}
+
+const FCpuTopology &FJobSystem::Topology()
+{
+	static std::once_flag detected;
+	std::call_once(detected, DetectTopology);
+	return CpuTopology;
+}
+
+void FJobSystem::PinThread(EJobPriority priority)
+{
+	if (!Topology().IsHeterogeneous() || !sys_pinthreads)
+		return;
+
+#ifdef __linux__
+	sched_setaffinity(0, sizeof(cpu_set_t), priority == JOB_Frame ? &FastCores : &SlowCores);
+#endif
+}
+
+//==========================================================================
+//
+// The workers are only started when something needs them. One core is
+// left to the calling thread, but there's always at least one worker so
+// that background jobs can run asynchronously.
+//
+//==========================================================================
+
+FJobSystem::Data *FJobSystem::Start()
+{
+	std::call_once(mStarted, [this]()
+	{
+		auto data = new Data;
+		auto &topo = Topology();
+
+		if (!topo.IsHeterogeneous() || !sys_pinthreads)
+		{
+			unsigned cores = topo.NumCores;
+			data->NumThreads = cores;
+			unsigned numworkers = cores > 1 ? cores - 1 : 1;
+			for (unsigned i = 0; i < numworkers; i++)
+			{
+				data->Threads.emplace_back([data]() { data->Worker(JOB_Frame, JOB_Background); });
+			}
+		}
+		else
+		{
+			// The calling thread is assumed to be on a fast core already.
+			data->NumThreads = topo.NumFastCores;
+			data->WakeQueue[JOB_Background] = JOB_Background;
+			for (unsigned i = 1; i < topo.NumFastCores; i++)
+			{
+				data->Threads.emplace_back([data]() { PinThread(JOB_Frame); data->Worker(JOB_Frame, JOB_Frame); });
+			}
+			for (unsigned i = topo.NumFastCores; i < topo.NumCores; i++)
+			{
+				data->Threads.emplace_back([data]() { PinThread(JOB_Background); data->Worker(JOB_Background, JOB_Background); });
+			}
+		}
+		mData = data;
+	});
+	return mData;
+}
+
+FJobSystem::~FJobSystem()
+{
+	if (mData == nullptr) return;
+	{
+		std::lock_guard<std::mutex> lock(mData->Mutex);
+		mData->Quit = true;
+	}
+	mData->WorkAvailable[JOB_Frame].notify_all();
+	mData->WorkAvailable[JOB_Background].notify_all();
+	for (auto &thread : mData->Threads)
+	{
+		thread.join();
+	}
+	delete mData;
+}
+
+unsigned FJobSystem::NumThreads()
+{
+	return Start()->NumThreads;
+}
+
+void FJobSystem::Submit(FJobCounter &counter, std::function<void()> func, EJobPriority priority)
+{
+	auto data = Start();
+	counter.Pending.fetch_add(1, std::memory_order_relaxed);
+	{
+		std::lock_guard<std::mutex> lock(data->Mutex);
+		data->Queues[priority].push_back({ &counter, std::move(func) });
+	}
+	data->WorkAvailable[data->WakeQueue[priority]].notify_one();
+}
+
+void FJobSystem::Wait(FJobCounter &counter)
+{
+	if (counter.IsDone()) return;
+
+	auto data = Start();
+	std::unique_lock<std::mutex> lock(data->Mutex);
+	while (!counter.IsDone())
+	{
+		Data::Job job;
+		if (data->Pop(job, JOB_Frame, JOB_Frame))
+		{
+			lock.unlock();
+			data->Run(job);
+			lock.lock();
+		}
+		else
+		{
+			data->JobDone.wait(lock);
+		}
+	}
+}
+
+void FJobSystem::RunParallel(unsigned numtasks, const std::function<void(unsigned)> &func)
+{
+	if (numtasks == 0) return;
+
+	FJobCounter counter;
+	for (unsigned i = 1; i < numtasks; i++)
+	{
+		Submit(counter, [&func, i]() { func(i); }, JOB_Frame);
+	}
+	func(0);
+	Wait(counter);
+}
+
+//==========================================================================
+//
+// Shows how the cores were sorted and how wide parallel sections are.
+//
+//==========================================================================
+
+ADD_STAT(cpus)
+{
+	auto &topo = FJobSystem::Topology();
+	FString out;
+	if (!topo.IsHeterogeneous())
+	{
+		out.Format("%u cores", topo.NumCores);
+	}
+	else
+	{
+		out.Format("%u cores: %u fast (capacity %u), %u slow (capacity %u), %s", topo.NumCores,
+			topo.NumFastCores, topo.FastCapacity, topo.NumCores - topo.NumFastCores, topo.SlowCapacity,
+			sys_pinthreads ? "pinned" : "not pinned");
+	}
+	out.AppendFormat("  jobs: %u threads per parallel section", Jobs.NumThreads());
+	return out;
+}
@@ -0,0 +1,88 @@
+#ifndef __JOBS_H
+#define __JOBS_H
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+//==========================================================================
+//
+// Shared worker pool for everything that used to start its own threads.
+//
+// Frame jobs are always taken before background jobs, so a long running
+// background job (saving, snapshot parsing, decompression) never delays
+// the splitting of per-frame work by more than the job it is running.
+// Threads waiting on a counter help out with frame jobs in the meantime,
+// so nested parallel sections cannot starve the pool.
+//
+// Long running loops that sleep on their own condition variables (sound
+// streaming, the console log writer) should keep their dedicated threads.
+//
+// On CPUs that mix fast and slow cores the frame workers are pinned to
+// the fast cores and background jobs only run on the slow ones, so that
+// frame work isn't split into slices that finish at different speeds.
+//
+//==========================================================================
+
+enum EJobPriority
+{
+	JOB_Frame,
+	JOB_Background,
+};
+
+struct FCpuTopology
+{
+	unsigned NumCores = 1;		// usable logical cores
+	unsigned NumFastCores = 1;	// cores within 75% of the highest capacity
+	unsigned FastCapacity = 0;	// capacity values as reported by the kernel, 0 if unknown
+	unsigned SlowCapacity = 0;
+
+	bool IsHeterogeneous() const { return NumFastCores < NumCores; }
+};
+
+// Counts the unfinished jobs of one batch.
+class FJobCounter
+{
+	friend class FJobSystem;
+	std::atomic<int> Pending = { 0 };
+
+public:
+	bool IsDone() const
+	{
+		return Pending.load(std::memory_order_acquire) == 0;
+	}
+};
+
+class FJobSystem
+{
+public:
+	FJobSystem() = default;
+	~FJobSystem();
+
+	// Number of threads that work on a parallel section, including the caller.
+	unsigned NumThreads();
+
+	static const FCpuTopology &Topology();
+
+	// Restricts the calling thread to the fast cores for JOB_Frame or the
+	// slow cores for JOB_Background. Does nothing on symmetric systems.
+	static void PinThread(EJobPriority priority);
+
+	void Submit(FJobCounter &counter, std::function<void()> func, EJobPriority priority = JOB_Background);
+	void Wait(FJobCounter &counter);
+
+	// Calls func(0)...func(numtasks-1), using the calling thread as one of the
+	// workers, and returns once all of them are done.
+	void RunParallel(unsigned numtasks, const std::function<void(unsigned)> &func);
+
+private:
+	struct Data;
+
+	Data *Start();
+	Data *mData = nullptr;
+	std::once_flag mStarted;
+};
+
+extern FJobSystem Jobs;
+
+#endif
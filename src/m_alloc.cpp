@@ -46,6 +46,9 @@
 
 #include "i_system.h"
 #include "dobject.h"
+#include "c_dispatch.h"
+#include "stats.h"
+#include <atomic>
 
 #ifndef _MSC_VER
 #define _NORMAL_BLOCK			0
@@ -219,3 +222,82 @@ void M_Free (void *block)
 }
 #endif
 
+
+//==========================================================================
+//
+// Per-subsystem memory accounting
+//
+// Some of the subsystems report from worker threads (the software
+// renderer's frame memory, for example), so the counters are atomic.
+//
+//==========================================================================
+
+static const char *const MemTagNames[NUM_MEMTAGS] =
+{
+	"Lump cache",
+	"Objects",
+	"Level data",
+	"Textures",
+	"Render memory",
+	"ACS strings",
+};
+
+static std::atomic<size_t> MemTagUsed[NUM_MEMTAGS];
+static std::atomic<size_t> MemTagPeak[NUM_MEMTAGS];
+
+static void M_UpdatePeak(EMemTag tag, size_t now)
+{
+	size_t peak = MemTagPeak[tag].load(std::memory_order_relaxed);
+	while (now > peak && !MemTagPeak[tag].compare_exchange_weak(peak, now, std::memory_order_relaxed))
+	{
+	}
+}
+
+void M_TrackMemory(EMemTag tag, ptrdiff_t delta)
+{
+	size_t now = MemTagUsed[tag].fetch_add(size_t(delta), std::memory_order_relaxed) + size_t(delta);
+	if (delta > 0) M_UpdatePeak(tag, now);
+}
+
+void M_SetMemoryUsage(EMemTag tag, size_t bytes)
+{
+	MemTagUsed[tag].store(bytes, std::memory_order_relaxed);
+	M_UpdatePeak(tag, bytes);
+}
+
+size_t M_MemoryUsage(EMemTag tag)
+{
+	return MemTagUsed[tag].load(std::memory_order_relaxed);
+}
+
+CCMD(memstat)
+{
+	size_t tagged = 0;
+
+	Printf("%-16s %10s %10s\n", "Subsystem", "Current", "Peak");
+	for (int i = 0; i < NUM_MEMTAGS; i++)
+	{
+		size_t used = MemTagUsed[i].load(std::memory_order_relaxed);
+		tagged += used;
+		Printf("%-16s %9zuK %9zuK\n", MemTagNames[i], (used + 1023) >> 10,
+			(MemTagPeak[i].load(std::memory_order_relaxed) + 1023) >> 10);
+	}
+	// Textures and render memory don't go through M_Malloc, so they aren't
+	// part of the GC's allocation count.
+	size_t outside = M_MemoryUsage(MEMTAG_TEXTURES) + M_MemoryUsage(MEMTAG_RENDER);
+	size_t inside = tagged - outside;
+	Printf("%-16s %9zuK\n", "Other M_Malloc", GC::AllocBytes > inside ? (GC::AllocBytes - inside + 1023) >> 10 : 0);
+	Printf("%-16s %9zuK\n", "Total", (GC::AllocBytes + outside + 1023) >> 10);
+}
+
+ADD_STAT(mem)
+{
+	FString out;
+	for (int i = 0; i < NUM_MEMTAGS; i++)
+	{
+		out.AppendFormat("%s%s: %zuK", i == 0 ? "" : "  ", MemTagNames[i],
+			(MemTagUsed[i].load(std::memory_order_relaxed) + 1023) >> 10);
+	}
+	out.AppendFormat("  M_Malloc: %zuK", (GC::AllocBytes + 1023) >> 10);
+	return out;
+}
@@ -35,6 +35,7 @@
 #define __M_ALLOC_H__
 
 #include <stdlib.h>
+#include <stddef.h>
 
 // These are the same as the same stdlib functions,
 // except they bomb out with a fatal error
@@ -53,4 +54,24 @@ void *M_Realloc (void *memblock, size_t size);
 
 void M_Free (void *memblock);
 
+// Memory accounting by subsystem. The allocator itself only knows the grand
+// total, so the owners of large buffers report what they hold here. The
+// memstat command and stat show current and peak bytes for each tag.
+
+enum EMemTag
+{
+	MEMTAG_LUMPCACHE,
+	MEMTAG_OBJECTS,
+	MEMTAG_LEVEL,
+	MEMTAG_TEXTURES,
+	MEMTAG_RENDER,
+	MEMTAG_ACSSTRINGS,
+
+	NUM_MEMTAGS
+};
+
+void M_TrackMemory (EMemTag tag, ptrdiff_t delta);
+void M_SetMemoryUsage (EMemTag tag, size_t bytes);
+size_t M_MemoryUsage (EMemTag tag);
+
 #endif //__M_ALLOC_H__
@@ -79,6 +79,7 @@
 
 #include "gameconfigfile.h"
 #include "gstrings.h"
+#include "r_governor.h"
 
 FGameConfigFile *GameConfig;
 
@@ -289,6 +290,7 @@ bool M_SaveDefaults (const char *filename)
 	bool success;
 
 	if (GameConfig == nullptr) return true;
+	R_GovernorRestore();	// save the user's settings, not the governor's
 	if (filename != nullptr)
 	{
 		oldpath = GameConfig->GetPathName();
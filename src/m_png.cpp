@@ -689,6 +689,141 @@ bool M_ReadIDAT (FileReader &file, uint8_t *buffer, int width, int height, int p
 	return true;
 }
 
+//==========================================================================
+//
+// M_ReadIDATBands
+//
+// Like M_ReadIDAT, but for non-interlaced images only. Rows are decoded
+// into a buffer of at most bandheight rows, which is passed to sink as
+// soon as it is full, so the entire image never needs to be in memory
+// at once. Rows are unpacked to one byte per pixel if bitdepth < 8, so
+// the pitch passed to sink is width * bytes per pixel.
+//
+//==========================================================================
+
+bool M_ReadIDATBands (FileReader &file, int width, int height, uint8_t bitdepth, uint8_t colortype, unsigned int chunklen, int bandheight,
+					const std::function<void(const uint8_t *pixels, int firstrow, int numrows, int pitch)> &sink)
+{
+	Byte chunkbuffer[4096];
+	z_stream stream;
+	int err;
+	int bytesPerPixel, bytesPerRowIn, pitch;
+	bool lastIDAT = false;
+
+	switch (colortype)
+	{
+	case 2:		bytesPerPixel = 3;		break;		// RGB
+	case 4:		bytesPerPixel = 2;		break;		// LA
+	case 6:		bytesPerPixel = 4;		break;		// RGBA
+	default:	bytesPerPixel = 1;		break;
+	}
+	switch (bitdepth)
+	{
+	case 8:		bytesPerRowIn = width * bytesPerPixel;	break;
+	case 4:		bytesPerRowIn = (width+1)/2;			break;
+	case 2:		bytesPerRowIn = (width+3)/4;			break;
+	case 1:		bytesPerRowIn = (width+7)/8;			break;
+	default:	return false;
+	}
+	pitch = width * bytesPerPixel;
+	bandheight = clamp(bandheight, 1, height);
+
+	// The last row of the previous band is kept, still packed, because the next row is unfiltered against it.
+	TArray<Byte> band(pitch * bandheight, true);
+	TArray<Byte> inputLine(bytesPerRowIn + 1, true);
+	TArray<Byte> lastrow(bytesPerRowIn, true);
+	memset(lastrow.Data(), 0, bytesPerRowIn);
+
+	stream.next_in = Z_NULL;
+	stream.avail_in = 0;
+	stream.zalloc = Z_NULL;
+	stream.zfree = Z_NULL;
+	err = inflateInit (&stream);
+	if (err != Z_OK)
+	{
+		return false;
+	}
+
+	int row = 0, bandrow = 0;
+	stream.next_out = inputLine.Data();
+	stream.avail_out = bytesPerRowIn + 1;
+
+	while (err != Z_STREAM_END && row < height)
+	{
+		if (stream.avail_in == 0 && chunklen > 0)
+		{
+			stream.next_in = chunkbuffer;
+			stream.avail_in = (uInt)file.Read (chunkbuffer, MIN<uint32_t>(chunklen,sizeof(chunkbuffer)));
+			chunklen -= stream.avail_in;
+		}
+
+		err = inflate (&stream, Z_SYNC_FLUSH);
+		if (err != Z_OK && err != Z_STREAM_END)
+		{ // something unexpected happened
+			break;
+		}
+
+		if (stream.avail_out == 0)
+		{
+			Byte *curr = &band[bandrow * pitch];
+			Byte *prev = bandrow == 0 ? lastrow.Data() : curr - pitch;
+			UnfilterRow (bytesPerRowIn, curr, inputLine.Data(), prev, bytesPerPixel);
+			row++;
+			bandrow++;
+
+			if (bandrow == bandheight || row == height)
+			{
+				memcpy(lastrow.Data(), curr, bytesPerRowIn);
+				if (bitdepth < 8)
+				{
+					for (int i = 0; i < bandrow; i++)
+					{
+						UnpackPixels (width, bytesPerRowIn, bitdepth, &band[i * pitch], &band[i * pitch], colortype == 0);
+					}
+				}
+				sink(band.Data(), row - bandrow, bandrow, pitch);
+				bandrow = 0;
+			}
+			stream.next_out = inputLine.Data();
+			stream.avail_out = bytesPerRowIn + 1;
+		}
+
+		if (chunklen == 0 && !lastIDAT)
+		{
+			uint32_t x[3];
+
+			if (file.Read (x, 12) != 12)
+			{
+				lastIDAT = true;
+			}
+			else if (x[2] != MAKE_ID('I','D','A','T'))
+			{
+				lastIDAT = true;
+			}
+			else
+			{
+				chunklen = BigLong((unsigned int)x[1]);
+			}
+		}
+	}
+
+	inflateEnd (&stream);
+
+	// Like M_ReadIDAT, keep whatever could be decoded if the data ends early.
+	if (bandrow > 0)
+	{
+		if (bitdepth < 8)
+		{
+			for (int i = 0; i < bandrow; i++)
+			{
+				UnpackPixels (width, bytesPerRowIn, bitdepth, &band[i * pitch], &band[i * pitch], colortype == 0);
+			}
+		}
+		sink(band.Data(), row - bandrow, bandrow, pitch);
+	}
+	return err == Z_OK || err == Z_STREAM_END;
+}
+
 // PRIVATE CODE ------------------------------------------------------------
 
 
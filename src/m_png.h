@@ -109,6 +109,11 @@ bool M_GetPNGText (PNGHandle *png, const char *keyword, char *buffer, size_t buf
 bool M_ReadIDAT (FileReader &file, uint8_t *buffer, int width, int height, int pitch,
 				 uint8_t bitdepth, uint8_t colortype, uint8_t interlace, unsigned int idatlen);
 
+// Same for non-interlaced images, but decodes them in bands of rows so that
+// the whole image does not have to be buffered.
+bool M_ReadIDATBands (FileReader &file, int width, int height, uint8_t bitdepth, uint8_t colortype, unsigned int idatlen, int bandheight,
+					const std::function<void(const uint8_t *pixels, int firstrow, int numrows, int pitch)> &sink);
+
 
 class FTexture;
 
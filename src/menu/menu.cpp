@@ -78,6 +78,7 @@ CVAR(Int, m_show_backbutton, 0, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 
 // Option Search
 CVAR(Bool, os_isanyof, true, CVAR_ARCHIVE);
+CVAR(Bool, m_retained, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 
 
 static DMenu *GetCurrentMenu()
@@ -111,6 +112,7 @@ float			BackbuttonAlpha;
 static bool		MenuEnabled = true;
 DMenu			*CurrentMenu;
 int				MenuTime;
+static unsigned	MenuEvents;		// counts the input the menu got, so a kept menu drawing can be told apart from a changed one
 
 void M_InitVideoModes();
 extern PClass *DefaultListMenuClass;
@@ -595,6 +597,8 @@ bool M_Responder (event_t *ev)
 
 	if (CurrentMenu != nullptr && menuactive != MENU_Off) 
 	{
+		MenuEvents++;
+
 		// There are a few input sources we are interested in:
 		//
 		// EV_KeyDown / EV_KeyUp : joysticks/gamepads/controllers
@@ -850,7 +854,25 @@ void M_Drawer (void)
 			screen->Dim(fade);
 			V_SetBorderNeedRefresh();
 		}
+
+		// With m_retained the menu is only drawn again when a tic has run or it
+		// got some input. Menus only animate in their tickers, so all other
+		// frames would produce the same drawing. The console can change CVARs
+		// a menu shows, so nothing is kept while it is open.
+		bool retained = m_retained && ConsoleState == c_up;
+		if (retained)
+		{
+			uint64_t key = MenuTime;
+			key = key * 31 + gametic;
+			key = key * 31 + MenuEvents;
+			key = key * 31 + (uintptr_t)CurrentMenu;
+			key = key * 31 + menuactive;
+			key = key * 31 + SCREENWIDTH;
+			key = key * 31 + SCREENHEIGHT;
+			if (screen->BeginRetained2D(RETAINED2D_MENU, key)) return;
+		}
 		CurrentMenu->CallDrawer();
+		if (retained) screen->EndRetained2D();
 	}
 }
 
@@ -33,6 +33,7 @@
 */
 
 #include <string.h>
+#include <mutex>
 #include "name.h"
 #include "c_dispatch.h"
 #include "c_console.h"
@@ -44,7 +45,8 @@
 // that is just large enough to hold it.
 #define BLOCK_SIZE			4096
 
-// How many entries to grow the NameArray by when it needs to grow.
+// How many entries to grow the NameArray by when it needs to grow. Later
+// growth doubles the size, so that only a few old arrays pile up.
 #define NAME_GROW_AMOUNT	256
 
 // TYPES -------------------------------------------------------------------
@@ -68,6 +70,9 @@ struct FName::NameManager::NameBlock
 FName::NameManager FName::NameData;
 bool FName::NameManager::Inited;
 
+// Serializes adding names. Lookups don't need it.
+static std::mutex NameMutex;
+
 // Define the predefined names.
 static const char *PredefinedNames[] =
 {
@@ -102,16 +107,29 @@ int FName::NameManager::FindName (const char *text, bool noCreate)
 
 	unsigned int hash = MakeKey (text);
 	unsigned int bucket = hash % HASH_SIZE;
-	int scanner = Buckets[bucket];
 
-	// See if the name already exists.
-	while (scanner >= 0)
+	// See if the name already exists. The bucket must be read before the
+	// array, so that the array is guaranteed to contain the entries it
+	// links to.
+	auto scan = [&]()
 	{
-		if (NameArray[scanner].Hash == hash && stricmp (NameArray[scanner].Text, text) == 0)
+		int scanner = Buckets[bucket].load(std::memory_order_acquire);
+		const NameEntry *names = NameArray.load(std::memory_order_acquire);
+		while (scanner >= 0)
 		{
-			return scanner;
+			if (names[scanner].Hash == hash && stricmp (names[scanner].Text, text) == 0)
+			{
+				break;
+			}
+			scanner = names[scanner].NextHash;
 		}
-		scanner = NameArray[scanner].NextHash;
+		return scanner;
+	};
+
+	int index = scan();
+	if (index >= 0)
+	{
+		return index;
 	}
 
 	// If we get here, then the name does not exist.
@@ -120,7 +138,10 @@ int FName::NameManager::FindName (const char *text, bool noCreate)
 		return 0;
 	}
 
-	return AddName (text, hash, bucket);
+	// Another thread may have added it in the meantime.
+	std::lock_guard<std::mutex> lock(NameMutex);
+	index = scan();
+	return index >= 0 ? index : AddName (text, strlen(text), hash, bucket);
 }
 
 //==========================================================================
@@ -144,18 +165,29 @@ int FName::NameManager::FindName (const char *text, size_t textLen, bool noCreat
 
 	unsigned int hash = MakeKey (text, textLen);
 	unsigned int bucket = hash % HASH_SIZE;
-	int scanner = Buckets[bucket];
 
 	// See if the name already exists.
-	while (scanner >= 0)
+	auto scan = [&]()
 	{
-		if (NameArray[scanner].Hash == hash &&
-			strnicmp (NameArray[scanner].Text, text, textLen) == 0 &&
-			NameArray[scanner].Text[textLen] == '\0')
+		int scanner = Buckets[bucket].load(std::memory_order_acquire);
+		const NameEntry *names = NameArray.load(std::memory_order_acquire);
+		while (scanner >= 0)
 		{
-			return scanner;
+			if (names[scanner].Hash == hash &&
+				strnicmp (names[scanner].Text, text, textLen) == 0 &&
+				names[scanner].Text[textLen] == '\0')
+			{
+				break;
+			}
+			scanner = names[scanner].NextHash;
 		}
-		scanner = NameArray[scanner].NextHash;
+		return scanner;
+	};
+
+	int index = scan();
+	if (index >= 0)
+	{
+		return index;
 	}
 
 	// If we get here, then the name does not exist.
@@ -164,7 +196,10 @@ int FName::NameManager::FindName (const char *text, size_t textLen, bool noCreat
 		return 0;
 	}
 
-	return AddName (text, hash, bucket);
+	// Another thread may have added it in the meantime.
+	std::lock_guard<std::mutex> lock(NameMutex);
+	index = scan();
+	return index >= 0 ? index : AddName (text, textLen, hash, bucket);
 }
 
 //==========================================================================
@@ -178,7 +213,10 @@ int FName::NameManager::FindName (const char *text, size_t textLen, bool noCreat
 void FName::NameManager::InitBuckets ()
 {
 	Inited = true;
-	memset (Buckets, -1, sizeof(Buckets));
+	for (auto &bucket : Buckets)
+	{
+		bucket.store(-1, std::memory_order_relaxed);
+	}
 
 	// Register built-in names. 'None' must be name 0.
 	for (size_t i = 0; i < countof(PredefinedNames); ++i)
@@ -196,11 +234,11 @@ void FName::NameManager::InitBuckets ()
 //
 //==========================================================================
 
-int FName::NameManager::AddName (const char *text, unsigned int hash, unsigned int bucket)
+int FName::NameManager::AddName (const char *text, size_t textLen, unsigned int hash, unsigned int bucket)
 {
 	char *textstore;
 	NameBlock *block = Blocks;
-	size_t len = strlen (text) + 1;
+	size_t len = textLen + 1;
 
 	// Get a block large enough for the name. Only the first block in the
 	// list is ever considered for name storage.
@@ -211,25 +249,40 @@ int FName::NameManager::AddName (const char *text, unsigned int hash, unsigned i
 
 	// Copy the string into the block.
 	textstore = (char *)block + block->NextAlloc;
-	strcpy (textstore, text);
+	memcpy (textstore, text, textLen);
+	textstore[textLen] = '\0';
 	block->NextAlloc += len;
 
 	// Add an entry for the name to the NameArray
-	if (NumNames >= MaxNames)
+	int index = NumNames.load(std::memory_order_relaxed);
+	NameEntry *names = NameArray.load(std::memory_order_relaxed);
+	if (index >= MaxNames)
 	{
 		// If no names have been defined yet, make the first allocation
 		// large enough to hold all the predefined names.
-		MaxNames += MaxNames == 0 ? countof(PredefinedNames) + NAME_GROW_AMOUNT : NAME_GROW_AMOUNT;
+		MaxNames = MaxNames == 0 ? countof(PredefinedNames) + NAME_GROW_AMOUNT : MaxNames * 2;
 
-		NameArray = (NameEntry *)M_Realloc (NameArray, MaxNames * sizeof(NameEntry));
+		// Other threads may still be reading the old array, so it can't be
+		// reallocated in place.
+		NameEntry *newnames = (NameEntry *)M_Malloc (MaxNames * sizeof(NameEntry));
+		if (names != NULL)
+		{
+			memcpy (newnames, names, index * sizeof(NameEntry));
+			assert(NumOldArrays < MAX_OLD_ARRAYS);
+			OldArrays[NumOldArrays++] = names;
+		}
+		names = newnames;
+		NameArray.store(names, std::memory_order_release);
 	}
 
-	NameArray[NumNames].Text = textstore;
-	NameArray[NumNames].Hash = hash;
-	NameArray[NumNames].NextHash = Buckets[bucket];
-	Buckets[bucket] = NumNames;
+	names[index].Text = textstore;
+	names[index].Hash = hash;
+	names[index].NextHash = Buckets[bucket].load(std::memory_order_relaxed);
+	NumNames.store(index + 1, std::memory_order_release);
+	// This makes the new entry visible to lookups.
+	Buckets[bucket].store(index, std::memory_order_release);
 
-	return NumNames++;
+	return index;
 }
 
 //==========================================================================
@@ -283,6 +336,14 @@ FName::NameManager::~NameManager()
 		M_Free (NameArray);
 		NameArray = NULL;
 	}
+	for (int i = 0; i < NumOldArrays; ++i)
+	{
+		M_Free (OldArrays[i]);
+	}
+	NumOldArrays = 0;
 	NumNames = MaxNames = 0;
-	memset (Buckets, -1, sizeof(Buckets));
+	for (auto &bucket : Buckets)
+	{
+		bucket.store(-1, std::memory_order_relaxed);
+	}
 }
@@ -34,6 +34,8 @@
 #ifndef NAME_H
 #define NAME_H
 
+#include <atomic>
+
 enum ENamedName
 {
 #define xx(n) NAME_##n,
@@ -58,8 +60,8 @@ public:
 
 	int GetIndex() const { return Index; }
 	operator int() const { return Index; }
-	const char *GetChars() const { return NameData.NameArray[Index].Text; }
-	operator const char *() const { return NameData.NameArray[Index].Text; }
+	const char *GetChars() const { return NameData.GetText(Index); }
+	operator const char *() const { return NameData.GetText(Index); }
 
 	FName &operator = (const char *text) { Index = NameData.FindName (text, false); return *this; }
 	FName &operator = (const FString &text);
@@ -68,7 +70,7 @@ public:
 
 	int SetName (const char *text, bool noCreate=false) { return Index = NameData.FindName (text, noCreate); }
 
-	bool IsValidName() const { return (unsigned)Index < (unsigned)NameData.NumNames; }
+	bool IsValidName() const { return (unsigned)Index < (unsigned)NameData.NumNames.load(std::memory_order_relaxed); }
 
 	// Note that the comparison operators compare the names' indices, not
 	// their text, so they cannot be used to do a lexicographical sort.
@@ -96,6 +98,10 @@ protected:
 		int NextHash;
 	};
 
+	// Names can be looked up from any thread without locking. Adding a name
+	// takes a lock, and entries never change or move once they have been
+	// published: when NameArray grows, the old array stays around so that
+	// threads still reading from it don't crash.
 	struct NameManager
 	{
 		// No constructor because we can't ensure that it actually gets
@@ -103,17 +109,25 @@ protected:
 		// means this struct must only exist in the program's BSS section.
 		~NameManager();
 
-		enum { HASH_SIZE = 1024 };
+		enum { HASH_SIZE = 1024, MAX_OLD_ARRAYS = 32 };
 		struct NameBlock;
 
 		NameBlock *Blocks;
-		NameEntry *NameArray;
-		int NumNames, MaxNames;
-		int Buckets[HASH_SIZE];
+		std::atomic<NameEntry *> NameArray;
+		NameEntry *OldArrays[MAX_OLD_ARRAYS];
+		int NumOldArrays;
+		std::atomic<int> NumNames;
+		int MaxNames;
+		std::atomic<int> Buckets[HASH_SIZE];
+
+		const char *GetText(int index) const
+		{
+			return NameArray.load(std::memory_order_acquire)[index].Text;
+		}
 
 		int FindName (const char *text, bool noCreate);
 		int FindName (const char *text, size_t textlen, bool noCreate);
-		int AddName (const char *text, unsigned int hash, unsigned int bucket);
+		int AddName (const char *text, size_t textLen, unsigned int hash, unsigned int bucket);
 		NameBlock *AddBlock (size_t len);
 		void InitBuckets ();
 		static bool Inited;
@@ -122,8 +122,14 @@ xx(Ironlich)
 xx(Minotaur)
 xx(Sorcerer2)
 
-// Bots check this
+// Bots check these
 xx(Megasphere)
+xx(Medikit)
+xx(Stimpack)
+xx(Soulsphere)
+xx(CrystalVial)
+xx(Invulnerability)
+xx(Invisibility)
 
 // Standard player classes
 xx(DoomPlayer)
@@ -51,6 +51,7 @@
 #include "m_bbox.h"
 #include "c_console.h"
 #include "r_state.h"
+#include "parallel_for.h"
 
 const int MaxSegs = 64;
 const int SplitCost = 8;
@@ -436,7 +437,7 @@ bool FNodeBuilder::ShoveSegBehind (uint32_t set, node_t &node, uint32_t seg, uin
 		node.dx = -node.dx;
 		node.dy = -node.dy;
 	}
-	return Heuristic (node, set, false) > 0;
+	return Heuristic (node, set, false, Touched, Colinear) > 0;
 }
 
 // Splitters are chosen to coincide with segs in the given set. To reduce the
@@ -464,6 +465,11 @@ int FNodeBuilder::SelectSplitter (uint32_t set, node_t &node, uint32_t &splitseg
 
 	D(Printf (PRINT_LOG, "Processing set %d\n", set));
 
+	// Which segs get tested only depends on their order in the set, not on
+	// their scores. So collect them first, score them, possibly in parallel,
+	// and then pick the best one in the same order a serial scan would.
+	unsigned int setsize = 0;
+	SplitCandidates.Clear();
 	while (seg != UINT_MAX)
 	{
 		FPrivSeg *pseg = &Segs[seg];
@@ -481,26 +487,54 @@ int FNodeBuilder::SelectSplitter (uint32_t set, node_t &node, uint32_t &splitseg
 				}
 
 				stepleft = step;
-				SetNodeFromSeg (node, pseg);
-
-				int value = Heuristic (node, set, nosplit);
+				SplitCandidates.Push(seg);
+			}
+		}
 
-				D(Printf (PRINT_LOG, "Seg %5d, ld %d (%5d,%5d)-(%5d,%5d) scores %d\n", seg, Segs[seg].linedef, node.x>>16, node.y>>16,
-					(node.x+node.dx)>>16, (node.y+node.dy)>>16, value));
+		setsize++;
+		seg = pseg->next;
+	}
 
-				if (value > bestvalue)
-				{
-					bestvalue = value;
-					bestseg = seg;
-				}
-				else if (value < 0)
-				{
-					nosplitters = true;
-				}
+	const int numcandidates = (int)SplitCandidates.Size();
+	SplitScores.Resize(numcandidates);
+	if (numcandidates >= 16 && uint64_t(numcandidates) * setsize >= (1 << 17))
+	{
+		const int chunk = 8;
+		parallel_for(0, numcandidates, chunk, [&](int first)
+		{
+			node_t testnode;
+			TArray<int> touched, colinear;
+			for (int i = first; i < MIN(first + chunk, numcandidates); i++)
+			{
+				SetNodeFromSeg (testnode, &Segs[SplitCandidates[i]]);
+				SplitScores[i] = Heuristic (testnode, set, nosplit, touched, colinear);
 			}
+		});
+	}
+	else
+	{
+		for (int i = 0; i < numcandidates; i++)
+		{
+			SetNodeFromSeg (node, &Segs[SplitCandidates[i]]);
+			SplitScores[i] = Heuristic (node, set, nosplit, Touched, Colinear);
 		}
+	}
 
-		seg = pseg->next;
+	for (int i = 0; i < numcandidates; i++)
+	{
+		int value = SplitScores[i];
+
+		D(Printf (PRINT_LOG, "Seg %5d, ld %d scores %d\n", SplitCandidates[i], Segs[SplitCandidates[i]].linedef, value));
+
+		if (value > bestvalue)
+		{
+			bestvalue = value;
+			bestseg = SplitCandidates[i];
+		}
+		else if (value < 0)
+		{
+			nosplitters = true;
+		}
 	}
 
 	if (bestseg == UINT_MAX)
@@ -522,7 +556,7 @@ int FNodeBuilder::SelectSplitter (uint32_t set, node_t &node, uint32_t &splitseg
 // true. A score of 0 means that the splitter does not split any of the segs
 // in the set.
 
-int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit)
+int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit, TArray<int> &touched, TArray<int> &colinear)
 {
 	// Set the initial score above 0 so that near vertex anti-weighting is less likely to produce a negative score.
 	int score = 1000000;
@@ -537,8 +571,8 @@ int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit)
 	unsigned int max, m2, p, q;
 	double frac;
 
-	Touched.Clear ();
-	Colinear.Clear ();
+	touched.Clear ();
+	colinear.Clear ();
 
 	while (i != UINT_MAX)
 	{
@@ -564,32 +598,32 @@ int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit)
 			{
 				if ((sidev[0] | sidev[1]) != 0)
 				{
-					max = Touched.Size();
+					max = touched.Size();
 					for (p = 0; p < max; ++p)
 					{
-						if (Touched[p] == test->loopnum)
+						if (touched[p] == test->loopnum)
 						{
 							break;
 						}
 					}
 					if (p == max)
 					{
-						Touched.Push (test->loopnum);
+						touched.Push (test->loopnum);
 					}
 				}
 				else
 				{
-					max = Colinear.Size();
+					max = colinear.Size();
 					for (p = 0; p < max; ++p)
 					{
-						if (Colinear[p] == test->loopnum)
+						if (colinear[p] == test->loopnum)
 						{
 							break;
 						}
 					}
 					if (p == max)
 					{
-						Colinear.Push (test->loopnum);
+						colinear.Push (test->loopnum);
 					}
 				}
 			}
@@ -706,8 +740,8 @@ int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit)
 	// seg of that sector must be crossing the container's corner and does not
 	// actually split the container.
 
-	max = Touched.Size ();
-	m2 = Colinear.Size ();
+	max = touched.Size ();
+	m2 = colinear.Size ();
 
 	// If honorNoSplit is false, then both these lists will be empty.
 
@@ -720,10 +754,10 @@ int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit)
 
 	for (p = 0; p < max; ++p)
 	{
-		int look = Touched[p];
+		int look = touched[p];
 		for (q = 0; q < m2; ++q)
 		{
-			if (look == Colinear[q])
+			if (look == colinear[q])
 			{
 				break;
 			}
@@ -1,9 +1,27 @@
 #include "doomtype.h"
 #include "nodebuild.h"
+#include "c_dispatch.h"
+#include "g_levellocals.h"
+#include "stats.h"
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define CLASSIFY_NEON 1
+#else
+#define CLASSIFY_NEON 0
+#endif
 
 #define FAR_ENOUGH 17179869184.f		// 4<<32
 
-int FNodeBuilder::ClassifyLine(node_t &node, const FPrivVert *v1, const FPrivVert *v2, int sidev[2])
+//==========================================================================
+//
+// The side numerators of both vertices. The NEON version computes both
+// lanes with the same sequence of double precision operations as the
+// scalar one so the results are identical.
+//
+//==========================================================================
+
+static inline void SideNumerators(const node_t &node, const FSimpleVert *v1, const FSimpleVert *v2, double &s_num1, double &s_num2)
 {
 	double d_x1 = double(node.x);
 	double d_y1 = double(node.y);
@@ -14,8 +32,39 @@ int FNodeBuilder::ClassifyLine(node_t &node, const FPrivVert *v1, const FPrivVer
 	double d_yv1 = double(v1->y);
 	double d_yv2 = double(v2->y);
 
-	double s_num1 = (d_y1 - d_yv1) * d_dx - (d_x1 - d_xv1) * d_dy;
-	double s_num2 = (d_y1 - d_yv2) * d_dx - (d_x1 - d_xv2) * d_dy;
+	s_num1 = (d_y1 - d_yv1) * d_dx - (d_x1 - d_xv1) * d_dy;
+	s_num2 = (d_y1 - d_yv2) * d_dx - (d_x1 - d_xv2) * d_dy;
+}
+
+#if CLASSIFY_NEON
+static inline void SideNumeratorsNEON(const node_t &node, const FSimpleVert *v1, const FSimpleVert *v2, double &s_num1, double &s_num2)
+{
+	int32x2_t xv = { v1->x, v2->x };
+	int32x2_t yv = { v1->y, v2->y };
+	float64x2_t d_xv = vcvtq_f64_s64(vmovl_s32(xv));
+	float64x2_t d_yv = vcvtq_f64_s64(vmovl_s32(yv));
+
+	float64x2_t ty = vmulq_f64(vsubq_f64(vdupq_n_f64(double(node.y)), d_yv), vdupq_n_f64(double(node.dx)));
+	float64x2_t tx = vmulq_f64(vsubq_f64(vdupq_n_f64(double(node.x)), d_xv), vdupq_n_f64(double(node.dy)));
+	float64x2_t num = vsubq_f64(ty, tx);
+
+	s_num1 = vgetq_lane_f64(num, 0);
+	s_num2 = vgetq_lane_f64(num, 1);
+}
+#endif
+
+template<bool UseNEON>
+static int ClassifyLineImpl(const node_t &node, const FSimpleVert *v1, const FSimpleVert *v2, int sidev[2])
+{
+	double d_dx = double(node.dx);
+	double d_dy = double(node.dy);
+	double s_num1, s_num2;
+
+#if CLASSIFY_NEON
+	if (UseNEON) SideNumeratorsNEON(node, v1, v2, s_num1, s_num2);
+	else
+#endif
+	SideNumerators(node, v1, v2, s_num1, s_num2);
 
 	int nears = 0;
 
@@ -134,3 +183,82 @@ int FNodeBuilder::ClassifyLine(node_t &node, const FPrivVert *v1, const FPrivVer
 	}
 	return -1;
 }
+
+int FNodeBuilder::ClassifyLine(node_t &node, const FPrivVert *v1, const FPrivVert *v2, int sidev[2])
+{
+	return ClassifyLineImpl<CLASSIFY_NEON>(node, v1, v2, sidev);
+}
+
+//==========================================================================
+//
+// Compares the classification kernels on the current level's segs, using
+// every 16th seg as a splitter, and reports their speed and any results that
+// differ between them.
+//
+//==========================================================================
+
+CCMD(benchclassify)
+{
+	if (level.segs.Size() == 0)
+	{
+		Printf("No level loaded\n");
+		return;
+	}
+
+	TArray<FSimpleVert> verts;
+	verts.Resize(level.segs.Size() * 2);
+	for (unsigned i = 0; i < level.segs.Size(); i++)
+	{
+		verts[i * 2].x = FLOAT2FIXED(level.segs[i].v1->fX());
+		verts[i * 2].y = FLOAT2FIXED(level.segs[i].v1->fY());
+		verts[i * 2 + 1].x = FLOAT2FIXED(level.segs[i].v2->fX());
+		verts[i * 2 + 1].y = FLOAT2FIXED(level.segs[i].v2->fY());
+	}
+
+	TArray<node_t> splitters;
+	for (unsigned i = 0; i < level.segs.Size(); i += 16)
+	{
+		node_t node;
+		node.x = verts[i * 2].x;
+		node.y = verts[i * 2].y;
+		node.dx = verts[i * 2 + 1].x - node.x;
+		node.dy = verts[i * 2 + 1].y - node.y;
+		if (node.dx != 0 || node.dy != 0) splitters.Push(node);
+	}
+
+	auto run = [&](auto kernel, TArray<int> &results)
+	{
+		cycle_t timer;
+		timer.Reset();
+		timer.Clock();
+		for (auto &node : splitters)
+		{
+			for (unsigned i = 0; i < level.segs.Size(); i++)
+			{
+				int sidev[2];
+				int side = kernel(node, &verts[i * 2], &verts[i * 2 + 1], sidev);
+				results.Push(side | (sidev[0] * 4) | (sidev[1] * 16));
+			}
+		}
+		timer.Unclock();
+		return timer.TimeMS();
+	};
+
+	uint64_t count = uint64_t(splitters.Size()) * level.segs.Size();
+	TArray<int> scalar;
+	scalar.Grow(unsigned(count));
+	double scalartime = run(ClassifyLineImpl<false>, scalar);
+	Printf("scalar: %.3f ms, %.2f ns per seg\n", scalartime, scalartime * 1e6 / count);
+
+#if CLASSIFY_NEON
+	TArray<int> neon;
+	neon.Grow(unsigned(count));
+	double neontime = run(ClassifyLineImpl<true>, neon);
+	unsigned mismatches = 0;
+	for (unsigned i = 0; i < scalar.Size(); i++)
+	{
+		if (scalar[i] != neon[i]) mismatches++;
+	}
+	Printf("NEON:   %.3f ms, %.2f ns per seg, %u mismatches\n", neontime, neontime * 1e6 / count, mismatches);
+#endif
+}
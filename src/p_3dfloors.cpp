@@ -401,6 +401,45 @@ bool P_CheckFor3DCeilingHit(AActor * mo, double z, bool trigger)
 	return false;
 }
 
+//==========================================================================
+//
+// Collects everything P_Recalculate3DFloors' result depends on. If this
+// is unchanged since the last run, the sorted ffloors and the lightlist
+// are still valid. Colormap changes are handled by P_RecalculateLights
+// and need not be part of it.
+//
+//==========================================================================
+
+template<class T> static void AddToKey(TArray<uint8_t> &key, const T &value)
+{
+	unsigned pos = key.Reserve(sizeof(T));
+	memcpy(&key[pos], &value, sizeof(T));
+}
+
+static void Get3DFloorKey(sector_t *sector, TArray<uint8_t> &key)
+{
+	key.Clear();
+	AddToKey(key, sector->centerspot);
+	AddToKey(key, sector->ceilingplane.Normal());
+	AddToKey(key, sector->ceilingplane.fD());
+	AddToKey(key, sector->floorplane.ZatPoint(sector->centerspot));
+	for (auto rover : sector->e->XFloor.ffloors)
+	{
+		if (rover->flags & FF_DYNAMIC) continue;
+
+		// FF_CLIPPED gets reset before the floors are sorted again.
+		unsigned flags = rover->flags;
+		if (flags & FF_CLIPPED) flags = (flags & ~FF_CLIPPED) | FF_EXISTS;
+
+		AddToKey(key, rover);
+		AddToKey(key, flags);
+		AddToKey(key, rover->top.plane->Normal());
+		AddToKey(key, rover->top.plane->fD());
+		AddToKey(key, rover->bottom.plane->Normal());
+		AddToKey(key, rover->bottom.plane->fD());
+	}
+}
+
 //==========================================================================
 //
 // P_Recalculate3DFloors
@@ -408,9 +447,13 @@ bool P_CheckFor3DCeilingHit(AActor * mo, double z, bool trigger)
 // This function sorts the ffloors by height and creates the lightlists 
 // that the given sector uses to light floors/ceilings/walls according to the 3D floors.
 //
+// With onlyifchanged set nothing is done if neither the sector's planes
+// nor its 3D floors changed since the last call. Moving lifts and their
+// interpolation call this for every attached sector each tic and frame.
+//
 //==========================================================================
 
-void P_Recalculate3DFloors(sector_t * sector)
+void P_Recalculate3DFloors(sector_t * sector, bool onlyifchanged)
 {
 	F3DFloor *		rover;
 	F3DFloor *		pick;
@@ -428,6 +471,24 @@ void P_Recalculate3DFloors(sector_t * sector)
 	TArray<F3DFloor*> & ffloors=sector->e->XFloor.ffloors;
 	TArray<lightlist_t> & lightlist = sector->e->XFloor.lightlist;
 
+	if (ffloors.Size() == 0)
+	{
+		sector->e->XFloor.recalckey.Clear();
+		return;
+	}
+	else
+	{
+		static TArray<uint8_t> key;
+		auto &lastkey = sector->e->XFloor.recalckey;
+
+		Get3DFloorKey(sector, key);
+		if (onlyifchanged && key.Size() == lastkey.Size() && !memcmp(key.Data(), lastkey.Data(), key.Size()))
+		{
+			return;
+		}
+		lastkey = key;
+	}
+
 	// Sort the floors top to bottom for quicker access here and later
 	// Translucent and swimmable floors are split if they overlap with solid ones.
 	if (ffloors.Size()>1)
@@ -453,16 +514,23 @@ void P_Recalculate3DFloors(sector_t * sector)
 			}
 		}
 
+		// The top heights are needed over and over while sorting so only calculate them once.
+		TArray<double> oldheights(oldlist.Size());
+		for (auto rover : oldlist)
+		{
+			oldheights.Push(rover->top.plane->ZatPoint(sector->centerspot));
+		}
+
 		while (oldlist.Size())
 		{
 			pick=oldlist[0];
-			double height=pick->top.plane->ZatPoint(sector->centerspot);
+			double height=oldheights[0];
 
 			// find highest starting ffloor - intersections are not supported!
 			pickindex=0;
 			for (j=1;j<oldlist.Size();j++)
 			{
-				double h2=oldlist[j]->top.plane->ZatPoint(sector->centerspot);
+				double h2=oldheights[j];
 
 				if (h2>height)
 				{
@@ -473,6 +541,7 @@ void P_Recalculate3DFloors(sector_t * sector)
 			}
 
 			oldlist.Delete(pickindex);
+			oldheights.Delete(pickindex);
 			double pick_bottom=pick->bottom.plane->ZatPoint(sector->centerspot);
 
 			if (pick->flags & FF_THISINSIDE)
@@ -668,6 +737,7 @@ void P_ClearDynamic3DFloorData()
 	for (auto &sec : level.sectors)
 	{
 		TArray<F3DFloor*> & ffloors = sec.e->XFloor.ffloors;
+		sec.e->XFloor.recalckey.Clear();
 
 		// delete the dynamic stuff
 		for (unsigned i = 0; i < ffloors.Size(); i++)
@@ -702,9 +772,9 @@ void P_RecalculateAttached3DFloors(sector_t * sec)
 
 	for(unsigned int i=0; i<x.attached.Size(); i++)
 	{
-		P_Recalculate3DFloors(x.attached[i]);
+		P_Recalculate3DFloors(x.attached[i], true);
 	}
-	P_Recalculate3DFloors(sec);
+	P_Recalculate3DFloors(sec, true);
 }
 
 //==========================================================================
@@ -119,7 +119,7 @@ void P_PlayerOnSpecial3DFloor(player_t* player);
 
 bool P_CheckFor3DFloorHit(AActor * mo, double z, bool trigger);
 bool P_CheckFor3DCeilingHit(AActor * mo, double z, bool trigger);
-void P_Recalculate3DFloors(sector_t *);
+void P_Recalculate3DFloors(sector_t *, bool onlyifchanged = false);
 void P_RecalculateAttached3DFloors(sector_t * sec);
 void P_RecalculateLights(sector_t *sector);
 void P_RecalculateAttachedLights(sector_t *sector);
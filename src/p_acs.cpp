@@ -36,6 +36,7 @@
 */
 
 #include <assert.h>
+#include <algorithm>
 
 #include "templates.h"
 #include "doomdef.h"
@@ -80,6 +81,7 @@
 #include "vm.h"
 #include "scriptutil.h"
 #include "s_music.h"
+#include "i_time.h"
 
 	// P-codes for ACS scripts
 	enum
@@ -842,6 +844,13 @@ inline int uallong(const int &foo)
 //
 //============================================================================
 
+void ACS_BoundsError(const char *message)
+{
+	I_Error("%s", message);
+	// I_Error throws, this is only here so the compiler can see it.
+	abort();
+}
+
 // ACS variables with world scope
 static BoundsCheckingArray<int32_t, NUM_WORLDVARS> ACS_WorldVars;
 static BoundsCheckingArray<FWorldGlobalArray, NUM_WORLDVARS> ACS_WorldArrays;
@@ -957,8 +966,11 @@ void ACSStringPool::PoolEntry::Unlock()
 
 ACSStringPool::ACSStringPool()
 {
-	memset(PoolBuckets, 0xFF, sizeof(PoolBuckets));
+	HashTable.Resize(MIN_HASH_SIZE);
+	memset(&HashTable[0], 0xFF, MIN_HASH_SIZE * sizeof(unsigned int));
+	HashUsed = 0;
 	FirstFreeEntry = 0;
+	StringBytes = 0;
 }
 
 //============================================================================
@@ -972,8 +984,52 @@ ACSStringPool::ACSStringPool()
 void ACSStringPool::Clear()
 {
 	Pool.Clear();
-	memset(PoolBuckets, 0xFF, sizeof(PoolBuckets));
+	RebuildHash(0);
 	FirstFreeEntry = 0;
+	StringBytes = 0;
+	UpdateMemoryUsage();
+}
+
+//============================================================================
+//
+// ACSStringPool :: RebuildHash
+//
+// Sizes the hash table for the given number of strings and reinserts all
+// entries that are in use.
+//
+//============================================================================
+
+void ACSStringPool::RebuildHash(unsigned int live)
+{
+	unsigned int size = MIN_HASH_SIZE;
+	while (size < live * 2) size <<= 1;
+
+	HashTable.Resize(size);
+	memset(&HashTable[0], 0xFF, size * sizeof(unsigned int));
+	HashUsed = 0;
+
+	unsigned int mask = size - 1;
+	for (unsigned int i = 0; i < Pool.Size(); ++i)
+	{
+		if (Pool[i].Next != FREE_ENTRY)
+		{
+			unsigned int slot = Pool[i].Hash & mask;
+			while (HashTable[slot] != NO_ENTRY) slot = (slot + 1) & mask;
+			HashTable[slot] = i;
+			HashUsed++;
+		}
+	}
+}
+
+//============================================================================
+//
+// ACSStringPool :: UpdateMemoryUsage
+//
+//============================================================================
+
+void ACSStringPool::UpdateMemoryUsage()
+{
+	M_SetMemoryUsage(MEMTAG_ACSSTRINGS, StringBytes + Pool.Max() * sizeof(PoolEntry) + HashTable.Size() * sizeof(unsigned int));
 }
 
 //============================================================================
@@ -990,26 +1046,26 @@ int ACSStringPool::AddString(const char *str)
 	if (str == nullptr) str = "";
 	size_t len = strlen(str);
 	unsigned int h = SuperFastHash(str, len);
-	unsigned int bucketnum = h % NUM_BUCKETS;
-	int i = FindString(str, len, h, bucketnum);
+	unsigned int slot;
+	int i = FindString(str, len, h, slot);
 	if (i >= 0)
 	{
 		return i | STRPOOL_LIBRARYID_OR;
 	}
 	FString fstr(str);
-	return InsertString(fstr, h, bucketnum);
+	return InsertString(fstr, h, slot);
 }
 
 int ACSStringPool::AddString(FString &str)
 {
 	unsigned int h = SuperFastHash(str.GetChars(), str.Len());
-	unsigned int bucketnum = h % NUM_BUCKETS;
-	int i = FindString(str, str.Len(), h, bucketnum);
+	unsigned int slot;
+	int i = FindString(str, str.Len(), h, slot);
 	if (i >= 0)
 	{
 		return i | STRPOOL_LIBRARYID_OR;
 	}
-	return InsertString(str, h, bucketnum);
+	return InsertString(str, h, slot);
 }
 
 //============================================================================
@@ -1209,10 +1265,7 @@ void ACSStringPool::UnlockAll()
 
 void ACSStringPool::PurgeStrings()
 {
-	// Clear the hash buckets. We'll rebuild them as we decide what strings
-	// to keep and which to toss.
-	memset(PoolBuckets, 0xFF, sizeof(PoolBuckets));
-	size_t usedcount = 0, freedcount = 0;
+	unsigned int usedcount = 0, freedcount = 0;
 	for (unsigned int i = 0; i < Pool.Size(); ++i)
 	{
 		PoolEntry *entry = &Pool[i];
@@ -1228,20 +1281,19 @@ void ACSStringPool::PurgeStrings()
 					FirstFreeEntry = i;
 				}
 				// And free the string.
+				StringBytes -= entry->Str.Len() + 1;
 				entry->Str = "";
 			}
 			else
 			{
 				usedcount++;
-				// Rehash this entry.
-				unsigned int h = entry->Hash % NUM_BUCKETS;
-				entry->Next = PoolBuckets[h];
-				PoolBuckets[h] = i;
 				// Remove MarkString's mark.
 				entry->Mark = false;
 			}
 		}
 	}
+	RebuildHash(usedcount);
+	UpdateMemoryUsage();
 }
 
 //============================================================================
@@ -1253,11 +1305,16 @@ void ACSStringPool::PurgeStrings()
 //
 //============================================================================
 
-int ACSStringPool::FindString(const char *str, size_t len, unsigned int h, unsigned int bucketnum)
+int ACSStringPool::FindString(const char *str, size_t len, unsigned int h, unsigned int &slot)
 {
-	unsigned int i = PoolBuckets[bucketnum];
-	while (i != NO_ENTRY)
+	unsigned int mask = HashTable.Size() - 1;
+	for (slot = h & mask; ; slot = (slot + 1) & mask)
 	{
+		unsigned int i = HashTable[slot];
+		if (i == NO_ENTRY)
+		{
+			return -1;
+		}
 		PoolEntry *entry = &Pool[i];
 		assert(entry->Next != FREE_ENTRY);
 		if (entry->Hash == h && entry->Str.Len() == len &&
@@ -1265,9 +1322,7 @@ int ACSStringPool::FindString(const char *str, size_t len, unsigned int h, unsig
 		{
 			return i;
 		}
-		i = entry->Next;
 	}
-	return -1;
 }
 
 //============================================================================
@@ -1278,13 +1333,24 @@ int ACSStringPool::FindString(const char *str, size_t len, unsigned int h, unsig
 //
 //============================================================================
 
-int ACSStringPool::InsertString(FString &str, unsigned int h, unsigned int bucketnum)
+int ACSStringPool::InsertString(FString &str, unsigned int h, unsigned int slot)
 {
 	unsigned int index = FirstFreeEntry;
+	bool rehashed = false;
 	if (index >= MIN_GC_SIZE && index == Pool.Max())
 	{ // We will need to grow the array. Try a garbage collection first.
 		P_CollectACSGlobalStrings();
 		index = FirstFreeEntry;
+		rehashed = true;
+	}
+	if ((HashUsed + 1) * 4 > HashTable.Size() * 3)
+	{
+		RebuildHash(HashUsed + 1);
+		rehashed = true;
+	}
+	if (rehashed)
+	{ // The slot we were given is stale.
+		FindString(str.GetChars(), str.Len(), h, slot);
 	}
 	if (FirstFreeEntry >= STRPOOL_LIBRARYID_OR)
 	{ // If we go any higher, we'll collide with the library ID marker.
@@ -1302,10 +1368,13 @@ int ACSStringPool::InsertString(FString &str, unsigned int h, unsigned int bucke
 	PoolEntry *entry = &Pool[index];
 	entry->Str = str;
 	entry->Hash = h;
-	entry->Next = PoolBuckets[bucketnum];
+	entry->Next = NO_ENTRY;
 	entry->Mark = false;
 	entry->Locks.Clear();
-	PoolBuckets[bucketnum] = index;
+	HashTable[slot] = index;
+	HashUsed++;
+	StringBytes += str.Len() + 1;
+	UpdateMemoryUsage();
 	return index | STRPOOL_LIBRARYID_OR;
 }
 
@@ -1341,6 +1410,7 @@ void ACSStringPool::ReadStrings(FSerializer &file, const char *key)
 	if (file.BeginObject(key))
 	{
 		int poolsize = 0;
+		unsigned int live = 0;
 
 		file("poolsize", poolsize);
 		Pool.Resize(poolsize);
@@ -1364,19 +1434,20 @@ void ACSStringPool::ReadStrings(FSerializer &file, const char *key)
 						file("string", Pool[ii].Str)
 							("locks", Pool[ii].Locks);
 
-						unsigned h = SuperFastHash(Pool[ii].Str, Pool[ii].Str.Len());
-						unsigned bucketnum = h % NUM_BUCKETS;
-						Pool[ii].Hash = h;
-						Pool[ii].Next = PoolBuckets[bucketnum];
-						PoolBuckets[bucketnum] = ii;
+						Pool[ii].Hash = SuperFastHash(Pool[ii].Str, Pool[ii].Str.Len());
+						Pool[ii].Next = NO_ENTRY;
+						StringBytes += Pool[ii].Str.Len() + 1;
+						live++;
 					}
 					file.EndObject();
 				}
 			}
 		}
+		RebuildHash(live);
 	}
 
 	FindFirstFreeEntry(FirstFreeEntry);
+	UpdateMemoryUsage();
 }
 
 //============================================================================
@@ -2048,8 +2119,13 @@ bool FBehavior::StaticCheckAllGood ()
 	return true;
 }
 
+struct ACSProfileNode;
+static ACSProfileNode *ACSProfileRoot;
+static void ACSProfileForgetModules(ACSProfileNode *node);
+
 void FBehavior::StaticUnloadModules ()
 {
+	ACSProfileForgetModules(ACSProfileRoot);
 	for (unsigned int i = StaticModules.Size(); i-- > 0; )
 	{
 		delete StaticModules[i];
@@ -3509,6 +3585,7 @@ cycle_t ACSTime;
 
 void DACSThinker::Tick ()
 {
+	PROFILE_ZONE("ACS");
 	ACSTime.Reset();
 	ACSTime.Clock();
 	DLevelScript *script = Scripts;
@@ -4105,17 +4182,42 @@ int DoGetMasterTID (AActor *self)
 	else return 0;
 }
 
+//============================================================================
+//
+// SingleActorFromTID
+//
+// Scripts that poll the properties of many TIDs every tic would otherwise
+// walk the same hash chains over and over, so the results are kept in a
+// small direct mapped cache until the TID hash changes.
+//
+//============================================================================
+
+struct FTIDCacheEntry
+{
+	int TID;
+	unsigned Generation;
+	AActor *Actor;
+};
+static FTIDCacheEntry TIDCache[256];
+
 AActor *SingleActorFromTID (int tid, AActor *defactor)
 {
 	if (tid == 0)
 	{
 		return defactor;
 	}
-	else
+
+	FTIDCacheEntry &entry = TIDCache[tid & (countof(TIDCache) - 1)];
+	if (entry.TID == tid && entry.Generation == AActor::TIDHashGeneration &&
+		(entry.Actor == nullptr || entry.Actor->tid == tid))
 	{
-		FActorIterator iterator (tid);
-		return iterator.Next();
+		return entry.Actor;
 	}
+	FActorIterator iterator (tid);
+	entry.TID = tid;
+	entry.Actor = iterator.Next();
+	entry.Generation = AActor::TIDHashGeneration;
+	return entry.Actor;
 }
 
 enum
@@ -6917,6 +7019,207 @@ static bool CharArrayParms(int &capacity, int &offset, int &a, FACSStackMemory&
 	return true;
 }
 
+//==========================================================================
+//
+// Timing profiler
+//
+// While acsprofile start is in effect, RunScript timestamps every
+// instruction and charges it to a call tree of scripts and the functions
+// they call. CallFunction and line specials are kept apart from the
+// interpreter's own time, and every p-code gets its own total, so the
+// expensive builtins show up. The timestamps make ACS run slower while
+// profiling; the proportions are what matters.
+//
+//==========================================================================
+
+struct ACSProfileNode
+{
+	ACSProfileInfo *Info = nullptr;
+	FString Name;
+	ACSProfileNode *Parent = nullptr;
+	TArray<ACSProfileNode *> Children;
+	uint64_t Self = 0;
+	uint64_t CallFunc = 0;
+	uint64_t Specials = 0;
+	unsigned Calls = 0;
+	bool IsFunction = false;
+
+	~ACSProfileNode()
+	{
+		for (auto child : Children) delete child;
+	}
+
+	uint64_t Inclusive() const
+	{
+		uint64_t total = Self + CallFunc + Specials;
+		for (auto child : Children) total += child->Inclusive();
+		return total;
+	}
+};
+
+static bool ACSProfileActive;
+static uint64_t ACSProfileStartTime, ACSProfileTotalTime;
+static int ACSProfileStartTic, ACSProfileTics;
+static uint64_t PCodeTime[PCODE_COMMAND_COUNT + 1];	// the last one is for unknown p-codes
+static unsigned PCodeCount[PCODE_COMMAND_COUNT + 1];
+
+static const char *const PCodeNames[PCODE_COMMAND_COUNT] =
+{
+	"NOP", "TERMINATE", "SUSPEND", "PUSHNUMBER", "LSPEC1", "LSPEC2", "LSPEC3", "LSPEC4", "LSPEC5",
+	"LSPEC1DIRECT", "LSPEC2DIRECT", "LSPEC3DIRECT", "LSPEC4DIRECT", "LSPEC5DIRECT", "ADD", "SUBTRACT",
+	"MULTIPLY", "DIVIDE", "MODULUS", "EQ", "NE", "LT", "GT", "LE", "GE", "ASSIGNSCRIPTVAR",
+	"ASSIGNMAPVAR", "ASSIGNWORLDVAR", "PUSHSCRIPTVAR", "PUSHMAPVAR", "PUSHWORLDVAR", "ADDSCRIPTVAR",
+	"ADDMAPVAR", "ADDWORLDVAR", "SUBSCRIPTVAR", "SUBMAPVAR", "SUBWORLDVAR", "MULSCRIPTVAR",
+	"MULMAPVAR", "MULWORLDVAR", "DIVSCRIPTVAR", "DIVMAPVAR", "DIVWORLDVAR", "MODSCRIPTVAR",
+	"MODMAPVAR", "MODWORLDVAR", "INCSCRIPTVAR", "INCMAPVAR", "INCWORLDVAR", "DECSCRIPTVAR",
+	"DECMAPVAR", "DECWORLDVAR", "GOTO", "IFGOTO", "DROP", "DELAY", "DELAYDIRECT", "RANDOM",
+	"RANDOMDIRECT", "THINGCOUNT", "THINGCOUNTDIRECT", "TAGWAIT", "TAGWAITDIRECT", "POLYWAIT",
+	"POLYWAITDIRECT", "CHANGEFLOOR", "CHANGEFLOORDIRECT", "CHANGECEILING", "CHANGECEILINGDIRECT",
+	"RESTART", "ANDLOGICAL", "ORLOGICAL", "ANDBITWISE", "ORBITWISE", "EORBITWISE", "NEGATELOGICAL",
+	"LSHIFT", "RSHIFT", "UNARYMINUS", "IFNOTGOTO", "LINESIDE", "SCRIPTWAIT", "SCRIPTWAITDIRECT",
+	"CLEARLINESPECIAL", "CASEGOTO", "BEGINPRINT", "ENDPRINT", "PRINTSTRING", "PRINTNUMBER",
+	"PRINTCHARACTER", "PLAYERCOUNT", "GAMETYPE", "GAMESKILL", "TIMER", "SECTORSOUND", "AMBIENTSOUND",
+	"SOUNDSEQUENCE", "SETLINETEXTURE", "SETLINEBLOCKING", "SETLINESPECIAL", "THINGSOUND",
+	"ENDPRINTBOLD", "ACTIVATORSOUND", "LOCALAMBIENTSOUND", "SETLINEMONSTERBLOCKING",
+	"PLAYERBLUESKULL", "PLAYERREDSKULL", "PLAYERYELLOWSKULL", "PLAYERMASTERSKULL", "PLAYERBLUECARD",
+	"PLAYERREDCARD", "PLAYERYELLOWCARD", "PLAYERMASTERCARD", "PLAYERBLACKSKULL", "PLAYERSILVERSKULL",
+	"PLAYERGOLDSKULL", "PLAYERBLACKCARD", "PLAYERSILVERCARD", "ISNETWORKGAME", "PLAYERTEAM",
+	"PLAYERHEALTH", "PLAYERARMORPOINTS", "PLAYERFRAGS", "PLAYEREXPERT", "BLUETEAMCOUNT",
+	"REDTEAMCOUNT", "BLUETEAMSCORE", "REDTEAMSCORE", "ISONEFLAGCTF", "LSPEC6", "LSPEC6DIRECT",
+	"PRINTNAME", "MUSICCHANGE", "CONSOLECOMMANDDIRECT", "CONSOLECOMMAND", "SINGLEPLAYER", "FIXEDMUL",
+	"FIXEDDIV", "SETGRAVITY", "SETGRAVITYDIRECT", "SETAIRCONTROL", "SETAIRCONTROLDIRECT",
+	"CLEARINVENTORY", "GIVEINVENTORY", "GIVEINVENTORYDIRECT", "TAKEINVENTORY", "TAKEINVENTORYDIRECT",
+	"CHECKINVENTORY", "CHECKINVENTORYDIRECT", "SPAWN", "SPAWNDIRECT", "SPAWNSPOT", "SPAWNSPOTDIRECT",
+	"SETMUSIC", "SETMUSICDIRECT", "LOCALSETMUSIC", "LOCALSETMUSICDIRECT", "PRINTFIXED",
+	"PRINTLOCALIZED", "MOREHUDMESSAGE", "OPTHUDMESSAGE", "ENDHUDMESSAGE", "ENDHUDMESSAGEBOLD",
+	"SETSTYLE", "SETSTYLEDIRECT", "SETFONT", "SETFONTDIRECT", "PUSHBYTE", "LSPEC1DIRECTB",
+	"LSPEC2DIRECTB", "LSPEC3DIRECTB", "LSPEC4DIRECTB", "LSPEC5DIRECTB", "DELAYDIRECTB",
+	"RANDOMDIRECTB", "PUSHBYTES", "PUSH2BYTES", "PUSH3BYTES", "PUSH4BYTES", "PUSH5BYTES",
+	"SETTHINGSPECIAL", "ASSIGNGLOBALVAR", "PUSHGLOBALVAR", "ADDGLOBALVAR", "SUBGLOBALVAR",
+	"MULGLOBALVAR", "DIVGLOBALVAR", "MODGLOBALVAR", "INCGLOBALVAR", "DECGLOBALVAR", "FADETO",
+	"FADERANGE", "CANCELFADE", "PLAYMOVIE", "SETFLOORTRIGGER", "SETCEILINGTRIGGER", "GETACTORX",
+	"GETACTORY", "GETACTORZ", "STARTTRANSLATION", "TRANSLATIONRANGE1", "TRANSLATIONRANGE2",
+	"ENDTRANSLATION", "CALL", "CALLDISCARD", "RETURNVOID", "RETURNVAL", "PUSHMAPARRAY",
+	"ASSIGNMAPARRAY", "ADDMAPARRAY", "SUBMAPARRAY", "MULMAPARRAY", "DIVMAPARRAY", "MODMAPARRAY",
+	"INCMAPARRAY", "DECMAPARRAY", "DUP", "SWAP", "WRITETOINI", "GETFROMINI", "SIN", "COS",
+	"VECTORANGLE", "CHECKWEAPON", "SETWEAPON", "TAGSTRING", "PUSHWORLDARRAY", "ASSIGNWORLDARRAY",
+	"ADDWORLDARRAY", "SUBWORLDARRAY", "MULWORLDARRAY", "DIVWORLDARRAY", "MODWORLDARRAY",
+	"INCWORLDARRAY", "DECWORLDARRAY", "PUSHGLOBALARRAY", "ASSIGNGLOBALARRAY", "ADDGLOBALARRAY",
+	"SUBGLOBALARRAY", "MULGLOBALARRAY", "DIVGLOBALARRAY", "MODGLOBALARRAY", "INCGLOBALARRAY",
+	"DECGLOBALARRAY", "SETMARINEWEAPON", "SETACTORPROPERTY", "GETACTORPROPERTY", "PLAYERNUMBER",
+	"ACTIVATORTID", "SETMARINESPRITE", "GETSCREENWIDTH", "GETSCREENHEIGHT", "THING_PROJECTILE2",
+	"STRLEN", "SETHUDSIZE", "GETCVAR", "CASEGOTOSORTED", "SETRESULTVALUE", "GETLINEROWOFFSET",
+	"GETACTORFLOORZ", "GETACTORANGLE", "GETSECTORFLOORZ", "GETSECTORCEILINGZ", "LSPEC5RESULT",
+	"GETSIGILPIECES", "GETLEVELINFO", "CHANGESKY", "PLAYERINGAME", "PLAYERISBOT",
+	"SETCAMERATOTEXTURE", "ENDLOG", "GETAMMOCAPACITY", "SETAMMOCAPACITY", "PRINTMAPCHARARRAY",
+	"PRINTWORLDCHARARRAY", "PRINTGLOBALCHARARRAY", "SETACTORANGLE", "GRABINPUT", "SETMOUSEPOINTER",
+	"MOVEMOUSEPOINTER", "SPAWNPROJECTILE", "GETSECTORLIGHTLEVEL", "GETACTORCEILINGZ",
+	"SETACTORPOSITION", "CLEARACTORINVENTORY", "GIVEACTORINVENTORY", "TAKEACTORINVENTORY",
+	"CHECKACTORINVENTORY", "THINGCOUNTNAME", "SPAWNSPOTFACING", "PLAYERCLASS", "ANDSCRIPTVAR",
+	"ANDMAPVAR", "ANDWORLDVAR", "ANDGLOBALVAR", "ANDMAPARRAY", "ANDWORLDARRAY", "ANDGLOBALARRAY",
+	"EORSCRIPTVAR", "EORMAPVAR", "EORWORLDVAR", "EORGLOBALVAR", "EORMAPARRAY", "EORWORLDARRAY",
+	"EORGLOBALARRAY", "ORSCRIPTVAR", "ORMAPVAR", "ORWORLDVAR", "ORGLOBALVAR", "ORMAPARRAY",
+	"ORWORLDARRAY", "ORGLOBALARRAY", "LSSCRIPTVAR", "LSMAPVAR", "LSWORLDVAR", "LSGLOBALVAR",
+	"LSMAPARRAY", "LSWORLDARRAY", "LSGLOBALARRAY", "RSSCRIPTVAR", "RSMAPVAR", "RSWORLDVAR",
+	"RSGLOBALVAR", "RSMAPARRAY", "RSWORLDARRAY", "RSGLOBALARRAY", "GETPLAYERINFO", "CHANGELEVEL",
+	"SECTORDAMAGE", "REPLACETEXTURES", "NEGATEBINARY", "GETACTORPITCH", "SETACTORPITCH", "PRINTBIND",
+	"SETACTORSTATE", "THINGDAMAGE2", "USEINVENTORY", "USEACTORINVENTORY", "CHECKACTORCEILINGTEXTURE",
+	"CHECKACTORFLOORTEXTURE", "GETACTORLIGHTLEVEL", "SETMUGSHOTSTATE", "THINGCOUNTSECTOR",
+	"THINGCOUNTNAMESECTOR", "CHECKPLAYERCAMERA", "MORPHACTOR", "UNMORPHACTOR", "GETPLAYERINPUT",
+	"CLASSIFYACTOR", "PRINTBINARY", "PRINTHEX", "CALLFUNC", "SAVESTRING", "PRINTMAPCHRANGE",
+	"PRINTWORLDCHRANGE", "PRINTGLOBALCHRANGE", "STRCPYTOMAPCHRANGE", "STRCPYTOWORLDCHRANGE",
+	"STRCPYTOGLOBALCHRANGE", "PUSHFUNCTION", "CALLSTACK", "SCRIPTWAITNAMED", "TRANSLATIONRANGE3",
+	"GOTOSTACK", "ASSIGNSCRIPTARRAY", "PUSHSCRIPTARRAY", "ADDSCRIPTARRAY", "SUBSCRIPTARRAY",
+	"MULSCRIPTARRAY", "DIVSCRIPTARRAY", "MODSCRIPTARRAY", "INCSCRIPTARRAY", "DECSCRIPTARRAY",
+	"ANDSCRIPTARRAY", "EORSCRIPTARRAY", "ORSCRIPTARRAY", "LSSCRIPTARRAY", "RSSCRIPTARRAY",
+	"PRINTSCRIPTCHARARRAY", "PRINTSCRIPTCHRANGE", "STRCPYTOSCRIPTCHRANGE", "LSPEC5EX",
+	"LSPEC5EXRESULT", "TRANSLATIONRANGE4", "TRANSLATIONRANGE5"
+};
+
+//==========================================================================
+//
+// Names scripts and functions the way acsprofile lists them
+//
+//==========================================================================
+
+static FString ACSProfileName(FBehavior *module, int index, bool function)
+{
+	FString name;
+	if (function)
+	{
+		uint32_t *fnames = (uint32_t *)module->FindChunk(MAKE_ID('F','N','A','M'));
+		if (fnames != nullptr && index >= 0 && index < (int)LittleLong(fnames[2]))
+		{
+			name.Format("%s:%s", module->GetModuleName(), (char *)(fnames + 2) + LittleLong(fnames[3+index]));
+		}
+		else
+		{
+			name.Format("%s:Function %d", module->GetModuleName(), index);
+		}
+	}
+	else
+	{
+		name.Format("%s:%s", module->GetModuleName(), ScriptPresentation(module->GetScriptPtr(index)->Number).GetChars() + 7);
+	}
+	return name;
+}
+
+static ACSProfileNode *ACSProfileEnter(ACSProfileNode *node, ACSProfileInfo *info, FBehavior *module, int index, bool function)
+{
+	ACSProfileNode *child = nullptr;
+	for (auto c : node->Children)
+	{
+		if (c->Info == info)
+		{
+			child = c;
+			break;
+		}
+	}
+	if (child == nullptr)
+	{
+		child = new ACSProfileNode;
+		child->Info = info;
+		child->Name = ACSProfileName(module, index, function);
+		child->Parent = node;
+		child->IsFunction = function;
+		node->Children.Push(child);
+	}
+	child->Calls++;
+	return child;
+}
+
+static void ACSProfileInstruction(ACSProfileNode *node, int pcd, uint64_t elapsed)
+{
+	unsigned slot = (unsigned)pcd < PCODE_COMMAND_COUNT ? pcd : PCODE_COMMAND_COUNT;
+	PCodeTime[slot] += elapsed;
+	PCodeCount[slot]++;
+	switch (pcd)
+	{
+	case PCD_CALLFUNC:
+		node->CallFunc += elapsed;
+		break;
+
+	case PCD_LSPEC1: case PCD_LSPEC2: case PCD_LSPEC3: case PCD_LSPEC4: case PCD_LSPEC5:
+	case PCD_LSPEC1DIRECT: case PCD_LSPEC2DIRECT: case PCD_LSPEC3DIRECT: case PCD_LSPEC4DIRECT: case PCD_LSPEC5DIRECT:
+	case PCD_LSPEC1DIRECTB: case PCD_LSPEC2DIRECTB: case PCD_LSPEC3DIRECTB: case PCD_LSPEC4DIRECTB: case PCD_LSPEC5DIRECTB:
+	case PCD_LSPEC5RESULT: case PCD_LSPEC5EX: case PCD_LSPEC5EXRESULT:
+		node->Specials += elapsed;
+		break;
+
+	default:
+		node->Self += elapsed;
+		break;
+	}
+}
+
+// Modules go away with their level. Their nodes keep the names but must not match new modules.
+static void ACSProfileForgetModules(ACSProfileNode *node)
+{
+	if (node == nullptr) return;
+	node->Info = nullptr;
+	for (auto child : node->Children) ACSProfileForgetModules(child);
+}
+
 int DLevelScript::RunScript ()
 {
 	DACSThinker *controller = DACSThinker::ActiveThinker;
@@ -7007,6 +7310,17 @@ int DLevelScript::RunScript ()
 	int optstart = -1;
 	int temp;
 
+	// Timing profiler state: the current node, and the node and p-code of the instruction being timed.
+	ACSProfileNode *profnode = nullptr, *profinstrnode = nullptr;
+	int profpcd = 0;
+	uint64_t proftime = 0;
+	if (ACSProfileActive && InModuleScriptNumber >= 0 && activeBehavior->GetScriptPtr(InModuleScriptNumber) != nullptr)
+	{
+		profnode = ACSProfileEnter(ACSProfileRoot, &activeBehavior->GetScriptPtr(InModuleScriptNumber)->ProfileData,
+			activeBehavior, InModuleScriptNumber, false);
+		proftime = I_nsTime();
+	}
+
 	while (state == SCRIPT_Running)
 	{
 		if (++runaway > 2000000)
@@ -7016,6 +7330,13 @@ int DLevelScript::RunScript ()
 			break;
 		}
 
+		if (profnode != nullptr)
+		{
+			uint64_t now = I_nsTime();
+			if (profinstrnode != nullptr) ACSProfileInstruction(profinstrnode, profpcd, now - proftime);
+			proftime = now;
+		}
+
 		if (fmt == ACS_LittleEnhanced)
 		{
 			pcd = getbyte(pc);
@@ -7028,6 +7349,8 @@ int DLevelScript::RunScript ()
 		{
 			pcd = NEXTWORD;
 		}
+		profinstrnode = profnode;
+		profpcd = pcd;
 
 		switch (pcd)
 		{
@@ -7333,6 +7656,10 @@ int DLevelScript::RunScript ()
 				activeFunction = func;
 				activeBehavior = module;
 				fmt = module->GetFormat();
+				if (profnode != nullptr)
+				{
+					profnode = ACSProfileEnter(profnode, module->GetFunctionProfileData(func), module, module->GetFunctionIndex(func), true);
+				}
 			}
 			break;
 
@@ -7369,6 +7696,7 @@ int DLevelScript::RunScript ()
 					Stack[sp++] = value;
 				}
 				ret->~CallReturn();
+				if (profnode != nullptr && profnode->IsFunction) profnode = profnode->Parent;
 			}
 			break;
 
@@ -10351,6 +10679,11 @@ scriptwait:
  		}
  	}
 
+	if (profinstrnode != nullptr)
+	{
+		ACSProfileInstruction(profinstrnode, profpcd, I_nsTime() - proftime);
+	}
+
 	if (runaway != 0 && InModuleScriptNumber >= 0)
 	{
 		auto scriptptr = activeBehavior->GetScriptPtr(InModuleScriptNumber);
@@ -10849,6 +11182,162 @@ static void ShowProfileData(TArray<ProfileCollector> &profiles, long ilimit,
 	}
 }
 
+//==========================================================================
+//
+// acsprofile start/stop/time/dump
+//
+//==========================================================================
+
+struct ACSProfileTotals
+{
+	FString Name;
+	uint64_t Inclusive;
+	uint64_t Self;
+	uint64_t CallFunc;
+	uint64_t Specials;
+	unsigned Calls;
+};
+
+static void ACSProfileStart()
+{
+	if (ACSProfileActive) return;
+	if (ACSProfileRoot == nullptr) ACSProfileRoot = new ACSProfileNode;
+	ACSProfileStartTime = I_nsTime();
+	ACSProfileStartTic = gametic;
+	ACSProfileActive = true;
+}
+
+static void ACSProfileStop()
+{
+	if (!ACSProfileActive) return;
+	ACSProfileTotalTime += I_nsTime() - ACSProfileStartTime;
+	ACSProfileTics += gametic - ACSProfileStartTic;
+	ACSProfileActive = false;
+}
+
+static void ACSProfileClear()
+{
+	delete ACSProfileRoot;
+	ACSProfileRoot = ACSProfileActive ? new ACSProfileNode : nullptr;
+	ACSProfileTotalTime = 0;
+	ACSProfileTics = 0;
+	ACSProfileStartTime = I_nsTime();
+	ACSProfileStartTic = gametic;
+	memset(PCodeTime, 0, sizeof(PCodeTime));
+	memset(PCodeCount, 0, sizeof(PCodeCount));
+}
+
+// Recursive calls only count towards inclusive time at their outermost level.
+static void ACSCollectTotals(ACSProfileNode *node, TMap<FString, unsigned> &index, TArray<ACSProfileTotals> &totals, TArray<ACSProfileNode *> &path)
+{
+	for (auto child : node->Children)
+	{
+		unsigned *pos = index.CheckKey(child->Name);
+		if (pos == nullptr)
+		{
+			index[child->Name] = totals.Size();
+			totals.Push({ child->Name, 0, 0, 0, 0, 0 });
+			pos = index.CheckKey(child->Name);
+		}
+		auto &entry = totals[*pos];
+		bool recursive = false;
+		for (auto caller : path) recursive |= caller->Name.Compare(child->Name) == 0;
+		if (!recursive) entry.Inclusive += child->Inclusive();
+		entry.Self += child->Self;
+		entry.CallFunc += child->CallFunc;
+		entry.Specials += child->Specials;
+		entry.Calls += child->Calls;
+
+		path.Push(child);
+		ACSCollectTotals(child, index, totals, path);
+		path.Pop();
+	}
+}
+
+static void ACSProfileReport(unsigned limit)
+{
+	if (ACSProfileRoot == nullptr)
+	{
+		Printf("No ACS timing profile has been recorded. Use acsprofile start.\n");
+		return;
+	}
+
+	TMap<FString, unsigned> index;
+	TArray<ACSProfileTotals> totals;
+	TArray<ACSProfileNode *> path;
+	ACSCollectTotals(ACSProfileRoot, index, totals, path);
+	std::sort(totals.begin(), totals.end(), [](const ACSProfileTotals &a, const ACSProfileTotals &b) { return a.Inclusive > b.Inclusive; });
+
+	int tics = MAX(ACSProfileTics + (ACSProfileActive ? gametic - ACSProfileStartTic : 0), 1);
+	Printf(TEXTCOLOR_YELLOW "%10s %10s %9s %10s %10s %8s  %s\n", "Total ms", "Self ms", "ms/tic", "Funcs ms", "Specs ms", "Calls", "Script/function");
+	for (unsigned i = 0; i < totals.Size() && (limit == 0 || i < limit); i++)
+	{
+		auto &entry = totals[i];
+		Printf("%10.3f %10.3f %9.4f %10.3f %10.3f %8u  %s\n", entry.Inclusive / 1e6, entry.Self / 1e6, entry.Inclusive / 1e6 / tics,
+			entry.CallFunc / 1e6, entry.Specials / 1e6, entry.Calls, entry.Name.GetChars());
+	}
+
+	// The most expensive p-codes, which is where builtins like HudMessage and GetActorProperty show up.
+	TArray<unsigned> pcodes;
+	for (unsigned i = 0; i <= PCODE_COMMAND_COUNT; i++)
+	{
+		if (PCodeCount[i] > 0) pcodes.Push(i);
+	}
+	std::sort(pcodes.begin(), pcodes.end(), [](unsigned a, unsigned b) { return PCodeTime[a] > PCodeTime[b]; });
+	Printf(TEXTCOLOR_YELLOW "\n%10s %12s %9s  %s\n", "Total ms", "Count", "ns/op", "P-code");
+	for (unsigned i = 0; i < pcodes.Size() && (limit == 0 || i < limit); i++)
+	{
+		unsigned p = pcodes[i];
+		Printf("%10.3f %12u %9.1f  %s\n", PCodeTime[p] / 1e6, PCodeCount[p], double(PCodeTime[p]) / PCodeCount[p],
+			p < PCODE_COMMAND_COUNT ? PCodeNames[p] : "(unknown)");
+	}
+	Printf("%d tics profiled\n", tics);
+}
+
+//==========================================================================
+//
+// Writes the call tree in the folded stack format used by vmprofile dump,
+// under a common ACS root, so both files can simply be concatenated and
+// fed to the same flame graph tool.
+//
+//==========================================================================
+
+static void ACSWriteFolded(FILE *file, ACSProfileNode *node, FString &path)
+{
+	for (auto child : node->Children)
+	{
+		size_t len = path.Len();
+		path << ';' << child->Name;
+
+		if (child->Self >= 1000) fprintf(file, "%s %llu\n", path.GetChars(), (unsigned long long)(child->Self / 1000));
+		if (child->CallFunc >= 1000) fprintf(file, "%s;[CallFunction] %llu\n", path.GetChars(), (unsigned long long)(child->CallFunc / 1000));
+		if (child->Specials >= 1000) fprintf(file, "%s;[LineSpecials] %llu\n", path.GetChars(), (unsigned long long)(child->Specials / 1000));
+		ACSWriteFolded(file, child, path);
+
+		path.Truncate(len);
+	}
+}
+
+static void ACSProfileDump(const char *filename)
+{
+	if (ACSProfileRoot == nullptr)
+	{
+		Printf("No ACS timing profile has been recorded. Use acsprofile start.\n");
+		return;
+	}
+
+	FILE *file = fopen(filename, "w");
+	if (file == nullptr)
+	{
+		Printf("Could not open %s for writing\n", filename);
+		return;
+	}
+	FString path = "ACS";
+	ACSWriteFolded(file, ACSProfileRoot, path);
+	fclose(file);
+	Printf("ACS profile written to %s\n", filename);
+}
+
 CCMD(acsprofile)
 {
 	static int (*sort_funcs[])(const void*, const void *) =
@@ -10878,6 +11367,28 @@ CCMD(acsprofile)
 		{
 			ClearProfiles(ScriptProfiles);
 			ClearProfiles(FuncProfiles);
+			ACSProfileClear();
+			return;
+		}
+		// `acsprofile start` and `stop` control the timing profiler, `time` and `dump` show its results.
+		if (stricmp(argv[1], "start") == 0)
+		{
+			ACSProfileStart();
+			return;
+		}
+		if (stricmp(argv[1], "stop") == 0)
+		{
+			ACSProfileStop();
+			return;
+		}
+		if (stricmp(argv[1], "time") == 0)
+		{
+			ACSProfileReport(argv.argc() >= 3 ? atoi(argv[2]) : 20);
+			return;
+		}
+		if (stricmp(argv[1], "dump") == 0)
+		{
+			ACSProfileDump(argv.argc() >= 3 ? argv[2] : "acsprofile.folded");
 			return;
 		}
 		for (int i = 1; i < argv.argc(); ++i)
@@ -10911,6 +11422,9 @@ CCMD(acsprofile)
 				Printf("Unknown option '%s'\n", argv[i]);
 				Printf("acsprofile clear : Reset profiling information\n");
 				Printf("acsprofile [total|min|max|avg|runs] [<limit>]\n");
+				Printf("acsprofile start|stop : Start or stop timing scripts\n");
+				Printf("acsprofile time [<limit>] : Show the timing results\n");
+				Printf("acsprofile dump [<filename>] : Write the timings as folded stacks\n");
 				return;
 			}
 		}
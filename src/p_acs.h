@@ -61,6 +61,11 @@ struct InitIntToZero
 };
 typedef TMap<int32_t, int32_t, THashTraits<int32_t>, InitIntToZero> FWorldGlobalArray;
 
+// Raises the error for a failed bounds check. Keeping it out of line and
+// noreturn lets the compiler treat the failing branch as cold, so the checks
+// on every stack and variable access in the interpreter stay cheap.
+[[noreturn]] void ACS_BoundsError(const char *message);
+
 // Type of elements count is unsigned int instead of size_t to match ACSStringPool interface
 template <typename T, unsigned int N>
 struct BoundsCheckingArray
@@ -69,7 +74,7 @@ struct BoundsCheckingArray
 	{
 		if (index >= N)
 		{
-			I_Error("Out of bounds memory access in ACS VM");
+			ACS_BoundsError("Out of bounds memory access in ACS VM");
 		}
 
 		return buffer[index];
@@ -118,11 +123,13 @@ public:
 	void WriteStrings(FSerializer &file, const char *key) const;
 
 private:
-	int FindString(const char *str, size_t len, unsigned int h, unsigned int bucketnum);
-	int InsertString(FString &str, unsigned int h, unsigned int bucketnum);
+	int FindString(const char *str, size_t len, unsigned int h, unsigned int &slot);
+	int InsertString(FString &str, unsigned int h, unsigned int slot);
 	void FindFirstFreeEntry(unsigned int base);
+	void RebuildHash(unsigned int live);
+	void UpdateMemoryUsage();
 
-	enum { NUM_BUCKETS = 251 };
+	enum { MIN_HASH_SIZE = 256 };
 	enum { FREE_ENTRY = 0xFFFFFFFE };	// Stored in PoolEntry's Next field
 	enum { NO_ENTRY = 0xFFFFFFFF };
 	enum { MIN_GC_SIZE = 100 };			// Don't auto-collect until there are this many strings
@@ -130,7 +137,7 @@ private:
 	{
 		FString Str;
 		unsigned int Hash;
-		unsigned int Next = FREE_ENTRY;
+		unsigned int Next = FREE_ENTRY;	// NO_ENTRY while the entry is in use
 		bool Mark;
 		TArray<int> Locks;
 
@@ -138,8 +145,12 @@ private:
 		void Unlock();
 	};
 	TArray<PoolEntry> Pool;
-	unsigned int PoolBuckets[NUM_BUCKETS];
+	// Open addressed index into Pool with linear probing. Its size is a power of two and
+	// it is kept at most 3/4 full. Only PurgeStrings removes entries, and it rebuilds it.
+	TArray<unsigned int> HashTable;
+	unsigned int HashUsed;
 	unsigned int FirstFreeEntry;
+	size_t StringBytes;
 };
 extern ACSStringPool GlobalACSStrings;
 
@@ -189,7 +200,7 @@ public:
 	{
 		if (index >= count)
 		{
-			I_Error("Out of bounds access to local variables in ACS VM");
+			ACS_BoundsError("Out of bounds access to local variables in ACS VM");
 		}
 
 		return memory[index];
@@ -377,6 +388,7 @@ public:
 	const char *GetModuleName() const { return ModuleName; }
 	ACSProfileInfo *GetFunctionProfileData(int index) { return index >= 0 && index < NumFunctions ? &FunctionProfileData[index] : NULL; }
 	ACSProfileInfo *GetFunctionProfileData(ScriptFunction *func) { return GetFunctionProfileData((int)(func - (ScriptFunction *)Functions)); }
+	int GetFunctionIndex(ScriptFunction *func) const { return (int)(func - (ScriptFunction *)Functions); }
 	const char *LookupString (uint32_t index, bool forprint = false) const;
 
 	BoundsCheckingArray<int32_t *, NUM_MAPVARS> MapVars;
@@ -187,32 +187,35 @@ static int CallStateChain (AActor *self, AActor *actor, FState *state)
 			{
                 state->CheckCallerType(actor, self);
 
-				if (state->ActionFunc->DefaultArgs.Size() > 0)
+				if (!(numret <= 1 && FState::CallDirectAction(state->ActionFunc, actor, self, &stp, wantret == &ret[0] ? &nextstate : nullptr)))
 				{
-					auto defs = state->ActionFunc->DefaultArgs;
-					auto index = actionParams.Reserve(defs.Size());
-					for (unsigned i = 0; i < defs.Size(); i++)
+					if (state->ActionFunc->DefaultArgs.Size() > 0)
 					{
-						actionParams[i + index] = defs[i];
-					}
+						auto &defs = state->ActionFunc->DefaultArgs;
+						auto index = actionParams.Reserve(defs.Size());
+						for (unsigned i = 0; i < defs.Size(); i++)
+						{
+							actionParams[i + index] = defs[i];
+						}
 
-					if (state->ActionFunc->ImplicitArgs >= 1)
-					{
-						actionParams[index] = actor;
+						if (state->ActionFunc->ImplicitArgs >= 1)
+						{
+							actionParams[index] = actor;
+						}
+						if (state->ActionFunc->ImplicitArgs == 3)
+						{
+							actionParams[index + 1] = self;
+							actionParams[index + 2] = VMValue(&stp);
+						}
+
+						VMCallAction(state->ActionFunc, &actionParams[index], state->ActionFunc->DefaultArgs.Size(), wantret, numret);
+						actionParams.Clamp(index);
 					}
-					if (state->ActionFunc->ImplicitArgs == 3)
+					else
 					{
-						actionParams[index + 1] = self;
-						actionParams[index + 2] = VMValue(&stp);
+						VMValue params[3] = { actor, self, VMValue(&stp) };
+						VMCallAction(state->ActionFunc, params, state->ActionFunc->ImplicitArgs, wantret, numret);
 					}
-
-					VMCallAction(state->ActionFunc, &actionParams[index], state->ActionFunc->DefaultArgs.Size(), wantret, numret);
-					actionParams.Clamp(index);
-				}
-				else
-				{
-					VMValue params[3] = { actor, self, VMValue(&stp) };
-					VMCallAction(state->ActionFunc, params, state->ActionFunc->ImplicitArgs, wantret, numret);
 				}
 			}
 			catch (CVMAbortException &err)
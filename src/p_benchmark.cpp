@@ -0,0 +1,323 @@
+/*
+** p_benchmark.cpp
+** Micro-benchmarks for the playsim's spatial queries
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**---------------------------------------------------------------------------
+**
+** 'benchplaysim [iterations] [seed]' times the collision, sight and trace
+** primitives on the current level. The test positions come from a fixed
+** seed, so two runs on the same map with the same seed do the same work.
+** Every test prints a checksum of its results next to its time, which
+** must not change when an optimization is supposed to be exact.
+**
+** Nothing that changes the level is called: traces use Trace() instead of
+** P_LineAttack, which spawns puffs, and the radius test does the blockmap
+** search, sight check and damage calculation of P_RadiusAttack without
+** dealing the damage. The test actor can't trigger lines.
+**
+*/
+
+#include <random>
+
+#include "doomstat.h"
+#include "c_dispatch.h"
+#include "stats.h"
+#include "actor.h"
+#include "p_local.h"
+#include "p_checkposition.h"
+#include "p_maputl.h"
+#include "p_trace.h"
+#include "g_levellocals.h"
+#include "r_defs.h"
+
+struct FBenchPoint
+{
+	DVector3 Pos;
+	DVector3 Target;	// a second point somewhere nearby
+	DAngle Angle;
+	DAngle Pitch;
+};
+
+class FPlaysimBench
+{
+public:
+	FPlaysimBench(unsigned seed) : Random(seed) {}
+
+	bool Setup(int count);
+	void Run();
+	void Cleanup();
+
+private:
+	double Uniform(double lo, double hi) { return std::uniform_real_distribution<double>(lo, hi)(Random); }
+	bool RandomPoint(DVector3 &pos, double x1, double y1, double x2, double y2);
+	void Place(AActor *mo, const DVector3 &pos, DAngle angle);
+	void Report(const char *name, cycle_t &time, unsigned checksum);
+
+	std::mt19937 Random;
+	TArray<FBenchPoint> Points;
+	AActor *Mover = nullptr;
+	AActor *Target = nullptr;
+};
+
+//==========================================================================
+//
+// Picks a point in the level where an actor of player size fits
+//
+//==========================================================================
+
+bool FPlaysimBench::RandomPoint(DVector3 &pos, double x1, double y1, double x2, double y2)
+{
+	for (int tries = 0; tries < 100; tries++)
+	{
+		DVector2 xy(Uniform(x1, x2), Uniform(y1, y2));
+		sector_t *sec = P_PointInSector(xy);
+		double floor = sec->floorplane.ZatPoint(xy);
+		double ceiling = sec->ceilingplane.ZatPoint(xy);
+		if (ceiling - floor >= 56)
+		{
+			pos = DVector3(xy, floor);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool FPlaysimBench::Setup(int count)
+{
+	if (level.vertexes.Size() == 0) return false;
+
+	double minx = level.vertexes[0].fX(), maxx = minx;
+	double miny = level.vertexes[0].fY(), maxy = miny;
+	for (auto &v : level.vertexes)
+	{
+		minx = MIN(minx, v.fX());
+		maxx = MAX(maxx, v.fX());
+		miny = MIN(miny, v.fY());
+		maxy = MAX(maxy, v.fY());
+	}
+
+	Points.Clear();
+	Points.Reserve(count);
+	for (auto &pt : Points)
+	{
+		if (!RandomPoint(pt.Pos, minx, miny, maxx, maxy)) return false;
+		if (!RandomPoint(pt.Target, pt.Pos.X - 1024, pt.Pos.Y - 1024, pt.Pos.X + 1024, pt.Pos.Y + 1024))
+		{
+			pt.Target = pt.Pos;
+		}
+		pt.Angle = DAngle(Uniform(0, 360));
+		pt.Pitch = DAngle(Uniform(-30, 30));
+	}
+
+	// Two player sized actors that block and can be shot, but never activate anything
+	for (AActor **mo : { &Mover, &Target })
+	{
+		*mo = Spawn(RUNTIME_CLASS(AActor), Points[0].Pos, NO_REPLACE);
+		(*mo)->UnlinkFromWorld(nullptr);
+		(*mo)->flags |= MF_SOLID | MF_SHOOTABLE;
+		(*mo)->flags6 |= MF6_NOTRIGGER;
+		(*mo)->radius = 16;
+		(*mo)->Height = 56;
+		(*mo)->LinkToWorld(nullptr);
+	}
+	return true;
+}
+
+void FPlaysimBench::Cleanup()
+{
+	if (Mover != nullptr) Mover->Destroy();
+	if (Target != nullptr) Target->Destroy();
+	Mover = Target = nullptr;
+}
+
+void FPlaysimBench::Place(AActor *mo, const DVector3 &pos, DAngle angle)
+{
+	mo->SetOrigin(pos, false);
+	mo->Angles.Yaw = angle;
+	mo->Vel.Zero();
+}
+
+void FPlaysimBench::Report(const char *name, cycle_t &time, unsigned checksum)
+{
+	Printf("%-18s %8u calls %10.3f ms %10.1f ns/call   checksum %08x\n",
+		name, Points.Size(), time.TimeMS(), time.TimeMS() * 1e6 / Points.Size(), checksum);
+}
+
+//==========================================================================
+//
+// Only the calls themselves are timed, the actors are moved into place
+// outside of the clock.
+//
+//==========================================================================
+
+void FPlaysimBench::Run()
+{
+	cycle_t time;
+	unsigned checksum;
+
+	time.Reset();
+	checksum = 0;
+	for (auto &pt : Points)
+	{
+		time.Clock();
+		sector_t *sec = P_PointInSector(pt.Target.XY());
+		time.Unclock();
+		checksum = checksum * 31 + sec->sectornum;
+	}
+	Report("P_PointInSector", time, checksum);
+
+	time.Reset();
+	checksum = 0;
+	for (auto &pt : Points)
+	{
+		Place(Mover, pt.Pos, pt.Angle);
+		FCheckPosition tm;
+		time.Clock();
+		bool ok = P_CheckPosition(Mover, pt.Pos.XY() + pt.Angle.ToVector(24), tm);
+		time.Unclock();
+		checksum = checksum * 31 + ok;
+	}
+	Report("P_CheckPosition", time, checksum);
+
+	time.Reset();
+	checksum = 0;
+	for (auto &pt : Points)
+	{
+		Place(Mover, pt.Pos, pt.Angle);
+		FCheckPosition tm;
+		time.Clock();
+		bool ok = P_TryMove(Mover, pt.Pos.XY() + pt.Angle.ToVector(24), 0, nullptr, tm);
+		time.Unclock();
+		checksum = checksum * 31 + ok;
+	}
+	Report("P_TryMove", time, checksum);
+
+	time.Reset();
+	checksum = 0;
+	for (auto &pt : Points)
+	{
+		Place(Mover, pt.Pos, pt.Angle);
+		Place(Target, pt.Target, pt.Angle);
+		time.Clock();
+		int seen = P_CheckSight(Mover, Target, SF_IGNOREVISIBILITY);
+		time.Unclock();
+		checksum = checksum * 31 + (seen != 0);
+	}
+	Report("P_CheckSight", time, checksum);
+
+	time.Reset();
+	checksum = 0;
+	for (auto &pt : Points)
+	{
+		Place(Mover, pt.Pos, pt.Angle);
+		DVector3 start = pt.Pos + DVector3(0, 0, 41);
+		double pc = pt.Pitch.Cos();
+		DVector3 dir(pc * pt.Angle.Cos(), pc * pt.Angle.Sin(), -pt.Pitch.Sin());
+		FTraceResults res;
+		time.Clock();
+		Trace(start, Mover->Sector, dir, 8192, MF_SHOOTABLE, ML_BLOCKEVERYTHING | ML_BLOCKHITSCAN, Mover, res);
+		time.Unclock();
+		checksum = checksum * 31 + res.HitType;
+	}
+	Report("Trace", time, checksum);
+
+	time.Reset();
+	checksum = 0;
+	for (auto &pt : Points)
+	{
+		Place(Mover, pt.Pos, pt.Angle);
+		Place(Target, pt.Target, pt.Angle);
+		time.Clock();
+		DAngle pitch = P_AimLineAttack(Mover, pt.Angle, 2048.);
+		time.Unclock();
+		checksum = checksum * 31 + int(pitch.Degrees * 16);
+	}
+	Report("P_AimLineAttack", time, checksum);
+
+	time.Reset();
+	checksum = 0;
+	for (auto &pt : Points)
+	{
+		unsigned hits = 0;
+		time.Clock();
+		FPathTraverse it(pt.Pos.X, pt.Pos.Y, pt.Target.X, pt.Target.Y, PT_ADDLINES | PT_ADDTHINGS);
+		while (it.Next() != nullptr) hits++;
+		time.Unclock();
+		checksum = checksum * 31 + hits;
+	}
+	Report("FPathTraverse", time, checksum);
+
+	time.Reset();
+	checksum = 0;
+	for (auto &pt : Points)
+	{
+		Place(Mover, pt.Pos + DVector3(0, 0, 16), pt.Angle);
+		int total = 0;
+		time.Clock();
+		FPortalGroupArray grouplist(FPortalGroupArray::PGA_Full3d);
+		FMultiBlockThingsIterator it(grouplist, Mover->X(), Mover->Y(), Mover->Z() - 256, Mover->Height + 512, 256, false, Mover->Sector);
+		FMultiBlockThingsIterator::CheckResult cres;
+		while (it.Next(&cres))
+		{
+			AActor *thing = cres.thing;
+			if (thing == Mover || !(thing->flags & MF_SHOOTABLE)) continue;
+			if (P_CheckSight(thing, Mover, SF_IGNOREVISIBILITY | SF_IGNOREWATERBOUNDARY))
+			{
+				total += P_GetRadiusDamage(Mover, thing, 128, 256, 0, false);
+			}
+		}
+		time.Unclock();
+		checksum = checksum * 31 + total;
+	}
+	Report("P_RadiusAttack", time, checksum);
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+CCMD(benchplaysim)
+{
+	if (gamestate != GS_LEVEL)
+	{
+		Printf("benchplaysim needs a level to be loaded\n");
+		return;
+	}
+	if (netgame)
+	{
+		Printf("benchplaysim can't be used in a network game\n");
+		return;
+	}
+
+	int iterations = argv.argc() >= 2 ? MAX(atoi(argv[1]), 1) : 10000;
+	unsigned seed = argv.argc() >= 3 ? (unsigned)strtoul(argv[2], nullptr, 0) : 1;
+
+	FPlaysimBench bench(seed);
+	if (!bench.Setup(iterations))
+	{
+		Printf("Could not find places to test in %s\n", level.MapName.GetChars());
+		bench.Cleanup();
+		return;
+	}
+	Printf("Playsim benchmark on %s, %d iterations, seed %u\n", level.MapName.GetChars(), iterations, seed);
+	bench.Run();
+	bench.Cleanup();
+}
@@ -22,6 +22,17 @@ struct FBlockNode
 	static FBlockNode *FreeBlocks;
 };
 
+// Contiguous copy of a block's thing chain so that the block iterators
+// can scan it linearly. Entries are appended when an actor is linked and
+// cleared (not removed) when it is unlinked, so that iterators running
+// while actors move see exactly what the linked list would show them.
+// The holes get squeezed out once per tic by FBlockmap::CompactThings.
+struct FBlockThing
+{
+	AActor *Me;
+	bool Single;	// actor is linked into this block only
+};
+
 // BLOCKMAP
 // Created from axis aligned bounding box
 // of the map, a rectangular array of
@@ -40,6 +51,10 @@ struct FBlockmap
 	double				bmaporgx;
 	double				bmaporgy;		// origin of block map
 	FBlockNode**		blocklinks; 	// for thing chains
+	TArray<FBlockThing>* blockthings;	// for thing chains, newest entries last
+	TArray<int>			dirtyblocks;	// blocks with cleared entries in blockthings
+	unsigned			linkgeneration;	// changes whenever a thing enters or leaves a block
+	bool				generated;		// built by the engine, so every line is in every block it touches
 
 	// mapblocks are used to check movement
 	// against lines and things
@@ -75,6 +90,42 @@ struct FBlockmap
 
 	bool VerifyBlockMap(int count);
 
+	void AddThing(int index, AActor *actor)
+	{
+		blockthings[index].Push({ actor, false });
+		linkgeneration++;
+	}
+
+	void RemoveThing(int index, AActor *actor)
+	{
+		auto &things = blockthings[index];
+		for (int i = things.Size() - 1; i >= 0; i--)
+		{
+			if (things[i].Me == actor)
+			{
+				things[i].Me = nullptr;
+				dirtyblocks.Push(index);
+				linkgeneration++;
+				return;
+			}
+		}
+	}
+
+	void CompactThings()
+	{
+		for (int index : dirtyblocks)
+		{
+			auto &things = blockthings[index];
+			unsigned j = 0;
+			for (unsigned i = 0; i < things.Size(); i++)
+			{
+				if (things[i].Me != nullptr) things[j++] = things[i];
+			}
+			things.Resize(j);
+		}
+		dirtyblocks.Clear();
+	}
+
 	void Clear()
 	{
 		if (blockmaplump != NULL)
@@ -87,6 +138,13 @@ struct FBlockmap
 			delete[] blocklinks;
 			blocklinks = NULL;
 		}
+		if (blockthings != NULL)
+		{
+			delete[] blockthings;
+			blockthings = NULL;
+		}
+		dirtyblocks.Clear();
+		linkgeneration++;
 	}
 
 };
@@ -67,8 +67,8 @@ FRandom pr_railtrail("RailTrail");
 #define FADEFROMTTL(a)	(1.f/(a))
 
 // [RH] particle globals
-uint32_t			ActiveParticles;
-uint32_t			InactiveParticles;
+// The live particles are kept packed at the start of the array.
+uint32_t			NumActiveParticles;
 TArray<particle_t>	Particles;
 TArray<uint16_t>	ParticlesInSubsec;
 
@@ -113,12 +113,9 @@ static const struct ColorList {
 inline particle_t *NewParticle (void)
 {
 	particle_t *result = nullptr;
-	if (InactiveParticles != NO_PARTICLE)
+	if (NumActiveParticles < Particles.Size())
 	{
-		result = &Particles[InactiveParticles];
-		InactiveParticles = result->tnext;
-		result->tnext = ActiveParticles;
-		ActiveParticles = uint32_t(result - Particles.Data());
+		result = &Particles[NumActiveParticles++];
 	}
 	return result;
 }
@@ -165,13 +162,8 @@ void P_InitParticles ()
 
 void P_ClearParticles ()
 {
-	int i = 0;
 	memset (Particles.Data(), 0, Particles.Size() * sizeof(particle_t));
-	ActiveParticles = NO_PARTICLE;
-	InactiveParticles = 0;
-	for (auto &p : Particles)
-		p.tnext = ++i;
-	Particles.Last().tnext = NO_PARTICLE;
+	NumActiveParticles = 0;
 }
 
 // Group particles by subsectors. Because particles are always
@@ -191,7 +183,7 @@ void P_FindParticleSubsectors ()
 	{
 		return;
 	}
-	for (uint16_t i = ActiveParticles; i != NO_PARTICLE; i = Particles[i].tnext)
+	for (uint16_t i = 0; i < NumActiveParticles; i++)
 	{
 		 // Try to reuse the subsector from the last portal check, if still valid.
 		if (Particles[i].subsector == NULL) Particles[i].subsector = R_PointInSubsector(Particles[i].Pos);
@@ -241,63 +233,75 @@ void P_InitEffects ()
 
 void P_ThinkParticles ()
 {
-	int i;
-	particle_t *particle, *prev;
-
-	i = ActiveParticles;
-	prev = NULL;
-	while (i != NO_PARTICLE)
+	const uint32_t count = NumActiveParticles;
+	const bool frozen = level.isFrozen();
+	particle_t *const particles = Particles.Data();
+	uint32_t live = 0;
+
+	// First age all particles. This touches nothing but the particles themselves
+	// so it is one straight pass over the packed array.
+	for (uint32_t i = 0; i < count; i++)
 	{
-		particle = &Particles[i];
-		i = particle->tnext;
-		if (!particle->notimefreeze && level.isFrozen())
-		{
-			prev = particle;
-			continue;
-		}
-		
+		particle_t *particle = &particles[i];
+		if (frozen && !particle->notimefreeze) continue;
+
 		auto oldtrans = particle->alpha;
 		particle->alpha -= particle->fadestep;
 		particle->size += particle->sizestep;
-		if (particle->alpha <= 0 || oldtrans < particle->alpha || --particle->ttl <= 0 || (particle->size <= 0))
-		{ // The particle has expired, so free it
-			memset (particle, 0, sizeof(particle_t));
-			if (prev)
-				prev->tnext = i;
-			else
-				ActiveParticles = i;
-			particle->tnext = InactiveParticles;
-			InactiveParticles = (int)(particle - Particles.Data());
-			continue;
+		particle->ttl--;
+		if (particle->alpha <= 0 || oldtrans < particle->alpha || particle->ttl <= 0 || particle->size <= 0)
+		{ // The particle has expired.
+			particle->ttl = INT_MIN;
 		}
+	}
 
-		// Handle crossing a line portal
-		DVector2 newxy = P_GetOffsetPosition(particle->Pos.X, particle->Pos.Y, particle->Vel.X, particle->Vel.Y);
-		particle->Pos.X = newxy.X;
-		particle->Pos.Y = newxy.Y;
-		particle->Pos.Z += particle->Vel.Z;
-		particle->Vel += particle->Acc;
-		particle->subsector = R_PointInSubsector(particle->Pos);
-		sector_t *s = particle->subsector->sector;
-		// Handle crossing a sector portal.
-		if (!s->PortalBlocksMovement(sector_t::ceiling))
+	// Then move the survivors and close the gaps left by the expired ones.
+	for (uint32_t i = 0; i < count; i++)
+	{
+		particle_t *particle = &particles[i];
+		if (particle->ttl == INT_MIN) continue;
+
+		if (!frozen || particle->notimefreeze)
 		{
-			if (particle->Pos.Z > s->GetPortalPlaneZ(sector_t::ceiling))
+			// Handle crossing a line portal
+			DVector2 newxy = P_GetOffsetPosition(particle->Pos.X, particle->Pos.Y, particle->Vel.X, particle->Vel.Y);
+			particle->Pos.X = newxy.X;
+			particle->Pos.Y = newxy.Y;
+			particle->Pos.Z += particle->Vel.Z;
+			particle->Vel += particle->Acc;
+			particle->subsector = R_PointInSubsector(particle->Pos);
+			sector_t *s = particle->subsector->sector;
+			// Handle crossing a sector portal.
+			if (!s->PortalBlocksMovement(sector_t::ceiling))
 			{
-				particle->Pos += s->GetPortalDisplacement(sector_t::ceiling);
-				particle->subsector = NULL;
+				if (particle->Pos.Z > s->GetPortalPlaneZ(sector_t::ceiling))
+				{
+					particle->Pos += s->GetPortalDisplacement(sector_t::ceiling);
+					particle->subsector = NULL;
+				}
 			}
-		}
-		else if (!s->PortalBlocksMovement(sector_t::floor))
-		{
-			if (particle->Pos.Z < s->GetPortalPlaneZ(sector_t::floor))
+			else if (!s->PortalBlocksMovement(sector_t::floor))
 			{
-				particle->Pos += s->GetPortalDisplacement(sector_t::floor);
-				particle->subsector = NULL;
+				if (particle->Pos.Z < s->GetPortalPlaneZ(sector_t::floor))
+				{
+					particle->Pos += s->GetPortalDisplacement(sector_t::floor);
+					particle->subsector = NULL;
+				}
 			}
 		}
-		prev = particle;
+		if (live != i)
+		{
+			particles[live] = *particle;
+		}
+		live++;
+	}
+
+	// Freed slots must be clean for the next particle spawned there.
+	if (live < count)
+	{
+		memset(&particles[live], 0, (count - live) * sizeof(particle_t));
 	}
+	NumActiveParticles = live;
 }
 
 enum PSFlag
@@ -59,11 +59,12 @@ struct particle_t
 	float	fadestep;
 	float	alpha;
 	int		color;
-	uint16_t	tnext;
 	uint16_t	snext;
 };
 
+// Live particles occupy Particles[0] to Particles[NumActiveParticles-1].
 extern TArray<particle_t>	Particles;
+extern uint32_t				NumActiveParticles;
 extern TArray<uint16_t>		ParticlesInSubsec;
 
 const uint16_t NO_PARTICLE = 0xffff;
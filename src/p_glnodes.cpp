@@ -1016,7 +1016,7 @@ bool P_CheckNodes(MapData * map, bool rebuilt, int buildtime)
 typedef TArray<uint8_t> MemFile;
 
 
-static FString CreateCacheName(MapData *map, bool create)
+static FString CreateCacheName(MapData *map, bool create, const char *ext = ".gzc")
 {
 	FString path = M_GetCachePath(create);
 	FString lumpname = Wads.GetLumpFullPath(map->lumpnum);
@@ -1026,7 +1026,7 @@ static FString CreateCacheName(MapData *map, bool create)
 
 	lumpname.ReplaceChars('/', '%');
 	lumpname.ReplaceChars(':', '$');
-	path << '/' << lumpname.Right(lumpname.Len() - separator - 1) << ".gzc";
+	path << '/' << lumpname.Right(lumpname.Len() - separator - 1) << ext;
 	return path;
 }
 
@@ -1215,6 +1215,162 @@ static bool CheckCachedNodes(MapData *map)
 	return true;
 }
 
+//==========================================================================
+//
+// Level cache
+//
+// Other derived level data is stored next to the node cache in a file of
+// chunks. The header identifies the map by its checksum and line and vertex
+// counts, and LEVELCACHE_VERSION must be bumped whenever the code creating
+// any of the chunks changes its output.
+//
+//==========================================================================
+
+enum
+{
+	LEVELCACHE_VERSION = 1,
+};
+
+static bool ReadLevelCacheHeader(FileReader &fr, MapData *map)
+{
+	char magic[4];
+	uint8_t md5[16], md5map[16];
+
+	if (fr.Read(magic, 4) != 4 || memcmp(magic, "LVC1", 4)) return false;
+	if (fr.ReadUInt32() != LEVELCACHE_VERSION) return false;
+	if (fr.Read(md5, 16) != 16) return false;
+	map->GetChecksum(md5map);
+	if (memcmp(md5, md5map, 16)) return false;
+	if (fr.ReadUInt32() != level.lines.Size()) return false;
+	if (fr.ReadUInt32() != level.vertexes.Size()) return false;
+	return true;
+}
+
+static bool ReadLevelCacheChunk(MapData *map, uint32_t id, TArray<uint8_t> &data)
+{
+	FileReader fr;
+	if (!fr.OpenFile(CreateCacheName(map, false, ".lvc")) || !ReadLevelCacheHeader(fr, map)) return false;
+
+	while (fr.Tell() + 12 <= fr.GetLength())
+	{
+		uint32_t chunkid = fr.ReadUInt32();
+		uLongf rawsize = fr.ReadUInt32();
+		uint32_t compsize = fr.ReadUInt32();
+		if (chunkid != id)
+		{
+			fr.Seek(compsize, FileReader::SeekCur);
+			continue;
+		}
+		if (compsize > fr.GetLength() - fr.Tell()) return false;
+
+		TArray<Bytef> compressed(compsize, true);
+		if (fr.Read(compressed.Data(), compsize) != compsize) return false;
+		data.Resize(rawsize);
+		return uncompress(data.Data(), &rawsize, compressed.Data(), compsize) == Z_OK && rawsize == data.Size();
+	}
+	return false;
+}
+
+static void WriteLevelCacheChunk(MapData *map, uint32_t id, const void *data, unsigned size)
+{
+	// Keep the other chunks of a valid file.
+	TArray<uint8_t> chunks;
+	{
+		FileReader fr;
+		if (fr.OpenFile(CreateCacheName(map, false, ".lvc")) && ReadLevelCacheHeader(fr, map))
+		{
+			while (fr.Tell() + 12 <= fr.GetLength())
+			{
+				uint32_t chunk[3];
+				if (fr.Read(chunk, 12) != 12) break;
+				uint32_t compsize = LittleLong(chunk[2]);
+				if (compsize > fr.GetLength() - fr.Tell()) break;
+				if (LittleLong(chunk[0]) == id)
+				{
+					fr.Seek(compsize, FileReader::SeekCur);
+					continue;
+				}
+				unsigned pos = chunks.Reserve(12 + compsize);
+				memcpy(&chunks[pos], chunk, 12);
+				fr.Read(&chunks[pos + 12], compsize);
+			}
+		}
+	}
+
+	uLongf complen = compressBound(size);
+	TArray<Bytef> compressed(complen, true);
+	if (compress(compressed.Data(), &complen, (const Bytef *)data, size) != Z_OK) return;
+
+	uint32_t header[4] = { LittleLong(uint32_t(LEVELCACHE_VERSION)), 0, LittleLong(level.lines.Size()), LittleLong(level.vertexes.Size()) };
+	uint8_t md5[16];
+	map->GetChecksum(md5);
+	uint32_t chunkheader[3] = { LittleLong(id), LittleLong(uint32_t(size)), LittleLong(uint32_t(complen)) };
+
+	FString path = CreateCacheName(map, true, ".lvc");
+	FileWriter *fw = FileWriter::Open(path);
+	if (fw == nullptr)
+	{
+		Printf("Cannot open level cache file %s for writing\n", path.GetChars());
+		return;
+	}
+	bool ok = fw->Write("LVC1", 4) == 4 &&
+		fw->Write(&header[0], 4) == 4 &&
+		fw->Write(md5, 16) == 16 &&
+		fw->Write(&header[2], 8) == 8 &&
+		fw->Write(chunks.Data(), chunks.Size()) == chunks.Size() &&
+		fw->Write(chunkheader, 12) == 12 &&
+		fw->Write(compressed.Data(), complen) == complen;
+	delete fw;
+	if (!ok)
+	{
+		Printf("Error saving level cache to file %s\n", path.GetChars());
+		remove(path);
+	}
+}
+
+//==========================================================================
+//
+// Blockmap caching. Generating a blockmap has to check every line against
+// every block it crosses, which is slow for large maps, and UDMF maps never
+// come with one.
+//
+//==========================================================================
+
+bool P_LoadCachedBlockMap(MapData *map)
+{
+	if (!gl_cachenodes || level.maptype == MAPTYPE_BUILD) return false;
+
+	TArray<uint8_t> data;
+	if (!ReadLevelCacheChunk(map, MAKE_ID('B','M','A','P'), data) || data.Size() < 16 || (data.Size() & 3)) return false;
+
+	int count = data.Size() / 4;
+	level.blockmap.blockmaplump = new int[count];
+	for (int i = 0; i < count; i++)
+	{
+		level.blockmap.blockmaplump[i] = LittleLong(((int *)data.Data())[i]);
+	}
+	if (!level.blockmap.VerifyBlockMap(count))
+	{
+		delete[] level.blockmap.blockmaplump;
+		level.blockmap.blockmaplump = nullptr;
+		return false;
+	}
+	DPrintf(DMSG_NOTIFY, "Loaded cached blockmap\n");
+	return true;
+}
+
+void P_SaveCachedBlockMap(MapData *map, const TArray<int> &blockmap, int buildtime)
+{
+	if (!gl_cachenodes || level.maptype == MAPTYPE_BUILD || buildtime / 1000.f < gl_cachetime) return;
+
+	TArray<int> data(blockmap.Size(), true);
+	for (unsigned i = 0; i < blockmap.Size(); i++)
+	{
+		data[i] = LittleLong(blockmap[i]);
+	}
+	WriteLevelCacheChunk(map, MAKE_ID('B','M','A','P'), data.Data(), data.Size() * 4);
+}
+
 UNSAFE_CCMD(clearnodecache)
 {
 	TArray<FFileList> list;
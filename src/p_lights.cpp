@@ -123,6 +123,7 @@ public:
 	DGlow(sector_t *sector);
 	void		Serialize(FSerializer &arc);
 	void		Tick();
+	bool		CanTickParallel() const override { return true; }
 protected:
 	int 		m_MinLight;
 	int 		m_MaxLight;
@@ -162,6 +163,7 @@ public:
 
 	void		Serialize(FSerializer &arc);
 	void		Tick();
+	bool		CanTickParallel() const override { return true; }
 protected:
 	uint8_t		m_BaseLevel;
 	uint8_t		m_Phase;
@@ -2777,6 +2777,7 @@ FUNC(LS_Line_SetBlocking)
 	{
 		level.lines[line].flags = (level.lines[line].flags & ~clearflags) | setflags;
 	}
+	P_InvalidateSightCache();
 	return true;
 }
 
@@ -0,0 +1,255 @@
+/*
+** p_loadtrace.cpp
+** Timeline of the phases of a level load
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**---------------------------------------------------------------------------
+**
+** Every level load records the wall time and the net amount of memory
+** allocated through M_Malloc for each of its phases. The phases nest, so
+** the result is a timeline that can be printed with 'loadtrace' or saved
+** in Chrome's trace event format with 'loadtrace dump' and inspected in
+** chrome://tracing or any compatible viewer.
+**
+*/
+
+#include "rapidjson/rapidjson.h"
+#include "rapidjson/writer.h"
+#include "rapidjson/stringbuffer.h"
+
+#include "doomtype.h"
+#include "c_dispatch.h"
+#include "c_cvars.h"
+#include "dobject.h"
+#include "files.h"
+#include "i_time.h"
+#include "p_loadtrace.h"
+
+EXTERN_CVAR(Bool, showloadtimes)
+
+struct FLoadTraceEvent
+{
+	const char *Name;
+	uint64_t Start;		// ns
+	uint64_t Duration;	// ns
+	int64_t AllocStart;	// bytes
+	int64_t Alloc;		// bytes
+	int Depth;
+};
+
+struct FLoadTraceLevel
+{
+	FString MapName;
+	unsigned FirstEvent;
+};
+
+static TArray<FLoadTraceEvent> TraceEvents;
+static TArray<FLoadTraceLevel> TraceLevels;
+static TArray<unsigned> OpenPhases;
+static bool TraceLoading;
+
+// Only the most recent loads are kept so that long sessions don't accumulate an endless log.
+enum { MAX_TRACED_LOADS = 32 };
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void LT_BeginLevelLoad(const char *mapname)
+{
+	// A load that was aborted with an error may have left phases open.
+	OpenPhases.Clear();
+
+	if (TraceLevels.Size() >= MAX_TRACED_LOADS)
+	{
+		unsigned drop = TraceLevels[1].FirstEvent;
+		TraceEvents.Delete(0, drop);
+		TraceLevels.Delete(0);
+		for (auto &lev : TraceLevels) lev.FirstEvent -= drop;
+	}
+
+	FLoadTraceLevel lev = { mapname, TraceEvents.Size() };
+	TraceLevels.Push(lev);
+	TraceLoading = true;
+	LT_BeginPhase("P_SetupLevel");
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void LT_BeginPhase(const char *name)
+{
+	if (!TraceLoading) return;
+
+	FLoadTraceEvent ev = { name, I_nsTime(), 0, (int64_t)GC::AllocBytes, 0, (int)OpenPhases.Size() };
+	OpenPhases.Push(TraceEvents.Push(ev));
+}
+
+void LT_EndPhase()
+{
+	unsigned index;
+	if (!TraceLoading || !OpenPhases.Pop(index)) return;
+
+	auto &ev = TraceEvents[index];
+	ev.Duration = I_nsTime() - ev.Start;
+	ev.Alloc = (int64_t)GC::AllocBytes - ev.AllocStart;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+static void LT_PrintLevel(unsigned levelindex)
+{
+	auto &lev = TraceLevels[levelindex];
+	unsigned end = levelindex + 1 < TraceLevels.Size() ? TraceLevels[levelindex + 1].FirstEvent : TraceEvents.Size();
+
+	Printf("---Load times for %s---\n", lev.MapName.GetChars());
+	Printf("%10s %10s  %s\n", "ms", "alloc KB", "phase");
+	for (unsigned i = lev.FirstEvent; i < end; i++)
+	{
+		auto &ev = TraceEvents[i];
+		Printf("%10.3f %10lld  %*s%s\n", ev.Duration / 1e6, (long long)(ev.Alloc / 1024), ev.Depth * 2, "", ev.Name);
+	}
+}
+
+void LT_EndLevelLoad()
+{
+	if (!TraceLoading) return;
+
+	while (OpenPhases.Size() > 0) LT_EndPhase();
+	TraceLoading = false;
+
+	if (showloadtimes) LT_PrintLevel(TraceLevels.Size() - 1);
+}
+
+//==========================================================================
+//
+// Writes all recorded loads in Chrome's trace event format, one track
+// per load.
+//
+//==========================================================================
+
+static void LT_Dump(const char *filename)
+{
+	if (TraceLevels.Size() == 0)
+	{
+		Printf("No level loads have been recorded\n");
+		return;
+	}
+
+	rapidjson::StringBuffer buffer;
+	rapidjson::Writer<rapidjson::StringBuffer> w(buffer);
+	uint64_t base = TraceEvents[TraceLevels[0].FirstEvent].Start;
+
+	w.StartObject();
+	w.Key("displayTimeUnit");
+	w.String("ms");
+	w.Key("traceEvents");
+	w.StartArray();
+	for (unsigned l = 0; l < TraceLevels.Size(); l++)
+	{
+		auto &lev = TraceLevels[l];
+		unsigned end = l + 1 < TraceLevels.Size() ? TraceLevels[l + 1].FirstEvent : TraceEvents.Size();
+
+		w.StartObject();
+		w.Key("name"); w.String("thread_name");
+		w.Key("ph"); w.String("M");
+		w.Key("pid"); w.Int(1);
+		w.Key("tid"); w.Int(l + 1);
+		w.Key("args");
+		w.StartObject();
+		w.Key("name"); w.String(lev.MapName.GetChars());
+		w.EndObject();
+		w.EndObject();
+
+		for (unsigned i = lev.FirstEvent; i < end; i++)
+		{
+			auto &ev = TraceEvents[i];
+			w.StartObject();
+			w.Key("name"); w.String(ev.Name);
+			w.Key("cat"); w.String("load");
+			w.Key("ph"); w.String("X");
+			w.Key("ts"); w.Double((ev.Start - base) / 1000.);
+			w.Key("dur"); w.Double(ev.Duration / 1000.);
+			w.Key("pid"); w.Int(1);
+			w.Key("tid"); w.Int(l + 1);
+			w.Key("args");
+			w.StartObject();
+			w.Key("map"); w.String(lev.MapName.GetChars());
+			w.Key("alloc"); w.Int64(ev.Alloc);
+			w.EndObject();
+			w.EndObject();
+		}
+	}
+	w.EndArray();
+	w.EndObject();
+
+	FileWriter *file = FileWriter::Open(filename);
+	if (file == nullptr)
+	{
+		Printf("Could not open %s for writing\n", filename);
+		return;
+	}
+	file->Write(buffer.GetString(), buffer.GetSize());
+	delete file;
+	Printf("Load trace written to %s\n", filename);
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+CCMD(loadtrace)
+{
+	if (argv.argc() >= 2)
+	{
+		if (stricmp(argv[1], "dump") == 0)
+		{
+			LT_Dump(argv.argc() >= 3 ? argv[2] : "loadtrace.json");
+			return;
+		}
+		else if (stricmp(argv[1], "clear") == 0)
+		{
+			if (TraceLoading) return;
+			TraceEvents.Clear();
+			TraceLevels.Clear();
+			return;
+		}
+		else if (stricmp(argv[1], "print") != 0)
+		{
+			Printf("Usage: loadtrace [print|dump [filename]|clear]\n");
+			return;
+		}
+	}
+	if (TraceLevels.Size() == 0)
+	{
+		Printf("No level loads have been recorded\n");
+		return;
+	}
+	LT_PrintLevel(TraceLevels.Size() - 1);
+}
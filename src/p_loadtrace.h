@@ -0,0 +1,22 @@
+#ifndef __P_LOADTRACE_H
+#define __P_LOADTRACE_H
+
+// Timeline of the phases of a level load. Phase names must be string
+// literals, they are stored as plain pointers.
+void LT_BeginLevelLoad(const char *mapname);
+void LT_EndLevelLoad();
+void LT_BeginPhase(const char *name);
+void LT_EndPhase();
+
+// Times the enclosing scope as one phase of the current level load.
+class FLoadPhase
+{
+public:
+	FLoadPhase(const char *name) { LT_BeginPhase(name); }
+	~FLoadPhase() { LT_EndPhase(); }
+
+	FLoadPhase(const FLoadPhase &) = delete;
+	FLoadPhase &operator=(const FLoadPhase &) = delete;
+};
+
+#endif
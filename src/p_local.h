@@ -88,6 +88,7 @@ void	P_FallingDamage (AActor *ent);
 void	P_PlayerThink (player_t *player);
 void	P_PredictPlayer (player_t *player);
 void	P_UnPredictPlayer ();
+void	P_RepredictPlayer (player_t *player);
 void	P_PredictionLerpReset();
 
 //
@@ -292,6 +293,8 @@ enum ESightFlags
 };
 
 void	P_ResetSightCounters (bool full);
+void	P_InvalidateSightCache ();
+void	P_BuildSightGroups ();
 bool	P_TalkFacing (AActor *player);
 void	P_UseLines (player_t* player);
 int	P_UsePuzzleItem (AActor *actor, int itemType);
@@ -421,6 +424,7 @@ int	P_RadiusAttack (AActor *spot, AActor *source, int damage, int distance,
 						FName damageType, int flags, int fulldamagedistance=0, FName species = NAME_None);
 
 void	P_DelSeclist(msecnode_t *, msecnode_t *sector_t::*seclisthead);
+void	P_ReleaseSecnodes();
 void	P_DelSeclist(portnode_t *, portnode_t *FLinePortal::*seclisthead);
 
 template<class nodetype, class linktype>
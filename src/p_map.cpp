@@ -1700,6 +1700,7 @@ MOVEMENT CLIPPING
 
 bool P_CheckPosition(AActor *thing, const DVector2 &pos, FCheckPosition &tm, bool actorsonly)
 {
+	FThinkerProfileScope profile(TPC_Collision);
 	sector_t *newsec;
 	AActor *thingblocker;
 	double realHeight = thing->Height;
@@ -2193,6 +2194,7 @@ bool P_TryMove(AActor *thing, const DVector2 &pos,
 	FCheckPosition &tm,
 	bool missileCheck)	// [GZ] Fired missiles ignore the drop-off test
 {
+	FThinkerProfileScope profile(TPC_Collision);
 	sector_t	*oldsector;
 	double		oldz;
 	int 		side;
@@ -5903,6 +5905,61 @@ int P_GetRadiusDamage(AActor *self, AActor *thing, int damage, int distance, int
 	return newdam;
 }
 
+//==========================================================================
+//
+// Radius attack query cache
+//
+// Mods frequently call A_Explode several times from the same spot in one
+// go (layered explosions, multiple damage types, etc.). As long as nothing
+// has been linked into or unlinked from the blockmap in between, such
+// explosions see exactly the same set of things, so the blockmap scan
+// is only done once and its result reused. The per-thing checks are
+// always done again because the previous explosion may have changed them.
+//
+//==========================================================================
+
+struct FRadiusQueryCache
+{
+	bool valid;
+	int maptime;
+	unsigned linkgeneration;
+	DVector3 pos;
+	double height;
+	int distance;
+	sector_t *sector;
+	TArray<AActor *> things;
+};
+
+static FRadiusQueryCache RadiusQuery;
+
+static TArray<AActor *> &P_RadiusAttackCandidates(AActor *bombspot, int bombdistance)
+{
+	FRadiusQueryCache &q = RadiusQuery;
+	if (q.valid && q.maptime == level.maptime && q.linkgeneration == level.blockmap.linkgeneration &&
+		q.pos == bombspot->Pos() && q.height == bombspot->Height && q.distance == bombdistance && q.sector == bombspot->Sector)
+	{
+		return q.things;
+	}
+
+	FPortalGroupArray grouplist(FPortalGroupArray::PGA_Full3d);
+	FMultiBlockThingsIterator it(grouplist, bombspot->X(), bombspot->Y(), bombspot->Z() - bombdistance, bombspot->Height + bombdistance*2, bombdistance, false, bombspot->Sector);
+	FMultiBlockThingsIterator::CheckResult cres;
+
+	q.things.Clear();
+	while ((it.Next(&cres)))
+	{
+		q.things.Push(cres.thing);
+	}
+	q.valid = true;
+	q.maptime = level.maptime;
+	q.linkgeneration = level.blockmap.linkgeneration;
+	q.pos = bombspot->Pos();
+	q.height = bombspot->Height;
+	q.distance = bombdistance;
+	q.sector = bombspot->Sector;
+	return q.things;
+}
+
 //==========================================================================
 //
 // P_RadiusAttack
@@ -5917,10 +5974,6 @@ int P_RadiusAttack(AActor *bombspot, AActor *bombsource, int bombdamage, int bom
 		return 0;
 	fulldamagedistance = clamp<int>(fulldamagedistance, 0, bombdistance - 1);
 
-	FPortalGroupArray grouplist(FPortalGroupArray::PGA_Full3d);
-	FMultiBlockThingsIterator it(grouplist, bombspot->X(), bombspot->Y(), bombspot->Z() - bombdistance, bombspot->Height + bombdistance*2, bombdistance, false, bombspot->Sector);
-	FMultiBlockThingsIterator::CheckResult cres;
-
 	if (flags & RADF_SOURCEISSPOT)
 	{ // The source is actually the same as the spot, even if that wasn't what we received.
 		bombsource = bombspot;
@@ -5928,11 +5981,13 @@ int P_RadiusAttack(AActor *bombspot, AActor *bombsource, int bombdamage, int bom
 
 	P_GeometryRadiusAttack(bombspot, bombsource, bombdamage, bombdistance, bombmod, fulldamagedistance);
 
+	// P_GeometryRadiusAttack may have spawned or moved things, so only fetch the candidates now.
+	TArray<AActor*> &candidates = P_RadiusAttackCandidates(bombspot, bombdistance);
+
 	TArray<AActor*> targets;
 	int count = 0;
-	while ((it.Next(&cres)))
+	for (AActor *thing : candidates)
 	{
-		AActor *thing = cres.thing;
 		// Vulnerable actors can be damaged by radius attacks even if not shootable
 		// Used to emulate MBF's vulnerability of non-missile bouncers to explosions.
 		if (!((thing->flags & MF_SHOOTABLE) || (thing->flags6 & MF6_VULNERABLE)))
@@ -6678,6 +6733,9 @@ bool P_ChangeSector(sector_t *sector, int crunch, double amt, int floorOrCeil, b
 	void(*iterator2)(AActor *, FChangePosition *) = NULL;
 	msecnode_t *n;
 
+	// Sector heights affect line of sight.
+	P_InvalidateSightCache();
+
 	cpos.nofit = false;
 	cpos.crushchange = crunch;
 	cpos.moveamt = fabs(amt);
@@ -6707,7 +6765,7 @@ bool P_ChangeSector(sector_t *sector, int crunch, double amt, int floorOrCeil, b
 		for (i = 0; i < sector->e->XFloor.attached.Size(); i++)
 		{
 			sec = sector->e->XFloor.attached[i];
-			P_Recalculate3DFloors(sec);	// Must recalculate the 3d floor and light lists
+			P_Recalculate3DFloors(sec, true);	// Must recalculate the 3d floor and light lists
 
 			// no thing checks for attached sectors because of heightsec
 			if (sec->heightsec == sector) continue;
@@ -6732,7 +6790,7 @@ bool P_ChangeSector(sector_t *sector, int crunch, double amt, int floorOrCeil, b
 			sec->CheckPortalPlane(!floorOrCeil);
 		}
 	}
-	P_Recalculate3DFloors(sector);			// Must recalculate the 3d floor and light lists
+	P_Recalculate3DFloors(sector, true);			// Must recalculate the 3d floor and light lists
 
 	// [RH] Use different functions for the four different types of sector
 	// movement.
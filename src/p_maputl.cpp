@@ -73,6 +73,10 @@
 #include "p_3dmidtex.h"
 #include "p_blockmap.h"
 #include "r_utility.h"
+
+#ifndef NO_SSE
+#include <emmintrin.h>
+#endif
 #include "actor.h"
 #include "actorinlines.h"
 
@@ -83,10 +87,11 @@
 #include "g_levellocals.h"
 #include "vm.h"
 
-sector_t *P_PointInSectorBuggy(double x, double y);
 int P_VanillaPointOnDivlineSide(double x, double y, const divline_t* line);
 
 
+const FSpawnLocationHint *SpawnLocationHint;
+
 //==========================================================================
 //
 // P_AproxDistance
@@ -344,6 +349,7 @@ void AActor::UnlinkFromWorld (FLinkContext *ctx)
 				block->NextActor->PrevActor = block->PrevActor;
 			}
 			*(block->PrevActor) = block->NextActor;
+			level.blockmap.RemoveThing(block->BlockIndex, this);
 			FBlockNode *next = block->NextBlock;
 			block->Release ();
 			block = next;
@@ -457,12 +463,19 @@ void AActor::LinkToWorld(FLinkContext *ctx, bool spawningmapthing, sector_t *sec
 		}
 	}
 
+	const FSpawnLocationHint *hint = spawningmapthing ? SpawnLocationHint : nullptr;
+	if (hint != nullptr && hint->pos != Pos().XY()) hint = nullptr;
+
 	if (sector == NULL)
 	{
 		if (!spawning)
 		{
 			sector = P_PointInSector(Pos());
 		}
+		else if (hint != nullptr)
+		{
+			sector = hint->sector;
+		}
 		else
 		{
 			sector = P_PointInSectorBuggy(X(), Y());
@@ -470,7 +483,8 @@ void AActor::LinkToWorld(FLinkContext *ctx, bool spawningmapthing, sector_t *sec
 	}
 
 	Sector = sector;
-	subsector = R_PointInSubsector(Pos());	// this is from the rendering nodes, not the gameplay nodes!
+	// this is from the rendering nodes, not the gameplay nodes!
+	subsector = hint != nullptr ? hint->subsector : R_PointInSubsector(Pos());
 
 	if (!(flags & MF_NOSECTOR))
 	{
@@ -551,6 +565,7 @@ void AActor::LinkToWorld(FLinkContext *ctx, bool spawningmapthing, sector_t *sec
 						}
 						node->PrevActor = link;
 						*link = node;
+						level.blockmap.AddThing(node->BlockIndex, this);
 
 						// Link in to actor
 						node->PrevBlock = alink;
@@ -561,6 +576,11 @@ void AActor::LinkToWorld(FLinkContext *ctx, bool spawningmapthing, sector_t *sec
 				}
 			}
 		}
+		if (BlockNode != NULL && BlockNode->NextBlock == NULL)
+		{
+			// This actor doesn't span blocks, so the block iterators can skip the duplicate check.
+			level.blockmap.blockthings[BlockNode->BlockIndex].Last().Single = true;
+		}
 	}
 	// Portal links cannot be done unless the level is fully initialized.
 	if (!spawningmapthing) UpdateRenderSectorList();
@@ -921,6 +941,14 @@ void FMultiBlockLinesIterator::Reset()
 	startIteratorForGroup(basegroup);
 }
 
+//===========================================================================
+//
+// Per-tic scratch memory for the iterators' overflow storage
+//
+//===========================================================================
+
+FMemArena PlaysimScratch(64*1024);
+
 //===========================================================================
 //
 // FBlockThingsIterator :: FBlockThingsIterator
@@ -928,16 +956,15 @@ void FMultiBlockLinesIterator::Reset()
 //===========================================================================
 
 FBlockThingsIterator::FBlockThingsIterator()
-: DynHash(0)
 {
 	minx = maxx = 0;
 	miny = maxy = 0;
 	ClearHash();
 	block = NULL;
+	blockpos = -1;
 }
 
 FBlockThingsIterator::FBlockThingsIterator(int _minx, int _miny, int _maxx, int _maxy)
-: DynHash(0)
 {
 	minx = _minx;
 	maxx = _maxx;
@@ -982,12 +1009,14 @@ void FBlockThingsIterator::StartBlock(int x, int y)
 	cury = y;
 	if (level.blockmap.isValidBlock(x, y))
 	{
-		block = level.blockmap.blocklinks[y*level.blockmap.bmapwidth + x];
+		block = &level.blockmap.blockthings[y*level.blockmap.bmapwidth + x];
+		blockpos = block->Size() - 1;
 	}
 	else
 	{
 		// invalid block
 		block = NULL;
+		blockpos = -1;
 	}
 }
 
@@ -1014,16 +1043,20 @@ AActor *FBlockThingsIterator::Next(bool centeronly)
 {
 	for (;;)
 	{
-		while (block != NULL)
+		// Walk the array backwards so that actors come out in the same order the thing chain has.
+		while (blockpos >= 0)
 		{
-			AActor *me = block->Me;
-			FBlockNode *mynode = block;
+			const FBlockThing &thing = (*block)[blockpos--];
+			AActor *me = thing.Me;
 			HashEntry *entry;
 			int i;
 
-			block = block->NextActor;
+			if (me == NULL)
+			{ // Unlinked since the last compaction.
+				continue;
+			}
 			// Don't recheck things that were already checked
-			if (mynode->NextBlock == NULL && mynode->PrevBlock == &me->BlockNode)
+			if (thing.Single)
 			{ // This actor doesn't span blocks, so we know it can only ever be checked once.
 				return me;
 			}
@@ -1064,10 +1097,6 @@ AActor *FBlockThingsIterator::Next(bool centeronly)
 					}
 					else
 					{
-						if (DynHash.Size() == 0)
-						{
-							DynHash.Grow(50);
-						}
 						i = DynHash.Reserve(1);
 						entry = &DynHash[i];
 						entry->Next = Buckets[hash];
@@ -1217,33 +1246,88 @@ TArray<intercept_t> FPathTraverse::intercepts(128);
 void FPathTraverse::AddLineIntercepts(int bx, int by)
 {
 	FBlockLinesIterator it(bx, by, bx, by, true);
-	line_t *ld;
+	line_t *batch[32];
+	unsigned count;
 
-	while ((ld = it.Next()))
+	// Collect the block's lines first so that the side tests can be done in one go.
+	do
 	{
-		int 				s1;
-		int 				s2;
-		double 				frac;
-		divline_t			dl;
+		count = 0;
+		while (count < countof(batch) && (batch[count] = it.Next()) != nullptr)
+		{
+			count++;
+		}
+		AddLineInterceptsBatch(batch, count);
+	} while (count == countof(batch));
+}
+
+//===========================================================================
+//
+// FPathTraverse :: AddLineInterceptsBatch
+//
+// Tests a group of lines against the trace. The side tests give the same
+// results as P_PointOnDivlineSide since the operations are the same and
+// done in the same order, just two vertices at a time.
+//
+//===========================================================================
+
+void FPathTraverse::AddLineInterceptsBatch(line_t **lines, unsigned count)
+{
+	bool crossed[32];
+
+	assert(count <= countof(crossed));
+#ifndef NO_SSE
+	const __m128d tx = _mm_set1_pd(trace.x);
+	const __m128d ty = _mm_set1_pd(trace.y);
+	const __m128d tdx = _mm_set1_pd(trace.dx);
+	const __m128d tdy = _mm_set1_pd(trace.dy);
+	const __m128d eps = _mm_set1_pd(EQUAL_EPSILON);
+
+	for (unsigned i = 0; i < count; i++)
+	{
+		const line_t *ld = lines[i];
+		__m128d vx = _mm_set_pd(ld->v2->fX(), ld->v1->fX());
+		__m128d vy = _mm_set_pd(ld->v2->fY(), ld->v1->fY());
+		__m128d side = _mm_add_pd(_mm_mul_pd(_mm_sub_pd(vy, ty), tdx), _mm_mul_pd(_mm_sub_pd(tx, vx), tdy));
+		int mask = _mm_movemask_pd(_mm_cmpgt_pd(side, eps));
+		crossed[i] = mask == 1 || mask == 2;
+	}
+#else
+	for (unsigned i = 0; i < count; i++)
+	{
+		const line_t *ld = lines[i];
+		crossed[i] = P_PointOnDivlineSide(ld->v1->fX(), ld->v1->fY(), &trace) != P_PointOnDivlineSide(ld->v2->fX(), ld->v2->fY(), &trace);
+	}
+#endif
+
+	for (unsigned i = 0; i < count; i++)
+	{
+		if (!crossed[i]) continue;	// line isn't crossed
 
-		s1 = P_PointOnDivlineSide (ld->v1->fX(), ld->v1->fY(), &trace);
-		s2 = P_PointOnDivlineSide (ld->v2->fX(), ld->v2->fY(), &trace);
-		
-		if (s1 == s2) continue;	// line isn't crossed
-		
 		// hit the line
-		P_MakeDivline (ld, &dl);
-		frac = P_InterceptVector (&trace, &dl);
+		line_t *ld = lines[i];
+		divline_t dl;
+		P_MakeDivline(ld, &dl);
+		double frac = P_InterceptVector(&trace, &dl);
 
 		if (frac < Startfrac || frac > 1.) continue;	// behind source or beyond end point
-			
+
+		// If a lazy traversal's caller has run another traversal in the meantime,
+		// validcount no longer tells which lines this one has already added.
+		if (validcount != initvalidcount)
+		{
+			unsigned j = intercept_index;
+			while (j < intercepts.Size() && !(intercepts[j].isaline && intercepts[j].d.line == ld)) j++;
+			if (j < intercepts.Size()) continue;
+		}
+
 		intercept_t newintercept;
 
 		newintercept.frac = frac;
 		newintercept.isaline = true;
 		newintercept.done = false;
 		newintercept.d.line = ld;
-		intercepts.Push (newintercept);
+		intercepts.Push(newintercept);
 	}
 }
 
@@ -1427,22 +1511,33 @@ void FPathTraverse::AddThingIntercepts (int bx, int by, FBlockThingsIterator &it
 //===========================================================================
 //
 // FPathTraverse :: Next
+//
+// A lazy traversal can only return an intercept once it is closer than
+// the point where the trace leaves the blocks added so far. Anything
+// further away could still be beaten by an intercept in the next block.
 // 
 //===========================================================================
 
 intercept_t *FPathTraverse::Next()
 {
-	intercept_t *in = NULL;
+	intercept_t *in;
+	double dist;
 
-	double dist = FLT_MAX;
-	for (unsigned scanpos = intercept_index; scanpos < intercepts.Size (); scanpos++)
+	for (;;)
 	{
-		intercept_t *scan = &intercepts[scanpos];
-		if (scan->frac < dist && !scan->done)
+		in = NULL;
+		dist = FLT_MAX;
+		for (unsigned scanpos = intercept_index; scanpos < intercepts.Size (); scanpos++)
 		{
-			dist = scan->frac;
-			in = scan;
+			intercept_t *scan = &intercepts[scanpos];
+			if (scan->frac < dist && !scan->done)
+			{
+				dist = scan->frac;
+				in = scan;
+			}
 		}
+		if (!moreblocks || (in != NULL && dist < blockexit - 1e-6)) break;
+		moreblocks = AddNextBlock();
 	}
 	
 	if (dist > 1. || in == NULL) return NULL;	// checked everything in range			
@@ -1460,17 +1555,7 @@ intercept_t *FPathTraverse::Next()
 void FPathTraverse::init(double x1, double y1, double x2, double y2, int flags, double startfrac) 
 {
 	double xt1, yt1, xt2, yt2;
-	double xstep, ystep;
 	double partialx, partialy;
-	double xintercept, yintercept;
-	
-	int 		mapx;
-	int 		mapy;
-	
-	int 		mapxstep;
-	int 		mapystep;
-
-	int 		count;
 
 	trace.x = x1;
 	trace.y = y1;
@@ -1497,6 +1582,7 @@ void FPathTraverse::init(double x1, double y1, double x2, double y2, int flags,
 	}
 
 	validcount++;
+	initvalidcount = validcount;
 	intercept_index = intercepts.Size();
 	Startfrac = startfrac;
 
@@ -1518,8 +1604,8 @@ void FPathTraverse::init(double x1, double y1, double x2, double y2, int flags,
 
 	mapx = xs_FloorToInt(xt1);
 	mapy = xs_FloorToInt(yt1);
-	int mapex = xs_FloorToInt(xt2);
-	int mapey = xs_FloorToInt(yt2);
+	mapex = xs_FloorToInt(xt2);
+	mapey = xs_FloorToInt(yt2);
 
 
 	if (mapex > mapx)
@@ -1583,87 +1669,118 @@ void FPathTraverse::init(double x1, double y1, double x2, double y2, int flags,
 		}
 	}
 
-	// Step through map blocks.
-	// Count is present to prevent a round off error
-	// from skipping the break statement.
+	compatible = (flags & PT_COMPATIBLE) && (i_compatflags & COMPATF_HITSCAN);
+	ptflags = flags;
+	blockcount = 0;
+	btit.ClearHash();
 
-	bool compatible = (flags & PT_COMPATIBLE) && (i_compatflags & COMPATF_HITSCAN);
-		
-	// we want to use one list of checked actors for the entire operation
-	FBlockThingsIterator btit;
-	for (count = 0 ; count < 1000 ; count++)
+	// Stopping early relies on every line being listed in every block it
+	// passes through, which only the engine's own blockmap guarantees.
+	moreblocks = (flags & PT_LAZY) && level.blockmap.generated;
+	if (moreblocks)
 	{
-		if (flags & PT_ADDLINES)
-		{
-			AddLineIntercepts(mapx, mapy);
-		}
-		
-		if (flags & PT_ADDTHINGS)
-		{
-			AddThingIntercepts(mapx, mapy, btit, compatible);
-		}
-				
-		// both coordinates reached the end, so end the traversing.
-		if ((mapxstep | mapystep) == 0)
-			break;
+		blockexit = Startfrac;
+	}
+	else
+	{
+		while (AddNextBlock()) {}
+	}
+}
+
+//===========================================================================
+//
+// FPathTraverse :: AddNextBlock
+//
+// Adds the intercepts of the current block and steps to the next one.
+// Returns false when there are no more blocks to check.
+//
+// Count is present to prevent a round off error
+// from skipping the end of the traversal.
+//
+//===========================================================================
+
+bool FPathTraverse::AddNextBlock()
+{
+	if (ptflags & PT_ADDLINES)
+	{
+		AddLineIntercepts(mapx, mapy);
+	}
+
+	if (ptflags & PT_ADDTHINGS)
+	{
+		AddThingIntercepts(mapx, mapy, btit, compatible);
+	}
+
+	if (moreblocks)
+	{
+		// Where the trace leaves this block, going by whichever edge it crosses first.
+		double fx = FLT_MAX, fy = FLT_MAX;
+		if (trace.dx > 0) fx = (level.blockmap.bmaporgx + (mapx + 1) * FBlockmap::MAPBLOCKUNITS - trace.x) / trace.dx;
+		else if (trace.dx < 0) fx = (level.blockmap.bmaporgx + mapx * FBlockmap::MAPBLOCKUNITS - trace.x) / trace.dx;
+		if (trace.dy > 0) fy = (level.blockmap.bmaporgy + (mapy + 1) * FBlockmap::MAPBLOCKUNITS - trace.y) / trace.dy;
+		else if (trace.dy < 0) fy = (level.blockmap.bmaporgy + mapy * FBlockmap::MAPBLOCKUNITS - trace.y) / trace.dy;
+		blockexit = MIN(fx, fy);
+	}
 
+	// both coordinates reached the end, so end the traversing.
+	if ((mapxstep | mapystep) == 0 || ++blockcount >= 1000)
+		return false;
 
-		// [RH] Handle corner cases properly instead of pretending they don't exist.
-		switch (((xs_FloorToInt(yintercept) == mapy) << 1) | (xs_FloorToInt(xintercept) == mapx))
+	// [RH] Handle corner cases properly instead of pretending they don't exist.
+	switch (((xs_FloorToInt(yintercept) == mapy) << 1) | (xs_FloorToInt(xintercept) == mapx))
+	{
+	case 0:		// neither xintercept nor yintercept match!
+		return false;	// Stop traversing, because somebody screwed up.
+
+	case 1:		// xintercept matches
+		xintercept += xstep;
+		mapy += mapystep;
+		if (mapy == mapey)
+			mapystep = 0;
+		break;
+
+	case 2:		// yintercept matches
+		yintercept += ystep;
+		mapx += mapxstep;
+		if (mapx == mapex)
+			mapxstep = 0;
+		break;
+
+	case 3:		// xintercept and yintercept both match
+		// The trace is exiting a block through its corner. Not only does the block
+		// being entered need to be checked (which will happen when this loop
+		// continues), but the other two blocks adjacent to the corner also need to
+		// be checked.
+		// Since Doom.exe did not do this, this code won't either if run in compatibility mode.
+		if (!compatible)
 		{
-		case 0:		// neither xintercept nor yintercept match!
-			count = 1000;	// Stop traversing, because somebody screwed up.
-			break;
+			if (ptflags & PT_ADDLINES)
+			{
+				AddLineIntercepts(mapx + mapxstep, mapy);
+				AddLineIntercepts(mapx, mapy + mapystep);
+			}
 
-		case 1:		// xintercept matches
+			if (ptflags & PT_ADDTHINGS)
+			{
+				AddThingIntercepts(mapx + mapxstep, mapy, btit, false);
+				AddThingIntercepts(mapx, mapy + mapystep, btit, false);
+			}
 			xintercept += xstep;
-			mapy += mapystep;
-			if (mapy == mapey)
-				mapystep = 0;
-			break;
-
-		case 2:		// yintercept matches
 			yintercept += ystep;
 			mapx += mapxstep;
+			mapy += mapystep;
 			if (mapx == mapex)
 				mapxstep = 0;
-			break;
-
-		case 3:		// xintercept and yintercept both match
-			// The trace is exiting a block through its corner. Not only does the block
-			// being entered need to be checked (which will happen when this loop
-			// continues), but the other two blocks adjacent to the corner also need to
-			// be checked.
-			// Since Doom.exe did not do this, this code won't either if run in compatibility mode.
-			if (!compatible)
-			{
-				if (flags & PT_ADDLINES)
-				{
-					AddLineIntercepts(mapx + mapxstep, mapy);
-					AddLineIntercepts(mapx, mapy + mapystep);
-				}
-				
-				if (flags & PT_ADDTHINGS)
-				{
-					AddThingIntercepts(mapx + mapxstep, mapy, btit, false);
-					AddThingIntercepts(mapx, mapy + mapystep, btit, false);
-				}
-				xintercept += xstep;
-				yintercept += ystep;
-				mapx += mapxstep;
-				mapy += mapystep;
-				if (mapx == mapex)
-					mapxstep = 0;
-				if (mapy == mapey)
-					mapystep = 0;
-			}
-			else
-			{
-				count = 1000; //	Doom originally did not handle this case so do the same in compatibility mode.
-			}
-			break;
+			if (mapy == mapey)
+				mapystep = 0;
+		}
+		else
+		{
+			return false; //	Doom originally did not handle this case so do the same in compatibility mode.
 		}
+		break;
 	}
+	return true;
 }
 
 //===========================================================================
@@ -1833,23 +1950,24 @@ static AActor *RoughBlockCheck (AActor *mo, int index, void *param)
 {
 	BlockCheckInfo *info = (BlockCheckInfo *)param;
 
-	FBlockNode *link;
+	auto &things = level.blockmap.blockthings[index];
 
-	for (link = level.blockmap.blocklinks[index]; link != NULL; link = link->NextActor)
+	for (int i = things.Size() - 1; i >= 0; i--)
 	{
-		if (link->Me != mo)
+		AActor *link = things[i].Me;
+		if (link != NULL && link != mo)
 		{
-			if (info->onlyseekable && !mo->CanSeek(link->Me))
+			if (info->onlyseekable && !mo->CanSeek(link))
 			{
 				continue;
 			}
-			if (info->frontonly && P_PointOnDivlineSide(link->Me->X(), link->Me->Y(), &info->frontline) != 0)
+			if (info->frontonly && P_PointOnDivlineSide(link->X(), link->Y(), &info->frontline) != 0)
 			{
 				continue;
 			}
-			if (mo->IsOkayToAttack (link->Me))
+			if (mo->IsOkayToAttack (link))
 			{
-				return link->Me;
+				return link;
 			}
 		}
 	}
@@ -1982,20 +2100,7 @@ int P_VanillaPointOnLineSide(double x, double y, const line_t* line)
 
 subsector_t *P_PointInSubsector(double x, double y)
 {
-	int side;
-
-	auto node = level.HeadGamenode();
-	if (node == nullptr) return &level.subsectors[0];
-
-	fixed_t xx = FLOAT2FIXED(x);
-	fixed_t yy = FLOAT2FIXED(y);
-	do
-	{
-		side = R_PointOnSide(xx, yy, node);
-		node = (node_t *)node->children[side];
-	} while (!((size_t)node & 1));
-
-	return (subsector_t *)((uint8_t *)node - 1);
+	return level.gamepointnodes.Locate(FLOAT2FIXED(x), FLOAT2FIXED(y));
 }
 
 //==========================================================================
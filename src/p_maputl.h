@@ -5,6 +5,8 @@
 #include "r_defs.h"
 #include "doomstat.h"
 #include "m_bbox.h"
+#include "p_blockmap.h"
+#include "memarena.h"
 
 extern int validcount;
 struct FBlockNode;
@@ -127,6 +129,94 @@ inline void P_LineOpening(FLineOpening &open, AActor *thing, const line_t *lined
 class FBoundingBox;
 struct polyblock_t;
 
+//============================================================================
+//
+// Scratch memory for playsim temporaries that never live longer than the
+// current tic. Everything in it is released at once at the start of
+// P_Ticker, so the movement code doesn't have to go to the heap for
+// every overflowing check list.
+//
+//============================================================================
+
+extern FMemArena PlaysimScratch;
+
+//============================================================================
+//
+// A minimal array for trivially copyable types that gets its memory from
+// PlaysimScratch. A grown array abandons its old storage to the arena.
+// Arrays owned by objects that can survive the tic (the ZScript
+// iterators) must be persistent, which makes them use the heap instead.
+//
+//============================================================================
+
+template<class T> class TScratchArray
+{
+public:
+	TScratchArray(bool persistent = false)
+	{
+		Array = nullptr;
+		Count = Most = 0;
+		Persistent = persistent;
+	}
+	~TScratchArray()
+	{
+		if (Persistent) M_Free(Array);
+	}
+	TScratchArray(const TScratchArray &) = delete;
+	TScratchArray &operator=(const TScratchArray &) = delete;
+
+	void SetPersistent()
+	{
+		assert(Array == nullptr);
+		Persistent = true;
+	}
+	unsigned Size() const
+	{
+		return Count;
+	}
+	void Clear()
+	{
+		Count = 0;
+	}
+	T &operator[](unsigned index)
+	{
+		return Array[index];
+	}
+	unsigned Reserve(unsigned amount)
+	{
+		if (Count + amount > Most) Grow(Count + amount);
+		unsigned place = Count;
+		Count += amount;
+		return place;
+	}
+	void Push(const T &item)
+	{
+		Array[Reserve(1)] = item;
+	}
+
+private:
+	void Grow(unsigned needed)
+	{
+		unsigned newmost = MAX(needed, MAX(Most * 2, 16u));
+		if (Persistent)
+		{
+			Array = (T *)M_Realloc(Array, newmost * sizeof(T));
+		}
+		else
+		{
+			T *newarray = (T *)PlaysimScratch.Alloc(newmost * sizeof(T));
+			if (Count > 0) memcpy(newarray, Array, Count * sizeof(T));
+			Array = newarray;
+		}
+		Most = newmost;
+	}
+
+	T *Array;
+	unsigned Count;
+	unsigned Most;
+	bool Persistent;
+};
+
 //============================================================================
 //
 // This is a dynamic array which holds its first MAX_STATIC entries in normal
@@ -165,7 +255,8 @@ struct FPortalGroupArray
 		MAX_STATIC = 4
 	};
 
-	FPortalGroupArray(int collectionmethod = PGA_CheckPosition)
+	FPortalGroupArray(int collectionmethod = PGA_CheckPosition, bool persistent = false)
+		: data(persistent)
 	{
 		method = collectionmethod;
 		varused = 0;
@@ -201,7 +292,7 @@ struct FPortalGroupArray
 private:
 	uint16_t entry[MAX_STATIC];
 	uint8_t varused;
-	TArray<uint16_t> data;
+	TScratchArray<uint16_t> data;
 };
 
 class FBlockLinesIterator
@@ -282,7 +373,8 @@ class FBlockThingsIterator
 
 	int curx, cury;
 
-	FBlockNode *block;
+	TArray<FBlockThing> *block;
+	int blockpos;
 
 	int Buckets[32];
 
@@ -293,7 +385,7 @@ class FBlockThingsIterator
 	};
 	HashEntry FixedHash[10];
 	int NumFixedHash;
-	TArray<HashEntry> DynHash;
+	TScratchArray<HashEntry> DynHash;
 
 	HashEntry *GetHashEntry(int i) { return i < (int)countof(FixedHash) ? &FixedHash[i] : &DynHash[i - countof(FixedHash)]; }
 
@@ -317,6 +409,7 @@ public:
 	void init(const FBoundingBox &box, bool clearhash = true);
 	AActor *Next(bool centeronly = false);
 	void Reset() { StartBlock(minx, miny); }
+	void SetPersistent() { DynHash.SetPersistent(); }
 };
 
 class FMultiBlockThingsIterator
@@ -346,6 +439,7 @@ public:
 	FMultiBlockThingsIterator(FPortalGroupArray &check, double checkx, double checky, double checkz, double checkh, double checkradius, bool ignorerestricted, sector_t *newsec);
 	bool Next(CheckResult *item);
 	void Reset();
+	void SetPersistent() { blockIterator.SetPersistent(); }
 	const FBoundingBox &Box() const
 	{
 		return bbox;
@@ -365,8 +459,24 @@ protected:
 	unsigned int intercept_count;
 	unsigned int count;
 
+	// Block stepping state. Normally all blocks are stepped through by init,
+	// with PT_LAZY only as many as Next needs to find the closest intercept.
+	int ptflags;
+	int mapx, mapy, mapex, mapey;
+	int mapxstep, mapystep;
+	double xstep, ystep;
+	double xintercept, yintercept;
+	int blockcount;
+	bool compatible;
+	bool moreblocks;		// lazy traversal hasn't reached the end yet
+	double blockexit;		// trace fraction at which the last added block is left
+	int initvalidcount;
+	FBlockThingsIterator btit;	// one list of checked actors for the entire operation
+
 	virtual void AddLineIntercepts(int bx, int by);
+	void AddLineInterceptsBatch(line_t **lines, unsigned count);
 	virtual void AddThingIntercepts(int bx, int by, FBlockThingsIterator &it, bool compatible);
+	bool AddNextBlock();
 	FPathTraverse() {}
 public:
 
@@ -418,10 +528,23 @@ typedef bool(*traverser_t) (intercept_t *in);
 
 int P_AproxDistance (int dx, int dy);
 double P_InterceptVector(const divline_t *v2, const divline_t *v1);
+sector_t *P_PointInSectorBuggy(double x, double y);
+
+// BSP lookups for a map thing's spawn position, precomputed by P_SpawnThings.
+// LinkToWorld uses them instead of walking the nodes if the position matches.
+struct FSpawnLocationHint
+{
+	DVector2 pos;
+	sector_t *sector;		// from P_PointInSectorBuggy
+	subsector_t *subsector;	// from R_PointInSubsector
+};
+
+extern const FSpawnLocationHint *SpawnLocationHint;
 
 #define PT_ADDLINES 	1
 #define PT_ADDTHINGS	2
 #define PT_COMPATIBLE	4
 #define PT_DELTA		8		// x2,y2 is passed as a delta, not as an endpoint
+#define PT_LAZY			16		// only collect intercepts up to the one Next is about to return
 
 #endif
\ No newline at end of file
@@ -526,6 +526,14 @@ bool AActor::SetState (FState *newstate, bool nofunction)
 			Destroy ();
 			return false;
 		}
+		if (newstate->ZeroTicSkip != nullptr)
+		{ // These states neither change anything nor call anything, so only the last one needs to be set.
+			state = newstate->ZeroTicSkip;
+			tics = 0;
+			renderflags = (renderflags & ~RF_FULLBRIGHT) | ActorRenderFlags::FromInt (state->GetFullbright());
+			newstate = state->GetNextState();
+			continue;
+		}
 		int prevsprite, newsprite;
 
 		if (state != NULL)
@@ -581,10 +589,11 @@ bool AActor::SetState (FState *newstate, bool nofunction)
 			}
 		}
 
-		if (!nofunction)
+		if (!nofunction && newstate->ActionFunc != nullptr)
 		{
 			FState *returned_state;
 			FStateParamInfo stp = { newstate, STATE_Actor, PSP_WEAPON };
+			FThinkerProfileScope profile(TPC_Action);
 			if (newstate->CallAction(this, this, &stp, &returned_state))
 			{
 				// Check whether the called action function resulted in destroying the actor
@@ -705,6 +714,51 @@ AActor *AActor::DropInventory (AActor *item, int amt)
 	return nullptr;
 }
 
+//============================================================================
+//
+// AActor :: InventoryMayContain
+//
+// Large inventories keep a bit filter of the classes (and all their
+// ancestors) they hold, so that looking for something the actor doesn't
+// carry doesn't have to walk the entire list. Items only get added through
+// AddInventory, which bumps InventoryID, or ObtainInventory, which replaces
+// the list head, so checking these two is enough to validate the filter.
+// Removed items just leave stale bits behind, which only cost a list walk.
+//
+//============================================================================
+
+static inline unsigned InventoryFilterBit(PClass *cls)
+{
+	return (uint32_t(uintptr_t(cls) >> 4) * 0x9E3779B1u) >> 24;
+}
+
+bool AActor::InventoryMayContain (PClassActor *type)
+{
+	if (InventoryFilterHead != Inventory || InventoryFilterID != InventoryID)
+	{
+		InventoryFilterHead = Inventory;
+		InventoryFilterID = InventoryID;
+		memset(InventoryFilter, 0, sizeof(InventoryFilter));
+
+		int count = 0;
+		for (AActor *item = Inventory; item != NULL; item = item->Inventory, count++)
+		{
+			for (PClass *cls = item->GetClass(); cls != NULL; cls = cls->ParentClass)
+			{
+				unsigned bit = InventoryFilterBit(cls);
+				InventoryFilter[bit >> 6] |= 1ull << (bit & 63);
+			}
+		}
+		InventoryFiltered = count >= 16;
+	}
+	if (!InventoryFiltered)
+	{
+		return true;
+	}
+	unsigned bit = InventoryFilterBit(type);
+	return !!(InventoryFilter[bit >> 6] & (1ull << (bit & 63)));
+}
+
 //============================================================================
 //
 // AActor :: FindInventory
@@ -715,7 +769,7 @@ AActor *AActor::FindInventory (PClassActor *type, bool subclass)
 {
 	AActor *item;
 
-	if (type == NULL)
+	if (type == NULL || Inventory == NULL || !InventoryMayContain(type))
 	{
 		return NULL;
 	}
@@ -1797,6 +1851,51 @@ bool P_SeekerMissile (AActor *actor, double thresh, double turnMax, bool precise
 }
 
 
+//============================================================================
+//
+// P_MissilePathIsClear
+//
+// Fast missiles take many small steps so that they can't skip over
+// anything. If the area swept by the whole move touches no line and no
+// other actor, it is all inside one sector, and none of the intermediate
+// steps can have a different outcome than the last one, so only that one
+// needs to be checked. Anything more involved takes the normal path.
+//
+//============================================================================
+
+static bool P_MissilePathIsClear(AActor *mo, const DVector2 &start, const DVector2 &move)
+{
+	if (!(mo->flags & MF_MISSILE) || (mo->flags2 & MF2_RIP) || (i_compatflags & COMPATF_WALLRUN))
+		return false;
+
+	sector_t *sec = mo->Sector;
+	if (sec->floorplane.isSlope() || sec->ceilingplane.isSlope() || sec->GetHeightSec() != nullptr ||
+		sec->e->XFloor.ffloors.Size() > 0 || sec->PortalIsLinked(sector_t::floor) || sec->PortalIsLinked(sector_t::ceiling))
+		return false;
+
+	DVector2 end = start + move;
+	FBoundingBox box = FBoundingBox(start.X, start.Y, mo->radius) | FBoundingBox(end.X, end.Y, mo->radius);
+
+	FBlockLinesIterator lit(box);
+	line_t *ld;
+	while ((ld = lit.Next()))
+	{
+		if (box.inRange(ld) && box.BoxOnLineSide(ld) == -1)
+			return false;
+	}
+
+	FBlockThingsIterator tit(box);
+	AActor *thing;
+	while ((thing = tit.Next()))
+	{
+		if (thing == mo) continue;
+		if (thing->X() + thing->radius >= box.Left() && thing->X() - thing->radius <= box.Right() &&
+			thing->Y() + thing->radius >= box.Bottom() && thing->Y() - thing->radius <= box.Top())
+			return false;
+	}
+	return true;
+}
+
 //
 // P_XYMovement
 //
@@ -1807,6 +1906,7 @@ bool P_SeekerMissile (AActor *actor, double thresh, double turnMax, bool precise
 
 double P_XYMovement (AActor *mo, DVector2 scroll) 
 {
+	FThinkerProfileScope profile(TPC_Movement);
 	static int pushtime = 0;
 	bool bForceSlide = !scroll.isZero();
 	DVector2 ptry;
@@ -1970,6 +2070,10 @@ double P_XYMovement (AActor *mo, DVector2 scroll)
 	FCheckPosition tm(!!(mo->flags2 & MF2_RIP));
 
 	DAngle oldangle = mo->Angles.Yaw;
+	if (steps > 1 && P_MissilePathIsClear(mo, start, move))
+	{
+		step = steps;
+	}
 	do
 	{
 		if (i_compatflags & COMPATF_WALLRUN) pushtime++;
@@ -2385,6 +2489,7 @@ void P_MonsterFallingDamage (AActor *mo)
 
 void P_ZMovement (AActor *mo, double oldfloorz)
 {
+	FThinkerProfileScope profile(TPC_Movement);
 	double dist;
 	double delta;
 	double oldz = mo->Z();
@@ -2922,6 +3027,7 @@ void P_NightmareRespawn (AActor *mobj)
 
 
 AActor *AActor::TIDHash[128];
+unsigned AActor::TIDHashGeneration;
 
 //
 // P_ClearTidHashes
@@ -2932,6 +3038,7 @@ AActor *AActor::TIDHash[128];
 void AActor::ClearTIDHashes ()
 {
 	memset(TIDHash, 0, sizeof(TIDHash));
+	TIDHashGeneration++;
 }
 
 //
@@ -2957,6 +3064,7 @@ void AActor::AddToHash ()
 		inext = TIDHash[hash];
 		iprev = &TIDHash[hash];
 		TIDHash[hash] = this;
+		TIDHashGeneration++;
 		if (inext)
 		{
 			inext->iprev = &inext;
@@ -2980,6 +3088,7 @@ void AActor::RemoveFromHash ()
 		}
 		iprev = NULL;
 		inext = NULL;
+		TIDHashGeneration++;
 	}
 	tid = 0;
 }
@@ -3681,6 +3790,19 @@ void AActor::Tick ()
 			return;
 		}
 
+		if (CanTickIdle())
+		{
+			// Everything below would be a no-op for this actor, so only do the
+			// bookkeeping that movement would have done and count down the state.
+			flags4 &= ~MF4_SCROLLMOVE;
+			BlockingMobj = nullptr;
+			Blocking3DFloor = nullptr;
+			BlockingFloor = nullptr;
+			BlockingCeiling = nullptr;
+			--tics;
+			return;
+		}
+
 		if (effects & FX_ROCKET) 
 		{
 			if (++smokecounter == 4)
@@ -4163,6 +4285,55 @@ void AActor::Tick ()
 	}
 }
 
+//==========================================================================
+//
+// AActor :: CanTickIdle
+//
+// Checks if this actor is resting on a plain floor, doing nothing but
+// waiting for its state to run out, like a monster standing in its
+// A_Look loop. For such actors the entire movement part of Tick has
+// no effect and consumes no random numbers, so it can be skipped
+// without changing the outcome. Anything that sets the actor in motion,
+// damages or alerts it or changes its state takes it off this path again.
+//
+//==========================================================================
+
+bool AActor::CanTickIdle()
+{
+	if (player != nullptr || Inventory != nullptr || tics <= 1 || state->GetCanRaise())
+		return false;
+
+	if (!Vel.isZero() || Z() != floorz || Pos() != OldRenderPos)
+		return false;
+
+	if ((flags & (MF_MISSILE | MF_SKULLFLY | MF_STEALTH | MF_CORPSE)) ||
+		(flags2 & (MF2_BLASTED | MF2_WINDTHRUST)) ||
+		(flags4 & MF4_VFRICTION) ||
+		(flags6 & (MF6_TOUCHY | MF6_KILLED)) ||
+		(flags7 & MF7_HANDLENODELAY) ||
+		(flags8 & MF8_INSCROLLSEC) ||
+		(effects & (FX_ROCKET | FX_GRENADE | FX_VISIBILITYPULSE)))
+		return false;
+
+	if (health <= 0 || PoisonDurationReceived != 0 || waterlevel != 0 || boomwaterlevel != 0)
+		return false;
+
+	if (bglobal.botnum && !demoplayback)
+		return false;
+
+	// Water, slopes, 3D floors and portals all need the full checks.
+	if (Sector->GetHeightSec() != nullptr || (Sector->MoreFlags & SECMF_UNDERWATER) || Sector->e->XFloor.ffloors.Size() > 0)
+		return false;
+
+	if (!Sector->PortalBlocksMovement(sector_t::ceiling) || !Sector->PortalBlocksMovement(sector_t::floor))
+		return false;
+
+	if (floorsector == nullptr || floorsector->floorplane.isSlope() || floorsector->e->XFloor.ffloors.Size() > 0)
+		return false;
+
+	return true;
+}
+
 //==========================================================================
 //
 // AActor :: CheckNoDelay
@@ -4975,7 +5146,8 @@ void AActor::AdjustFloorClip ()
 	// [RH] clip based on shallowest floor player is standing on
 	// If the sector has a deep water effect, then let that effect
 	// do the floorclipping instead of the terrain type.
-	for (m = touching_sectorlist; m; m = m->m_tnext)
+	// If no terrain clips at all, every floor would give 0, same as no floor.
+	for (m = AnyTerrainFootClip ? touching_sectorlist : nullptr; m; m = m->m_tnext)
 	{
 		DVector3 pos = PosRelative(m->m_sector);
 		sector_t* hsec = m->m_sector->GetHeightSec();
@@ -6182,6 +6354,10 @@ bool P_HitWater (AActor * thing, sector_t * sec, const DVector3 &pos, bool check
 	if (thing->player && (thing->player->cheats & CF_PREDICTING))
 		return false;
 
+	// Nothing to find if no terrain is liquid or splashes.
+	if (!AnyTerrainSplash)
+		return false;
+
 	AActor *mo = NULL;
 	FSplashDef *splash;
 	int terrainnum;
@@ -6360,6 +6536,11 @@ bool P_HitFloor (AActor *thing)
 		return false;
 	}
 
+	if (!AnyTerrainSplash)
+	{
+		return false;
+	}
+
 	// don't splash if landing on the edge above water/lava/etc....
 	DVector3 pos;
 	for (m = thing->touching_sectorlist; m; m = m->m_tnext)
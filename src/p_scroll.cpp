@@ -69,6 +69,23 @@
 //
 //-----------------------------------------------------------------------------
 
+// One scroller in the flat list used by P_TickScrollers. Constant speed
+// wall and plane scrollers are handled by the loop itself, everything
+// else by the scroller's own Tick.
+struct FScrollEntry
+{
+	DScroller *Scroller;	// only set for scrollers that need their Tick
+	EScroll Type;
+	EScrollPos Parts;
+	int Affectee;
+	double dx, dy;
+};
+
+static TArray<FScrollEntry> ScrollBatch;
+static DThinker *ScrollBatchTail;
+static bool ScrollBatchDirty = true;
+static bool ScrollBatchUsable;
+
 class DScroller : public DThinker
 {
 	DECLARE_CLASS (DScroller, DThinker)
@@ -84,10 +101,11 @@ public:
 
 	bool AffectsWall (int wallnum) const { return m_Type == EScroll::sc_side && m_Affectee == wallnum; }
 	int GetWallNum () const { return m_Type == EScroll::sc_side ? m_Affectee : -1; }
-	void SetRate (double dx, double dy) { m_dx = dx; m_dy = dy; }
+	void SetRate (double dx, double dy) { m_dx = dx; m_dy = dy; ScrollBatchDirty = true; }
 	bool IsType (EScroll type) const { return type == m_Type; }
 	int GetAffectee () const { return m_Affectee; }
 	EScrollPos GetScrollParts() const { return m_Parts; }
+	void GetBatchEntry(FScrollEntry &entry);
 
 protected:
 	EScroll m_Type;		// Type of scroll effect
@@ -103,6 +121,7 @@ protected:
 private:
 	DScroller ()
 	{
+		ScrollBatchDirty = true;
 	}
 };
 
@@ -268,6 +287,116 @@ void DScroller::Tick ()
 	}
 }
 
+//-----------------------------------------------------------------------------
+//
+// Fills in the entry for P_TickScrollers. Only scrollers whose amount never
+// changes by itself can be inlined, and carrying scrollers are left alone
+// since they need to mark the actors in the sector.
+//
+//-----------------------------------------------------------------------------
+
+void DScroller::GetBatchEntry(FScrollEntry &entry)
+{
+	entry.Type = m_Type;
+	entry.Parts = m_Parts;
+	entry.Affectee = m_Affectee;
+	entry.dx = m_dx;
+	entry.dy = m_dy;
+
+	bool inlined = m_Control == -1 && !m_Accel && (m_dx != 0 || m_dy != 0) &&
+		(m_Type == EScroll::sc_side || m_Type == EScroll::sc_floor || m_Type == EScroll::sc_ceiling);
+	entry.Scroller = inlined ? nullptr : this;
+}
+
+//-----------------------------------------------------------------------------
+//
+// Ticks all scrollers from a flat list of their parameters instead of
+// walking the thinker list, which keeps maps with thousands of scrolling
+// walls from touching every scroller object each tic. The list is rebuilt
+// whenever a scroller is created, destroyed or changes speed, and is kept
+// in thinker order so the results are the same as ticking the thinkers.
+//
+// Returns the number of scrollers ticked, or -1 if the list contains
+// anything else and has to be ticked normally.
+//
+//-----------------------------------------------------------------------------
+
+int P_TickScrollers(FThinkerList *list)
+{
+	if (ScrollBatchDirty || list->GetTail() != ScrollBatchTail)
+	{
+		ScrollBatch.Clear();
+		ScrollBatchTail = list->GetTail();
+		ScrollBatchDirty = false;
+		ScrollBatchUsable = true;
+		for (DThinker *node = list->GetHead(); node != nullptr && node != list->Sentinel; node = node->NextThinker)
+		{
+			if (node->ObjectFlags & OF_EuthanizeMe) continue;
+			if (node->GetClass() != RUNTIME_CLASS(DScroller) || (node->ObjectFlags & OF_JustSpawned))
+			{
+				ScrollBatchUsable = false;
+				break;
+			}
+			static_cast<DScroller *>(node)->GetBatchEntry(ScrollBatch[ScrollBatch.Reserve(1)]);
+		}
+	}
+	if (!ScrollBatchUsable)
+	{
+		return -1;
+	}
+
+	for (auto &entry : ScrollBatch)
+	{
+		if (entry.Scroller != nullptr)
+		{
+			entry.Scroller->Tick();
+			continue;
+		}
+
+		double tdx, tdy;
+		switch (entry.Type)
+		{
+		case EScroll::sc_side:
+		{
+			side_t *side = &level.sides[entry.Affectee];
+			if (entry.Parts & EScrollPos::scw_top)
+			{
+				side->AddTextureXOffset(side_t::top, entry.dx);
+				side->AddTextureYOffset(side_t::top, entry.dy);
+			}
+			if (entry.Parts & EScrollPos::scw_mid && (side->linedef->backsector == NULL ||
+				!(side->linedef->flags&ML_3DMIDTEX)))
+			{
+				side->AddTextureXOffset(side_t::mid, entry.dx);
+				side->AddTextureYOffset(side_t::mid, entry.dy);
+			}
+			if (entry.Parts & EScrollPos::scw_bottom)
+			{
+				side->AddTextureXOffset(side_t::bottom, entry.dx);
+				side->AddTextureYOffset(side_t::bottom, entry.dy);
+			}
+			break;
+		}
+
+		case EScroll::sc_floor:
+			RotationComp(&level.sectors[entry.Affectee], sector_t::floor, entry.dx, entry.dy, tdx, tdy);
+			level.sectors[entry.Affectee].AddXOffset(sector_t::floor, tdx);
+			level.sectors[entry.Affectee].AddYOffset(sector_t::floor, tdy);
+			break;
+
+		case EScroll::sc_ceiling:
+			RotationComp(&level.sectors[entry.Affectee], sector_t::ceiling, entry.dx, entry.dy, tdx, tdy);
+			level.sectors[entry.Affectee].AddXOffset(sector_t::ceiling, tdx);
+			level.sectors[entry.Affectee].AddYOffset(sector_t::ceiling, tdy);
+			break;
+
+		default:
+			break;
+		}
+	}
+	return ScrollBatch.Size();
+}
+
 //-----------------------------------------------------------------------------
 //
 // Add_Scroller()
@@ -306,6 +435,7 @@ DScroller::DScroller (EScroll type, double dx, double dy,
 	}
 	m_Affectee = affectee;
 	m_Interpolations[0] = m_Interpolations[1] = m_Interpolations[2] = NULL;
+	ScrollBatchDirty = true;
 
 	switch (type)
 	{
@@ -353,6 +483,7 @@ void DScroller::OnDestroy ()
 			m_Interpolations[i] = NULL;
 		}
 	}
+	ScrollBatchDirty = true;
 	Super::OnDestroy();
 }
 
@@ -390,6 +521,7 @@ DScroller::DScroller (double dx, double dy, const line_t *l,
 	m_Affectee = l->sidedef[0]->Index();
 	level.sides[m_Affectee].Flags |= WALLF_NOAUTODECALS;
 	m_Interpolations[0] = m_Interpolations[1] = m_Interpolations[2] = NULL;
+	ScrollBatchDirty = true;
 
 	if (m_Parts & EScrollPos::scw_top)
 	{
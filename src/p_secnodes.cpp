@@ -38,7 +38,8 @@
 //=============================================================================
 
 msecnode_t *headsecnode = nullptr;
-FMemArena secnodearena;
+FMemArena secnodearena(64 * 1024);
+static unsigned numallocsecnodes, numfreesecnodes;
 
 //=============================================================================
 //
@@ -57,10 +58,12 @@ msecnode_t *P_GetSecnode()
 	{
 		node = headsecnode;
 		headsecnode = headsecnode->m_snext;
+		numfreesecnodes--;
 	}
 	else
 	{
 		node = (msecnode_t *)secnodearena.Alloc(sizeof(*node));
+		numallocsecnodes++;
 	}
 	return node;
 }
@@ -77,6 +80,29 @@ void P_PutSecnode(msecnode_t *node)
 {
 	node->m_snext = headsecnode;
 	headsecnode = node;
+	numfreesecnodes++;
+}
+
+//=============================================================================
+//
+// P_ReleaseSecnodes
+//
+// Gives the arena's memory back once a level has been torn down, so
+// that the next level starts with nodes that are allocated close to
+// each other instead of a free list scattered across the old level's
+// allocations. This is only done if every node has been returned,
+// otherwise some actor outside the level still holds on to them.
+//
+//=============================================================================
+
+void P_ReleaseSecnodes()
+{
+	if (numfreesecnodes == numallocsecnodes)
+	{
+		secnodearena.FreeAll();
+		headsecnode = nullptr;
+		numallocsecnodes = numfreesecnodes = 0;
+	}
 }
 
 //=============================================================================
@@ -106,6 +106,9 @@
 #include "r_renderer.h"
 #include "r_data/colormaps.h"
 #include "p_blockmap.h"
+#include "p_maputl.h"
+#include "p_loadtrace.h"
+#include "parallel_for.h"
 #include "r_utility.h"
 #include "p_spec.h"
 #include "p_saveg.h"
@@ -1440,9 +1443,33 @@ void P_SpawnThings (int position)
 {
 	int numthings = MapThingsConverted.Size();
 
+	// The BSP walks for each thing's spawn position only read the finished
+	// level geometry, so they can be done for all things up front, in
+	// parallel. Spawning itself stays serial and in map order, since it
+	// runs script code and consumes random numbers.
+	TArray<FSpawnLocationHint> hints;
+	if (numthings >= 256)
+	{
+		hints.Resize(numthings);
+		const int chunk = 64;
+		parallel_for(0, numthings, chunk, [&](int first)
+		{
+			int last = MIN(first + chunk, numthings);
+			for (int j = first; j < last; j++)
+			{
+				auto &hint = hints[j];
+				hint.pos = MapThingsConverted[j].pos.XY();
+				hint.sector = P_PointInSectorBuggy(hint.pos.X, hint.pos.Y);
+				hint.subsector = R_PointInSubsector(hint.pos);
+			}
+		});
+	}
+
 	for (int i=0; i < numthings; i++)
 	{
+		if (hints.Size() > 0) SpawnLocationHint = &hints[i];
 		AActor *actor = SpawnMapThing (i, &MapThingsConverted[i], position);
+		SpawnLocationHint = nullptr;
 		unsigned *udi = MapThingsUserDataIndex.CheckKey((unsigned)i);
 		if (udi != NULL)
 		{
@@ -2307,65 +2334,46 @@ void P_LoadSideDefs2 (MapData *map, FMissingTextureTracker &missingtex)
 //
 //===========================================================================
 
-static unsigned int BlockHash (TArray<int> *block)
+static unsigned int BlockHash (const int *ar, int size)
 {
 	int hash = 0;
-	int *ar = &(*block)[0];
-	for (size_t i = 0; i < block->Size(); ++i)
+	for (int i = 0; i < size; ++i)
 	{
 		hash = hash * 12235 + ar[i];
 	}
 	return hash & 0x7fffffff;
 }
 
-static bool BlockCompare (TArray<int> *block1, TArray<int> *block2)
-{
-	size_t size = block1->Size();
-
-	if (size != block2->Size())
-	{
-		return false;
-	}
-	if (size == 0)
-	{
-		return true;
-	}
-	int *ar1 = &(*block1)[0];
-	int *ar2 = &(*block2)[0];
-	for (size_t i = 0; i < size; ++i)
-	{
-		if (ar1[i] != ar2[i])
-		{
-			return false;
-		}
-	}
-	return true;
-}
+//===========================================================================
+//
+// The line lists of all blocks are stored in one flat array, with
+// blockstart[i] .. blockstart[i+1] delimiting block i's lines.
+//
+//===========================================================================
 
-static void CreatePackedBlockmap (TArray<int> &BlockMap, TArray<int> *blocks, int bmapwidth, int bmapheight)
+static void CreatePackedBlockmap (TArray<int> &BlockMap, const TArray<int> &blocklines, const TArray<int> &blockstart, int bmapwidth, int bmapheight)
 {
 	int buckets[4096];
 	int hashblock;
-	TArray<int> *block;
-	int zero = 0;
-	int terminator = -1;
-	int *array;
 	int i, hash;
-	int hashed = 0, nothashed = 0;
+	const int numblocks = bmapwidth * bmapheight;
 
-	TArray<int> hashes(bmapwidth * bmapheight, true);
+	TArray<int> hashes(numblocks, true);
 
-	memset (hashes.Data(), 0xff, sizeof(int)*bmapwidth*bmapheight);
+	memset (hashes.Data(), 0xff, sizeof(int)*numblocks);
 	memset (buckets, 0xff, sizeof(buckets));
 
-	for (i = 0; i < bmapwidth * bmapheight; ++i)
+	for (i = 0; i < numblocks; ++i)
 	{
-		block = &blocks[i];
-		hash = BlockHash (block) % 4096;
+		const int *block = blocklines.Data() + blockstart[i];
+		int size = blockstart[i + 1] - blockstart[i];
+
+		hash = BlockHash (block, size) % 4096;
 		hashblock = buckets[hash];
 		while (hashblock != -1)
 		{
-			if (BlockCompare (block, &blocks[hashblock]))
+			if (blockstart[hashblock + 1] - blockstart[hashblock] == size &&
+				(size == 0 || !memcmp(block, blocklines.Data() + blockstart[hashblock], size * sizeof(int))))
 			{
 				break;
 			}
@@ -2374,21 +2382,17 @@ static void CreatePackedBlockmap (TArray<int> &BlockMap, TArray<int> *blocks, in
 		if (hashblock != -1)
 		{
 			BlockMap[4+i] = BlockMap[4+hashblock];
-			hashed++;
 		}
 		else
 		{
 			hashes[i] = buckets[hash];
 			buckets[hash] = i;
 			BlockMap[4+i] = BlockMap.Size ();
-			BlockMap.Push (zero);
-			array = &(*block)[0];
-			for (size_t j = 0; j < block->Size(); ++j)
-			{
-				BlockMap.Push (array[j]);
-			}
-			BlockMap.Push (terminator);
-			nothashed++;
+
+			unsigned pos = BlockMap.Reserve (size + 2);
+			BlockMap[pos] = 0;
+			if (size > 0) memcpy (&BlockMap[pos + 1], block, size * sizeof(int));
+			BlockMap[pos + size + 1] = -1;
 		}
 	}
 }
@@ -2396,49 +2400,16 @@ static void CreatePackedBlockmap (TArray<int> &BlockMap, TArray<int> *blocks, in
 #define BLOCKBITS 7
 #define BLOCKSIZE 128
 
-static void P_CreateBlockMap ()
-{
-	TArray<int> *block, *endblock;
-	TArray<TArray<int>> BlockLists;
-	int adder;
-	int bmapwidth, bmapheight;
-	double dminx, dmaxx, dminy, dmaxy;
-	int minx, maxx, miny, maxy;
-	int line;
-
-	if (level.vertexes.Size() == 0)
-		return;
-
-	// Find map extents for the blockmap
-	dminx = dmaxx = level.vertexes[0].fX();
-	dminy = dmaxy = level.vertexes[0].fY();
-
-	for (auto &vert : level.vertexes)
-	{
-			 if (vert.fX() < dminx) dminx = vert.fX();
-		else if (vert.fX() > dmaxx) dmaxx = vert.fX();
-			 if (vert.fY() < dminy) dminy = vert.fY();
-		else if (vert.fY() > dmaxy) dmaxy = vert.fY();
-	}
-
-	minx = int(dminx);
-	miny = int(dminy);
-	maxx = int(dmaxx);
-	maxy = int(dmaxy);
-
-	bmapwidth =	 ((maxx - minx) >> BLOCKBITS) + 1;
-	bmapheight = ((maxy - miny) >> BLOCKBITS) + 1;
-
-	TArray<int> BlockMap (bmapwidth * bmapheight * 3 + 4);
-
-	adder = minx;			BlockMap.Push (adder);
-	adder = miny;			BlockMap.Push (adder);
-	adder = bmapwidth;		BlockMap.Push (adder);
-	adder = bmapheight;		BlockMap.Push (adder);
-
-	BlockLists.Resize(bmapwidth * bmapheight);
+//===========================================================================
+//
+// Calls emit(block, line) for every block a line passes through.
+//
+//===========================================================================
 
-	for (line = 0; line < (int)level.lines.Size(); ++line)
+template<class Func>
+static void RasterizeBlockLines (int bmapwidth, int minx, int miny, Func emit)
+{
+	for (int line = 0; line < (int)level.lines.Size(); ++line)
 	{
 		int x1 = int(level.lines[line].v1->fX());
 		int y1 = int(level.lines[line].v1->fY());
@@ -2451,12 +2422,12 @@ static void P_CreateBlockMap ()
 		int bx2 = (x2 - minx) >> BLOCKBITS;
 		int by2 = (y2 - miny) >> BLOCKBITS;
 
-		block = &BlockLists[bx + by * bmapwidth];
-		endblock = &BlockLists[bx2 + by2 * bmapwidth];
+		int block = bx + by * bmapwidth;
+		int endblock = bx2 + by2 * bmapwidth;
 
 		if (block == endblock)	// Single block
 		{
-			block->Push (line);
+			emit (block, line);
 		}
 		else if (by == by2)		// Horizontal line
 		{
@@ -2466,7 +2437,7 @@ static void P_CreateBlockMap ()
 			}
 			do
 			{
-				block->Push (line);
+				emit (block, line);
 				block += 1;
 			} while (block <= endblock);
 		}
@@ -2478,7 +2449,7 @@ static void P_CreateBlockMap ()
 			}
 			do
 			{
-				block->Push (line);
+				emit (block, line);
 				block += bmapwidth;
 			} while (block <= endblock);
 		}
@@ -2513,20 +2484,20 @@ static void P_CreateBlockMap ()
 					int stop = (Scale ((by << BLOCKBITS) + yadd - (y1 - miny), dx, dy) + (x1 - minx)) >> BLOCKBITS;
 					while (bx != stop)
 					{
-						block->Push (line);
+						emit (block, line);
 						block += xchange;
 						bx += xchange;
 					}
-					block->Push (line);
+					emit (block, line);
 					block += ymove;
 					by += ychange;
 				} while (by != by2);
 				while (block != endblock)
 				{
-					block->Push (line);
+					emit (block, line);
 					block += xchange;
 				}
-				block->Push (line);
+				emit (block, line);
 			}
 			else					// Y-major
 			{
@@ -2536,32 +2507,94 @@ static void P_CreateBlockMap ()
 					int stop = (Scale ((bx << BLOCKBITS) + xadd - (x1 - minx), dy, dx) + (y1 - miny)) >> BLOCKBITS;
 					while (by != stop)
 					{
-						block->Push (line);
+						emit (block, line);
 						block += ymove;
 						by += ychange;
 					}
-					block->Push (line);
+					emit (block, line);
 					block += xchange;
 					bx += xchange;
 				} while (bx != bx2);
 				while (block != endblock)
 				{
-					block->Push (line);
+					emit (block, line);
 					block += ymove;
 				}
-				block->Push (line);
+				emit (block, line);
 			}
 		}
 	}
+}
 
-	BlockMap.Reserve (bmapwidth * bmapheight);
-	CreatePackedBlockmap (BlockMap, BlockLists.Data(), bmapwidth, bmapheight);
+static void P_CreateBlockMap (MapData *map)
+{
+	int adder;
+	int bmapwidth, bmapheight;
+	double dminx, dmaxx, dminy, dmaxy;
+	int minx, maxx, miny, maxy;
 
-	level.blockmap.blockmaplump = new int[BlockMap.Size()];
-	for (unsigned int ii = 0; ii < BlockMap.Size(); ++ii)
+	if (level.vertexes.Size() == 0)
+		return;
+
+	level.blockmap.generated = true;
+	if (P_LoadCachedBlockMap(map))
+		return;
+
+	uint64_t starttime = I_msTime();
+
+	// Find map extents for the blockmap
+	dminx = dmaxx = level.vertexes[0].fX();
+	dminy = dmaxy = level.vertexes[0].fY();
+
+	for (auto &vert : level.vertexes)
 	{
-		level.blockmap.blockmaplump[ii] = BlockMap[ii];
+			 if (vert.fX() < dminx) dminx = vert.fX();
+		else if (vert.fX() > dmaxx) dmaxx = vert.fX();
+			 if (vert.fY() < dminy) dminy = vert.fY();
+		else if (vert.fY() > dmaxy) dmaxy = vert.fY();
 	}
+
+	minx = int(dminx);
+	miny = int(dminy);
+	maxx = int(dmaxx);
+	maxy = int(dmaxy);
+
+	bmapwidth =	 ((maxx - minx) >> BLOCKBITS) + 1;
+	bmapheight = ((maxy - miny) >> BLOCKBITS) + 1;
+
+	const int numblocks = bmapwidth * bmapheight;
+
+	// Two passes over the lines instead of one growing list per block:
+	// first count how many lines each block gets, then fill them into
+	// one flat array at the offsets given by the counts.
+	TArray<int> blockstart(numblocks + 1, true);
+	memset (blockstart.Data(), 0, sizeof(int) * (numblocks + 1));
+
+	RasterizeBlockLines (bmapwidth, minx, miny, [&](int block, int line) { blockstart[block + 1]++; });
+	for (int i = 0; i < numblocks; ++i)
+	{
+		blockstart[i + 1] += blockstart[i];
+	}
+
+	TArray<int> blocklines(blockstart[numblocks], true);
+	TArray<int> fillpos(numblocks, true);
+	memcpy (fillpos.Data(), blockstart.Data(), sizeof(int) * numblocks);
+
+	RasterizeBlockLines (bmapwidth, minx, miny, [&](int block, int line) { blocklines[fillpos[block]++] = line; });
+
+	TArray<int> BlockMap (numblocks * 3 + 4);
+
+	adder = minx;			BlockMap.Push (adder);
+	adder = miny;			BlockMap.Push (adder);
+	adder = bmapwidth;		BlockMap.Push (adder);
+	adder = bmapheight;		BlockMap.Push (adder);
+
+	BlockMap.Reserve (numblocks);
+	CreatePackedBlockmap (BlockMap, blocklines, blockstart, bmapwidth, bmapheight);
+
+	level.blockmap.blockmaplump = new int[BlockMap.Size()];
+	memcpy (level.blockmap.blockmaplump, BlockMap.Data(), BlockMap.Size() * sizeof(int));
+	P_SaveCachedBlockMap(map, BlockMap, int(I_msTime() - starttime));
 }
 
 
@@ -2664,13 +2697,14 @@ void P_LoadBlockMap (MapData * map)
 {
 	int count = map->Size(ML_BLOCKMAP);
 
+	level.blockmap.generated = false;
 	if (ForceNodeBuild || genblockmap ||
 		count/2 >= 0x10000 || count == 0 ||
 		Args->CheckParm("-blockmap")
 		)
 	{
 		DPrintf (DMSG_SPAMMY, "Generating BLOCKMAP\n");
-		P_CreateBlockMap ();
+		P_CreateBlockMap (map);
 	}
 	else
 	{
@@ -2700,7 +2734,7 @@ void P_LoadBlockMap (MapData * map)
 		if (!level.blockmap.VerifyBlockMap(count))
 		{
 			DPrintf (DMSG_SPAMMY, "Generating BLOCKMAP\n");
-			P_CreateBlockMap();
+			P_CreateBlockMap(map);
 		}
 
 	}
@@ -2714,6 +2748,8 @@ void P_LoadBlockMap (MapData * map)
 	count = level.blockmap.bmapwidth*level.blockmap.bmapheight;
 	level.blockmap.blocklinks = new FBlockNode *[count];
 	memset (level.blockmap.blocklinks, 0, count*sizeof(*level.blockmap.blocklinks));
+	level.blockmap.blockthings = new TArray<FBlockThing>[count];
+	level.blockmap.dirtyblocks.Clear();
 	level.blockmap.blockmap = level.blockmap.blockmaplump+4;
 }
 
@@ -2727,20 +2763,14 @@ void P_LoadBlockMap (MapData * map)
 
 static void P_GroupLines (bool buildmap)
 {
-	cycle_t times[16];
 	int 				total;
 	sector_t*			sector;
 	FBoundingBox		bbox;
 	bool				flaggedNoFronts = false;
 	unsigned int		jj;
 
-	for (unsigned i = 0; i < countof(times); ++i)
-	{
-		times[i].Reset();
-	}
-
 	// look up sector number for each subsector
-	times[0].Clock();
+	LT_BeginPhase("link subsectors");
 	for (auto &sub : level.subsectors)
 	{
 		sub.sector = sub.firstline->sidedef->sector;
@@ -2752,10 +2782,10 @@ static void P_GroupLines (bool buildmap)
 			sub.firstline[jj].Subsector = &sub;
 		}
 	}
-	times[0].Unclock();
+	LT_EndPhase();
 
 	// count number of lines in each sector
-	times[1].Clock();
+	LT_BeginPhase("count sector lines");
 	total = 0;
 	for (unsigned i = 0; i < level.lines.Size(); i++)
 	{
@@ -2785,10 +2815,10 @@ static void P_GroupLines (bool buildmap)
 	{
 		I_Error ("You need to fix these lines to play this map.\n");
 	}
-	times[1].Unclock();
+	LT_EndPhase();
 
 	// build line tables for each sector
-	times[3].Clock();
+	LT_BeginPhase("build sector line tables");
 	level.linebuffer.Alloc(total);
 	line_t **lineb_p = &level.linebuffer[0];
 	auto numsectors = level.sectors.Size();
@@ -2855,29 +2885,19 @@ static void P_GroupLines (bool buildmap)
 			sector->centerspot = pos / (2 * sector->Lines.Size());
 		}
 	}
-	times[3].Unclock();
+	LT_EndPhase();
 
 	// [RH] Moved this here
-	times[4].Clock();
+	LT_BeginPhase("hash tags");
 	// killough 1/30/98: Create xref tables for tags
 	tagManager.HashTags();
-	times[4].Unclock();
+	LT_EndPhase();
 
-	times[5].Clock();
 	if (!buildmap)
 	{
+		FLoadPhase phase("set slopes");
 		P_SetSlopes ();
 	}
-	times[5].Unclock();
-
-	if (showloadtimes)
-	{
-		Printf ("---Group Lines Times---\n");
-		for (int i = 0; i < 7; ++i)
-		{
-			Printf (" time %d:%9.4f ms\n", i, times[i].TimeMS());
-		}
-	}
 }
 
 //===========================================================================
@@ -2996,6 +3016,31 @@ void P_GetPolySpots (MapData * map, TArray<FNodeBuilder::FPolyStart> &spots, TAr
 }
 
 
+//==========================================================================
+//
+// P_PumpLoadEvents
+//
+// Level setup runs on the main thread, so long loads would otherwise
+// keep the window from processing its messages and some platforms flag
+// the game as not responding. Events posted here are simply queued and
+// handled once the level is running.
+//
+//==========================================================================
+
+void I_GetEvent();	// i_input.h pulls in too much garbage.
+
+void P_PumpLoadEvents()
+{
+	static uint64_t lastpump;
+	uint64_t now = I_msTime();
+
+	if (now - lastpump >= 100)
+	{
+		lastpump = now;
+		I_GetEvent();
+	}
+}
+
 //===========================================================================
 //
 // P_PrecacheLevel
@@ -3134,8 +3179,18 @@ static void P_PrecacheLevel()
 		if (tex.Exists()) AddToList(hitlist, tex, FTextureManager::HIT_Wall);
 	}
 
+	// Inflate the source lumps of all textures in use up front so that the renderer does not do it one by one.
+	TArray<int> lumps;
+	for (i = 0; i < cnt; i++)
+	{
+		FTexture *tex = hitlist[i] ? TexMan.ByIndex(i) : nullptr;
+		if (tex != nullptr && tex->GetSourceLump() >= 0) lumps.Push(tex->GetSourceLump());
+	}
+	Wads.PrefetchLumps(lumps);
+
 	Renderer->Precache(hitlist, actorhitlist);
 
+	Wads.ReleasePrefetchedLumps();
 	delete[] hitlist;
 }
 
@@ -3168,6 +3223,7 @@ void P_FreeLevelData ()
 	FPolyObj::ClearAllSubsectorLinks(); // can't be done as part of the polyobj deletion process.
 	SN_StopAllSequences ();
 	DThinker::DestroyAllThinkers ();
+	P_ReleaseSecnodes();
 	P_ClearPortals();
 	tagManager.Clear();
 	level.total_monsters = level.total_items = level.total_secrets =
@@ -3197,9 +3253,12 @@ void P_FreeLevelData ()
 	level.vertexes.Clear();
 	level.nodes.Clear();
 	level.gamenodes.Reset();
+	level.pointnodes.Clear();
+	level.gamepointnodes.Clear();
 	level.subsectors.Clear();
 	level.gamesubsectors.Reset();
 	level.rejectmatrix.Clear();
+	level.sightgroups.Clear();
 	level.Zones.Clear();
 	level.blockmap.Clear();
 
@@ -3232,6 +3291,30 @@ void P_FreeLevelData ()
 	P_FreeStrifeConversations ();
 	level.Scrolls.Clear();
 	P_ClearUDMFKeys();
+	PlaysimScratch.FreeAllBlocks();
+	M_SetMemoryUsage(MEMTAG_LEVEL, 0);
+}
+
+//===========================================================================
+//
+// P_LevelDataSize
+//
+// Approximate memory held by the level geometry, for memstat.
+//
+//===========================================================================
+
+template<class T> static size_t ArrayBytes(const TArray<T> &arr)
+{
+	return arr.Size() * sizeof(T);
+}
+
+static size_t P_LevelDataSize()
+{
+	return ArrayBytes(level.vertexes) + ArrayBytes(level.sectors) + ArrayBytes(level.linebuffer) +
+		ArrayBytes(level.lines) + ArrayBytes(level.sides) + ArrayBytes(level.segs) +
+		ArrayBytes(level.subsectors) + ArrayBytes(level.nodes) + ArrayBytes(level.gamesubsectors) +
+		ArrayBytes(level.gamenodes) + ArrayBytes(level.rejectmatrix) + ArrayBytes(level.loadsectors) +
+		ArrayBytes(level.loadlines) + ArrayBytes(level.loadsides);
 }
 
 //===========================================================================
@@ -3244,7 +3327,6 @@ void P_FreeLevelData ()
 
 void P_SetupLevel(const char *lumpname, int position, bool newGame)
 {
-	cycle_t times[20];
 #if 0
 	FMapThing *buildthings;
 	int numbuildthings;
@@ -3259,10 +3341,7 @@ void P_SetupLevel(const char *lumpname, int position, bool newGame)
 
 	bool RequireGLNodes = Renderer->RequireGLNodes() || am_textured;
 
-	for (i = 0; i < (int)countof(times); ++i)
-	{
-		times[i].Reset();
-	}
+	LT_BeginLevelLoad(lumpname);
 
 	level.maptype = MAPTYPE_UNKNOWN;
 	wminfo.partime = 180;
@@ -3303,13 +3382,17 @@ void P_SetupLevel(const char *lumpname, int position, bool newGame)
 	C_MidPrint(NULL, NULL);
 
 	// Free all level data from the previous map
+	LT_BeginPhase("free level data");
 	P_FreeLevelData();
+	LT_EndPhase();
 
+	LT_BeginPhase("open map data");
 	MapData *map = P_OpenMapData(lumpname, true);
 	if (map == NULL)
 	{
 		I_Error("Unable to open map '%s'\n", lumpname);
 	}
+	LT_EndPhase();
 
 	// [ZZ] init per-map static handlers. we need to call this before everything is set up because otherwise scripts don't receive PlayerEntered event
 	//      (which happens at god-knows-what stage in this function, but definitely not the last part, because otherwise it'd work to put E_InitStaticHandlers before the player spawning)
@@ -3334,9 +3417,9 @@ void P_SetupLevel(const char *lumpname, int position, bool newGame)
 	{
 		uint8_t *mapdata = new uint8_t[map->Size(0)];
 		map->Read(0, mapdata);
-		times[0].Clock();
+		LT_BeginPhase("load build map");
 		buildmap = P_LoadBuildMap(mapdata, map->Size(0), &buildthings, &numbuildthings);
-		times[0].Unclock();
+		LT_EndPhase();
 		delete[] mapdata;
 	}
 #endif
@@ -3347,6 +3430,7 @@ void P_SetupLevel(const char *lumpname, int position, bool newGame)
 		ForceNodeBuild = gennodes;
 
 		// [RH] Load in the BEHAVIOR lump
+		LT_BeginPhase("load scripts");
 		FBehavior::StaticUnloadModules();
 		if (map->HasBehavior)
 		{
@@ -3410,37 +3494,35 @@ void P_SetupLevel(const char *lumpname, int position, bool newGame)
 
 
 		P_LoadStrifeConversations(map, lumpname);
+		LT_EndPhase();
 
 		FMissingTextureTracker missingtex;
 
 		if (!map->isText)
 		{
-			times[0].Clock();
+			LT_BeginPhase("load vertexes");
 			P_LoadVertexes(map);
-			times[0].Unclock();
+			LT_EndPhase();
 
 			// Check for maps without any BSP data at all (e.g. SLIGE)
-			times[1].Clock();
+			LT_BeginPhase("load sectors");
 			P_LoadSectors(map, missingtex);
-			times[1].Unclock();
+			LT_EndPhase();
 
-			times[2].Clock();
-			times[2].Unclock();
-
-			times[3].Clock();
+			LT_BeginPhase("load lines");
 			if (!map->HasBehavior)
 				P_LoadLineDefs(map);
 			else
 				P_LoadLineDefs2(map);	// [RH] Load Hexen-style linedefs
-			times[3].Unclock();
+			LT_EndPhase();
 
-			times[4].Clock();
+			LT_BeginPhase("load sides");
 			P_LoadSideDefs2(map, missingtex);
-			times[4].Unclock();
+			LT_EndPhase();
 
-			times[5].Clock();
+			LT_BeginPhase("finish lines");
 			P_FinishLoadingLineDefs();
-			times[5].Unclock();
+			LT_EndPhase();
 
 			if (!map->HasBehavior)
 				P_LoadThings(map);
@@ -3449,16 +3531,17 @@ void P_SetupLevel(const char *lumpname, int position, bool newGame)
 		}
 		else
 		{
-			times[0].Clock();
+			LT_BeginPhase("parse UDMF");
 			P_ParseTextMap(map, missingtex);
-			times[0].Unclock();
+			LT_EndPhase();
 		}
+		P_PumpLoadEvents();
 
 		PostProcessLevel(checksum);
 
-		times[6].Clock();
+		LT_BeginPhase("loop sides");
 		P_LoopSidedefs(true);
-		times[6].Unclock();
+		LT_EndPhase();
 
 		linemap.Clear();
 		linemap.ShrinkToFit();
@@ -3521,31 +3604,31 @@ void P_SetupLevel(const char *lumpname, int position, bool newGame)
 			{
 				if (!P_CheckV4Nodes(map))
 				{
-					times[7].Clock();
+					LT_BeginPhase("load subsectors");
 					P_LoadSubsectors<mapsubsector_t, mapseg_t>(map);
-					times[7].Unclock();
+					LT_EndPhase();
 
-					times[8].Clock();
+					LT_BeginPhase("load nodes");
 					if (!ForceNodeBuild) P_LoadNodes<mapnode_t, mapsubsector_t>(map);
-					times[8].Unclock();
+					LT_EndPhase();
 
-					times[9].Clock();
+					LT_BeginPhase("load segs");
 					if (!ForceNodeBuild) P_LoadSegs<mapseg_t>(map);
-					times[9].Unclock();
+					LT_EndPhase();
 				}
 				else
 				{
-					times[7].Clock();
+					LT_BeginPhase("load subsectors");
 					P_LoadSubsectors<mapsubsector4_t, mapseg4_t>(map);
-					times[7].Unclock();
+					LT_EndPhase();
 
-					times[8].Clock();
+					LT_BeginPhase("load nodes");
 					if (!ForceNodeBuild) P_LoadNodes<mapnode4_t, mapsubsector4_t>(map);
-					times[8].Unclock();
+					LT_EndPhase();
 
-					times[9].Clock();
+					LT_BeginPhase("load segs");
 					if (!ForceNodeBuild) P_LoadSegs<mapseg4_t>(map);
-					times[9].Unclock();
+					LT_EndPhase();
 				}
 			}
 			else ForceNodeBuild = true;
@@ -3566,6 +3649,8 @@ void P_SetupLevel(const char *lumpname, int position, bool newGame)
 
 	uint64_t startTime = 0, endTime = 0;
 
+	if (ForceNodeBuild) LT_BeginPhase("build nodes");
+
 	bool BuildGLNodes;
 	if (ForceNodeBuild)
 	{
@@ -3596,6 +3681,7 @@ void P_SetupLevel(const char *lumpname, int position, bool newGame)
 		DPrintf(DMSG_NOTIFY, "BSP generation took %.3f sec (%d segs)\n", (endTime - startTime) * 0.001, level.segs.Size());
 		oldvertextable = builder.GetOldVertexTable();
 		reloop = true;
+		LT_EndPhase();
 	}
 	else
 	{
@@ -3626,6 +3712,7 @@ void P_SetupLevel(const char *lumpname, int position, bool newGame)
 		// If the original nodes being loaded are not GL nodes they will be kept around for
 		// use in P_PointInSubsector to avoid problems with maps that depend on the specific
 		// nodes they were built with (P:AR E1M3 is a good example for a map where this is the case.)
+		FLoadPhase phase("check GL nodes");
 		reloop |= P_CheckNodes(map, BuildGLNodes, (uint32_t)(endTime - startTime));
 		hasglnodes = true;
 	}
@@ -3636,22 +3723,28 @@ void P_SetupLevel(const char *lumpname, int position, bool newGame)
 
 	// set the head node for gameplay purposes. If the separate gamenodes array is not empty, use that, otherwise use the render nodes.
 	level.headgamenode = level.gamenodes.Size() > 0 ? &level.gamenodes[level.gamenodes.Size() - 1] : level.nodes.Size() ? &level.nodes[level.nodes.Size() - 1] : nullptr;
+	level.pointnodes.Build(level.nodes, level.subsectors.Data());
+	if (level.gamenodes.Size() > 0) level.gamepointnodes.Build(level.gamenodes, level.gamesubsectors.Data());
+	else level.gamepointnodes.Build(level.nodes, level.subsectors.Data());
 
-	times[10].Clock();
+	P_PumpLoadEvents();
+
+	LT_BeginPhase("load blockmap");
 	P_LoadBlockMap(map);
-	times[10].Unclock();
+	LT_EndPhase();
 
-	times[11].Clock();
+	LT_BeginPhase("load reject");
 	P_LoadReject(map, buildmap);
-	times[11].Unclock();
+	LT_EndPhase();
 
-	times[12].Clock();
+	LT_BeginPhase("group lines");
 	P_GroupLines(buildmap);
-	times[12].Unclock();
+	LT_EndPhase();
 
-	times[13].Clock();
+	LT_BeginPhase("flood zones");
 	P_FloodZones();
-	times[13].Unclock();
+	LT_EndPhase();
+	P_PumpLoadEvents();
 
 	if (hasglnodes)
 	{
@@ -3668,13 +3761,15 @@ void P_SetupLevel(const char *lumpname, int position, bool newGame)
 	if (!buildmap)
 	{
 		// [RH] Spawn slope creating things first.
+		LT_BeginPhase("spawn slopes and 3D floors");
 		P_SpawnSlopeMakers(&MapThingsConverted[0], &MapThingsConverted[MapThingsConverted.Size()], oldvertextable);
 		P_CopySlopes();
 
 		// Spawn 3d floors - must be done before spawning things so it can't be done in P_SpawnSpecials
 		P_Spawn3DFloors();
+		LT_EndPhase();
 
-		times[14].Clock();
+		LT_BeginPhase("load things");
 		P_SpawnThings(position);
 
 		for (i = 0; i < MAXPLAYERS; ++i)
@@ -3682,12 +3777,13 @@ void P_SetupLevel(const char *lumpname, int position, bool newGame)
 			if (playeringame[i] && players[i].mo != NULL)
 				players[i].health = players[i].mo->health;
 		}
-		times[14].Unclock();
+		LT_EndPhase();
 
-		times[15].Clock();
+		LT_BeginPhase("translate teleports");
 		if (!map->HasBehavior && !map->isText)
 			P_TranslateTeleportThings();	// [RH] Assign teleport destination TIDs
-		times[15].Unclock();
+		LT_EndPhase();
+		P_PumpLoadEvents();
 	}
 #if 0	// There is no such thing as a build map.
 	else
@@ -3706,7 +3802,9 @@ void P_SetupLevel(const char *lumpname, int position, bool newGame)
 	}
 
 	// set up world state
+	LT_BeginPhase("spawn specials");
 	P_SpawnSpecials();
+	LT_EndPhase();
 
 	// disable reflective planes on sloped sectors.
 	for (auto &sec : level.sectors)
@@ -3725,21 +3823,27 @@ void P_SetupLevel(const char *lumpname, int position, bool newGame)
 	P_ClearDynamic3DFloorData();
 
 	// This must be done BEFORE the PolyObj Spawn!!!
+	LT_BeginPhase("renderer preprocessing");
 	Renderer->PreprocessLevel();
+	LT_EndPhase();
+	P_PumpLoadEvents();
 
+	LT_BeginPhase("recalculate 3D floors");
 	for (auto &sec : level.sectors)
 	{
 		P_Recalculate3DFloors(&sec);
 	}
+	LT_EndPhase();
 
 	P_InitHealthGroups();
 
-	times[16].Clock();
+	LT_BeginPhase("init polys");
 	if (reloop) P_LoopSidedefs(false);
 	PO_Init();				// Initialize the polyobjs
 	if (!level.IsReentering())
 		P_FinalizePortals();	// finalize line portals after polyobjects have been initialized. This info is needed for properly flagging them.
-	times[16].Unclock();
+	P_BuildSightGroups();
+	LT_EndPhase();
 
 	assert(sidetemp != NULL);
 	delete[] sidetemp;
@@ -3818,14 +3922,23 @@ void P_SetupLevel(const char *lumpname, int position, bool newGame)
 	// [RH] Remove all particles
 	P_ClearParticles();
 
-	times[17].Clock();
+	// The level geometry is final now, so the renderer can start its own setup in the background.
+	LT_BeginPhase("precache");
+	Renderer->StartBackgroundLevelSetup();
 	// preload graphics and sounds
 	if (precache)
 	{
+		LT_BeginPhase("precache textures");
 		P_PrecacheLevel();
+		LT_EndPhase();
+		LT_BeginPhase("precache sounds");
 		S_PrecacheLevel();
+		LT_EndPhase();
 	}
-	times[17].Unclock();
+	LT_BeginPhase("wait for renderer setup");
+	Renderer->FinishBackgroundLevelSetup();
+	LT_EndPhase();
+	LT_EndPhase();
 
 	if (deathmatch)
 	{
@@ -3852,35 +3965,6 @@ void P_SetupLevel(const char *lumpname, int position, bool newGame)
 	P_ResetSightCounters(true);
 	//Printf ("free memory: 0x%x\n", Z_FreeMemory());
 
-	if (showloadtimes)
-	{
-		Printf("---Total load times---\n");
-		for (i = 0; i < 18; ++i)
-		{
-			static const char *timenames[] =
-			{
-				"load vertexes",
-				"load sectors",
-				"load sides",
-				"load lines",
-				"load sides 2",
-				"load lines 2",
-				"loop sides",
-				"load subsectors",
-				"load nodes",
-				"load segs",
-				"load blockmap",
-				"load reject",
-				"group lines",
-				"flood zones",
-				"load things",
-				"translate teleports",
-				"init polys",
-				"precache"
-			};
-			Printf("Time%3d:%9.4f ms (%s)\n", i, times[i].TimeMS(), timenames[i]);
-		}
-	}
 	MapThingsConverted.Clear();
 	MapThingsUserDataIndex.Clear();
 	MapThingsUserData.Clear();
@@ -3894,6 +3978,9 @@ void P_SetupLevel(const char *lumpname, int position, bool newGame)
 	memcpy(&level.loadlines[0], &level.lines[0], level.lines.Size() * sizeof(level.lines[0]));
 	level.loadsides.Resize(level.sides.Size());
 	memcpy(&level.loadsides[0], &level.sides[0], level.sides.Size() * sizeof(level.sides[0]));
+
+	M_SetMemoryUsage(MEMTAG_LEVEL, P_LevelDataSize());
+	LT_EndLevelLoad();
 }
 
 //
@@ -146,6 +146,7 @@ bool P_CheckMapData(const char * mapname);
 //		On September 1, 1998, I added the position to indicate which set
 //		of single-player start spots should be spawned in the level.
 void P_SetupLevel (const char *mapname, int position, bool newGame);
+void P_PumpLoadEvents();
 
 void P_FreeLevelData();
 
@@ -165,6 +166,8 @@ FString GetUDMFString(int type, int index, FName key);
 
 bool P_LoadGLNodes(MapData * map);
 bool P_CheckNodes(MapData * map, bool rebuilt, int buildtime);
+bool P_LoadCachedBlockMap(MapData *map);
+void P_SaveCachedBlockMap(MapData *map, const TArray<int> &blockmap, int buildtime);
 bool P_CheckForGLNodes();
 void P_SetRenderSector();
 
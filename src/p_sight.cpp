@@ -43,6 +43,7 @@
 #include "stats.h"
 #include "g_levellocals.h"
 #include "actorinlines.h"
+#include "portal.h"
 
 static FRandom pr_botchecksight ("BotCheckSight");
 static FRandom pr_checksight ("CheckSight");
@@ -61,6 +62,45 @@ This uses specialized forms of the maputils routines for optimized performance
 static int sightcounts[6];
 static cycle_t SightCycles;
 static cycle_t MaxSightCycles;
+static int sightcachehits, sightcachemisses;
+
+CVAR(Bool, sv_sightcache, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+//==========================================================================
+//
+// Sight check cache
+//
+// Within one tic the same pairs of actors get checked many times. The
+// result of the path traversal only depends on the actors' positions and
+// heights and the level geometry, so it is remembered until either actor
+// moves or something that can block sight changes (movers, polyobjects,
+// line flags). All entries are dropped at the start of each tic.
+//
+//==========================================================================
+
+struct FSightCacheEntry
+{
+	AActor *t1, *t2;
+	int flags;
+	unsigned epoch;
+	DVector3 pos1, pos2;
+	double height1, height2;
+	bool result;
+};
+
+static FSightCacheEntry SightCache[1024];
+static unsigned SightCacheEpoch = 1;
+
+void P_InvalidateSightCache()
+{
+	SightCacheEpoch++;
+}
+
+static FSightCacheEntry *P_FindSightCacheEntry(AActor *t1, AActor *t2, int flags)
+{
+	size_t hash = (((size_t)t1 >> 3) * 31 + ((size_t)t2 >> 3)) ^ (size_t)flags;
+	return &SightCache[hash % countof(SightCache)];
+}
 
 enum
 {
@@ -827,6 +867,60 @@ sightcounts[2]++;
 	return traverseres;
 }
 
+//==========================================================================
+//
+// P_BuildSightGroups
+//
+// Most maps come with an empty REJECT lump, so as a fallback this
+// collects which sectors are connected through two-sided lines. Sight
+// can never pass between sectors that are not connected this way, no
+// matter how the sectors move later. This is cheap enough to run during
+// level setup. Maps with linked portals are left alone because the sight
+// traverser can cross those.
+//
+//==========================================================================
+
+void P_BuildSightGroups()
+{
+	level.sightgroups.Clear();
+	if (Displacements.size > 1 || level.sectors.Size() == 0 || level.sectors.Size() > 0xffff)
+	{
+		return;
+	}
+
+	TArray<sector_t *> stack;
+	uint16_t numgroups = 0;
+
+	level.sightgroups.Resize(level.sectors.Size());
+	for (auto &g : level.sightgroups) g = 0xffff;
+
+	for (auto &sec : level.sectors)
+	{
+		if (level.sightgroups[sec.Index()] != 0xffff) continue;
+
+		level.sightgroups[sec.Index()] = numgroups;
+		stack.Push(&sec);
+		while (stack.Size() > 0)
+		{
+			sector_t *cur;
+			stack.Pop(cur);
+			for (auto line : cur->Lines)
+			{
+				sector_t *other = line->frontsector == cur ? line->backsector : line->frontsector;
+				if (other != nullptr && level.sightgroups[other->Index()] == 0xffff)
+				{
+					level.sightgroups[other->Index()] = numgroups;
+					stack.Push(other);
+				}
+			}
+		}
+		numgroups++;
+	}
+
+	// Everything is connected so there's nothing to reject.
+	if (numgroups == 1) level.sightgroups.Clear();
+}
+
 /*
 =====================
 =
@@ -865,6 +959,12 @@ sightcounts[0]++;
 		res = false;			// can't possibly be connected
 		goto done;
 	}
+	if (level.sightgroups.Size() > 0 && level.sightgroups[s1->Index()] != level.sightgroups[s2->Index()])
+	{
+sightcounts[0]++;
+		res = false;			// not connected by any two-sided lines
+		goto done;
+	}
 
 //
 // check precisely
@@ -904,6 +1004,21 @@ sightcounts[0]++;
 	// An unobstructed LOS is possible.
 	// Now look from eyes of t1 to any part of t2.
 
+	FSightCacheEntry *cache;
+	cache = nullptr;
+	if (sv_sightcache)
+	{
+		cache = P_FindSightCacheEntry(t1, t2, flags);
+		if (cache->epoch == SightCacheEpoch && cache->t1 == t1 && cache->t2 == t2 && cache->flags == flags &&
+			cache->pos1 == t1->Pos() && cache->pos2 == t2->Pos() && cache->height1 == t1->Height && cache->height2 == t2->Height)
+		{
+			sightcachehits++;
+			res = cache->result;
+			goto done;
+		}
+		sightcachemisses++;
+	}
+
 	validcount++;
 	portals.Clear();
 	{
@@ -934,6 +1049,10 @@ sightcounts[0]++;
 			}
 		}
 	}
+	if (cache != nullptr)
+	{
+		*cache = { t1, t2, flags, SightCacheEpoch, t1->Pos(), t2->Pos(), t1->Height, t2->Height, res };
+	}
 
 done:
 	SightCycles.Unclock();
@@ -943,9 +1062,10 @@ done:
 ADD_STAT (sight)
 {
 	FString out;
-	out.Format ("%04.1f ms (%04.1f max), %5d %2d%4d%4d%4d%4d\n",
+	out.Format ("%04.1f ms (%04.1f max), %5d %2d%4d%4d%4d%4d, cache %d/%d\n",
 		SightCycles.TimeMS(), MaxSightCycles.TimeMS(),
-		sightcounts[3], sightcounts[0], sightcounts[1], sightcounts[2], sightcounts[4], sightcounts[5]);
+		sightcounts[3], sightcounts[0], sightcounts[1], sightcounts[2], sightcounts[4], sightcounts[5],
+		sightcachehits, sightcachehits + sightcachemisses);
 	return out;
 }
 
@@ -961,4 +1081,6 @@ void P_ResetSightCounters (bool full)
 	}
 	SightCycles.Reset();
 	memset (sightcounts, 0, sizeof(sightcounts));
+	sightcachehits = sightcachemisses = 0;
+	P_InvalidateSightCache();
 }
@@ -39,6 +39,7 @@
 class FScanner;
 struct level_info_t;
 struct FDoorAnimation;
+struct FThinkerList;
 
 struct FThinkerCollection
 {
@@ -64,6 +65,7 @@ enum EScrollPos : int
 };
 
 void P_CreateScroller(EScroll type, double dx, double dy, int control, int affectee, int accel, EScrollPos scrollpos = EScrollPos::scw_all);
+int P_TickScrollers(FThinkerList *list);
 
 
 //jff 2/23/98 identify the special classes that can share sectors
@@ -133,6 +135,7 @@ class DLighting : public DSectorEffect
 	DECLARE_CLASS(DLighting, DSectorEffect)
 public:
 	DLighting(sector_t *sector);
+	void *GetTickKey() const override { return m_Sector; }
 protected:
 	DLighting();
 };
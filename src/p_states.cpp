@@ -1066,6 +1066,56 @@ int FStateDefinitions::FinishStates(PClassActor *actor)
 
 
 
+//==========================================================================
+//
+// Zero-tic states without an action that keep the current sprite and frame
+// ("#### # 0") do nothing but pass on to the next state, so SetState can
+// step over an entire run of them at once. This has to be done after
+// Dehacked has been applied because it can still change the states.
+//
+//==========================================================================
+
+static bool IsPassThroughState(const FState *state)
+{
+	return state->Tics == 0 && state->TicRange == 0 && state->ActionFunc == nullptr &&
+		state->sprite == SPR_FIXED && (state->UseFlags & SUF_ACTOR);
+}
+
+void FState::StaticSetupZeroTicChains()
+{
+	for (auto cls : PClassActor::AllActorClasses)
+	{
+		auto info = cls->ActorInfo();
+		for (int i = 0; i < info->NumOwnedStates; i++)
+		{
+			FState *state = &info->OwnedStates[i];
+			state->ZeroTicSkip = nullptr;
+			if (!IsPassThroughState(state))
+			{
+				continue;
+			}
+
+			// A chain that runs in circles hangs the actor either way, so there's
+			// no need to detect those precisely. Just don't try to shorten them.
+			FState *last = state;
+			int length;
+			for (length = 0; length < 1000; length++)
+			{
+				FState *next = last->NextState;
+				if (next == nullptr || next == state || !IsPassThroughState(next))
+				{
+					break;
+				}
+				last = next;
+			}
+			if (length < 1000)
+			{
+				state->ZeroTicSkip = last;
+			}
+		}
+	}
+}
+
 //==========================================================================
 //
 // Prints all state label info to the logfile
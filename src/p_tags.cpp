@@ -34,6 +34,7 @@
 */
 
 
+#include <algorithm>
 #include "p_tags.h"
 #include "c_dispatch.h"
 #include "g_levellocals.h"
@@ -72,8 +73,9 @@ void FTagManager::AddSectorTag(int sector, int tag)
 			}
 		}
 	}
-	FTagItem it = { sector, tag, -1 };
+	FTagItem it = { sector, tag };
 	allTags.Push(it);
+	lookupDirty = hashed;
 }
 
 //-----------------------------------------------------------------------------
@@ -94,6 +96,7 @@ void FTagManager::RemoveSectorTags(int sect)
 				allTags[start].tag = allTags[start].target = -1;
 				start++;
 			}
+			lookupDirty = hashed;
 		}
 	}
 }
@@ -113,9 +116,10 @@ void FTagManager::RemoveLineIDs(int line)
 		{
 			while (allIDs[start].target == line)
 			{
-				allTags[start].tag = allTags[start].target = -1;
+				allIDs[start].tag = allIDs[start].target = -1;
 				start++;
 			}
+			lookupDirty = hashed;
 		}
 	}
 }
@@ -150,8 +154,9 @@ void FTagManager::AddLineID(int line, int tag)
 			}
 		}
 	}
-	FTagItem it = { line, tag, -1 };
+	FTagItem it = { line, tag };
 	allIDs.Push(it);
+	lookupDirty = hashed;
 }
 
 //-----------------------------------------------------------------------------
@@ -163,35 +168,78 @@ void FTagManager::AddLineID(int line, int tag)
 void FTagManager::HashTags()
 {
 	// add an end marker so we do not need to check for the array's size in the other functions.
-	static FTagItem it = { -1, -1, -1 };
+	static FTagItem it = { -1, -1 };
 	allTags.Push(it);
 	allIDs.Push(it);
 
-	// Initially make all slots empty.
-	memset(TagHashFirst, -1, sizeof(TagHashFirst));
-	memset(IDHashFirst, -1, sizeof(IDHashFirst));
+	BuildLookup(allTags, sectorsByTag, sectorTagRanges);
+	BuildLookup(allIDs, linesByTag, lineIDRanges);
+	hashed = true;
+	lookupDirty = false;
+}
+
+//-----------------------------------------------------------------------------
+//
+// Orders all valid targets by tag. Among equal tags the original order
+// is kept, so lower targets still come first, just like with the old
+// hash chains.
+//
+//-----------------------------------------------------------------------------
 
-	// Proceed from last to first so that lower targets appear first
-	for (int i = allTags.Size() - 1; i >= 0; i--)
+void FTagManager::BuildLookup(const TArray<FTagItem> &items, TArray<int> &targets, TMap<int, FTagRange> &ranges)
+{
+	TArray<int> order(items.Size());
+	for (unsigned i = 0; i < items.Size(); i++)
 	{
-		if (allTags[i].target >= 0)	// only link valid entries
-		{
-			int hash = ((unsigned int)allTags[i].tag) % FTagManager::TAG_HASH_SIZE;
-			allTags[i].nexttag = TagHashFirst[hash];
-			TagHashFirst[hash] = i;
-		}
+		if (items[i].target >= 0) order.Push(i);	// only link valid entries
 	}
+	std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return items[a].tag < items[b].tag; });
 
-	for (int i = allIDs.Size() - 1; i >= 0; i--)
+	targets.Resize(order.Size());
+	ranges.Clear();
+	unsigned first = 0;
+	for (unsigned i = 0; i < order.Size(); i++)
 	{
-		if (allIDs[i].target >= 0)	// only link valid entries
+		targets[i] = items[order[i]].target;
+		if (i + 1 == order.Size() || items[order[i + 1]].tag != items[order[i]].tag)
 		{
-			int hash = ((unsigned int)allIDs[i].tag) % FTagManager::TAG_HASH_SIZE;
-			allIDs[i].nexttag = IDHashFirst[hash];
-			IDHashFirst[hash] = i;
+			FTagRange range = { (int)first, int(i + 1 - first) };
+			ranges[items[order[i]].tag] = range;
+			first = i + 1;
 		}
 	}
+}
+
+//-----------------------------------------------------------------------------
+//
+// Tags that get changed after the level was set up only invalidate the
+// lookup tables. They get rebuilt the next time an iterator needs them.
+//
+//-----------------------------------------------------------------------------
+
+void FTagManager::UpdateLookup()
+{
+	if (lookupDirty)
+	{
+		BuildLookup(allTags, sectorsByTag, sectorTagRanges);
+		BuildLookup(allIDs, linesByTag, lineIDRanges);
+		lookupDirty = false;
+	}
+}
 
+void FTagManager::GetRange(TMap<int, FTagRange> &ranges, int tag, int &start, int &end)
+{
+	UpdateLookup();
+	auto range = ranges.CheckKey(tag);
+	if (range == nullptr)
+	{
+		start = end = 0;
+	}
+	else
+	{
+		start = range->first;
+		end = range->first + range->count;
+	}
 }
 
 //-----------------------------------------------------------------------------
@@ -321,6 +369,7 @@ CCMD(dumptags)
 //
 // Find the next sector with a specified tag.
 // Rewritten by Lee Killough to use chained hashing to improve speed
+// and later changed to walk the tag's run in the sorted lookup table.
 //
 //-----------------------------------------------------------------------------
 
@@ -334,10 +383,8 @@ int FSectorTagIterator::Next()
 	}
 	else if (searchtag != 0)
 	{
-		while (start >= 0 && tagManager.allTags[start].tag != searchtag) start = tagManager.allTags[start].nexttag;
-		if (start == -1) return -1;
-		ret = tagManager.allTags[start].target;
-		start = tagManager.allTags[start].nexttag;
+		if (start >= end || start >= (int)tagManager.sectorsByTag.Size()) return -1;
+		ret = tagManager.sectorsByTag[start++];
 	}
 	else
 	{
@@ -379,10 +426,7 @@ int FSectorTagIterator::NextCompat(bool compat, int start)
 
 int FLineIdIterator::Next()
 {
-	while (start >= 0 && tagManager.allIDs[start].tag != searchtag) start = tagManager.allIDs[start].nexttag;
-	if (start == -1) return -1;
-	int ret = tagManager.allIDs[start].target;
-	start = tagManager.allIDs[start].nexttag;
-	return ret;
+	if (start >= end || start >= (int)tagManager.linesByTag.Size()) return -1;
+	return tagManager.linesByTag[start++];
 }
 
@@ -8,7 +8,6 @@ struct FTagItem
 {
 	int target;		// either sector or line
 	int tag;
-	int nexttag;	// for hashing
 };
 
 class FSectorTagIterator;
@@ -16,9 +15,11 @@ class FLineIdIterator;
 
 class FTagManager
 {
-	enum
+	// A run of targets with the same tag in sectorsByTag/linesByTag.
+	struct FTagRange
 	{
-		TAG_HASH_SIZE = 256
+		int first;
+		int count;
 	};
 
 	friend class FSectorTagIterator;
@@ -28,8 +29,19 @@ class FTagManager
 	TArray<FTagItem> allIDs;
 	TArray<int> startForSector;
 	TArray<int> startForLine;
-	int TagHashFirst[TAG_HASH_SIZE];
-	int IDHashFirst[TAG_HASH_SIZE];
+
+	// Lookup tables built by HashTags: all targets ordered by tag so that
+	// the iterators can walk them without any tag comparisons.
+	TArray<int> sectorsByTag;
+	TArray<int> linesByTag;
+	TMap<int, FTagRange> sectorTagRanges;
+	TMap<int, FTagRange> lineIDRanges;
+	bool hashed = false;
+	bool lookupDirty = false;
+
+	static void BuildLookup(const TArray<FTagItem> &items, TArray<int> &targets, TMap<int, FTagRange> &ranges);
+	void UpdateLookup();
+	void GetRange(TMap<int, FTagRange> &ranges, int tag, int &start, int &end);
 
 	bool SectorHasTags(int sect) const
 	{
@@ -48,8 +60,11 @@ public:
 		allIDs.Clear();
 		startForSector.Clear();
 		startForLine.Clear();
-		memset(TagHashFirst, -1, sizeof(TagHashFirst));
-		memset(IDHashFirst, -1, sizeof(IDHashFirst));
+		sectorsByTag.Clear();
+		linesByTag.Clear();
+		sectorTagRanges.Clear();
+		lineIDRanges.Clear();
+		hashed = lookupDirty = false;
 	}
 
 	bool SectorHasTags(const sector_t *sector) const;
@@ -77,6 +92,7 @@ class FSectorTagIterator
 protected:
 	int searchtag;
 	int start;
+	int end;
 
 	FSectorTagIterator()
 	{
@@ -86,7 +102,8 @@ protected:
 	void Init(int tag)
 	{
 		searchtag = tag;
-		start = tag == 0 ? 0 : tagManager.TagHashFirst[((unsigned int)tag) % FTagManager::TAG_HASH_SIZE];
+		if (tag == 0) start = end = 0;
+		else tagManager.GetRange(tagManager.sectorTagRanges, tag, start, end);
 	}
 
 	void Init(int tag, line_t *line)
@@ -95,11 +112,11 @@ protected:
 		{
 			searchtag = INT_MIN;
 			start = (line == NULL || line->backsector == NULL) ? -1 : line->backsector->Index();
+			end = 0;
 		}
 		else
 		{
-			searchtag = tag;
-			start = tagManager.TagHashFirst[((unsigned int)tag) % FTagManager::TAG_HASH_SIZE];
+			Init(tag);
 		}
 	}
 
@@ -124,12 +141,13 @@ class FLineIdIterator
 protected:
 	int searchtag;
 	int start;
+	int end;
 
 public:
 	FLineIdIterator(int id)
 	{
 		searchtag = id;
-		start = tagManager.IDHashFirst[((unsigned int)id) % FTagManager::TAG_HASH_SIZE];
+		tagManager.GetRange(tagManager.lineIDRanges, id, start, end);
 	}
 
 	int Next();
@@ -136,6 +136,8 @@ static void ParseDefault (FScanner &sc);
 FTerrainTypeArray TerrainTypes;
 TArray<FSplashDef> Splashes;
 TArray<FTerrainDef> Terrains;
+bool AnyTerrainFootClip;
+bool AnyTerrainSplash;
 uint16_t DefaultTerrainType;
 
 // PRIVATE DATA DEFINITIONS ------------------------------------------------
@@ -258,6 +260,13 @@ void P_InitTerrainTypes ()
 	}
 	Splashes.ShrinkToFit ();
 	Terrains.ShrinkToFit ();
+
+	AnyTerrainFootClip = AnyTerrainSplash = false;
+	for (auto &terrain : Terrains)
+	{
+		if (terrain.FootClip != 0) AnyTerrainFootClip = true;
+		if (terrain.Splash != -1 || terrain.IsLiquid) AnyTerrainSplash = true;
+	}
 }
 
 //==========================================================================
@@ -123,6 +123,11 @@ struct FTerrainDef
 extern TArray<FSplashDef> Splashes;
 extern TArray<FTerrainDef> Terrains;
 
+// Without any of these the movement code can skip the terrain checks,
+// since no floor could clip feet or make a splash.
+extern bool AnyTerrainFootClip;
+extern bool AnyTerrainSplash;
+
 int P_FindTerrain(FName name);
 FName P_GetTerrainName(int terrainnum);
 
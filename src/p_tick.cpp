@@ -41,6 +41,7 @@
 #include "g_levellocals.h"
 #include "events.h"
 #include "actorinlines.h"
+#include "p_maputl.h"
 
 extern gamestate_t wipegamestate;
 
@@ -77,8 +78,12 @@ bool P_CheckTickerPaused ()
 //
 void P_Ticker (void)
 {
+	PROFILE_ZONE("Playsim");
 	int i;
 
+	// Nothing that was put in the scratch arena may outlive the tic that made it.
+	PlaysimScratch.FreeAll();
+
 	interpolator.UpdateInterpolations ();
 	r_NoInterpolate = true;
 
@@ -158,6 +163,7 @@ void P_Ticker (void)
 	StatusBar->CallTick ();		// [RH] moved this here
 	level.Tick ();			// [RH] let the level tick
 	DThinker::RunThinkers ();
+	level.blockmap.CompactThings ();
 
 	//if added by MC: Freeze mode.
 	if (!level.isFrozen())
@@ -162,7 +162,7 @@ bool Trace(const DVector3 &start, sector_t *sector, const DVector3 &direction, d
 
 	inf.Start = start;
 	GetPortalTransition(inf.Start, sector);
-	inf.ptflags = actorMask ? PT_ADDLINES|PT_ADDTHINGS|PT_COMPATIBLE : PT_ADDLINES;
+	inf.ptflags = (actorMask ? PT_ADDLINES|PT_ADDTHINGS|PT_COMPATIBLE : PT_ADDLINES) | PT_LAZY;
 	inf.Vec = direction;
 	inf.ActorMask = actorMask;
 	inf.WallMask = wallMask;
@@ -186,6 +186,191 @@ void UDMFParserBase::Skip()
 	}
 }
 
+//===========================================================================
+//
+// Skips whitespace and comments in the raw TEXTMAP buffer the same way
+// FScanner does. Returns NULL for anything that needs the full scanner.
+//
+//===========================================================================
+
+static const char *UDMFSkipSpace(const char *p, const char *end, int &line)
+{
+	while (p < end)
+	{
+		if (*p == '\n')
+		{
+			line++;
+			p++;
+		}
+		else if ((uint8_t)*p <= ' ')
+		{
+			p++;
+		}
+		else if (*p == '/' && p + 1 < end && p[1] == '/')
+		{
+			while (p < end && *p != '\n') p++;
+		}
+		else if (*p == '/' && p + 1 < end && p[1] == '*')
+		{
+			for (p += 2; p + 1 < end && (p[0] != '*' || p[1] != '/'); p++)
+			{
+				if (*p == '\n') line++;
+			}
+			if (p + 1 >= end) return NULL;
+			p += 2;
+		}
+		else break;
+	}
+	return p;
+}
+
+static inline bool UDMFIsIdentChar(char c)
+{
+	return isalnum((uint8_t)c) || c == '_';
+}
+
+//===========================================================================
+//
+// Checks for the closing brace of a block without going through
+// FScanner's token path.
+//
+//===========================================================================
+
+bool UDMFParserBase::CheckBlockEnd()
+{
+	const char *end;
+	const char *p = sc.GetRawPos(&end);
+	int line = sc.Line;
+
+	if (p != NULL) p = UDMFSkipSpace(p, end, line);
+	if (p == NULL) return sc.CheckToken('}');
+
+	bool found = p < end && *p == '}';
+	sc.SetRawPos(found ? p + 1 : p, line);
+	return found;
+}
+
+//===========================================================================
+//
+// Lexes the common 'key = value;' forms straight from the lump buffer
+// so that neither the key nor the value has to be copied into the
+// scanner's string buffer first. Anything unusual (escape sequences,
+// hex or suffixed numbers, identifiers as values) returns false without
+// consuming anything so that ParseKey can handle it the regular way and
+// produce the same results and error messages.
+//
+//===========================================================================
+
+bool UDMFParserBase::FastParseKey(FName &key, bool checkblock, bool *isblock)
+{
+	const char *end;
+	const char *p = sc.GetRawPos(&end);
+	int line = sc.Line;
+
+	if (p == NULL || (p = UDMFSkipSpace(p, end, line)) == NULL || p >= end) return false;
+	if (!isalpha((uint8_t)*p) && *p != '_') return false;
+
+	const char *keystart = p;
+	while (p < end && UDMFIsIdentChar(*p)) p++;
+	size_t keylen = p - keystart;
+
+	if ((p = UDMFSkipSpace(p, end, line)) == NULL || p >= end) return false;
+	if (*p == '{')
+	{
+		if (!checkblock) return false;
+		key = FName(keystart, keylen, false);
+		if (isblock) *isblock = true;
+		sc.SetRawPos(p + 1, line);
+		return true;
+	}
+	if (*p != '=') return false;
+	if ((p = UDMFSkipSpace(p + 1, end, line)) == NULL || p >= end) return false;
+
+	int token;
+	int number = 0;
+	double flt = 0;
+	const char *strstart = NULL;
+
+	if (*p == '"')
+	{
+		strstart = ++p;
+		while (p < end && *p != '"')
+		{
+			if (*p == '\\' || *p == '\n') return false;
+			p++;
+		}
+		if (p >= end) return false;
+		token = TK_StringConst;
+	}
+	else if (isdigit((uint8_t)*p) || *p == '.' || *p == '+' || *p == '-')
+	{
+		bool neg = *p == '-';
+		if (*p == '+' || *p == '-') p++;
+
+		const char *numstart = p;
+		bool isfloat = false;
+		int digits = 0;
+		for (; p < end && isdigit((uint8_t)*p); p++) digits++;
+		if (p < end && *p == '.')
+		{
+			isfloat = true;
+			for (p++; p < end && isdigit((uint8_t)*p); p++) digits++;
+		}
+		if (digits == 0) return false;
+		if (p < end && (*p == 'e' || *p == 'E'))
+		{
+			isfloat = true;
+			p++;
+			if (p < end && (*p == '+' || *p == '-')) p++;
+			if (p >= end || !isdigit((uint8_t)*p)) return false;
+			while (p < end && isdigit((uint8_t)*p)) p++;
+		}
+		// Suffixes and hex constants are left to the scanner.
+		if (p < end && (UDMFIsIdentChar(*p) || *p == '.')) return false;
+
+		if (isfloat)
+		{
+			token = TK_FloatConst;
+			flt = strtod(numstart, NULL);
+		}
+		else
+		{
+			token = TK_IntConst;
+			number = (int)strtoll(numstart, NULL, 0);
+			flt = number;
+		}
+		if (neg)
+		{
+			number = -number;
+			flt = -flt;
+		}
+	}
+	else if (!strnicmp(p, "true", 4) && (p + 4 >= end || !UDMFIsIdentChar(p[4])))
+	{
+		token = TK_True;
+		p += 4;
+	}
+	else if (!strnicmp(p, "false", 5) && (p + 5 >= end || !UDMFIsIdentChar(p[5])))
+	{
+		token = TK_False;
+		p += 5;
+	}
+	else return false;
+
+	const char *valueend = p;
+	if (token == TK_StringConst) p++;
+	if ((p = UDMFSkipSpace(p, end, line)) == NULL || p >= end || *p != ';') return false;
+
+	key = FName(keystart, keylen, false);
+	if (checkblock && isblock) *isblock = false;
+	if (strstart != NULL) parsedString = FString(strstart, valueend - strstart);
+	sc.TokenType = token;
+	sc.Number = number;
+	sc.Float = flt;
+	sc.SetRawPos(p + 1, line);
+	return true;
+}
+
 //===========================================================================
 //
 // Parses a 'key = value' line of the map
@@ -194,8 +379,14 @@ void UDMFParserBase::Skip()
 
 FName UDMFParserBase::ParseKey(bool checkblock, bool *isblock)
 {
+	FName key;
+	if (FastParseKey(key, checkblock, isblock))
+	{
+		return key;
+	}
+
 	sc.MustGetString();
-	FName key = sc.String;
+	key = sc.String;
 	if (checkblock)
 	{
 		if (sc.CheckToken('{'))
@@ -506,7 +697,7 @@ public:
 		th->Health = 1;
 		th->FloatbobPhase = -1;
 		sc.MustGetToken('{');
-		while (!sc.CheckToken('}'))
+		while (!CheckBlockEnd())
 		{
 			FName key = ParseKey();
 			switch(key)
@@ -848,7 +1039,7 @@ public:
 		if (level.flags2 & LEVEL2_CHECKSWITCHRANGE) ld->flags |= ML_CHECKSWITCHRANGE;
 
 		sc.MustGetToken('{');
-		while (!sc.CheckToken('}'))
+		while (!CheckBlockEnd())
 		{
 			FName key = ParseKey();
 
@@ -1224,7 +1415,7 @@ public:
 		sd->UDMFIndex = index;
 
 		sc.MustGetToken('{');
-		while (!sc.CheckToken('}'))
+		while (!CheckBlockEnd())
 		{
 			FName key = ParseKey();
 			switch(key)
@@ -1511,7 +1702,7 @@ public:
 		sec->movefactor = ORIG_FRICTION_FACTOR;
 
 		sc.MustGetToken('{');
-		while (!sc.CheckToken('}'))
+		while (!CheckBlockEnd())
 		{
 			FName key = ParseKey();
 			switch(key)
@@ -2035,7 +2226,7 @@ public:
 
 		sc.MustGetToken('{');
 		double x = 0, y = 0;
-		while (!sc.CheckToken('}'))
+		while (!CheckBlockEnd())
 		{
 			FName key = ParseKey();
 			switch (key)
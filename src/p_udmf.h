@@ -14,6 +14,8 @@ protected:
 	bool BadCoordinates = false;
 
 	void Skip();
+	bool CheckBlockEnd();
+	bool FastParseKey(FName &key, bool checkblock, bool *isblock);
 	FName ParseKey(bool checkblock = false, bool *isblock = NULL);
 	int CheckInt(const char *key);
 	double CheckFloat(const char *key);
@@ -94,7 +94,7 @@ class USDFParser : public UDMFParserBase
 		check.Item = NULL;
 		check.Amount = -1;
 
-		while (!sc.CheckToken('}'))
+		while (!CheckBlockEnd())
 		{
 			FName key = ParseKey();
 			switch(key)
@@ -140,7 +140,7 @@ class USDFParser : public UDMFParserBase
 
 
 		reply->NeedsGold = false;
-		while (!sc.CheckToken('}'))
+		while (!CheckBlockEnd())
 		{
 			bool block = false;
 			FName key = ParseKey(true, &block);
@@ -284,7 +284,7 @@ class USDFParser : public UDMFParserBase
 		check.Item = NULL;
 		check.Amount = -1;
 
-		while (!sc.CheckToken('}'))
+		while (!CheckBlockEnd())
 		{
 			FName key = ParseKey();
 			switch(key)
@@ -321,7 +321,7 @@ class USDFParser : public UDMFParserBase
 		FString Dialogue;
 		FString Goodbye;
 
-		while (!sc.CheckToken('}'))
+		while (!CheckBlockEnd())
 		{
 			bool block = false;
 			FName key = ParseKey(true, &block);
@@ -429,7 +429,7 @@ class USDFParser : public UDMFParserBase
 		FName clsid = NAME_None;
 		unsigned int startpos = StrifeDialogues.Size();
 
-		while (!sc.CheckToken('}'))
+		while (!CheckBlockEnd())
 		{
 			bool block = false;
 			FName key = ParseKey(true, &block);
@@ -139,6 +139,9 @@ struct PredictPos
 	DRotator angles;
 } static PredictionLerpFrom, PredictionLerpResult, PredictionLast;
 static int PredictionLerptics;
+static int PredictionGametic = -1;		// gametic and maketic the current prediction was made for
+static int PredictionMaketic;
+static bool PredictionExtendable;		// the predicted state is the unaltered result of the tics run
 
 static player_t PredictionPlayerBackup;
 static AActor *PredictionActor;
@@ -1518,6 +1521,10 @@ void P_PredictPlayer (player_t *player)
 	}
 	act->BlockNode = NULL;
 
+	PredictionGametic = gametic;
+	PredictionMaketic = maxtic;
+	PredictionExtendable = true;
+
 	// Values too small to be usable for lerping can be considered "off".
 	bool CanLerp = (!(cl_predict_lerpscale < 0.01f) && (ticdup == 1)), DoLerp = false, NoInterpolateOld = R_GetViewInterpolationStatus();
 	for (int i = gametic; i < maxtic; ++i)
@@ -1569,6 +1576,7 @@ void P_PredictPlayer (player_t *player)
 			{
 				PredictionLerptics++;
 				player->mo->SetXYZ(PredictionLerpResult.pos);
+				PredictionExtendable = false;
 			}
 			else
 			{
@@ -1578,6 +1586,50 @@ void P_PredictPlayer (player_t *player)
 	}
 }
 
+//==========================================================================
+//
+// P_RepredictPlayer
+//
+// Called when new local tics were buffered, but the game hasn't run any.
+// Since the world is still the same, the current prediction stays valid.
+// It only needs to be continued for the new tics instead of being redone
+// from gametic, unless the lerp has already moved the player.
+//
+//==========================================================================
+
+void P_RepredictPlayer (player_t *player)
+{
+	if ((player->cheats & CF_PREDICTING) && player->mo == PredictionActor && PredictionGametic == gametic)
+	{
+		if (PredictionMaketic == maketic)
+		{
+			return;
+		}
+		if (PredictionExtendable && PredictionMaketic < maketic)
+		{
+			bool CanLerp = (!(cl_predict_lerpscale < 0.01f) && (ticdup == 1)), NoInterpolateOld = R_GetViewInterpolationStatus();
+			for (int i = PredictionMaketic; i < maketic; ++i)
+			{
+				if (!NoInterpolateOld)
+					R_RebuildViewInterpolation(player);
+
+				player->cmd = localcmds[i % LOCALCMDTICS];
+				P_PlayerThink (player);
+				player->mo->Tick ();
+			}
+			PredictionMaketic = maketic;
+			if (CanLerp)
+			{
+				PredictionLast.gametic = maketic - 1;
+				PredictionLast.pos = player->mo->Pos();
+			}
+			return;
+		}
+	}
+	P_UnPredictPlayer();
+	P_PredictPlayer(player);
+}
+
 void P_UnPredictPlayer ()
 {
 	player_t *player = &players[consoleplayer];
@@ -50,7 +50,7 @@ inline void parallel_for(const Index first, const Index last, const Index step,
 	});
 }
 
-#else // Generic loop with optional OpenMP parallelization
+#elif defined _OPENMP
 
 template <typename Index, typename Function>
 inline void parallel_for(const Index first, const Index last, const Index step, const Function& function)
@@ -62,6 +62,29 @@ inline void parallel_for(const Index first, const Index last, const Index step,
 	}
 }
 
+#else // Split the range into one contiguous block per thread of the engine's job system
+
+#include "jobs.h"
+
+template <typename Index, typename Function>
+inline void parallel_for(const Index first, const Index last, const Index step, const Function& function)
+{
+	if (last <= first) return;
+
+	const long long count = ((long long)last - first + step - 1) / step;
+	const unsigned numtasks = (unsigned)(count < Jobs.NumThreads() ? count : Jobs.NumThreads());
+
+	Jobs.RunParallel(numtasks, [&](unsigned task)
+	{
+		const long long begin = count * task / numtasks;
+		const long long end = count * (task + 1) / numtasks;
+		for (long long n = begin; n < end; n++)
+		{
+			function(Index(first + n * step));
+		}
+	});
+}
+
 #endif // HAVE_PARALLEL_FOR
 
 template <typename Index, typename Function>
@@ -146,7 +146,7 @@ static void DoMovePolyobj (FPolyObj *po, const DVector2 & move);
 static void InitSegLists ();
 static void KillSegLists ();
 static FPolyNode *NewPolyNode();
-static void FreePolyNode();
+static void FreePolyNode(FPolyNode *node);
 static void ReleaseAllPolyNodes();
 
 // EXTERNAL DATA DECLARATIONS ----------------------------------------------
@@ -947,7 +947,7 @@ bool FPolyObj::MovePolyobj (const DVector2 &pos, bool force)
 	UnLinkPolyobj ();
 	DoMovePolyobj (pos);
 
-	if (!force)
+	if (!force && MayBeBlocked())
 	{
 		bool blocked = false;
 
@@ -1040,7 +1040,7 @@ bool FPolyObj::RotatePolyobj (DAngle angle, bool fromsave)
 	UpdateBBox();
 
 	// If we are loading a savegame we do not really want to damage actors and be blocked by them. This can also cause crashes when trying to damage incompletely deserialized player pawns.
-	if (!fromsave)
+	if (!fromsave && MayBeBlocked())
 	{
 		for (unsigned i = 0; i < Sidedefs.Size(); i++)
 		{
@@ -1102,6 +1102,61 @@ void FPolyObj::UnLinkPolyobj ()
 	}
 }
 
+//==========================================================================
+//
+// MayBeBlocked
+//
+// Most moves happen with nobody near the polyobject. Before checking each
+// side for blocking actors, look once whether any solid actor overlaps the
+// bounds of all the moved sides at all. Linked portals on the polyobject
+// can shift the actor positions per line, so those always do the full check.
+//
+//==========================================================================
+
+bool FPolyObj::MayBeBlocked () const
+{
+	if (bHasPortals || Sidedefs.Size() == 0)
+		return true;
+
+	FBoundingBox box;
+	box.ClearBox();
+	for (auto sd : Sidedefs)
+	{
+		line_t *ld = sd->linedef;
+		box.AddToBox(DVector2(ld->bbox[BOXLEFT], ld->bbox[BOXBOTTOM]));
+		box.AddToBox(DVector2(ld->bbox[BOXRIGHT], ld->bbox[BOXTOP]));
+	}
+
+	int bmapwidth = level.blockmap.bmapwidth;
+	int bmapheight = level.blockmap.bmapheight;
+	int top = clamp(level.blockmap.GetBlockY(box.Top()), 0, bmapheight - 1);
+	int bottom = clamp(level.blockmap.GetBlockY(box.Bottom()), 0, bmapheight - 1);
+	int left = clamp(level.blockmap.GetBlockX(box.Left()), 0, bmapwidth - 1);
+	int right = clamp(level.blockmap.GetBlockX(box.Right()), 0, bmapwidth - 1);
+	line_t *ld = Sidedefs[0]->linedef;
+
+	for (int j = bottom*bmapwidth; j <= top*bmapwidth; j += bmapwidth)
+	{
+		for (int i = left; i <= right; i++)
+		{
+			for (FBlockNode *block = level.blockmap.blocklinks[j+i]; block != NULL; block = block->NextActor)
+			{
+				AActor *mobj = block->Me;
+				if ((mobj->flags&MF_SOLID) && !(mobj->flags&MF_NOCLIP))
+				{
+					DVector2 pos = mobj->PosRelative(ld);
+					if (pos.X + mobj->radius >= box.Left() && pos.X - mobj->radius <= box.Right() &&
+						pos.Y + mobj->radius >= box.Bottom() && pos.Y - mobj->radius <= box.Top())
+					{
+						return true;
+					}
+				}
+			}
+		}
+	}
+	return false;
+}
+
 //==========================================================================
 //
 // CheckMobjBlocking
@@ -1244,6 +1299,9 @@ void FPolyObj::LinkPolyobj ()
 	int bmapwidth = level.blockmap.bmapwidth;
 	int bmapheight = level.blockmap.bmapheight;
 
+	// The polyobject has moved so any cached line of sight through it is void.
+	P_InvalidateSightCache();
+
 	// calculate the polyobj bbox
 	Bounds.ClearBox();
 	for(unsigned i = 0; i < Sidedefs.Size(); i++)
@@ -1843,8 +1901,9 @@ void FPolyObj::ClearSubsectorLinks()
 			subsectorlinks->subsector->BSP->bDirty = true;
 		}
 
+		// Moving polyobjects are resplit every time they move, so keep the node and its seg storage around.
 		subsectorlinks->state = -1;
-		delete subsectorlinks;
+		FreePolyNode(subsectorlinks);
 		subsectorlinks = next;
 	}
 	subsectorlinks = NULL;
@@ -2221,7 +2280,7 @@ static FPolyNode *NewPolyNode()
 //
 //==========================================================================
 
-void FreePolyNode(FPolyNode *node)
+static void FreePolyNode(FPolyNode *node)
 {
 	node->segs.Clear();
 	node->pnext = FreePolyNodes;
@@ -2243,6 +2302,7 @@ void ReleaseAllPolyNodes()
 		next = node->pnext;
 		delete node;
 	}
+	FreePolyNodes = NULL;
 }
 
 //==========================================================================
@@ -113,6 +113,7 @@ private:
 	void UpdateBBox ();
 	void DoMovePolyobj (const DVector2 &pos);
 	void UnLinkPolyobj ();
+	bool MayBeBlocked () const;
 	bool CheckMobjBlocking (side_t *sd);
 
 };
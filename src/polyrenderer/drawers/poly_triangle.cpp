@@ -137,7 +137,7 @@ void PolyTriangleThreadData::SetTransform(const Mat4f *newObjectToClip, const Ma
 	objectToWorld = newObjectToWorld;
 }
 
-void PolyTriangleThreadData::DrawElements(const PolyDrawArgs &drawargs, const void *vertices, const unsigned int *elements, int vcount, PolyDrawMode drawmode)
+void PolyTriangleThreadData::DrawElements(const PolyDrawArgs &drawargs, const void *vertices, const unsigned int *elements, int vcount, PolyDrawMode drawmode, PolySharedVertices *shared)
 {
 	if (vcount < 3)
 		return;
@@ -155,23 +155,25 @@ void PolyTriangleThreadData::DrawElements(const PolyDrawArgs &drawargs, const vo
 	args.zbuffer = PolyZBuffer::Instance()->Values();
 	args.depthOffset = weaponScene ? 1.0f : 0.0f;
 
+	int vinput = 0;
+
 	ShadedTriVertex vert[3];
 	if (drawmode == PolyDrawMode::Triangles)
 	{
 		for (int i = 0; i < vcount / 3; i++)
 		{
 			for (int j = 0; j < 3; j++)
-				vert[j] = ShadeVertex(drawargs, vertices, *(elements++));
+				vert[j] = FetchVertex(drawargs, vertices, elements, vinput++, shared);
 			DrawShadedTriangle(vert, ccw, &args);
 		}
 	}
 	else if (drawmode == PolyDrawMode::TriangleFan)
 	{
-		vert[0] = ShadeVertex(drawargs, vertices, *(elements++));
-		vert[1] = ShadeVertex(drawargs, vertices, *(elements++));
+		vert[0] = FetchVertex(drawargs, vertices, elements, vinput++, shared);
+		vert[1] = FetchVertex(drawargs, vertices, elements, vinput++, shared);
 		for (int i = 2; i < vcount; i++)
 		{
-			vert[2] = ShadeVertex(drawargs, vertices, *(elements++));
+			vert[2] = FetchVertex(drawargs, vertices, elements, vinput++, shared);
 			DrawShadedTriangle(vert, ccw, &args);
 			vert[1] = vert[2];
 		}
@@ -179,11 +181,11 @@ void PolyTriangleThreadData::DrawElements(const PolyDrawArgs &drawargs, const vo
 	else // TriangleDrawMode::TriangleStrip
 	{
 		bool toggleccw = ccw;
-		vert[0] = ShadeVertex(drawargs, vertices, *(elements++));
-		vert[1] = ShadeVertex(drawargs, vertices, *(elements++));
+		vert[0] = FetchVertex(drawargs, vertices, elements, vinput++, shared);
+		vert[1] = FetchVertex(drawargs, vertices, elements, vinput++, shared);
 		for (int i = 2; i < vcount; i++)
 		{
-			vert[2] = ShadeVertex(drawargs, vertices, *(elements++));
+			vert[2] = FetchVertex(drawargs, vertices, elements, vinput++, shared);
 			DrawShadedTriangle(vert, toggleccw, &args);
 			vert[0] = vert[1];
 			vert[1] = vert[2];
@@ -192,7 +194,7 @@ void PolyTriangleThreadData::DrawElements(const PolyDrawArgs &drawargs, const vo
 	}
 }
 
-void PolyTriangleThreadData::DrawArray(const PolyDrawArgs &drawargs, const void *vertices, int vcount, PolyDrawMode drawmode)
+void PolyTriangleThreadData::DrawArray(const PolyDrawArgs &drawargs, const void *vertices, int vcount, PolyDrawMode drawmode, PolySharedVertices *shared)
 {
 	if (vcount < 3)
 		return;
@@ -218,17 +220,17 @@ void PolyTriangleThreadData::DrawArray(const PolyDrawArgs &drawargs, const void
 		for (int i = 0; i < vcount / 3; i++)
 		{
 			for (int j = 0; j < 3; j++)
-				vert[j] = ShadeVertex(drawargs, vertices, vinput++);
+				vert[j] = FetchVertex(drawargs, vertices, nullptr, vinput++, shared);
 			DrawShadedTriangle(vert, ccw, &args);
 		}
 	}
 	else if (drawmode == PolyDrawMode::TriangleFan)
 	{
-		vert[0] = ShadeVertex(drawargs, vertices, vinput++);
-		vert[1] = ShadeVertex(drawargs, vertices, vinput++);
+		vert[0] = FetchVertex(drawargs, vertices, nullptr, vinput++, shared);
+		vert[1] = FetchVertex(drawargs, vertices, nullptr, vinput++, shared);
 		for (int i = 2; i < vcount; i++)
 		{
-			vert[2] = ShadeVertex(drawargs, vertices, vinput++);
+			vert[2] = FetchVertex(drawargs, vertices, nullptr, vinput++, shared);
 			DrawShadedTriangle(vert, ccw, &args);
 			vert[1] = vert[2];
 		}
@@ -236,11 +238,11 @@ void PolyTriangleThreadData::DrawArray(const PolyDrawArgs &drawargs, const void
 	else // TriangleDrawMode::TriangleStrip
 	{
 		bool toggleccw = ccw;
-		vert[0] = ShadeVertex(drawargs, vertices, vinput++);
-		vert[1] = ShadeVertex(drawargs, vertices, vinput++);
+		vert[0] = FetchVertex(drawargs, vertices, nullptr, vinput++, shared);
+		vert[1] = FetchVertex(drawargs, vertices, nullptr, vinput++, shared);
 		for (int i = 2; i < vcount; i++)
 		{
-			vert[2] = ShadeVertex(drawargs, vertices, vinput++);
+			vert[2] = FetchVertex(drawargs, vertices, nullptr, vinput++, shared);
 			DrawShadedTriangle(vert, toggleccw, &args);
 			vert[0] = vert[1];
 			vert[1] = vert[2];
@@ -249,6 +251,14 @@ void PolyTriangleThreadData::DrawArray(const PolyDrawArgs &drawargs, const void
 	}
 }
 
+ShadedTriVertex PolyTriangleThreadData::FetchVertex(const PolyDrawArgs &drawargs, const void *vertices, const unsigned int *elements, int pos, PolySharedVertices *shared)
+{
+	if (!shared)
+		return ShadeVertex(drawargs, vertices, elements ? elements[pos] : pos);
+
+	return shared->Get(pos, [&](int i) { return ShadeVertex(drawargs, vertices, elements ? elements[i] : i); });
+}
+
 ShadedTriVertex PolyTriangleThreadData::ShadeVertex(const PolyDrawArgs &drawargs, const void *vertices, int index)
 {
 	ShadedTriVertex sv;
@@ -710,10 +720,29 @@ DrawPolyTrianglesCommand::DrawPolyTrianglesCommand(const PolyDrawArgs &args, con
 
 void DrawPolyTrianglesCommand::Execute(DrawerThread *thread)
 {
+	// With several threads on the command, only shade each vertex once instead of once per thread
+	PolySharedVertices *sharedVertices = nullptr;
+	if (thread->num_cores > 1 && count >= 3)
+	{
+		std::call_once(sharedInit, [&]() { shared.Init(count); });
+		sharedVertices = &shared;
+	}
+
 	if (!elements)
-		PolyTriangleThreadData::Get(thread)->DrawArray(args, vertices, count, mode);
+		PolyTriangleThreadData::Get(thread)->DrawArray(args, vertices, count, mode, sharedVertices);
 	else
-		PolyTriangleThreadData::Get(thread)->DrawElements(args, vertices, elements, count, mode);
+		PolyTriangleThreadData::Get(thread)->DrawElements(args, vertices, elements, count, mode, sharedVertices);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void PolySharedVertices::Init(int count)
+{
+	vertices.resize(count);
+	int numChunks = (count + ChunkSize - 1) / ChunkSize;
+	chunkState.reset(new std::atomic<int>[numChunks]);
+	for (int i = 0; i < numChunks; i++)
+		chunkState[i].store(ChunkUnshaded, std::memory_order_relaxed);
 }
 
 /////////////////////////////////////////////////////////////////////////////
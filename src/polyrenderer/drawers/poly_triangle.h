@@ -28,6 +28,8 @@
 #include "polyrenderer/math/gpu_types.h"
 #include "polyrenderer/drawers/poly_buffer.h"
 #include "polyrenderer/drawers/poly_draw_args.h"
+#include <atomic>
+#include <mutex>
 
 class PolyTriangleDrawer
 {
@@ -44,6 +46,45 @@ public:
 	static bool IsBgra();
 };
 
+// Vertices of one draw command, shaded once and shared by all drawer threads.
+// Whichever thread first needs a chunk shades it, the others wait for it or use the result.
+class PolySharedVertices
+{
+public:
+	void Init(int count);
+
+	template<typename ShadeFunc>
+	const ShadedTriVertex &Get(int pos, ShadeFunc shade)
+	{
+		std::atomic<int> &state = chunkState[pos / ChunkSize];
+		if (state.load(std::memory_order_acquire) != ChunkReady)
+		{
+			int expected = ChunkUnshaded;
+			if (state.compare_exchange_strong(expected, ChunkShading))
+			{
+				int start = pos / ChunkSize * ChunkSize;
+				int end = MIN(start + ChunkSize, (int)vertices.size());
+				for (int i = start; i < end; i++)
+					vertices[i] = shade(i);
+				state.store(ChunkReady, std::memory_order_release);
+			}
+			else
+			{
+				while (state.load(std::memory_order_acquire) != ChunkReady)
+					std::this_thread::yield();
+			}
+		}
+		return vertices[pos];
+	}
+
+private:
+	enum { ChunkSize = 96 };
+	enum { ChunkUnshaded, ChunkShading, ChunkReady };
+
+	std::vector<ShadedTriVertex> vertices;
+	std::unique_ptr<std::atomic<int>[]> chunkState;
+};
+
 class PolyTriangleThreadData
 {
 public:
@@ -56,8 +97,8 @@ public:
 	void SetWeaponScene(bool value) { weaponScene = value; }
 	void SetModelVertexShader(int frame1, int frame2, float interpolationFactor) { modelFrame1 = frame1; modelFrame2 = frame2; modelInterpolationFactor = interpolationFactor; }
 
-	void DrawElements(const PolyDrawArgs &args, const void *vertices, const unsigned int *elements, int count, PolyDrawMode mode);
-	void DrawArray(const PolyDrawArgs &args, const void *vertices, int vcount, PolyDrawMode mode);
+	void DrawElements(const PolyDrawArgs &args, const void *vertices, const unsigned int *elements, int count, PolyDrawMode mode, PolySharedVertices *shared = nullptr);
+	void DrawArray(const PolyDrawArgs &args, const void *vertices, int vcount, PolyDrawMode mode, PolySharedVertices *shared = nullptr);
 
 	int32_t core;
 	int32_t num_cores;
@@ -73,6 +114,7 @@ public:
 
 private:
 	ShadedTriVertex ShadeVertex(const PolyDrawArgs &drawargs, const void *vertices, int index);
+	ShadedTriVertex FetchVertex(const PolyDrawArgs &drawargs, const void *vertices, const unsigned int *elements, int pos, PolySharedVertices *shared);
 	void DrawShadedTriangle(const ShadedTriVertex *vertices, bool ccw, TriDrawTriangleArgs *args);
 	static bool IsDegenerate(const ShadedTriVertex *vertices);
 	static bool IsFrontfacing(TriDrawTriangleArgs *args);
@@ -191,6 +233,9 @@ private:
 	const unsigned int *elements;
 	int count;
 	PolyDrawMode mode;
+
+	std::once_flag sharedInit;
+	PolySharedVertices shared;
 };
 
 class DrawRectCommand : public DrawerCommand
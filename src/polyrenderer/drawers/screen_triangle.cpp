@@ -300,8 +300,7 @@ void TriangleBlock::RenderBlock(int x0, int y0, int x1, int y1)
 	bool writeStencil = args->uniforms->WriteStencil();
 	bool writeDepth = args->uniforms->WriteDepth();
 
-	int bmode = (int)args->uniforms->BlendMode();
-	auto drawFunc = args->destBgra ? ScreenTriangle::SpanDrawers32[bmode] : ScreenTriangle::SpanDrawers8[bmode];
+	auto drawFunc = ScreenTriangle::GetSpanDrawer(args);
 
 	// Loop through blocks
 	for (int y = start_miny; y < y1; y += q * num_cores)
@@ -1216,8 +1215,7 @@ void ScreenTriangle::DrawSWRender(const TriDrawTriangleArgs *args, PolyTriangleT
 
 	// Draw the triangle:
 
-	int bmode = (int)args->uniforms->BlendMode();
-	auto drawfunc = args->destBgra ? ScreenTriangle::SpanDrawers32[bmode] : ScreenTriangle::SpanDrawers8[bmode];
+	auto drawfunc = ScreenTriangle::GetSpanDrawer(args);
 
 	float stepXW = args->gradientX.W;
 	float v1X = args->v1->x;
@@ -1867,47 +1865,6 @@ void DrawSpanOpt32(int y, int x0, int x1, const TriDrawTriangleArgs *args)
 	}
 }
 
-template<typename ModeT>
-void DrawSpan32(int y, int x0, int x1, const TriDrawTriangleArgs *args)
-{
-	using namespace TriScreenDrawerModes;
-
-	if (args->uniforms->NumLights() == 0 && args->uniforms->DynLightColor() == 0)
-	{
-		if (!args->uniforms->FixedLight())
-		{
-			if (args->uniforms->SimpleShade())
-				DrawSpanOpt32<ModeT, DrawerOpt>(y, x0, x1, args);
-			else
-				DrawSpanOpt32<ModeT, DrawerOptC>(y, x0, x1, args);
-		}
-		else
-		{
-			if (args->uniforms->SimpleShade())
-				DrawSpanOpt32<ModeT, DrawerOptF>(y, x0, x1, args);
-			else
-				DrawSpanOpt32<ModeT, DrawerOptCF>(y, x0, x1, args);
-		}
-	}
-	else
-	{
-		if (!args->uniforms->FixedLight())
-		{
-			if (args->uniforms->SimpleShade())
-				DrawSpanOpt32<ModeT, DrawerOptL>(y, x0, x1, args);
-			else
-				DrawSpanOpt32<ModeT, DrawerOptLC>(y, x0, x1, args);
-		}
-		else
-		{
-			if (args->uniforms->SimpleShade())
-				DrawSpanOpt32<ModeT, DrawerOptLF>(y, x0, x1, args);
-			else
-				DrawSpanOpt32<ModeT, DrawerOptLCF>(y, x0, x1, args);
-		}
-	}
-}
-
 template<typename ModeT, typename OptT>
 void DrawSpanOpt8(int y, int x0, int x1, const TriDrawTriangleArgs *args)
 {
@@ -2424,27 +2381,6 @@ void DrawSpanOpt8(int y, int x0, int x1, const TriDrawTriangleArgs *args)
 	}
 }
 
-template<typename ModeT>
-void DrawSpan8(int y, int x0, int x1, const TriDrawTriangleArgs *args)
-{
-	using namespace TriScreenDrawerModes;
-
-	if (args->uniforms->NumLights() == 0 && args->uniforms->DynLightColor() == 0)
-	{
-		if (!args->uniforms->FixedLight())
-			DrawSpanOpt8<ModeT, DrawerOptC>(y, x0, x1, args);
-		else
-			DrawSpanOpt8<ModeT, DrawerOptCF>(y, x0, x1, args);
-	}
-	else
-	{
-		if (!args->uniforms->FixedLight())
-			DrawSpanOpt8<ModeT, DrawerOptLC>(y, x0, x1, args);
-		else
-			DrawSpanOpt8<ModeT, DrawerOptLCF>(y, x0, x1, args);
-	}
-}
-
 template<typename ModeT>
 void DrawRect8(const void *destOrg, int destWidth, int destHeight, int destPitch, const RectDrawArgs *args, PolyTriangleThreadData *thread)
 {
@@ -2971,70 +2907,112 @@ void DrawRect32(const void *destOrg, int destWidth, int destHeight, int destPitc
 		DrawRectOpt32<ModeT, DrawerOptCF>(destOrg, destWidth, destHeight, destPitch, args, thread);
 }
 
-void(*ScreenTriangle::SpanDrawers8[])(int, int, int, const TriDrawTriangleArgs *) =
+// Every SWOPT_* combination for a blend mode. The palette drawers always apply colored fog.
+#define SPAN_DRAWERS8(mode) { \
+	&DrawSpanOpt8<mode, TriScreenDrawerModes::DrawerOptN<0 | TriScreenDrawerModes::SWOPT_ColoredFog>>, \
+	&DrawSpanOpt8<mode, TriScreenDrawerModes::DrawerOptN<1 | TriScreenDrawerModes::SWOPT_ColoredFog>>, \
+	&DrawSpanOpt8<mode, TriScreenDrawerModes::DrawerOptN<2 | TriScreenDrawerModes::SWOPT_ColoredFog>>, \
+	&DrawSpanOpt8<mode, TriScreenDrawerModes::DrawerOptN<3 | TriScreenDrawerModes::SWOPT_ColoredFog>>, \
+	&DrawSpanOpt8<mode, TriScreenDrawerModes::DrawerOptN<4 | TriScreenDrawerModes::SWOPT_ColoredFog>>, \
+	&DrawSpanOpt8<mode, TriScreenDrawerModes::DrawerOptN<5 | TriScreenDrawerModes::SWOPT_ColoredFog>>, \
+	&DrawSpanOpt8<mode, TriScreenDrawerModes::DrawerOptN<6 | TriScreenDrawerModes::SWOPT_ColoredFog>>, \
+	&DrawSpanOpt8<mode, TriScreenDrawerModes::DrawerOptN<7 | TriScreenDrawerModes::SWOPT_ColoredFog>> }
+
+#define SPAN_DRAWERS32(mode) { \
+	&DrawSpanOpt32<mode, TriScreenDrawerModes::DrawerOptN<0>>, \
+	&DrawSpanOpt32<mode, TriScreenDrawerModes::DrawerOptN<1>>, \
+	&DrawSpanOpt32<mode, TriScreenDrawerModes::DrawerOptN<2>>, \
+	&DrawSpanOpt32<mode, TriScreenDrawerModes::DrawerOptN<3>>, \
+	&DrawSpanOpt32<mode, TriScreenDrawerModes::DrawerOptN<4>>, \
+	&DrawSpanOpt32<mode, TriScreenDrawerModes::DrawerOptN<5>>, \
+	&DrawSpanOpt32<mode, TriScreenDrawerModes::DrawerOptN<6>>, \
+	&DrawSpanOpt32<mode, TriScreenDrawerModes::DrawerOptN<7>> }
+
+ScreenTriangle::SpanDrawerFunc ScreenTriangle::GetSpanDrawer(const TriDrawTriangleArgs *args)
 {
-	&DrawSpan8<TriScreenDrawerModes::StyleOpaque>,
-	&DrawSpan8<TriScreenDrawerModes::StyleSkycap>,
-	&DrawSpan8<TriScreenDrawerModes::StyleFogBoundary>,
-	&DrawSpan8<TriScreenDrawerModes::StyleSrcColor>,
-	&DrawSpan8<TriScreenDrawerModes::StyleFill>,
-	&DrawSpan8<TriScreenDrawerModes::StyleNormal>,
-	&DrawSpan8<TriScreenDrawerModes::StyleFuzzy>,
-	&DrawSpan8<TriScreenDrawerModes::StyleStencil>,
-	&DrawSpan8<TriScreenDrawerModes::StyleTranslucent>,
-	&DrawSpan8<TriScreenDrawerModes::StyleAdd>,
-	&DrawSpan8<TriScreenDrawerModes::StyleShaded>,
-	&DrawSpan8<TriScreenDrawerModes::StyleTranslucentStencil>,
-	&DrawSpan8<TriScreenDrawerModes::StyleShadow>,
-	&DrawSpan8<TriScreenDrawerModes::StyleSubtract>,
-	&DrawSpan8<TriScreenDrawerModes::StyleAddStencil>,
-	&DrawSpan8<TriScreenDrawerModes::StyleAddShaded>,
-	&DrawSpan8<TriScreenDrawerModes::StyleOpaqueTranslated>,
-	&DrawSpan8<TriScreenDrawerModes::StyleSrcColorTranslated>,
-	&DrawSpan8<TriScreenDrawerModes::StyleNormalTranslated>,
-	&DrawSpan8<TriScreenDrawerModes::StyleStencilTranslated>,
-	&DrawSpan8<TriScreenDrawerModes::StyleTranslucentTranslated>,
-	&DrawSpan8<TriScreenDrawerModes::StyleAddTranslated>,
-	&DrawSpan8<TriScreenDrawerModes::StyleShadedTranslated>,
-	&DrawSpan8<TriScreenDrawerModes::StyleTranslucentStencilTranslated>,
-	&DrawSpan8<TriScreenDrawerModes::StyleShadowTranslated>,
-	&DrawSpan8<TriScreenDrawerModes::StyleSubtractTranslated>,
-	&DrawSpan8<TriScreenDrawerModes::StyleAddStencilTranslated>,
-	&DrawSpan8<TriScreenDrawerModes::StyleAddShadedTranslated>
+	using namespace TriScreenDrawerModes;
+
+	// Resolve the lighting options once per triangle so the span loops never branch on them
+	const PolyDrawArgs *uniforms = args->uniforms;
+	int opt = 0;
+	if (uniforms->NumLights() != 0 || uniforms->DynLightColor() != 0)
+		opt |= SWOPT_DynLights;
+	if (!uniforms->SimpleShade())
+		opt |= SWOPT_ColoredFog;
+	if (uniforms->FixedLight())
+		opt |= SWOPT_FixedLight;
+
+	int bmode = (int)uniforms->BlendMode();
+	return args->destBgra ? SpanDrawers32[bmode][opt] : SpanDrawers8[bmode][opt];
+}
+
+ScreenTriangle::SpanDrawerFunc ScreenTriangle::SpanDrawers8[][8] =
+{
+	SPAN_DRAWERS8(TriScreenDrawerModes::StyleOpaque),
+	SPAN_DRAWERS8(TriScreenDrawerModes::StyleSkycap),
+	SPAN_DRAWERS8(TriScreenDrawerModes::StyleFogBoundary),
+	SPAN_DRAWERS8(TriScreenDrawerModes::StyleSrcColor),
+	SPAN_DRAWERS8(TriScreenDrawerModes::StyleFill),
+	SPAN_DRAWERS8(TriScreenDrawerModes::StyleNormal),
+	SPAN_DRAWERS8(TriScreenDrawerModes::StyleFuzzy),
+	SPAN_DRAWERS8(TriScreenDrawerModes::StyleStencil),
+	SPAN_DRAWERS8(TriScreenDrawerModes::StyleTranslucent),
+	SPAN_DRAWERS8(TriScreenDrawerModes::StyleAdd),
+	SPAN_DRAWERS8(TriScreenDrawerModes::StyleShaded),
+	SPAN_DRAWERS8(TriScreenDrawerModes::StyleTranslucentStencil),
+	SPAN_DRAWERS8(TriScreenDrawerModes::StyleShadow),
+	SPAN_DRAWERS8(TriScreenDrawerModes::StyleSubtract),
+	SPAN_DRAWERS8(TriScreenDrawerModes::StyleAddStencil),
+	SPAN_DRAWERS8(TriScreenDrawerModes::StyleAddShaded),
+	SPAN_DRAWERS8(TriScreenDrawerModes::StyleOpaqueTranslated),
+	SPAN_DRAWERS8(TriScreenDrawerModes::StyleSrcColorTranslated),
+	SPAN_DRAWERS8(TriScreenDrawerModes::StyleNormalTranslated),
+	SPAN_DRAWERS8(TriScreenDrawerModes::StyleStencilTranslated),
+	SPAN_DRAWERS8(TriScreenDrawerModes::StyleTranslucentTranslated),
+	SPAN_DRAWERS8(TriScreenDrawerModes::StyleAddTranslated),
+	SPAN_DRAWERS8(TriScreenDrawerModes::StyleShadedTranslated),
+	SPAN_DRAWERS8(TriScreenDrawerModes::StyleTranslucentStencilTranslated),
+	SPAN_DRAWERS8(TriScreenDrawerModes::StyleShadowTranslated),
+	SPAN_DRAWERS8(TriScreenDrawerModes::StyleSubtractTranslated),
+	SPAN_DRAWERS8(TriScreenDrawerModes::StyleAddStencilTranslated),
+	SPAN_DRAWERS8(TriScreenDrawerModes::StyleAddShadedTranslated)
 };
 
-void(*ScreenTriangle::SpanDrawers32[])(int, int, int, const TriDrawTriangleArgs *) =
+ScreenTriangle::SpanDrawerFunc ScreenTriangle::SpanDrawers32[][8] =
 {
-	&DrawSpan32<TriScreenDrawerModes::StyleOpaque>,
-	&DrawSpan32<TriScreenDrawerModes::StyleSkycap>,
-	&DrawSpan32<TriScreenDrawerModes::StyleFogBoundary>,
-	&DrawSpan32<TriScreenDrawerModes::StyleSrcColor>,
-	&DrawSpan32<TriScreenDrawerModes::StyleFill>,
-	&DrawSpan32<TriScreenDrawerModes::StyleNormal>,
-	&DrawSpan32<TriScreenDrawerModes::StyleFuzzy>,
-	&DrawSpan32<TriScreenDrawerModes::StyleStencil>,
-	&DrawSpan32<TriScreenDrawerModes::StyleTranslucent>,
-	&DrawSpan32<TriScreenDrawerModes::StyleAdd>,
-	&DrawSpan32<TriScreenDrawerModes::StyleShaded>,
-	&DrawSpan32<TriScreenDrawerModes::StyleTranslucentStencil>,
-	&DrawSpan32<TriScreenDrawerModes::StyleShadow>,
-	&DrawSpan32<TriScreenDrawerModes::StyleSubtract>,
-	&DrawSpan32<TriScreenDrawerModes::StyleAddStencil>,
-	&DrawSpan32<TriScreenDrawerModes::StyleAddShaded>,
-	&DrawSpan32<TriScreenDrawerModes::StyleOpaqueTranslated>,
-	&DrawSpan32<TriScreenDrawerModes::StyleSrcColorTranslated>,
-	&DrawSpan32<TriScreenDrawerModes::StyleNormalTranslated>,
-	&DrawSpan32<TriScreenDrawerModes::StyleStencilTranslated>,
-	&DrawSpan32<TriScreenDrawerModes::StyleTranslucentTranslated>,
-	&DrawSpan32<TriScreenDrawerModes::StyleAddTranslated>,
-	&DrawSpan32<TriScreenDrawerModes::StyleShadedTranslated>,
-	&DrawSpan32<TriScreenDrawerModes::StyleTranslucentStencilTranslated>,
-	&DrawSpan32<TriScreenDrawerModes::StyleShadowTranslated>,
-	&DrawSpan32<TriScreenDrawerModes::StyleSubtractTranslated>,
-	&DrawSpan32<TriScreenDrawerModes::StyleAddStencilTranslated>,
-	&DrawSpan32<TriScreenDrawerModes::StyleAddShadedTranslated>
+	SPAN_DRAWERS32(TriScreenDrawerModes::StyleOpaque),
+	SPAN_DRAWERS32(TriScreenDrawerModes::StyleSkycap),
+	SPAN_DRAWERS32(TriScreenDrawerModes::StyleFogBoundary),
+	SPAN_DRAWERS32(TriScreenDrawerModes::StyleSrcColor),
+	SPAN_DRAWERS32(TriScreenDrawerModes::StyleFill),
+	SPAN_DRAWERS32(TriScreenDrawerModes::StyleNormal),
+	SPAN_DRAWERS32(TriScreenDrawerModes::StyleFuzzy),
+	SPAN_DRAWERS32(TriScreenDrawerModes::StyleStencil),
+	SPAN_DRAWERS32(TriScreenDrawerModes::StyleTranslucent),
+	SPAN_DRAWERS32(TriScreenDrawerModes::StyleAdd),
+	SPAN_DRAWERS32(TriScreenDrawerModes::StyleShaded),
+	SPAN_DRAWERS32(TriScreenDrawerModes::StyleTranslucentStencil),
+	SPAN_DRAWERS32(TriScreenDrawerModes::StyleShadow),
+	SPAN_DRAWERS32(TriScreenDrawerModes::StyleSubtract),
+	SPAN_DRAWERS32(TriScreenDrawerModes::StyleAddStencil),
+	SPAN_DRAWERS32(TriScreenDrawerModes::StyleAddShaded),
+	SPAN_DRAWERS32(TriScreenDrawerModes::StyleOpaqueTranslated),
+	SPAN_DRAWERS32(TriScreenDrawerModes::StyleSrcColorTranslated),
+	SPAN_DRAWERS32(TriScreenDrawerModes::StyleNormalTranslated),
+	SPAN_DRAWERS32(TriScreenDrawerModes::StyleStencilTranslated),
+	SPAN_DRAWERS32(TriScreenDrawerModes::StyleTranslucentTranslated),
+	SPAN_DRAWERS32(TriScreenDrawerModes::StyleAddTranslated),
+	SPAN_DRAWERS32(TriScreenDrawerModes::StyleShadedTranslated),
+	SPAN_DRAWERS32(TriScreenDrawerModes::StyleTranslucentStencilTranslated),
+	SPAN_DRAWERS32(TriScreenDrawerModes::StyleShadowTranslated),
+	SPAN_DRAWERS32(TriScreenDrawerModes::StyleSubtractTranslated),
+	SPAN_DRAWERS32(TriScreenDrawerModes::StyleAddStencilTranslated),
+	SPAN_DRAWERS32(TriScreenDrawerModes::StyleAddShadedTranslated)
 };
 
+#undef SPAN_DRAWERS8
+#undef SPAN_DRAWERS32
+
 void(*ScreenTriangle::RectDrawers8[])(const void *, int, int, int, const RectDrawArgs *, PolyTriangleThreadData *) =
 {
 	&DrawRect8<TriScreenDrawerModes::StyleOpaque>,
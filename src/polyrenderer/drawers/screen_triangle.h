@@ -144,8 +144,14 @@ public:
 	static void Draw(const TriDrawTriangleArgs *args, PolyTriangleThreadData *thread);
 	static void DrawSWRender(const TriDrawTriangleArgs *args, PolyTriangleThreadData *thread);
 
-	static void(*SpanDrawers8[])(int y, int x0, int x1, const TriDrawTriangleArgs *args);
-	static void(*SpanDrawers32[])(int y, int x0, int x1, const TriDrawTriangleArgs *args);
+	typedef void(*SpanDrawerFunc)(int y, int x0, int x1, const TriDrawTriangleArgs *args);
+
+	// Picks the fully specialized span drawer for the triangle's blend mode and lighting options
+	static SpanDrawerFunc GetSpanDrawer(const TriDrawTriangleArgs *args);
+
+	// Indexed by [TriBlendMode][SWOPT_* flags]
+	static SpanDrawerFunc SpanDrawers8[][8];
+	static SpanDrawerFunc SpanDrawers32[][8];
 	static void(*RectDrawers8[])(const void *, int, int, int, const RectDrawArgs *, PolyTriangleThreadData *);
 	static void(*RectDrawers32[])(const void *, int, int, int, const RectDrawArgs *, PolyTriangleThreadData *);
 
@@ -209,6 +215,7 @@ namespace TriScreenDrawerModes
 	struct DrawerOptLC { static const int Flags = SWOPT_DynLights | SWOPT_ColoredFog; };
 	struct DrawerOptLF { static const int Flags = SWOPT_DynLights | SWOPT_FixedLight; };
 	struct DrawerOptLCF { static const int Flags = SWOPT_DynLights | SWOPT_ColoredFog | SWOPT_FixedLight; };
+	template<int F> struct DrawerOptN { static const int Flags = F; };
 
 	static const int fuzzcolormap[FUZZTABLE] =
 	{
@@ -73,6 +73,7 @@ void PolyRenderer::RenderView(player_t *player)
 	ActiveRatio(width, height, &trueratio);
 	//viewport->SetViewport(&Thread, width, height, trueratio);
 
+	DrawerThreads::BeginFrameCapture();
 	RenderActorView(player->mo, false);
 
 	// Apply special colormap if the target cannot do it
@@ -86,6 +87,8 @@ void PolyRenderer::RenderView(player_t *player)
 	PolyDrawerWaitCycles.Clock();
 	DrawerThreads::WaitForWorkers();
 	PolyDrawerWaitCycles.Unclock();
+
+	DrawerThreads::ReplayFrameCapture();
 }
 
 void PolyRenderer::RenderViewToCanvas(AActor *actor, DCanvas *canvas, int x, int y, int width, int height, bool dontmaplines)
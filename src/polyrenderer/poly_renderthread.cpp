@@ -38,6 +38,7 @@
 #include "r_data/colormaps.h"
 #include "poly_renderthread.h"
 #include "poly_renderer.h"
+#include "jobs.h"
 #include <mutex>
 
 #ifdef WIN32
@@ -148,6 +149,8 @@ void PolyRenderThreads::RenderThreadSlices(int totalcount, std::function<void(Po
 	int numThreads = std::thread::hardware_concurrency();
 	if (numThreads == 0)
 		numThreads = 2;
+	else if (FJobSystem::Topology().IsHeterogeneous())
+		numThreads = FJobSystem::Topology().NumFastCores;
 
 	if (r_scene_multithreaded == 0 || r_multithreaded == 0)
 		numThreads = 1;
@@ -224,6 +227,7 @@ void PolyRenderThreads::StartThreads(size_t numThreads)
 		int start_run_id = run_id;
 		thread->thread = std::thread([=]()
 		{
+			FJobSystem::PinThread(JOB_Frame);
 			int last_run_id = start_run_id;
 			while (true)
 			{
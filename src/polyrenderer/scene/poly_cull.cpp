@@ -28,8 +28,19 @@
 #include "poly_cull.h"
 #include "polyrenderer/poly_renderer.h"
 
+CVAR(Bool, r_cullcache, true, 0)
+
 void PolyCull::CullScene(sector_t *portalSector, line_t *portalLine)
 {
+	CullKey key = GetCullKey(portalSector, portalLine);
+	if (r_cullcache && ReuseLastCull(key))
+		return;
+
+	LastKey = key;
+	LastCullValid = true;
+	VisibleSolidLines.clear();
+	VisibleOpenLines.clear();
+
 	for (uint32_t sub : PvsSubsectors)
 		SubsectorDepths[sub] = 0xffffffff;
 	SubsectorDepths.resize(level.subsectors.Size(), 0xffffffff);
@@ -84,6 +95,70 @@ void PolyCull::CullScene(sector_t *portalSector, line_t *portalLine)
 		CullNode(level.HeadNode());
 }
 
+PolyCull::CullKey PolyCull::GetCullKey(sector_t *portalSector, line_t *portalLine) const
+{
+	const auto &viewpoint = PolyRenderer::Instance()->Viewpoint;
+	CullKey key;
+	key.Pos = viewpoint.Pos;
+	key.Angles = viewpoint.Angles;
+	key.FieldOfView = viewpoint.FieldOfView;
+	key.WidescreenRatio = PolyRenderer::Instance()->Viewwindow.WidescreenRatio;
+	key.PortalSector = portalSector;
+	key.PortalLine = portalLine;
+	key.Segs = level.segs.Data();
+	key.NumSegs = level.segs.Size();
+	return key;
+}
+
+bool PolyCull::CullKey::operator==(const CullKey &other) const
+{
+	return Pos == other.Pos && Angles.Yaw == other.Angles.Yaw && Angles.Pitch == other.Angles.Pitch && FieldOfView == other.FieldOfView &&
+		WidescreenRatio == other.WidescreenRatio && PortalSector == other.PortalSector && PortalLine == other.PortalLine &&
+		Segs == other.Segs && NumSegs == other.NumSegs;
+}
+
+bool PolyCull::ReuseLastCull(const CullKey &key)
+{
+	if (!LastCullValid || !(key == LastKey))
+		return false;
+
+	// The walk order only depends on the view. What changes between frames is which lines
+	// occlude, and only the lines that were visible last frame took part in clipping.
+	for (seg_t *line : VisibleSolidLines)
+	{
+		if (!IsSolidLine(line))
+			return false;
+	}
+	for (seg_t *line : VisibleOpenLines)
+	{
+		if (IsSolidLine(line))
+			return false;
+	}
+
+	// Floor and ceiling heights may have moved even if nothing opened or closed
+	FirstSkyHeight = true;
+	MaxCeilingHeight = 0.0;
+	MinFloorHeight = 0.0;
+	for (uint32_t sub : PvsSubsectors)
+		UpdateSkyHeights(level.subsectors[sub].sector);
+	return true;
+}
+
+void PolyCull::UpdateSkyHeights(sector_t *sector)
+{
+	if (!FirstSkyHeight)
+	{
+		MaxCeilingHeight = MAX(MaxCeilingHeight, sector->ceilingplane.Zat0());
+		MinFloorHeight = MIN(MinFloorHeight, sector->floorplane.Zat0());
+	}
+	else
+	{
+		MaxCeilingHeight = sector->ceilingplane.Zat0();
+		MinFloorHeight = sector->floorplane.Zat0();
+		FirstSkyHeight = false;
+	}
+}
+
 void PolyCull::CullNode(void *node)
 {
 	while (!((size_t)node & 1))  // Keep going until found a subsector
@@ -120,17 +195,7 @@ void PolyCull::CullSubsector(subsector_t *sub)
 	}
 
 	// Update sky heights for the scene
-	if (!FirstSkyHeight)
-	{
-		MaxCeilingHeight = MAX(MaxCeilingHeight, sub->sector->ceilingplane.Zat0());
-		MinFloorHeight = MIN(MinFloorHeight, sub->sector->floorplane.Zat0());
-	}
-	else
-	{
-		MaxCeilingHeight = sub->sector->ceilingplane.Zat0();
-		MinFloorHeight = sub->sector->floorplane.Zat0();
-		FirstSkyHeight = false;
-	}
+	UpdateSkyHeights(sub->sector);
 
 	uint32_t subsectorDepth = (uint32_t)PvsSubsectors.size();
 
@@ -164,9 +229,17 @@ void PolyCull::CullSubsector(subsector_t *sub)
 		angle_t angle2 = PointToPseudoAngle(line->v1->fX(), line->v1->fY());
 		angle_t angle1 = PointToPseudoAngle(line->v2->fX(), line->v2->fY());
 		bool lineVisible = !IsSegmentCulled(angle1, angle2);
-		if (lineVisible && IsSolidLine(line))
+		if (lineVisible)
 		{
-			MarkSegmentCulled(angle1, angle2);
+			if (IsSolidLine(line))
+			{
+				MarkSegmentCulled(angle1, angle2);
+				VisibleSolidLines.push_back(line);
+			}
+			else
+			{
+				VisibleOpenLines.push_back(line);
+			}
 		}
 
 		// Mark if this line was visible
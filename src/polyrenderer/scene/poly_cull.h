@@ -53,6 +53,26 @@ private:
 		angle_t Start, End;
 	};
 
+	// Last frame's culling inputs. If they match and no visible line changed
+	// its occluding state, the front to back walk would produce the same result.
+	struct CullKey
+	{
+		DVector3 Pos;
+		DRotator Angles;
+		DAngle FieldOfView;
+		float WidescreenRatio = 0.0f;
+		sector_t *PortalSector = nullptr;
+		line_t *PortalLine = nullptr;
+		seg_t *Segs = nullptr;
+		unsigned int NumSegs = 0;
+
+		bool operator==(const CullKey &other) const;
+	};
+
+	CullKey GetCullKey(sector_t *portalSector, line_t *portalLine) const;
+	bool ReuseLastCull(const CullKey &key);
+	void UpdateSkyHeights(sector_t *sector);
+
 	void MarkViewFrustum();
 	void InvertSegments();
 
@@ -82,5 +102,10 @@ private:
 	std::vector<bool> PvsLineVisible;
 	uint32_t NextPvsLineStart = 0;
 
+	CullKey LastKey;
+	bool LastCullValid = false;
+	std::vector<seg_t *> VisibleSolidLines;
+	std::vector<seg_t *> VisibleOpenLines;
+
 	static angle_t AngleToPseudo(angle_t ang);
 };
@@ -77,7 +77,7 @@ void RenderPolyScene::Render(PolyPortalViewpoint *viewpoint)
 			{
 				int spritenum = thing->sprite;
 				bool isPicnumOverride = thing->picnum.isValid();
-				FSpriteModelFrame *modelframe = isPicnumOverride ? nullptr : FindModelFrame(thing->GetClass(), spritenum, thing->frame, !!(thing->flags & MF_DROPPED));
+				FSpriteModelFrame *modelframe = isPicnumOverride ? nullptr : FindModelFrame(thing->GetClass(), thing->state, spritenum, thing->frame, !!(thing->flags & MF_DROPPED));
 				double distanceSquared = (thing->Pos() - rviewpoint.Pos).LengthSquared();
 				if (r_modelscene && modelframe && distanceSquared < model_distance_cull)
 				{
@@ -78,7 +78,7 @@ void RenderPolySprite::Render(PolyRenderThread *thread, AActor *thing, subsector
 		const auto &viewpoint = PolyRenderer::Instance()->Viewpoint;
 		int spritenum = thing->sprite;
 		bool isPicnumOverride = thing->picnum.isValid();
-		FSpriteModelFrame *modelframe = isPicnumOverride ? nullptr : FindModelFrame(thing->GetClass(), spritenum, thing->frame, !!(thing->flags & MF_DROPPED));
+		FSpriteModelFrame *modelframe = isPicnumOverride ? nullptr : FindModelFrame(thing->GetClass(), thing->state, spritenum, thing->frame, !!(thing->flags & MF_DROPPED));
 		if (modelframe && (thing->Pos() - viewpoint.Pos).LengthSquared() < model_distance_cull)
 		{
 			DVector3 pos = thing->InterpolatedPosition(viewpoint.TicFrac);
@@ -44,11 +44,19 @@ double PerfToSec, PerfToMillisec;
 
 void CalculateCPUSpeed()
 {
+#ifdef __aarch64__
+	uint64_t frequency;
+	asm volatile ("mrs %0, cntfrq_el0" : "=r" (frequency));
+
+	if (0 != frequency)
+	{
+#else
 	long long frequency;
 	size_t size = sizeof frequency;
 
 	if (0 == sysctlbyname("machdep.tsc.frequency", &frequency, &size, nullptr, 0) && 0 != frequency)
 	{
+#endif
 		PerfToSec = 1.0 / frequency;
 		PerfToMillisec = 1000.0 / frequency;
 
@@ -240,6 +240,7 @@ void I_ClosestResolution (int *width, int *height, int bits)
 //==========================================================================
 
 EXTERN_CVAR(Int, vid_maxfps);
+EXTERN_CVAR(Bool, vid_lowlatency);
 EXTERN_CVAR(Bool, cl_capfps);
 
 #if !defined(__APPLE__) && !defined(__OpenBSD__)
@@ -270,7 +271,8 @@ void I_SetFPSLimit(int limit)
 
 	if (limit < 0)
 	{
-		limit = vid_maxfps;
+		// With vid_lowlatency the main loop does the waiting itself.
+		limit = vid_lowlatency ? 0 : *vid_maxfps;
 	}
 	// Kill any leftover timer.
 	if (FPSLimitTimerEnabled)
@@ -314,7 +316,7 @@ CUSTOM_CVAR (Int, vid_maxfps, 200, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
 	}
 	else if (cl_capfps == 0)
 	{
-		I_SetFPSLimit(vid_maxfps);
+		I_SetFPSLimit(-1);
 	}
 }
 
@@ -29,6 +29,7 @@
 #include "i_system.h"
 #include "version.h"
 #include "x86.h"
+#include "stats.h"
 
 
 #ifndef NO_GTK
@@ -100,6 +101,47 @@ void I_ShowFatalError(const char *message)
 
 void CalculateCPUSpeed()
 {
+#if defined __aarch64__
+	// The generic timer knows its own frequency.
+	uint64_t frequency;
+	asm volatile ("mrs %0, cntfrq_el0" : "=r" (frequency));
+
+	if (frequency != 0)
+	{
+		PerfToSec = 1.0 / frequency;
+		PerfToMillisec = 1000.0 / frequency;
+
+		if (!batchrun)
+		{
+			Printf("Cycle counter: %.0f MHz\n", frequency * 1e-6);
+		}
+	}
+#elif (defined __i386__ || defined __amd64__) && !defined NO_CLOCK_GETTIME
+	// Count TSC ticks against the monotonic clock for 20 ms.
+	timespec start, now;
+	double elapsed;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	uint64_t startcycles = rdtsc();
+	do
+	{
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		elapsed = (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) * 1e-9;
+	}
+	while (elapsed < 0.02);
+	double frequency = (rdtsc() - startcycles) / elapsed;
+
+	if (frequency > 0)
+	{
+		PerfToSec = 1.0 / frequency;
+		PerfToMillisec = 1000.0 / frequency;
+
+		if (!batchrun)
+		{
+			Printf("CPU speed: %.0f MHz\n", 0.001 / PerfToMillisec);
+		}
+	}
+#endif
 }
 
 void I_DebugPrint(const char *cp)
@@ -78,6 +78,7 @@ EXTERN_CVAR (Int, vid_adapter)
 EXTERN_CVAR (Int, vid_displaybits)
 EXTERN_CVAR (Int, vid_renderer)
 EXTERN_CVAR (Int, vid_maxfps)
+EXTERN_CVAR (Bool, vid_lowlatency)
 EXTERN_CVAR (Bool, cl_capfps)
 
 DFrameBuffer *CreateGLSWFrameBuffer(int width, int height, bool bgra, bool fullscreen);
@@ -115,6 +116,10 @@ CUSTOM_CVAR(Bool, gl_es, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG | CVAR_NOINITCA
 SDLGLVideo::SDLGLVideo (int parm)
 {
 	IteratorBits = 0;
+
+	extern void gl_CalculateCPUSpeed();
+	gl_CalculateCPUSpeed();
+
     if( SDL_Init( SDL_INIT_VIDEO ) < 0 ) {
         fprintf( stderr, "Video initialization failed: %s\n",
              SDL_GetError( ) );
@@ -486,7 +491,7 @@ void SDLGLFB::NewRefreshRate ()
 void SDLGLFB::SwapBuffers()
 {
 #if !defined(__APPLE__) && !defined(__OpenBSD__)
-	if (vid_maxfps && !cl_capfps)
+	if (vid_maxfps && !cl_capfps && !vid_lowlatency)
 	{
 		SEMAPHORE_WAIT(FPSLimitSemaphore)
 	}
@@ -72,6 +72,7 @@ extern bool GUICapture;
 
 EXTERN_CVAR (Float, Gamma)
 EXTERN_CVAR (Int, vid_maxfps)
+EXTERN_CVAR (Bool, vid_lowlatency)
 EXTERN_CVAR (Bool, cl_capfps)
 EXTERN_CVAR (Bool, vid_vsync)
 
@@ -155,6 +156,7 @@ SDLFB::SDLFB (int width, int height, bool bgra, bool fullscreen, SDL_Window *old
 	{
 		GammaTable[0][i] = GammaTable[1][i] = GammaTable[2][i] = i;
 	}
+	GammaIsIdentity = true;
 
 	memcpy (SourcePalette, GPalette.BaseColors, sizeof(PalEntry)*256);
 	UpdateColors ();
@@ -228,7 +230,7 @@ void SDLFB::Update ()
 	DrawRateStuff ();
 
 #if !defined(__APPLE__) && !defined(__OpenBSD__)
-	if(vid_maxfps && !cl_capfps)
+	if(vid_maxfps && !cl_capfps && !vid_lowlatency)
 	{
 		SEMAPHORE_WAIT(FPSLimitSemaphore)
 	}
@@ -258,7 +260,16 @@ void SDLFB::Update ()
 		pitch = Surface->pitch;
 	}
 
-	if (Bgra)
+	if (Bgra && UsingRenderer && GammaIsIdentity && FlashAmount == 0)
+	{
+		// The canvas already has the texture's layout, and the texture doesn't
+		// blend, so the alpha bytes don't need to be set either.
+		for (int y = 0; y < Height; ++y)
+		{
+			memcpy ((uint8_t *)pixels+y*pitch, MemBuffer+y*Pitch*4, Width*4);
+		}
+	}
+	else if (Bgra)
 	{
 		CopyWithGammaBgra(pixels, pitch, GammaTable[0], GammaTable[1], GammaTable[2], Flash, FlashAmount);
 	}
@@ -311,6 +322,15 @@ void SDLFB::Update ()
 		CalcGamma ((Windowed || rgamma == 0.f) ? Gamma : (Gamma * rgamma), GammaTable[0]);
 		CalcGamma ((Windowed || ggamma == 0.f) ? Gamma : (Gamma * ggamma), GammaTable[1]);
 		CalcGamma ((Windowed || bgamma == 0.f) ? Gamma : (Gamma * bgamma), GammaTable[2]);
+		GammaIsIdentity = true;
+		for (int i = 0; i < 256; ++i)
+		{
+			if (GammaTable[0][i] != i || GammaTable[1][i] != i || GammaTable[2][i] != i)
+			{
+				GammaIsIdentity = false;
+				break;
+			}
+		}
 		NeedPalUpdate = true;
 	}
 	
@@ -458,6 +478,7 @@ void SDLFB::ResetSDLRenderer ()
 			}
 		}
 		Texture = SDL_CreateTexture (Renderer, fmt, SDL_TEXTUREACCESS_STREAMING, Width, Height);
+		SDL_SetTextureBlendMode (Texture, SDL_BLENDMODE_NONE);
 
 		{
 			NotPaletted = true;
@@ -35,6 +35,7 @@ public:
 private:
 	PalEntry SourcePalette[256];
 	uint8_t GammaTable[3][256];
+	bool GammaIsIdentity;
 	PalEntry Flash;
 	int FlashAmount;
 	float Gamma;
@@ -71,13 +71,13 @@ struct FColormap
 		LightColor.Decolorize();
 	}
 
-	bool operator == (const FColormap &other)
+	bool operator == (const FColormap &other) const
 	{
 		return LightColor == other.LightColor && FadeColor == other.FadeColor && Desaturation == other.Desaturation &&
 			BlendFactor == other.BlendFactor && FogDensity == other.FogDensity;
 	}
 
-	bool operator != (const FColormap &other)
+	bool operator != (const FColormap &other) const
 	{
 		return !operator==(other);
 	}
@@ -263,7 +263,7 @@ void FModelRenderer::RenderFrameModels(const FSpriteModelFrame *smf, const FStat
 					}
 				}
 				if (nextState && inter != 0.0)
-					smfNext = FindModelFrame(ti, nextState->sprite, nextState->Frame, false);
+					smfNext = FindModelFrame(ti, nextState, nextState->sprite, nextState->Frame, false);
 			}
 		}
 	}
@@ -556,6 +556,20 @@ void InitModels()
 		SpriteModelFrames[i].hashnext = SpriteModelHash[j];
 		SpriteModelHash[j]=i;
 	}
+
+	// Most actors show their state's own sprite and frame, so remember the model for
+	// those directly in the state to spare the renderers the hash lookup.
+	for (auto cls : PClassActor::AllActorClasses)
+	{
+		auto info = cls->ActorInfo();
+		bool hasmodel = GetDefaultByType(cls)->hasmodel;
+		for (int i = 0; i < info->NumOwnedStates; i++)
+		{
+			FState *state = &info->OwnedStates[i];
+			FSpriteModelFrame *smf = hasmodel ? FindModelFrame(cls, state->sprite, state->Frame, false) : nullptr;
+			state->ModelFrame = smf != nullptr && smf->type == cls ? smf : nullptr;
+		}
+	}
 }
 
 static void ParseModelDefLump(int Lump)
@@ -921,6 +935,22 @@ FSpriteModelFrame * FindModelFrame(const PClass * ti, int sprite, int frame, boo
 	return nullptr;
 }
 
+// Same as above, but checks the model cached in the given state first.
+// The state may belong to a parent class or the sprite and frame may have
+// been overridden, so the cached frame still has to match the request.
+FSpriteModelFrame * FindModelFrame(const PClass * ti, const FState * state, int sprite, int frame, bool dropped)
+{
+	if (state != nullptr)
+	{
+		FSpriteModelFrame *smf = state->ModelFrame;
+		if (smf != nullptr && smf->type == ti && smf->sprite == sprite && smf->frame == frame)
+		{
+			return smf;
+		}
+	}
+	return FindModelFrame(ti, sprite, frame, dropped);
+}
+
 //===========================================================================
 //
 // IsHUDModelForPlayerAvailable
@@ -384,6 +384,7 @@ struct FIndexInit
 };
 
 typedef TMap<FModelVertex, unsigned int, FVoxelVertexHash, FIndexInit> FVoxelMap;
+struct FVoxelFace;
 
 
 class FVoxelModel : public FModel
@@ -396,7 +397,8 @@ protected:
 	TArray<FModelVertex> mVertices;
 	TArray<unsigned int> mIndices;
 	
-	void MakeSlabPolys(int x, int y, kvxslab_t *voxptr, FVoxelMap &check);
+	void MakeSlabPolys(int x, int y, kvxslab_t *voxptr, TArray<FVoxelFace> &faces);
+	void MergeFaces(TArray<FVoxelFace> &faces, FVoxelMap &check);
 	void AddFace(int x1, int y1, int z1, int x2, int y2, int z2, int x3, int y3, int z3, int x4, int y4, int z4, uint8_t color, FVoxelMap &check);
 	unsigned int AddVertex(FModelVertex &vert, FVoxelMap &check);
 
@@ -463,6 +465,7 @@ struct FSpriteModelFrame
 };
 
 FSpriteModelFrame * FindModelFrame(const PClass * ti, int sprite, int frame, bool dropped);
+FSpriteModelFrame * FindModelFrame(const PClass * ti, const FState * state, int sprite, int frame, bool dropped);
 bool IsHUDModelForPlayerAvailable(player_t * player);
 void FlushModels();
 
@@ -39,6 +39,7 @@
 #include "g_levellocals.h"
 #include "models.h"
 #include "v_palette.h"
+#include <algorithm>
 
 #ifdef _MSC_VER
 #pragma warning(disable:4244) // warning C4244: conversion from 'double' to 'float', possible loss of data
@@ -246,13 +247,29 @@ void FVoxelModel::AddFace(int x1, int y1, int z1, int x2, int y2, int z2, int x3
 	mIndices.Push(indx[3]);
 }
 
+//===========================================================================
+//
+// One visible voxel face. Faces of one direction that lie in the same
+// plane are merged into larger quads by MergeFaces.
+// dir is the slab's backface cull bit for the face: 1, 2 face along x,
+// 4, 8 along y and 16, 32 along z. u and v are the face's position in its
+// plane, in this order from x, y and z.
+//
+//===========================================================================
+
+struct FVoxelFace
+{
+	uint16_t dir, plane, u, v;
+	uint8_t color;
+};
+
 //===========================================================================
 //
 // 
 //
 //===========================================================================
 
-void FVoxelModel::MakeSlabPolys(int x, int y, kvxslab_t *voxptr, FVoxelMap &check)
+void FVoxelModel::MakeSlabPolys(int x, int y, kvxslab_t *voxptr, TArray<FVoxelFace> &faces)
 {
 	const uint8_t *col = voxptr->col;
 	int zleng = voxptr->zleng;
@@ -261,37 +278,101 @@ void FVoxelModel::MakeSlabPolys(int x, int y, kvxslab_t *voxptr, FVoxelMap &chec
 
 	if (cull & 16)
 	{
-		AddFace(x, y, ztop, x+1, y, ztop, x, y+1, ztop, x+1, y+1, ztop, *col, check);
+		faces.Push({ 16, (uint16_t)ztop, (uint16_t)x, (uint16_t)y, col[0] });
 	}
-	int z = ztop;
-	while (z < ztop+zleng)
+	for (int z = ztop; z < ztop + zleng; z++, col++)
+	{
+		if (cull & 1) faces.Push({ 1, (uint16_t)x, (uint16_t)y, (uint16_t)z, *col });
+		if (cull & 2) faces.Push({ 2, (uint16_t)(x + 1), (uint16_t)y, (uint16_t)z, *col });
+		if (cull & 4) faces.Push({ 4, (uint16_t)y, (uint16_t)x, (uint16_t)z, *col });
+		if (cull & 8) faces.Push({ 8, (uint16_t)(y + 1), (uint16_t)x, (uint16_t)z, *col });
+	}
+	if (cull & 32)
+	{
+		faces.Push({ 32, (uint16_t)(ztop + zleng), (uint16_t)x, (uint16_t)y, voxptr->col[zleng - 1] });
+	}
+}
+
+//===========================================================================
+//
+// Greedy meshing: in every plane, runs of faces with the same color are
+// joined into rectangles, first along u, then along v. Without
+// gl_voxel_mergefaces only runs along the sides' z axis are joined, which
+// is what the original one quad per face mesh did.
+//
+//===========================================================================
+
+CVAR(Bool, gl_voxel_mergefaces, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+void FVoxelModel::MergeFaces(TArray<FVoxelFace> &faces, FVoxelMap &check)
+{
+	std::sort(faces.begin(), faces.end(), [](const FVoxelFace &a, const FVoxelFace &b)
 	{
-		int c = 0;
-		while (z+c < ztop+zleng && col[c] == col[0]) c++;
+		return a.dir != b.dir ? a.dir < b.dir : a.plane < b.plane;
+	});
 
-		if (cull & 1)
+	const bool mergeu = gl_voxel_mergefaces;
+	TArray<int16_t> grid;
+	for (unsigned first = 0, last; first < faces.Size(); first = last)
+	{
+		const int dir = faces[first].dir, plane = faces[first].plane;
+		int umin = INT_MAX, umax = INT_MIN, vmin = INT_MAX, vmax = INT_MIN;
+		for (last = first; last < faces.Size() && faces[last].dir == dir && faces[last].plane == plane; last++)
 		{
-			AddFace(x, y, z, x, y+1, z, x, y, z+c, x, y+1, z+c, *col, check);
+			umin = MIN<int>(umin, faces[last].u);
+			umax = MAX<int>(umax, faces[last].u);
+			vmin = MIN<int>(vmin, faces[last].v);
+			vmax = MAX<int>(vmax, faces[last].v);
 		}
-		if (cull & 2)
+		const int w = umax - umin + 1, h = vmax - vmin + 1;
+		grid.Resize(w * h);
+		for (auto &cell : grid) cell = -1;
+		for (unsigned i = first; i < last; i++)
 		{
-			AddFace(x+1, y+1, z, x+1, y, z, x+1, y+1, z+c, x+1, y, z+c, *col, check);
+			grid[(faces[i].v - vmin) * w + faces[i].u - umin] = faces[i].color;
 		}
-		if (cull & 4)
+		const bool mergev = mergeu || dir < 16;
+
+		for (int v = 0; v < h; v++)
 		{
-			AddFace(x+1, y, z, x, y, z, x+1, y, z+c, x, y, z+c, *col, check);
+			for (int u = 0; u < w; u++)
+			{
+				const int c = grid[v * w + u];
+				if (c < 0) continue;
+
+				int width = 1, height = 1;
+				while (mergeu && u + width < w && grid[v * w + u + width] == c) width++;
+				while (mergev && v + height < h)
+				{
+					int k = 0;
+					while (k < width && grid[(v + height) * w + u + k] == c) k++;
+					if (k < width) break;
+					height++;
+				}
+				for (int j = 0; j < height; j++)
+				{
+					for (int k = 0; k < width; k++) grid[(v + j) * w + u + k] = -1;
+				}
+
+				// The corners go in the same order as for a single face of this direction.
+				int u0 = umin + u, u1 = u0 + width, v0 = vmin + v, v1 = v0 + height;
+				if (dir == 2 || dir == 4 || dir == 32) std::swap(u0, u1);
+				switch (dir)
+				{
+				case 1:
+				case 2:
+					AddFace(plane, u0, v0, plane, u1, v0, plane, u0, v1, plane, u1, v1, c, check);
+					break;
+				case 4:
+				case 8:
+					AddFace(u0, plane, v0, u1, plane, v0, u0, plane, v1, u1, plane, v1, c, check);
+					break;
+				default:
+					AddFace(u0, v0, plane, u1, v0, plane, u0, v1, plane, u1, v1, plane, c, check);
+					break;
+				}
+			}
 		}
-		if (cull & 8)
-		{
-			AddFace(x, y+1, z, x+1, y+1, z, x, y+1, z+c, x+1, y+1, z+c, *col, check);
-		}	
-		z+=c;
-		col+=c;
-	}
-	if (cull & 32)
-	{
-		int z = ztop+zleng-1;
-		AddFace(x+1, y, z+1, x, y, z+1, x+1, y+1, z+1, x, y+1, z+1, voxptr->col[zleng-1], check);
 	}
 }
 
@@ -304,6 +385,7 @@ void FVoxelModel::MakeSlabPolys(int x, int y, kvxslab_t *voxptr, FVoxelMap &chec
 void FVoxelModel::Initialize()
 {
 	FVoxelMap check;
+	TArray<FVoxelFace> faces;
 	FVoxelMipLevel *mip = &mVoxel->Mips[0];
 	for (int x = 0; x < mip->SizeX; x++)
 	{
@@ -315,10 +397,11 @@ void FVoxelModel::Initialize()
 			kvxslab_t *voxend = (kvxslab_t *)(slabxoffs + xyoffs[y+1]);
 			for (; voxptr < voxend; voxptr = (kvxslab_t *)((uint8_t *)voxptr + voxptr->zleng + 3))
 			{
-				MakeSlabPolys(x, y, voxptr, check);
+				MakeSlabPolys(x, y, voxptr, faces);
 			}
 		}
 	}
+	MergeFaces(faces, check);
 }
 
 //===========================================================================
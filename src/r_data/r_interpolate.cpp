@@ -331,6 +331,7 @@ DInterpolation::DInterpolation()
 	Next = nullptr;
 	Prev = nullptr;
 	refcount = 0;
+	applied = false;
 }
 
 //==========================================================================
@@ -467,6 +468,8 @@ void DSectorPlaneInterpolation::UpdateInterpolation()
 
 void DSectorPlaneInterpolation::Restore()
 {
+	if (!applied) return;
+	applied = false;
 	if (!ceiling)
 	{
 		sector->floorplane.setD(bakheight);
@@ -510,8 +513,15 @@ void DSectorPlaneInterpolation::Interpolate(double smoothratio)
 	{
 		Destroy();
 	}
+	else if (oldheight == bakheight && oldtexz == baktexz)
+	{
+		// The plane did not move during the last tic, so there's nothing to
+		// interpolate and the attached 3D floors don't need to be recalculated.
+		applied = false;
+	}
 	else
 	{
+		applied = true;
 		pplane->setD(oldheight + (bakheight - oldheight) * smoothratio);
 		sector->SetPlaneTexZ(pos, oldtexz + (baktexz - oldtexz) * smoothratio, true);
 	P_RecalculateAttached3DFloors(sector);
@@ -614,6 +624,8 @@ void DSectorScrollInterpolation::UpdateInterpolation()
 
 void DSectorScrollInterpolation::Restore()
 {
+	if (!applied) return;
+	applied = false;
 	sector->SetXOffset(ceiling, bakx);
 	sector->SetYOffset(ceiling, baky);
 }
@@ -633,8 +645,13 @@ void DSectorScrollInterpolation::Interpolate(double smoothratio)
 	{
 		Destroy();
 	}
+	else if (oldx == bakx && oldy == baky)
+	{
+		applied = false;
+	}
 	else
 	{
+		applied = true;
 		sector->SetXOffset(ceiling, oldx + (bakx - oldx) * smoothratio);
 		sector->SetYOffset(ceiling, oldy + (baky - oldy) * smoothratio);
 	}
@@ -712,6 +729,8 @@ void DWallScrollInterpolation::UpdateInterpolation()
 
 void DWallScrollInterpolation::Restore()
 {
+	if (!applied) return;
+	applied = false;
 	side->SetTextureXOffset(part, bakx);
 	side->SetTextureYOffset(part, baky);
 }
@@ -731,8 +750,13 @@ void DWallScrollInterpolation::Interpolate(double smoothratio)
 	{
 		Destroy();
 	}
+	else if (oldx == bakx && oldy == baky)
+	{
+		applied = false;
+	}
 	else
 	{
+		applied = true;
 		side->SetTextureXOffset(part, oldx + (bakx - oldx) * smoothratio);
 		side->SetTextureYOffset(part, oldy + (baky - oldy) * smoothratio);
 	}
@@ -814,6 +838,8 @@ void DPolyobjInterpolation::UpdateInterpolation()
 
 void DPolyobjInterpolation::Restore()
 {
+	if (!applied) return;
+	applied = false;
 	for(unsigned int i = 0; i < poly->Vertices.Size(); i++)
 	{
 		poly->Vertices[i]->set(bakverts[i*2  ], bakverts[i*2+1]);
@@ -849,8 +875,14 @@ void DPolyobjInterpolation::Interpolate(double smoothratio)
 	{
 		Destroy();
 	}
+	else if (!changed && poly->CenterSpot.pos.X == oldcx && poly->CenterSpot.pos.Y == oldcy)
+	{
+		// Nothing moved, so the subsector links can stay as they are.
+		applied = false;
+	}
 	else
 	{
+		applied = true;
 		bakcx = poly->CenterSpot.pos.X;
 		bakcy = poly->CenterSpot.pos.Y;
 		poly->CenterSpot.pos.X = bakcx + (bakcx - oldcx) * smoothratio;
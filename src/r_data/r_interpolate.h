@@ -20,6 +20,7 @@ class DInterpolation : public DObject
 
 protected:
 	int refcount;
+	bool applied;	// Interpolate changed something that Restore must undo
 
 	DInterpolation();
 
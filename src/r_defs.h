@@ -560,6 +560,7 @@ struct extsector_t
 		TDeletingArray<F3DFloor *>		ffloors;		// 3D floors in this sector
 		TArray<lightlist_t>				lightlist;		// 3D light list
 		TArray<sector_t*>				attached;		// 3D floors attached to this sector
+		TArray<uint8_t>					recalckey;		// inputs of the last P_Recalculate3DFloors run
 	} XFloor;
 
 	TArray<vertex_t *> vertices;
@@ -1592,6 +1593,46 @@ struct FMiniBSP
 	TArray<vertex_t> Verts;
 };
 
+// Copy of a node tree with only what point location needs: 24 bytes per
+// node instead of 72, laid out depth first so that the nodes near the root,
+// which every lookup visits, share cache lines. The side test is the same
+// integer math as R_PointOnSide, so results are identical.
+
+struct FPointNode
+{
+	fixed_t x, y, dx, dy;
+	uint32_t children[2];	// If the high bit is set, it's a subsector index.
+};
+
+struct FPointTree
+{
+	enum { LEAF = 0x80000000u };
+
+	TArray<FPointNode> Nodes;
+	subsector_t *Subsectors = nullptr;
+
+	void Build(const TArray<node_t> &nodes, subsector_t *subsectors);
+	void Clear()
+	{
+		Nodes.Clear();
+		Subsectors = nullptr;
+	}
+
+	subsector_t *Locate(fixed_t x, fixed_t y) const
+	{
+		// single subsector is a special case
+		if (Nodes.Size() == 0) return Subsectors;
+
+		uint32_t index = 0;
+		do
+		{
+			const FPointNode &node = Nodes[index];
+			index = node.children[DMulScale32(y - node.y, node.dx, node.x - x, node.dy) > 0];
+		} while (!(index & LEAF));
+		return Subsectors + (index & ~LEAF);
+	}
+};
+
 //
 // OTHER TYPES
 //
@@ -0,0 +1,331 @@
+/*
+** r_governor.cpp
+** Lowers rendering quality when frames take too long
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**---------------------------------------------------------------------------
+**
+** With vid_governor on, the time D_Display takes is averaged over windows
+** of one second. Two slow windows in a row take one step down the list
+** below. After a while of meeting the target, one step is tried back up.
+** If that step is slow right away it is taken back and the wait before the
+** next try doubles, so the governor does not keep flipping between two
+** steps.
+**
+** Settings changed this way are put back before the config is saved, unless
+** the user changed them in the mean time.
+**
+*/
+
+#include "c_cvars.h"
+#include "c_dispatch.h"
+#include "doomdef.h"
+#include "doomstat.h"
+#include "i_time.h"
+#include "templates.h"
+#include "r_videoscale.h"
+#include "r_governor.h"
+
+EXTERN_CVAR(Bool, gl_lights)
+EXTERN_CVAR(Bool, gl_bloom)
+EXTERN_CVAR(Int, gl_ssao)
+EXTERN_CVAR(Int, r_maxparticles)
+
+extern int currentrenderer;
+
+CUSTOM_CVAR(Bool, vid_governor, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG | CVAR_NOINITCALL)
+{
+	if (!self) R_GovernorRestore();
+}
+
+// Frame rate the governor tries to hold
+CVAR(Int, vid_governor_fps, 60, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+// Print every change the governor makes
+CVAR(Bool, vid_governor_log, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+enum EGovernorKnob
+{
+	GK_SSAO,
+	GK_Bloom,
+	GK_Particles,
+	GK_Lights,
+	GK_Scale
+};
+
+struct FGovernorStep
+{
+	EGovernorKnob Knob;
+	float Scale;
+	const char *Description;
+};
+
+// Cheapest loss of quality first
+static const FGovernorStep GovernorSteps[] =
+{
+	{ GK_SSAO, 1, "ambient occlusion off" },
+	{ GK_Bloom, 1, "bloom off" },
+	{ GK_Particles, 1, "half the particles" },
+	{ GK_Scale, 0.85f, "85% resolution" },
+	{ GK_Lights, 1, "dynamic lights off" },
+	{ GK_Scale, 0.7f, "70% resolution" },
+	{ GK_Scale, 0.55f, "55% resolution" },
+};
+
+enum { NUM_GOVERNOR_STEPS = countof(GovernorSteps) };
+
+static struct
+{
+	bool Applied;
+	int UserValue;
+	int SetValue;
+} GovernorState[NUM_GOVERNOR_STEPS];
+
+static int GovernorLevel;		// number of steps gone through, including those that did not apply
+static float GovernorScale = 1;
+
+static uint64_t WindowStart;
+static double WindowTime;
+static int WindowFrames;
+static int SlowWindows, GoodWindows;
+static int ProbeWindows = 10;	// good windows before a step back up is tried
+static int SinceStepUp = -1;	// windows since the last step up, -1 once it has held
+
+float R_GovernorScale()
+{
+	return GovernorScale;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+static bool StepApplies(const FGovernorStep &step)
+{
+	switch (step.Knob)
+	{
+	case GK_SSAO:		return currentrenderer == 1 && gl_ssao != 0;
+	case GK_Bloom:		return currentrenderer == 1 && gl_bloom;
+	case GK_Particles:	return r_maxparticles > 200;
+	case GK_Lights:		return gl_lights;
+	case GK_Scale:		return ViewportCanScale() && step.Scale < GovernorScale;
+	}
+	return false;
+}
+
+static void UpdateGovernorScale()
+{
+	float scale = 1;
+	for (int i = 0; i < NUM_GOVERNOR_STEPS; i++)
+	{
+		if (GovernorState[i].Applied && GovernorSteps[i].Knob == GK_Scale) scale = MIN(scale, GovernorSteps[i].Scale);
+	}
+	if (scale != GovernorScale)
+	{
+		GovernorScale = scale;
+		setsizeneeded = true;
+	}
+}
+
+static void ApplyStep(int i)
+{
+	auto &state = GovernorState[i];
+	switch (GovernorSteps[i].Knob)
+	{
+	case GK_SSAO:
+		state.UserValue = gl_ssao;
+		gl_ssao = state.SetValue = 0;
+		break;
+
+	case GK_Bloom:
+		state.UserValue = gl_bloom;
+		gl_bloom = false;
+		state.SetValue = 0;
+		break;
+
+	case GK_Particles:
+		state.UserValue = r_maxparticles;
+		r_maxparticles = state.SetValue = state.UserValue / 2;
+		break;
+
+	case GK_Lights:
+		state.UserValue = gl_lights;
+		gl_lights = false;
+		state.SetValue = 0;
+		break;
+
+	case GK_Scale:
+		break;
+	}
+	state.Applied = true;
+	UpdateGovernorScale();
+}
+
+// Settings the user has changed since are left alone.
+static void UndoStep(int i)
+{
+	auto &state = GovernorState[i];
+	switch (GovernorSteps[i].Knob)
+	{
+	case GK_SSAO:
+		if (gl_ssao == state.SetValue) gl_ssao = state.UserValue;
+		break;
+
+	case GK_Bloom:
+		if (gl_bloom == !!state.SetValue) gl_bloom = !!state.UserValue;
+		break;
+
+	case GK_Particles:
+		if (r_maxparticles == state.SetValue) r_maxparticles = state.UserValue;
+		break;
+
+	case GK_Lights:
+		if (gl_lights == !!state.SetValue) gl_lights = !!state.UserValue;
+		break;
+
+	case GK_Scale:
+		break;
+	}
+	state.Applied = false;
+	UpdateGovernorScale();
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+static void StepDown(double avg, double budget)
+{
+	while (GovernorLevel < NUM_GOVERNOR_STEPS && !StepApplies(GovernorSteps[GovernorLevel]))
+	{
+		GovernorLevel++;
+	}
+	if (GovernorLevel == NUM_GOVERNOR_STEPS)
+	{
+		return;
+	}
+	ApplyStep(GovernorLevel);
+	if (vid_governor_log)
+	{
+		Printf("Governor: %.1f ms per frame for a %.1f ms budget, %s\n", avg, budget, GovernorSteps[GovernorLevel].Description);
+	}
+	GovernorLevel++;
+}
+
+static void StepUp()
+{
+	while (GovernorLevel > 0)
+	{
+		GovernorLevel--;
+		if (GovernorState[GovernorLevel].Applied)
+		{
+			UndoStep(GovernorLevel);
+			if (vid_governor_log)
+			{
+				Printf("Governor: trying without %s\n", GovernorSteps[GovernorLevel].Description);
+			}
+			return;
+		}
+	}
+}
+
+void R_GovernorRestore()
+{
+	for (int i = NUM_GOVERNOR_STEPS - 1; i >= 0; i--)
+	{
+		if (GovernorState[i].Applied) UndoStep(i);
+	}
+	GovernorLevel = 0;
+	SlowWindows = GoodWindows = 0;
+	ProbeWindows = 10;
+	SinceStepUp = -1;
+	WindowStart = 0;
+}
+
+//==========================================================================
+//
+// Called by D_Display with the time the frame took.
+//
+//==========================================================================
+
+void R_GovernorFrame(double framems)
+{
+	// Menus, intermissions and the title screen say nothing about level performance.
+	if (!vid_governor || gamestate != GS_LEVEL)
+	{
+		WindowStart = 0;
+		return;
+	}
+
+	uint64_t now = I_msTime();
+	if (WindowStart == 0)
+	{
+		WindowStart = now;
+		WindowTime = 0;
+		WindowFrames = 0;
+	}
+	WindowTime += framems;
+	WindowFrames++;
+	if (now - WindowStart < 1000)
+	{
+		return;
+	}
+
+	double avg = WindowTime / WindowFrames;
+	double budget = 1000. / clamp<int>(vid_governor_fps, 10, 1000);
+	WindowStart = now;
+	WindowTime = 0;
+	WindowFrames = 0;
+
+	if (avg > budget * 1.1)
+	{
+		GoodWindows = 0;
+		// A step up that is slow right away goes back at once.
+		if (++SlowWindows >= 2 || SinceStepUp >= 0)
+		{
+			if (SinceStepUp >= 0) ProbeWindows = MIN(ProbeWindows * 2, 160);
+			SlowWindows = 0;
+			SinceStepUp = -1;
+			StepDown(avg, budget);
+		}
+	}
+	else
+	{
+		SlowWindows = 0;
+		if (SinceStepUp >= 0 && ++SinceStepUp >= 10)
+		{
+			SinceStepUp = -1;
+			ProbeWindows = 10;
+		}
+
+		if (avg > budget)
+		{
+			GoodWindows = 0;
+		}
+		else if (++GoodWindows >= ProbeWindows && GovernorLevel > 0)
+		{
+			GoodWindows = 0;
+			SinceStepUp = 0;
+			StepUp();
+		}
+	}
+}
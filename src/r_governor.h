@@ -0,0 +1,9 @@
+#ifndef __R_GOVERNOR_H__
+#define __R_GOVERNOR_H__
+
+// Automatic quality scaling to hold vid_governor_fps
+void R_GovernorFrame(double framems);
+void R_GovernorRestore();
+float R_GovernorScale();
+
+#endif //__R_GOVERNOR_H__
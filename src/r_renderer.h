@@ -52,6 +52,10 @@ struct FRenderer
 	virtual void RenderTextureView (FCanvasTexture *tex, AActor *viewpoint, double fov) = 0;
 	virtual void PreprocessLevel() {}
 	virtual void CleanLevelData() {}
+
+	// level setup work that can run on worker threads while the level's resources are being precached.
+	virtual void StartBackgroundLevelSetup() {}
+	virtual void FinishBackgroundLevelSetup() {}
 	virtual bool RequireGLNodes() { return false; }
 
 	virtual uint32_t GetCaps() { return 0; }
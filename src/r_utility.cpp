@@ -383,23 +383,55 @@ CUSTOM_CVAR (Int, screenblocks, 10, CVAR_ARCHIVE)
 
 subsector_t *R_PointInSubsector (fixed_t x, fixed_t y)
 {
-	node_t *node;
-	int side;
+	return level.pointnodes.Locate(x, y);
+}
 
-	// single subsector is a special case
-	if (level.nodes.Size() == 0)
-		return &level.subsectors[0];
-				
-	node = level.HeadNode();
+//==========================================================================
+//
+// FPointTree :: Build
+//
+//==========================================================================
+
+void FPointTree::Build(const TArray<node_t> &nodes, subsector_t *subsectors)
+{
+	Nodes.Resize(nodes.Size());
+	Subsectors = subsectors;
+	if (nodes.Size() == 0) return;
+
+	struct Pending
+	{
+		const node_t *node;
+		uint32_t *slot;
+	};
+	TArray<Pending> stack;
+	uint32_t headslot, count = 0;
 
-	do
+	stack.Push({ &nodes.Last(), &headslot });
+	while (stack.Size() > 0)
 	{
-		side = R_PointOnSide (x, y, node);
-		node = (node_t *)node->children[side];
+		Pending p;
+		stack.Pop(p);
+		*p.slot = count;
+		FPointNode &out = Nodes[count++];
+		out.x = p.node->x;
+		out.y = p.node->y;
+		out.dx = p.node->dx;
+		out.dy = p.node->dy;
+
+		// Push the back side first so that the front side is laid out right after its parent.
+		for (int side = 1; side >= 0; side--)
+		{
+			void *child = p.node->children[side];
+			if ((size_t)child & 1)
+			{
+				out.children[side] = uint32_t((subsector_t *)((uint8_t *)child - 1) - subsectors) | LEAF;
+			}
+			else
+			{
+				stack.Push({ (node_t *)child, &out.children[side] });
+			}
+		}
 	}
-	while (!((size_t)node & 1));
-		
-	return (subsector_t *)((uint8_t *)node - 1);
 }
 
 //==========================================================================
@@ -35,6 +35,7 @@
 #include "c_cvars.h"
 #include "v_video.h"
 #include "templates.h"
+#include "r_governor.h"
 
 #define NUMSCALEMODES 7
 
@@ -169,7 +170,7 @@ int ViewportScaledWidth(int width, int height)
 		vid_scalemode = 0;
 	if (vid_cropaspect && height > 0)
 		width = ((float)width/height > ActiveRatio(width, height)) ? (int)(height * ActiveRatio(width, height)) : width;
-	return (int)MAX((int32_t)160, (int32_t)(vid_scalefactor * vScaleTable[vid_scalemode].GetScaledWidth(width)));
+	return (int)MAX((int32_t)160, (int32_t)(vid_scalefactor * R_GovernorScale() * vScaleTable[vid_scalemode].GetScaledWidth(width)));
 }
 
 int ViewportScaledHeight(int width, int height)
@@ -183,7 +184,12 @@ int ViewportScaledHeight(int width, int height)
 		vid_scalemode = 0;
 	if (vid_cropaspect && height > 0)
 		height = ((float)width/height < ActiveRatio(width, height)) ? (int)(width / ActiveRatio(width, height)) : height;
-	return (int)MAX((int32_t)100, (int32_t)(vid_scalefactor * vScaleTable[vid_scalemode].GetScaledHeight(height)));
+	return (int)MAX((int32_t)100, (int32_t)(vid_scalefactor * R_GovernorScale() * vScaleTable[vid_scalemode].GetScaledHeight(height)));
+}
+
+bool ViewportCanScale()
+{
+	return !isClassicSoftware();
 }
 
 bool ViewportIsScaled43()
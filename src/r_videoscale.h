@@ -37,4 +37,5 @@ bool ViewportLinearScale();
 int ViewportScaledWidth(int width, int height);
 int ViewportScaledHeight(int width, int height);
 bool ViewportIsScaled43();
+bool ViewportCanScale();
 #endif //__VIDEOSCALE_H__
\ No newline at end of file
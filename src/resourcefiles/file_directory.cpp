@@ -35,10 +35,23 @@
 
 
 #include <sys/stat.h>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
 
 #include "resourcefile.h"
 #include "cmdlib.h"
 #include "i_system.h"
+#include "i_time.h"
+#include "c_cvars.h"
+#include <vector>
+
+CVAR(Bool, file_mmapdirs, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+CVAR(Bool, file_watchdirs, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
 
 
 
@@ -53,7 +66,12 @@ struct FDirectoryLump : public FResourceLump
 	virtual FileReader NewReader();
 	virtual int FillCache();
 
+	bool MapFile();
+	int Refresh();
+
 	FString mFullPath;
+	FileReader mMapping;	// only used with file_mmapdirs
+	time_t mTime;
 };
 
 
@@ -68,13 +86,30 @@ class FDirectory : public FResourceFile
 	TArray<FDirectoryLump> Lumps;
 	const bool nosubdir;
 
+	// Change notification. The platform specific handle only tells that something
+	// in the tree has changed, the actual lumps are then found by comparing file times.
+#ifdef _WIN32
+	HANDLE ChangeHandle = INVALID_HANDLE_VALUE;
+#elif defined(__linux__)
+	int ChangeHandle = -1;
+#endif
+	uint64_t LastCheck = 0;
+	bool RetryCheck = false;
+	std::vector<FileReader> RetiredMappings;	// replaced mappings may still be referenced through the lump cache.
+
 	int AddDirectory(const char *dirpath);
 	void AddEntry(const char *fullpath, int size);
+	void StartWatching();
+	bool CheckChangeNotification();
 
 public:
 	FDirectory(const char * dirname, bool nosubdirflag = false);
+	~FDirectory();
 	bool Open(bool quiet);
 	virtual FResourceLump *GetLump(int no) { return ((unsigned)no < NumLumps)? &Lumps[no] : NULL; }
+	void FindModifiedLumps(TArray<int> &changed) override;
+
+	friend struct FDirectoryLump;
 };
 
 
@@ -104,6 +139,15 @@ FDirectory::FDirectory(const char * directory, bool nosubdirflag)
 	FileName = dirname;
 }
 
+FDirectory::~FDirectory()
+{
+#ifdef _WIN32
+	if (ChangeHandle != INVALID_HANDLE_VALUE) FindCloseChangeNotification(ChangeHandle);
+#elif defined(__linux__)
+	if (ChangeHandle >= 0) close(ChangeHandle);
+#endif
+}
+
 
 //==========================================================================
 //
@@ -119,6 +163,11 @@ int FDirectory::AddDirectory(const char *dirpath)
 	FString dirmatch = dirpath;
 	findstate_t find;
 	dirmatch += '*';
+
+#ifdef __linux__
+	// inotify does not watch subdirectories so each one needs its own watch.
+	if (ChangeHandle >= 0) inotify_add_watch(ChangeHandle, dirpath, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+#endif
 	
 	handle = I_FindFirst(dirmatch.GetChars(), &find);
 	if (handle == ((void *)(-1)))
@@ -181,6 +230,7 @@ int FDirectory::AddDirectory(const char *dirpath)
 
 bool FDirectory::Open(bool quiet)
 {
+	if (file_watchdirs) StartWatching();
 	NumLumps = AddDirectory(FileName);
 	if (!quiet) Printf(", %d lumps\n", NumLumps);
 	PostProcessArchive(&Lumps[0], sizeof(FDirectoryLump));
@@ -210,6 +260,75 @@ void FDirectory::AddEntry(const char *fullpath, int size)
 	lump_p->Owner = this;
 	lump_p->Flags = 0;
 	lump_p->CheckEmbedded();
+	if (!GetFileInfo(fullpath, nullptr, &lump_p->mTime)) lump_p->mTime = 0;
+}
+
+//==========================================================================
+//
+// Sets up the change notification for the directory tree. This needs to
+// be done before scanning it so that AddDirectory can watch subdirectories.
+//
+//==========================================================================
+
+void FDirectory::StartWatching()
+{
+#ifdef _WIN32
+	ChangeHandle = FindFirstChangeNotificationW(FileName.WideString().c_str(), !nosubdir,
+		FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE);
+#elif defined(__linux__)
+	ChangeHandle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+}
+
+//==========================================================================
+//
+// Returns true if the tree may have changed since the last call. Without
+// a change notification this is rate limited to once per second because
+// it has to check every file.
+//
+//==========================================================================
+
+bool FDirectory::CheckChangeNotification()
+{
+	bool retry = RetryCheck && I_msTime() - LastCheck >= 1000;
+#ifdef _WIN32
+	if (ChangeHandle != INVALID_HANDLE_VALUE)
+	{
+		if (WaitForSingleObject(ChangeHandle, 0) != WAIT_OBJECT_0) return retry;
+		FindNextChangeNotification(ChangeHandle);
+		return true;
+	}
+#elif defined(__linux__)
+	if (ChangeHandle >= 0)
+	{
+		char buffer[4096];
+		bool changed = false;
+		while (read(ChangeHandle, buffer, sizeof(buffer)) > 0) changed = true;
+		return changed || retry;
+	}
+#endif
+	return I_msTime() - LastCheck >= 1000;
+}
+
+//==========================================================================
+//
+// Finds the lumps whose files have changed on disk and drops their
+// cached data so that the next access reads the new contents.
+//
+//==========================================================================
+
+void FDirectory::FindModifiedLumps(TArray<int> &changed)
+{
+	if (!CheckChangeNotification()) return;
+
+	LastCheck = I_msTime();
+	RetryCheck = false;
+	for (uint32_t i = 0; i < NumLumps; i++)
+	{
+		int res = Lumps[i].Refresh();
+		if (res > 0) changed.Push(i);
+		else if (res < 0) RetryCheck = true;
+	}
 }
 
 
@@ -222,10 +341,60 @@ void FDirectory::AddEntry(const char *fullpath, int size)
 FileReader FDirectoryLump::NewReader()
 {
 	FileReader fr;
-	fr.OpenFile(mFullPath);
+	if (MapFile())
+	{
+		fr.OpenMemory(mMapping.GetBuffer(), LumpSize);
+	}
+	else
+	{
+		fr.OpenFile(mFullPath);
+	}
 	return fr;
 }
 
+//==========================================================================
+//
+// Maps the file on first access. Mapped lumps are cached as pointers into
+// the mapping, the same way uncompressed lumps in mapped archives are.
+//
+//==========================================================================
+
+bool FDirectoryLump::MapFile()
+{
+	if (mMapping.isOpen()) return true;
+	if (!file_mmapdirs || LumpSize <= 0) return false;
+	return mMapping.OpenMappedFile(mFullPath) && mMapping.GetLength() == LumpSize;
+}
+
+//==========================================================================
+//
+// Checks the file for modification and drops the cache if it has changed.
+// Returns 1 if the lump was refreshed and -1 if its cache is still in use,
+// in which case the check has to be repeated later.
+//
+//==========================================================================
+
+int FDirectoryLump::Refresh()
+{
+	size_t size;
+	time_t time;
+	if (!GetFileInfo(mFullPath, &size, &time)) return 0;
+	if (time == mTime && (int)size == LumpSize) return 0;
+	if (RefCount > 0) return -1;
+
+	FlushCache();
+	mTime = time;
+	LumpSize = (int)size;
+	Cache = nullptr;
+	RefCount = 0;
+	if (mMapping.isOpen())
+	{
+		// Pointers into a mapping are never reference counted so it has to stay alive.
+		static_cast<FDirectory*>(Owner)->RetiredMappings.push_back(std::move(mMapping));
+	}
+	return 1;
+}
+
 //==========================================================================
 //
 //
@@ -234,6 +403,13 @@ FileReader FDirectoryLump::NewReader()
 
 int FDirectoryLump::FillCache()
 {
+	if (MapFile())
+	{
+		Cache = (char*)mMapping.GetBuffer();
+		RefCount = -1;
+		return 1;
+	}
+
 	FileReader fr;
 	Cache = new char[LumpSize];
 	if (!fr.OpenFile(mFullPath))
@@ -256,7 +256,8 @@ bool FZipFile::Open(bool quiet)
 		}
 		else
 		{
-			if (name.IndexOf(name0) != 0)
+			// Only prefixes are compared here, so avoid searching the whole name and building temporary strings.
+			if (strncmp(name, name0, name0.Len()) != 0)
 			{
 				name0 = "";
 				break;
@@ -264,19 +265,22 @@ bool FZipFile::Open(bool quiet)
 			else if (!foundspeciallump)
 			{
 				// at least one of the more common definition lumps must be present.
-				if (name.IndexOf(name0 + "mapinfo") == 0) foundspeciallump = true;
-				else if (name.IndexOf(name0 + "zmapinfo") == 0) foundspeciallump = true;
-				else if (name.IndexOf(name0 + "gameinfo") == 0) foundspeciallump = true;
-				else if (name.IndexOf(name0 + "sndinfo") == 0) foundspeciallump = true;
-				else if (name.IndexOf(name0 + "sbarinfo") == 0) foundspeciallump = true;
-				else if (name.IndexOf(name0 + "menudef") == 0) foundspeciallump = true;
-				else if (name.IndexOf(name0 + "gldefs") == 0) foundspeciallump = true;
-				else if (name.IndexOf(name0 + "animdefs") == 0) foundspeciallump = true;
-				else if (name.IndexOf(name0 + "decorate.") == 0) foundspeciallump = true;	// DECORATE is a common subdirectory name, so the check needs to be a bit different.
-				else if (name.Compare(name0 + "decorate") == 0) foundspeciallump = true;
-				else if (name.IndexOf(name0 + "zscript.") == 0) foundspeciallump = true;	// same here.
-				else if (name.Compare(name0 + "zscript") == 0) foundspeciallump = true;
-				else if (name.Compare(name0 + "maps/") == 0) foundspeciallump = true;
+				const char *rest = name.GetChars() + name0.Len();
+				auto startswith = [=](const char *prefix) { return strncmp(rest, prefix, strlen(prefix)) == 0; };
+
+				if (startswith("mapinfo")) foundspeciallump = true;
+				else if (startswith("zmapinfo")) foundspeciallump = true;
+				else if (startswith("gameinfo")) foundspeciallump = true;
+				else if (startswith("sndinfo")) foundspeciallump = true;
+				else if (startswith("sbarinfo")) foundspeciallump = true;
+				else if (startswith("menudef")) foundspeciallump = true;
+				else if (startswith("gldefs")) foundspeciallump = true;
+				else if (startswith("animdefs")) foundspeciallump = true;
+				else if (startswith("decorate.")) foundspeciallump = true;	// DECORATE is a common subdirectory name, so the check needs to be a bit different.
+				else if (!strcmp(rest, "decorate")) foundspeciallump = true;
+				else if (startswith("zscript.")) foundspeciallump = true;	// same here.
+				else if (!strcmp(rest, "zscript")) foundspeciallump = true;
+				else if (!strcmp(rest, "maps/")) foundspeciallump = true;
 			}
 		}
 	}
@@ -290,8 +294,8 @@ bool FZipFile::Open(bool quiet)
 		FZipCentralDirectoryInfo *zip_fh = (FZipCentralDirectoryInfo *)dirptr;
 
 		int len = LittleShort(zip_fh->NameLength);
-		FString name(dirptr + sizeof(FZipCentralDirectoryInfo), len);
-		if (name0.IsNotEmpty()) name = name.Mid(name0.Len());
+		int skip = (int)MIN<size_t>(name0.Len(), len);
+		FString name(dirptr + sizeof(FZipCentralDirectoryInfo) + skip, len - skip);
 		dirptr += sizeof(FZipCentralDirectoryInfo) + 
 				  LittleShort(zip_fh->NameLength) + 
 				  LittleShort(zip_fh->ExtraLength) + 
@@ -460,6 +464,63 @@ int FZipLump::FillCache()
 	return 1;
 }
 
+//==========================================================================
+//
+// Reading only the start of a compressed lump, e.g. to detect an image
+// format, should not require inflating all of it. This is only possible
+// if the archive is in memory, because a file reader cannot be shared.
+//
+//==========================================================================
+
+FileReader FZipLump::NewStreamReader()
+{
+	const char *buffer;
+
+	if (Cache == nullptr && Method != METHOD_STORED && (buffer = Owner->Reader.GetBuffer()) != nullptr)
+	{
+		if (Flags & LUMPFZIP_NEEDFILESTART) SetLumpAddress();
+		FileReader source, stream;
+		source.OpenMemory(buffer + Position, CompressedSize);
+		if (stream.OpenBufferedDecompressor(std::move(source), LumpSize, Method))
+		{
+			return stream;
+		}
+	}
+	return NewReader();
+}
+
+//==========================================================================
+//
+// Long streamed lumps like music should not need to be decompressed into
+// memory at all. This opens the compressed data separately so that the
+// reader does not depend on the archive's one and decompresses it in small
+// blocks as it gets played.
+//
+//==========================================================================
+
+FileReader FZipLump::NewIndependentStreamReader(const char *filename)
+{
+	FileReader source, stream;
+
+	if (Cache != nullptr || (GPFlags & ZF_ENCRYPTED) || (Method != METHOD_DEFLATE && Method != METHOD_BZIP2 && Method != METHOD_LZMA))
+	{
+		return stream;
+	}
+	if (Flags & LUMPFZIP_NEEDFILESTART) SetLumpAddress();
+
+	const char *buffer = Owner->Reader.GetBuffer();
+	if (buffer != nullptr)
+	{
+		source.OpenMemory(buffer + Position, CompressedSize);
+	}
+	else if (!source.OpenFile(filename, Position, CompressedSize))
+	{
+		return stream;
+	}
+	stream.OpenStreamingDecompressor(std::move(source), LumpSize, Method);
+	return stream;
+}
+
 //==========================================================================
 //
 //
@@ -610,7 +671,7 @@ int AppendCentralDirectory(FileWriter *zip_file, const char *filename, FCompress
 	return 0;
 }
 
-bool WriteZip(const char *filename, TArray<FString> &filenames, TArray<FCompressedBuffer> &content)
+bool WriteZip(FileWriter *f, TArray<FString> &filenames, TArray<FCompressedBuffer> &content)
 {
 	// try to determine local time
 	struct tm *ltime;
@@ -623,49 +684,46 @@ bool WriteZip(const char *filename, TArray<FString> &filenames, TArray<FCompress
 
 	if (filenames.Size() != content.Size()) return false;
 
-	auto f = FileWriter::Open(filename);
-	if (f != nullptr)
+	for (unsigned i = 0; i < filenames.Size(); i++)
 	{
-		for (unsigned i = 0; i < filenames.Size(); i++)
+		int pos = AppendToZip(f, filenames[i], content[i], dostime);
+		if (pos == -1)
 		{
-			int pos = AppendToZip(f, filenames[i], content[i], dostime);
-			if (pos == -1)
-			{
-				delete f;
-				remove(filename);
-				return false;
-			}
-			positions.Push(pos);
-		}
-
-		int dirofs = (int)f->Tell();
-		for (unsigned i = 0; i < filenames.Size(); i++)
-		{
-			if (AppendCentralDirectory(f, filenames[i], content[i], dostime, positions[i]) < 0)
-			{
-				delete f;
-				remove(filename);
-				return false;
-			}
+			return false;
 		}
+		positions.Push(pos);
+	}
 
-		// Write the directory terminator.
-		FZipEndOfCentralDirectory dirend;
-		dirend.Magic = ZIP_ENDOFDIR;
-		dirend.DiskNumber = 0;
-		dirend.FirstDisk = 0;
-		dirend.NumEntriesOnAllDisks = dirend.NumEntries = LittleShort((uint16_t)filenames.Size());
-		dirend.DirectoryOffset = LittleLong(dirofs);
-		dirend.DirectorySize = LittleLong((uint32_t)(f->Tell() - dirofs));
-		dirend.ZipCommentLength = 0;
-		if (f->Write(&dirend, sizeof(dirend)) != sizeof(dirend))
+	int dirofs = (int)f->Tell();
+	for (unsigned i = 0; i < filenames.Size(); i++)
+	{
+		if (AppendCentralDirectory(f, filenames[i], content[i], dostime, positions[i]) < 0)
 		{
-			delete f;
-			remove(filename);
 			return false;
 		}
+	}
+
+	// Write the directory terminator.
+	FZipEndOfCentralDirectory dirend;
+	dirend.Magic = ZIP_ENDOFDIR;
+	dirend.DiskNumber = 0;
+	dirend.FirstDisk = 0;
+	dirend.NumEntriesOnAllDisks = dirend.NumEntries = LittleShort((uint16_t)filenames.Size());
+	dirend.DirectoryOffset = LittleLong(dirofs);
+	dirend.DirectorySize = LittleLong((uint32_t)(f->Tell() - dirofs));
+	dirend.ZipCommentLength = 0;
+	return f->Write(&dirend, sizeof(dirend)) == sizeof(dirend);
+}
+
+bool WriteZip(const char *filename, TArray<FString> &filenames, TArray<FCompressedBuffer> &content)
+{
+	auto f = FileWriter::Open(filename);
+	if (f != nullptr)
+	{
+		bool ok = WriteZip(f, filenames, content);
 		delete f;
-		return true;
+		if (!ok) remove(filename);
+		return ok;
 	}
 	return false;
 }
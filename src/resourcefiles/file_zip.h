@@ -24,6 +24,9 @@ struct FZipLump : public FResourceLump
 
 	virtual FileReader *GetReader();
 	virtual int FillCache();
+	virtual FileReader NewStreamReader();
+	virtual FileReader NewIndependentStreamReader(const char *filename);
+	virtual bool CanPrefetch() { return Method == METHOD_DEFLATE || Method == METHOD_BZIP2 || Method == METHOD_LZMA; }
 
 private:
 	void SetLumpAddress();
@@ -43,6 +43,41 @@
 #include "doomstat.h"
 #include "w_zip.h"
 #include "md5.h"
+#include "c_cvars.h"
+#include "stats.h"
+
+//==========================================================================
+//
+// Released caches are not freed right away but kept in a list up to this
+// many megabytes, so that lumps which get read over and over again (e.g.
+// on every map load) don't have to be read and decompressed each time.
+// Caches that are still referenced are never evicted, and caches that
+// point into a memory mapped file are never put in the list because
+// they don't occupy any heap memory.
+//
+//==========================================================================
+
+CUSTOM_CVAR(Int, lumpcache_budget, 32, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+{
+	if (self < 0) self = 0;
+	else FResourceLump::TrimReleasedCaches(size_t(self) << 20);
+}
+
+static FResourceLump *ReleasedHead, *ReleasedTail;
+static size_t ReleasedBytes;
+static unsigned ReleasedCount;
+static unsigned CacheHits, CacheMisses, CacheEvictions;
+
+static void UnlinkReleased(FResourceLump *lump)
+{
+	if (lump->LruPrev != NULL) lump->LruPrev->LruNext = lump->LruNext;
+	else ReleasedHead = lump->LruNext;
+	if (lump->LruNext != NULL) lump->LruNext->LruPrev = lump->LruPrev;
+	else ReleasedTail = lump->LruPrev;
+	lump->LruPrev = lump->LruNext = NULL;
+	ReleasedBytes -= lump->LumpSize;
+	ReleasedCount--;
+}
 
 
 //==========================================================================
@@ -80,6 +115,8 @@ FResourceLump::~FResourceLump()
 {
 	if (Cache != NULL && RefCount >= 0)
 	{
+		if (RefCount == 0) UnlinkReleased(this);
+		M_TrackMemory(MEMTAG_LUMPCACHE, -LumpSize);
 		delete [] Cache;
 		Cache = NULL;
 	}
@@ -245,10 +282,19 @@ void *FResourceLump::CacheLump()
 	if (Cache != NULL)
 	{
 		if (RefCount > 0) RefCount++;
+		else if (RefCount == 0)
+		{
+			UnlinkReleased(this);
+			RefCount = 1;
+		}
+		CacheHits++;
 	}
 	else if (LumpSize > 0)
 	{
+		CacheMisses++;
 		FillCache();
+		// Caches that point into a memory mapped file don't take up heap space.
+		if (RefCount > 0) M_TrackMemory(MEMTAG_LUMPCACHE, LumpSize);
 	}
 	return Cache;
 }
@@ -265,13 +311,69 @@ int FResourceLump::ReleaseCache()
 	{
 		if (--RefCount == 0)
 		{
-			delete [] Cache;
-			Cache = NULL;
+			size_t budget = size_t(*lumpcache_budget) << 20;
+			if ((size_t)LumpSize <= budget)
+			{
+				LruNext = ReleasedHead;
+				if (ReleasedHead != NULL) ReleasedHead->LruPrev = this;
+				else ReleasedTail = this;
+				ReleasedHead = this;
+				ReleasedBytes += LumpSize;
+				ReleasedCount++;
+				TrimReleasedCaches(budget);
+			}
+			else
+			{
+				M_TrackMemory(MEMTAG_LUMPCACHE, -LumpSize);
+				delete [] Cache;
+				Cache = NULL;
+			}
 		}
 	}
 	return RefCount;
 }
 
+//==========================================================================
+//
+// Frees a released cache that has been kept around
+//
+//==========================================================================
+
+void FResourceLump::FlushCache()
+{
+	if (Cache != NULL && RefCount == 0)
+	{
+		UnlinkReleased(this);
+		M_TrackMemory(MEMTAG_LUMPCACHE, -LumpSize);
+		delete [] Cache;
+		Cache = NULL;
+	}
+}
+
+//==========================================================================
+//
+// Frees the least recently released caches until they fit in the budget
+//
+//==========================================================================
+
+void FResourceLump::TrimReleasedCaches(size_t budget)
+{
+	while (ReleasedBytes > budget && ReleasedTail != NULL)
+	{
+		ReleasedTail->FlushCache();
+		CacheEvictions++;
+	}
+}
+
+ADD_STAT(lumpcache)
+{
+	FString out;
+	unsigned total = CacheHits + CacheMisses;
+	out.Format("hits: %u of %u (%.1f%%)  released: %u lumps, %zu of %d KB kept, %u evicted",
+		CacheHits, total, total > 0 ? CacheHits * 100. / total : 0., ReleasedCount, ReleasedBytes >> 10, *lumpcache_budget << 10, CacheEvictions);
+	return out;
+}
+
 //==========================================================================
 //
 // Opens a resource file
@@ -45,7 +45,9 @@ struct FResourceLump
 	};
 	uint8_t			Flags;
 	int8_t			RefCount;
-	char *			Cache;
+	char *			Cache;			// A cache with a RefCount of 0 has been released but is still kept around.
+	FResourceLump *	LruPrev;		// Links in the list of released caches, most recently released first.
+	FResourceLump *	LruNext;
 	FResourceFile *	Owner;
 	FTexture *		LinkedTexture;
 	int				Namespace;
@@ -53,6 +55,7 @@ struct FResourceLump
 	FResourceLump()
 	{
 		Cache = NULL;
+		LruPrev = LruNext = NULL;
 		Owner = NULL;
 		Flags = 0;
 		RefCount = 0;
@@ -64,14 +67,19 @@ struct FResourceLump
 	virtual ~FResourceLump();
 	virtual FileReader *GetReader();
 	virtual FileReader NewReader();
+	virtual FileReader NewStreamReader() { return NewReader(); }	// for compressed lumps: decompresses only as much as gets read.
+	virtual FileReader NewIndependentStreamReader(const char *filename) { return FileReader(); }	// for compressed lumps: a reader with its own file handle that never holds the whole lump.
 	virtual int GetFileOffset() { return -1; }
 	virtual int GetIndexNum() const { return 0; }
 	void LumpNameSetup(FString iname);
 	void CheckEmbedded();
 	virtual FCompressedBuffer GetRawData();
+	virtual bool CanPrefetch() { return false; }	// true if GetRawData returns a stream that can be decompressed on a separate thread.
 
 	void *CacheLump();
 	int ReleaseCache();
+	void FlushCache();	// frees a released cache that is still being kept around.
+	static void TrimReleasedCaches(size_t budget);
 
 protected:
 	virtual int FillCache() { return -1; }
@@ -119,6 +127,7 @@ public:
 	virtual void FindStrifeTeaserVoices ();
 	virtual bool Open(bool quiet) = 0;
 	virtual FResourceLump *GetLump(int no) = 0;
+	virtual void FindModifiedLumps(TArray<int> &changed) {}	// Returns the lumps that have changed on disk. Only supported for directories.
 	FResourceLump *FindLump(const char *name);
 };
 
@@ -47,6 +47,10 @@
 #include "doomstat.h"
 #include "v_text.h"
 
+#ifndef NO_SSE
+#include <emmintrin.h>
+#endif
+
 // MACROS ------------------------------------------------------------------
 
 // TYPES -------------------------------------------------------------------
@@ -279,6 +283,13 @@ void FScanner::OpenString (const char *name, FString buffer)
 void FScanner :: OpenLumpNum (int lump)
 {
 	Close ();
+	FString *cached = CacheLumpText ? LumpTextCache.CheckKey(lump) : nullptr;
+	if (cached != nullptr)
+	{
+		// FString is reference counted, so this doesn't copy the text.
+		ScriptBuffer = *cached;
+	}
+	else
 	{
 		FMemLump mem = Wads.ReadLump(lump);
 		ScriptBuffer = mem.GetString();
@@ -286,6 +297,58 @@ void FScanner :: OpenLumpNum (int lump)
 	ScriptName = Wads.GetLumpFullPath(lump);
 	LumpNum = lump;
 	PrepareScript ();
+	if (CacheLumpText && cached == nullptr)
+	{
+		LumpTextCache[lump] = ScriptBuffer;
+	}
+}
+
+//==========================================================================
+//
+// FScanner :: CacheLumps
+//
+// Many lumps get opened by more than one parser during startup, e.g.
+// MAPINFO, which is read once for the game info and once for the maps.
+// While enabled, the prepared text of each lump is kept so that it only
+// needs to be read from the resource file once. Disabling the cache
+// releases all stored text. It must not be enabled across a change of
+// the lump directory.
+//
+//==========================================================================
+
+bool FScanner::CacheLumpText;
+TMap<int, FString> FScanner::LumpTextCache;
+
+void FScanner::CacheLumps(bool enable)
+{
+	CacheLumpText = enable;
+	LumpTextCache.Clear();
+}
+
+//==========================================================================
+//
+// FScanner :: PreloadLumps
+//
+// Puts the given lumps into the text cache. Compressed lumps are inflated
+// in parallel first. Returns false if the cache is disabled, in which
+// case nothing gets loaded.
+//
+//==========================================================================
+
+bool FScanner::PreloadLumps(const TArray<int> &lumps)
+{
+	if (!CacheLumpText) return false;
+
+	Wads.PrefetchLumps(lumps);
+	for (int lump : lumps)
+	{
+		if (lump >= 0 && LumpTextCache.CheckKey(lump) == nullptr)
+		{
+			FScanner sc(lump);
+		}
+	}
+	Wads.ReleasePrefetchedLumps();
+	return true;
 }
 
 //==========================================================================
@@ -398,6 +461,42 @@ void FScanner::RestorePos (const FScanner::SavedPos &pos)
 	Crossed = false;
 }
 
+//==========================================================================
+//
+// FScanner :: GetRawPos
+//
+// Gives dedicated lexers direct access to the unparsed part of the
+// script. Returns NULL if a token has been pushed back with UnGet, since
+// the buffer position is then ahead of what the caller expects.
+//
+//==========================================================================
+
+const char *FScanner::GetRawPos(const char **end)
+{
+	CheckOpen();
+	if (AlreadyGot || End) return NULL;
+	*end = ScriptEndPtr;
+	return ScriptPtr;
+}
+
+//==========================================================================
+//
+// FScanner :: SetRawPos
+//
+// Continues scanning after a section that was consumed by GetRawPos's caller.
+//
+//==========================================================================
+
+void FScanner::SetRawPos(const char *ptr, int line)
+{
+	ScriptPtr = ptr;
+	Line = line;
+	End = false;
+	AlreadyGot = false;
+	LastGotToken = false;
+	Crossed = false;
+}
+
 //==========================================================================
 //
 // FScanner :: isText
@@ -476,6 +575,44 @@ void FScanner::SetStateMode(bool stately)
 	StateOptions = stately;
 }
 
+//==========================================================================
+//
+// FScanner :: SkipCommentBody
+//
+// Returns the position of the next '*' or newline inside a C comment,
+// or limit if there is none. Comments are skipped a lot when parsing
+// large mods so this checks 16 characters at a time where possible.
+//
+//==========================================================================
+
+const char *FScanner::SkipCommentBody(const char *p, const char *limit)
+{
+#ifndef NO_SSE
+	const __m128i star = _mm_set1_epi8('*');
+	const __m128i newline = _mm_set1_epi8('\n');
+	while (limit - p >= 16)
+	{
+		__m128i chars = _mm_loadu_si128((const __m128i *)p);
+		int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chars, star), _mm_cmpeq_epi8(chars, newline)));
+		if (mask != 0)
+		{
+			while (!(mask & 1))
+			{
+				mask >>= 1;
+				p++;
+			}
+			return p;
+		}
+		p += 16;
+	}
+#endif
+	while (p < limit && *p != '*' && *p != '\n')
+	{
+		p++;
+	}
+	return p;
+}
+
 //==========================================================================
 //
 // FScanner::ScanString
@@ -39,8 +39,12 @@ public:
 	void DisableStateOptions();
 	const SavedPos SavePos();
 	void RestorePos(const SavedPos &pos);
+	const char *GetRawPos(const char **end);
+	void SetRawPos(const char *ptr, int line);
 
 	static FString TokenName(int token, const char *string=NULL);
+	static void CacheLumps(bool enable);
+	static bool PreloadLumps(const TArray<int> &lumps);
 
 	bool GetString();
 	void MustGetString();
@@ -97,6 +101,7 @@ protected:
 	void PrepareScript();
 	void CheckOpen();
 	bool ScanString(bool tokens);
+	static const char *SkipCommentBody(const char *p, const char *limit);
 
 	// Strings longer than this minus one will be dynamically allocated.
 	static const int MAX_STRING_SIZE = 128;
@@ -118,6 +123,9 @@ protected:
 	bool Escape;
 	VersionInfo ParseVersion = { 0, 0, 0 };	// no ZScript extensions by default
 
+	static bool CacheLumpText;
+	static TMap<int, FString> LumpTextCache;
+
 
 	bool ScanValue(bool allowfloat);
 };
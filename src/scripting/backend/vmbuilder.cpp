@@ -112,6 +112,9 @@ void VMFunctionBuilder::EndStatement()
 
 void VMFunctionBuilder::MakeFunction(VMScriptFunction *func)
 {
+	UnoptimizedCodeSize = Code.Size();
+	OptimizeCode();
+
 	func->Alloc(Code.Size(), IntConstantList.Size(), FloatConstantList.Size(), StringConstantList.Size(), AddressConstantList.Size(), LineNumbers.Size());
 
 	// Copy code block.
@@ -150,6 +153,104 @@ void VMFunctionBuilder::MakeFunction(VMScriptFunction *func)
 	assert(ActiveParam == 0);
 }
 
+//==========================================================================
+//
+// VMFunctionBuilder :: IsSkipOp
+//
+// Instructions that may skip the one following them. What follows such an
+// instruction is part of it and must stay in place.
+//
+//==========================================================================
+
+bool VMFunctionBuilder::IsSkipOp(int op)
+{
+	switch (op)
+	{
+	case OP_TEST:		case OP_TESTN:		case OP_IJMP:		case OP_CMPS:
+	case OP_EQ_R:		case OP_EQ_K:		case OP_LT_RR:		case OP_LT_RK:		case OP_LT_KR:
+	case OP_LE_RR:		case OP_LE_RK:		case OP_LE_KR:		case OP_LTU_RR:		case OP_LTU_RK:
+	case OP_LTU_KR:		case OP_LEU_RR:		case OP_LEU_RK:		case OP_LEU_KR:		case OP_EQF_R:
+	case OP_EQF_K:		case OP_LTF_RR:		case OP_LTF_RK:		case OP_LTF_KR:		case OP_LEF_RR:
+	case OP_LEF_RK:		case OP_LEF_KR:		case OP_EQV2_R:		case OP_EQV3_R:		case OP_EQA_R:
+	case OP_EQA_K:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+//==========================================================================
+//
+// VMFunctionBuilder :: OptimizeCode
+//
+// A peephole pass over the finished code: jumps that land on another jump
+// are threaded to the final target, and NOPs and register moves onto
+// themselves (which the code generator emits when an expression already
+// ended up in its destination) are removed.
+//
+//==========================================================================
+
+void VMFunctionBuilder::OptimizeCode()
+{
+	int count = (int)Code.Size();
+
+	for (int i = 0; i < count; i++)
+	{
+		if (Code[i].op != OP_JMP)
+			continue;
+
+		int target = i + 1 + Code[i].i24;
+		for (int n = 0; n < 16 && target >= 0 && target < count && target != i && Code[target].op == OP_JMP; n++)
+			target = target + 1 + Code[target].i24;
+		Code[i].i24 = target - i - 1;
+	}
+
+	// Figure out where each instruction ends up. A removed instruction maps to its successor.
+	TArray<bool> keep(count, true);
+	TArray<int> newpos(count + 1, true);
+	int out = 0;
+	for (int i = 0; i < count; i++)
+	{
+		const VMOP &op = Code[i];
+		bool noop = op.op == OP_NOP ||
+			((op.op == OP_MOVE || op.op == OP_MOVEF || op.op == OP_MOVES || op.op == OP_MOVEA || op.op == OP_MOVEV2 || op.op == OP_MOVEV3) && op.a == op.b);
+		keep[i] = !noop || (i > 0 && IsSkipOp(Code[i - 1].op));
+		newpos[i] = out;
+		if (keep[i]) out++;
+	}
+	newpos[count] = out;
+	if (out == count)
+		return;
+
+	for (int i = 0; i < count; i++)
+	{
+		if (keep[i] && Code[i].op == OP_JMP)
+		{
+			int target = i + 1 + Code[i].i24;
+			assert(target >= 0 && target <= count);
+			Code[i].i24 = newpos[target] - newpos[i] - 1;
+		}
+	}
+	for (int i = 0; i < count; i++)
+	{
+		if (keep[i]) Code[newpos[i]] = Code[i];
+	}
+	Code.Clamp(out);
+
+	// Statements whose code was removed entirely collapse onto the next one.
+	unsigned lines = 0;
+	for (unsigned i = 0; i < LineNumbers.Size(); i++)
+	{
+		FStatementInfo si = LineNumbers[i];
+		si.InstructionIndex = (uint16_t)newpos[si.InstructionIndex];
+		if (lines > 0 && LineNumbers[lines - 1].InstructionIndex == si.InstructionIndex)
+			lines--;
+		LineNumbers[lines++] = si;
+	}
+	LineNumbers.Clamp(lines);
+}
+
 //==========================================================================
 //
 // VMFunctionBuilder :: FillIntConstants
@@ -826,15 +927,16 @@ void FFunctionBuildList::Build()
 		assert(item.Code != NULL);
 
 		// We don't know the return type in advance for anonymous functions.
-		FCompileContext ctx(item.CurGlobals, item.Func, item.Func->SymbolName == NAME_None ? nullptr : item.Func->Variants[0].Proto, item.FromDecorate, item.StateIndex, item.StateCount, item.Lump, item.Version);
+		auto &variant = item.Func->Variants[0];
+		FCompileContext ctx(item.CurGlobals, item.Func, item.Func->SymbolName == NAME_None ? nullptr : variant.Proto, item.FromDecorate, item.StateIndex, item.StateCount, item.Lump, item.Version);
 
 		// Allocate registers for the function's arguments and create local variable nodes before starting to resolve it.
 		VMFunctionBuilder buildit(item.Func->GetImplicitArgs());
-		for (unsigned i = 0; i < item.Func->Variants[0].Proto->ArgumentTypes.Size(); i++)
+		for (unsigned i = 0; i < variant.Proto->ArgumentTypes.Size(); i++)
 		{
-			auto type = item.Func->Variants[0].Proto->ArgumentTypes[i];
-			auto name = item.Func->Variants[0].ArgNames[i];
-			auto flags = item.Func->Variants[0].ArgFlags[i];
+			auto type = variant.Proto->ArgumentTypes[i];
+			auto name = variant.ArgNames[i];
+			auto flags = variant.ArgFlags[i];
 			// this won't get resolved and won't get emitted. It is only needed so that the code generator can retrieve the necessary info about this argument to do its work.
 			auto local = new FxLocalVariableDeclaration(type, name, nullptr, flags, FScriptPosition());
 			if (!(flags & VARF_Out)) local->RegNum = buildit.Registers[type->GetRegType()].Get(type->GetRegCount());
@@ -890,7 +992,7 @@ void FFunctionBuildList::Build()
 				sfunc->NumArgs = 0;
 				// NumArgs for the VMFunction must be the amount of stack elements, which can differ from the amount of logical function arguments if vectors are in the list.
 				// For the VM a vector is 2 or 3 args, depending on size.
-				auto funcVariant = item.Func->Variants[0];
+				auto &funcVariant = item.Func->Variants[0];
 				for (unsigned int i = 0; i < funcVariant.Proto->ArgumentTypes.Size(); i++)
 				{
 					auto argType = funcVariant.Proto->ArgumentTypes[i];
@@ -906,7 +1008,7 @@ void FFunctionBuildList::Build()
 					}
 				}
 
-				disasmdump.Write(sfunc, item.PrintableName);
+				disasmdump.Write(sfunc, item.PrintableName, buildit.GetUnoptimizedCodeSize());
 
 				sfunc->Unsafe = ctx.Unsafe;
 			}
@@ -1132,12 +1234,12 @@ VMDisassemblyDumper::~VMDisassemblyDumper()
 {
 	if (dump != nullptr)
 	{
-		fprintf(dump, "\n*************************************************************************\n%i code bytes\n%i data bytes\n", codesize * 4, datasize);
+		fprintf(dump, "\n*************************************************************************\n%i code bytes (%i before optimization)\n%i data bytes\n", codesize * 4, unoptimizedcodesize * 4, datasize);
 		fclose(dump);
 	}
 }
 
-void VMDisassemblyDumper::Write(VMScriptFunction *sfunc, const FString &fname)
+void VMDisassemblyDumper::Write(VMScriptFunction *sfunc, const FString &fname, unsigned unoptimizedsize)
 {
 	if (dump != nullptr)
 	{
@@ -1149,7 +1251,10 @@ void VMDisassemblyDumper::Write(VMScriptFunction *sfunc, const FString &fname)
 		assert(sfunc != nullptr);
 
 		DumpFunction(dump, sfunc, fname, (int)fname.Len());
+		if (unoptimizedsize == 0) unoptimizedsize = sfunc->CodeSize;
+		fprintf(dump, "%d instructions, %d before optimization\n", sfunc->CodeSize, (int)unoptimizedsize);
 		codesize += sfunc->CodeSize;
+		unoptimizedcodesize += unoptimizedsize;
 		datasize += sfunc->LineInfoCount * sizeof(FStatementInfo) + sfunc->ExtraSpace + sfunc->NumKonstD * sizeof(int) +
 			sfunc->NumKonstA * sizeof(void*) + sfunc->NumKonstF * sizeof(double) + sfunc->NumKonstS * sizeof(FString);
 	}
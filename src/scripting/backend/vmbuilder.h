@@ -59,6 +59,9 @@ public:
 	void EndStatement();
 	void MakeFunction(VMScriptFunction *func);
 
+	// Instruction count before MakeFunction's peephole pass.
+	unsigned GetUnoptimizedCodeSize() const { return UnoptimizedCodeSize; }
+
 	// Returns the constant register holding the value.
 	unsigned GetConstantInt(int val);
 	unsigned GetConstantFloat(double val);
@@ -123,6 +126,10 @@ private:
 	int ActiveParam;
 
 	TArray<VMOP> Code;
+	unsigned UnoptimizedCodeSize = 0;
+
+	void OptimizeCode();
+	static bool IsSkipOp(int op);
 
 };
 
@@ -223,13 +230,14 @@ public:
 	explicit VMDisassemblyDumper(const FileOperationType operation);
 	~VMDisassemblyDumper();
 
-	void Write(VMScriptFunction *sfunc, const FString &fname);
+	void Write(VMScriptFunction *sfunc, const FString &fname, unsigned unoptimizedsize = 0);
 	void Flush();
 
 private:
 	FILE *dump = nullptr;
 	FString namefilter;
 	int codesize = 0;
+	int unoptimizedcodesize = 0;
 	int datasize = 0;
 };
 
@@ -1353,10 +1353,59 @@ void ParseDecorate (FScanner &sc, PNamespace *ns)
 	}
 }
 
+//==========================================================================
+//
+// Reads all DECORATE lumps and the lumps they include ahead of parsing,
+// one level of includes at a time, so that compressed lumps get inflated
+// in parallel. Includes are found with a plain text search, so one inside
+// a comment at worst preloads a lump that isn't needed.
+//
+//==========================================================================
+
+static void PreloadDecorate()
+{
+	TArray<int> wave, seen;
+	int lastlump = 0, lump;
+
+	while ((lump = Wads.FindLump("DECORATE", &lastlump)) != -1)
+	{
+		wave.Push(lump);
+	}
+
+	while (wave.Size() > 0 && FScanner::PreloadLumps(wave))
+	{
+		seen.Append(wave);
+		TArray<int> next;
+		for (int lumpnum : wave)
+		{
+			FScanner sc(lumpnum);
+			const char *end;
+			const char *p = sc.GetRawPos(&end);
+			for (; p != nullptr && end - p > 8; p++)
+			{
+				if (*p != '#' || strnicmp(p, "#include", 8)) continue;
+				p += 8;
+				while (p < end && (*p == ' ' || *p == '\t')) p++;
+				if (p >= end || *p != '"') continue;
+
+				const char *name = ++p;
+				while (p < end && *p != '"' && *p != '\n') p++;
+				int inc = Wads.CheckNumForFullName(FString(name, p - name), true);
+				if (inc >= 0 && seen.Find(inc) == seen.Size() && next.Find(inc) == next.Size())
+				{
+					next.Push(inc);
+				}
+			}
+		}
+		wave = std::move(next);
+	}
+}
+
 void ParseAllDecorate()
 {
 	int lastlump = 0, lump;
 
+	PreloadDecorate();
 	while ((lump = Wads.FindLump("DECORATE", &lastlump)) != -1)
 	{
 		FScanner sc(lump);
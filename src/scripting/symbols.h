@@ -225,7 +225,7 @@ struct PSymbolTable
 	// Frees all symbols from this table.
 	void ReleaseSymbols();
 
-	typedef TMap<FName, PSymbol *> MapType;
+	typedef TFlatMap<FName, PSymbol *> MapType;
 
 	MapType::Iterator GetIterator()
 	{
@@ -466,20 +466,27 @@ void SynthesizeFlagFields();
 
 void LoadActors()
 {
-	cycle_t timer;
+	cycle_t timer, zscripttimer, decoratetimer, codegentimer;
 
 	timer.Reset(); timer.Clock();
+	zscripttimer.Reset(); decoratetimer.Reset(); codegentimer.Reset();
 	FScriptPosition::ResetErrorCounter();
 
 	InitThingdef();
 	FScriptPosition::StrictErrors = true;
+	zscripttimer.Clock();
 	ParseScripts();
+	zscripttimer.Unclock();
 
 	FScriptPosition::StrictErrors = false;
+	decoratetimer.Clock();
 	ParseAllDecorate();
 	SynthesizeFlagFields();
+	decoratetimer.Unclock();
 
+	codegentimer.Clock();
 	FunctionBuildList.Build();
+	codegentimer.Unclock();
 
 	if (FScriptPosition::ErrorCounter > 0)
 	{
@@ -544,6 +551,9 @@ void LoadActors()
 
 	timer.Unclock();
 	if (!batchrun) Printf("script parsing took %.2f ms\n", timer.TimeMS());
+	DPrintf(DMSG_NOTIFY, "ZScript: %.2f ms, DECORATE: %.2f ms, code generation: %.2f ms, postprocessing: %.2f ms\n",
+		zscripttimer.TimeMS(), decoratetimer.TimeMS(), codegentimer.TimeMS(),
+		timer.TimeMS() - zscripttimer.TimeMS() - decoratetimer.TimeMS() - codegentimer.TimeMS());
 
 	// Now we may call the scripted OnDestroy method.
 	PClass::bVMOperational = true;
@@ -1,6 +1,7 @@
 
 #include "jit.h"
 #include "jitintern.h"
+#include "stats.h"
 
 extern PString *TypeString;
 extern PStruct *TypeVector2;
@@ -15,6 +16,7 @@ JitFuncPtr JitCompile(VMScriptFunction *sfunc)
 		return nullptr;
 #endif
 
+	uint64_t hitchstart = FHitchLog::Start();
 	using namespace asmjit;
 	StringLogger logger;
 	try
@@ -26,7 +28,9 @@ JitFuncPtr JitCompile(VMScriptFunction *sfunc)
 		code.setLogger(&logger);
 
 		JitCompiler compiler(&code, sfunc);
-		return reinterpret_cast<JitFuncPtr>(AddJitFunction(&code, &compiler));
+		auto func = reinterpret_cast<JitFuncPtr>(AddJitFunction(&code, &compiler));
+		if (hitchstart) FHitchLog::Note(hitchstart, "JIT", "%s", sfunc->PrintableName.GetChars());
+		return func;
 	}
 	catch (const CRecoverableError &e)
 	{
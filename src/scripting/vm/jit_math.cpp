@@ -945,6 +945,10 @@ void JitCompiler::EmitFLOP()
 			cc.movsd(regF[A], regF[B]);
 		cc.xorpd(regF[A], maskXmm);
 	}
+	else if (C == FLOP_SQRT)
+	{
+		CallSqrt(regF[A], regF[B]);
+	}
 	else
 	{
 		auto v = newTempXmmSd();
@@ -967,7 +971,6 @@ void JitCompiler::EmitFLOP()
 		case FLOP_EXP:		func = g_exp; break;
 		case FLOP_LOG:		func = g_log; break;
 		case FLOP_LOG10:	func = g_log10; break;
-		case FLOP_SQRT:		func = g_sqrt; break;
 		case FLOP_CEIL:		func = ceil; break;
 		case FLOP_FLOOR:	func = floor; break;
 		case FLOP_ACOS:		func = g_acos; break;
@@ -1513,11 +1516,8 @@ void JitCompiler::EmitEQA_K()
 	});
 }
 
+// sqrtsd is correctly rounded, so it gives the same result as g_sqrt without the call.
 void JitCompiler::CallSqrt(const asmjit::X86Xmm &a, const asmjit::X86Xmm &b)
 {
-	auto result = newResultXmmSd();
-	auto call = CreateCall<double, double>(g_sqrt);
-	call->setRet(0, result);
-	call->setArg(0, b);
-	cc.movsd(a, result);
+	cc.sqrtsd(a, b);
 }
@@ -54,6 +54,7 @@ extern FMemArena ClassDataAllocator;
 #define MAX_TRY_DEPTH	8	// Maximum number of nested TRYs in a single function
 
 void JitRelease();
+void VMProfileRelease();
 
 
 typedef unsigned char		VM_UBYTE;
@@ -434,6 +435,7 @@ public:
 		AllFunctions.Clear();
 		// also release any JIT data
 		JitRelease();
+		VMProfileRelease();
 	}
 	static void CreateRegUseInfo()
 	{
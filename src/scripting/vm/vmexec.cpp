@@ -169,8 +169,8 @@ void VMSelectEngine(EVMEngine engine)
 #ifdef NDEBUG
 		VMExec = VMExec_Unchecked::Exec;
 #else
-#endif
 		VMExec = VMExec_Checked::Exec;
+#endif
 		break;
 	case VMEngine_Unchecked:
 		VMExec = VMExec_Unchecked::Exec;
@@ -393,7 +393,7 @@ VMFrameStack::~VMFrameStack()
 
 VMFrame *VMFrameStack::AllocFrame(VMScriptFunction *func)
 {
-	VMFrame *frame = Alloc(func->StackSize);
+	VMFrame *frame = Alloc(func->StackSize, func->MaxParam * sizeof(VMValue));
 	frame->Func = func;
 	frame->NumRegD = func->NumRegD;
 	frame->NumRegF = func->NumRegF;
@@ -414,11 +414,12 @@ VMFrame *VMFrameStack::AllocFrame(VMScriptFunction *func)
 // VMFrameStack :: Alloc
 //
 // Allocates space for a frame. Its size will be rounded up to a multiple
-// of 16 bytes.
+// of 16 bytes. Everything but the parameter area is cleared; parameters
+// are always written by OP_PARAM before a call reads them.
 //
 //===========================================================================
 
-VMFrame *VMFrameStack::Alloc(int size)
+VMFrame *VMFrameStack::Alloc(int size, int paramsize)
 {
 	BlockHeader *block;
 	VMFrame *frame, *parent;
@@ -441,6 +442,10 @@ VMFrame *VMFrameStack::Alloc(int size)
 		{
 			blocksize = BLOCK_SIZE;
 		}
+		if (Blocks == NULL && UnusedBlocks == NULL && blocksize < INITIAL_BLOCK_SIZE)
+		{
+			blocksize = INITIAL_BLOCK_SIZE;
+		}
 		for (blockp = &UnusedBlocks, block = *blockp; block != NULL; block = block->NextBlock)
 		{
 			if (block->BlockSize >= blocksize)
@@ -463,7 +468,9 @@ VMFrame *VMFrameStack::Alloc(int size)
 		Blocks = block;
 	}
 	frame = (VMFrame *)block->FreeSpace;
-	memset(frame, 0, size);
+	const int headsize = (sizeof(VMFrame) + 15) & ~15;
+	memset(frame, 0, headsize);
+	memset((VM_UBYTE *)frame + headsize + paramsize, 0, size - headsize - paramsize);
 	frame->ParentFrame = parent;
 	block->FreeSpace += size;
 	block->LastFrame = frame;
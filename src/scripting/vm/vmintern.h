@@ -361,7 +361,11 @@ public:
 	}
 	static int OffsetLastFrame() { return (int)(ptrdiff_t)offsetof(BlockHeader, LastFrame); }
 private:
-	enum { BLOCK_SIZE = 4096 };		// Default block size
+	enum
+	{
+		BLOCK_SIZE = 4096,					// Default block size
+		INITIAL_BLOCK_SIZE = 1024 * 1024	// The first block is big enough that ordinary call chains never leave it
+	};
 	struct BlockHeader
 	{
 		BlockHeader *NextBlock;
@@ -376,7 +380,7 @@ private:
 	};
 	BlockHeader *Blocks;
 	BlockHeader *UnusedBlocks;
-	VMFrame *Alloc(int size);
+	VMFrame *Alloc(int size, int paramsize);
 };
 
 class VMParamFiller
@@ -0,0 +1,417 @@
+/*
+** vmprofile.cpp
+** Call tree profiler for script functions
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**---------------------------------------------------------------------------
+**
+** Every call into a script function, from the VM, the JIT or native code,
+** goes through VMFunction::ScriptCall. While profiling, that pointer is
+** swapped for a trampoline that times the call and records it in a call
+** tree, so interpreted and compiled code are measured the same way.
+**
+** vmbench runs the script benchmarks in zscript/vmbench.zs and reports
+** their throughput under the JIT and the interpreter.
+**
+*/
+
+#include <algorithm>
+#include "dobject.h"
+#include "c_dispatch.h"
+#include "i_time.h"
+#include "v_text.h"
+#include "vmintern.h"
+#include "types.h"
+#include "c_cvars.h"
+
+EXTERN_CVAR(Bool, vm_jit)
+
+struct VMProfileNode
+{
+	VMFunction *Func = nullptr;
+	VMProfileNode *Parent = nullptr;
+	TArray<VMProfileNode *> Children;
+	uint64_t Inclusive = 0;
+	uint64_t Exclusive = 0;
+	unsigned Calls = 0;
+
+	~VMProfileNode()
+	{
+		for (auto child : Children) delete child;
+	}
+
+	VMProfileNode *GetChild(VMFunction *func)
+	{
+		for (auto child : Children)
+		{
+			if (child->Func == func) return child;
+		}
+		auto child = new VMProfileNode;
+		child->Func = func;
+		child->Parent = this;
+		Children.Push(child);
+		return child;
+	}
+};
+
+struct VMProfileTotals
+{
+	VMFunction *Func;
+	uint64_t Inclusive;
+	uint64_t Exclusive;
+	unsigned Calls;
+};
+
+static bool ProfileActive;
+static VMProfileNode *ProfileRoot;
+static VMProfileNode *ProfileCurrent;
+static uint64_t ProfileStartTime, ProfileTotalTime;
+static TMap<VMFunction *, JitFuncPtr> ProfileOriginalCalls;
+
+//==========================================================================
+//
+// ProfiledScriptCall
+//
+//==========================================================================
+
+static int ProfiledScriptCall(VMFunction *func, VMValue *params, int numparams, VMReturn *ret, int numret)
+{
+	JitFuncPtr *original = ProfileOriginalCalls.CheckKey(func);
+	assert(original != nullptr);
+
+	// Restores the caller's node even if the call throws.
+	struct Scope
+	{
+		VMProfileNode *Node, *Caller;
+		uint64_t Start;
+		~Scope()
+		{
+			uint64_t elapsed = I_nsTime() - Start;
+			Node->Inclusive += elapsed;
+			Node->Exclusive += elapsed;
+			if (Caller->Func != nullptr) Caller->Exclusive -= elapsed;
+			ProfileCurrent = Caller;
+		}
+	} scope = { ProfileCurrent->GetChild(func), ProfileCurrent, 0 };
+
+	scope.Node->Calls++;
+	ProfileCurrent = scope.Node;
+	scope.Start = I_nsTime();
+
+	int result = (*original)(func, params, numparams, ret, numret);
+
+	// FirstScriptCall installs the real entry point on the first call. Keep profiling it.
+	if (ProfileActive && func->ScriptCall != ProfiledScriptCall)
+	{
+		ProfileOriginalCalls[func] = func->ScriptCall;
+		func->ScriptCall = ProfiledScriptCall;
+	}
+	return result;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+static void VMProfileStart()
+{
+	if (ProfileActive) return;
+
+	if (ProfileRoot == nullptr)
+	{
+		ProfileRoot = new VMProfileNode;
+		ProfileTotalTime = 0;
+	}
+	ProfileCurrent = ProfileRoot;
+
+	for (auto func : VMFunction::AllFunctions)
+	{
+		if (!(func->VarFlags & VARF_Native) && func->ScriptCall != nullptr)
+		{
+			ProfileOriginalCalls[func] = func->ScriptCall;
+			func->ScriptCall = ProfiledScriptCall;
+		}
+	}
+	ProfileStartTime = I_nsTime();
+	ProfileActive = true;
+}
+
+static void VMProfileStop()
+{
+	if (!ProfileActive) return;
+
+	// Functions still inside a profiled call are unwound by their Scope, which only touches the tree.
+	TMap<VMFunction *, JitFuncPtr>::Iterator it(ProfileOriginalCalls);
+	TMap<VMFunction *, JitFuncPtr>::Pair *pair;
+	while (it.NextPair(pair))
+	{
+		if (pair->Key->ScriptCall == ProfiledScriptCall)
+			pair->Key->ScriptCall = pair->Value;
+	}
+	ProfileTotalTime += I_nsTime() - ProfileStartTime;
+	ProfileActive = false;
+}
+
+void VMProfileRelease()
+{
+	// The functions themselves are about to go away. Nothing must be restored.
+	ProfileOriginalCalls.Clear();
+	ProfileActive = false;
+	if (ProfileCurrent == ProfileRoot)
+	{
+		delete ProfileRoot;
+		ProfileRoot = ProfileCurrent = nullptr;
+	}
+}
+
+//==========================================================================
+//
+// Sums up the call tree per function. Recursive calls only count
+// towards inclusive time at their outermost level.
+//
+//==========================================================================
+
+static void CollectTotals(VMProfileNode *node, TMap<VMFunction *, unsigned> &index, TArray<VMProfileTotals> &totals, TArray<VMFunction *> &path)
+{
+	for (auto child : node->Children)
+	{
+		unsigned *pos = index.CheckKey(child->Func);
+		if (pos == nullptr)
+		{
+			index[child->Func] = totals.Size();
+			totals.Push({ child->Func, 0, 0, 0 });
+			pos = index.CheckKey(child->Func);
+		}
+		auto &entry = totals[*pos];
+		if (path.Find(child->Func) == path.Size())
+			entry.Inclusive += child->Inclusive;
+		entry.Exclusive += child->Exclusive;
+		entry.Calls += child->Calls;
+
+		path.Push(child->Func);
+		CollectTotals(child, index, totals, path);
+		path.Pop();
+	}
+}
+
+static void VMProfileReport(unsigned limit)
+{
+	if (ProfileRoot == nullptr)
+	{
+		Printf("No script profile has been recorded\n");
+		return;
+	}
+
+	TMap<VMFunction *, unsigned> index;
+	TArray<VMProfileTotals> totals;
+	TArray<VMFunction *> path;
+	CollectTotals(ProfileRoot, index, totals, path);
+	std::sort(totals.begin(), totals.end(), [](const VMProfileTotals &a, const VMProfileTotals &b) { return a.Exclusive > b.Exclusive; });
+
+	uint64_t elapsed = ProfileTotalTime + (ProfileActive ? I_nsTime() - ProfileStartTime : 0);
+	Printf(TEXTCOLOR_YELLOW "%10s %10s %10s %9s  %s\n", "Self ms", "Total ms", "Calls", "Self %", "Function");
+	for (unsigned i = 0; i < totals.Size() && (limit == 0 || i < limit); i++)
+	{
+		auto &entry = totals[i];
+		Printf("%10.3f %10.3f %10u %8.2f%%  %s\n", entry.Exclusive / 1e6, entry.Inclusive / 1e6, entry.Calls,
+			elapsed > 0 ? entry.Exclusive * 100.0 / elapsed : 0.0, entry.Func->PrintableName.GetChars());
+	}
+	Printf("%.3f ms profiled\n", elapsed / 1e6);
+}
+
+//==========================================================================
+//
+// Writes the call tree in the folded stack format read by flamegraph.pl
+// and compatible viewers, one line per call path with its self time in
+// microseconds.
+//
+//==========================================================================
+
+static void WriteFolded(FILE *file, VMProfileNode *node, FString &path)
+{
+	for (auto child : node->Children)
+	{
+		size_t len = path.Len();
+		if (len > 0) path += ';';
+		path += child->Func->PrintableName;
+
+		uint64_t us = child->Exclusive / 1000;
+		if (us > 0) fprintf(file, "%s %llu\n", path.GetChars(), (unsigned long long)us);
+		WriteFolded(file, child, path);
+
+		path.Truncate(len);
+	}
+}
+
+static void VMProfileDump(const char *filename)
+{
+	if (ProfileRoot == nullptr)
+	{
+		Printf("No script profile has been recorded\n");
+		return;
+	}
+
+	FILE *file = fopen(filename, "w");
+	if (file == nullptr)
+	{
+		Printf("Could not open %s for writing\n", filename);
+		return;
+	}
+	FString path;
+	WriteFolded(file, ProfileRoot, path);
+	fclose(file);
+	Printf("Script profile written to %s\n", filename);
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+CCMD(vmprofile)
+{
+	if (argv.argc() >= 2)
+	{
+		if (stricmp(argv[1], "start") == 0)
+		{
+			VMProfileStart();
+			return;
+		}
+		else if (stricmp(argv[1], "stop") == 0)
+		{
+			VMProfileStop();
+			return;
+		}
+		else if (stricmp(argv[1], "clear") == 0)
+		{
+			if (ProfileActive || ProfileCurrent != ProfileRoot)
+			{
+				Printf("Stop the profiler before clearing it\n");
+				return;
+			}
+			delete ProfileRoot;
+			ProfileRoot = ProfileCurrent = nullptr;
+			return;
+		}
+		else if (stricmp(argv[1], "report") == 0)
+		{
+			VMProfileReport(argv.argc() >= 3 ? atoi(argv[2]) : 20);
+			return;
+		}
+		else if (stricmp(argv[1], "dump") == 0)
+		{
+			VMProfileDump(argv.argc() >= 3 ? argv[2] : "vmprofile.folded");
+			return;
+		}
+	}
+	Printf("Usage: vmprofile <start|stop|clear|report [count]|dump [filename]>\n");
+}
+
+//==========================================================================
+//
+// Runs one benchmark function repeatedly. Each call returns the number of
+// operations it performed; the total is reported as operations per second.
+//
+//==========================================================================
+
+static const char *const VMBenchmarks[] = { "DynArrays", "Strings", "Vectors", "VirtualCalls", "ThinkerIteration" };
+
+static void RunBenchmark(VMFunction *func, const char *name, const char *engine, unsigned iterations)
+{
+	int ops = 0;
+	VMReturn ret(&ops);
+	VMCall(func, nullptr, 0, &ret, 1);	// the first call compiles the function
+
+	uint64_t totalops = 0;
+	uint64_t start = I_nsTime();
+	for (unsigned i = 0; i < iterations; i++)
+	{
+		VMCall(func, nullptr, 0, &ret, 1);
+		totalops += ops;
+	}
+	uint64_t elapsed = std::max<uint64_t>(I_nsTime() - start, 1);
+	Printf("%-20s %-12s %14.0f ops/sec %10.1f ns/call\n", name, engine, totalops * 1e9 / elapsed, double(elapsed) / iterations);
+}
+
+//==========================================================================
+//
+// Runs the benchmark with every script function going straight to the
+// interpreter, including calls made from compiled code.
+//
+//==========================================================================
+
+static void RunInterpretedBenchmark(VMFunction *func, const char *name, unsigned iterations)
+{
+	struct Restore
+	{
+		TMap<VMFunction *, JitFuncPtr> Calls;
+		~Restore()
+		{
+			TMap<VMFunction *, JitFuncPtr>::Iterator it(Calls);
+			TMap<VMFunction *, JitFuncPtr>::Pair *pair;
+			while (it.NextPair(pair)) pair->Key->ScriptCall = pair->Value;
+		}
+	} restore;
+
+	for (auto f : VMFunction::AllFunctions)
+	{
+		if (!(f->VarFlags & (VARF_Native | VARF_Abstract)) && f->ScriptCall != nullptr)
+		{
+			restore.Calls[f] = f->ScriptCall;
+			f->ScriptCall = VMExec;
+		}
+	}
+	RunBenchmark(func, name, "interpreter", iterations);
+}
+
+CCMD(vmbench)
+{
+	if (ProfileActive)
+	{
+		Printf("Stop the profiler before running benchmarks\n");
+		return;
+	}
+
+	const char *only = argv.argc() >= 2 && stricmp(argv[1], "all") != 0 ? argv[1] : nullptr;
+	unsigned iterations = argv.argc() >= 3 ? std::max(atoi(argv[2]), 1) : 1000;
+	bool found = false;
+
+	for (auto name : VMBenchmarks)
+	{
+		if (only != nullptr && stricmp(only, name) != 0) continue;
+		found = true;
+
+		VMFunction *func = PClass::FindFunction("VMBench", name);
+		if (func == nullptr || func->Proto == nullptr || func->Proto->ArgumentTypes.Size() != 0 || func->Proto->ReturnTypes.Size() != 1)
+		{
+			Printf("VMBench.%s is missing or not a static int function\n", name);
+			continue;
+		}
+		RunBenchmark(func, name, vm_jit ? "jit" : "interpreter", iterations);
+		if (vm_jit) RunInterpretedBenchmark(func, name, iterations);
+	}
+	if (!found)
+	{
+		Printf("Usage: vmbench [all|");
+		for (auto name : VMBenchmarks) Printf("%s%s", name, name == VMBenchmarks[countof(VMBenchmarks) - 1] ? "" : "|");
+		Printf("] [iterations]\n");
+	}
+}
@@ -95,7 +95,7 @@ DEFINE_ACTION_FUNCTION_NATIVE(DThinkerIterator, Reinit, ReinitThinker)
 class DBlockLinesIterator : public DObject
 {
 	DECLARE_ABSTRACT_CLASS(DBlockLinesIterator, DObject);
-	FPortalGroupArray check;
+	FPortalGroupArray check { FPortalGroupArray::PGA_CheckPosition, true };
 
 public:
 	FMultiBlockLinesIterator iterator;
@@ -171,7 +171,7 @@ DEFINE_ACTION_FUNCTION_NATIVE(DBlockLinesIterator, Next, BLINext)
 class DBlockThingsIterator : public DObject
 {
 	DECLARE_ABSTRACT_CLASS(DBlockThingsIterator, DObject);
-	FPortalGroupArray check;
+	FPortalGroupArray check { FPortalGroupArray::PGA_CheckPosition, true };
 public:
 	FMultiBlockThingsIterator iterator;
 	FMultiBlockThingsIterator::CheckResult cres;
@@ -179,6 +179,7 @@ public:
 	DBlockThingsIterator(AActor *origin, double checkradius = -1, bool ignorerestricted = false)
 		: iterator(check, origin, checkradius, ignorerestricted)
 	{
+		iterator.SetPersistent();
 		cres.thing = nullptr;
 		cres.Position.Zero();
 		cres.portalflags = 0;
@@ -187,6 +188,7 @@ public:
 	DBlockThingsIterator(double checkx, double checky, double checkz, double checkh, double checkradius, bool ignorerestricted, sector_t *newsec)
 		: iterator(check, checkx, checky, checkz, checkh, checkradius, ignorerestricted, newsec)
 	{
+		iterator.SetPersistent();
 		cres.thing = nullptr;
 		cres.Position.Zero();
 		cres.portalflags = 0;
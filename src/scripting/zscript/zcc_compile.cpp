@@ -2721,6 +2721,7 @@ void ZCCCompiler::CompileFunction(ZCC_StructWork *c, ZCC_FuncDeclarator *f, bool
 		if (f->Flags & ZCC_Abstract) varflags |= VARF_Abstract;
 		if (f->Flags & ZCC_VarArg) varflags |= VARF_VarArg;
 		if (f->Flags & ZCC_FuncConst) varflags |= VARF_ReadOnly; // FuncConst method is internally marked as VARF_ReadOnly
+		if ((f->Flags & ZCC_Final) && mVersion >= MakeVersion(4, 6)) varflags |= VARF_Final;	// older scripts accepted 'final' but ignored it, so they may still override such methods.
 		if (mVersion >= MakeVersion(2, 4, 0))
 		{
 			if (c->Type()->ScopeFlags & Scope_UI)
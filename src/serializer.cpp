@@ -146,6 +146,272 @@ struct FJSONObject
 	}
 };
 
+//==========================================================================
+//
+// Binary encoding of the same document structure the JSON writer creates.
+// It skips all number formatting and parsing, and keys are written only the
+// first time they occur and referred to by index after that. The reader
+// builds the same rapidjson DOM from it so nothing else needs to know which
+// format was used.
+//
+//==========================================================================
+
+static const char BinaryMagic[4] = { 'Z', 'B', 'S', 'V' };
+enum { BINARY_VERSION = 1 };
+
+enum EBinaryToken
+{
+	BT_StartObject = 1,
+	BT_EndObject,
+	BT_StartArray,
+	BT_EndArray,
+	BT_NewKey,		// length, text. Gets the next key index.
+	BT_Key,			// key index
+	BT_Null,
+	BT_True,
+	BT_False,
+	BT_Int,			// zigzag varint
+	BT_Int64,		// zigzag varint
+	BT_Uint,		// varint
+	BT_Uint64,		// varint
+	BT_Double,		// 8 bytes
+	BT_String,		// length, text
+};
+
+class FBinaryWriter
+{
+	rapidjson::StringBuffer &mOut;
+	TArray<FString> mKeys;
+	TArray<unsigned> mKeyTable;		// open addressing, key index + 1, 0 is free
+
+	void Byte(uint8_t b)
+	{
+		mOut.Put((char)b);
+	}
+
+	void Varint(uint64_t v)
+	{
+		while (v >= 0x80)
+		{
+			Byte(uint8_t(v | 0x80));
+			v >>= 7;
+		}
+		Byte(uint8_t(v));
+	}
+
+	void SignedVarint(int64_t v)
+	{
+		Varint((uint64_t(v) << 1) ^ uint64_t(v >> 63));
+	}
+
+	void Text(const char *s, size_t len)
+	{
+		Varint(len);
+		memcpy(mOut.Push(len), s, len);
+	}
+
+	// Returns the slot for the key, which is either free or holds this key.
+	unsigned &FindKeySlot(const char *k)
+	{
+		unsigned mask = mKeyTable.Size() - 1;
+		unsigned slot = MakeKey(k) & mask;
+		while (mKeyTable[slot] != 0 && mKeys[mKeyTable[slot] - 1].Compare(k) != 0)
+		{
+			slot = (slot + 1) & mask;
+		}
+		return mKeyTable[slot];
+	}
+
+	void GrowKeyTable()
+	{
+		mKeyTable.Resize(mKeyTable.Size() * 2);
+		memset(mKeyTable.Data(), 0, mKeyTable.Size() * sizeof(unsigned));
+		for (unsigned i = 0; i < mKeys.Size(); i++)
+		{
+			FindKeySlot(mKeys[i]) = i + 1;
+		}
+	}
+
+public:
+	FBinaryWriter(rapidjson::StringBuffer &out) : mOut(out)
+	{
+		mKeyTable.Resize(1024);
+		memset(mKeyTable.Data(), 0, mKeyTable.Size() * sizeof(unsigned));
+		memcpy(mOut.Push(sizeof(BinaryMagic)), BinaryMagic, sizeof(BinaryMagic));
+		Byte(BINARY_VERSION);
+	}
+
+	void StartObject() { Byte(BT_StartObject); }
+	void EndObject() { Byte(BT_EndObject); }
+	void StartArray() { Byte(BT_StartArray); }
+	void EndArray() { Byte(BT_EndArray); }
+	void Null() { Byte(BT_Null); }
+	void Bool(bool k) { Byte(k ? BT_True : BT_False); }
+	void Int(int32_t k) { Byte(BT_Int); SignedVarint(k); }
+	void Int64(int64_t k) { Byte(BT_Int64); SignedVarint(k); }
+	void Uint(uint32_t k) { Byte(BT_Uint); Varint(k); }
+	void Uint64(uint64_t k) { Byte(BT_Uint64); Varint(k); }
+	void String(const char *k) { Byte(BT_String); Text(k, strlen(k)); }
+
+	void Double(double k)
+	{
+		Byte(BT_Double);
+		memcpy(mOut.Push(sizeof(double)), &k, sizeof(double));
+	}
+
+	void Key(const char *k)
+	{
+		unsigned &slot = FindKeySlot(k);
+		if (slot != 0)
+		{
+			Byte(BT_Key);
+			Varint(slot - 1);
+			return;
+		}
+		mKeys.Push(k);
+		slot = mKeys.Size();
+		Byte(BT_NewKey);
+		Text(k, strlen(k));
+		if (mKeys.Size() * 2 > mKeyTable.Size()) GrowKeyTable();
+	}
+};
+
+//==========================================================================
+//
+// Feeds the contents of a binary document to a rapidjson handler, for
+// Document::Populate.
+//
+//==========================================================================
+
+class FBinaryGenerator
+{
+	const uint8_t *mPos, *mEnd;
+	TArray<std::pair<const char *, unsigned>> mKeys;
+
+	bool Varint(uint64_t &v)
+	{
+		v = 0;
+		for (int shift = 0; shift < 64 && mPos < mEnd; shift += 7)
+		{
+			uint8_t b = *mPos++;
+			v |= uint64_t(b & 0x7f) << shift;
+			if (!(b & 0x80)) return true;
+		}
+		return false;
+	}
+
+	bool SignedVarint(int64_t &v)
+	{
+		uint64_t u;
+		if (!Varint(u)) return false;
+		v = int64_t(u >> 1) ^ -int64_t(u & 1);
+		return true;
+	}
+
+	bool Text(const char *&s, unsigned &len)
+	{
+		uint64_t l;
+		if (!Varint(l) || l > uint64_t(mEnd - mPos)) return false;
+		s = (const char *)mPos;
+		len = (unsigned)l;
+		mPos += l;
+		return true;
+	}
+
+public:
+	FBinaryGenerator(const char *buffer, size_t length)
+	{
+		mPos = (const uint8_t *)buffer + sizeof(BinaryMagic) + 1;
+		mEnd = (const uint8_t *)buffer + length;
+	}
+
+	static bool IsBinary(const char *buffer, size_t length)
+	{
+		return length > sizeof(BinaryMagic) && !memcmp(buffer, BinaryMagic, sizeof(BinaryMagic)) && buffer[sizeof(BinaryMagic)] == BINARY_VERSION;
+	}
+
+	template<class Handler> bool operator()(Handler &h)
+	{
+		// Members of each open object or elements of each open array.
+		// Object members are counted by their keys, array elements by their values.
+		TArray<unsigned> counts;
+		TArray<bool> inobject;
+		const char *s;
+		unsigned len;
+		uint64_t u;
+		int64_t i;
+		double d;
+
+		while (mPos < mEnd)
+		{
+			uint8_t token = *mPos++;
+			if (token != BT_EndObject && token != BT_EndArray && token != BT_NewKey && token != BT_Key)
+			{
+				if (counts.Size() > 0 && !inobject.Last()) counts.Last()++;
+			}
+			switch (token)
+			{
+			case BT_StartObject:
+			case BT_StartArray:
+				counts.Push(0);
+				inobject.Push(token == BT_StartObject);
+				if (!(token == BT_StartObject ? h.StartObject() : h.StartArray())) return false;
+				break;
+
+			case BT_EndObject:
+			case BT_EndArray:
+				if (counts.Size() == 0 || inobject.Last() != (token == BT_EndObject)) return false;
+				if (!(token == BT_EndObject ? h.EndObject(counts.Last()) : h.EndArray(counts.Last()))) return false;
+				counts.Pop();
+				inobject.Pop();
+				if (counts.Size() == 0) return true;	// the root is complete.
+				break;
+
+			case BT_NewKey:
+			case BT_Key:
+				if (counts.Size() == 0 || !inobject.Last()) return false;
+				if (token == BT_NewKey)
+				{
+					if (!Text(s, len)) return false;
+					mKeys.Push(std::make_pair(s, len));
+				}
+				else
+				{
+					if (!Varint(u) || u >= mKeys.Size()) return false;
+					s = mKeys[(unsigned)u].first;
+					len = mKeys[(unsigned)u].second;
+				}
+				counts.Last()++;
+				if (!h.Key(s, len, true)) return false;
+				break;
+
+			case BT_Null:	if (!h.Null()) return false; break;
+			case BT_True:	if (!h.Bool(true)) return false; break;
+			case BT_False:	if (!h.Bool(false)) return false; break;
+			case BT_Int:	if (!SignedVarint(i) || !h.Int((int)i)) return false; break;
+			case BT_Int64:	if (!SignedVarint(i) || !h.Int64(i)) return false; break;
+			case BT_Uint:	if (!Varint(u) || !h.Uint((unsigned)u)) return false; break;
+			case BT_Uint64:	if (!Varint(u) || !h.Uint64(u)) return false; break;
+
+			case BT_Double:
+				if (mEnd - mPos < (ptrdiff_t)sizeof(double)) return false;
+				memcpy(&d, mPos, sizeof(double));
+				mPos += sizeof(double);
+				if (!h.Double(d)) return false;
+				break;
+
+			case BT_String:
+				if (!Text(s, len) || !h.String(s, len, true)) return false;
+				break;
+
+			default:
+				return false;
+			}
+		}
+		return false;
+	}
+};
+
 //==========================================================================
 //
 // some wrapper stuff to keep the RapidJSON dependencies out of the global headers.
@@ -160,14 +426,21 @@ struct FWriter
 
 	Writer *mWriter1;
 	PrettyWriter *mWriter2;
+	FBinaryWriter *mWriter3 = nullptr;
 	TArray<bool> mInObject;
 	rapidjson::StringBuffer mOutString;
 	TArray<DObject *> mDObjects;
 	TMap<DObject *, int> mObjectMap;
 	
-	FWriter(bool pretty)
+	FWriter(bool pretty, bool binary = false)
 	{
-		if (!pretty)
+		if (binary)
+		{
+			mWriter1 = nullptr;
+			mWriter2 = nullptr;
+			mWriter3 = new FBinaryWriter(mOutString);
+		}
+		else if (!pretty)
 		{
 			mWriter1 = new Writer(mOutString);
 			mWriter2 = nullptr;
@@ -183,6 +456,7 @@ struct FWriter
 	{
 		if (mWriter1) delete mWriter1;
 		if (mWriter2) delete mWriter2;
+		if (mWriter3) delete mWriter3;
 	}
 
 
@@ -195,36 +469,42 @@ struct FWriter
 	{
 		if (mWriter1) mWriter1->StartObject();
 		else if (mWriter2) mWriter2->StartObject();
+		else if (mWriter3) mWriter3->StartObject();
 	}
 
 	void EndObject()
 	{
 		if (mWriter1) mWriter1->EndObject();
 		else if (mWriter2) mWriter2->EndObject();
+		else if (mWriter3) mWriter3->EndObject();
 	}
 
 	void StartArray()
 	{
 		if (mWriter1) mWriter1->StartArray();
 		else if (mWriter2) mWriter2->StartArray();
+		else if (mWriter3) mWriter3->StartArray();
 	}
 
 	void EndArray()
 	{
 		if (mWriter1) mWriter1->EndArray();
 		else if (mWriter2) mWriter2->EndArray();
+		else if (mWriter3) mWriter3->EndArray();
 	}
 
 	void Key(const char *k)
 	{
 		if (mWriter1) mWriter1->Key(k);
 		else if (mWriter2) mWriter2->Key(k);
+		else if (mWriter3) mWriter3->Key(k);
 	}
 
 	void Null()
 	{
 		if (mWriter1) mWriter1->Null();
 		else if (mWriter2) mWriter2->Null();
+		else if (mWriter3) mWriter3->Null();
 	}
 
 	void StringU(const char *k, bool encode)
@@ -232,6 +512,7 @@ struct FWriter
 		if (encode) k = StringToUnicode(k);
 		if (mWriter1) mWriter1->String(k);
 		else if (mWriter2) mWriter2->String(k);
+		else if (mWriter3) mWriter3->String(k);
 	}
 
 	void String(const char *k)
@@ -239,6 +520,7 @@ struct FWriter
 		k = StringToUnicode(k);
 		if (mWriter1) mWriter1->String(k);
 		else if (mWriter2) mWriter2->String(k);
+		else if (mWriter3) mWriter3->String(k);
 	}
 
 	void String(const char *k, int size)
@@ -246,36 +528,42 @@ struct FWriter
 		k = StringToUnicode(k, size);
 		if (mWriter1) mWriter1->String(k);
 		else if (mWriter2) mWriter2->String(k);
+		else if (mWriter3) mWriter3->String(k);
 	}
 
 	void Bool(bool k)
 	{
 		if (mWriter1) mWriter1->Bool(k);
 		else if (mWriter2) mWriter2->Bool(k);
+		else if (mWriter3) mWriter3->Bool(k);
 	}
 
 	void Int(int32_t k)
 	{
 		if (mWriter1) mWriter1->Int(k);
 		else if (mWriter2) mWriter2->Int(k);
+		else if (mWriter3) mWriter3->Int(k);
 	}
 
 	void Int64(int64_t k)
 	{
 		if (mWriter1) mWriter1->Int64(k);
 		else if (mWriter2) mWriter2->Int64(k);
+		else if (mWriter3) mWriter3->Int64(k);
 	}
 
 	void Uint(uint32_t k)
 	{
 		if (mWriter1) mWriter1->Uint(k);
 		else if (mWriter2) mWriter2->Uint(k);
+		else if (mWriter3) mWriter3->Uint(k);
 	}
 
 	void Uint64(int64_t k)
 	{
 		if (mWriter1) mWriter1->Uint64(k);
 		else if (mWriter2) mWriter2->Uint64(k);
+		else if (mWriter3) mWriter3->Uint64(k);
 	}
 
 	void Double(double k)
@@ -288,6 +576,10 @@ struct FWriter
 		{
 			mWriter2->Double(k);
 		}
+		else if (mWriter3)
+		{
+			mWriter3->Double(k);
+		}
 	}
 
 };
@@ -308,7 +600,19 @@ struct FReader
 
 	FReader(const char *buffer, size_t length)
 	{
-		mDoc.Parse(buffer, length);
+		if (FBinaryGenerator::IsBinary(buffer, length))
+		{
+			FBinaryGenerator gen(buffer, length);
+			mDoc.Populate(gen);
+			if (!mDoc.IsObject())
+			{
+				I_Error("Corrupt binary serializer data");
+			}
+		}
+		else
+		{
+			mDoc.Parse(buffer, length);
+		}
 		mObjects.Push(FJSONObject(&mDoc));
 	}
 
@@ -358,6 +662,23 @@ bool FSerializer::OpenWriter(bool pretty)
 	return true;
 }
 
+//==========================================================================
+//
+// Writes the same data as OpenWriter in a compact binary form that is
+// a lot faster to write and read back. OpenReader detects the format.
+//
+//==========================================================================
+
+bool FSerializer::OpenBinaryWriter()
+{
+	if (w != nullptr || r != nullptr) return false;
+
+	mErrors = 0;
+	w = new FWriter(false, true);
+	BeginObject(nullptr);
+	return true;
+}
+
 //==========================================================================
 //
 //
@@ -385,17 +706,55 @@ bool FSerializer::OpenReader(FCompressedBuffer *input)
 	if (w != nullptr || r != nullptr) return false;
 
 	mErrors = 0;
+	r = ParseSerializerInput(input);
+	return true;
+}
+
+//==========================================================================
+//
+// Opens a reader for data that was already parsed by ParseSerializerInput.
+// The serializer takes ownership of it.
+//
+//==========================================================================
+
+bool FSerializer::OpenReader(FReader *input)
+{
+	if (input == nullptr) return false;
+	if (w != nullptr || r != nullptr) return false;
+
+	mErrors = 0;
+	r = input;
+	return true;
+}
+
+//==========================================================================
+//
+// Decompresses and parses serializer data. This is the slow part of
+// opening a reader. It only works on the input and its own document, so
+// it can be run on a worker thread while the game thread does something
+// else.
+//
+//==========================================================================
+
+FReader *ParseSerializerInput(FCompressedBuffer *input)
+{
+	if (input->mSize <= 0 || input->mBuffer == nullptr) return nullptr;
+
 	if (input->mMethod == METHOD_STORED)
 	{
-		r = new FReader((char*)input->mBuffer, input->mSize);
+		return new FReader((char*)input->mBuffer, input->mSize);
 	}
 	else
 	{
 		TArray<char> unpacked(input->mSize);
 		input->Decompress(unpacked.Data());
-		r = new FReader(unpacked.Data(), input->mSize);
+		return new FReader(unpacked.Data(), input->mSize);
 	}
-	return true;
+}
+
+void DeleteSerializerInput(FReader *input)
+{
+	delete input;
 }
 
 //==========================================================================
@@ -1053,19 +1412,31 @@ const char *FSerializer::GetOutput(unsigned *len)
 FCompressedBuffer FSerializer::GetCompressedOutput()
 {
 	if (isReading()) return{ 0,0,0,0,0,nullptr };
-	FCompressedBuffer buff;
 	WriteObjects();
 	EndObject();
-	buff.mSize = (unsigned)w->mOutString.GetSize();
+	return CompressZipBuffer(w->mOutString.GetString(), (unsigned)w->mOutString.GetSize());
+}
+
+//==========================================================================
+//
+// Deflates a block of memory into a zip compatible buffer. This only
+// uses new[] and zlib so it may be called from a worker thread.
+//
+//==========================================================================
+
+FCompressedBuffer CompressZipBuffer(const char *data, unsigned size)
+{
+	FCompressedBuffer buff;
+	buff.mSize = size;
 	buff.mZipFlags = 0;
-	buff.mCRC32 = crc32(0, (const Bytef*)w->mOutString.GetString(), buff.mSize);
+	buff.mCRC32 = crc32(0, (const Bytef*)data, buff.mSize);
 
 	uint8_t *compressbuf = new uint8_t[buff.mSize+1];
 
 	z_stream stream;
 	int err;
 
-	stream.next_in = (Bytef *)w->mOutString.GetString();
+	stream.next_in = (Bytef *)data;
 	stream.avail_in = buff.mSize;
 	stream.next_out = (Bytef*)compressbuf;
 	stream.avail_out = buff.mSize;
@@ -1099,7 +1470,9 @@ FCompressedBuffer FSerializer::GetCompressedOutput()
 	}
 
 error:
-	memcpy(compressbuf, w->mOutString.GetString(), buff.mSize + 1);
+	memcpy(compressbuf, data, buff.mSize);
+	compressbuf[buff.mSize] = 0;
+	buff.mBuffer = (char*)compressbuf;
 	buff.mCompressedSize = buff.mSize;
 	buff.mMethod = METHOD_STORED;
 	return buff;
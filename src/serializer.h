@@ -79,8 +79,10 @@ public:
 		Close();
 	}
 	bool OpenWriter(bool pretty = true);
+	bool OpenBinaryWriter();
 	bool OpenReader(const char *buffer, size_t length);
 	bool OpenReader(FCompressedBuffer *input);
+	bool OpenReader(FReader *input);
 	void Close();
 	void ReadObjects(bool hubtravel);
 	bool BeginObject(const char *name);
@@ -181,6 +183,9 @@ public:
 	int mErrors = 0;
 	int mObjectErrors = 0;
 };
+FCompressedBuffer CompressZipBuffer(const char *data, unsigned size);
+FReader *ParseSerializerInput(FCompressedBuffer *input);
+void DeleteSerializerInput(FReader *input);
 
 FSerializer &Serialize(FSerializer &arc, const char *key, bool &value, bool *defval);
 FSerializer &Serialize(FSerializer &arc, const char *key, int64_t &value, int64_t *defval);
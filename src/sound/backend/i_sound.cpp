@@ -47,6 +47,7 @@
 #include "c_cvars.h"
 #include "stats.h"
 #include "zmusic/zmusic.h"
+#include "m_fixed.h"
 
 
 EXTERN_CVAR (Float, snd_sfxvolume)
@@ -54,6 +55,8 @@ EXTERN_CVAR(Float, snd_musicvolume)
 CVAR (Int, snd_samplerate, 0, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 CVAR (Int, snd_buffersize, 0, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 CVAR (Int, snd_hrtf, 0, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+CVAR (Bool, snd_asyncdecode, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+CVAR (Int, snd_decodewait, 20, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)	// ms a sound may wait for its background decode before it gets skipped
 
 #if !defined(NO_OPENAL)
 #define DEF_BACKEND "openal"
@@ -246,7 +249,7 @@ void I_InitSound ()
 {
 	FModule_SetProgDir(progdir);
 	/* Get command line options: */
-	nosound = !!Args->CheckParm ("-nosound");
+	nosound = !!Args->CheckParm ("-nosound") || !!Args->CheckParm ("-headless");
 	nosfx = !!Args->CheckParm ("-nosfx");
 
 	GSnd = NULL;
@@ -326,6 +329,14 @@ void SoundRenderer::DrawWaveDebug(int mode)
 {
 }
 
+void SoundRenderer::UpdateSoundParams3DBatch(SoundListener *listener, unsigned count, FISoundChannel *const *chans, const bool *areasounds, const FVector3 *pos, const FVector3 *vel)
+{
+	for (unsigned i = 0; i < count; i++)
+	{
+		UpdateSoundParams3D(listener, chans[i], areasounds[i], pos[i], vel[i]);
+	}
+}
+
 FString SoundStream::GetStats()
 {
 	return "No stream stats available.";
@@ -486,3 +497,72 @@ SoundHandle SoundRenderer::LoadSoundVoc(uint8_t *sfxdata, int length)
 	if (data) delete[] data;
 	return retval;
 }
+
+//==========================================================================
+//
+// SoundRenderer :: DecodeSound
+//
+// Decodes any format the sound decoder understands to 8 or 16 bit PCM.
+//
+//==========================================================================
+
+bool SoundRenderer::DecodeSound(uint8_t *sfxdata, int length, FDecodedSound &decoded, FString *error)
+{
+	ChannelConfig chans;
+	SampleType type;
+	int srate;
+	uint32_t loop_start = 0, loop_end = ~0u;
+	bool startass = false, endass = false;
+
+	FindLoopTags(sfxdata, length, &loop_start, &startass, &loop_end, &endass);
+	auto decoder = CreateDecoder(sfxdata, length, true);
+	if (!decoder)
+		return false;
+
+	SoundDecoder_GetInfo(decoder, &srate, &chans, &type);
+	int channels = chans == ChannelConfig_Mono ? 1 : chans == ChannelConfig_Stereo ? 2 : 0;
+	int bits = type == SampleType_UInt8 ? 8 : type == SampleType_Int16 ? 16 : 0;
+	if (channels == 0 || bits == 0)
+	{
+		SoundDecoder_Close(decoder);
+		if (error != nullptr)
+		{
+			error->Format("Unsupported audio format: %s, %s", GetChannelConfigName(chans), GetSampleTypeName(type));
+		}
+		return false;
+	}
+
+	auto &data = decoded.Data;
+	unsigned total = 0;
+	unsigned got;
+
+	data.resize(total + 32768);
+	while ((got = (unsigned)SoundDecoder_Read(decoder, (char*)&data[total], data.size() - total)) > 0)
+	{
+		total += got;
+		data.resize(total * 2);
+	}
+	data.resize(total);
+	SoundDecoder_Close(decoder);
+	if (total == 0)
+	{
+		return false;
+	}
+
+	if (!startass) loop_start = Scale(loop_start, srate, 1000);
+	if (!endass && loop_end != ~0u) loop_end = Scale(loop_end, srate, 1000);
+	const uint32_t samples = total / (channels * bits / 8);
+	if (loop_start > samples) loop_start = 0;
+	if (loop_end > samples) loop_end = samples;
+
+	decoded.Frequency = srate;
+	decoded.Channels = channels;
+	decoded.Bits = bits;
+	// A loop over the entire sound is the same as no loop points at all.
+	if (loop_end > loop_start && (loop_start > 0 || loop_end < samples))
+	{
+		decoded.LoopStart = loop_start;
+		decoded.LoopEnd = loop_end;
+	}
+	return true;
+}
@@ -85,6 +85,17 @@ public:
 
 typedef bool (*SoundStreamCallback)(SoundStream *stream, void *buff, int len, void *userdata);
 
+// A sound that has been decoded to PCM but not yet been handed to the sound device.
+struct FDecodedSound
+{
+	std::vector<uint8_t> Data;
+	int Frequency = 0;
+	int Channels = 0;
+	int Bits = 0;
+	int LoopStart = -1;		// in samples, -1 if the sound does not define its own loop points
+	int LoopEnd = -1;
+};
+
 struct SoundDecoder;
 class MIDIDevice;
 
@@ -100,6 +111,12 @@ public:
 	virtual SoundHandle LoadSound(uint8_t *sfxdata, int length) = 0;
 	SoundHandle LoadSoundVoc(uint8_t *sfxdata, int length);
 	virtual SoundHandle LoadSoundRaw(uint8_t *sfxdata, int length, int frequency, int channels, int bits, int loopstart, int loopend = -1) = 0;
+	SoundHandle LoadSoundDecoded(FDecodedSound &decoded)
+	{
+		return LoadSoundRaw(decoded.Data.data(), (int)decoded.Data.size(), decoded.Frequency, decoded.Channels, decoded.Bits, decoded.LoopStart, decoded.LoopEnd);
+	}
+	// Does not touch the sound device, so this may be called from any thread as long as no error message is requested.
+	static bool DecodeSound(uint8_t *sfxdata, int length, FDecodedSound &decoded, FString *error = nullptr);
 	virtual void UnloadSound (SoundHandle sfx) = 0;	// unloads a sound from memory
 	virtual unsigned int GetMSLength(SoundHandle sfx) = 0;	// Gets the length of a sound at its default frequency
 	virtual unsigned int GetSampleLength(SoundHandle sfx) = 0;	// Gets the length of a sound at its default frequency
@@ -130,6 +147,9 @@ public:
 	// Gets a channel's audibility (real volume).
 	virtual float GetAudibility(FISoundChannel *chan) = 0;
 
+	// Returns how many more channels can be started before the device has to steal one.
+	virtual int GetFreeVoices() { return INT_MAX; }
+
 	// Synchronizes following sound startups.
 	virtual void Sync (bool sync) = 0;
 
@@ -147,6 +167,8 @@ public:
 
 	// Updates the volume, separation, and pitch of a sound channel.
 	virtual void UpdateSoundParams3D (SoundListener *listener, FISoundChannel *chan, bool areasound, const FVector3 &pos, const FVector3 &vel) = 0;
+	// The same for a whole set of channels at once, so that all device updates can be submitted together.
+	virtual void UpdateSoundParams3DBatch (SoundListener *listener, unsigned count, FISoundChannel *const *chans, const bool *areasounds, const FVector3 *pos, const FVector3 *vel);
 
 	virtual void UpdateListener (SoundListener *) = 0;
 	virtual void UpdateSounds () = 0;
@@ -45,9 +45,6 @@
 #include "m_fixed.h"
 
 
-const char *GetSampleTypeName(SampleType type);
-const char *GetChannelConfigName(ChannelConfig chan);
-
 FModule OpenALModule{"OpenAL"};
 
 #include "oalload.h"
@@ -60,6 +57,10 @@ CVAR(Bool, snd_waterreverb, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
 CVAR (String, snd_aldevice, "Default", CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 CVAR (Bool, snd_efx, false, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 CVAR (String, snd_alresampler, "Default", CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+static std::atomic<unsigned> StreamUnderruns;	// times a stream ran dry and had to be restarted
+
+CVAR (Bool, snd_lowlatency, false, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)	// use short mixing periods unless snd_buffersize says otherwise
+CVAR (Int, snd_reverbfade, 250, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)	// ms to crossfade between reverb environments, 0 switches at once
 
 #ifdef _WIN32
 #define OPENALLIB "openal32.dll"
@@ -109,6 +110,7 @@ ReverbContainer *ForcedEnvironment;
 
 EXTERN_CVAR (Int, snd_channels)
 EXTERN_CVAR (Int, snd_samplerate)
+EXTERN_CVAR (Int, snd_buffersize)
 EXTERN_CVAR (Bool, snd_waterreverb)
 EXTERN_CVAR (Bool, snd_pitched)
 EXTERN_CVAR (Int, snd_hrtf)
@@ -215,6 +217,8 @@ class OpenALSoundStream : public SoundStream
 			alSourcef(Source, AL_AIR_ABSORPTION_FACTOR, 0.f);
 			alSourcei(Source, AL_DIRECT_FILTER, AL_FILTER_NULL);
 			alSource3i(Source, AL_AUXILIARY_SEND_FILTER, 0, 0, AL_FILTER_NULL);
+			if(Renderer->EnvFadeSlot)
+				alSource3i(Source, AL_AUXILIARY_SEND_FILTER, 0, 1, AL_FILTER_NULL);
 		}
 		if(Renderer->AL.EXT_SOURCE_RADIUS)
 			alSourcef(Source, AL_SOURCE_RADIUS, 0.f);
@@ -408,6 +412,7 @@ public:
 			ok = (getALError() == AL_NO_ERROR) && (queued > 0);
 			if(ok)
 			{
+				StreamUnderruns++;
 				alSourcePlay(Source);
 				ok = (getALError()==AL_NO_ERROR);
 			}
@@ -543,9 +548,13 @@ static void LoadALCFunc(ALCdevice *device, const char *name, T *x)
 #define LOAD_FUNC(x)  (LoadALFunc(#x, &x))
 #define LOAD_DEV_FUNC(d, x)  (LoadALCFunc(d, #x, &x))
 OpenALSoundRenderer::OpenALSoundRenderer()
-	: QuitThread(false), Device(NULL), Context(NULL), SFXPaused(0), PrevEnvironment(NULL), EnvSlot(0)
+	: QuitThread(false), Device(NULL), Context(NULL), SFXPaused(0), PrevEnvironment(NULL), EnvSlot(0), EnvFadeSlot(0)
 {
 	EnvFilters[0] = EnvFilters[1] = 0;
+	SlotEnvironment[0] = SlotEnvironment[1] = nullptr;
+	SlotGain[0] = 1.f;
+	SlotGain[1] = 0.f;
+	ActiveSlot = 0;
 
 	Printf("I_InitSound: Initializing OpenAL\n");
 
@@ -556,6 +565,7 @@ OpenALSoundRenderer::OpenALSoundRenderer()
 	ALC.EXT_disconnect = !!alcIsExtensionPresent(Device, "ALC_EXT_disconnect");
 	ALC.SOFT_HRTF = !!alcIsExtensionPresent(Device, "ALC_SOFT_HRTF");
 	ALC.SOFT_pause_device = !!alcIsExtensionPresent(Device, "ALC_SOFT_pause_device");
+	ALC.SOFT_device_clock = !!alcIsExtensionPresent(Device, "ALC_SOFT_device_clock");
 
 	const ALCchar *current = NULL;
 	if(alcIsExtensionPresent(Device, "ALC_ENUMERATE_ALL_EXT"))
@@ -582,6 +592,15 @@ OpenALSoundRenderer::OpenALSoundRenderer()
 	attribs.Push(std::max<ALCint>(snd_channels, 2) - 1);
 	attribs.Push(ALC_STEREO_SOURCES);
 	attribs.Push(1);
+	// The mixing period is requested as an update rate. snd_buffersize is in
+	// sample frames per period, the low latency mode defaults to 256.
+	int period = *snd_buffersize > 0 ? *snd_buffersize : *snd_lowlatency ? 256 : 0;
+	if(period > 0)
+	{
+		int rate = *snd_samplerate > 0 ? *snd_samplerate : 48000;
+		attribs.Push(ALC_REFRESH);
+		attribs.Push(std::max(rate / clamp(period, 64, 8192), 1));
+	}
 	if(ALC.SOFT_HRTF)
 	{
 		attribs.Push(ALC_HRTF_SOFT);
@@ -592,6 +611,12 @@ OpenALSoundRenderer::OpenALSoundRenderer()
 		else
 			attribs.Push(ALC_DONT_CARE_SOFT);
 	}
+	if(*snd_efx && ALC.EXT_EFX)
+	{
+		// The second send is for crossfading between reverb environments.
+		attribs.Push(ALC_MAX_AUXILIARY_SENDS);
+		attribs.Push(2);
+	}
 	// Other attribs..?
 	attribs.Push(0);
 
@@ -660,6 +685,8 @@ OpenALSoundRenderer::OpenALSoundRenderer()
 		LOAD_DEV_FUNC(Device, alcDevicePauseSOFT);
 		LOAD_DEV_FUNC(Device, alcDeviceResumeSOFT);
 	}
+	if(ALC.SOFT_device_clock)
+		LOAD_DEV_FUNC(Device, alcGetInteger64vSOFT);
 
 	ALenum err = getALError();
 	if(err != AL_NO_ERROR)
@@ -798,7 +825,23 @@ OpenALSoundRenderer::OpenALSoundRenderer()
 	}
 
 	if(EnvSlot)
+	{
+		ALCint sends = 0;
+		alcGetIntegerv(Device, ALC_MAX_AUXILIARY_SENDS, 1, &sends);
+		if(sends >= 2)
+		{
+			alGenAuxiliaryEffectSlots(1, &EnvFadeSlot);
+			if(getALError() != AL_NO_ERROR)
+				EnvFadeSlot = 0;
+			else
+				alAuxiliaryEffectSlotf(EnvFadeSlot, AL_EFFECTSLOT_GAIN, 0.f);
+		}
 		Printf("  EFX enabled\n");
+	}
+
+	double latency = GetOutputLatency();
+	if(latency >= 0)
+		DPrintf(DMSG_NOTIFY, "  Output latency: " TEXTCOLOR_BLUE"%.1f" TEXTCOLOR_NORMAL"ms\n", latency);
 
 	if(AL.SOFT_source_resampler && strcmp(*snd_alresampler, "Default") != 0)
 	{
@@ -856,6 +899,9 @@ OpenALSoundRenderer::~OpenALSoundRenderer()
 	}
 	EnvEffects.Clear();
 
+	if(EnvFadeSlot)
+		alDeleteAuxiliaryEffectSlots(1, &EnvFadeSlot);
+	EnvFadeSlot = 0;
 	if(EnvSlot)
 	{
 		alDeleteAuxiliaryEffectSlots(1, &EnvSlot);
@@ -1053,85 +1099,15 @@ SoundHandle OpenALSoundRenderer::LoadSoundRaw(uint8_t *sfxdata, int length, int
 
 SoundHandle OpenALSoundRenderer::LoadSound(uint8_t *sfxdata, int length)
 {
-	SoundHandle retval = { NULL };
-	ALenum format = AL_NONE;
-	ChannelConfig chans;
-	SampleType type;
-	int srate;
-	uint32_t loop_start = 0, loop_end = ~0u;
-	bool startass = false, endass = false;
-
-	FindLoopTags(sfxdata, length, &loop_start, &startass, &loop_end, &endass);
-	auto decoder = CreateDecoder(sfxdata, length, true);
-	if (!decoder)
-		return retval;
-
-	SoundDecoder_GetInfo(decoder, &srate, &chans, &type);
-	int samplesize = 1;
-	if (chans == ChannelConfig_Mono)
-	{
-		if (type == SampleType_UInt8) format = AL_FORMAT_MONO8, samplesize = 1;
-		if (type == SampleType_Int16) format = AL_FORMAT_MONO16, samplesize = 2;
-	}
-	else if (chans == ChannelConfig_Stereo)
-	{
-		if (type == SampleType_UInt8) format = AL_FORMAT_STEREO8, samplesize = 2;
-		if (type == SampleType_Int16) format = AL_FORMAT_STEREO16, samplesize = 4;
-	}
-
-	if (format == AL_NONE)
-	{
-		SoundDecoder_Close(decoder);
-		Printf("Unsupported audio format: %s, %s\n", GetChannelConfigName(chans),
-			GetSampleTypeName(type));
-		return retval;
-	}
-
-	std::vector<uint8_t> data;
-	unsigned total = 0;
-	unsigned got;
-
-	data.resize(total + 32768);
-	while ((got = (unsigned)SoundDecoder_Read(decoder, (char*)&data[total], data.size() - total)) > 0)
-	{
-		total += got;
-		data.resize(total * 2);
-	}
-	data.resize(total);
-	if (total == 0)
-	{
-		return retval;
-	}
-	SoundDecoder_Close(decoder);
-
-	ALenum err;
-	ALuint buffer = 0;
-	alGenBuffers(1, &buffer);
-	alBufferData(buffer, format, &data[0], (ALsizei)data.size(), srate);
-	if((err=getALError()) != AL_NO_ERROR)
-	{
-		Printf("Failed to buffer data: %s\n", alGetString(err));
-		alDeleteBuffers(1, &buffer);
-		getALError();
-		return retval;
-	}
+	FDecodedSound decoded;
+	FString error;
 
-	if (!startass) loop_start = Scale(loop_start, srate, 1000);
-	if (!endass && loop_end != ~0u) loop_end = Scale(loop_end, srate, 1000);
-	const uint32_t samples = (uint32_t)data.size() / samplesize;
-	if (loop_start > samples) loop_start = 0;
-	if (loop_end > samples) loop_end = samples;
-
-	if ((loop_start > 0 || loop_end > 0) && loop_end > loop_start && AL.SOFT_loop_points)
+	if (!DecodeSound(sfxdata, length, decoded, &error))
 	{
-		ALint loops[2] = { static_cast<ALint>(loop_start), static_cast<ALint>(loop_end) };
-		DPrintf(DMSG_NOTIFY, "Setting loop points %d -> %d\n", loops[0], loops[1]);
-		alBufferiv(buffer, AL_LOOP_POINTS_SOFT, loops);
-		// no console messages here, please!
+		if (error.IsNotEmpty()) Printf("%s\n", error.GetChars());
+		return { NULL };
 	}
-
-	retval.data = MAKE_PTRID(buffer);
-	return retval;
+	return LoadSoundDecoded(decoded);
 }
 
 void OpenALSoundRenderer::UnloadSound(SoundHandle sfx)
@@ -1209,16 +1185,7 @@ FISoundChannel *OpenALSoundRenderer::StartSound(SoundHandle sfx, float vol, int
 
 	if(EnvSlot)
 	{
-		if(!(chanflags&SNDF_NOREVERB))
-		{
-			alSourcei(source, AL_DIRECT_FILTER, EnvFilters[0]);
-			alSource3i(source, AL_AUXILIARY_SEND_FILTER, EnvSlot, 0, EnvFilters[1]);
-		}
-		else
-		{
-			alSourcei(source, AL_DIRECT_FILTER, AL_FILTER_NULL);
-			alSource3i(source, AL_AUXILIARY_SEND_FILTER, 0, 0, AL_FILTER_NULL);
-		}
+		SetSourceReverb(source, !(chanflags&SNDF_NOREVERB));
 		alSourcef(source, AL_ROOM_ROLLOFF_FACTOR, 0.f);
 	}
 	if(WasInWater && !(chanflags&SNDF_NOREVERB))
@@ -1377,16 +1344,7 @@ FISoundChannel *OpenALSoundRenderer::StartSound3D(SoundHandle sfx, SoundListener
 
 	if(EnvSlot)
 	{
-		if(!(chanflags&SNDF_NOREVERB))
-		{
-			alSourcei(source, AL_DIRECT_FILTER, EnvFilters[0]);
-			alSource3i(source, AL_AUXILIARY_SEND_FILTER, EnvSlot, 0, EnvFilters[1]);
-		}
-		else
-		{
-			alSourcei(source, AL_DIRECT_FILTER, AL_FILTER_NULL);
-			alSource3i(source, AL_AUXILIARY_SEND_FILTER, 0, 0, AL_FILTER_NULL);
-		}
+		SetSourceReverb(source, !(chanflags&SNDF_NOREVERB));
 		alSourcef(source, AL_ROOM_ROLLOFF_FACTOR, 0.f);
 	}
 	if(WasInWater && !(chanflags&SNDF_NOREVERB))
@@ -1600,15 +1558,10 @@ void OpenALSoundRenderer::Sync(bool sync)
 	}
 }
 
-void OpenALSoundRenderer::UpdateSoundParams3D(SoundListener *listener, FISoundChannel *chan, bool areasound, const FVector3 &pos, const FVector3 &vel)
+// Expects chan->DistanceSqr to be up to date.
+void OpenALSoundRenderer::SetSourcePosVel(FISoundChannel *chan, const FVector3 &pos, const FVector3 &vel)
 {
-	if(chan == NULL || chan->SysChannel == NULL)
-		return;
-
-	float dist_sqr = (float)(pos - listener->position).LengthSquared();
-	chan->DistanceSqr = dist_sqr;
-
-	alDeferUpdatesSOFT();
+	float dist_sqr = chan->DistanceSqr;
 	ALuint source = GET_PTRID(chan->SysChannel);
 
 	if(dist_sqr < (0.0004f*0.0004f))
@@ -1629,6 +1582,36 @@ void OpenALSoundRenderer::UpdateSoundParams3D(SoundListener *listener, FISoundCh
 		alSource3f(source, AL_POSITION, pos[0], pos[1], -pos[2]);
 	}
 	alSource3f(source, AL_VELOCITY, vel[0], vel[1], -vel[2]);
+}
+
+void OpenALSoundRenderer::UpdateSoundParams3D(SoundListener *listener, FISoundChannel *chan, bool areasound, const FVector3 &pos, const FVector3 &vel)
+{
+	if(chan == NULL || chan->SysChannel == NULL)
+		return;
+
+	chan->DistanceSqr = (float)(pos - listener->position).LengthSquared();
+
+	alDeferUpdatesSOFT();
+	SetSourcePosVel(chan, pos, vel);
+	getALError();
+}
+
+void OpenALSoundRenderer::UpdateSoundParams3DBatch(SoundListener *listener, unsigned count, FISoundChannel *const *chans, const bool *areasounds, const FVector3 *pos, const FVector3 *vel)
+{
+	if(count == 0)
+		return;
+
+	// Everything is submitted in one deferred block and errors are only checked once at the end.
+	alDeferUpdatesSOFT();
+	for(unsigned i = 0;i < count;i++)
+	{
+		FISoundChannel *chan = chans[i];
+		if(chan == NULL || chan->SysChannel == NULL)
+			continue;
+
+		chan->DistanceSqr = (float)(pos[i] - listener->position).LengthSquared();
+		SetSourcePosVel(chan, pos[i], vel[i]);
+	}
 	getALError();
 }
 
@@ -1672,7 +1655,7 @@ void OpenALSoundRenderer::UpdateListener(SoundListener *listener)
 		DPrintf(DMSG_NOTIFY, "Reverb Environment %s\n", env->Name);
 
 		if(EnvSlot != 0)
-			LoadReverb(env);
+			SelectReverb(env);
 
 		const_cast<ReverbContainer*>(env)->Modified = false;
 	}
@@ -1688,7 +1671,7 @@ void OpenALSoundRenderer::UpdateListener(SoundListener *listener)
 			{
 				// Find the "Underwater" reverb environment
 				env = S_FindEnvironment(0x1600);
-				LoadReverb(env ? env : DefaultEnvironments[0]);
+				SelectReverb(env ? env : DefaultEnvironments[0]);
 
 				alFilterf(EnvFilters[0], AL_LOWPASS_GAIN, 1.f);
 				alFilterf(EnvFilters[0], AL_LOWPASS_GAINHF, 0.125f);
@@ -1702,8 +1685,7 @@ void OpenALSoundRenderer::UpdateListener(SoundListener *listener)
 					ALuint source = GET_PTRID(schan->SysChannel);
 					if (source && !(schan->ChanFlags & CHANF_UI))
 					{
-						alSourcei(source, AL_DIRECT_FILTER, EnvFilters[0]);
-						alSource3i(source, AL_AUXILIARY_SEND_FILTER, EnvSlot, 0, EnvFilters[1]);
+						SetSourceReverb(source, true);
 					}
 					schan = schan->NextChan;
 				}
@@ -1727,7 +1709,7 @@ void OpenALSoundRenderer::UpdateListener(SoundListener *listener)
 
 		if(EnvSlot != 0)
 		{
-			LoadReverb(env);
+			SelectReverb(env);
 
 			alFilterf(EnvFilters[0], AL_LOWPASS_GAIN, 1.f);
 			alFilterf(EnvFilters[0], AL_LOWPASS_GAINHF, 1.f);
@@ -1740,8 +1722,7 @@ void OpenALSoundRenderer::UpdateListener(SoundListener *listener)
 				ALuint source = GET_PTRID(schan->SysChannel);
 				if (source && !(schan->ChanFlags & CHANF_UI))
 				{
-					alSourcei(source, AL_DIRECT_FILTER, EnvFilters[0]);
-					alSource3i(source, AL_AUXILIARY_SEND_FILTER, EnvSlot, 0, EnvFilters[1]);
+					SetSourceReverb(source, true);
 				}
 				schan = schan->NextChan;
 			}
@@ -1757,6 +1738,9 @@ void OpenALSoundRenderer::UpdateListener(SoundListener *listener)
 		}
 		getALError();
 	}
+
+	if(EnvFadeSlot != 0)
+		UpdateReverbFade();
 }
 
 void OpenALSoundRenderer::UpdateSounds()
@@ -1827,6 +1811,13 @@ void OpenALSoundRenderer::PrintStatus()
 		Printf("ALC Extensions: " TEXTCOLOR_ORANGE"%s\n", alcGetString(Device, ALC_EXTENSIONS));
 		Printf("Available sources: " TEXTCOLOR_BLUE"%d" TEXTCOLOR_NORMAL" (" TEXTCOLOR_BLUE"%d" TEXTCOLOR_NORMAL" mono, " TEXTCOLOR_BLUE"%d" TEXTCOLOR_NORMAL" stereo)\n", mono+stereo, mono, stereo);
 	}
+	ALCint refresh = 0;
+	alcGetIntegerv(Device, ALC_REFRESH, 1, &refresh);
+	if(getALCError(Device) == AL_NO_ERROR && refresh > 0)
+		Printf("Mixing period: " TEXTCOLOR_BLUE"%d" TEXTCOLOR_NORMAL" samples\n", frequency / refresh);
+	double latency = GetOutputLatency();
+	if(latency >= 0)
+		Printf("Output latency: " TEXTCOLOR_BLUE"%.1f" TEXTCOLOR_NORMAL"ms\n", latency);
 	if(!alcIsExtensionPresent(Device, "ALC_EXT_EFX"))
 		Printf("EFX not found\n");
 	else
@@ -1862,9 +1853,32 @@ FString OpenALSoundRenderer::GatherStats()
 
 	out.Format("%u sources (" TEXTCOLOR_YELLOW"%u" TEXTCOLOR_NORMAL" active, " TEXTCOLOR_YELLOW"%u" TEXTCOLOR_NORMAL" free), Update interval: " TEXTCOLOR_YELLOW"%.1f" TEXTCOLOR_NORMAL"ms",
 			   total, used, unused, 1000.f/static_cast<float>(refresh));
+	double latency = GetOutputLatency();
+	if(latency >= 0)
+		out.AppendFormat(", Latency: " TEXTCOLOR_YELLOW"%.1f" TEXTCOLOR_NORMAL"ms", latency);
+	out.AppendFormat(", Stream underruns: " TEXTCOLOR_YELLOW"%u" TEXTCOLOR_NORMAL, StreamUnderruns.load());
 	return out;
 }
 
+//==========================================================================
+//
+// Time in ms from mixing a sample to it being heard, as reported by the
+// device. -1 if the device can't tell.
+//
+//==========================================================================
+
+double OpenALSoundRenderer::GetOutputLatency()
+{
+	if(!ALC.SOFT_device_clock)
+		return -1;
+
+	int64_t latency = 0;
+	alcGetInteger64vSOFT(Device, ALC_DEVICE_LATENCY_SOFT, 1, &latency);
+	if(getALCError(Device) != AL_NO_ERROR)
+		return -1;
+	return latency / 1e6;
+}
+
 void OpenALSoundRenderer::PrintDriversList()
 {
 	const ALCchar *drivers = (alcIsExtensionPresent(NULL, "ALC_ENUMERATE_ALL_EXT") ?
@@ -1923,7 +1937,93 @@ void OpenALSoundRenderer::PurgeStoppedSources()
 	getALError();
 }
 
-void OpenALSoundRenderer::LoadReverb(const ReverbContainer *env)
+//==========================================================================
+//
+// Points a source's sends at both environment slots, or at none.
+//
+//==========================================================================
+
+void OpenALSoundRenderer::SetSourceReverb(ALuint source, bool reverb)
+{
+	if(reverb)
+	{
+		alSourcei(source, AL_DIRECT_FILTER, EnvFilters[0]);
+		alSource3i(source, AL_AUXILIARY_SEND_FILTER, EnvSlot, 0, EnvFilters[1]);
+		if(EnvFadeSlot)
+			alSource3i(source, AL_AUXILIARY_SEND_FILTER, EnvFadeSlot, 1, EnvFilters[1]);
+	}
+	else
+	{
+		alSourcei(source, AL_DIRECT_FILTER, AL_FILTER_NULL);
+		alSource3i(source, AL_AUXILIARY_SEND_FILTER, 0, 0, AL_FILTER_NULL);
+		if(EnvFadeSlot)
+			alSource3i(source, AL_AUXILIARY_SEND_FILTER, 0, 1, AL_FILTER_NULL);
+	}
+}
+
+//==========================================================================
+//
+// Makes env the audible environment. Without a second slot it is loaded
+// right away. Otherwise it fades in on the slot that is not active, which
+// is skipped if that slot still has env from before, e.g. when stepping
+// back and forth over a zone border.
+//
+//==========================================================================
+
+void OpenALSoundRenderer::SelectReverb(const ReverbContainer *env)
+{
+	if(EnvFadeSlot == 0)
+	{
+		LoadReverb(env, EnvSlot);
+		return;
+	}
+
+	if(env == SlotEnvironment[ActiveSlot])
+	{
+		// Reloading an edited environment must not fade.
+		if(env->Modified)
+			LoadReverb(env, ActiveSlot ? EnvFadeSlot : EnvSlot);
+		return;
+	}
+
+	int other = ActiveSlot ^ 1;
+	if(env != SlotEnvironment[other] || env->Modified)
+	{
+		LoadReverb(env, other ? EnvFadeSlot : EnvSlot);
+		SlotEnvironment[other] = env;
+	}
+	ActiveSlot = other;
+	LastFadeTime = std::chrono::steady_clock::now();
+
+	if(*snd_reverbfade <= 0 || SlotEnvironment[ActiveSlot ^ 1] == nullptr)
+	{
+		// Nothing to fade from.
+		SlotGain[ActiveSlot] = 1.f;
+		SlotGain[ActiveSlot ^ 1] = 0.f;
+		alAuxiliaryEffectSlotf(EnvSlot, AL_EFFECTSLOT_GAIN, SlotGain[0]);
+		alAuxiliaryEffectSlotf(EnvFadeSlot, AL_EFFECTSLOT_GAIN, SlotGain[1]);
+		getALError();
+	}
+}
+
+void OpenALSoundRenderer::UpdateReverbFade()
+{
+	if(SlotGain[ActiveSlot] >= 1.f)
+		return;
+
+	auto now = std::chrono::steady_clock::now();
+	float elapsed = std::chrono::duration_cast<std::chrono::duration<float, std::milli>>(now - LastFadeTime).count();
+	LastFadeTime = now;
+
+	float step = *snd_reverbfade > 0 ? elapsed / *snd_reverbfade : 1.f;
+	SlotGain[ActiveSlot] = std::min(SlotGain[ActiveSlot] + step, 1.f);
+	SlotGain[ActiveSlot ^ 1] = 1.f - SlotGain[ActiveSlot];
+	alAuxiliaryEffectSlotf(EnvSlot, AL_EFFECTSLOT_GAIN, SlotGain[0]);
+	alAuxiliaryEffectSlotf(EnvFadeSlot, AL_EFFECTSLOT_GAIN, SlotGain[1]);
+	getALError();
+}
+
+void OpenALSoundRenderer::LoadReverb(const ReverbContainer *env, ALuint slot)
 {
 	ALuint *envReverb = EnvEffects.CheckKey(env->ID);
 	bool doLoad = (env->Modified || !envReverb);
@@ -2025,7 +2125,7 @@ void OpenALSoundRenderer::LoadReverb(const ReverbContainer *env)
 #undef mB2Gain
 	}
 
-	alAuxiliaryEffectSloti(EnvSlot, AL_EFFECTSLOT_EFFECT, *envReverb);
+	alAuxiliaryEffectSloti(slot, AL_EFFECTSLOT_EFFECT, *envReverb);
 	getALError();
 }
 
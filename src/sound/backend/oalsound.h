@@ -58,6 +58,14 @@ ALC_API ALCboolean ALC_APIENTRY alcResetDeviceSOFT(ALCdevice *device, const ALCi
 #endif
 #endif
 
+#ifndef ALC_SOFT_device_clock
+#define ALC_SOFT_device_clock 1
+#define ALC_DEVICE_CLOCK_SOFT                    0x1600
+#define ALC_DEVICE_LATENCY_SOFT                  0x1601
+#define ALC_DEVICE_CLOCK_LATENCY_SOFT            0x1602
+#endif
+typedef void (ALC_APIENTRY*LPALCGETINTEGER64VSOFT_ZD)(ALCdevice *device, ALCenum pname, ALCsizei size, int64_t *values);
+
 #ifndef AL_EXT_source_distance_model
 #define AL_EXT_source_distance_model 1
 #define AL_SOURCE_DISTANCE_MODEL                 0x200
@@ -164,12 +172,14 @@ public:
 
 	// Updates the volume, separation, and pitch of a sound channel.
 	virtual void UpdateSoundParams3D(SoundListener *listener, FISoundChannel *chan, bool areasound, const FVector3 &pos, const FVector3 &vel);
+	virtual void UpdateSoundParams3DBatch(SoundListener *listener, unsigned count, FISoundChannel *const *chans, const bool *areasounds, const FVector3 *pos, const FVector3 *vel);
 
 	virtual void UpdateListener(SoundListener *);
 	virtual void UpdateSounds();
 
 	virtual void MarkStartTime(FISoundChannel*, float startTime);
 	virtual float GetAudibility(FISoundChannel*);
+	virtual int GetFreeVoices() { return FreeSfx.Size(); }
 
 
 	virtual bool IsValid();
@@ -183,6 +193,7 @@ private:
         bool EXT_disconnect;
         bool SOFT_HRTF;
         bool SOFT_pause_device;
+        bool SOFT_device_clock;
 		bool SOFT_output_limiter;
     } ALC;
     struct {
@@ -241,12 +252,18 @@ private:
 
     void (ALC_APIENTRY*alcDevicePauseSOFT)(ALCdevice *device);
     void (ALC_APIENTRY*alcDeviceResumeSOFT)(ALCdevice *device);
+    LPALCGETINTEGER64VSOFT_ZD alcGetInteger64vSOFT;
 
     void BackgroundProc();
     void AddStream(OpenALSoundStream *stream);
     void RemoveStream(OpenALSoundStream *stream);
 
-	void LoadReverb(const ReverbContainer *env);
+	double GetOutputLatency();
+	void LoadReverb(const ReverbContainer *env, ALuint slot);
+	void SelectReverb(const ReverbContainer *env);
+	void UpdateReverbFade();
+	void SetSourceReverb(ALuint source, bool reverb);
+	void SetSourcePosVel(FISoundChannel *chan, const FVector3 &pos, const FVector3 &vel);
 	void PurgeStoppedSources();
 	static FSoundChan *FindLowestChannel();
 
@@ -277,6 +294,15 @@ private:
     ALuint EnvFilters[2];
     EffectMap EnvEffects;
 
+    // Environment changes crossfade between two effect slots. Each slot keeps
+    // its environment loaded, so going back and forth between two zones only
+    // changes the slot gains.
+    ALuint EnvFadeSlot;
+    const ReverbContainer *SlotEnvironment[2];
+    float SlotGain[2];
+    int ActiveSlot;
+    std::chrono::steady_clock::time_point LastFadeTime;
+
     bool WasInWater;
 
     TArray<OpenALSoundStream*> Streams;
@@ -691,6 +691,7 @@ static void S_SetListener(AActor *listenactor)
 
 void S_UpdateSounds (AActor *listenactor)
 {
+	PROFILE_ZONE("Sound");
 	// should never happen
 	S_SetListener(listenactor);
 
@@ -1458,7 +1459,27 @@ CCMD (snd_listdrivers)
 	GSnd->PrintDriversList ();
 }
 
+//==========================================================================
+//
+// Everything the sound system can tell about its performance, for the
+// sound stat and the benchmark output.
+//
+//==========================================================================
+
+void S_AppendSoundStats(FString &out)
+{
+	out += GSnd->GatherStats();
+	if (soundEngine)
+	{
+		out << "\n" << soundEngine->GatherStats();
+	}
+	out += "\n";
+	S_AppendMusicStreamStats(out);
+}
+
 ADD_STAT (sound)
 {
-	return GSnd->GatherStats ();
+	FString out;
+	S_AppendSoundStats(out);
+	return out;
 }
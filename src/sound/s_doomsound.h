@@ -62,6 +62,7 @@ void S_SoundReset();
 void S_ResumeSound(bool state);
 void S_PauseSound(bool state1, bool state);
 void S_NoiseDebug();
+void S_AppendSoundStats(FString &out);
 
 inline void S_StopSound(int chan)
 {
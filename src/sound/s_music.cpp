@@ -61,10 +61,16 @@
 #include "musicformats/win32/i_cd.h"
 #endif
 #include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <atomic>
 
 #include "i_system.h"
 #include "i_sound.h"
 #include "i_music.h"
+#include "i_time.h"
 
 #include "s_sound.h"
 #include "s_sndseq.h"
@@ -123,11 +129,149 @@ DEFINE_FIELD_X(MusPlayingInfo, MusPlayingInfo, loop);
 // Create a sound system stream for the currently playing song 
 //==========================================================================
 
+CUSTOM_CVAR(Int, snd_musicrenderahead, 150, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)	// ms of music to render in advance, 0 renders on the stream thread
+{
+	if (self < 0) self = 0;
+	else if (self > 2000) self = 2000;
+}
+
+// Synthesis time of the last music buffer and the longest since the last
+// stat query, in ns. Written by whichever thread renders the music.
+static std::atomic<uint64_t> MusicSynthTime, MusicSynthPeak;
+static std::atomic<unsigned> MusicStarved;	// times the stream had to wait for the render-ahead thread
+
+static bool TimedFillStream(ZMusic_MusicStream song, void *buff, int len)
+{
+	uint64_t start = I_nsTime();
+	bool written = ZMusic_FillStream(song, buff, len);
+	uint64_t time = I_nsTime() - start;
+
+	MusicSynthTime.store(time);
+	uint64_t peak = MusicSynthPeak.load();
+	while (time > peak && !MusicSynthPeak.compare_exchange_weak(peak, time)) {}
+	return written;
+}
+
+//==========================================================================
+//
+// FMusicRenderAhead
+//
+// Software synths can take quite a while to render a block. Instead of
+// doing that on the sound system's stream thread, a dedicated thread keeps
+// a ring buffer of snd_musicrenderahead ms filled in advance, so that a
+// busy CPU no longer immediately causes dropouts.
+//
+//==========================================================================
+
+class FMusicRenderAhead
+{
+	ZMusic_MusicStream Song;
+	std::vector<uint8_t> Ring;
+	size_t BlockSize;
+	size_t ReadPos = 0;
+	size_t Filled = 0;
+	unsigned Generation = 0;
+	bool SongEnded = false;
+	bool Quit = false;
+
+	std::mutex Lock;
+	std::condition_variable WakeSynth;
+	std::condition_variable WakeReader;
+	std::thread Thread;
+
+	bool HasSpace() const
+	{
+		return Ring.size() - Filled >= BlockSize;
+	}
+
+	void Render()
+	{
+		std::vector<uint8_t> block(BlockSize);
+		std::unique_lock<std::mutex> lock(Lock);
+		while (true)
+		{
+			WakeSynth.wait(lock, [this] { return Quit || (!SongEnded && HasSpace()); });
+			if (Quit) return;
+
+			unsigned gen = Generation;
+			lock.unlock();
+			bool written = TimedFillStream(Song, block.data(), (int)BlockSize);
+			lock.lock();
+			if (gen != Generation) continue;	// flushed while rendering, this block is stale.
+
+			if (!written)
+			{
+				SongEnded = true;
+			}
+			else
+			{
+				size_t writepos = (ReadPos + Filled) % Ring.size();
+				size_t first = std::min(BlockSize, Ring.size() - writepos);
+				memcpy(&Ring[writepos], block.data(), first);
+				memcpy(&Ring[0], block.data() + first, BlockSize - first);
+				Filled += BlockSize;
+			}
+			WakeReader.notify_one();
+		}
+	}
+
+public:
+	FMusicRenderAhead(ZMusic_MusicStream song, size_t blocksize, size_t blocks) : Song(song), BlockSize(blocksize)
+	{
+		Ring.resize(blocksize * std::max<size_t>(blocks, 2));
+		Thread = std::thread(&FMusicRenderAhead::Render, this);
+	}
+
+	~FMusicRenderAhead()
+	{
+		{
+			std::lock_guard<std::mutex> lock(Lock);
+			Quit = true;
+		}
+		WakeSynth.notify_one();
+		Thread.join();
+	}
+
+	// Called from the stream thread. If the synth has fallen behind this waits for it, just like
+	// rendering the block right here would have. Returns false once the song has ended and everything
+	// rendered up to that point has been played.
+	bool Read(uint8_t *buff, size_t len)
+	{
+		std::unique_lock<std::mutex> lock(Lock);
+		if (Filled < len && !SongEnded && HasSpace()) MusicStarved++;
+		WakeReader.wait(lock, [=] { return Filled >= len || SongEnded || !HasSpace(); });
+		if (SongEnded && Filled == 0) return false;
+
+		size_t got = std::min(len, Filled);
+		size_t first = std::min(got, Ring.size() - ReadPos);
+		memcpy(buff, &Ring[ReadPos], first);
+		memcpy(buff + first, &Ring[0], got - first);
+		if (got < len) memset(buff + got, 0, len - got);
+		ReadPos = (ReadPos + got) % Ring.size();
+		Filled -= got;
+		WakeSynth.notify_one();
+		return true;
+	}
+
+	// Drops everything that was rendered ahead, e.g. after switching subsongs.
+	void Flush()
+	{
+		{
+			std::lock_guard<std::mutex> lock(Lock);
+			ReadPos = Filled = 0;
+			SongEnded = false;
+			Generation++;
+		}
+		WakeSynth.notify_one();
+	}
+};
+
 static std::unique_ptr<SoundStream> musicStream;
+static std::unique_ptr<FMusicRenderAhead> musicRenderAhead;
 
 static bool FillStream(SoundStream* stream, void* buff, int len, void* userdata)
 {
-	bool written = ZMusic_FillStream(mus_playing.handle, buff, len);
+	bool written = musicRenderAhead ? musicRenderAhead->Read((uint8_t*)buff, len) : TimedFillStream(mus_playing.handle, buff, len);
 	
 	if (!written)
 	{
@@ -137,10 +281,38 @@ static bool FillStream(SoundStream* stream, void* buff, int len, void* userdata)
 	return true;
 }
 
+//==========================================================================
+//
+// Synthesis timing of the music stream for the sound stats.
+//
+//==========================================================================
+
+void S_AppendMusicStreamStats(FString &out)
+{
+	if (!musicStream)
+	{
+		out += "Music: not streaming";
+		return;
+	}
+	out.AppendFormat("Music synth: %.3f ms per buffer, peak %.3f ms, render-ahead waits: %u",
+		MusicSynthTime.load() / 1e6, MusicSynthPeak.exchange(0) / 1e6, MusicStarved.load());
+}
+
+void S_StopStream()
+{
+	if (musicStream)
+	{
+		musicStream->Stop();
+		musicStream.reset();
+	}
+	musicRenderAhead.reset();
+}
 
 void S_CreateStream()
 {
 	if (!mus_playing.handle) return;
+	// The render thread must be gone before anything else may touch the song.
+	S_StopStream();
 	SoundStreamInfo fmt;
 	ZMusic_GetStreamInfo(mus_playing.handle, &fmt);
 	if (fmt.mBufferSize > 0) // if buffer size is 0 the library will play the song itself (e.g. Windows system synth.)
@@ -148,6 +320,13 @@ void S_CreateStream()
 		int flags = fmt.mNumChannels < 0 ? 0 : SoundStream::Float;
 		if (abs(fmt.mNumChannels) < 2) flags |= SoundStream::Mono;
 
+		if (snd_musicrenderahead > 0)
+		{
+			size_t framesize = abs(fmt.mNumChannels) * (fmt.mNumChannels < 0 ? sizeof(int16_t) : sizeof(float));
+			size_t bytes = size_t(snd_musicrenderahead) * fmt.mSampleRate / 1000 * framesize;
+			musicRenderAhead.reset(new FMusicRenderAhead(mus_playing.handle, fmt.mBufferSize, (bytes + fmt.mBufferSize - 1) / fmt.mBufferSize));
+		}
+
 		musicStream.reset(GSnd->CreateStream(FillStream, fmt.mBufferSize, flags, fmt.mSampleRate, nullptr));
 		if (musicStream) musicStream->Play(true, 1);
 	}
@@ -158,15 +337,6 @@ void S_PauseStream(bool paused)
 	if (musicStream) musicStream->SetPaused(paused);
 }
 
-void S_StopStream()
-{
-	if (musicStream)
-	{
-		musicStream->Stop();
-		musicStream.reset();
-	}
-}
-
 
 //==========================================================================
 //
@@ -421,6 +591,7 @@ bool S_ChangeMusic (const char *musicname, int order, bool looping, bool force)
 			if (ZMusic_SetSubsong(mus_playing.handle, order))
 			{
 				mus_playing.baseorder = order;
+				if (musicRenderAhead) musicRenderAhead->Flush();
 			}
 		}
 		else if (!ZMusic_IsPlaying(mus_playing.handle))
@@ -481,7 +652,7 @@ bool S_ChangeMusic (const char *musicname, int order, bool looping, bool force)
 				{
 					return false;
 				}
-				reader = Wads.ReopenLumpReader(lumpnum);
+				reader = Wads.ReopenStreamingLumpReader(lumpnum);
 			}
 		}
 		else
@@ -641,6 +812,7 @@ void S_StopMusic (bool force)
 		//Printf("Unable to stop %s: %s\n", mus_playing.name.GetChars(), err.what());
 		if (mus_playing.handle != nullptr)
 		{
+			S_StopStream();
 			auto h = mus_playing.handle;
 			mus_playing.handle = nullptr;
 			ZMusic_Close(h);
@@ -66,6 +66,7 @@ void S_ResumeMusic ();
 // Updates music & sounds
 //
 void S_UpdateMusic ();
+void S_AppendMusicStreamStats(FString &out);
 
 struct MidiDeviceSetting
 {
@@ -39,6 +39,12 @@
 #include <io.h>
 #endif
 #include <fcntl.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <deque>
+#include <algorithm>
 
 #include "templates.h"
 #include "s_soundinternal.h"
@@ -46,6 +52,8 @@
 #include "superfasthash.h"
 #include "s_music.h"
 #include "m_random.h"
+#include "c_cvars.h"
+#include "stats.h"
 
 
 enum
@@ -55,6 +63,133 @@ enum
 static FRandom pr_soundpitch ("SoundPitch");
 SoundEngine* soundEngine;
 
+EXTERN_CVAR(Bool, snd_asyncdecode)
+EXTERN_CVAR(Int, snd_decodewait)
+
+//==========================================================================
+//
+// FSoundDecodeQueue
+//
+// Decodes compressed sounds on a worker thread so that precaching them
+// does not stall the game. Only the decoding happens there, the sound
+// device is only ever accessed by the main thread.
+//
+//==========================================================================
+
+struct FSoundDecodeJob
+{
+	int SfxID;
+	TArray<uint8_t> Lump;
+	FDecodedSound Decoded;
+	bool Success = false;
+};
+
+class FSoundDecodeQueue
+{
+	std::thread Thread;
+	std::mutex Lock;
+	std::condition_variable Wake;
+	std::condition_variable Done;
+	std::deque<FSoundDecodeJob*> Pending;
+	std::vector<FSoundDecodeJob*> Finished;
+	FSoundDecodeJob *Current = nullptr;
+	bool Quit = false;
+
+	void Worker()
+	{
+		std::unique_lock<std::mutex> lock(Lock);
+		while (true)
+		{
+			Wake.wait(lock, [this] { return Quit || !Pending.empty(); });
+			if (Quit) return;
+			Current = Pending.front();
+			Pending.pop_front();
+			lock.unlock();
+			Current->Success = SoundRenderer::DecodeSound(Current->Lump.Data(), Current->Lump.Size(), Current->Decoded);
+			lock.lock();
+			Finished.push_back(Current);
+			Current = nullptr;
+			Done.notify_all();
+		}
+	}
+
+	bool IsQueued(int sfxid) const
+	{
+		if (Current != nullptr && Current->SfxID == sfxid) return true;
+		for (auto job : Pending) if (job->SfxID == sfxid) return true;
+		return false;
+	}
+
+public:
+	FSoundDecodeQueue()
+	{
+		Thread = std::thread(&FSoundDecodeQueue::Worker, this);
+	}
+
+	~FSoundDecodeQueue()
+	{
+		Clear();
+		{
+			std::lock_guard<std::mutex> lock(Lock);
+			Quit = true;
+		}
+		Wake.notify_all();
+		Thread.join();
+	}
+
+	void Push(FSoundDecodeJob *job)
+	{
+		{
+			std::lock_guard<std::mutex> lock(Lock);
+			Pending.push_back(job);
+		}
+		Wake.notify_one();
+	}
+
+	// Waits at most the given time for a sound's decode to finish. A sound that
+	// has not been started yet gets moved to the front of the queue first.
+	bool Wait(int sfxid, int ms)
+	{
+		std::unique_lock<std::mutex> lock(Lock);
+		for (auto it = Pending.begin(); it != Pending.end(); ++it)
+		{
+			if ((*it)->SfxID == sfxid)
+			{
+				auto job = *it;
+				Pending.erase(it);
+				Pending.push_front(job);
+				break;
+			}
+		}
+		return Done.wait_for(lock, std::chrono::milliseconds(MAX(ms, 0)), [=] { return !IsQueued(sfxid); });
+	}
+
+	size_t Size()
+	{
+		std::lock_guard<std::mutex> lock(Lock);
+		return Pending.size() + (Current != nullptr);
+	}
+
+	std::vector<FSoundDecodeJob*> TakeFinished()
+	{
+		std::vector<FSoundDecodeJob*> jobs;
+		std::lock_guard<std::mutex> lock(Lock);
+		jobs.swap(Finished);
+		return jobs;
+	}
+
+	// Throws away all pending and finished work.
+	void Clear()
+	{
+		std::unique_lock<std::mutex> lock(Lock);
+		for (auto job : Pending) delete job;
+		Pending.clear();
+		Done.wait(lock, [this] { return Current == nullptr; });
+		for (auto job : Finished) delete job;
+		Finished.clear();
+	}
+};
+
 //==========================================================================
 //
 // S_Init
@@ -83,6 +218,7 @@ void SoundEngine::Clear()
 	StopAllChannels();
 	UnloadAllSounds();
 	GetSounds().Clear();
+	NameTable.Clear();
 	ClearRandoms();
 }
 
@@ -104,6 +240,10 @@ void SoundEngine::Shutdown ()
 		delete chan;
 	}
 	FreeChannels = NULL;
+
+	FlushDecodes();
+	delete DecodeQueue;
+	DecodeQueue = nullptr;
 }
 
 //==========================================================================
@@ -154,6 +294,8 @@ void SoundEngine::CacheMarkedSounds()
 //
 // S_CacheSound
 //
+// Compressed sounds are decoded in the background.
+//
 //==========================================================================
 
 void SoundEngine::CacheSound (sfxinfo_t *sfx)
@@ -171,7 +313,7 @@ void SoundEngine::CacheSound (sfxinfo_t *sfx)
 		}
 		else
 		{
-			LoadSound(sfx);
+			LoadSound(sfx, true);
 			sfx->bUsed = true;
 		}
 	}
@@ -185,6 +327,8 @@ void SoundEngine::CacheSound (sfxinfo_t *sfx)
 
 void SoundEngine::UnloadSound (sfxinfo_t *sfx)
 {
+	// A pending background decode gets discarded when it finishes.
+	sfx->bDecoding = false;
 	if (sfx->data.isValid())
 	{
 		GSnd->UnloadSound(sfx->data);
@@ -492,6 +636,17 @@ FSoundChan *SoundEngine::StartSound(int type, const void *source,
 		return NULL;
 	}
 
+	// If the background decode could not finish in time, drop the sound. Looping
+	// sounds start out evicted so that they begin playing once the data is there.
+	if (!sfx->data.isValid() && !GSnd->IsNull())
+	{
+		if (!(chanflags & CHANF_LOOP))
+		{
+			return NULL;
+		}
+		chanflags |= CHANF_EVICTED;
+	}
+
 	// Select priority.
 	if (type == SOURCE_None || source == listener.ListenerObject)
 	{
@@ -600,6 +755,7 @@ FSoundChan *SoundEngine::StartSound(int type, const void *source,
 		chan->DistanceScale = float(attenuation);
 		chan->SourceType = type;
 		chan->UserData = 0;
+		chan->CachedPos = pos;
 		if (type == SOURCE_Unattached)
 		{
 			chan->Point[0] = pt->X; chan->Point[1] = pt->Y; chan->Point[2] = pt->Z;
@@ -655,8 +811,8 @@ void SoundEngine::RestartChannel(FSoundChan *chan)
 
 	sfx = LoadSound(sfx);
 
-	// The empty sound never plays.
-	if (sfx->lumpnum == sfx_empty)
+	// The empty sound never plays, a sound that is still being decoded must keep waiting.
+	if (sfx->lumpnum == sfx_empty || !sfx->data.isValid())
 	{
 		return;
 	}
@@ -679,6 +835,7 @@ void SoundEngine::RestartChannel(FSoundChan *chan)
 		{
 			return;
 		}
+		chan->CachedPos = pos;
 
 		// If this sound doesn't like playing near itself, don't play it if
 		// that's what would happen.
@@ -708,10 +865,13 @@ void SoundEngine::RestartChannel(FSoundChan *chan)
 // S_LoadSound
 //
 // Returns a pointer to the sfxinfo with the actual sound data.
+// With async set, compressed sounds only get queued for decoding. A
+// synchronous load of such a sound waits for its decode for at most
+// snd_decodewait ms and returns without data if it takes longer.
 //
 //==========================================================================
 
-sfxinfo_t *SoundEngine::LoadSound(sfxinfo_t *sfx)
+sfxinfo_t *SoundEngine::LoadSound(sfxinfo_t *sfx, bool async)
 {
 	if (GSnd->IsNull()) return sfx;
 
@@ -723,12 +883,18 @@ sfxinfo_t *SoundEngine::LoadSound(sfxinfo_t *sfx)
 		{
 			return sfx;
 		}
+
+		if (sfx->bDecoding)
+		{
+			if (async || !WaitForDecode(sfx)) return sfx;
+			continue;
+		}
 		
 		// See if there is another sound already initialized with this lump. If so,
 		// then set this one up as a link, and don't load the sound again.
 		for (i = 0; i < S_sfx.Size(); i++)
 		{
-			if (S_sfx[i].data.isValid() && S_sfx[i].link == sfxinfo_t::NO_LINK && S_sfx[i].lumpnum == sfx->lumpnum &&
+			if ((S_sfx[i].data.isValid() || S_sfx[i].bDecoding) && S_sfx[i].link == sfxinfo_t::NO_LINK && S_sfx[i].lumpnum == sfx->lumpnum &&
 				(!sfx->bLoadRAW || (sfx->RawRate == S_sfx[i].RawRate)))	// Raw sounds with different sample rates may not share buffers, even if they use the same source data.
 			{
 				DPrintf (DMSG_NOTIFY, "Linked %s to %s (%d)\n", sfx->name.GetChars(), S_sfx[i].name.GetChars(), i);
@@ -736,9 +902,15 @@ sfxinfo_t *SoundEngine::LoadSound(sfxinfo_t *sfx)
 				// This is necessary to avoid using the rolloff settings of the linked sound if its
 				// settings are different.
 				if (sfx->Rolloff.MinDistance == 0) sfx->Rolloff = S_Rolloff;
-				return &S_sfx[i];
+				break;
 			}
 		}
+		if (i < S_sfx.Size())
+		{
+			// The linked sound may still be decoding.
+			sfx = &S_sfx[i];
+			continue;
+		}
 
 		DPrintf(DMSG_NOTIFY, "Loading sound \"%s\" (%td)\n", sfx->name.GetChars(), sfx - &S_sfx[0]);
 
@@ -766,6 +938,16 @@ sfxinfo_t *SoundEngine::LoadSound(sfxinfo_t *sfx)
 				sfx->data = GSnd->LoadSoundRaw(sfxdata.Data()+8, dmxlen, frequency, 1, 8, sfx->LoopStart);
 			}
 			// If that fails, let the sound system try and figure it out.
+			else if (async && snd_asyncdecode)
+			{
+				if (DecodeQueue == nullptr) DecodeQueue = new FSoundDecodeQueue;
+				auto job = new FSoundDecodeJob;
+				job->SfxID = int(sfx - &S_sfx[0]);
+				job->Lump = std::move(sfxdata);
+				DecodeQueue->Push(job);
+				sfx->bDecoding = true;
+				return sfx;
+			}
 			else
 			{
 				sfx->data = GSnd->LoadSound(sfxdata.Data(), size);
@@ -785,6 +967,45 @@ sfxinfo_t *SoundEngine::LoadSound(sfxinfo_t *sfx)
 	return sfx;
 }
 
+//==========================================================================
+//
+// Hands all sounds whose background decode has finished to the sound device.
+//
+//==========================================================================
+
+void SoundEngine::UploadDecodedSounds()
+{
+	if (DecodeQueue == nullptr) return;
+
+	for (auto job : DecodeQueue->TakeFinished())
+	{
+		sfxinfo_t *sfx = &S_sfx[job->SfxID];
+		if (sfx->bDecoding)
+		{
+			sfx->bDecoding = false;
+			// Let the synchronous loader print its complaints if the decode failed.
+			sfx->data = job->Success ? GSnd->LoadSoundDecoded(job->Decoded) : GSnd->LoadSound(job->Lump.Data(), job->Lump.Size());
+			if (!sfx->data.isValid()) sfx->lumpnum = sfx_empty;
+		}
+		delete job;
+	}
+}
+
+bool SoundEngine::WaitForDecode(sfxinfo_t *sfx)
+{
+	DecodeQueue->Wait(int(sfx - &S_sfx[0]), snd_decodewait);
+	UploadDecodedSounds();
+	return !sfx->bDecoding;
+}
+
+void SoundEngine::FlushDecodes()
+{
+	if (DecodeQueue == nullptr) return;
+
+	DecodeQueue->Clear();
+	for (auto &sfx : S_sfx) sfx.bDecoding = false;
+}
+
 //==========================================================================
 //
 // S_CheckSingular
@@ -840,7 +1061,9 @@ bool SoundEngine::CheckSoundLimit(sfxinfo_t *sfx, const FVector3 &pos, int near_
 				return false;
 			}
 
-			CalcPosVel(chan, &chanorigin, NULL);
+			// 3D channels get their position refreshed every frame, everything else needs to be looked up.
+			if (chan->ChanFlags & CHANF_IS3D) chanorigin = chan->CachedPos;
+			else CalcPosVel(chan, &chanorigin, NULL);
 			// scale the limit distance with the attenuation. An attenuation of 0 means the limit distance is infinite and all sounds within the level are inside the limit.
 			float attn = std::min(chan->DistanceScale, attenuation);
 			if (attn <= 0 || (chanorigin - pos).LengthSquared() <= limit_range / attn)
@@ -1180,20 +1403,33 @@ void SoundEngine::EvictAllChannels()
 	for (chan = Channels; chan != NULL; chan = next)
 	{
 		next = chan->NextChan;
+		EvictChannel(chan);
+//		assert(chan->NextChan == next);
+	}
+}
 
-		if (!(chan->ChanFlags & CHANF_EVICTED))
+//==========================================================================
+//
+// S_EvictChannel
+//
+// Takes a channel's system voice away but keeps it around so that it can
+// resume from the same position later.
+//
+//==========================================================================
+
+void SoundEngine::EvictChannel(FSoundChan *chan)
+{
+	if (!(chan->ChanFlags & CHANF_EVICTED))
+	{
+		chan->ChanFlags |= CHANF_EVICTED;
+		if (chan->SysChannel != NULL)
 		{
-			chan->ChanFlags |= CHANF_EVICTED;
-			if (chan->SysChannel != NULL)
+			if (!(chan->ChanFlags & CHANF_ABSTIME))
 			{
-				if (!(chan->ChanFlags & CHANF_ABSTIME))
-				{
-					chan->StartTime = GSnd ? GSnd->GetPosition(chan) : 0;
-					chan->ChanFlags |= CHANF_ABSTIME;
-				}
-				StopChannel(chan);
+				chan->StartTime = GSnd ? GSnd->GetPosition(chan) : 0;
+				chan->ChanFlags |= CHANF_ABSTIME;
 			}
-//			assert(chan->NextChan == next);
+			StopChannel(chan);
 		}
 	}
 }
@@ -1249,6 +1485,109 @@ void SoundEngine::RestoreEvictedChannels()
 	RestoreEvictedChannel(Channels);
 }
 
+//==========================================================================
+//
+// S_UpdateVoices
+//
+// The per-frame counterpart to S_RestoreEvictedChannels: Only the most
+// audible channels are bound to a system voice, all others stay evicted
+// as virtual channels. Evicted channels are restarted by priority and
+// audibility, and once the device runs out of voices they may only take
+// over the voice of a less important channel.
+//
+//==========================================================================
+
+void SoundEngine::UpdateVoices()
+{
+	// A channel must be this much louder than the one whose voice it takes, so that two
+	// channels of similar volume don't keep swapping places.
+	const float hysteresis = 1.25f;
+
+	VirtualChans.Clear();
+	BoundChans.Clear();
+	for (FSoundChan *chan = Channels; chan != NULL; chan = chan->NextChan)
+	{
+		chan->Audibility = chan->Volume;
+		if (chan->ChanFlags & CHANF_IS3D)
+		{
+			chan->Audibility *= GetRolloff(&chan->Rolloff, sqrtf(chan->DistanceSqr) * chan->DistanceScale);
+		}
+
+		if (chan->ChanFlags & CHANF_EVICTED)
+		{
+			VirtualChans.Push(chan);
+		}
+		else if (chan->SysChannel != NULL && !(chan->ChanFlags & CHANF_UI))
+		{
+			BoundChans.Push(chan);
+		}
+	}
+
+	std::sort(VirtualChans.begin(), VirtualChans.end(), [](FSoundChan *a, FSoundChan *b)
+	{
+		return a->Priority != b->Priority ? a->Priority > b->Priority : a->Audibility > b->Audibility;
+	});
+
+	unsigned victim = 0;
+	bool full = false;
+	for (auto chan : VirtualChans)
+	{
+		if (!full && GSnd->GetFreeVoices() <= 0)
+		{
+			// Only sort the playing channels once they are actually needed.
+			if (victim == 0)
+			{
+				std::sort(BoundChans.begin(), BoundChans.end(), [](FSoundChan *a, FSoundChan *b)
+				{
+					return a->Priority != b->Priority ? a->Priority < b->Priority : a->Audibility < b->Audibility;
+				});
+			}
+			// Skip channels that have been stopped in the meantime.
+			while (victim < BoundChans.Size() && BoundChans[victim]->SysChannel == NULL) victim++;
+
+			FSoundChan *lowest = victim < BoundChans.Size() ? BoundChans[victim] : NULL;
+			if (lowest != NULL && (chan->Priority > lowest->Priority ||
+				(chan->Priority == lowest->Priority && chan->Audibility > lowest->Audibility * hysteresis)))
+			{
+				EvictChannel(lowest);
+				victim++;
+			}
+			else
+			{
+				// Everything else is less important than what is playing now.
+				full = true;
+			}
+		}
+		if (!full)
+		{
+			RestartChannel(chan);
+		}
+
+		// Non-looping sounds get the same treatment as in S_RestoreEvictedChannel.
+		if (!(chan->ChanFlags & CHANF_LOOP))
+		{
+			if (chan->ChanFlags & CHANF_EVICTED)
+			{
+				ReturnChannel(chan);
+			}
+			else if (!(chan->ChanFlags & CHANF_JUSTSTARTED))
+			{
+				chan->ChanFlags |= CHANF_FORGETTABLE;
+			}
+		}
+	}
+
+	FSoundChan *chan, *next;
+	for (chan = Channels; chan != NULL; chan = next)
+	{
+		next = chan->NextChan;
+		if (!(chan->ChanFlags & CHANF_EVICTED) && chan->SysChannel == NULL && (chan->ChanFlags & (CHANF_FORGETTABLE | CHANF_LOOP)) == CHANF_FORGETTABLE)
+		{
+			ReturnChannel(chan);
+		}
+	}
+}
+
 //==========================================================================
 //
 // S_UpdateSounds
@@ -1259,20 +1598,41 @@ void SoundEngine::RestoreEvictedChannels()
 void SoundEngine::UpdateSounds(int time)
 {
 	FVector3 pos, vel;
+	cycle_t clock;
+
+	clock.Reset();
+	clock.Clock();
+	UploadDecodedSounds();
 
+	UpdateChans.Clear();
+	UpdateAreas.Clear();
+	UpdatePos.Clear();
+	UpdateVel.Clear();
 	for (FSoundChan* chan = Channels; chan != NULL; chan = chan->NextChan)
 	{
-		if ((chan->ChanFlags & (CHANF_EVICTED | CHANF_IS3D)) == CHANF_IS3D)
+		if ((chan->ChanFlags & (CHANF_EVICTED | CHANF_IS3D)) == (CHANF_EVICTED | CHANF_IS3D))
+		{
+			// Virtual channels still need their distance to decide whether they get a voice again.
+			CalcPosVel(chan, &pos, &vel);
+			chan->CachedPos = pos;
+			chan->DistanceSqr = (float)(pos - listener.position).LengthSquared();
+		}
+		else if (chan->ChanFlags & CHANF_IS3D)
 		{
 			CalcPosVel(chan, &pos, &vel);
+			chan->CachedPos = pos;
 
 			if (ValidatePosVel(chan, pos, vel))
 			{
-				GSnd->UpdateSoundParams3D(&listener, chan, !!(chan->ChanFlags & CHANF_AREA), pos, vel);
+				UpdateChans.Push(chan);
+				UpdateAreas.Push(!!(chan->ChanFlags & CHANF_AREA));
+				UpdatePos.Push(pos);
+				UpdateVel.Push(vel);
 			}
 		}
 		chan->ChanFlags &= ~CHANF_JUSTSTARTED;
 	}
+	GSnd->UpdateSoundParams3DBatch(&listener, UpdateChans.Size(), UpdateChans.Data(), UpdateAreas.Data(), UpdatePos.Data(), UpdateVel.Data());
 
 
 	GSnd->UpdateListener(&listener);
@@ -1281,8 +1641,30 @@ void SoundEngine::UpdateSounds(int time)
 	if (time >= RestartEvictionsAt)
 	{
 		RestartEvictionsAt = 0;
-		RestoreEvictedChannels();
+		UpdateVoices();
 	}
+	clock.Unclock();
+	LastUpdateMS = clock.TimeMS();
+}
+
+//==========================================================================
+//
+// S_GatherStats
+//
+//==========================================================================
+
+FString SoundEngine::GatherStats()
+{
+	int active = 0, virt = 0;
+	for (FSoundChan* chan = Channels; chan != NULL; chan = chan->NextChan)
+	{
+		if (chan->ChanFlags & CHANF_EVICTED) virt++;
+		else active++;
+	}
+	FString out;
+	out.Format("Update: %.3f ms, channels: %d active, %d virtual, decode queue: %d",
+		LastUpdateMS, active, virt, DecodeQueue ? (int)DecodeQueue->Size() : 0);
+	return out;
 }
 
 //==========================================================================
@@ -1438,6 +1820,7 @@ void SoundEngine::StopChannel(FSoundChan *chan)
 
 void SoundEngine::UnloadAllSounds()
 {
+	FlushDecodes();
 	for (unsigned i = 0; i < S_sfx.Size(); i++)
 	{
 		UnloadSound(&S_sfx[i]);
@@ -1462,21 +1845,17 @@ void SoundEngine::Reset()
 
 int SoundEngine::FindSound(const char* logicalname)
 {
-	int i;
-
-	if (logicalname != NULL)
+	if (logicalname != NULL && NameTable.Size() > 0)
 	{
-		i = S_sfx[MakeKey(logicalname) % S_sfx.Size()].index;
-
-		while ((i != 0) && stricmp(S_sfx[i].name, logicalname))
-			i = S_sfx[i].next;
-
-		return i;
-	}
-	else
-	{
-		return 0;
+		unsigned mask = NameTable.Size() - 1;
+		for (unsigned slot = MakeKey(logicalname) & mask; NameTable[slot] != 0; slot = (slot + 1) & mask)
+		{
+			unsigned i = NameTable[slot];
+			if (!stricmp(S_sfx[i].name, logicalname))
+				return i;
+		}
 	}
+	return 0;
 }
 
 int SoundEngine::FindSoundByResID(int resid)
@@ -1489,22 +1868,14 @@ int SoundEngine::FindSoundByResID(int resid)
 //
 // S_FindSoundNoHash
 //
-// Given a logical name, find the sound's index in S_sfx without
-// using the hash table.
+// The name table is kept up to date while sounds get added, so this is
+// the same as FindSound now. SNDINFO parsing used to do a linear search
+// here for every name it referenced.
 //==========================================================================
 
 int SoundEngine::FindSoundNoHash(const char* logicalname)
 {
-	unsigned int i;
-
-	for (i = 1; i < S_sfx.Size(); i++)
-	{
-		if (stricmp(S_sfx[i].name, logicalname) == 0)
-		{
-			return i;
-		}
-	}
-	return 0;
+	return FindSound(logicalname);
 }
 
 //==========================================================================
@@ -1541,15 +1912,66 @@ int SoundEngine::AddSoundLump(const char* logicalname, int lump, int CurrentPitc
 
 	newsfx.name = logicalname;
 	newsfx.lumpnum = lump;
-	newsfx.next = 0;
 	newsfx.PitchMask = CurrentPitchMask;
 	newsfx.NearLimit = nearlimit;
 	newsfx.ResourceId = resid;
 
 	if (resid >= 0) ResIdMap[resid] = S_sfx.Size() - 1;
+	AddSoundName(S_sfx.Size() - 1);
 	return (int)S_sfx.Size()-1;
 }
 
+//==========================================================================
+//
+// S_AddSoundName
+//
+// Enters a sound into the name table. The table is kept at most half
+// full. If the name is already taken, the older sound keeps it.
+//
+//==========================================================================
+
+void SoundEngine::AddSoundName(unsigned index)
+{
+	if (index == 0) return;	// sound 0 is "no sound" and is never looked up by name.
+	if (S_sfx.Size() * 2 > NameTable.Size())
+	{
+		RehashSoundNames();
+		return;
+	}
+
+	unsigned mask = NameTable.Size() - 1;
+	unsigned slot = MakeKey(S_sfx[index].name) & mask;
+	for (; NameTable[slot] != 0; slot = (slot + 1) & mask)
+	{
+		if (!stricmp(S_sfx[NameTable[slot]].name, S_sfx[index].name))
+			return;
+	}
+	NameTable[slot] = index;
+}
+
+void SoundEngine::RehashSoundNames()
+{
+	unsigned size = 256;
+	while (size < S_sfx.Size() * 4) size <<= 1;
+
+	NameTable.Resize(size);
+	memset(NameTable.Data(), 0, size * sizeof(NameTable[0]));
+	for (unsigned i = 1; i < S_sfx.Size(); i++)
+	{
+		unsigned slot = MakeKey(S_sfx[i].name) & (size - 1);
+		bool found = false;
+		for (; NameTable[slot] != 0; slot = (slot + 1) & (size - 1))
+		{
+			if (!stricmp(S_sfx[NameTable[slot]].name, S_sfx[i].name))
+			{
+				found = true;
+				break;
+			}
+		}
+		if (!found) NameTable[slot] = i;
+	}
+}
+
 
 //==========================================================================
 //
@@ -1665,29 +2087,13 @@ int SoundEngine::PickReplacement(int refid)
 //
 // S_HashSounds
 //
-// Fills in the next and index fields of S_sfx to form a working hash table.
+// Called when all sounds have been defined. The name table is maintained
+// as sounds get added, so this only trims the arrays.
 //==========================================================================
 
 void SoundEngine::HashSounds()
 {
-	unsigned int i;
-	unsigned int j;
-	unsigned int size;
-
 	S_sfx.ShrinkToFit();
-	size = S_sfx.Size();
-
-	// Mark all buckets as empty
-	for (i = 0; i < size; i++)
-		S_sfx[i].index = 0;
-
-	// Now set up the chains
-	for (i = 1; i < size; i++)
-	{
-		j = MakeKey(S_sfx[i].name) % size;
-		S_sfx[i].next = S_sfx[j].index;
-		S_sfx[j].index = i;
-	}
 	S_rnd.ShrinkToFit();
 }
 
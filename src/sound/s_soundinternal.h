@@ -27,7 +27,6 @@ struct sfxinfo_t
 	FString		name;								// [RH] Sound name defined in SNDINFO
 	int 		lumpnum = sfx_empty;				// lump number of sfx
 
-	unsigned int next = -1, index = 0;				// [RH] For hashing
 	float		Volume = 1.f;
 
 	int			ResourceId = -1;					// Resource ID as implemented by Blood. Not used by Doom but added for completeness.
@@ -43,6 +42,7 @@ struct sfxinfo_t
 	bool		bUsed = false;
 	bool		bSingular = false;
 	bool		bTentative = true;
+	bool		bDecoding = false;					// data is still being decoded in the background
 
 	TArray<int> UserData;
 
@@ -146,6 +146,8 @@ struct FSoundChan : public FISoundChannel
 	float		LimitRange;
 	const void *Source;
 	float Point[3];	// Sound is not attached to any source.
+	FVector3	CachedPos;	// 3D sounds only: position at the last update, used by the limit checks.
+	float		Audibility;	// Volume at the listener's position as of the last voice update.
 };
 
 
@@ -197,6 +199,8 @@ ReverbContainer *S_FindEnvironment (const char *name);
 ReverbContainer *S_FindEnvironment (int id);
 void S_AddEnvironment (ReverbContainer *settings);
 	
+class FSoundDecodeQueue;
+
 class SoundEngine
 {
 protected:
@@ -212,8 +216,17 @@ protected:
 	FRolloffInfo S_Rolloff{};
 	TArray<uint8_t> S_SoundCurve;
 	TMap<int, int> ResIdMap;
+	double LastUpdateMS = 0;		// time spent in the last UpdateSounds call
+	TArray<unsigned> NameTable;		// open addressing table of S_sfx indices by name, 0 marks a free slot
 	TArray<FRandomSoundList> S_rnd;
 	bool blockNewSounds = false;
+	FSoundDecodeQueue* DecodeQueue = nullptr;
+
+	// Scratch space for UpdateSounds so that all 3D channels can be passed to the sound device at once.
+	TArray<FISoundChannel*> UpdateChans;
+	TArray<bool> UpdateAreas;
+	TArray<FVector3> UpdatePos, UpdateVel;
+	TArray<FSoundChan*> VirtualChans, BoundChans;
 
 private:
 	void LinkChannel(FSoundChan* chan, FSoundChan** head);
@@ -221,6 +234,8 @@ private:
 	void ReturnChannel(FSoundChan* chan);
 	void RestartChannel(FSoundChan* chan);
 	void RestoreEvictedChannel(FSoundChan* chan);
+	void EvictChannel(FSoundChan* chan);
+	void UpdateVoices();
 
 	bool IsChannelUsed(int sourcetype, const void* actor, int channel, int* seen);
 	// This is the actual sound positioning logic which needs to be provided by the client.
@@ -233,6 +248,8 @@ private:
 	// Checks if a copy of this sound is already playing.
 	bool CheckSingular(int sound_id);
 	virtual TArray<uint8_t> ReadSound(int lumpnum) = 0;
+	bool WaitForDecode(sfxinfo_t* sfx);
+	void FlushDecodes();
 protected:
 	virtual bool CheckSoundLimit(sfxinfo_t* sfx, const FVector3& pos, int near_limit, float limit_range, int sourcetype, const void* actor, int channel, float attenuation);
 	virtual FSoundID ResolveSound(const void *ent, int srctype, FSoundID soundid, float &attenuation);
@@ -253,7 +270,8 @@ public:
 	virtual void SetSource(FSoundChan* chan, int index) {}
 
 	virtual void StopChannel(FSoundChan* chan);
-	sfxinfo_t* LoadSound(sfxinfo_t* sfx);
+	sfxinfo_t* LoadSound(sfxinfo_t* sfx, bool async = false);
+	void UploadDecodedSounds();
 
 	// Initializes sound stuff, including volume
 	// Sets channels, SFX and music volume,
@@ -383,6 +401,7 @@ public:
 
 	void ChannelVirtualChanged(FISoundChannel* ichan, bool is_virtual);
 	FString ListSoundChannels();
+	FString GatherStats();
 
 	// Allow this to be overridden for special needs.
 	virtual float GetRolloff(const FRolloffInfo* rolloff, float distance);
@@ -400,6 +419,8 @@ public:
 	unsigned int GetMSLength(FSoundID sound);
 	int PickReplacement(int refid);
 	void HashSounds();
+	void AddSoundName(unsigned index);
+	void RehashSoundNames();
 	void AddRandomSound(int Owner, TArray<uint32_t> list);
 };
 
@@ -32,6 +32,11 @@
 **
 */
 
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <time.h>
+
 #include "doomtype.h"
 #include "stats.h"
 #include "v_video.h"
@@ -41,6 +46,8 @@
 #include "c_dispatch.h"
 #include "m_swap.h"
 #include "sbar.h"
+#include "files.h"
+#include "c_cvars.h"
 
 FStat *FStat::FirstStat;
 
@@ -143,3 +150,441 @@ CCMD (stat)
 		FStat::ToggleStat (argv[1]);
 	}
 }
+
+//==========================================================================
+//
+// Profiler zones
+//
+// Every thread that enters a zone gets its own event buffer. Events of the
+// current frame are summed up for the overlay in EndFrame. While capturing
+// they are kept until the next capture starts.
+//
+//==========================================================================
+
+struct FProfileEvent
+{
+	const char *Name;
+	const char *Parent;
+	uint64_t Start;
+	uint64_t Duration;
+	int Depth;
+};
+
+struct FProfileThread
+{
+	std::mutex Lock;
+	TArray<FProfileEvent> Events;
+	unsigned FrameStart = 0;	// first event of the current frame
+	unsigned Kept = 0;			// events that belong to the capture
+	int Depth = 0;
+	int Index;
+	const char *Name = nullptr;	// for tracks that are not a thread
+	const char *Open[32];		// names of the zones that are currently entered
+};
+
+struct FProfileTotal
+{
+	const char *Name;
+	const char *Parent;
+	int Depth;
+	int Thread;
+	uint64_t Time;
+	unsigned Calls;
+};
+
+// Buffers are never freed since a thread's events may still be needed after it exits.
+static std::mutex ProfileThreadsLock;
+static TArray<FProfileThread *> ProfileThreads;
+static thread_local FProfileThread *ProfileThreadBuffer;
+
+static const unsigned MaxProfileEvents = 1 << 20;	// per thread, so that a forgotten capture can't eat all memory
+static bool ProfileCapturing;
+static uint64_t ProfileCaptureStart;
+static TArray<FProfileTotal> ProfileLastFrame;
+
+std::atomic<bool> FProfileZone::Enabled;
+
+static uint64_t ProfileTimeNS()
+{
+	using namespace std::chrono;
+	return (uint64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static FProfileThread *GetProfileThread()
+{
+	if (ProfileThreadBuffer == nullptr)
+	{
+		auto thread = new FProfileThread;
+		std::lock_guard<std::mutex> lock(ProfileThreadsLock);
+		thread->Index = ProfileThreads.Push(thread);
+		ProfileThreadBuffer = thread;
+	}
+	return ProfileThreadBuffer;
+}
+
+static FProfileThread *GetProfileTrack(const char *name)
+{
+	std::lock_guard<std::mutex> lock(ProfileThreadsLock);
+	for (auto thread : ProfileThreads)
+	{
+		if (thread->Name != nullptr && !strcmp(thread->Name, name)) return thread;
+	}
+	auto thread = new FProfileThread;
+	thread->Name = name;
+	thread->Index = ProfileThreads.Push(thread);
+	return thread;
+}
+
+uint64_t FProfileZone::Now()
+{
+	return ProfileTimeNS();
+}
+
+void FProfileZone::AddEvent(const char *track, const char *name, const char *parent, uint64_t start, uint64_t duration, int depth)
+{
+	FProfileThread *thread = GetProfileTrack(track);
+	std::lock_guard<std::mutex> lock(thread->Lock);
+	if (thread->Events.Size() < MaxProfileEvents)
+	{
+		thread->Events.Push({ name, parent, start, duration, depth });
+	}
+}
+
+void FProfileZone::Begin()
+{
+	FProfileThread *thread = GetProfileThread();
+	if (thread->Depth < (int)countof(thread->Open)) thread->Open[thread->Depth] = mName;
+	thread->Depth++;
+	mStart = ProfileTimeNS();
+}
+
+void FProfileZone::End()
+{
+	uint64_t now = ProfileTimeNS();
+	FProfileThread *thread = GetProfileThread();
+	int depth = --thread->Depth;
+	const char *parent = depth == 0 ? nullptr : thread->Open[MIN(depth, (int)countof(thread->Open)) - 1];
+
+	std::lock_guard<std::mutex> lock(thread->Lock);
+	if (thread->Events.Size() < MaxProfileEvents)
+	{
+		thread->Events.Push({ mName, parent, mStart, now - mStart, depth });
+	}
+}
+
+// Prints the zones below parent at the given depth, slowest first.
+static void PrintProfileTotals(FString &out, const TArray<FProfileTotal> &totals, int thread, const char *parent, int depth, uint64_t mintime)
+{
+	for (auto &total : totals)
+	{
+		if (total.Thread != thread || total.Depth != depth) continue;
+		if (depth > 0 && strcmp(total.Parent, parent)) continue;
+		if (total.Time < mintime) continue;
+
+		out.AppendFormat("%*s%s: %2.3f ms (%u)\n", depth * 2 + 2, "", total.Name, total.Time * 1e-6, total.Calls);
+		PrintProfileTotals(out, totals, thread, total.Name, depth + 1, mintime);
+	}
+}
+
+// Needs ProfileThreadsLock for the thread names.
+static void PrintProfileFrame(FString &out, const TArray<FProfileTotal> &totals, uint64_t mintime)
+{
+	int thread = -1;
+	for (auto &total : totals)
+	{
+		if (total.Thread != thread)
+		{
+			thread = total.Thread;
+			const char *name = ProfileThreads[thread]->Name;
+			if (name != nullptr) out.AppendFormat("%s:\n", name);
+			else out.AppendFormat("Thread %d:\n", thread);
+			PrintProfileTotals(out, totals, thread, nullptr, 0, mintime);
+		}
+	}
+}
+
+ADD_STAT(profile)
+{
+	FString out;
+	std::lock_guard<std::mutex> lock(ProfileThreadsLock);
+	PrintProfileFrame(out, ProfileLastFrame, 0);
+	return out;
+}
+
+static FStat *ProfileStat = &Istaticstatprofile;
+
+//==========================================================================
+//
+// Hitch log
+//
+// The zone totals of the last few frames are kept in a ring, as are the
+// most recent notes. Both are only written out when a frame is too slow.
+//
+//==========================================================================
+
+CUSTOM_CVAR(Int, hitch_threshold, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+{
+	if (self < 0) self = 0;
+}
+
+CUSTOM_CVAR(Int, hitch_frames, 8, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+{
+	if (self < 1) self = 1;
+	else if (self > 120) self = 120;
+}
+
+CVAR(String, hitch_logfile, "hitches.log", CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+struct FHitchFrame
+{
+	uint64_t Start;
+	uint64_t Duration;
+	TArray<FProfileTotal> Totals;
+};
+
+struct FHitchNote
+{
+	const char *Category;
+	uint64_t Start;
+	uint64_t Duration;
+	char Text[96];
+};
+
+static const unsigned MaxHitchNotes = 256;
+static std::mutex HitchNotesLock;
+static FHitchNote HitchNotes[MaxHitchNotes];
+static unsigned HitchNoteCount;		// total notes taken, the ring holds the last MaxHitchNotes
+static TArray<FHitchFrame> HitchFrames;
+static unsigned HitchFrameCount;
+static uint64_t HitchLastFrameEnd;
+static bool HitchSkip;
+
+std::atomic<bool> FHitchLog::Enabled;
+
+void FHitchLog::Note(uint64_t start, const char *category, const char *fmt, ...)
+{
+	uint64_t now = ProfileTimeNS();
+	std::lock_guard<std::mutex> lock(HitchNotesLock);
+	auto &note = HitchNotes[HitchNoteCount++ % MaxHitchNotes];
+	note.Category = category;
+	note.Start = start;
+	note.Duration = now - start;
+
+	va_list argptr;
+	va_start(argptr, fmt);
+	myvsnprintf(note.Text, sizeof(note.Text), fmt, argptr);
+	va_end(argptr);
+}
+
+void FHitchLog::SkipFrame()
+{
+	HitchSkip = true;
+}
+
+// Needs ProfileThreadsLock for the thread names.
+static void WriteHitchLog(unsigned numframes)
+{
+	FILE *f = fopen(hitch_logfile, "a");
+	if (f == nullptr)
+	{
+		DPrintf(DMSG_ERROR, "Could not open %s\n", *hitch_logfile);
+		return;
+	}
+
+	auto &hitch = HitchFrames[(HitchFrameCount - 1) % HitchFrames.Size()];
+	time_t now = time(nullptr);
+	char timestr[64];
+	strftime(timestr, sizeof(timestr), "%Y-%m-%d %H:%M:%S", localtime(&now));
+
+	FString out;
+	out.Format("=== Hitch at %s: frame took %.1f ms (threshold %d ms)\n", timestr, hitch.Duration * 1e-6, *hitch_threshold);
+
+	// Zones below 0.1 ms only make the log harder to read
+	unsigned first = HitchFrameCount - numframes;
+	for (unsigned i = first; i < HitchFrameCount; i++)
+	{
+		auto &frame = HitchFrames[i % HitchFrames.Size()];
+		out.AppendFormat("\nFrame %d: %.2f ms%s\n", int(i - HitchFrameCount) + 1, frame.Duration * 1e-6, i == HitchFrameCount - 1 ? " (hitch)" : "");
+		PrintProfileFrame(out, frame.Totals, 100000);
+	}
+
+	uint64_t windowstart = HitchFrames[first % HitchFrames.Size()].Start;
+	out.AppendFormat("\nNotes:\n");
+	{
+		std::lock_guard<std::mutex> lock(HitchNotesLock);
+		unsigned firstnote = HitchNoteCount > MaxHitchNotes ? HitchNoteCount - MaxHitchNotes : 0;
+		for (unsigned i = firstnote; i < HitchNoteCount; i++)
+		{
+			auto &note = HitchNotes[i % MaxHitchNotes];
+			if (note.Start < windowstart) continue;
+			out.AppendFormat("  %+9.2f ms  %-8s %7.2f ms  %s\n", (note.Start - hitch.Start) * 1e-6, note.Category, note.Duration * 1e-6, note.Text);
+		}
+	}
+	out += "\n";
+
+	fputs(out.GetChars(), f);
+	fclose(f);
+	DPrintf(DMSG_NOTIFY, "Hitch of %.1f ms logged to %s\n", hitch.Duration * 1e-6, *hitch_logfile);
+}
+
+//==========================================================================
+//
+// Called once per frame by the main loop.
+//
+//==========================================================================
+
+void FProfileZone::EndFrame()
+{
+	bool hitchlog = hitch_threshold > 0;
+	if (hitchlog != FHitchLog::Enabled)
+	{
+		FHitchLog::Enabled = hitchlog;
+		HitchFrames.Clear();
+		HitchFrameCount = 0;
+		HitchLastFrameEnd = 0;
+	}
+	Enabled = ProfileCapturing || ProfileStat->isActive() || hitchlog;
+
+	TArray<FProfileTotal> totals;
+	std::lock_guard<std::mutex> lock(ProfileThreadsLock);
+	for (auto thread : ProfileThreads)
+	{
+		std::lock_guard<std::mutex> tlock(thread->Lock);
+		for (unsigned i = thread->FrameStart; i < thread->Events.Size(); i++)
+		{
+			auto &ev = thread->Events[i];
+			auto found = totals.FindEx([&](const FProfileTotal &t)
+			{
+				return t.Thread == thread->Index && t.Depth == ev.Depth && !strcmp(t.Name, ev.Name) &&
+					(t.Parent == ev.Parent || (t.Parent != nullptr && ev.Parent != nullptr && !strcmp(t.Parent, ev.Parent)));
+			});
+			if (found == totals.Size())
+			{
+				totals.Push({ ev.Name, ev.Parent, ev.Depth, thread->Index, ev.Duration, 1 });
+			}
+			else
+			{
+				totals[found].Time += ev.Duration;
+				totals[found].Calls++;
+			}
+		}
+		if (ProfileCapturing)
+		{
+			thread->Kept = thread->Events.Size();
+		}
+		else
+		{
+			thread->Events.Resize(thread->Kept);
+		}
+		thread->FrameStart = thread->Events.Size();
+	}
+
+	std::stable_sort(totals.begin(), totals.end(), [](const FProfileTotal &a, const FProfileTotal &b)
+	{
+		if (a.Thread != b.Thread) return a.Thread < b.Thread;
+		return a.Time > b.Time;
+	});
+
+	if (hitchlog)
+	{
+		uint64_t now = ProfileTimeNS();
+		if (HitchFrames.Size() != (unsigned)hitch_frames)
+		{
+			HitchFrames.Resize(hitch_frames);
+			HitchFrameCount = 0;
+		}
+		auto &frame = HitchFrames[HitchFrameCount++ % HitchFrames.Size()];
+		frame.Start = HitchLastFrameEnd != 0 ? HitchLastFrameEnd : now;
+		frame.Duration = now - frame.Start;
+		frame.Totals = totals;
+
+		if (frame.Duration > uint64_t(hitch_threshold) * 1000000 && HitchLastFrameEnd != 0 && !HitchSkip)
+		{
+			WriteHitchLog(MIN(HitchFrameCount, HitchFrames.Size()));
+		}
+		HitchLastFrameEnd = now;
+		HitchSkip = false;
+	}
+	ProfileLastFrame = std::move(totals);
+}
+
+//==========================================================================
+//
+// Writes the capture in the Chrome trace event format, which can be
+// viewed in chrome://tracing, Perfetto and imported into Tracy.
+//
+//==========================================================================
+
+static bool DumpProfile(const char *filename)
+{
+	FileWriter *fw = FileWriter::Open(filename);
+	if (fw == nullptr) return false;
+
+	fw->Printf("{\"traceEvents\":[\n");
+	bool first = true;
+	std::lock_guard<std::mutex> lock(ProfileThreadsLock);
+	for (auto thread : ProfileThreads)
+	{
+		std::lock_guard<std::mutex> tlock(thread->Lock);
+		if (thread->Name != nullptr)
+		{
+			fw->Printf("%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+				first ? "" : ",\n", thread->Index, thread->Name);
+			first = false;
+		}
+		for (unsigned i = 0; i < thread->Kept; i++)
+		{
+			auto &ev = thread->Events[i];
+			if (ev.Start < ProfileCaptureStart) continue;
+			fw->Printf("%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+				first ? "" : ",\n", ev.Name, (ev.Start - ProfileCaptureStart) * 1e-3, ev.Duration * 1e-3, thread->Index);
+			first = false;
+		}
+	}
+	fw->Printf("\n]}\n");
+	delete fw;
+	return true;
+}
+
+CCMD(profile)
+{
+	if (argv.argc() >= 2 && !stricmp(argv[1], "start"))
+	{
+		std::lock_guard<std::mutex> lock(ProfileThreadsLock);
+		for (auto thread : ProfileThreads)
+		{
+			std::lock_guard<std::mutex> tlock(thread->Lock);
+			thread->Events.Clear();
+			thread->FrameStart = thread->Kept = 0;
+		}
+		ProfileCaptureStart = ProfileTimeNS();
+		ProfileCapturing = true;
+		FProfileZone::Enabled = true;
+		Printf("Profile capture started\n");
+	}
+	else if (argv.argc() >= 2 && !stricmp(argv[1], "stop"))
+	{
+		ProfileCapturing = false;
+		Printf("Profile capture stopped\n");
+	}
+	else if (argv.argc() >= 2 && !stricmp(argv[1], "dump"))
+	{
+		const char *filename = argv.argc() >= 3 ? argv[2] : "profile.json";
+		if (ProfileCapturing)
+		{
+			Printf("Stop the capture first\n");
+		}
+		else if (DumpProfile(filename))
+		{
+			Printf("Profile written to %s\n", filename);
+		}
+		else
+		{
+			Printf("Could not write %s\n", filename);
+		}
+	}
+	else
+	{
+		Printf("Usage: profile start|stop|dump [file]\n");
+	}
+}
@@ -34,9 +34,12 @@
 #ifndef __STATS_H__
 #define __STATS_H__
 
+#include <atomic>
 #include "zstring.h"
 
-#if !defined _WIN32 && !defined __APPLE__
+// Use the CPU's cycle counter wherever there is one. Reading it costs a few
+// cycles while clock_gettime can end up in a syscall on some ARM kernels.
+#if !defined _WIN32 && !defined __APPLE__ && !defined __i386__ && !defined __amd64__ && !defined __aarch64__
 
 #ifdef NO_CLOCK_GETTIME
 class cycle_t
@@ -96,7 +99,7 @@ private:
 
 #else
 
-// Windows and macOS
+// Windows, macOS and x86/ARM64 Linux
 #include "x86.h"
 
 extern double PerfToSec, PerfToMillisec;
@@ -118,6 +121,10 @@ inline uint64_t rdtsc()
 	uint64_t tsc;
 	asm volatile ("rdtsc; shlq $32, %%rdx; orq %%rdx, %%rax" : "=a" (tsc) :: "%rdx");
 	return tsc;
+#elif defined __aarch64__
+	uint64_t cnt;
+	asm volatile ("mrs %0, cntvct_el0" : "=r" (cnt));
+	return cnt;
 #elif defined __ppc__
 	unsigned int lower, upper, temp;
 	do
@@ -214,4 +221,79 @@ private:
 		FString GetStats (); } Istaticstat##n; \
 	FString Stat_##n::GetStats ()
 
+//==========================================================================
+//
+// Profiler zones
+//
+// A zone measures the scope it is declared in. Zones nest and can be used
+// on any thread. They cost one flag check unless 'stat profile' is shown
+// or a capture is running ('profile start'). A capture can be written out
+// in the Chrome trace event format.
+//
+//==========================================================================
+
+class FProfileZone
+{
+public:
+	FProfileZone(const char *name)
+	{
+		mName = Enabled.load(std::memory_order_relaxed) ? name : nullptr;
+		if (mName != nullptr) Begin();
+	}
+	~FProfileZone()
+	{
+		if (mName != nullptr) End();
+	}
+	FProfileZone(const FProfileZone &) = delete;
+	FProfileZone &operator=(const FProfileZone &) = delete;
+
+	static void EndFrame();
+	static std::atomic<bool> Enabled;
+
+	// For timings taken elsewhere, like GPU queries. They go to a separate
+	// track named after 'track'. Times are in nanoseconds on Now()'s clock.
+	static uint64_t Now();
+	static void AddEvent(const char *track, const char *name, const char *parent, uint64_t start, uint64_t duration, int depth);
+
+private:
+	void Begin();
+	void End();
+
+	const char *mName;
+	uint64_t mStart;
+};
+
+//==========================================================================
+//
+// Hitch log
+//
+// When a frame takes longer than hitch_threshold milliseconds, the zone
+// totals of the last hitch_frames frames and the notes taken during them
+// are appended to hitch_logfile. Slow operations that are likely to cause
+// a hitch leave a note:
+//
+//	uint64_t start = FHitchLog::Start();
+//	...
+//	if (start) FHitchLog::Note(start, "Lump", "%s", name);
+//
+// Start() costs one flag check while the log is off.
+//
+//==========================================================================
+
+class FHitchLog
+{
+public:
+	static uint64_t Start() { return Enabled.load(std::memory_order_relaxed) ? FProfileZone::Now() : 0; }
+	static void Note(uint64_t start, const char *category, const char *fmt, ...) GCCPRINTF(3, 4);
+
+	// For frames that are expected to be long, like loading a level
+	static void SkipFrame();
+
+	static std::atomic<bool> Enabled;
+};
+
+#define PROFILE_ZONE_NAME2(a, b) a##b
+#define PROFILE_ZONE_NAME(a, b) PROFILE_ZONE_NAME2(a, b)
+#define PROFILE_ZONE(name) FProfileZone PROFILE_ZONE_NAME(profilezone_, __LINE__)(name)
+
 #endif //__STATS_H__
@@ -46,23 +46,247 @@
 #include "gi.h"
 #include "c_cvars.h"
 #include "gstrings.h"
+#include "m_misc.h"
+#include "md5.h"
+#include "files.h"
+#include "version.h"
 
 EXTERN_CVAR(String, language)
 
+// Keep the parsed LANGUAGE lumps on disk so that unchanged lumps don't need to be parsed again.
+CVAR(Bool, language_cache, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+// Only keep the strings of the current language and its fallbacks in memory.
+CVAR(Bool, language_lazyload, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+static const char LanguageCacheMagic[4] = { 'L', 'N', 'G', '1' };
+
+//==========================================================================
+//
+// The cache is only valid for the exact same set of LANGUAGE lumps, game
+// and engine build, all of which go into the key.
+//
+//==========================================================================
+
+static void LanguageCacheKey(const TArray<int> &lumps, uint8_t digest[16])
+{
+	MD5Context md5;
+	const char *hash = GetGitHash();
+	md5.Update((const uint8_t *)hash, (unsigned)strlen(hash));
+
+	int32_t game[2] = { LittleLong(int32_t(gameinfo.gametype)), LittleLong(int32_t(gameinfo.flags & GI_SHAREWARE)) };
+	md5.Update((const uint8_t *)game, sizeof(game));
+
+	for (int lump : lumps)
+	{
+		FMemLump data = Wads.ReadLump(lump);
+		int32_t len = LittleLong(int32_t(Wads.LumpLength(lump)));
+		md5.Update((const uint8_t *)&len, sizeof(len));
+		md5.Update((const uint8_t *)data.GetMem(), Wads.LumpLength(lump));
+	}
+	md5.Final(digest);
+}
+
+static FString LanguageCachePath()
+{
+	FString path = M_GetCachePath(true);
+	CreatePath(path);
+	path << "/language.cache";
+	return path;
+}
+
+//==========================================================================
+//
+// Cache file format: magic, key, number of tables, then for each table its
+// id, number of strings and the strings as length prefixed name/text pairs.
+// Everything is little endian.
+//
+//==========================================================================
+
+static void WriteCacheInt(TArray<uint8_t> &out, uint32_t val)
+{
+	val = LittleLong(val);
+	unsigned pos = out.Reserve(4);
+	memcpy(&out[pos], &val, 4);
+}
+
+static void WriteCacheString(TArray<uint8_t> &out, const char *str, size_t len)
+{
+	WriteCacheInt(out, uint32_t(len));
+	unsigned pos = out.Reserve(unsigned(len));
+	if (len > 0) memcpy(&out[pos], str, len);
+}
+
+static void SaveLanguageCache(const uint8_t key[16], FStringTable::LangMap &tables)
+{
+	TArray<uint8_t> out;
+	unsigned pos = out.Reserve(20);
+	memcpy(&out[pos], LanguageCacheMagic, 4);
+	memcpy(&out[pos + 4], key, 16);
+	WriteCacheInt(out, tables.CountUsed());
+
+	FStringTable::LangMap::Iterator it(tables);
+	FStringTable::LangMap::Pair *pair;
+	while (it.NextPair(pair))
+	{
+		WriteCacheInt(out, pair->Key);
+		WriteCacheInt(out, pair->Value.CountUsed());
+
+		StringMap::Iterator sit(pair->Value);
+		StringMap::Pair *spair;
+		while (sit.NextPair(spair))
+		{
+			const char *name = spair->Key.GetChars();
+			WriteCacheString(out, name, strlen(name));
+			WriteCacheString(out, spair->Value.GetChars(), spair->Value.Len());
+		}
+	}
+
+	FString path = LanguageCachePath();
+	FString temppath = path + ".tmp";
+	FileWriter *fw = FileWriter::Open(temppath);
+	if (fw != nullptr)
+	{
+		bool ok = fw->Write(out.Data(), out.Size()) == out.Size();
+		delete fw;
+		remove(path);
+		if (!ok || rename(temppath, path) != 0) remove(temppath);
+	}
+}
+
+static bool LoadLanguageCache(const uint8_t key[16], FStringTable::LangMap &tables)
+{
+	FileReader fr;
+	if (!fr.OpenFile(LanguageCachePath())) return false;
+	TArray<uint8_t> in = fr.Read();
+	const uint8_t *p = in.Data(), *end = p + in.Size();
+
+	if (in.Size() < 24 || memcmp(p, LanguageCacheMagic, 4) != 0 || memcmp(p + 4, key, 16) != 0) return false;
+	p += 20;
+
+	auto readint = [&](uint32_t &val)
+	{
+		if (end - p < 4) return false;
+		memcpy(&val, p, 4);
+		val = LittleLong(val);
+		p += 4;
+		return true;
+	};
+	auto readstring = [&](const char *&str, uint32_t &len)
+	{
+		if (!readint(len) || uint32_t(end - p) < len) return false;
+		str = (const char *)p;
+		p += len;
+		return true;
+	};
+
+	uint32_t numtables;
+	if (!readint(numtables)) return false;
+	for (uint32_t i = 0; i < numtables; i++)
+	{
+		uint32_t id, numstrings;
+		if (!readint(id) || !readint(numstrings)) return false;
+		StringMap &map = tables[id];
+		for (uint32_t j = 0; j < numstrings; j++)
+		{
+			const char *name, *text;
+			uint32_t namelen, textlen;
+			if (!readstring(name, namelen) || !readstring(text, textlen)) return false;
+			map.Insert(FName(name, namelen, false), FString(text, textlen));
+		}
+	}
+	return p == end;
+}
+
+//==========================================================================
+//
+// Collects the LANGUAGE lumps. Unless language_lazyload is off only the
+// tables for the current language and its fallbacks get stored. Others
+// are loaded when the language changes.
+//
+//==========================================================================
+
 void FStringTable::LoadStrings ()
 {
 	int lastlump, lump;
 
 	lastlump = 0;
+	languageLumps.Clear();
+	loadedTables.Clear();
 
 	while ((lump = Wads.FindLump ("LANGUAGE", &lastlump)) != -1)
 	{
-		LoadLanguage (lump);
+		languageLumps.Push(lump);
+	}
+
+	allTablesLoaded = !language_lazyload;
+	if (allTablesLoaded)
+	{
+		LoadTables(nullptr);
 	}
 	UpdateLanguage();
 }
 
-void FStringTable::LoadLanguage (int lumpnum)
+//==========================================================================
+//
+// Gets the contents of all LANGUAGE lumps, either from the cache or by
+// parsing them, and adds the given tables (or all if ids is null).
+//
+//==========================================================================
+
+void FStringTable::LoadTables (const TArray<uint32_t> *ids)
+{
+	uint8_t key[16];
+	LangMap parsed;
+	bool cached = false;
+	if (language_cache)
+	{
+		LanguageCacheKey(languageLumps, key);
+		cached = LoadLanguageCache(key, parsed);
+		if (!cached) parsed.Clear();
+	}
+	if (!cached)
+	{
+		for (int lumpnum : languageLumps)
+		{
+			LoadLanguage (lumpnum, parsed);
+		}
+		if (language_cache) SaveLanguageCache(key, parsed);
+	}
+
+	LangMap::Iterator it(parsed);
+	LangMap::Pair *pair;
+	while (it.NextPair(pair))
+	{
+		if (ids != nullptr && ids->Find(pair->Key) == ids->Size()) continue;
+
+		StringMap &map = allStrings[pair->Key];
+		StringMap::Iterator sit(pair->Value);
+		StringMap::Pair *spair;
+		while (sit.NextPair(spair))
+		{
+			map.Insert(spair->Key, spair->Value);
+		}
+	}
+}
+
+//==========================================================================
+//
+// Makes sure that a table can be looked up with GetLanguageString.
+//
+//==========================================================================
+
+void FStringTable::EnsureLanguage (uint32_t lang_id)
+{
+	if (!allTablesLoaded && loadedTables.Find(lang_id) == loadedTables.Size())
+	{
+		TArray<uint32_t> ids;
+		ids.Push(lang_id);
+		loadedTables.Push(lang_id);
+		LoadTables(&ids);
+	}
+}
+
+void FStringTable::LoadLanguage (int lumpnum, LangMap &tables)
 {
 	bool errordone = false;
 	TArray<uint32_t> activeMaps;
@@ -165,7 +389,7 @@ void FStringTable::LoadLanguage (int lumpnum)
 				// Insert the string into all relevant tables.
 				for (auto map : activeMaps)
 				{
-					allStrings[map].Insert(strName, strText);
+					tables[map].Insert(strName, strText);
 				}
 			}
 		}
@@ -180,6 +404,23 @@ void FStringTable::UpdateLanguage()
 		MAKE_ID('e', 'n', 'u', '\0') :
 		MAKE_ID(language[0], language[1], language[2], '\0');
 
+	if (!allTablesLoaded)
+	{
+		TArray<uint32_t> missing;
+		for (uint32_t lang_id : { (uint32_t)global_table, (uint32_t)LanguageID, (uint32_t)(LanguageID & MAKE_ID(0xff, 0xff, 0, 0)), (uint32_t)default_table })
+		{
+			if (loadedTables.Find(lang_id) == loadedTables.Size() && missing.Find(lang_id) == missing.Size())
+			{
+				missing.Push(lang_id);
+			}
+		}
+		if (missing.Size() > 0)
+		{
+			loadedTables.Append(missing);
+			LoadTables(&missing);
+		}
+	}
+
 	currentLanguageSet.Clear();
 
 	auto checkone = [&](uint32_t lang_id)
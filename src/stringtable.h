@@ -69,6 +69,7 @@ public:
 
 	void LoadStrings ();
 	void UpdateLanguage();
+	void EnsureLanguage(uint32_t lang_id);
 	StringMap GetDefaultStrings() { return allStrings[default_table]; }	// Dehacked needs these for comparison
 	void SetDehackedStrings(StringMap && map)
 	{
@@ -89,8 +90,12 @@ private:
 
 	LangMap allStrings;
 	TArray<std::pair<uint32_t, StringMap*>> currentLanguageSet;
+	TArray<int> languageLumps;
+	TArray<uint32_t> loadedTables;	// only used when not all tables are loaded
+	bool allTablesLoaded = true;
 
-	void LoadLanguage (int lumpnum);
+	void LoadTables (const TArray<uint32_t> *ids);
+	void LoadLanguage (int lumpnum, LangMap &tables);
 	static size_t ProcessEscapes (char *str);
 };
 
@@ -49,7 +49,7 @@
 #include "r_draw_rgba.h"
 #include "swrenderer/viewport/r_viewport.h"
 #include "swrenderer/scene/r_light.h"
-#ifdef NO_SSE
+#ifndef RT_DRAWERS_SSE2
 #include "r_draw_wall32.h"
 #include "r_draw_sprite32.h"
 #include "r_draw_span32.h"
@@ -612,6 +612,39 @@ namespace swrenderer
 			uint32_t u = (uint32_t)(int64_t(startu) + _pviewx);
 			uint32_t v = (uint32_t)(int64_t(startv) + _pviewy);
 
+#ifdef RT_DRAWERS_SSE2
+			if (_shade_constants.simple_shade)
+			{
+				// Fetch four texels at a time and light them together
+				for (int i = 0; i < SPANSIZE; i += 4)
+				{
+					uint32_t fg[4];
+					int16_t mlight[4];
+					for (int j = 0; j < 4; j++)
+					{
+						uint32_t sx = ((u >> 16) * source_width) >> 16;
+						uint32_t sy = ((v >> 16) * source_height) >> 16;
+						fg[j] = _source[sy + sx * source_height];
+						mlight[j] = (int16_t)LightBgra::calc_light_multiplier(light);
+						u += stepu;
+						v += stepv;
+						light += steplight;
+					}
+
+					__m128i fgcolor = _mm_loadu_si128((const __m128i*)fg);
+					__m128i fglo = _mm_unpacklo_epi8(fgcolor, _mm_setzero_si128());
+					__m128i fghi = _mm_unpackhi_epi8(fgcolor, _mm_setzero_si128());
+					__m128i mlightlo = _mm_set_epi16(mlight[1], mlight[1], mlight[1], mlight[1], mlight[0], mlight[0], mlight[0], mlight[0]);
+					__m128i mlighthi = _mm_set_epi16(mlight[3], mlight[3], mlight[3], mlight[3], mlight[2], mlight[2], mlight[2], mlight[2]);
+					fglo = _mm_srli_epi16(_mm_mullo_epi16(fglo, mlightlo), 8);
+					fghi = _mm_srli_epi16(_mm_mullo_epi16(fghi, mlighthi), 8);
+					__m128i outcolor = _mm_or_si128(_mm_packus_epi16(fglo, fghi), _mm_set1_epi32(0xff000000));
+					_mm_storeu_si128((__m128i*)dest, outcolor);
+					dest += 4;
+				}
+			}
+			else
+#endif
 			for (int i = 0; i < SPANSIZE; i++)
 			{
 				uint32_t sx = ((u >> 16) * source_width) >> 16;
@@ -704,7 +737,7 @@ namespace swrenderer
 		end_blue = (int)(colormap->ColorizeEnd[2] * 255);
 	}
 
-#ifdef NO_SSE
+#ifndef RT_DRAWERS_SSE2
 	void ApplySpecialColormapRGBACommand::Execute(DrawerThread *thread)
 	{
 		int y = thread->skipped_by_thread(0);
@@ -32,6 +32,10 @@
 
 #ifndef NO_SSE
 #include <immintrin.h>
+#define RT_DRAWERS_SSE2
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include "r_draw_sse2neon.h"
+#define RT_DRAWERS_SSE2
 #endif
 
 struct FSpecialColormap;
@@ -0,0 +1,199 @@
+/*
+**  SSE2 intrinsics used by the RT family of drawers, implemented with NEON
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**---------------------------------------------------------------------------
+**
+**  Only the subset of SSE2 the *_sse2.h drawers actually use is provided.
+**  Every function reproduces the exact integer semantics of its x86
+**  counterpart (wrapping, saturation, lane order), so the NEON drawers
+**  produce the same pixels as the SSE2 ones. The only exception is
+**  _mm_rsqrt_ps, whose precision is not specified on x86 either.
+**
+**  AArch64 only - the 32 bit NEON instruction set lacks vzip1q, vcvtnq
+**  and friends, so ARMv7 builds keep using the plain C++ drawers.
+**
+*/
+
+#pragma once
+
+#include <arm_neon.h>
+#include <stdint.h>
+
+typedef int32x4_t __m128i;
+typedef float32x4_t __m128;
+
+#define _MM_SHUFFLE(z, y, x, w) (((z) << 6) | ((y) << 4) | ((x) << 2) | (w))
+
+#define _MM_TRANSPOSE4_PS(row0, row1, row2, row3) \
+	do { \
+		float32x4x2_t t01 = vtrnq_f32(row0, row1); \
+		float32x4x2_t t23 = vtrnq_f32(row2, row3); \
+		row0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0])); \
+		row1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1])); \
+		row2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0])); \
+		row3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1])); \
+	} while (0)
+
+#define SSE2NEON_S16(x) vreinterpretq_s16_s32(x)
+#define SSE2NEON_U16(x) vreinterpretq_u16_s32(x)
+#define SSE2NEON_S8(x) vreinterpretq_s8_s32(x)
+#define SSE2NEON_U32(x) vreinterpretq_u32_s32(x)
+
+// Load / store
+
+static inline __m128i _mm_setzero_si128() { return vdupq_n_s32(0); }
+static inline __m128 _mm_setzero_ps() { return vdupq_n_f32(0.0f); }
+
+static inline __m128i _mm_set1_epi16(short w) { return vreinterpretq_s32_s16(vdupq_n_s16(w)); }
+static inline __m128i _mm_set1_epi32(int i) { return vdupq_n_s32(i); }
+static inline __m128 _mm_set1_ps(float f) { return vdupq_n_f32(f); }
+
+static inline __m128i _mm_set_epi16(short w7, short w6, short w5, short w4, short w3, short w2, short w1, short w0)
+{
+	const int16_t data[8] = { w0, w1, w2, w3, w4, w5, w6, w7 };
+	return vreinterpretq_s32_s16(vld1q_s16(data));
+}
+
+static inline __m128i _mm_setr_epi16(short w0, short w1, short w2, short w3, short w4, short w5, short w6, short w7)
+{
+	const int16_t data[8] = { w0, w1, w2, w3, w4, w5, w6, w7 };
+	return vreinterpretq_s32_s16(vld1q_s16(data));
+}
+
+static inline __m128 _mm_setr_ps(float f0, float f1, float f2, float f3)
+{
+	const float data[4] = { f0, f1, f2, f3 };
+	return vld1q_f32(data);
+}
+
+static inline __m128i _mm_cvtsi32_si128(int a) { return vsetq_lane_s32(a, vdupq_n_s32(0), 0); }
+static inline int _mm_cvtsi128_si32(__m128i a) { return vgetq_lane_s32(a, 0); }
+
+static inline __m128i _mm_loadl_epi64(const __m128i *p) { return vcombine_s32(vld1_s32((const int32_t *)p), vdup_n_s32(0)); }
+static inline __m128i _mm_loadu_si128(const __m128i *p) { return vld1q_s32((const int32_t *)p); }
+static inline void _mm_storel_epi64(__m128i *p, __m128i a) { vst1_s32((int32_t *)p, vget_low_s32(a)); }
+static inline void _mm_storeu_si128(__m128i *p, __m128i a) { vst1q_s32((int32_t *)p, a); }
+
+static inline __m128i _mm_castps_si128(__m128 a) { return vreinterpretq_s32_f32(a); }
+static inline __m128 _mm_castsi128_ps(__m128i a) { return vreinterpretq_f32_s32(a); }
+
+// Integer arithmetic
+
+static inline __m128i _mm_add_epi16(__m128i a, __m128i b) { return vreinterpretq_s32_s16(vaddq_s16(SSE2NEON_S16(a), SSE2NEON_S16(b))); }
+static inline __m128i _mm_sub_epi16(__m128i a, __m128i b) { return vreinterpretq_s32_s16(vsubq_s16(SSE2NEON_S16(a), SSE2NEON_S16(b))); }
+static inline __m128i _mm_min_epi16(__m128i a, __m128i b) { return vreinterpretq_s32_s16(vminq_s16(SSE2NEON_S16(a), SSE2NEON_S16(b))); }
+static inline __m128i _mm_mullo_epi16(__m128i a, __m128i b) { return vreinterpretq_s32_s16(vmulq_s16(SSE2NEON_S16(a), SSE2NEON_S16(b))); }
+
+static inline __m128i _mm_mulhi_epi16(__m128i a, __m128i b)
+{
+	int32x4_t lo = vmull_s16(vget_low_s16(SSE2NEON_S16(a)), vget_low_s16(SSE2NEON_S16(b)));
+	int32x4_t hi = vmull_high_s16(SSE2NEON_S16(a), SSE2NEON_S16(b));
+	return vreinterpretq_s32_s16(vcombine_s16(vshrn_n_s32(lo, 16), vshrn_n_s32(hi, 16)));
+}
+
+static inline __m128i _mm_add_epi32(__m128i a, __m128i b) { return vaddq_s32(a, b); }
+static inline __m128i _mm_sub_epi32(__m128i a, __m128i b) { return vsubq_s32(a, b); }
+static inline __m128i _mm_cmpeq_epi32(__m128i a, __m128i b) { return vreinterpretq_s32_u32(vceqq_s32(a, b)); }
+
+// Shift counts above the lane width give zero (logical) or the sign (arithmetic), as on x86.
+static inline __m128i _mm_srli_epi16(__m128i a, int count) { return vreinterpretq_s32_u16(vshlq_u16(SSE2NEON_U16(a), vdupq_n_s16((int16_t)-(count > 16 ? 16 : count)))); }
+static inline __m128i _mm_srli_epi32(__m128i a, int count) { return vreinterpretq_s32_u32(vshlq_u32(SSE2NEON_U32(a), vdupq_n_s32(-(count > 32 ? 32 : count)))); }
+static inline __m128i _mm_srai_epi32(__m128i a, int count) { return vshlq_s32(a, vdupq_n_s32(-(count > 31 ? 31 : count))); }
+
+// Logical
+
+static inline __m128i _mm_and_si128(__m128i a, __m128i b) { return vandq_s32(a, b); }
+static inline __m128i _mm_andnot_si128(__m128i a, __m128i b) { return vbicq_s32(b, a); }
+static inline __m128i _mm_or_si128(__m128i a, __m128i b) { return vorrq_s32(a, b); }
+
+// Packing
+
+static inline __m128i _mm_packs_epi32(__m128i a, __m128i b) { return vreinterpretq_s32_s16(vcombine_s16(vqmovn_s32(a), vqmovn_s32(b))); }
+static inline __m128i _mm_packus_epi16(__m128i a, __m128i b) { return vreinterpretq_s32_u8(vcombine_u8(vqmovun_s16(SSE2NEON_S16(a)), vqmovun_s16(SSE2NEON_S16(b)))); }
+
+static inline __m128i _mm_unpacklo_epi8(__m128i a, __m128i b) { return vreinterpretq_s32_s8(vzip1q_s8(SSE2NEON_S8(a), SSE2NEON_S8(b))); }
+static inline __m128i _mm_unpackhi_epi8(__m128i a, __m128i b) { return vreinterpretq_s32_s8(vzip2q_s8(SSE2NEON_S8(a), SSE2NEON_S8(b))); }
+static inline __m128i _mm_unpacklo_epi16(__m128i a, __m128i b) { return vreinterpretq_s32_s16(vzip1q_s16(SSE2NEON_S16(a), SSE2NEON_S16(b))); }
+static inline __m128i _mm_unpackhi_epi16(__m128i a, __m128i b) { return vreinterpretq_s32_s16(vzip2q_s16(SSE2NEON_S16(a), SSE2NEON_S16(b))); }
+
+// Shuffles. The lane selectors must be constant expressions for NEON, hence the templates.
+
+template<int imm>
+static inline __m128i sse2neon_shuffle_epi32(__m128i a)
+{
+	__m128i r = vdupq_n_s32(vgetq_lane_s32(a, imm & 3));
+	r = vsetq_lane_s32(vgetq_lane_s32(a, (imm >> 2) & 3), r, 1);
+	r = vsetq_lane_s32(vgetq_lane_s32(a, (imm >> 4) & 3), r, 2);
+	return vsetq_lane_s32(vgetq_lane_s32(a, (imm >> 6) & 3), r, 3);
+}
+
+template<int imm>
+static inline __m128i sse2neon_shufflelo_epi16(__m128i a)
+{
+	int16x8_t v = SSE2NEON_S16(a);
+	int16x8_t r = v;
+	r = vsetq_lane_s16(vgetq_lane_s16(v, imm & 3), r, 0);
+	r = vsetq_lane_s16(vgetq_lane_s16(v, (imm >> 2) & 3), r, 1);
+	r = vsetq_lane_s16(vgetq_lane_s16(v, (imm >> 4) & 3), r, 2);
+	r = vsetq_lane_s16(vgetq_lane_s16(v, (imm >> 6) & 3), r, 3);
+	return vreinterpretq_s32_s16(r);
+}
+
+template<int imm>
+static inline __m128i sse2neon_shufflehi_epi16(__m128i a)
+{
+	int16x8_t v = SSE2NEON_S16(a);
+	int16x8_t r = v;
+	r = vsetq_lane_s16(vgetq_lane_s16(v, 4 + (imm & 3)), r, 4);
+	r = vsetq_lane_s16(vgetq_lane_s16(v, 4 + ((imm >> 2) & 3)), r, 5);
+	r = vsetq_lane_s16(vgetq_lane_s16(v, 4 + ((imm >> 4) & 3)), r, 6);
+	r = vsetq_lane_s16(vgetq_lane_s16(v, 4 + ((imm >> 6) & 3)), r, 7);
+	return vreinterpretq_s32_s16(r);
+}
+
+#define _mm_shuffle_epi32(a, imm) sse2neon_shuffle_epi32<(imm)>(a)
+#define _mm_shufflelo_epi16(a, imm) sse2neon_shufflelo_epi16<(imm)>(a)
+#define _mm_shufflehi_epi16(a, imm) sse2neon_shufflehi_epi16<(imm)>(a)
+
+// Floating point
+
+static inline __m128 _mm_add_ps(__m128 a, __m128 b) { return vaddq_f32(a, b); }
+static inline __m128 _mm_sub_ps(__m128 a, __m128 b) { return vsubq_f32(a, b); }
+static inline __m128 _mm_mul_ps(__m128 a, __m128 b) { return vmulq_f32(a, b); }
+static inline __m128 _mm_min_ps(__m128 a, __m128 b) { return vminq_f32(a, b); }
+
+static inline __m128 _mm_and_ps(__m128 a, __m128 b) { return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+static inline __m128 _mm_andnot_ps(__m128 a, __m128 b) { return vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(b), vreinterpretq_u32_f32(a))); }
+static inline __m128 _mm_or_ps(__m128 a, __m128 b) { return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+static inline __m128 _mm_cmpeq_ps(__m128 a, __m128 b) { return vreinterpretq_f32_u32(vceqq_f32(a, b)); }
+
+// Round to nearest even, the default MXCSR mode.
+static inline __m128i _mm_cvtps_epi32(__m128 a) { return vcvtnq_s32_f32(a); }
+
+// One Newton-Raphson step on top of the estimate, roughly matching the x86 precision.
+static inline __m128 _mm_rsqrt_ps(__m128 a)
+{
+	float32x4_t e = vrsqrteq_f32(a);
+	return vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(a, e), e));
+}
+
+#undef SSE2NEON_S16
+#undef SSE2NEON_U16
+#undef SSE2NEON_S8
+#undef SSE2NEON_U32
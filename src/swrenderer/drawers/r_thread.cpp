@@ -33,7 +33,11 @@
 #include "r_thread.h"
 #include "swrenderer/r_memory.h"
 #include "swrenderer/r_renderthread.h"
+#include "stats.h"
+#include "c_dispatch.h"
+#include "jobs.h"
 #include <chrono>
+#include <algorithm>
 
 #ifdef WIN32
 void PeekThreadedErrorPane();
@@ -41,6 +45,7 @@ void PeekThreadedErrorPane();
 
 CVAR(Int, r_multithreaded, 1, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
 CVAR(Int, r_debug_draw, 0, 0);
+CVAR(Bool, r_drawer_bands, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
 
 /////////////////////////////////////////////////////////////////////////////
 
@@ -59,7 +64,41 @@ DrawerThreads::~DrawerThreads()
 	StopThreads();
 }
 
-void DrawerThreads::Execute(DrawerCommandQueuePtr commands)
+// Drawer queue flush statistics of the last completed frame
+static struct
+{
+	std::atomic<uint64_t> wake_total { 0 };
+	std::atomic<uint64_t> wake_max { 0 };
+	size_t queues = 0;
+	uint64_t wait_time = 0;
+} DrawerQueueStats, LastDrawerQueueStats;
+
+static uint64_t DrawerTimeNS()
+{
+	using namespace std::chrono;
+	return (uint64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Busy waits for a short while before the caller falls back to blocking on a condition variable.
+// Handing work over this way costs microseconds, while a park and wake up costs a context switch.
+template<typename Condition>
+static bool SpinWaitFor(Condition condition)
+{
+	uint64_t start = DrawerTimeNS();
+	for (int i = 0; ; i++)
+	{
+		if (condition())
+			return true;
+		if ((i & 63) == 63)
+		{
+			if (DrawerTimeNS() - start > 50000)
+				return false;
+			std::this_thread::yield();
+		}
+	}
+}
+
+void DrawerThreads::Execute(DrawerCommandQueuePtr commands, bool columnband)
 {
 	if (!commands || commands->commands.empty())
 		return;
@@ -68,14 +107,35 @@ void DrawerThreads::Execute(DrawerCommandQueuePtr commands)
 
 	queue->StartThreads();
 
-	// Add to queue and awaken worker threads
+	// Scene slice threads may submit at the same time. The lock only orders them, the workers never take it.
+	// If the ring is full, drain it first.
+	std::unique_lock<std::mutex> submit_lock(queue->submit_mutex);
+	size_t seq = queue->queues_submitted.load(std::memory_order_relaxed);
+	if (seq - queue->ring_tail == MaxActiveQueues)
+	{
+		queue->Recycle();
+		seq = queue->queues_submitted.load(std::memory_order_relaxed);
+	}
+
+	commands->run_as_band = columnband && r_drawer_bands && !r_debug_draw && queue->threads.size() > 1;
+	commands->band_claimed = false;
+	if (commands->run_as_band)
+		queue->bands_submitted++;
+	commands->bands_before = queue->bands_submitted;
+	commands->started = false;
+	commands->submit_time = DrawerTimeNS();
+
+	queue->tasks_left.fetch_add(queue->threads.size());
+	queue->command_ring[seq % MaxActiveQueues] = commands;
+	queue->queues_submitted.store(seq + 1, std::memory_order_release);
+	submit_lock.unlock();
+
+	// Awaken worker threads that gave up spinning
 	std::unique_lock<std::mutex> start_lock(queue->start_mutex);
-	std::unique_lock<std::mutex> end_lock(queue->end_mutex);
-	queue->active_commands.push_back(commands);
-	queue->tasks_left += queue->threads.size();
-	end_lock.unlock();
+	bool wake = queue->parked_workers > 0;
 	start_lock.unlock();
-	queue->start_condition.notify_all();
+	if (wake)
+		queue->start_condition.notify_all();
 }
 
 void DrawerThreads::ResetDebugDrawPos()
@@ -96,54 +156,196 @@ void DrawerThreads::ResetDebugDrawPos()
 }
 
 void DrawerThreads::WaitForWorkers()
+{
+	auto queue = Instance();
+	std::unique_lock<std::mutex> submit_lock(queue->submit_mutex);
+	queue->Recycle();
+}
+
+void DrawerThreads::Recycle()
 {
 	using namespace std::chrono_literals;
 
 	// Wait for workers to finish
-	auto queue = Instance();
-	std::unique_lock<std::mutex> end_lock(queue->end_mutex);
-	if (!queue->end_condition.wait_for(end_lock, 5s, [&]() { return queue->tasks_left == 0; }))
+	uint64_t wait_start = DrawerTimeNS();
+	if (!SpinWaitFor([&]() { return tasks_left.load() == 0; }))
 	{
+		std::unique_lock<std::mutex> end_lock(end_mutex);
+		if (!end_condition.wait_for(end_lock, 5s, [&]() { return tasks_left.load() == 0; }))
+		{
 #ifdef WIN32
-		PeekThreadedErrorPane();
+			PeekThreadedErrorPane();
 #endif
-		// Invoke the crash reporter so that we can capture the call stack of whatever the hung worker thread is doing
-		int *threadCrashed = nullptr;
-		*threadCrashed = 0xdeadbeef;
+			// Invoke the crash reporter so that we can capture the call stack of whatever the hung worker thread is doing
+			int *threadCrashed = nullptr;
+			*threadCrashed = 0xdeadbeef;
+		}
 	}
-	end_lock.unlock();
+	DrawerQueueStats.wait_time += DrawerTimeNS() - wait_start;
 
 	// Clean up
-	std::unique_lock<std::mutex> start_lock(queue->start_mutex);
-	for (auto &thread : queue->threads)
-		thread.current_queue = 0;
+	size_t submitted = queues_submitted.load(std::memory_order_relaxed);
+	for (size_t seq = ring_tail; seq < submitted; seq++)
+	{
+		DrawerCommandQueuePtr &list = command_ring[seq % MaxActiveQueues];
+		if (replaying)
+		{
+			// The commands belong to the capture
+		}
+		else if (capturing)
+		{
+			// The queue object itself gets reused, so keep a copy of its command list
+			auto copy = std::make_shared<DrawerCommandQueue>(list->FrameMemory);
+			copy->commands = list->commands;
+			captured.push_back(copy);
+			captured_bands.push_back(list->run_as_band);
+			list->Clear();
+		}
+		else
+		{
+			for (auto &command : list->commands)
+				command->~DrawerCommand();
+			list->Clear();
+		}
+		list.reset();
+	}
+	ring_tail = submitted;
+
+	bands_submitted = 0;
+	bands_finished = 0;
+}
+
+void DrawerThreads::EndFrameStats()
+{
+	auto queue = Instance();
+	std::unique_lock<std::mutex> submit_lock(queue->submit_mutex);
+	LastDrawerQueueStats.wake_total = DrawerQueueStats.wake_total.exchange(0);
+	LastDrawerQueueStats.wake_max = DrawerQueueStats.wake_max.exchange(0);
+	LastDrawerQueueStats.queues = queue->queues_submitted.load(std::memory_order_relaxed) - queue->frame_start_seq;
+	LastDrawerQueueStats.wait_time = DrawerQueueStats.wait_time;
+	DrawerQueueStats.wait_time = 0;
+	queue->frame_start_seq = queue->queues_submitted.load(std::memory_order_relaxed);
+}
 
-	for (auto &list : queue->active_commands)
+static int ReplayIterations;
+
+CCMD(replaydrawers)
+{
+	ReplayIterations = argv.argc() > 1 ? MAX(atoi(argv[1]), 1) : 100;
+}
+
+void DrawerThreads::BeginFrameCapture()
+{
+	if (ReplayIterations == 0)
+		return;
+
+	auto queue = Instance();
+	std::unique_lock<std::mutex> submit_lock(queue->submit_mutex);
+	queue->Recycle();
+	queue->capturing = true;
+}
+
+void DrawerThreads::ReplayFrameCapture()
+{
+	auto queue = Instance();
+	if (!queue->capturing)
+		return;
+
+	int iterations = ReplayIterations;
+	ReplayIterations = 0;
+	{
+		std::unique_lock<std::mutex> submit_lock(queue->submit_mutex);
+		queue->Recycle();
+		queue->capturing = false;
+	}
+
+	auto &captured = queue->captured;
+	size_t numqueues = captured.size();
+	size_t numcommands = 0;
+	for (auto &list : captured)
+		numcommands += list->commands.size();
+	if (numcommands == 0)
+	{
+		Printf("No drawer commands were queued. replaydrawers needs r_multithreaded.\n");
+		captured.clear();
+		queue->captured_bands.clear();
+		return;
+	}
+
+	// The screen gets drawn over again and again, so translucent parts of this frame will look wrong.
+	TArray<double> times;
+	queue->replaying = true;
+	for (int i = 0; i < iterations; i++)
+	{
+		uint64_t start = DrawerTimeNS();
+		for (size_t j = 0; j < captured.size(); j++)
+		{
+			for (auto &command : captured[j]->commands)
+				command->Rewind();
+			Execute(captured[j], queue->captured_bands[j]);
+		}
+		WaitForWorkers();
+		times.Push((DrawerTimeNS() - start) / 1e6);
+	}
+	queue->replaying = false;
+
+	for (auto &list : captured)
 	{
 		for (auto &command : list->commands)
 			command->~DrawerCommand();
-		list->Clear();
 	}
-	queue->active_commands.clear();
+	captured.clear();
+	queue->captured_bands.clear();
+
+	std::sort(times.begin(), times.end());
+	double total = 0;
+	for (double t : times)
+		total += t;
+	Printf("Replayed %d queues with %d commands %d times on %d threads\n", (int)numqueues, (int)numcommands, iterations, (int)queue->threads.size());
+	Printf("min %.3f ms, avg %.3f ms, median %.3f ms, max %.3f ms\n", times[0], total / times.Size(), times[times.Size() / 2], times.Last());
+}
+
+bool DrawerThreads::WaitForWork(DrawerThread *thread)
+{
+	if (SpinWaitFor([&]() { return thread->current_queue < queues_submitted.load(std::memory_order_acquire) || shutdown_flag; }))
+		return !shutdown_flag;
+
+	std::unique_lock<std::mutex> start_lock(start_mutex);
+	parked_workers++;
+	start_condition.wait(start_lock, [&]() { return thread->current_queue < queues_submitted.load(std::memory_order_acquire) || shutdown_flag; });
+	parked_workers--;
+	return !shutdown_flag;
 }
 
 void DrawerThreads::WorkerMain(DrawerThread *thread)
 {
 	while (true)
 	{
-		// Wait until we are signalled to run:
-		std::unique_lock<std::mutex> start_lock(start_mutex);
-		start_condition.wait(start_lock, [&]() { return thread->current_queue < active_commands.size() || shutdown_flag; });
-		if (shutdown_flag)
+		// Wait until there is a queue we have not run yet:
+		if (!WaitForWork(thread))
 			break;
 
-		// Grab the commands
-		DrawerCommandQueuePtr list = active_commands[thread->current_queue];
+		// Grab the commands. The slot stays valid until this worker has counted itself out of tasks_left.
+		DrawerCommandQueue *list = command_ring[thread->current_queue % MaxActiveQueues].get();
 		thread->current_queue++;
-		start_lock.unlock();
+		PROFILE_ZONE("Drawer queue");
+
+		if (!list->started.exchange(true))
+		{
+			uint64_t wake = DrawerTimeNS() - list->submit_time;
+			DrawerQueueStats.wake_total += wake;
+			uint64_t prevmax = DrawerQueueStats.wake_max;
+			while (wake > prevmax && !DrawerQueueStats.wake_max.compare_exchange_weak(prevmax, wake)) { }
+		}
 
 		// Do the work:
-		if (r_debug_draw)
+		if (list->run_as_band)
+		{
+			// Whoever gets here first runs the whole band. The others move on to the next queue.
+			if (!list->band_claimed.exchange(true))
+				RunBand(thread, list);
+		}
+		else if (r_debug_draw)
 		{
 			for (auto& command : list->commands)
 			{
@@ -154,6 +356,7 @@ void DrawerThreads::WorkerMain(DrawerThread *thread)
 		}
 		else
 		{
+			WaitForBands(list);
 			for (auto& command : list->commands)
 			{
 				command->Execute(thread);
@@ -161,13 +364,37 @@ void DrawerThreads::WorkerMain(DrawerThread *thread)
 		}
 
 		// Notify main thread that we finished:
-		std::unique_lock<std::mutex> end_lock(end_mutex);
-		tasks_left--;
-		bool finishedTasks = tasks_left == 0;
-		end_lock.unlock();
-		if (finishedTasks)
+		if (tasks_left.fetch_sub(1) == 1)
+		{
+			std::unique_lock<std::mutex> end_lock(end_mutex);
+			end_lock.unlock();
 			end_condition.notify_all();
+		}
+	}
+}
+
+void DrawerThreads::RunBand(DrawerThread *thread, DrawerCommandQueue *list)
+{
+	DrawerThread *bandthread = &band_threads[thread->core];
+	for (auto& command : list->commands)
+	{
+		command->Execute(bandthread);
 	}
+
+	bands_finished.fetch_add(1);
+	std::unique_lock<std::mutex> band_lock(band_mutex);
+	band_lock.unlock();
+	band_condition.notify_all();
+}
+
+void DrawerThreads::WaitForBands(DrawerCommandQueue *list)
+{
+	// Interleaved queues may overlap any band, so every band submitted before them must be complete
+	if (SpinWaitFor([&]() { return bands_finished.load() >= list->bands_before; }))
+		return;
+
+	std::unique_lock<std::mutex> band_lock(band_mutex);
+	band_condition.wait(band_lock, [&]() { return bands_finished.load() >= list->bands_before; });
 }
 
 void DrawerThreads::StartThreads()
@@ -181,6 +408,11 @@ void DrawerThreads::StartThreads()
 		if (r_multithreaded == 1)
 			Printf ("Could not determine number of CPU cores (assuming 2). Set r_multithreaded.\n");
 	}
+	else if (FJobSystem::Topology().IsHeterogeneous())
+	{
+		// Every thread gets an equal share, so the slow cores would hold up the fast ones.
+		num_threads = FJobSystem::Topology().NumFastCores;
+	}
 
 	if (r_multithreaded == 0)
 		num_threads = 1;
@@ -189,9 +421,12 @@ void DrawerThreads::StartThreads()
 
 	if (num_threads != (int)threads.size())
 	{
+		// Let the old workers finish their queues, the new ones start at the next submission
+		WaitForWorkers();
 		StopThreads();
 
 		threads.resize(num_threads);
+		band_threads.resize(num_threads);
 
 		for (int i = 0; i < num_threads; i++)
 		{
@@ -199,7 +434,8 @@ void DrawerThreads::StartThreads()
 			DrawerThread *thread = &threads[i];
 			thread->core = i;
 			thread->num_cores = num_threads;
-			thread->thread = std::thread([=]() { queue->WorkerMain(thread); });
+			thread->current_queue = queues_submitted.load();
+			thread->thread = std::thread([=]() { FJobSystem::PinThread(JOB_Frame); queue->WorkerMain(thread); });
 		}
 	}
 }
@@ -213,6 +449,7 @@ void DrawerThreads::StopThreads()
 	for (auto &thread : threads)
 		thread.thread.join();
 	threads.clear();
+	band_threads.clear();
 	lock.lock();
 	shutdown_flag = false;
 }
@@ -232,8 +469,30 @@ void *DrawerCommandQueue::AllocMemory(size_t size)
 
 void GroupMemoryBarrierCommand::Execute(DrawerThread *thread)
 {
+	size_t num_cores = thread->num_cores;
+	if (count.fetch_add(1) + 1 >= num_cores)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		lock.unlock();
+		condition.notify_all();
+		return;
+	}
+
+	if (SpinWaitFor([&]() { return count.load() >= num_cores; }))
+		return;
+
 	std::unique_lock<std::mutex> lock(mutex);
-	count++;
-	condition.notify_all();
-	condition.wait(lock, [&]() { return count >= thread->num_cores; });
+	condition.wait(lock, [&]() { return count.load() >= num_cores; });
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+ADD_STAT(drawerqueues)
+{
+	size_t queues = LastDrawerQueueStats.queues;
+	double wake_avg = queues ? LastDrawerQueueStats.wake_total / (double)queues / 1000.0 : 0.0;
+	FString out;
+	out.Format("queues=%d  wake avg=%.1f us  wake max=%.1f us  wait=%.1f us", (int)queues, wake_avg,
+		LastDrawerQueueStats.wake_max / 1000.0, LastDrawerQueueStats.wait_time / 1000.0);
+	return out;
 }
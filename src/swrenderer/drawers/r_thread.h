@@ -27,11 +27,15 @@
 #include <memory>
 #include <thread>
 #include <mutex>
+#include <atomic>
 #include <condition_variable>
 
 // Use multiple threads when drawing
 EXTERN_CVAR(Int, r_multithreaded)
 
+// Let a single worker run each scene slice queue instead of interleaving its lines across all workers
+EXTERN_CVAR(Bool, r_drawer_bands)
+
 class PolyTriangleThreadData;
 
 // Worker data for each thread executing drawer commands
@@ -95,6 +99,9 @@ public:
 	virtual ~DrawerCommand() { }
 
 	virtual void Execute(DrawerThread *thread) = 0;
+
+	// Prepares the command for another run by replaydrawers
+	virtual void Rewind() { }
 };
 
 // Wait for all worker threads before executing next command
@@ -102,11 +109,12 @@ class GroupMemoryBarrierCommand : public DrawerCommand
 {
 public:
 	void Execute(DrawerThread *thread);
+	void Rewind() override { count = 0; }
 
 private:
 	std::mutex mutex;
 	std::condition_variable condition;
-	size_t count = 0;
+	std::atomic<size_t> count { 0 };
 };
 
 class DrawerCommandQueue;
@@ -115,13 +123,22 @@ typedef std::shared_ptr<DrawerCommandQueue> DrawerCommandQueuePtr;
 class DrawerThreads
 {
 public:
-	// Runs the collected commands on worker threads
-	static void Execute(DrawerCommandQueuePtr queue);
+	// Runs the collected commands on worker threads.
+	// A column band queue only touches pixels no other band queue of the frame touches, so it may run on one worker alone.
+	static void Execute(DrawerCommandQueuePtr queue, bool columnband = false);
 
 	// Waits for all commands to finish executing
 	static void WaitForWorkers();
 
+	// Latches the queue flush statistics shown by stat drawerqueues
+	static void EndFrameStats();
+
 	static void ResetDebugDrawPos();
+
+	// Keeps the commands of the frame that starts if replaydrawers was used,
+	// and runs them again in a loop with timing once the frame has finished.
+	static void BeginFrameCapture();
+	static void ReplayFrameCapture();
 	
 private:
 	DrawerThreads();
@@ -130,23 +147,50 @@ private:
 	void StartThreads();
 	void StopThreads();
 	void WorkerMain(DrawerThread *thread);
+	bool WaitForWork(DrawerThread *thread);
+	void Recycle();
+	void RunBand(DrawerThread *thread, DrawerCommandQueue *list);
+	void WaitForBands(DrawerCommandQueue *list);
 
 	static DrawerThreads *Instance();
 	
 	std::mutex threads_mutex;
 	std::vector<DrawerThread> threads;
 
+	// Submitted queues. Writers hold submit_mutex, workers follow queues_submitted with their current_queue.
+	enum { MaxActiveQueues = 256 };
+	std::mutex submit_mutex;
+	DrawerCommandQueuePtr command_ring[MaxActiveQueues];
+	std::atomic<size_t> queues_submitted { 0 };
+	size_t ring_tail = 0;
+	size_t frame_start_seq = 0;
+
+	// Workers spin for a moment before parking here
 	std::mutex start_mutex;
 	std::condition_variable start_condition;
-	std::vector<DrawerCommandQueuePtr> active_commands;
-	bool shutdown_flag = false;
+	int parked_workers = 0;
+	std::atomic<bool> shutdown_flag { false };
 
 	std::mutex end_mutex;
 	std::condition_variable end_condition;
-	size_t tasks_left = 0;
+	std::atomic<size_t> tasks_left { 0 };
+
+	// Single line (core 0 of 1) thread data used by each worker while it runs a band queue by itself
+	std::vector<DrawerThread> band_threads;
+
+	std::mutex band_mutex;
+	std::condition_variable band_condition;
+	size_t bands_submitted = 0;
+	std::atomic<size_t> bands_finished { 0 };
 
 	size_t debug_draw_end = 0;
 
+	// Frame capture for replaydrawers. Captured commands stay valid until the frame memory is cleared by the next frame.
+	bool capturing = false;
+	bool replaying = false;
+	std::vector<DrawerCommandQueuePtr> captured;
+	std::vector<bool> captured_bands;
+
 	DrawerThread single_core_thread;
 	
 	friend class DrawerCommandQueue;
@@ -187,6 +231,13 @@ private:
 	
 	std::vector<DrawerCommand *> commands;
 	RenderMemory *FrameMemory;
+
+	// Scheduling state for the current DrawerThreads::Execute
+	bool run_as_band = false;
+	std::atomic<bool> band_claimed { false };
+	size_t bands_before = 0;
+	std::atomic<bool> started { false };
+	uint64_t submit_time = 0;
 	
 	friend class DrawerThreads;
 };
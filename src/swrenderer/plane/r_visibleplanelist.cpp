@@ -51,9 +51,16 @@
 #include "swrenderer/drawers/r_draw.h"
 #include "swrenderer/viewport/r_viewport.h"
 #include "swrenderer/r_renderthread.h"
+#include <atomic>
+
+CVAR(Bool, r_mergeplanes, true, 0);
 
 namespace swrenderer
 {
+	// Visplane counters for stat visplanes. The main thread latches them when it starts a new frame.
+	static std::atomic<int> PlanesFound, PlanesCreated, PlanesMerged, PlaneProbes;
+	static int LastPlanesFound, LastPlanesCreated, LastPlanesMerged, LastPlaneProbes;
+
 	VisiblePlaneList::VisiblePlaneList(RenderThread *thread)
 	{
 		Thread = thread;
@@ -65,8 +72,26 @@ namespace swrenderer
 			plane = nullptr;
 	}
 
+	unsigned VisiblePlaneList::CalcHash(int picnum, int lightlevel, const secplane_t &height, const FDynamicColormap *colormap)
+	{
+		// Many sectors in vanilla maps share texture and light and only differ in height, so every
+		// part of the key has to reach all the bucket bits. Finalizer from MurmurHash3.
+		uint32_t h = (uint32_t)picnum * 0x9e3779b1u;
+		h ^= (uint32_t)lightlevel * 0x85ebca6bu;
+		h ^= (uint32_t)FLOAT2FIXED(height.fD()) * 0xc2b2ae35u;
+		h ^= (uint32_t)FLOAT2FIXED(height.fC()) * 0x27d4eb2fu;
+		h ^= (uint32_t)(((uintptr_t)colormap) >> 4);
+		h ^= h >> 16;
+		h *= 0x85ebca6bu;
+		h ^= h >> 13;
+		h *= 0xc2b2ae35u;
+		h ^= h >> 16;
+		return h & (MAXVISPLANES - 1);
+	}
+
 	VisiblePlane *VisiblePlaneList::Add(unsigned hash)
 	{
+		PlanesCreated++;
 		VisiblePlane *newplane = Thread->FrameMemory->NewObject<VisiblePlane>(Thread);
 		newplane->next = visplanes[hash];
 		visplanes[hash] = newplane;
@@ -77,6 +102,14 @@ namespace swrenderer
 	{
 		for (int i = 0; i <= MAXVISPLANES; i++)
 			visplanes[i] = nullptr;
+
+		if (Thread->MainThread)
+		{
+			LastPlanesFound = PlanesFound.exchange(0);
+			LastPlanesCreated = PlanesCreated.exchange(0);
+			LastPlanesMerged = PlanesMerged.exchange(0);
+			LastPlaneProbes = PlaneProbes.exchange(0);
+		}
 	}
 
 	void VisiblePlaneList::ClearKeepFakePlanes()
@@ -147,10 +180,13 @@ namespace swrenderer
 		}
 
 		// New visplane algorithm uses hash table -- killough
-		hash = isskybox ? ((unsigned)MAXVISPLANES) : CalcHash(picnum.GetIndex(), lightlevel, height);
+		// The hash is made from the stored key so that GetRange puts split planes in the same chain.
+		hash = isskybox ? ((unsigned)MAXVISPLANES) : CalcHash(picnum.GetIndex(), lightlevel, plane, basecolormap);
 		
+		int probes = 0;
 		for (check = visplanes[hash]; check; check = check->next)	// killough
 		{
+			probes++;
 			if (isskybox)
 			{
 				if (portal == check->portal && plane == check->height)
@@ -180,11 +216,15 @@ namespace swrenderer
 								)
 							)
 						{
+							PlaneProbes += probes;
+							PlanesFound++;
 							return check;
 						}
 					}
 					else
 					{
+						PlaneProbes += probes;
+						PlanesFound++;
 						return check;
 					}
 				}
@@ -202,9 +242,12 @@ namespace swrenderer
 					Thread->Viewport->viewpoint.Pos == check->viewpos
 					)
 				{
+					PlaneProbes += probes;
+					PlanesFound++;
 					return check;
 				}
 		}
+		PlaneProbes += probes;
 
 		check = Add(hash);		// killough
 
@@ -279,7 +322,7 @@ namespace swrenderer
 			}
 			else
 			{
-				hash = CalcHash(pl->picnum.GetIndex(), pl->lightlevel, pl->height);
+				hash = CalcHash(pl->picnum.GetIndex(), pl->lightlevel, pl->height, pl->colormap);
 			}
 			VisiblePlane *new_pl = Add(hash);
 
@@ -341,6 +384,9 @@ namespace swrenderer
 
 		for (i = 0; i < MAXVISPLANES; i++)
 		{
+			if (r_mergeplanes)
+				MergePlanes(i);
+
 			for (pl = visplanes[i]; pl; pl = pl->next)
 			{
 				// kg3D - draw only correct planes
@@ -360,6 +406,79 @@ namespace swrenderer
 		return vpcount;
 	}
 
+	bool VisiblePlaneList::CanMerge(const VisiblePlane *a, const VisiblePlane *b)
+	{
+		if (!(a->height == b->height &&
+			a->picnum == b->picnum &&
+			a->lightlevel == b->lightlevel &&
+			a->colormap == b->colormap &&
+			a->xform == b->xform &&
+			a->sky == b->sky &&
+			a->portal == b->portal &&
+			a->lights == b->lights &&
+			a->extralight == b->extralight &&
+			a->visibility == b->visibility &&
+			a->viewpos == b->viewpos &&
+			a->viewangle == b->viewangle &&
+			a->Alpha == b->Alpha &&
+			a->Additive == b->Additive &&
+			a->CurrentPortalUniq == b->CurrentPortalUniq &&
+			a->MirrorFlags == b->MirrorFlags &&
+			a->CurrentSkybox == b->CurrentSkybox))
+		{
+			return false;
+		}
+
+		// The planes may only share columns that one of them leaves empty
+		int x1 = MAX(a->left, b->left);
+		int x2 = MIN(a->right, b->right);
+		for (int x = x1; x < x2; x++)
+		{
+			if (a->top[x] != 0x7fff && b->top[x] != 0x7fff)
+				return false;
+		}
+		return true;
+	}
+
+	// GetRange splits a plane whenever it is revisited over columns it already covers.
+	// Once the walls are done, pieces with the same key that ended up disjoint can be drawn as one.
+	void VisiblePlaneList::MergePlanes(int hash)
+	{
+		RenderPortal *renderportal = Thread->Portal.get();
+
+		for (VisiblePlane *pl = visplanes[hash]; pl; pl = pl->next)
+		{
+			if (pl->sky < 0 || pl->left >= pl->right || pl->CurrentPortalUniq != renderportal->CurrentPortalUniq || pl->CurrentSkybox != Thread->Clip3D->CurrentSkybox)
+				continue;
+
+			for (VisiblePlane **probe = &pl->next; *probe != nullptr; )
+			{
+				VisiblePlane *other = *probe;
+				if (other->left < other->right && CanMerge(pl, other))
+				{
+					for (int x = other->left; x < other->right; x++)
+					{
+						if (other->top[x] != 0x7fff)
+						{
+							pl->top[x] = other->top[x];
+							pl->bottom[x] = other->bottom[x];
+						}
+					}
+					pl->left = MIN(pl->left, other->left);
+					pl->right = MAX(pl->right, other->right);
+
+					*probe = other->next;
+					other->next = nullptr;
+					PlanesMerged++;
+				}
+				else
+				{
+					probe = &other->next;
+				}
+			}
+		}
+	}
+
 	void VisiblePlaneList::RenderHeight(double height)
 	{
 		VisiblePlane *pl;
@@ -390,4 +509,13 @@ namespace swrenderer
 		Thread->Viewport->viewpoint.Pos = oViewPos;
 		Thread->Viewport->viewpoint.Angles.Yaw = oViewAngle;
 	}
+
+	ADD_STAT(visplanes)
+	{
+		int lookups = LastPlanesFound + LastPlanesCreated;
+		FString out;
+		out.Format("found=%d  created=%d  merged=%d  probes/lookup=%.2f", LastPlanesFound, LastPlanesCreated, LastPlanesMerged,
+			lookups ? LastPlaneProbes / (double)lookups : 0.0);
+		return out;
+	}
 }
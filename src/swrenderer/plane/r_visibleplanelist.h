@@ -55,10 +55,12 @@ namespace swrenderer
 	private:
 		VisiblePlaneList();
 		VisiblePlane *Add(unsigned hash);
+		void MergePlanes(int hash);
 
-		enum { MAXVISPLANES = 128 }; // must be a power of 2
+		enum { MAXVISPLANES = 512 }; // must be a power of 2
 		VisiblePlane *visplanes[MAXVISPLANES + 1];
 
-		static unsigned CalcHash(int picnum, int lightlevel, const secplane_t &height) { return (unsigned)((picnum) * 3 + (lightlevel)+(FLOAT2FIXED((height).fD())) * 7) & (MAXVISPLANES - 1); }
+		static unsigned CalcHash(int picnum, int lightlevel, const secplane_t &height, const FDynamicColormap *colormap);
+		static bool CanMerge(const VisiblePlane *a, const VisiblePlane *b);
 	};
 }
@@ -38,9 +38,72 @@
 #include "r_data/colormaps.h"
 #include "r_memory.h"
 
+#include "stats.h"
+#include <atomic>
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
+
+// Numbers for stat rendermemory, shared by all render threads
+static std::atomic<int> BlocksAllocated;
+static std::atomic<int64_t> BytesAllocated;
+static std::atomic<int> SystemAllocations;
+static std::atomic<int> OversizedAllocations;
+
+RenderMemory::MemoryBlock::MemoryBlock(uint32_t size) : Position(0), Size(size)
+{
+	// Standard blocks are huge page aligned so the kernel can back them with a single page
+	size_t alignment = size == BlockSize ? (size_t)BlockSize : 64;
+#ifdef _WIN32
+	Data = (uint8_t*)_aligned_malloc(size, alignment);
+#else
+	void *ptr = nullptr;
+	if (posix_memalign(&ptr, alignment, size) != 0)
+		ptr = nullptr;
+	Data = (uint8_t*)ptr;
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+	if (Data && size == BlockSize)
+		madvise(Data, size, MADV_HUGEPAGE);
+#endif
+#endif
+	if (Data == nullptr)
+		I_FatalError("Out of memory allocating %u bytes of render memory", size);
+
+	BlocksAllocated++;
+	BytesAllocated += size;
+	SystemAllocations++;
+	M_TrackMemory(MEMTAG_RENDER, size);
+}
+
+RenderMemory::MemoryBlock::~MemoryBlock()
+{
+#ifdef _WIN32
+	_aligned_free(Data);
+#else
+	free(Data);
+#endif
+	BlocksAllocated--;
+	BytesAllocated -= Size;
+	M_TrackMemory(MEMTAG_RENDER, -ptrdiff_t(Size));
+}
+
 void *RenderMemory::AllocBytes(int size)
 {
 	size = (size + 15) / 16 * 16; // 16-byte align
+
+	// Requests that do not fit a standard block get a block of their own. It goes in front
+	// of the current block so that remaining space keeps being used.
+	if (size > BlockSize)
+	{
+		OversizedAllocations++;
+		std::unique_ptr<MemoryBlock> block(new MemoryBlock(size));
+		block->Position = size;
+		void *data = block->Data;
+		UsedBlocks.insert(UsedBlocks.empty() ? UsedBlocks.end() : UsedBlocks.end() - 1, std::move(block));
+		return data;
+	}
 		
 	if (UsedBlocks.empty() || UsedBlocks.back()->Position + size > BlockSize)
 	{
@@ -53,7 +116,7 @@ void *RenderMemory::AllocBytes(int size)
 		}
 		else
 		{
-			UsedBlocks.push_back(std::unique_ptr<MemoryBlock>(new MemoryBlock()));
+			UsedBlocks.push_back(std::unique_ptr<MemoryBlock>(new MemoryBlock(BlockSize)));
 		}
 	}
 		
@@ -66,10 +129,38 @@ void *RenderMemory::AllocBytes(int size)
 	
 void RenderMemory::Clear()
 {
+	size_t used = 0;
 	while (!UsedBlocks.empty())
 	{
 		auto block = std::move(UsedBlocks.back());
 		UsedBlocks.pop_back();
-		FreeBlocks.push_back(std::move(block));
+		if (block->Size == BlockSize)
+		{
+			FreeBlocks.push_back(std::move(block));
+			used++;
+		}
+	}
+
+	// All blocks of the peak frame stay in the free list, so the next frames do not have to allocate.
+	// Blocks above the peak are only released after a long stretch of lighter frames.
+	if (used >= HighWaterMark)
+	{
+		HighWaterMark = used;
+		FramesBelowMark = 0;
 	}
+	else if (++FramesBelowMark >= TrimDelay)
+	{
+		HighWaterMark = used;
+		FramesBelowMark = 0;
+		while (FreeBlocks.size() > HighWaterMark)
+			FreeBlocks.pop_back();
+	}
+}
+
+ADD_STAT(rendermemory)
+{
+	FString out;
+	out.Format("blocks=%d (%.1f MB)  system allocs=%d  oversized=%d", BlocksAllocated.load(),
+		BytesAllocated.load() / (1024.0 * 1024.0), SystemAllocations.load(), OversizedAllocations.load());
+	return out;
 }
@@ -25,19 +25,28 @@ public:
 private:
 	void *AllocBytes(int size);
 		
-	enum { BlockSize = 1024 * 1024 };
+	// 2 MB so that a block can be backed by a single transparent huge page
+	enum { BlockSize = 2 * 1024 * 1024 };
+
+	// Frames the usage has to stay below the high water mark before spare blocks are released
+	enum { TrimDelay = 300 };
 		
 	struct MemoryBlock
 	{
-		MemoryBlock() : Data(new uint8_t[BlockSize]), Position(0) { }
-		~MemoryBlock() { delete[] Data; }
+		MemoryBlock(uint32_t size);
+		~MemoryBlock();
 			
 		MemoryBlock(const MemoryBlock &) = delete;
 		MemoryBlock &operator=(const MemoryBlock &) = delete;
 			
 		uint8_t *Data;
 		uint32_t Position;
+		uint32_t Size;
 	};
 	std::vector<std::unique_ptr<MemoryBlock>> UsedBlocks;
 	std::vector<std::unique_ptr<MemoryBlock>> FreeBlocks;
+
+	// Most standard blocks used by a frame recently. Clear keeps at least that many in FreeBlocks.
+	size_t HighWaterMark = 0;
+	int FramesBelowMark = 0;
 };
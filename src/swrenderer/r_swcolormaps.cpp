@@ -55,7 +55,10 @@
 #include "templates.h"
 #include "r_utility.h"
 #include "r_renderer.h"
+#include "p_3dfloors.h"
+#include "jobs.h"
 #include <atomic>
+#include <mutex>
 
 FDynamicColormap NormalLight;
 FDynamicColormap FullNormalLight; //[SP] Emulate GZDoom brightness
@@ -106,8 +109,39 @@ static FDynamicColormap *CreateSpecialLights (PalEntry color, PalEntry fade, int
 	return colormap;
 }
 
+//==========================================================================
+//
+// Every wall, flat and sprite looks up its colormap, and maps with lots of
+// colored sectors make the list long. Each thread keeps a small cache of
+// its recent lookups, which is invalidated when any colormap changes.
+//
+//==========================================================================
+
+struct FSpecialLightsCacheEntry
+{
+	uint32_t Color;
+	uint32_t Fade;
+	int Desaturate;
+	unsigned Generation;
+	FDynamicColormap *Colormap;
+};
+
+static std::atomic<unsigned> SpecialLightsGeneration(1);
+static thread_local FSpecialLightsCacheEntry SpecialLightsCache[64];
+
 FDynamicColormap *GetSpecialLights (PalEntry color, PalEntry fade, int desaturate)
 {
+	unsigned generation = SpecialLightsGeneration.load(std::memory_order_acquire);
+	unsigned hash = ((color.d * 0x9E3779B1u) ^ fade.d ^ desaturate) * 0x9E3779B1u;
+	FSpecialLightsCacheEntry &entry = SpecialLightsCache[hash >> 26];
+
+	if (entry.Generation == generation && entry.Color == color.d && entry.Fade == fade.d && entry.Desaturate == desaturate)
+	{
+		return entry.Colormap;
+	}
+
+	FDynamicColormap *found = nullptr;
+
 	// If this colormap has already been created, just return it
 	for (FDynamicColormap *colormap = &NormalLight; colormap != NULL; colormap = colormap->Next)
 	{
@@ -115,11 +149,82 @@ FDynamicColormap *GetSpecialLights (PalEntry color, PalEntry fade, int desaturat
 			fade == colormap->Fade &&
 			desaturate == colormap->Desaturate)
 		{
-			return colormap;
+			found = colormap;
+			break;
+		}
+	}
+
+	if (found == nullptr)
+	{
+		found = CreateSpecialLights(color, fade, desaturate);
+	}
+	entry = { color.d, fade.d, desaturate, generation, found };
+	return found;
+}
+
+//==========================================================================
+//
+// Building a colormap takes 8192 palette searches, which shows up as a
+// hitch the first time a colored sector comes into view. The ones the
+// level's sectors ask for are built up front, spread over the workers.
+//
+//==========================================================================
+
+void PrecacheSpecialLights()
+{
+	TArray<FDynamicColormap *> built;
+
+	auto add = [&](const FColormap &cm, bool forsprites)
+	{
+		// Same key as GetColorTable with no special color.
+		PalEntry c = cm.LightColor;
+		if (forsprites) c.Decolorize();
+		if (c == PalEntry(255, 255, 255) && cm.FadeColor == 0 && cm.Desaturation == 0)
+			return;
+
+		for (FDynamicColormap *colormap = &NormalLight; colormap != NULL; colormap = colormap->Next)
+		{
+			if (c == colormap->Color && cm.FadeColor == colormap->Fade && cm.Desaturation == colormap->Desaturate)
+				return;
+		}
+		for (auto colormap : built)
+		{
+			if (c == colormap->Color && cm.FadeColor == colormap->Fade && cm.Desaturation == colormap->Desaturate)
+				return;
+		}
+
+		FDynamicColormap *colormap = new FDynamicColormap;
+		colormap->Next = NULL;
+		colormap->Color = c;
+		colormap->Fade = cm.FadeColor;
+		colormap->Desaturate = cm.Desaturation;
+		colormap->Maps = new uint8_t[NUMCOLORMAPS*256];
+		built.Push(colormap);
+	};
+
+	bool decolorize = !!(level.flags3 & LEVEL3_NOCOLOREDSPRITELIGHTING);
+	for (auto &sec : level.sectors)
+	{
+		add(sec.Colormap, false);
+		if (decolorize) add(sec.Colormap, true);
+		for (auto &light : sec.e->XFloor.lightlist)
+		{
+			add(light.extra_colormap, false);
+			if (decolorize) add(light.extra_colormap, true);
 		}
 	}
+	if (built.Size() == 0)
+		return;
+
+	Jobs.RunParallel(built.Size(), [&](unsigned i) { built[i]->BuildLights(); });
 
-	return CreateSpecialLights(color, fade, desaturate);
+	std::unique_lock<std::mutex> lock(buildmapmutex);
+	for (auto colormap : built)
+	{
+		colormap->Next = NormalLight.Next;
+		std::atomic_thread_fence(std::memory_order_release);
+		NormalLight.Next = colormap;
+	}
 }
 
 //==========================================================================
@@ -139,6 +244,7 @@ static void FreeSpecialLights()
 		delete colormap;
 	}
 	NormalLight.Next = NULL;
+	SpecialLightsGeneration++;
 }
 
 //==========================================================================
@@ -230,6 +336,7 @@ void FDynamicColormap::ChangeColor (PalEntry lightcolor, int desaturate)
 		// [BB] desaturate must be in [0,255]
 		Desaturate = clamp(desaturate, 0, 255);
 		if (Maps) BuildLights ();
+		SpecialLightsGeneration++;
 	}
 }
 
@@ -245,6 +352,7 @@ void FDynamicColormap::ChangeFade (PalEntry fadecolor)
 	{
 		Fade = fadecolor;
 		if (Maps) BuildLights ();
+		SpecialLightsGeneration++;
 	}
 }
 
@@ -261,6 +369,7 @@ void FDynamicColormap::ChangeColorFade (PalEntry lightcolor, PalEntry fadecolor)
 		Color = lightcolor;
 		Fade = fadecolor;
 		if (Maps) BuildLights ();
+		SpecialLightsGeneration++;
 	}
 }
 
@@ -478,6 +587,7 @@ void InitSWColorMaps()
 	NormalLight.Color = PalEntry (255, 255, 255);
 	NormalLight.Fade = 0;
 	NormalLight.Maps = realcolormaps.Maps;
+	SpecialLightsGeneration++;
 	NormalLightHasFixedLights = R_CheckForFixedLights(realcolormaps.Maps);
 
 	// [SP] Create a copy of the colormap
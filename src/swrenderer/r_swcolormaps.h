@@ -33,6 +33,7 @@ extern TArray<FSWColormap> SpecialSWColormaps;
 void DeinitSWColorMaps();
 void InitSWColorMaps();
 FDynamicColormap *GetSpecialLights (PalEntry lightcolor, PalEntry fadecolor, int desaturate);
+void PrecacheSpecialLights();
 void SetDefaultColormap (const char *name);
 
 
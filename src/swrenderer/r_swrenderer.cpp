@@ -373,6 +373,8 @@ void FSoftwareRenderer::PreprocessLevel()
 			}
 		}
 	}
+
+	PrecacheSpecialLights();
 }
 
 void FSoftwareRenderer::CleanLevelData()
@@ -941,7 +941,7 @@ namespace swrenderer
 				ThingSprite sprite;
 				int spritenum = thing->sprite;
 				bool isPicnumOverride = thing->picnum.isValid();
-				FSpriteModelFrame *modelframe = isPicnumOverride ? nullptr : FindModelFrame(thing->GetClass(), spritenum, thing->frame, !!(thing->flags & MF_DROPPED));
+				FSpriteModelFrame *modelframe = isPicnumOverride ? nullptr : FindModelFrame(thing->GetClass(), thing->state, spritenum, thing->frame, !!(thing->flags & MF_DROPPED));
 				if (r_modelscene && r_models_carmack && modelframe && (thing->Pos() - Thread->Viewport->viewpoint.Pos).LengthSquared() < model_distance_cull)
 				{
 					DVector3 pos = thing->InterpolatedPosition(Thread->Viewport->viewpoint.TicFrac);
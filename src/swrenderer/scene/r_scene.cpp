@@ -57,6 +57,7 @@
 #include "swrenderer/r_memory.h"
 #include "swrenderer/r_renderthread.h"
 #include "swrenderer/things/r_playersprite.h"
+#include "jobs.h"
 #include <chrono>
 
 #ifdef WIN32
@@ -68,6 +69,8 @@ EXTERN_CVAR(Int, r_clearbuffer)
 EXTERN_CVAR(Int, r_debug_draw)
 
 CVAR(Int, r_scene_multithreaded, 0, 0);
+CVAR(Bool, r_scene_balance, true, 0);		// Size the slices from the previous frame's slice timings
+CVAR(Int, r_scene_slices, 1, 0);			// Slices per thread. Threads that finish early pick up the remaining slices.
 CVAR(Bool, r_models, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
 CVAR(Bool, r_models_carmack, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
 
@@ -94,6 +97,9 @@ namespace swrenderer
 
 	void RenderScene::RenderView(player_t *player)
 	{
+		DrawerThreads::EndFrameStats(); // stat drawerqueues shows the previous frame
+		DrawerThreads::BeginFrameCapture();
+
 		auto viewport = MainThread()->Viewport.get();
 		viewport->RenderTarget = screen;
 
@@ -137,10 +143,13 @@ namespace swrenderer
 		DrawerWaitCycles.Clock();
 		DrawerThreads::WaitForWorkers();
 		DrawerWaitCycles.Unclock();
+
+		DrawerThreads::ReplayFrameCapture();
 	}
 
 	void RenderScene::RenderActorView(AActor *actor, bool dontmaplines)
 	{
+		PROFILE_ZONE("Software scene");
 		WallCycles.Reset();
 		PlaneCycles.Reset();
 		MaskedCycles.Reset();
@@ -213,6 +222,8 @@ namespace swrenderer
 		int numThreads = std::thread::hardware_concurrency();
 		if (numThreads == 0)
 			numThreads = 2;
+		else if (FJobSystem::Topology().IsHeterogeneous())
+			numThreads = FJobSystem::Topology().NumFastCores;
 
 		if (r_scene_multithreaded == 0 || r_multithreaded == 0)
 			numThreads = 1;
@@ -225,15 +236,33 @@ namespace swrenderer
 			StartThreads(numThreads);
 		}
 
-		// Setup threads:
+		int numSlices = numThreads;
+		if (numThreads > 1)
+			numSlices = numThreads * clamp((int)r_scene_slices, 1, 8);
+		numSlices = clamp(numSlices, 1, MAX(viewwidth / 16, 1));
+
+		while ((int)(Threads.size() + ExtraSlices.size()) < numSlices)
+			ExtraSlices.push_back(std::unique_ptr<RenderThread>(new RenderThread(this, false)));
+
+		Slices.clear();
+		for (auto &thread : Threads)
+			Slices.push_back(thread.get());
+		for (auto &slice : ExtraSlices)
+			Slices.push_back(slice.get());
+
+		UpdateSliceEdges(numSlices);
+
+		// Setup slices:
 		std::unique_lock<std::mutex> start_lock(start_mutex);
-		for (int i = 0; i < numThreads; i++)
+		for (int i = 0; i < numSlices; i++)
 		{
-			*Threads[i]->Viewport = *MainThread()->Viewport;
-			*Threads[i]->Light = *MainThread()->Light;
-			Threads[i]->X1 = viewwidth * i / numThreads;
-			Threads[i]->X2 = viewwidth * (i + 1) / numThreads;
+			*Slices[i]->Viewport = *MainThread()->Viewport;
+			*Slices[i]->Light = *MainThread()->Light;
+			Slices[i]->X1 = SliceEdges[i];
+			Slices[i]->X2 = SliceEdges[i + 1];
 		}
+		NumActiveSlices = numSlices;
+		NextSlice = 0;
 		run_id++;
 		start_lock.unlock();
 
@@ -243,8 +272,8 @@ namespace swrenderer
 			start_condition.notify_all();
 		}
 
-		// Do the main thread ourselves:
-		RenderThreadSlice(MainThread());
+		// Do our share of the slices ourselves:
+		RenderSlices();
 
 		// Wait for everyone to finish:
 		if (Threads.size() > 1)
@@ -269,6 +298,71 @@ namespace swrenderer
 		MainThread()->X2 = viewwidth;
 	}
 
+	void RenderScene::RenderSlices()
+	{
+		while (true)
+		{
+			size_t index = NextSlice++;
+			if (index >= NumActiveSlices)
+				break;
+
+			auto start = std::chrono::steady_clock::now();
+			RenderThreadSlice(Slices[index]);
+			SliceTimes[index] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		}
+	}
+
+	void RenderScene::UpdateSliceEdges(int numSlices)
+	{
+		bool balance = r_scene_balance && numSlices > 1 && SliceViewWidth == viewwidth && (int)SliceEdges.size() == numSlices + 1;
+
+		double totalTime = 0.0;
+		if (balance)
+		{
+			for (int i = 0; i < numSlices; i++)
+				totalTime += SliceTimes[i];
+			balance = totalTime > 0.0;
+		}
+
+		if (!balance)
+		{
+			SliceEdges.resize(numSlices + 1);
+			for (int i = 0; i <= numSlices; i++)
+				SliceEdges[i] = viewwidth * i / numSlices;
+		}
+		else
+		{
+			// Treat the time of each slice as evenly spread over its columns and place the new
+			// edges where each slice gets an equal share. Move halfway there to avoid oscillating.
+			const int minWidth = 16;
+			std::vector<int> edges(numSlices + 1);
+			edges[0] = 0;
+			edges[numSlices] = viewwidth;
+
+			int slice = 0;
+			double sliceStartTime = 0.0;
+			for (int i = 1; i < numSlices; i++)
+			{
+				double target = totalTime * i / numSlices;
+				while (slice < numSlices - 1 && sliceStartTime + SliceTimes[slice] < target)
+				{
+					sliceStartTime += SliceTimes[slice];
+					slice++;
+				}
+				double t = SliceTimes[slice] > 0.0 ? (target - sliceStartTime) / SliceTimes[slice] : 0.5;
+				double x = SliceEdges[slice] + clamp(t, 0.0, 1.0) * (SliceEdges[slice + 1] - SliceEdges[slice]);
+				edges[i] = (int)((SliceEdges[i] + x) * 0.5);
+			}
+
+			for (int i = 1; i < numSlices; i++)
+				edges[i] = clamp(edges[i], edges[i - 1] + minWidth, viewwidth - (numSlices - i) * minWidth);
+			SliceEdges = edges;
+		}
+
+		SliceTimes.assign(numSlices, 0.0);
+		SliceViewWidth = viewwidth;
+	}
+
 	void RenderScene::RenderThreadSlice(RenderThread *thread)
 	{
 		thread->DrawQueue->Clear();
@@ -306,7 +400,8 @@ namespace swrenderer
 			thread->TranslucentPass->Render();
 		}
 
-		DrawerThreads::Execute(thread->DrawQueue);
+		// Each slice only draws inside its own columns, except for models which are rasterized unclipped
+		DrawerThreads::Execute(thread->DrawQueue, Threads.size() > 1 && !r_modelscene);
 	}
 
 	void RenderScene::StartThreads(size_t numThreads)
@@ -314,10 +409,10 @@ namespace swrenderer
 		while (Threads.size() < (size_t)numThreads)
 		{
 			std::unique_ptr<RenderThread> thread(new RenderThread(this, false));
-			auto renderthread = thread.get();
 			int start_run_id = run_id;
 			thread->thread = std::thread([=]()
 			{
+				FJobSystem::PinThread(JOB_Frame);
 				int last_run_id = start_run_id;
 				while (true)
 				{
@@ -329,7 +424,7 @@ namespace swrenderer
 					last_run_id = run_id;
 					start_lock.unlock();
 
-					RenderThreadSlice(renderthread);
+					RenderSlices();
 
 					// Notify main thread that we finished:
 					std::unique_lock<std::mutex> end_lock(end_mutex);
@@ -26,6 +26,7 @@
 #include <memory>
 #include <thread>
 #include <mutex>
+#include <atomic>
 #include <condition_variable>
 #include "r_defs.h"
 #include "d_player.h"
@@ -61,6 +62,8 @@ namespace swrenderer
 		void RenderActorView(AActor *actor, bool dontmaplines = false);
 		void RenderThreadSlices();
 		void RenderThreadSlice(RenderThread *thread);
+		void RenderSlices();
+		void UpdateSliceEdges(int numSlices);
 		void RenderPSprites();
 
 		void StartThreads(size_t numThreads);
@@ -70,6 +73,17 @@ namespace swrenderer
 		int clearcolor = 0;
 
 		std::vector<std::unique_ptr<RenderThread>> Threads;
+
+		// Slices of the current frame. The first ones belong to Threads, the rest are extra slices
+		// for r_scene_slices, pulled by whichever thread gets to them first.
+		std::vector<std::unique_ptr<RenderThread>> ExtraSlices;
+		std::vector<RenderThread *> Slices;
+		std::vector<int> SliceEdges;
+		std::vector<double> SliceTimes;
+		int SliceViewWidth = 0;
+		size_t NumActiveSlices = 0;
+		std::atomic<size_t> NextSlice { 0 };
+
 		std::mutex start_mutex;
 		std::condition_variable start_condition;
 		bool shutdown_flag = false;
@@ -429,43 +429,53 @@ int FJPEGTexture::CopyTrueColorPixels(FBitmap *bmp, int x, int y, int rotate, FC
 		{
 			jpeg_start_decompress(&cinfo);
 
-			int yc = 0;
-			buff = new uint8_t[cinfo.output_height * cinfo.output_width * cinfo.output_components];
+			// Unrotated copies are converted in bands of about 256 kB so that large images need no full size intermediate buffer.
+			int pitch = cinfo.output_width * cinfo.output_components;
+			int bandheight = rotate == 0 ? clamp<int>((256 << 10) / MAX(pitch, 1), 1, cinfo.output_height) : cinfo.output_height;
+			buff = new uint8_t[bandheight * pitch];
 
-
-			while (cinfo.output_scanline < cinfo.output_height)
+			if (cinfo.out_color_space == JCS_GRAYSCALE)
 			{
-				uint8_t * ptr = buff + cinfo.output_width * cinfo.output_components * yc;
-				jpeg_read_scanlines(&cinfo, &ptr, 1);
-				yc++;
+				for (int i = 0; i < 256; i++) pe[i] = PalEntry(255, i, i, i);	// default to a gray map
 			}
 
-			switch (cinfo.out_color_space)
+			while (cinfo.output_scanline < cinfo.output_height)
 			{
-			case JCS_RGB:
-				bmp->CopyPixelDataRGB(x, y, buff, cinfo.output_width, cinfo.output_height,
-					3, cinfo.output_width * cinfo.output_components, rotate, CF_RGB, inf);
-				break;
+				int firstrow = cinfo.output_scanline;
+				int yc = 0;
+				while (yc < bandheight && cinfo.output_scanline < cinfo.output_height)
+				{
+					uint8_t * ptr = buff + pitch * yc;
+					jpeg_read_scanlines(&cinfo, &ptr, 1);
+					yc++;
+				}
 
-			case JCS_GRAYSCALE:
-				for (int i = 0; i < 256; i++) pe[i] = PalEntry(255, i, i, i);	// default to a gray map
-				bmp->CopyPixelData(x, y, buff, cinfo.output_width, cinfo.output_height,
-					1, cinfo.output_width, rotate, pe, inf);
-				break;
-
-			case JCS_CMYK:
-				bmp->CopyPixelDataRGB(x, y, buff, cinfo.output_width, cinfo.output_height,
-					4, cinfo.output_width * cinfo.output_components, rotate, CF_CMYK, inf);
-				break;
-
-			case JCS_YCbCr:
-				bmp->CopyPixelDataRGB(x, y, buff, cinfo.output_width, cinfo.output_height,
-					4, cinfo.output_width * cinfo.output_components, rotate, CF_YCbCr, inf);
-				break;
-
-			default:
-				assert(0);
-				break;
+				switch (cinfo.out_color_space)
+				{
+				case JCS_RGB:
+					bmp->CopyPixelDataRGB(x, y + firstrow, buff, cinfo.output_width, yc,
+						3, pitch, rotate, CF_RGB, inf);
+					break;
+
+				case JCS_GRAYSCALE:
+					bmp->CopyPixelData(x, y + firstrow, buff, cinfo.output_width, yc,
+						1, cinfo.output_width, rotate, pe, inf);
+					break;
+
+				case JCS_CMYK:
+					bmp->CopyPixelDataRGB(x, y + firstrow, buff, cinfo.output_width, yc,
+						4, pitch, rotate, CF_CMYK, inf);
+					break;
+
+				case JCS_YCbCr:
+					bmp->CopyPixelDataRGB(x, y + firstrow, buff, cinfo.output_width, yc,
+						4, pitch, rotate, CF_YCbCr, inf);
+					break;
+
+				default:
+					assert(0);
+					break;
+				}
 			}
 			jpeg_finish_decompress(&cinfo);
 		}
@@ -615,48 +615,60 @@ int FPNGTexture::CopyTrueColorPixels(FBitmap *bmp, int x, int y, int rotate, FCo
 		transpal = true;
 	}
 
-	uint8_t * Pixels = new uint8_t[pixwidth * Height];
-
-	lump->Seek (StartOfIDAT, FileReader::SeekSet);
-	lump->Read(&len, 4);
-	lump->Read(&id, 4);
-	M_ReadIDAT (*lump, Pixels, Width, Height, pixwidth, BitDepth, ColorType, Interlace, BigLong((unsigned int)len));
-
-	switch (ColorType)
+	auto copy = [&](const uint8_t *Pixels, int row, int numrows)
 	{
-	case 0:
-	case 3:
-		bmp->CopyPixelData(x, y, Pixels, Width, Height, 1, Width, rotate, pe, inf);
-		break;
-
-	case 2:
-		if (!HaveTrans)
+		switch (ColorType)
 		{
-			bmp->CopyPixelDataRGB(x, y, Pixels, Width, Height, 3, pixwidth, rotate, CF_RGB, inf);
-		}
-		else
-		{
-			bmp->CopyPixelDataRGB(x, y, Pixels, Width, Height, 3, pixwidth, rotate, CF_RGBT, inf,
-				NonPaletteTrans[0], NonPaletteTrans[1], NonPaletteTrans[2]);
-			transpal = true;
-		}
-		break;
+		case 0:
+		case 3:
+			bmp->CopyPixelData(x, y + row, Pixels, Width, numrows, 1, Width, rotate, pe, inf);
+			break;
 
-	case 4:
-		bmp->CopyPixelDataRGB(x, y, Pixels, Width, Height, 2, pixwidth, rotate, CF_IA, inf);
-		transpal = -1;
-		break;
+		case 2:
+			if (!HaveTrans)
+			{
+				bmp->CopyPixelDataRGB(x, y + row, Pixels, Width, numrows, 3, pixwidth, rotate, CF_RGB, inf);
+			}
+			else
+			{
+				bmp->CopyPixelDataRGB(x, y + row, Pixels, Width, numrows, 3, pixwidth, rotate, CF_RGBT, inf,
+					NonPaletteTrans[0], NonPaletteTrans[1], NonPaletteTrans[2]);
+			}
+			break;
 
-	case 6:
-		bmp->CopyPixelDataRGB(x, y, Pixels, Width, Height, 4, pixwidth, rotate, CF_RGBA, inf);
-		transpal = -1;
-		break;
+		case 4:
+			bmp->CopyPixelDataRGB(x, y + row, Pixels, Width, numrows, 2, pixwidth, rotate, CF_IA, inf);
+			break;
 
-	default:
-		break;
+		case 6:
+			bmp->CopyPixelDataRGB(x, y + row, Pixels, Width, numrows, 4, pixwidth, rotate, CF_RGBA, inf);
+			break;
+
+		default:
+			break;
+		}
+	};
+	if (ColorType == 2 && HaveTrans) transpal = true;
+	else if (ColorType == 4 || ColorType == 6) transpal = -1;
+
+	lump->Seek (StartOfIDAT, FileReader::SeekSet);
+	lump->Read(&len, 4);
+	lump->Read(&id, 4);
 
+	if (!Interlace && rotate == 0)
+	{
+		// Decode and convert in bands of about 256 kB so that large images need no full size intermediate buffer.
+		int bandheight = MAX(1, (256 << 10) / MAX(pixwidth, 1));
+		M_ReadIDATBands(*lump, Width, Height, BitDepth, ColorType, BigLong((unsigned int)len), bandheight,
+			[&](const uint8_t *pixels, int row, int numrows, int pitch) { copy(pixels, row, numrows); });
+	}
+	else
+	{
+		uint8_t * Pixels = new uint8_t[pixwidth * Height];
+		M_ReadIDAT (*lump, Pixels, Width, Height, pixwidth, BitDepth, ColorType, Interlace, BigLong((unsigned int)len));
+		copy(Pixels, 0, Height);
+		delete[] Pixels;
 	}
-	delete[] Pixels;
 	return transpal;
 }
 
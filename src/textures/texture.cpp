@@ -150,7 +150,7 @@ FTexture::FTexture (const char *name, int lumpnum)
 : LeftOffset(0), TopOffset(0),
   WidthBits(0), HeightBits(0), Scale(1,1), SourceLump(lumpnum),
   UseType(ETextureType::Any), bNoDecals(false), bNoRemap0(false), bWorldPanning(false),
-  bMasked(true), bAlphaTexture(false), bHasCanvas(false), bWarped(0), bComplex(false), bMultiPatch(false), bKeepAround(false),
+  bMasked(true), bAlphaTexture(false), bHasCanvas(false), bWarped(0), bComplex(false), bMultiPatch(false), bKeepAround(false), bSourceModified(false),
 	Rotations(0xFFFF), SkyOffset(0), Width(0), Height(0), WidthMask(0)
 {
 	id.SetInvalid();
@@ -210,7 +210,9 @@ const uint32_t *FTexture::GetPixelsBgra()
 
 bool FTexture::CheckModified (FRenderStyle)
 {
-	return false;
+	bool modified = bSourceModified;
+	bSourceModified = false;
+	return modified;
 }
 
 FTextureFormat FTexture::GetFormat()
@@ -374,6 +374,32 @@ void FTextureManager::UnloadAll ()
 	}
 }
 
+//==========================================================================
+//
+// FTextureManager :: SourceLumpsModified
+//
+// Unloads all textures created from the given lumps and flags them so that
+// the hardware renderer recreates them on next use.
+//
+//==========================================================================
+
+void FTextureManager::SourceLumpsModified (const TArray<int> &lumps)
+{
+	TMap<int, bool> modified;
+	for (auto lump : lumps) modified[lump] = true;
+
+	for (unsigned int i = 0; i < Textures.Size(); ++i)
+	{
+		FTexture *tex = Textures[i].Texture;
+		if (modified.CheckKey(tex->GetSourceLump()) != nullptr)
+		{
+			tex->Unload ();
+			tex->KillNative ();
+			tex->bSourceModified = true;
+		}
+	}
+}
+
 //==========================================================================
 //
 // FTextureManager :: AddTexture
@@ -1012,6 +1038,19 @@ void FTextureManager::Init()
 	AddTexture(CreateShaderTexture(true, false));
 	AddTexture(CreateShaderTexture(true, true));
 
+	// The text definitions of all files are read up front, so that the
+	// compressed ones can be inflated in parallel.
+	TArray<int> deflumps;
+	for (auto name : { "TEXTURES", "HIRESTEX" })
+	{
+		int lump, lastlump = 0;
+		while ((lump = Wads.FindLump(name, &lastlump)) != -1)
+		{
+			deflumps.Push(lump);
+		}
+	}
+	FScanner::PreloadLumps(deflumps);
+
 	int wadcnt = Wads.GetNumWads();
 	for(int i = 0; i< wadcnt; i++)
 	{
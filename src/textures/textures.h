@@ -243,6 +243,7 @@ public:
 							// doing it per patch.
 	uint8_t bMultiPatch:2;		// This is a multipatch texture (we really could use real type info for textures...)
 	uint8_t bKeepAround:1;		// This texture was used as part of a multi-patch texture. Do not free it.
+	uint8_t bSourceModified:1;	// The source lump has changed on disk. Reported once by CheckModified.
 
 	uint16_t Rotations;
 	int16_t SkyOffset;
@@ -589,6 +590,7 @@ public:
 	void ReplaceTexture (FTextureID picnum, FTexture *newtexture, bool free);
 
 	void UnloadAll ();
+	void SourceLumpsModified (const TArray<int> &lumps);
 
 	int NumTextures () const { return (int)Textures.Size(); }
 
@@ -52,8 +52,11 @@ void WarpBuffer(TYPE *Pixels, const TYPE *source, int width, int height, int xmu
 			int xt = xf;
 			const TYPE *sourcep = source + y;
 			TYPE *dest = Pixels + y;
-			for (xt = width; xt; xt--, xf = (xf + 1) % width, dest += height)
+			for (xt = width; xt; xt--, dest += height)
+			{
 				*dest = sourcep[xf + ymask * xf];
+				if (++xf == width) xf = 0;
+			}
 		}
 		timebase = unsigned(time * Speed * 23 / 28);
 		for (x = width - 1; x >= 0; x--)
@@ -63,8 +66,11 @@ void WarpBuffer(TYPE *Pixels, const TYPE *source, int width, int height, int xmu
 			int yt = yf;
 			const TYPE *sourcep = Pixels + (x + ymask * x);
 			TYPE *dest = buffer;
-			for (yt = height; yt; yt--, yf = (yf + 1) % height)
+			for (yt = height; yt; yt--)
+			{
 				*dest++ = sourcep[yf];
+				if (++yf == height) yf = 0;
+			}
 			memcpy(Pixels + (x + ymask*x), buffer, height * sizeof(TYPE));
 		}
 	}
@@ -72,18 +78,35 @@ void WarpBuffer(TYPE *Pixels, const TYPE *source, int width, int height, int xmu
 	{
 		unsigned timebase = unsigned(time * Speed * 40 / 28);
 		// [mxd] Rewrote to fix animation for NPo2 textures
+		// Each of the four sine terms only depends on either x or y, so they are looked up
+		// once per row and column. They are at most 2 in size, so the coordinates can
+		// be wrapped with a compare instead of a division per pixel.
+		int *colx = (int *)alloca(sizeof(int) * 2 * width);
+		int *coly = colx + width;
+		int *rowx = (int *)alloca(sizeof(int) * 2 * height);
+		int *rowy = rowx + height;
+		for (x = 0; x < width; x++)
+		{
+			colx[x] = (x + 128 + ((TexMan.sintable[((x*xmul + timebase * 4 + 300) >> 2) & TexMan.SINMASK]) >> 13)) % width;
+			coly[x] = (TexMan.sintable[((x*xmul + timebase * 4 + 1200) >> 2) & TexMan.SINMASK]) >> 13;
+		}
+		for (y = 0; y < height; y++)
+		{
+			rowx[y] = (TexMan.sintable[((y*ymul + timebase * 5 + 900) >> 2) & TexMan.SINMASK]) >> 13;
+			rowy[y] = (y + 128 + ((TexMan.sintable[((y*ymul + timebase * 3 + 700) >> 2) & TexMan.SINMASK]) >> 13)) % height;
+		}
 		for (x = 0; x < width; x++)
 		{
 			TYPE *dest = Pixels + (x + ymask * x);
 			for (y = 0; y < height; y++)
 			{
-				int xt = (x + 128
-					+ ((TexMan.sintable[((y*ymul + timebase * 5 + 900) >> 2) & TexMan.SINMASK]) >> 13)
-					+ ((TexMan.sintable[((x*xmul + timebase * 4 + 300) >> 2) & TexMan.SINMASK]) >> 13)) % width;
+				int xt = colx[x] + rowx[y];
+				while (xt < 0) xt += width;
+				while (xt >= width) xt -= width;
 
-				int yt = (y + 128
-					+ ((TexMan.sintable[((y*ymul + timebase * 3 + 700) >> 2) & TexMan.SINMASK]) >> 13)
-					+ ((TexMan.sintable[((x*xmul + timebase * 4 + 1200) >> 2) & TexMan.SINMASK]) >> 13)) % height;
+				int yt = rowy[y] + coly[x];
+				while (yt < 0) yt += height;
+				while (yt >= height) yt -= height;
 
 				*dest++ = source[(xt + ymask * xt) + yt];
 			}
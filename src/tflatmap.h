@@ -0,0 +1,506 @@
+#pragma once
+/*
+** tflatmap.h
+** Open addressing hash table with the same interface as TMap
+**
+**---------------------------------------------------------------------------
+**
+** TFlatMap stores its pairs in one flat array, next to an array with one
+** control byte per slot. A control byte either marks the slot as empty or
+** deleted, or holds 7 bits of the hash of the key stored there. Lookups
+** compare 16 control bytes at once and only look at the pairs whose bits
+** match, so a miss rarely touches a pair at all and a hit is usually found
+** with a single key comparison.
+**
+** Removing entries doesn't move anything, so it's safe to remove the pair
+** currently returned by an iterator. Inserting may rehash the table, same
+** as with TMap.
+**
+*/
+
+#include "tarray.h"
+
+#ifndef NO_SSE
+#include <emmintrin.h>
+#endif
+
+template<class KT, class VT, class MapType> class TFlatMapIterator;
+template<class KT, class VT, class MapType> class TFlatMapConstIterator;
+
+template<class KT, class VT, class HashTraits=THashTraits<KT>, class ValueTraits=TValueTraits<VT> >
+class TFlatMap
+{
+	template<class KTa, class VTa, class MTa> friend class TFlatMapIterator;
+	template<class KTb, class VTb, class MTb> friend class TFlatMapConstIterator;
+
+public:
+	typedef class TFlatMap<KT, VT, HashTraits, ValueTraits> MyType;
+	typedef class TFlatMapIterator<KT, VT, MyType> Iterator;
+	typedef class TFlatMapConstIterator<KT, VT, MyType> ConstIterator;
+	typedef struct { const KT Key; VT Value; } Pair;
+	typedef const Pair ConstPair;
+
+	TFlatMap() { SetSlotVector(1); }
+	TFlatMap(hash_t size) { SetSlotVector(size); }
+	~TFlatMap() { ClearSlotVector(); }
+
+	TFlatMap(const TFlatMap &o)
+	{
+		SetSlotVector(o.CountUsed());
+		CopySlots(o);
+	}
+
+	TFlatMap &operator= (const TFlatMap &o)
+	{
+		if (&o != this)
+		{
+			ClearSlotVector();
+			SetSlotVector(o.CountUsed());
+			CopySlots(o);
+		}
+		return *this;
+	}
+
+	//=======================================================================
+	//
+	// TransferFrom
+	//
+	// Moves the contents from one TFlatMap to another, leaving the map moved
+	// from empty.
+	//
+	//=======================================================================
+
+	void TransferFrom(TFlatMap &o)
+	{
+		ClearSlotVector();
+		Ctrl = o.Ctrl;
+		Slots = o.Slots;
+		Size = o.Size;
+		NumUsed = o.NumUsed;
+		Growth = o.Growth;
+
+		o.Ctrl = nullptr;
+		o.Slots = nullptr;
+		o.Size = 0;
+		o.SetSlotVector(1);
+	}
+
+	//=======================================================================
+	//
+	// Clear
+	//
+	// Empties out the table and resizes it with room for count entries.
+	//
+	//=======================================================================
+
+	void Clear(hash_t count=1)
+	{
+		ClearSlotVector();
+		SetSlotVector(count);
+	}
+
+	hash_t CountUsed() const
+	{
+		return NumUsed;
+	}
+
+	//=======================================================================
+	//
+	// operator[]
+	//
+	// Returns a reference to the value associated with a particular key,
+	// creating the pair if the key isn't already in the table.
+	//
+	//=======================================================================
+
+	VT &operator[] (const KT key)
+	{
+		hash_t hash = HashKey(key);
+		IPair *p = FindKey(key, hash);
+		if (p == nullptr)
+		{
+			p = NewKey(key, hash);
+			ValueTraits traits;
+			traits.Init(p->Value);
+		}
+		return p->Value;
+	}
+
+	//=======================================================================
+	//
+	// CheckKey
+	//
+	// Returns a pointer to the value associated with a particular key, or
+	// NULL if the key isn't in the table.
+	//
+	//=======================================================================
+
+	VT *CheckKey (const KT key)
+	{
+		IPair *p = FindKey(key, HashKey(key));
+		return p != nullptr ? &p->Value : nullptr;
+	}
+
+	const VT *CheckKey (const KT key) const
+	{
+		const IPair *p = const_cast<TFlatMap *>(this)->FindKey(key, HashKey(key));
+		return p != nullptr ? &p->Value : nullptr;
+	}
+
+	//=======================================================================
+	//
+	// Insert
+	//
+	// Adds a key/value pair to the table if key isn't in the table, or
+	// replaces the value for the existing pair if the key is in the table.
+	//
+	//=======================================================================
+
+	VT &Insert(const KT key, const VT &value)
+	{
+		hash_t hash = HashKey(key);
+		IPair *p = FindKey(key, hash);
+		if (p != nullptr)
+		{
+			p->Value = value;
+		}
+		else
+		{
+			p = NewKey(key, hash);
+			::new(&p->Value) VT(value);
+		}
+		return p->Value;
+	}
+
+	VT &Insert(const KT key, VT &&value)
+	{
+		hash_t hash = HashKey(key);
+		IPair *p = FindKey(key, hash);
+		if (p != nullptr)
+		{
+			p->Value = std::move(value);
+		}
+		else
+		{
+			p = NewKey(key, hash);
+			::new(&p->Value) VT(std::move(value));
+		}
+		return p->Value;
+	}
+
+	VT &InsertNew(const KT key)
+	{
+		hash_t hash = HashKey(key);
+		IPair *p = FindKey(key, hash);
+		if (p != nullptr)
+		{
+			p->Value.~VT();
+		}
+		else
+		{
+			p = NewKey(key, hash);
+		}
+		::new(&p->Value) VT;
+		return p->Value;
+	}
+
+	//=======================================================================
+	//
+	// Remove
+	//
+	// Removes the key/value pair for a particular key if it is in the table.
+	//
+	//=======================================================================
+
+	void Remove(const KT key)
+	{
+		IPair *p = FindKey(key, HashKey(key));
+		if (p != nullptr)
+		{
+			p->~IPair();
+			Ctrl[p - Slots] = CTRL_DELETED;
+			--NumUsed;
+		}
+	}
+
+protected:
+	struct IPair	// This must be the same as Pair above, but with a
+	{				// non-const Key.
+		KT Key;
+		VT Value;
+	};
+
+	enum
+	{
+		GROUP_SIZE = 16,
+		CTRL_EMPTY = 0x80,
+		CTRL_DELETED = 0xFE,	// Full slots have the high bit clear.
+	};
+
+	uint8_t *Ctrl;
+	IPair *Slots;
+	hash_t Size;		// a power of 2 and at least GROUP_SIZE
+	hash_t NumUsed;
+	hash_t Growth;		// empty slots that can still be used before the table must grow
+
+	// Keys like FNames and pointers have their entropy in the low bits, but
+	// all bits are needed for the slot position and control byte.
+	static hash_t HashKey(const KT key)
+	{
+		HashTraits Traits;
+		hash_t h = Traits.Hash(key);
+		h ^= h >> 16;
+		h *= 0x85ebca6b;
+		h ^= h >> 13;
+		h *= 0xc2b2ae35;
+		h ^= h >> 16;
+		return h;
+	}
+
+	// Returns a bit mask of the bytes in the group equal to value.
+	static unsigned MatchGroup(const uint8_t *group, uint8_t value)
+	{
+#ifndef NO_SSE
+		__m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+		return _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)value)));
+#else
+		unsigned mask = 0;
+		for (int i = 0; i < GROUP_SIZE; i++)
+		{
+			if (group[i] == value) mask |= 1u << i;
+		}
+		return mask;
+#endif
+	}
+
+	// Returns a bit mask of the empty and deleted slots in the group.
+	static unsigned MatchFree(const uint8_t *group)
+	{
+#ifndef NO_SSE
+		return _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)group));
+#else
+		unsigned mask = 0;
+		for (int i = 0; i < GROUP_SIZE; i++)
+		{
+			if (group[i] & 0x80) mask |= 1u << i;
+		}
+		return mask;
+#endif
+	}
+
+	static int LowestBit(unsigned mask)
+	{
+#if defined(_MSC_VER)
+		unsigned long bit;
+		_BitScanForward(&bit, mask);
+		return int(bit);
+#elif defined(__GNUC__)
+		return __builtin_ctz(mask);
+#else
+		int bit = 0;
+		while (!(mask & 1))
+		{
+			mask >>= 1;
+			bit++;
+		}
+		return bit;
+#endif
+	}
+
+	void SetSlotVector(hash_t count)
+	{
+		// Keep the table at most 7/8 full.
+		for (Size = GROUP_SIZE; Size - Size / 8 < count; Size <<= 1)
+		{ }
+		// The control bytes come first. Since Size is a multiple of 16 the
+		// pairs will be suitably aligned behind them.
+		Ctrl = (uint8_t *)M_Malloc(Size + Size * sizeof(IPair));
+		Slots = (IPair *)(Ctrl + Size);
+		memset(Ctrl, CTRL_EMPTY, Size);
+		NumUsed = 0;
+		Growth = Size - Size / 8;
+	}
+
+	void ClearSlotVector()
+	{
+		if (Ctrl != nullptr)
+		{
+			for (hash_t i = 0; i < Size; ++i)
+			{
+				if (!(Ctrl[i] & 0x80))
+				{
+					Slots[i].~IPair();
+				}
+			}
+			M_Free(Ctrl);
+		}
+		Ctrl = nullptr;
+		Slots = nullptr;
+		Size = 0;
+		NumUsed = 0;
+		Growth = 0;
+	}
+
+	// Probing goes from group to group with a growing stride, which visits
+	// every group once when the number of groups is a power of 2.
+	IPair *FindKey(const KT key, hash_t hash)
+	{
+		HashTraits Traits;
+		hash_t mask = Size - 1;
+		hash_t pos = (hash >> 7) & mask & ~(GROUP_SIZE - 1);
+		uint8_t h2 = uint8_t(hash & 0x7f);
+
+		for (hash_t stride = GROUP_SIZE; ; stride += GROUP_SIZE)
+		{
+			const uint8_t *group = Ctrl + pos;
+			for (unsigned match = MatchGroup(group, h2); match != 0; match &= match - 1)
+			{
+				IPair *p = &Slots[pos + LowestBit(match)];
+				if (!Traits.Compare(p->Key, key))
+				{
+					return p;
+				}
+			}
+			if (MatchGroup(group, CTRL_EMPTY) != 0 || stride > Size)
+			{
+				return nullptr;
+			}
+			pos = (pos + stride) & mask;
+		}
+	}
+
+	/*
+	** Inserts a key that is known not to be in the table and returns
+	** its pair. The Value field is left unconstructed.
+	*/
+	IPair *NewKey(const KT key, hash_t hash)
+	{
+		if (Growth == 0)
+		{
+			// Only deleted slots are left: rebuild at the same size if enough
+			// of them are dead, otherwise grow.
+			Resize(NumUsed < Size / 2 ? NumUsed + 1 : Size);
+		}
+		hash_t mask = Size - 1;
+		hash_t pos = (hash >> 7) & mask & ~(GROUP_SIZE - 1);
+		for (hash_t stride = GROUP_SIZE; ; stride += GROUP_SIZE)
+		{
+			unsigned freeslots = MatchFree(Ctrl + pos);
+			if (freeslots != 0)
+			{
+				pos += LowestBit(freeslots);
+				break;
+			}
+			pos = (pos + stride) & mask;
+		}
+		if (Ctrl[pos] == CTRL_EMPTY)
+		{
+			--Growth;
+		}
+		Ctrl[pos] = uint8_t(hash & 0x7f);
+		++NumUsed;
+		::new(&Slots[pos].Key) KT(key);
+		return &Slots[pos];
+	}
+
+	void Resize(hash_t count)
+	{
+		uint8_t *octrl = Ctrl;
+		IPair *oslots = Slots;
+		hash_t osize = Size;
+
+		SetSlotVector(count);
+		for (hash_t i = 0; i < osize; ++i)
+		{
+			if (!(octrl[i] & 0x80))
+			{
+				IPair *p = NewKey(oslots[i].Key, HashKey(oslots[i].Key));
+				::new(&p->Value) VT(std::move(oslots[i].Value));
+				oslots[i].~IPair();
+			}
+		}
+		M_Free(octrl);
+	}
+
+	void CopySlots(const TFlatMap &o)
+	{
+		for (hash_t i = 0; i < o.Size; ++i)
+		{
+			if (!(o.Ctrl[i] & 0x80))
+			{
+				IPair *p = NewKey(o.Slots[i].Key, HashKey(o.Slots[i].Key));
+				::new(&p->Value) VT(o.Slots[i].Value);
+			}
+		}
+	}
+};
+
+// TFlatMapIterator ---------------------------------------------------------
+// A class to iterate over all the pairs in a TFlatMap.
+
+template<class KT, class VT, class MapType=TFlatMap<KT,VT> >
+class TFlatMapIterator
+{
+public:
+	TFlatMapIterator(MapType &map)
+		: Map(map), Position(0)
+	{
+	}
+
+	bool NextPair(typename MapType::Pair *&pair)
+	{
+		for (; Position < Map.Size; ++Position)
+		{
+			if (!(Map.Ctrl[Position] & 0x80))
+			{
+				pair = reinterpret_cast<typename MapType::Pair *>(&Map.Slots[Position++]);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void Reset()
+	{
+		Position = 0;
+	}
+
+protected:
+	MapType &Map;
+	hash_t Position;
+};
+
+// TFlatMapConstIterator ----------------------------------------------------
+// Exactly the same as TFlatMapIterator, but it works with a const TFlatMap.
+
+template<class KT, class VT, class MapType=TFlatMap<KT,VT> >
+class TFlatMapConstIterator
+{
+public:
+	TFlatMapConstIterator(const MapType &map)
+		: Map(map), Position(0)
+	{
+	}
+
+	bool NextPair(typename MapType::ConstPair *&pair)
+	{
+		for (; Position < Map.Size; ++Position)
+		{
+			if (!(Map.Ctrl[Position] & 0x80))
+			{
+				pair = reinterpret_cast<typename MapType::ConstPair *>(&Map.Slots[Position++]);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void Reset()
+	{
+		Position = 0;
+	}
+
+protected:
+	const MapType &Map;
+	hash_t Position;
+};
@@ -1300,8 +1300,10 @@ FFont::FFont (const char *name, const char *nametemplate, const char *filetempla
 				}
 			}
 
-			if (!noTranslate) Chars[i].Pic = new FFontChar1 (pic);
-			else Chars[i].Pic = pic;
+			// Large Unicode fonts can have thousands of glyphs of which only a few
+			// ever get drawn, so the translated glyphs are created in GetChar.
+			Chars[i].Pic = pic;
+			Chars[i].Deferred = !noTranslate;
 			Chars[i].XMove = Chars[i].Pic->GetScaledWidth();
 		}
 		else
@@ -1350,7 +1352,7 @@ FFont::~FFont ()
 		{
 			for (int i = 0; i < count; ++i)
 			{
-				if (Chars[i].Pic != NULL && Chars[i].Pic->Name[0] == 0)
+				if (Chars[i].Pic != NULL && !Chars[i].Deferred && Chars[i].Pic->Name[0] == 0)
 				{
 					delete Chars[i].Pic;
 				}
@@ -1736,6 +1738,13 @@ FTexture *FFont::GetChar (int code, int *const width) const
 	{
 		code -= FirstChar;
 		xmove = Chars[code].XMove;
+		if (Chars[code].Deferred)
+		{
+			auto pic = new FFontChar1 (Chars[code].Pic);
+			pic->SetSourceRemap(PatchRemap);
+			Chars[code].Pic = pic;
+			Chars[code].Deferred = false;
+		}
 	}
 
 	if (width != nullptr)
@@ -1886,9 +1895,16 @@ void FFont::LoadTranslations()
 
 	for (unsigned int i = 0; i < count; i++)
 	{
-		FFontChar1 *pic = static_cast<FFontChar1 *>(Chars[i].Pic);
-		if(pic)
+		if (Chars[i].Deferred)
 		{
+			// The pixels are only needed for the scan here, so they are released
+			// right away instead of keeping every glyph of the font in memory.
+			RecordTextureColors (Chars[i].Pic, usedcolors);
+			Chars[i].Pic->Unload();
+		}
+		else if (Chars[i].Pic)
+		{
+			FFontChar1 *pic = static_cast<FFontChar1 *>(Chars[i].Pic);
 			pic->SetSourceRemap(NULL); // Force the FFontChar1 to return the same pixels as the base texture
 			RecordTextureColors (pic, usedcolors);
 		}
@@ -1898,7 +1914,7 @@ void FFont::LoadTranslations()
 
 	for (unsigned int i = 0; i < count; i++)
 	{
-		if(Chars[i].Pic)
+		if(Chars[i].Pic && !Chars[i].Deferred)
 			static_cast<FFontChar1 *>(Chars[i].Pic)->SetSourceRemap(PatchRemap);
 	}
 
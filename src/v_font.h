@@ -146,6 +146,7 @@ protected:
 	{
 		FTexture *Pic;
 		int XMove;
+		bool Deferred = false;	// Pic is still the source texture, the translated glyph gets created on first use
 	} *Chars;
 	int ActiveColors;
 	TArray<FRemapTable> Ranges;
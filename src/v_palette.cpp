@@ -35,6 +35,9 @@
 #include "g_level.h"
 
 #include <stddef.h>
+#ifndef NO_SSE
+#include <emmintrin.h>
+#endif
 #include <string.h>
 #include <math.h>
 #include <float.h>
@@ -113,8 +116,59 @@ int BestColor (const uint32_t *pal_in, int r, int g, int b, int first, int num)
 	const PalEntry *pal = (const PalEntry *)pal_in;
 	int bestcolor = first;
 	int bestdist = 257 * 257 + 257 * 257 + 257 * 257;
+	int color = first;
+
+#ifndef NO_SSE
+	// Compares four colors at a time. Each lane keeps the first of its closest
+	// colors and ties between lanes go to the lower index, so the result is the
+	// same as from the plain loop below, which also does the leftover colors.
+	if (num - first >= 8)
+	{
+		const __m128i rgbmask = _mm_set1_epi32(0x00ffffff);
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i target = _mm_set_epi16(0, r, g, b, 0, r, g, b);
+		__m128i index = _mm_setr_epi32(first, first + 1, first + 2, first + 3);
+		__m128i bestd = _mm_set1_epi32(bestdist);
+		__m128i besti = index;
+
+		for (; color + 4 <= num; color += 4)
+		{
+			__m128i c = _mm_and_si128(_mm_loadu_si128((const __m128i *)&pal[color]), rgbmask);
+			__m128i lo = _mm_sub_epi16(_mm_unpacklo_epi8(c, zero), target);
+			__m128i hi = _mm_sub_epi16(_mm_unpackhi_epi8(c, zero), target);
+			// b*b+g*g and r*r for each color
+			lo = _mm_madd_epi16(lo, lo);
+			hi = _mm_madd_epi16(hi, hi);
+			__m128 bg = _mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(2, 0, 2, 0));
+			__m128 rr = _mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(3, 1, 3, 1));
+			__m128i dist = _mm_add_epi32(_mm_castps_si128(bg), _mm_castps_si128(rr));
+
+			__m128i closer = _mm_cmplt_epi32(dist, bestd);
+			bestd = _mm_or_si128(_mm_and_si128(closer, dist), _mm_andnot_si128(closer, bestd));
+			besti = _mm_or_si128(_mm_and_si128(closer, index), _mm_andnot_si128(closer, besti));
+			index = _mm_add_epi32(index, _mm_set1_epi32(4));
+
+			if (_mm_movemask_epi8(_mm_cmpeq_epi32(bestd, zero)))
+				break;
+		}
+
+		int32_t dists[4], indices[4];
+		_mm_storeu_si128((__m128i *)dists, bestd);
+		_mm_storeu_si128((__m128i *)indices, besti);
+		for (int i = 0; i < 4; i++)
+		{
+			if (dists[i] < bestdist || (dists[i] == bestdist && indices[i] < bestcolor))
+			{
+				bestdist = dists[i];
+				bestcolor = indices[i];
+			}
+		}
+		if (bestdist == 0)
+			return bestcolor;
+	}
+#endif
 
-	for (int color = first; color < num; color++)
+	for (; color < num; color++)
 	{
 		int x = r - pal[color].r;
 		int y = g - pal[color].g;
@@ -446,6 +446,16 @@ public:
 	virtual bool Update() = 0;
 };
 
+// The layers of 2D drawing that can be kept across frames with BeginRetained2D.
+enum ERetained2D
+{
+	RETAINED2D_HUD,
+	RETAINED2D_INTERMISSION,
+	RETAINED2D_MENU,
+
+	NUM_RETAINED2D
+};
+
 // A canvas that represents the actual display. The video code is responsible
 // for actually implementing this. Built on top of SimpleCanvas, because it
 // needs a system memory buffer when buffered output is enabled.
@@ -520,6 +530,14 @@ public:
 	// accelerated 2D mode.
 	virtual void DrawBlendingRect();
 
+	// Retained 2D drawing: everything drawn between BeginRetained2D and
+	// EndRetained2D is kept and played back on later calls with the same
+	// layer and key. Returns true if the kept drawing was used, in which case
+	// the caller must not draw anything and must not call EndRetained2D.
+	// Only one layer can be recorded at a time.
+	virtual bool BeginRetained2D(int layer, uint64_t key) { return false; }
+	virtual void EndRetained2D() {}
+
 	virtual int GetClientWidth();
 	virtual int GetClientHeight();
 
@@ -58,6 +58,9 @@
 #include "md5.h"
 #include "doomstat.h"
 #include "vm.h"
+#include "c_cvars.h"
+#include "stats.h"
+#include "jobs.h"
 
 // MACROS ------------------------------------------------------------------
 
@@ -85,8 +88,13 @@ static void PrintLastError ();
 
 FWadCollection Wads;
 
+// Map resource files into memory so that uncompressed lumps need not be copied.
+CVAR(Bool, file_mmap, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
 // PRIVATE DATA DEFINITIONS ------------------------------------------------
 
+static unsigned NameLookups, NameSteps, FullNameLookups, FullNameSteps, FullNameCompares;
+
 // CODE --------------------------------------------------------------------
 
 //==========================================================================
@@ -117,6 +125,9 @@ FWadCollection::~FWadCollection ()
 
 void FWadCollection::DeleteAll ()
 {
+	FinishBackgroundPrefetch();
+	BackgroundLumps.Clear();
+	PrefetchedLumps.Clear();
 	LumpInfo.Clear();
 	NumLumps = 0;
 
@@ -173,6 +184,7 @@ void FWadCollection::InitMultipleFiles (TArray<FString> &filenames)
 	NextLumpIndex = &Hashes[NumLumps];
 	FirstLumpIndex_FullName = &Hashes[NumLumps*2];
 	NextLumpIndex_FullName = &Hashes[NumLumps*3];
+	FullNameHash = &Hashes[NumLumps*4];
 	InitHashChains ();
 	LumpInfo.ShrinkToFit();
 	Files.ShrinkToFit();
@@ -224,7 +236,7 @@ void FWadCollection::AddFile (const char *filename, FileReader *wadr)
 
 		if (!isdir)
 		{
-			if (!wadreader.OpenFile(filename))
+			if (!(file_mmap && wadreader.OpenMappedFile(filename)) && !wadreader.OpenFile(filename))
 			{ // Didn't find file
 				Printf (TEXTCOLOR_RED "%s: File not found\n", filename);
 				PrintLastError ();
@@ -426,13 +438,14 @@ int FWadCollection::CheckNumForName (const char *name, int space)
 
 	uppercopy (uname, name);
 	i = FirstLumpIndex[LumpNameHash (uname) % NumLumps];
+	NameLookups++;
 
 	while (i != NULL_INDEX)
 	{
-		FResourceLump *lump = LumpInfo[i].lump;
-
-		if (lump->qwName == qname)
+		NameSteps++;
+		if (ShortNames[i] == qname)
 		{
+			FResourceLump *lump = LumpInfo[i].lump;
 			if (lump->Namespace == space) break;
 			// If the lump is from one of the special namespaces exclusive to Zips
 			// the check has to be done differently:
@@ -469,9 +482,10 @@ int FWadCollection::CheckNumForName (const char *name, int space, int wadnum, bo
 	// If exact is true if will only find lumps in the same WAD, otherwise
 	// also those in earlier WADs.
 
-	while (i != NULL_INDEX &&
-		(lump = LumpInfo[i].lump, lump->qwName != qname ||
-		lump->Namespace != space ||
+	NameLookups++;
+
+	while (i != NULL_INDEX && (NameSteps++, ShortNames[i] != qname ||
+		(lump = LumpInfo[i].lump, lump->Namespace != space) ||
 		 (exact? (LumpInfo[i].wadnum != wadnum) : (LumpInfo[i].wadnum > wadnum)) ))
 	{
 		i = NextLumpIndex[i];
@@ -480,6 +494,21 @@ int FWadCollection::CheckNumForName (const char *name, int space, int wadnum, bo
 	return i != NULL_INDEX ? i : -1;
 }
 
+//==========================================================================
+//
+// Lookup counts since startup. Steps are hash chain entries visited,
+// compares are the string compares done for full names.
+//
+//==========================================================================
+
+ADD_STAT(lumplookups)
+{
+	FString out;
+	out.Format("name: %u lookups, %u steps  fullname: %u lookups, %u steps, %u compares",
+		NameLookups, NameSteps, FullNameLookups, FullNameSteps, FullNameCompares);
+	return out;
+}
+
 DEFINE_ACTION_FUNCTION(_Wads, CheckNumForName)
 {
 	PARAM_PROLOGUE;
@@ -529,9 +558,11 @@ int FWadCollection::CheckNumForFullName (const char *name, bool trynormal, int n
 		return -1;
 	}
 
-	i = FirstLumpIndex_FullName[MakeKey(name) % NumLumps];
+	uint32_t hash = MakeKey(name);
+	i = FirstLumpIndex_FullName[hash % NumLumps];
+	FullNameLookups++;
 
-	while (i != NULL_INDEX && stricmp(name, LumpInfo[i].lump->FullName))
+	while (i != NULL_INDEX && (FullNameSteps++, FullNameHash[i] != hash || (FullNameCompares++, stricmp(name, LumpInfo[i].lump->FullName))))
 	{
 		i = NextLumpIndex_FullName[i];
 	}
@@ -561,10 +592,12 @@ int FWadCollection::CheckNumForFullName (const char *name, int wadnum)
 		return CheckNumForFullName (name);
 	}
 
-	i = FirstLumpIndex_FullName[MakeKey (name) % NumLumps];
+	uint32_t hash = MakeKey(name);
+	i = FirstLumpIndex_FullName[hash % NumLumps];
+	FullNameLookups++;
 
-	while (i != NULL_INDEX && 
-		(stricmp(name, LumpInfo[i].lump->FullName) || LumpInfo[i].wadnum != wadnum))
+	while (i != NULL_INDEX && (FullNameSteps++, FullNameHash[i] != hash || LumpInfo[i].wadnum != wadnum ||
+		(FullNameCompares++, stricmp(name, LumpInfo[i].lump->FullName))))
 	{
 		i = NextLumpIndex_FullName[i];
 	}
@@ -720,10 +753,13 @@ void FWadCollection::InitHashChains (void)
 	memset (NextLumpIndex, 255, NumLumps*sizeof(NextLumpIndex[0]));
 	memset (FirstLumpIndex_FullName, 255, NumLumps*sizeof(FirstLumpIndex_FullName[0]));
 	memset (NextLumpIndex_FullName, 255, NumLumps*sizeof(NextLumpIndex_FullName[0]));
+	memset (FullNameHash, 0, NumLumps*sizeof(FullNameHash[0]));
+	ShortNames.Resize(NumLumps);
 
 	// Now set up the chains
 	for (i = 0; i < (unsigned)NumLumps; i++)
 	{
+		ShortNames[i] = LumpInfo[i].lump->qwName;
 		uppercopy (name, LumpInfo[i].lump->Name);
 		j = LumpNameHash (name) % NumLumps;
 		NextLumpIndex[i] = FirstLumpIndex[j];
@@ -732,7 +768,8 @@ void FWadCollection::InitHashChains (void)
 		// Do the same for the full paths
 		if (LumpInfo[i].lump->FullName.IsNotEmpty())
 		{
-			j = MakeKey(LumpInfo[i].lump->FullName) % NumLumps;
+			FullNameHash[i] = MakeKey(LumpInfo[i].lump->FullName);
+			j = FullNameHash[i] % NumLumps;
 			NextLumpIndex_FullName[i] = FirstLumpIndex_FullName[j];
 			FirstLumpIndex_FullName[j] = i;
 		}
@@ -1408,6 +1445,7 @@ unsigned FWadCollection::GetLumpsInFolder(const char *inpath, TArray<FolderEntry
 
 void FWadCollection::ReadLump (int lump, void *dest)
 {
+	uint64_t hitchstart = FHitchLog::Start();
 	auto lumpr = OpenLumpReader (lump);
 	auto size = lumpr.GetLength ();
 	auto numread = lumpr.Read (dest, size);
@@ -1417,6 +1455,7 @@ void FWadCollection::ReadLump (int lump, void *dest)
 		I_Error ("W_ReadLump: only read %ld of %ld on lump %i\n",
 			numread, size, lump);	
 	}
+	if (hitchstart) FHitchLog::Note(hitchstart, "Lump", "%s (%ld bytes)", GetLumpFullPath(lump).GetChars(), (long)size);
 }
 
 //==========================================================================
@@ -1429,6 +1468,7 @@ void FWadCollection::ReadLump (int lump, void *dest)
 
 TArray<uint8_t> FWadCollection::ReadLumpIntoArray(int lump, int pad)
 {
+	uint64_t hitchstart = FHitchLog::Start();
 	auto lumpr = OpenLumpReader(lump);
 	auto size = lumpr.GetLength();
 	TArray<uint8_t> data(size + pad);
@@ -1440,6 +1480,7 @@ TArray<uint8_t> FWadCollection::ReadLumpIntoArray(int lump, int pad)
 			numread, size, lump);
 	}
 	if (pad > 0) memset(&data[size], 0, pad);
+	if (hitchstart) FHitchLog::Note(hitchstart, "Lump", "%s (%ld bytes)", GetLumpFullPath(lump).GetChars(), (long)size);
 	return data;
 }
 
@@ -1464,6 +1505,204 @@ DEFINE_ACTION_FUNCTION(_Wads, ReadLump)
 	ACTION_RETURN_STRING(isLumpValid ? Wads.ReadLump(lump).GetString() : FString());
 }
 
+//==========================================================================
+//
+// PrefetchLumps
+//
+// Decompresses the given lumps on worker threads and stores the results
+// in their caches, so that reading them afterwards does not have to inflate
+// them one at a time on the main thread. Lumps are taken in the given order
+// until maxbytes of decompressed data are held. Each prefetched lump keeps
+// one cache reference until ReleasePrefetchedLumps is called.
+//
+//==========================================================================
+
+struct FWadCollection::PrefetchJob
+{
+	FResourceLump *lump;
+	FCompressedBuffer raw;
+	char *data;
+};
+
+struct FWadCollection::PrefetchBatch
+{
+	TArray<PrefetchJob> jobs;
+	FJobCounter counter;
+};
+
+FWadCollection::PrefetchBatch *FWadCollection::StartPrefetch(const TArray<int> &lumps, size_t maxbytes, bool background)
+{
+	auto batch = new PrefetchBatch;
+	auto &jobs = batch->jobs;
+	size_t total = 0;
+
+	for (auto lumpnum : lumps)
+	{
+		if ((unsigned)lumpnum >= LumpInfo.Size()) continue;
+		auto rl = LumpInfo[lumpnum].lump;
+		if (rl->Cache != nullptr || rl->LumpSize <= 0 || !rl->CanPrefetch()) continue;
+		if (total + rl->LumpSize > maxbytes) break;
+
+		// Lumps may be listed more than once.
+		bool listed = false;
+		for (auto &job : jobs) if (job.lump == rl) listed = true;
+		if (listed) continue;
+
+		// Reading the compressed data uses the owner's file reader, so this must happen here.
+		jobs.Push({ rl, rl->GetRawData(), nullptr });
+		total += rl->LumpSize;
+	}
+	if (jobs.Size() == 0) return batch;
+
+	// The workers only touch the job list, never the lumps themselves.
+	auto worker = [batch](unsigned first, unsigned step)
+	{
+		auto &jobs = batch->jobs;
+		for (unsigned i = first; i < jobs.Size(); i += step)
+		{
+			auto &job = jobs[i];
+			job.data = new char[job.raw.mSize];
+			try
+			{
+				FileReader mr, frz;
+				mr.OpenMemory(job.raw.mBuffer, job.raw.mCompressedSize);
+				if (frz.OpenDecompressor(mr, job.raw.mSize, job.raw.mMethod, false) && frz.Read(job.data, job.raw.mSize) == (FileReader::Size)job.raw.mSize)
+				{
+					continue;
+				}
+			}
+			catch (CRecoverableError &)
+			{
+				// Leave reporting the error to the regular cache fill.
+			}
+			delete[] job.data;
+			job.data = nullptr;
+		}
+	};
+
+	unsigned numthreads = MIN(Jobs.NumThreads(), jobs.Size());
+	if (background)
+	{
+		for (unsigned t = 0; t < numthreads; t++)
+		{
+			Jobs.Submit(batch->counter, [=]() { worker(t, numthreads); });
+		}
+	}
+	else
+	{
+		Jobs.RunParallel(numthreads, [=](unsigned t) { worker(t, numthreads); });
+	}
+	return batch;
+}
+
+void FWadCollection::FinishPrefetch(PrefetchBatch *batch, TArray<FResourceLump *> &holder)
+{
+	Jobs.Wait(batch->counter);
+
+	for (auto &job : batch->jobs)
+	{
+		job.raw.Clean();
+		if (job.data == nullptr) continue;
+
+		// The lump may have been read the regular way while the batch was running.
+		if (job.lump->Cache == nullptr)
+		{
+			job.lump->Cache = job.data;
+			job.lump->RefCount = 1;
+			holder.Push(job.lump);
+		}
+		else
+		{
+			delete[] job.data;
+		}
+	}
+	delete batch;
+}
+
+void FWadCollection::PrefetchLumps(const TArray<int> &lumps, size_t maxbytes)
+{
+	FinishPrefetch(StartPrefetch(lumps, maxbytes, false), PrefetchedLumps);
+}
+
+//==========================================================================
+//
+// ReleasePrefetchedLumps
+//
+// Drops the references PrefetchLumps holds. Lumps not otherwise in use
+// are freed.
+//
+//==========================================================================
+
+void FWadCollection::ReleasePrefetchedLumps()
+{
+	for (auto rl : PrefetchedLumps)
+	{
+		rl->ReleaseCache();
+	}
+	PrefetchedLumps.Clear();
+}
+
+//==========================================================================
+//
+// StartBackgroundPrefetch
+//
+// Like PrefetchLumps, but returns right away and leaves the main thread
+// free for other work while the lumps get inflated. Until
+// FinishBackgroundPrefetch is called, the lumps can still be read the
+// regular way. Lumps from a background prefetch are held separately, so
+// that the shorter lived prefetches made in the meantime don't release
+// them, until ReleaseBackgroundPrefetch is called.
+//
+//==========================================================================
+
+void FWadCollection::StartBackgroundPrefetch(const TArray<int> &lumps, size_t maxbytes)
+{
+	FinishBackgroundPrefetch();
+	BackgroundPrefetch = StartPrefetch(lumps, maxbytes, true);
+}
+
+void FWadCollection::FinishBackgroundPrefetch()
+{
+	if (BackgroundPrefetch != nullptr)
+	{
+		FinishPrefetch(BackgroundPrefetch, BackgroundLumps);
+		BackgroundPrefetch = nullptr;
+	}
+}
+
+void FWadCollection::ReleaseBackgroundPrefetch()
+{
+	FinishBackgroundPrefetch();
+	for (auto rl : BackgroundLumps)
+	{
+		rl->ReleaseCache();
+	}
+	BackgroundLumps.Clear();
+}
+
+//==========================================================================
+//
+// FindModifiedLumps
+//
+// Collects the lumps of directory mounts whose files were changed on disk.
+// Their caches have already been dropped when this returns.
+//
+//==========================================================================
+
+void FWadCollection::FindModifiedLumps(TArray<int> &lumps)
+{
+	TArray<int> changed;
+	for (auto file : Files)
+	{
+		changed.Clear();
+		file->FindModifiedLumps(changed);
+		for (auto lump : changed)
+		{
+			lumps.Push(file->GetFirstLump() + lump);
+		}
+	}
+}
+
 //==========================================================================
 //
 // OpenLumpReader
@@ -1489,6 +1728,10 @@ FileReader FWadCollection::OpenLumpReader(int lump)
 		rdr.OpenFilePart(*rd, rl->GetFileOffset(), rl->LumpSize);
 		return rdr;
 	}
+	if (rl->RefCount == 0 && (rl->Flags & LUMPF_COMPRESSED))
+	{
+		return rl->NewStreamReader();	// Only decompresses what gets read, if the lump's format allows it.
+	}
 	return rl->NewReader();	// This always gets a reader to the cache
 }
 
@@ -1515,6 +1758,35 @@ FileReader FWadCollection::ReopenLumpReader(int lump, bool alwayscache)
 	return rl->NewReader();	// This always gets a reader to the cache
 }
 
+//==========================================================================
+//
+// ReopenStreamingLumpReader
+//
+// For lumps that are read sequentially over a long time, like music.
+// Compressed lumps are decompressed in small blocks as they get read
+// instead of being cached in full.
+//
+//==========================================================================
+
+FileReader FWadCollection::ReopenStreamingLumpReader(int lump)
+{
+	if ((unsigned)lump >= (unsigned)LumpInfo.Size())
+	{
+		I_Error("ReopenStreamingLumpReader: %u >= NumLumps", lump);
+	}
+
+	auto rl = LumpInfo[lump].lump;
+	if (rl->RefCount == 0 && (rl->Flags & LUMPF_COMPRESSED))
+	{
+		auto fr = rl->NewIndependentStreamReader(Wads.GetWadFullName(Wads.GetLumpFile(lump)));
+		if (fr.isOpen())
+		{
+			return fr;
+		}
+	}
+	return ReopenLumpReader(lump);
+}
+
 //==========================================================================
 //
 // GetFileReader
@@ -158,8 +158,16 @@ public:
 	FMemLump ReadLump (int lump);
 	FMemLump ReadLump (const char *name) { return ReadLump (GetNumForName (name)); }
 
+	void PrefetchLumps(const TArray<int> &lumps, size_t maxbytes = 128 << 20);	// decompresses lumps into their caches on worker threads.
+	void ReleasePrefetchedLumps();
+	void StartBackgroundPrefetch(const TArray<int> &lumps, size_t maxbytes = 128 << 20);	// the same while the main thread goes on.
+	void FinishBackgroundPrefetch();
+	void ReleaseBackgroundPrefetch();
+	void FindModifiedLumps(TArray<int> &lumps);
+
 	FileReader OpenLumpReader(int lump);		// opens a reader that redirects to the containing file's one.
 	FileReader ReopenLumpReader(int lump, bool alwayscache = false);		// opens an independent reader.
+	FileReader ReopenStreamingLumpReader(int lump);		// like ReopenLumpReader but never decompresses the whole lump at once.
 
 	int FindLump (const char *name, int *lastlump, bool anyns=false);		// [RH] Find lumps with duplication
 	int FindLumpMulti (const char **names, int *lastlump, bool anyns = false, int *nameindex = NULL); // same with multiple possible names
@@ -195,6 +203,12 @@ protected:
 
 	TArray<FResourceFile *> Files;
 	TArray<LumpRecord> LumpInfo;
+	struct PrefetchJob;
+	struct PrefetchBatch;
+
+	TArray<FResourceLump *> PrefetchedLumps;	// each holds one cache reference until released.
+	TArray<FResourceLump *> BackgroundLumps;	// the same for the background prefetch.
+	PrefetchBatch *BackgroundPrefetch = nullptr;
 
 	TArray<uint32_t> Hashes;	// one allocation for all hash lists.
 	uint32_t *FirstLumpIndex;	// [RH] Hashing stuff moved out of lumpinfo structure
@@ -202,6 +216,8 @@ protected:
 
 	uint32_t *FirstLumpIndex_FullName;	// The same information for fully qualified paths from .zips
 	uint32_t *NextLumpIndex_FullName;
+	uint32_t *FullNameHash;				// MakeKey of each lump's full name, checked before comparing strings.
+	TArray<uint64_t> ShortNames;		// each lump's qwName, so that following a chain does not touch the lump records.
 
 	uint32_t NumLumps = 0;					// Not necessarily the same as LumpInfo.Size()
 	uint32_t NumWads;
@@ -209,6 +225,8 @@ protected:
 	int IwadIndex;
 
 	void InitHashChains ();								// [RH] Set up the lumpinfo hashing
+	PrefetchBatch *StartPrefetch(const TArray<int> &lumps, size_t maxbytes, bool background);
+	void FinishPrefetch(PrefetchBatch *batch, TArray<FResourceLump *> &holder);
 
 private:
 	void RenameSprites();
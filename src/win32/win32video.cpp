@@ -102,6 +102,7 @@ extern bool VidResizing;
 EXTERN_CVAR (Bool, fullscreen)
 EXTERN_CVAR (Float, Gamma)
 EXTERN_CVAR (Bool, cl_capfps)
+EXTERN_CVAR (Bool, vid_lowlatency)
 
 // PRIVATE DATA DEFINITIONS ------------------------------------------------
 
@@ -130,7 +131,7 @@ CUSTOM_CVAR (Int, vid_maxfps, 200, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
 	}
 	else if (cl_capfps == 0)
 	{
-		I_SetFPSLimit(vid_maxfps);
+		I_SetFPSLimit(-1);
 	}
 }
 
@@ -780,7 +781,8 @@ void I_SetFPSLimit(int limit)
 {
 	if (limit < 0)
 	{
-		limit = vid_maxfps;
+		// With vid_lowlatency the main loop does the waiting itself.
+		limit = vid_lowlatency ? 0 : *vid_maxfps;
 	}
 	// Kill any leftover timer.
 	if (FPSLimitTimer != 0)
@@ -1336,11 +1336,24 @@ static HANDLE StringHeap;
 const SIZE_T STRING_HEAP_SIZE = 64*1024;
 #endif
 
-FStringData *FStringData::Alloc (size_t strlen)
-{
-	strlen += 1 + sizeof(FStringData);	// Add space for header and terminating null
-	strlen = (strlen + 7) & ~7;			// Pad length up
+//==========================================================================
+//
+// Short strings get created and destroyed by the million while parsing,
+// so freed blocks for them don't go back to the heap right away but are
+// kept in a small cache for each thread. The blocks themselves come from
+// the common heap, so it doesn't matter which thread frees them.
+//
+//==========================================================================
+
+enum
+{
+	SMALL_STRING_BLOCK = 32,	// Up to 19 characters
+	MEDIUM_STRING_BLOCK = 64,	// Up to 51 characters
+	STRING_CACHE_SIZE = 256,
+};
 
+static void *AllocStringBlock (size_t size)
+{
 #ifdef _WIN32
 	if (StringHeap == NULL)
 	{
@@ -1350,11 +1363,68 @@ FStringData *FStringData::Alloc (size_t strlen)
 			throw std::bad_alloc();
 		}
 	}
+	return HeapAlloc (StringHeap, 0, size);
+#else
+	return malloc (size);
+#endif
+}
 
-	FStringData *block = (FStringData *)HeapAlloc (StringHeap, 0, strlen);
+static void FreeStringBlock (void *block)
+{
+#ifdef _WIN32
+	HeapFree (StringHeap, 0, block);
 #else
-	FStringData *block = (FStringData *)malloc (strlen);
+	free (block);
 #endif
+}
+
+namespace
+{
+	// No constructor, so this is usable as soon as the thread starts.
+	struct FStringBlockCache
+	{
+		FStringData *Blocks[2][STRING_CACHE_SIZE];
+		int Count[2];
+
+		~FStringBlockCache();
+	};
+
+	thread_local FStringBlockCache StringCache;
+	// Strings that get freed after the thread's cache was destroyed must bypass it.
+	thread_local bool StringCacheGone;
+
+	FStringBlockCache::~FStringBlockCache()
+	{
+		StringCacheGone = true;
+		for (int i = 0; i < 2; i++)
+		{
+			while (Count[i] > 0)
+			{
+				FreeStringBlock (Blocks[i][--Count[i]]);
+			}
+		}
+	}
+}
+
+FStringData *FStringData::Alloc (size_t strlen)
+{
+	strlen += 1 + sizeof(FStringData);	// Add space for header and terminating null
+	strlen = (strlen + 7) & ~7;			// Pad length up
+
+	FStringData *block = NULL;
+	if (strlen <= MEDIUM_STRING_BLOCK && !StringCacheGone)
+	{
+		int cls = strlen > SMALL_STRING_BLOCK;
+		strlen = cls ? MEDIUM_STRING_BLOCK : SMALL_STRING_BLOCK;
+		if (StringCache.Count[cls] > 0)
+		{
+			block = StringCache.Blocks[cls][--StringCache.Count[cls]];
+		}
+	}
+	if (block == NULL)
+	{
+		block = (FStringData *)AllocStringBlock (strlen);
+	}
 	if (block == NULL)
 	{
 		throw std::bad_alloc();
@@ -1389,11 +1459,17 @@ void FStringData::Dealloc ()
 {
 	assert (RefCount <= 0);
 
-#ifdef _WIN32
-	HeapFree (StringHeap, 0, this);
-#else
-	free (this);
-#endif
+	size_t size = AllocLen + 1 + sizeof(FStringData);
+	if ((size == SMALL_STRING_BLOCK || size == MEDIUM_STRING_BLOCK) && !StringCacheGone)
+	{
+		int cls = size == MEDIUM_STRING_BLOCK;
+		if (StringCache.Count[cls] < STRING_CACHE_SIZE)
+		{
+			StringCache.Blocks[cls][StringCache.Count[cls]++] = this;
+			return;
+		}
+	}
+	FreeStringBlock (this);
 }
 
 FStringData *FStringData::MakeCopy ()
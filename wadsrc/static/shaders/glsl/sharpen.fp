@@ -0,0 +1,30 @@
+
+in vec2 TexCoord;
+out vec4 FragColor;
+
+uniform sampler2D InputTexture;
+uniform vec2 Scale;
+uniform vec2 Offset;
+uniform vec2 InvSize;
+uniform float Sharpness;
+
+// Contrast adaptive sharpening: the sharpening weight is lowered where the
+// local neighbourhood already has a lot of contrast, so edges don't ring.
+
+void main()
+{
+	vec2 uv = Offset + TexCoord * Scale;
+	vec3 c = texture(InputTexture, uv).rgb;
+	vec3 n = texture(InputTexture, uv + vec2(0.0, InvSize.y)).rgb;
+	vec3 s = texture(InputTexture, uv - vec2(0.0, InvSize.y)).rgb;
+	vec3 e = texture(InputTexture, uv + vec2(InvSize.x, 0.0)).rgb;
+	vec3 w = texture(InputTexture, uv - vec2(InvSize.x, 0.0)).rgb;
+
+	vec3 mn = min(c, min(min(n, s), min(e, w)));
+	vec3 mx = max(c, max(max(n, s), max(e, w)));
+	vec3 amp = sqrt(clamp(min(mn, 1.0 - mx) / max(mx, vec3(0.0001)), 0.0, 1.0));
+
+	vec3 weight = amp * (Sharpness * -0.2);
+	vec3 result = (c + (n + s + e + w) * weight) / (1.0 + 4.0 * weight);
+	FragColor = vec4(max(result, vec3(0.0)), 1.0);
+}
@@ -5,6 +5,11 @@ out vec4 FragColor;
 uniform sampler2D InputTexture;
 uniform sampler2D ExposureTexture;
 
+#if defined(COLORMAP)
+uniform vec4 uFixedColormapStart;
+uniform vec4 uFixedColormapRange;
+#endif
+
 vec3 Linear(vec3 c)
 {
 	//c = max(c, vec3(0.0));
@@ -88,5 +93,13 @@ void main()
 	color = color * exposureAdjustment;
 	color = Linear(color); // needed because gzdoom's scene texture is not linear at the moment
 #endif
+#if defined(COLORMAP)
+	// fused colormap.fp pass
+	color = Tonemap(color);
+	float gray = (color.r * 0.3 + color.g * 0.56 + color.b * 0.14);
+	vec4 cm = uFixedColormapStart + gray * uFixedColormapRange;
+	FragColor = vec4(clamp(cm.rgb, 0.0, 1.0), 1.0);
+#else
 	FragColor = vec4(Tonemap(color), 1.0);
+#endif
 }